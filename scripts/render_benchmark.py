@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# Render-benchmark driver: runs pbrt with --benchmark over a corpus of
+# small scenes (one .pbrt file per scene; the scene chooses its own
+# integrator, so the corpus should include path/bdpt/sppm/volpath
+# variants), merges the per-render records into one JSON report, and
+# optionally compares against a baseline report, failing if any scene's
+# render time regresses by more than --threshold percent.
+#
+# usage: render_benchmark.py --pbrt <binary> --scenes <dir>
+#            [--out results.json] [--baseline old.json] [--threshold 3]
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def run_scene(pbrt, scene, outdir):
+    record_file = os.path.join(outdir, "record.json")
+    if os.path.exists(record_file):
+        os.remove(record_file)
+    image = os.path.join(outdir, "out.exr")
+    status = subprocess.call(
+        [pbrt, "--quiet", "--outfile", image, "--benchmark", record_file,
+         scene],
+        cwd=os.path.dirname(os.path.abspath(scene)) or ".")
+    if status != 0 or not os.path.exists(record_file):
+        return {"scene": os.path.basename(scene), "error": status}
+    with open(record_file) as f:
+        record = json.loads(f.readline())
+    record["scene"] = os.path.basename(scene)
+    return record
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--pbrt", default="pbrt")
+    parser.add_argument("--scenes", required=True)
+    parser.add_argument("--out", default="render_benchmark.json")
+    parser.add_argument("--baseline")
+    parser.add_argument("--threshold", type=float, default=3.0)
+    args = parser.parse_args()
+
+    scenes = sorted(
+        os.path.join(args.scenes, name)
+        for name in os.listdir(args.scenes) if name.endswith(".pbrt"))
+    if not scenes:
+        sys.exit("no .pbrt scenes found in %s" % args.scenes)
+
+    results = []
+    with tempfile.TemporaryDirectory() as outdir:
+        for scene in scenes:
+            record = run_scene(args.pbrt, scene, outdir)
+            print("%-32s %s" % (record["scene"],
+                                "FAILED" if "error" in record else
+                                "%.2fs render, %.0f rays/s, %d MB peak" %
+                                (record["render_s"], record["rays_per_s"],
+                                 record["peak_rss_bytes"] // (1 << 20))))
+            results.append(record)
+    with open(args.out, "w") as f:
+        json.dump(results, f, indent=2)
+
+    status = 0
+    if any("error" in record for record in results):
+        status = 1
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = {record["scene"]: record for record in json.load(f)}
+        for record in results:
+            old = baseline.get(record["scene"])
+            if not old or "error" in record or "error" in old:
+                continue
+            if old["render_s"] <= 0:
+                continue
+            change = 100.0 * (record["render_s"] / old["render_s"] - 1)
+            if change > args.threshold:
+                print("REGRESSION %s: render %.2fs -> %.2fs (%+.1f%%)" %
+                      (record["scene"], old["render_s"], record["render_s"],
+                       change))
+                status = 1
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -33,16 +33,21 @@
 
 // accelerators/bvh.cpp*
 #include "accelerators/bvh.h"
+#include "sharedmem.h"
 #include "interaction.h"
+#include "parallel.h"
 #include "paramset.h"
 #include "stats.h"
 #include <algorithm>
+#include <cstdio>
+#include <unordered_map>
 
 STAT_TIMER("Time/BVH construction", constructionTime);
 STAT_MEMORY_COUNTER("Memory/BVH tree", treeBytes);
 STAT_RATIO("BVH/Primitives per leaf node", totalPrimitives, totalLeafNodes);
 STAT_COUNTER("BVH/Interior nodes", interiorNodes);
 STAT_COUNTER("BVH/Leaf nodes", leafNodes);
+STAT_COUNTER("BVH/Spatial splits", nSpatialSplits);
 
 // BVHAccel Local Declarations
 struct BVHPrimitiveInfo {
@@ -90,17 +95,6 @@ struct LBVHTreelet {
     BVHBuildNode *buildNodes;
 };
 
-struct LinearBVHNode {
-    Bounds3f bounds;
-    union {
-        int primitivesOffset;   // leaf
-        int secondChildOffset;  // interior
-    };
-    uint16_t nPrimitives;  // 0 -> interior node
-    uint8_t axis;          // interior node: xyz
-    uint8_t pad[1];        // ensure 32 byte total size
-};
-
 // BVHAccel Utility Functions
 inline uint32_t LeftShift3(uint32_t x) {
     Assert(x <= (1 << 10));
@@ -174,11 +168,150 @@ static void RadixSort(std::vector<MortonPrimitive> *v) {
     if (nPasses & 1) std::swap(*v, tempVector);
 }
 
+// Rank primitives by how cheap they are to test for occlusion so that
+// any-hit traversal can try direct geometry before primitives that
+// require a ray transformation or a nested aggregate descent.
+static int PrimitiveOcclusionCostRank(const Primitive *prim) {
+    if (dynamic_cast<const Aggregate *>(prim)) return 2;
+    if (dynamic_cast<const TransformedPrimitive *>(prim)) return 1;
+    return 0;
+}
+
+// BVH cache file layout: _BVHCacheHeader_, then the ordered-primitive
+// permutation (indices into the primitives as passed to the
+// constructor), then the flattened LinearBVHNode array verbatim.
+struct BVHCacheHeader {
+    uint32_t magic, version;
+    uint32_t floatSize, nodeSize;
+    uint64_t key;
+    uint64_t nInputPrims, nOrderedPrims, nNodes;
+};
+static const uint32_t bvhCacheMagic = 0x48564250;  // "PBVH"
+static const uint32_t bvhCacheVersion = 1;
+
+// Hash the primitive bounds and build parameters with 64-bit FNV-1a to
+// key the on-disk BVH cache.
+static uint64_t BVHCacheKey(const std::vector<BVHPrimitiveInfo> &primitiveInfo,
+                            int maxPrimsInNode,
+                            BVHAccel::SplitMethod splitMethod) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size) {
+        const unsigned char *bytes = (const unsigned char *)data;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    uint64_t n = primitiveInfo.size();
+    mix(&n, sizeof(n));
+    mix(&maxPrimsInNode, sizeof(maxPrimsInNode));
+    mix(&splitMethod, sizeof(splitMethod));
+    for (const BVHPrimitiveInfo &pi : primitiveInfo)
+        mix(&pi.bounds, sizeof(pi.bounds));
+    return hash;
+}
+
+static bool LoadBVHCache(const std::string &filename, uint64_t key,
+                         std::vector<std::shared_ptr<Primitive>> *primitives,
+                         LinearBVHNode **nodes, int *totalNodes,
+                         bool *nodesShared) {
+    *nodesShared = false;
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    BVHCacheHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != bvhCacheMagic || header.version != bvhCacheVersion ||
+        header.floatSize != sizeof(Float) ||
+        header.nodeSize != sizeof(LinearBVHNode) || header.key != key ||
+        header.nInputPrims != primitives->size()) {
+        fclose(f);
+        return false;
+    }
+    std::vector<int32_t> permutation(header.nOrderedPrims);
+    // With --sharedmem the node block lives in a named shared segment,
+    // so sibling processes on the node keep one resident copy; the
+    // first process fills it from the cache file
+    LinearBVHNode *linearNodes = nullptr;
+    bool sharedCreator = false;
+    if (SharedSceneEnabled())
+        linearNodes = (LinearBVHNode *)SharedScenePublishOrAttach(
+            key ^ (header.nNodes * 0x9e3779b97f4a7c15ull),
+            header.nNodes * sizeof(LinearBVHNode), &sharedCreator);
+    *nodesShared = linearNodes != nullptr;
+    if (!linearNodes)
+        linearNodes = AllocAlignedInterleaved<LinearBVHNode>(header.nNodes);
+    if (fread(permutation.data(), sizeof(int32_t), permutation.size(), f) !=
+            permutation.size()) {
+        fclose(f);
+        if (!*nodesShared) FreeAligned(linearNodes);
+        return false;
+    }
+    if (*nodesShared && !sharedCreator) {
+        // The nodes are (or will be) in the segment already
+        SharedSceneWaitReady(linearNodes);
+    } else if (fread(linearNodes, sizeof(LinearBVHNode), header.nNodes, f) !=
+               header.nNodes) {
+        fclose(f);
+        if (!*nodesShared) FreeAligned(linearNodes);
+        return false;
+    } else if (*nodesShared)
+        SharedSceneMarkReady(linearNodes);
+    fclose(f);
+    std::vector<std::shared_ptr<Primitive>> orderedPrims(
+        header.nOrderedPrims);
+    for (size_t i = 0; i < permutation.size(); ++i) {
+        if (permutation[i] < 0 ||
+            permutation[i] >= (int32_t)primitives->size()) {
+            if (!*nodesShared) FreeAligned(linearNodes);
+            return false;
+        }
+        orderedPrims[i] = (*primitives)[permutation[i]];
+    }
+    primitives->swap(orderedPrims);
+    *nodes = linearNodes;
+    *totalNodes = header.nNodes;
+    return true;
+}
+
+static void SaveBVHCache(const std::string &filename, uint64_t key,
+                         uint64_t nInputPrims,
+                         const std::vector<int32_t> &permutation,
+                         const LinearBVHNode *nodes, int totalNodes) {
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) {
+        Warning("Unable to write BVH cache file \"%s\"", filename.c_str());
+        return;
+    }
+    BVHCacheHeader header;
+    header.magic = bvhCacheMagic;
+    header.version = bvhCacheVersion;
+    header.floatSize = sizeof(Float);
+    header.nodeSize = sizeof(LinearBVHNode);
+    header.key = key;
+    header.nInputPrims = nInputPrims;
+    header.nOrderedPrims = permutation.size();
+    header.nNodes = totalNodes;
+    if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+        fwrite(permutation.data(), sizeof(int32_t), permutation.size(), f) !=
+            permutation.size() ||
+        fwrite(nodes, sizeof(LinearBVHNode), totalNodes, f) !=
+            (size_t)totalNodes)
+        Warning("Error writing BVH cache file \"%s\"", filename.c_str());
+    fclose(f);
+}
+
+// Subtrees with at most this many primitives are built as independent
+// parallel tasks by _parallelSAHBuild()_ rather than being split further
+// on the calling thread.
+static const int sahParallelSubtreeSize = 4096;
+
 // BVHAccel Method Definitions
 BVHAccel::BVHAccel(const std::vector<std::shared_ptr<Primitive>> &p,
-                   int maxPrimsInNode, SplitMethod splitMethod)
+                   int maxPrimsInNode, SplitMethod splitMethod,
+                   Float spatialSplitBudget, const std::string &cacheDir)
     : maxPrimsInNode(std::min(255, maxPrimsInNode)),
       splitMethod(splitMethod),
+      spatialSplitBudget(spatialSplitBudget),
       primitives(p) {
     StatTimer buildTime(&constructionTime);
     if (primitives.size() == 0) return;
@@ -186,17 +319,51 @@ BVHAccel::BVHAccel(const std::vector<std::shared_ptr<Primitive>> &p,
 
     // Initialize _primitiveInfo_ array for primitives
     std::vector<BVHPrimitiveInfo> primitiveInfo(primitives.size());
-    for (size_t i = 0; i < primitives.size(); ++i)
-        primitiveInfo[i] = {i, primitives[i]->WorldBound()};
+    ParallelFor([&](int64_t i) {
+        primitiveInfo[i] = {(size_t)i, primitives[i]->WorldBound()};
+    }, primitives.size(), 1024);
+
+    // Try to reuse a previously serialized BVH for this geometry
+    uint64_t cacheKey = 0;
+    std::string cachePath;
+    if (!cacheDir.empty()) {
+        cacheKey = BVHCacheKey(primitiveInfo, this->maxPrimsInNode,
+                               splitMethod);
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "/bvh-%016llx.bin",
+                 (unsigned long long)cacheKey);
+        cachePath = cacheDir + suffix;
+        int cachedNodes;
+        if (LoadBVHCache(cachePath, cacheKey, &primitives, &nodes,
+                         &cachedNodes, &nodesShared)) {
+            Info("Loaded BVH with %d nodes for %d primitives from \"%s\"",
+                 cachedNodes, (int)primitives.size(), cachePath.c_str());
+            treeBytes += cachedNodes * sizeof(LinearBVHNode) + sizeof(*this) +
+                         primitives.size() * sizeof(primitives[0]);
+            nNodes = cachedNodes;
+            return;
+        }
+    }
 
     // Build BVH tree for primitives using _primitiveInfo_
     MemoryArena arena(1024 * 1024);
+    std::vector<std::unique_ptr<MemoryArena>> subtreeArenas;
     int totalNodes = 0;
-    std::vector<std::shared_ptr<Primitive>> orderedPrims;
-    orderedPrims.reserve(primitives.size());
+    std::vector<std::shared_ptr<Primitive>> orderedPrims(primitives.size());
     BVHBuildNode *root;
     if (splitMethod == SplitMethod::HLBVH)
         root = HLBVHBuild(arena, primitiveInfo, &totalNodes, orderedPrims);
+    else if (splitMethod == SplitMethod::SpatialSplit) {
+        // Reference splitting may duplicate primitives, so ordered
+        // primitives are appended rather than written in place.
+        orderedPrims.clear();
+        nSpatialRefs = primitiveInfo.size();
+        root = spatialSplitBuild(arena, primitiveInfo, &totalNodes,
+                                 orderedPrims);
+    } else if (splitMethod == SplitMethod::SAH && MaxThreadIndex() > 1 &&
+             (int)primitives.size() > 2 * sahParallelSubtreeSize)
+        root = parallelSAHBuild(arena, subtreeArenas, primitiveInfo,
+                                &totalNodes, orderedPrims);
     else
         root = recursiveBuild(arena, primitiveInfo, 0, primitives.size(),
                               &totalNodes, orderedPrims);
@@ -208,10 +375,39 @@ BVHAccel::BVHAccel(const std::vector<std::shared_ptr<Primitive>> &p,
     // Compute representation of depth-first traversal of BVH tree
     treeBytes += totalNodes * sizeof(LinearBVHNode) + sizeof(*this) +
                  primitives.size() * sizeof(primitives[0]);
-    nodes = AllocAligned<LinearBVHNode>(totalNodes);
+    nodes = AllocAlignedInterleaved<LinearBVHNode>(totalNodes);
     int offset = 0;
     flattenBVHTree(root, &offset);
     Assert(offset == totalNodes);
+    nNodes = totalNodes;
+
+    // Order each leaf's primitives so the cheapest tests come first;
+    // shadow rays frequently terminate on the first primitive tried.
+    for (int i = 0; i < nNodes; ++i) {
+        const LinearBVHNode &node = nodes[i];
+        if (node.nPrimitives > 1)
+            std::stable_sort(
+                primitives.begin() + node.primitivesOffset,
+                primitives.begin() + node.primitivesOffset + node.nPrimitives,
+                [](const std::shared_ptr<Primitive> &a,
+                   const std::shared_ptr<Primitive> &b) {
+                    return PrimitiveOcclusionCostRank(a.get()) <
+                           PrimitiveOcclusionCostRank(b.get());
+                });
+    }
+
+    // Serialize the flattened BVH for reuse by later runs
+    if (!cachePath.empty()) {
+        std::unordered_map<const Primitive *, int32_t> inputIndex;
+        inputIndex.reserve(p.size());
+        for (size_t i = 0; i < p.size(); ++i)
+            inputIndex.emplace(p[i].get(), (int32_t)i);
+        std::vector<int32_t> permutation(primitives.size());
+        for (size_t i = 0; i < primitives.size(); ++i)
+            permutation[i] = inputIndex[primitives[i].get()];
+        SaveBVHCache(cachePath, cacheKey, p.size(), permutation, nodes,
+                     totalNodes);
+    }
 }
 
 Bounds3f BVHAccel::WorldBound() const {
@@ -237,12 +433,11 @@ BVHBuildNode *BVHAccel::recursiveBuild(
     int nPrimitives = end - start;
     if (nPrimitives == 1) {
         // Create leaf _BVHBuildNode_
-        int firstPrimOffset = orderedPrims.size();
         for (int i = start; i < end; ++i) {
             int primNum = primitiveInfo[i].primitiveNumber;
-            orderedPrims.push_back(primitives[primNum]);
+            orderedPrims[i] = primitives[primNum];
         }
-        node->InitLeaf(firstPrimOffset, nPrimitives, bounds);
+        node->InitLeaf(start, nPrimitives, bounds);
         return node;
     } else {
         // Compute bound of primitive centroids, choose split dimension _dim_
@@ -255,12 +450,11 @@ BVHBuildNode *BVHAccel::recursiveBuild(
         int mid = (start + end) / 2;
         if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim]) {
             // Create leaf _BVHBuildNode_
-            int firstPrimOffset = orderedPrims.size();
             for (int i = start; i < end; ++i) {
                 int primNum = primitiveInfo[i].primitiveNumber;
-                orderedPrims.push_back(primitives[primNum]);
+                orderedPrims[i] = primitives[primNum];
             }
-            node->InitLeaf(firstPrimOffset, nPrimitives, bounds);
+            node->InitLeaf(start, nPrimitives, bounds);
             return node;
         } else {
             // Partition primitives based on _splitMethod_
@@ -367,12 +561,11 @@ BVHBuildNode *BVHAccel::recursiveBuild(
                         mid = pmid - &primitiveInfo[0];
                     } else {
                         // Create leaf _BVHBuildNode_
-                        int firstPrimOffset = orderedPrims.size();
                         for (int i = start; i < end; ++i) {
                             int primNum = primitiveInfo[i].primitiveNumber;
-                            orderedPrims.push_back(primitives[primNum]);
+                            orderedPrims[i] = primitives[primNum];
                         }
-                        node->InitLeaf(firstPrimOffset, nPrimitives, bounds);
+                        node->InitLeaf(start, nPrimitives, bounds);
                         return node;
                     }
                 }
@@ -389,6 +582,321 @@ BVHBuildNode *BVHAccel::recursiveBuild(
     return node;
 }
 
+BVHBuildNode *BVHAccel::spatialSplitBuild(
+    MemoryArena &arena, std::vector<BVHPrimitiveInfo> &refs, int *totalNodes,
+    std::vector<std::shared_ptr<Primitive>> &orderedPrims) {
+    Assert(refs.size() > 0);
+    BVHBuildNode *node = arena.Alloc<BVHBuildNode>();
+    (*totalNodes)++;
+    // Compute bounds of all references in BVH node
+    Bounds3f bounds;
+    for (const BVHPrimitiveInfo &ref : refs)
+        bounds = Union(bounds, ref.bounds);
+    int nRefs = refs.size();
+    auto makeLeaf = [&]() {
+        int firstPrimOffset = orderedPrims.size();
+        for (const BVHPrimitiveInfo &ref : refs)
+            orderedPrims.push_back(primitives[ref.primitiveNumber]);
+        node->InitLeaf(firstPrimOffset, nRefs, bounds);
+        return node;
+    };
+    if (nRefs == 1) return makeLeaf();
+
+    // Compute bound of reference centroids, choose split dimension _dim_
+    Bounds3f centroidBounds;
+    for (const BVHPrimitiveInfo &ref : refs)
+        centroidBounds = Union(centroidBounds, ref.centroid);
+    int dim = centroidBounds.MaximumExtent();
+    if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim])
+        return makeLeaf();
+    PBRT_CONSTEXPR int nBuckets = 12;
+
+    // Evaluate binned object split over reference centroids
+    BucketInfo buckets[nBuckets];
+    for (const BVHPrimitiveInfo &ref : refs) {
+        int b = nBuckets * centroidBounds.Offset(ref.centroid)[dim];
+        if (b == nBuckets) b = nBuckets - 1;
+        buckets[b].count++;
+        buckets[b].bounds = Union(buckets[b].bounds, ref.bounds);
+    }
+    Float objMinCost = Infinity;
+    int objSplitBucket = -1;
+    for (int i = 0; i < nBuckets - 1; ++i) {
+        Bounds3f b0, b1;
+        int count0 = 0, count1 = 0;
+        for (int j = 0; j <= i; ++j) {
+            b0 = Union(b0, buckets[j].bounds);
+            count0 += buckets[j].count;
+        }
+        for (int j = i + 1; j < nBuckets; ++j) {
+            b1 = Union(b1, buckets[j].bounds);
+            count1 += buckets[j].count;
+        }
+        if (count0 == 0 || count1 == 0) continue;
+        Float cost = 1 +
+                     (count0 * b0.SurfaceArea() + count1 * b1.SurfaceArea()) /
+                         bounds.SurfaceArea();
+        if (cost < objMinCost) {
+            objMinCost = cost;
+            objSplitBucket = i;
+        }
+    }
+
+    // Evaluate binned spatial split if the duplication budget allows;
+    // references are clipped to the bucket slabs (by chopping their
+    // bounds, since primitives can't be re-clipped through the
+    // _Primitive_ interface) and counted once as an entry in their first
+    // bucket and once as an exit in their last.
+    Float spatialMinCost = Infinity;
+    int spatialSplitBucket = -1;
+    Float lo = bounds.pMin[dim], hi = bounds.pMax[dim];
+    bool budgetLeft =
+        (Float)nSpatialRefs < spatialSplitBudget * (Float)primitives.size();
+    if (hi > lo && budgetLeft) {
+        struct SpatialBin {
+            int entries = 0, exits = 0;
+            Bounds3f bounds;
+        };
+        SpatialBin bins[nBuckets];
+        for (const BVHPrimitiveInfo &ref : refs) {
+            int b0 = Clamp((int)(nBuckets * (ref.bounds.pMin[dim] - lo) /
+                                 (hi - lo)),
+                           0, nBuckets - 1);
+            int b1 = Clamp((int)(nBuckets * (ref.bounds.pMax[dim] - lo) /
+                                 (hi - lo)),
+                           b0, nBuckets - 1);
+            bins[b0].entries++;
+            bins[b1].exits++;
+            for (int b = b0; b <= b1; ++b) {
+                Bounds3f clipped = ref.bounds;
+                clipped.pMin[dim] =
+                    std::max(clipped.pMin[dim],
+                             lo + b * (hi - lo) / nBuckets);
+                clipped.pMax[dim] =
+                    std::min(clipped.pMax[dim],
+                             lo + (b + 1) * (hi - lo) / nBuckets);
+                bins[b].bounds = Union(bins[b].bounds, clipped);
+            }
+        }
+        Bounds3f rightBounds[nBuckets];
+        rightBounds[nBuckets - 1] = bins[nBuckets - 1].bounds;
+        for (int i = nBuckets - 2; i > 0; --i)
+            rightBounds[i] = Union(rightBounds[i + 1], bins[i].bounds);
+        Bounds3f b0;
+        int count0 = 0, count1 = nRefs;
+        for (int i = 0; i < nBuckets - 1; ++i) {
+            b0 = Union(b0, bins[i].bounds);
+            count0 += bins[i].entries;
+            count1 -= bins[i].exits;
+            if (count0 == 0 || count1 == 0) continue;
+            Float cost =
+                1 +
+                (count0 * b0.SurfaceArea() +
+                 count1 * rightBounds[i + 1].SurfaceArea()) /
+                    bounds.SurfaceArea();
+            if (cost < spatialMinCost) {
+                spatialMinCost = cost;
+                spatialSplitBucket = i;
+            }
+        }
+    }
+
+    // Either create leaf or split references at the cheaper candidate
+    Float leafCost = nRefs;
+    Float minCost = std::min(objMinCost, spatialMinCost);
+    if (nRefs <= maxPrimsInNode && leafCost <= minCost) return makeLeaf();
+    std::vector<BVHPrimitiveInfo> leftRefs, rightRefs;
+    if (spatialSplitBucket >= 0 && spatialMinCost < objMinCost) {
+        // Distribute references across the spatial split plane,
+        // duplicating (with chopped bounds) those that straddle it
+        Float splitPos = lo + (spatialSplitBucket + 1) * (hi - lo) / nBuckets;
+        for (const BVHPrimitiveInfo &ref : refs) {
+            if (ref.bounds.pMax[dim] <= splitPos)
+                leftRefs.push_back(ref);
+            else if (ref.bounds.pMin[dim] >= splitPos)
+                rightRefs.push_back(ref);
+            else {
+                Bounds3f lb = ref.bounds, rb = ref.bounds;
+                lb.pMax[dim] = splitPos;
+                rb.pMin[dim] = splitPos;
+                leftRefs.push_back(
+                    BVHPrimitiveInfo(ref.primitiveNumber, lb));
+                rightRefs.push_back(
+                    BVHPrimitiveInfo(ref.primitiveNumber, rb));
+                ++nSpatialRefs;
+                ++nSpatialSplits;
+            }
+        }
+    }
+    if (leftRefs.empty() || rightRefs.empty()) {
+        // Partition references by the object split (or in equal halves
+        // if the binning failed to separate them)
+        leftRefs.clear();
+        rightRefs.clear();
+        if (objSplitBucket >= 0) {
+            for (const BVHPrimitiveInfo &ref : refs) {
+                int b = nBuckets * centroidBounds.Offset(ref.centroid)[dim];
+                if (b == nBuckets) b = nBuckets - 1;
+                if (b <= objSplitBucket)
+                    leftRefs.push_back(ref);
+                else
+                    rightRefs.push_back(ref);
+            }
+        } else {
+            std::nth_element(refs.begin(), refs.begin() + nRefs / 2,
+                             refs.end(),
+                             [dim](const BVHPrimitiveInfo &a,
+                                   const BVHPrimitiveInfo &b) {
+                                 return a.centroid[dim] < b.centroid[dim];
+                             });
+            leftRefs.assign(refs.begin(), refs.begin() + nRefs / 2);
+            rightRefs.assign(refs.begin() + nRefs / 2, refs.end());
+        }
+    }
+    // Release this node's reference list before recursing
+    refs.clear();
+    refs.shrink_to_fit();
+    node->InitInterior(
+        dim, spatialSplitBuild(arena, leftRefs, totalNodes, orderedPrims),
+        spatialSplitBuild(arena, rightRefs, totalNodes, orderedPrims));
+    return node;
+}
+
+BVHBuildNode *BVHAccel::parallelSAHBuild(
+    MemoryArena &arena, std::vector<std::unique_ptr<MemoryArena>> &subtreeArenas,
+    std::vector<BVHPrimitiveInfo> &primitiveInfo, int *totalNodes,
+    std::vector<std::shared_ptr<Primitive>> &orderedPrims) {
+    // Split the top of the tree on the calling thread, using all threads
+    // for the binning and bounds passes; ranges at or below
+    // _subtreeSize_ primitives become independent build tasks.
+    struct SubtreeTask {
+        BVHBuildNode *node;
+        int start, end;
+    };
+    std::vector<SubtreeTask> tasks;
+    const int nThreads = MaxThreadIndex();
+    const int subtreeSize =
+        std::max(sahParallelSubtreeSize,
+                 (int)(primitiveInfo.size() / (8 * nThreads)));
+    std::function<BVHBuildNode *(int, int)> buildUpper = [&](
+        int start, int end) -> BVHBuildNode * {
+        int nPrimitives = end - start;
+        BVHBuildNode *node = arena.Alloc<BVHBuildNode>();
+        if (nPrimitives > subtreeSize) {
+            // Compute bounds of primitives and centroids in parallel
+            std::vector<Bounds3f> threadBounds(nThreads);
+            std::vector<Bounds3f> threadCentroidBounds(nThreads);
+            ParallelFor([&](int64_t i) {
+                threadBounds[ThreadIndex] = Union(
+                    threadBounds[ThreadIndex], primitiveInfo[start + i].bounds);
+                threadCentroidBounds[ThreadIndex] =
+                    Union(threadCentroidBounds[ThreadIndex],
+                          primitiveInfo[start + i].centroid);
+            }, nPrimitives, 4096);
+            Bounds3f bounds, centroidBounds;
+            for (int t = 0; t < nThreads; ++t) {
+                bounds = Union(bounds, threadBounds[t]);
+                centroidBounds = Union(centroidBounds, threadCentroidBounds[t]);
+            }
+            int dim = centroidBounds.MaximumExtent();
+            if (centroidBounds.pMax[dim] != centroidBounds.pMin[dim]) {
+                // Bin primitives into SAH buckets with per-thread counts
+                PBRT_CONSTEXPR int nBuckets = 12;
+                std::vector<BucketInfo> threadBuckets(nThreads * nBuckets);
+                ParallelFor([&](int64_t i) {
+                    const BVHPrimitiveInfo &pi = primitiveInfo[start + i];
+                    int b = nBuckets * centroidBounds.Offset(pi.centroid)[dim];
+                    if (b == nBuckets) b = nBuckets - 1;
+                    BucketInfo &bucket =
+                        threadBuckets[ThreadIndex * nBuckets + b];
+                    bucket.count++;
+                    bucket.bounds = Union(bucket.bounds, pi.bounds);
+                }, nPrimitives, 4096);
+                BucketInfo buckets[nBuckets];
+                for (int t = 0; t < nThreads; ++t)
+                    for (int b = 0; b < nBuckets; ++b) {
+                        buckets[b].count += threadBuckets[t * nBuckets + b].count;
+                        buckets[b].bounds =
+                            Union(buckets[b].bounds,
+                                  threadBuckets[t * nBuckets + b].bounds);
+                    }
+
+                // Compute costs for splitting after each bucket
+                Float cost[nBuckets - 1];
+                for (int i = 0; i < nBuckets - 1; ++i) {
+                    Bounds3f b0, b1;
+                    int count0 = 0, count1 = 0;
+                    for (int j = 0; j <= i; ++j) {
+                        b0 = Union(b0, buckets[j].bounds);
+                        count0 += buckets[j].count;
+                    }
+                    for (int j = i + 1; j < nBuckets; ++j) {
+                        b1 = Union(b1, buckets[j].bounds);
+                        count1 += buckets[j].count;
+                    }
+                    cost[i] = 1 +
+                              (count0 * b0.SurfaceArea() +
+                               count1 * b1.SurfaceArea()) /
+                                  bounds.SurfaceArea();
+                }
+
+                // Find bucket to split at that minimizes SAH metric
+                Float minCost = cost[0];
+                int minCostSplitBucket = 0;
+                for (int i = 1; i < nBuckets - 1; ++i) {
+                    if (cost[i] < minCost) {
+                        minCost = cost[i];
+                        minCostSplitBucket = i;
+                    }
+                }
+                BVHPrimitiveInfo *pmid = std::partition(
+                    &primitiveInfo[start], &primitiveInfo[end - 1] + 1,
+                    [=](const BVHPrimitiveInfo &pi) {
+                        int b = nBuckets *
+                                centroidBounds.Offset(pi.centroid)[dim];
+                        if (b == nBuckets) b = nBuckets - 1;
+                        return b <= minCostSplitBucket;
+                    });
+                int mid = pmid - &primitiveInfo[0];
+                if (mid != start && mid != end) {
+                    // Create interior node; children bounds aren't known
+                    // yet for subtree tasks, so use the exact bounds
+                    // computed from the primitive range instead of
+                    // _InitInterior()_.
+                    (*totalNodes)++;
+                    node->children[0] = buildUpper(start, mid);
+                    node->children[1] = buildUpper(mid, end);
+                    node->bounds = bounds;
+                    node->splitAxis = dim;
+                    node->nPrimitives = 0;
+                    ++interiorNodes;
+                    return node;
+                }
+            }
+        }
+        // Record range as a subtree build task
+        tasks.push_back({node, start, end});
+        return node;
+    };
+    BVHBuildNode *root = buildUpper(0, primitiveInfo.size());
+
+    // Build subtrees in parallel, one arena per task
+    for (size_t i = 0; i < tasks.size(); ++i)
+        subtreeArenas.emplace_back(new MemoryArena(1024 * 1024));
+    std::atomic<int> atomicTotal(0);
+    ParallelFor([&](int64_t i) {
+        const SubtreeTask &task = tasks[i];
+        int taskNodes = 0;
+        BVHBuildNode *subRoot =
+            recursiveBuild(*subtreeArenas[i], primitiveInfo, task.start,
+                           task.end, &taskNodes, orderedPrims);
+        *task.node = *subRoot;
+        atomicTotal += taskNodes;
+    }, tasks.size());
+    *totalNodes += atomicTotal;
+    return root;
+}
+
 BVHBuildNode *BVHAccel::HLBVHBuild(
     MemoryArena &arena, const std::vector<BVHPrimitiveInfo> &primitiveInfo,
     int *totalNodes,
@@ -642,7 +1150,36 @@ int BVHAccel::flattenBVHTree(BVHBuildNode *node, int *offset) {
     return myOffset;
 }
 
-BVHAccel::~BVHAccel() { FreeAligned(nodes); }
+BVHAccel::~BVHAccel() {
+    if (!nodesShared) FreeAligned(nodes);
+}
+
+void BVHAccel::Refit() {
+    if (!nodes) return;
+    if (nodesShared) {
+        // The node block is mapped read-mostly across processes;
+        // refitting in place would corrupt sibling renders
+        Warning("Skipping BVH refit of shared node block");
+        return;
+    }
+    // In the depth-first layout both children of an interior node are
+    // stored at higher indices than the node itself, so a single reverse
+    // sweep updates bounds bottom-up: leaves from their primitives'
+    // current world bounds, interior nodes from their children.
+    for (int i = nNodes - 1; i >= 0; --i) {
+        LinearBVHNode *node = &nodes[i];
+        if (node->nPrimitives > 0) {
+            Bounds3f bounds;
+            for (int j = 0; j < node->nPrimitives; ++j)
+                bounds = Union(
+                    bounds,
+                    primitives[node->primitivesOffset + j]->WorldBound());
+            node->bounds = bounds;
+        } else
+            node->bounds = Union(nodes[i + 1].bounds,
+                                 nodes[node->secondChildOffset].bounds);
+    }
+}
 
 bool BVHAccel::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
     if (!nodes) return false;
@@ -685,6 +1222,10 @@ bool BVHAccel::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
 }
 
 bool BVHAccel::IntersectP(const Ray &ray) const {
+    // Any-hit traversal: occlusion rays can stop at the first
+    // intersection found, so there is no benefit to the front-to-back
+    // ordered descent used by Intersect(); the first child is simply
+    // visited next and the second pushed, with no axis bookkeeping.
     if (!nodes) return false;
     ProfilePhase p(Prof::AccelIntersectP);
     Vector3f invDir(1.f / ray.d.x, 1.f / ray.d.y, 1.f / ray.d.z);
@@ -704,9 +1245,121 @@ bool BVHAccel::IntersectP(const Ray &ray) const {
                 }
                 if (toVisitOffset == 0) break;
                 currentNodeIndex = nodesToVisit[--toVisitOffset];
+            } else {
+                nodesToVisit[toVisitOffset++] = node->secondChildOffset;
+                currentNodeIndex = currentNodeIndex + 1;
+            }
+        } else {
+            if (toVisitOffset == 0) break;
+            currentNodeIndex = nodesToVisit[--toVisitOffset];
+        }
+    }
+    return false;
+}
+
+// Order rays by direction octant (and by origin within an octant) so
+// that coherent rays are traversed back to back and touch largely the
+// same BVH nodes while they are still cache-resident.
+static void SortRayStream(const Ray *rays, int nRays,
+                          std::vector<int> *order) {
+    order->resize(nRays);
+    for (int i = 0; i < nRays; ++i) (*order)[i] = i;
+    auto octant = [](const Ray &r) {
+        return (r.d.x < 0 ? 1 : 0) | (r.d.y < 0 ? 2 : 0) |
+               (r.d.z < 0 ? 4 : 0);
+    };
+    std::sort(order->begin(), order->end(), [&](int a, int b) {
+        int oa = octant(rays[a]), ob = octant(rays[b]);
+        if (oa != ob) return oa < ob;
+        if (rays[a].o.x != rays[b].o.x) return rays[a].o.x < rays[b].o.x;
+        if (rays[a].o.y != rays[b].o.y) return rays[a].o.y < rays[b].o.y;
+        return rays[a].o.z < rays[b].o.z;
+    });
+}
+
+bool BVHAccel::ComputeBeamEntry(const Point3f &origin,
+                                const Vector3f cornerDirections[4],
+                                std::vector<int> *entryNodes) const {
+    if (!nodes) return false;
+    // Build the four inward-facing side planes of the frustum from
+    // consecutive corner directions
+    Vector3f center = cornerDirections[0] + cornerDirections[1] +
+                      cornerDirections[2] + cornerDirections[3];
+    Vector3f planes[4];
+    for (int i = 0; i < 4; ++i) {
+        Vector3f n = Cross(cornerDirections[i], cornerDirections[(i + 1) % 4]);
+        if (n.LengthSquared() < 1e-18f) return false;
+        if (Dot(n, center) < 0) n = -n;
+        planes[i] = n;
+    }
+
+    // Descend from the root, culling subtrees entirely outside any
+    // plane (p-vertex test) and recording the surviving subtree roots;
+    // descent stops at leaves, fully inside nodes, a depth cap, or
+    // when the entry list is about to overflow
+    PBRT_CONSTEXPR int maxEntryNodes = 64, maxDepth = 12;
+    entryNodes->clear();
+    struct StackEntry {
+        int node, depth;
+    };
+    StackEntry stack[64];
+    int sp = 0;
+    stack[sp++] = {0, 0};
+    while (sp > 0) {
+        StackEntry top = stack[--sp];
+        const LinearBVHNode *node = &nodes[top.node];
+        bool culled = false, inside = true;
+        for (int i = 0; i < 4 && !culled; ++i) {
+            const Vector3f &n = planes[i];
+            Point3f pFar(n.x > 0 ? node->bounds.pMax.x : node->bounds.pMin.x,
+                         n.y > 0 ? node->bounds.pMax.y : node->bounds.pMin.y,
+                         n.z > 0 ? node->bounds.pMax.z : node->bounds.pMin.z);
+            if (Dot(n, pFar - origin) < 0) culled = true;
+            Point3f pNear(n.x > 0 ? node->bounds.pMin.x : node->bounds.pMax.x,
+                          n.y > 0 ? node->bounds.pMin.y : node->bounds.pMax.y,
+                          n.z > 0 ? node->bounds.pMin.z : node->bounds.pMax.z);
+            if (Dot(n, pNear - origin) < 0) inside = false;
+        }
+        if (culled) continue;
+        if (node->nPrimitives > 0 || inside || top.depth >= maxDepth ||
+            (int)entryNodes->size() + sp + 2 > maxEntryNodes) {
+            entryNodes->push_back(top.node);
+            continue;
+        }
+        stack[sp++] = {node->secondChildOffset, top.depth + 1};
+        stack[sp++] = {top.node + 1, top.depth + 1};
+    }
+    return true;
+}
+
+bool BVHAccel::IntersectFromEntry(const Ray &ray, SurfaceInteraction *isect,
+                                  const std::vector<int> &entryNodes) const {
+    if (!nodes) return false;
+    // Nothing survived the frustum: no ray in the beam can hit
+    if (entryNodes.empty()) return false;
+    ProfilePhase p(Prof::AccelIntersect);
+    bool hit = false;
+    Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+    int dirIsNeg[3] = {invDir.x < 0, invDir.y < 0, invDir.z < 0};
+    // Seed the traversal stack with the beam's entry nodes instead of
+    // starting at the root
+    int nodesToVisit[128];
+    int toVisitOffset = 0;
+    for (size_t i = entryNodes.size() - 1; i > 0; --i)
+        nodesToVisit[toVisitOffset++] = entryNodes[i];
+    int currentNodeIndex = entryNodes[0];
+    while (true) {
+        const LinearBVHNode *node = &nodes[currentNodeIndex];
+        if (node->bounds.IntersectP(ray, invDir, dirIsNeg)) {
+            if (node->nPrimitives > 0) {
+                for (int i = 0; i < node->nPrimitives; ++i)
+                    if (primitives[node->primitivesOffset + i]->Intersect(
+                            ray, isect))
+                        hit = true;
+                if (toVisitOffset == 0) break;
+                currentNodeIndex = nodesToVisit[--toVisitOffset];
             } else {
                 if (dirIsNeg[node->axis]) {
-                    /// second child first
                     nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
                     currentNodeIndex = node->secondChildOffset;
                 } else {
@@ -719,7 +1372,20 @@ bool BVHAccel::IntersectP(const Ray &ray) const {
             currentNodeIndex = nodesToVisit[--toVisitOffset];
         }
     }
-    return false;
+    return hit;
+}
+
+void BVHAccel::IntersectStream(Ray *rays, SurfaceInteraction *isects,
+                               bool *hits, int nRays) const {
+    std::vector<int> order;
+    SortRayStream(rays, nRays, &order);
+    for (int i : order) hits[i] = Intersect(rays[i], &isects[i]);
+}
+
+void BVHAccel::IntersectPStream(Ray *rays, bool *hits, int nRays) const {
+    std::vector<int> order;
+    SortRayStream(rays, nRays, &order);
+    for (int i : order) hits[i] = IntersectP(rays[i]);
 }
 
 std::shared_ptr<BVHAccel> CreateBVHAccelerator(
@@ -734,6 +1400,8 @@ std::shared_ptr<BVHAccel> CreateBVHAccelerator(
         splitMethod = BVHAccel::SplitMethod::Middle;
     else if (splitMethodName == "equal")
         splitMethod = BVHAccel::SplitMethod::EqualCounts;
+    else if (splitMethodName == "spatial")
+        splitMethod = BVHAccel::SplitMethod::SpatialSplit;
     else {
         Warning("BVH split method \"%s\" unknown.  Using \"sah\".",
                 splitMethodName.c_str());
@@ -741,5 +1409,8 @@ std::shared_ptr<BVHAccel> CreateBVHAccelerator(
     }
 
     int maxPrimsInNode = ps.FindOneInt("maxnodeprims", 4);
-    return std::make_shared<BVHAccel>(prims, maxPrimsInNode, splitMethod);
+    Float spatialSplitBudget = ps.FindOneFloat("spatialsplitbudget", 1.2f);
+    std::string cacheDir = ps.FindOneString("cachedir", "");
+    return std::make_shared<BVHAccel>(prims, maxPrimsInNode, splitMethod,
+                                      spatialSplitBudget, cacheDir);
 }
@@ -47,29 +47,68 @@ struct BVHBuildNode;
 // BVHAccel Forward Declarations
 struct BVHPrimitiveInfo;
 struct MortonPrimitive;
-struct LinearBVHNode;
+
+struct LinearBVHNode {
+    Bounds3f bounds;
+    union {
+        int primitivesOffset;   // leaf
+        int secondChildOffset;  // interior
+    };
+    uint16_t nPrimitives;  // 0 -> interior node
+    uint8_t axis;          // interior node: xyz
+    uint8_t pad[1];        // ensure 32 byte total size
+};
 
 // BVHAccel Declarations
 class BVHAccel : public Aggregate {
   public:
     // BVHAccel Public Types
-    enum class SplitMethod { SAH, HLBVH, Middle, EqualCounts };
+    enum class SplitMethod { SAH, HLBVH, Middle, EqualCounts, SpatialSplit };
 
     // BVHAccel Public Methods
     BVHAccel(const std::vector<std::shared_ptr<Primitive>> &p,
              int maxPrimsInNode = 1,
-             SplitMethod splitMethod = SplitMethod::SAH);
+             SplitMethod splitMethod = SplitMethod::SAH,
+             Float spatialSplitBudget = 1.2f,
+             const std::string &cacheDir = "");
     Bounds3f WorldBound() const;
     ~BVHAccel();
     bool Intersect(const Ray &ray, SurfaceInteraction *isect) const;
     bool IntersectP(const Ray &ray) const;
-
-  private:
-    // BVHAccel Private Methods
+    void IntersectStream(Ray *rays, SurfaceInteraction *isects, bool *hits,
+                         int nRays) const;
+    bool ComputeBeamEntry(const Point3f &origin,
+                          const Vector3f cornerDirections[4],
+                          std::vector<int> *entryNodes) const;
+    bool IntersectFromEntry(const Ray &ray, SurfaceInteraction *isect,
+                            const std::vector<int> &entryNodes) const;
+    // Flattened-structure accessors for offload backends that upload
+    // the node array and leaf primitives to an accelerator
+    const LinearBVHNode *GetLinearNodes(int *count) const {
+        *count = this->nNodes;
+        return nodes;
+    }
+    const std::vector<std::shared_ptr<Primitive>> &GetPrimitives() const {
+        return primitives;
+    }
+    void IntersectPStream(Ray *rays, bool *hits, int nRays) const;
+    void Refit();
+
+  protected:
+    // BVHAccel Protected Methods
     BVHBuildNode *recursiveBuild(
         MemoryArena &arena, std::vector<BVHPrimitiveInfo> &primitiveInfo,
         int start, int end, int *totalNodes,
         std::vector<std::shared_ptr<Primitive>> &orderedPrims);
+    BVHBuildNode *spatialSplitBuild(
+        MemoryArena &arena, std::vector<BVHPrimitiveInfo> &refs,
+        int *totalNodes,
+        std::vector<std::shared_ptr<Primitive>> &orderedPrims);
+    BVHBuildNode *parallelSAHBuild(
+        MemoryArena &arena,
+        std::vector<std::unique_ptr<MemoryArena>> &subtreeArenas,
+        std::vector<BVHPrimitiveInfo> &primitiveInfo, int *totalNodes,
+        std::vector<std::shared_ptr<Primitive>> &orderedPrims);
     BVHBuildNode *HLBVHBuild(
         MemoryArena &arena, const std::vector<BVHPrimitiveInfo> &primitiveInfo,
         int *totalNodes,
@@ -85,11 +124,19 @@ class BVHAccel : public Aggregate {
                                 int start, int end, int *totalNodes) const;
     int flattenBVHTree(BVHBuildNode *node, int *offset);
 
-    // BVHAccel Private Data
+    // BVHAccel Protected Data
     const int maxPrimsInNode;
     const SplitMethod splitMethod;
+    // Maximum number of references the spatial-split build may create,
+    // as a multiple of the input primitive count.
+    const Float spatialSplitBudget;
+    size_t nSpatialRefs = 0;
     std::vector<std::shared_ptr<Primitive>> primitives;
     LinearBVHNode *nodes = nullptr;
+    int nNodes = 0;
+    // True when _nodes_ points into a cross-process shared segment
+    // (--sharedmem): never freed here, and never refit in place
+    bool nodesShared = false;
 };
 
 std::shared_ptr<BVHAccel> CreateBVHAccelerator(
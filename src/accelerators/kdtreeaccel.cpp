@@ -35,6 +35,7 @@
 #include "accelerators/kdtreeaccel.h"
 #include "paramset.h"
 #include "interaction.h"
+#include "parallel.h"
 #include "stats.h"
 #include <algorithm>
 
@@ -52,6 +53,25 @@ struct KdAccelNode {
     int SplitAxis() const { return flags & 3; }
     bool IsLeaf() const { return (flags & 3) == 3; }
     int AboveChild() const { return aboveChild >> 2; }
+    // Two-primitive leaves whose indices fit in 15 bits store them
+    // inline (bit 31 marks the encoding), skipping the side-vector
+    // indirection's dependent load
+    bool TwoInlinePrimitives() const {
+        return ((uint32_t)onePrimitive & 0x80000000u) != 0;
+    }
+    int InlinePrimitive(int i) const {
+        return (onePrimitive >> (15 * i)) & 0x7fff;
+    }
+    bool HasExternalIndices() const {
+        return nPrimitives() > 1 &&
+               !(nPrimitives() == 2 && TwoInlinePrimitives());
+    }
+    // Shift an interior node's above-child index when its subtree block
+    // is spliced into the final node array at _nodeBase_
+    void RebaseAboveChild(int nodeBase) { aboveChild += (nodeBase << 2); }
+    // Point an interior node at a new above-child position (used by
+    // the child-pair reordering pass)
+    void SetAboveChild(int ac) { aboveChild = (ac << 2) | (aboveChild & 3); }
     union {
         Float split;                 // Interior
         int onePrimitive;            // Leaf
@@ -78,6 +98,173 @@ struct BoundEdge {
     EdgeType type;
 };
 
+struct KdSplitChoice {
+    int bestAxis = -1, bestOffset = -1;
+    Float bestCost = Infinity;
+};
+
+// Evaluate every candidate split plane along _axis_ (whose edges must
+// already be sorted) and update _choice_ if a cheaper one is found
+static void EvalKdSplits(int axis, const BoundEdge *edges, int nPrimitives,
+                         const Bounds3f &nodeBounds, int isectCost,
+                         int traversalCost, Float emptyBonus,
+                         KdSplitChoice *choice) {
+    Float invTotalSA = 1 / nodeBounds.SurfaceArea();
+    Vector3f d = nodeBounds.pMax - nodeBounds.pMin;
+    int nBelow = 0, nAbove = nPrimitives;
+    for (int i = 0; i < 2 * nPrimitives; ++i) {
+        if (edges[i].type == EdgeType::End) --nAbove;
+        Float edgeT = edges[i].t;
+        if (edgeT > nodeBounds.pMin[axis] && edgeT < nodeBounds.pMax[axis]) {
+            // Compute cost for split at _i_th edge
+
+            // Compute child surface areas for split at _edgeT_
+            int otherAxis0 = (axis + 1) % 3, otherAxis1 = (axis + 2) % 3;
+            Float belowSA = 2 * (d[otherAxis0] * d[otherAxis1] +
+                                 (edgeT - nodeBounds.pMin[axis]) *
+                                     (d[otherAxis0] + d[otherAxis1]));
+            Float aboveSA = 2 * (d[otherAxis0] * d[otherAxis1] +
+                                 (nodeBounds.pMax[axis] - edgeT) *
+                                     (d[otherAxis0] + d[otherAxis1]));
+            Float pBelow = belowSA * invTotalSA;
+            Float pAbove = aboveSA * invTotalSA;
+            Float eb = (nAbove == 0 || nBelow == 0) ? emptyBonus : 0;
+            Float cost =
+                traversalCost +
+                isectCost * (1 - eb) * (pBelow * nBelow + pAbove * nAbove);
+
+            // Update best split if this is lowest cost so far
+            if (cost < choice->bestCost) {
+                choice->bestCost = cost;
+                choice->bestAxis = axis;
+                choice->bestOffset = i;
+            }
+        }
+        if (edges[i].type == EdgeType::Start) ++nBelow;
+    }
+    Assert(nBelow == nPrimitives && nAbove == 0);
+}
+
+// Select the best split for a node.  The serial path mirrors the
+// historical behavior: sort and evaluate the longest axis first and only
+// fall back to the others if no usable split is found.  With
+// _sortAxesInParallel_ set (used for large nodes near the top of the
+// tree), all three axes are initialized and sorted concurrently and the
+// best split over all of them is taken.
+static void ChooseKdSplit(const Bounds3f &nodeBounds,
+                          const std::vector<Bounds3f> &allPrimBounds,
+                          const int *primNums, int nPrimitives, int isectCost,
+                          int traversalCost, Float emptyBonus,
+                          const std::unique_ptr<BoundEdge[]> edges[3],
+                          bool sortAxesInParallel, KdSplitChoice *choice) {
+    auto initAxis = [&](int axis) {
+        // Initialize edges for _axis_
+        for (int i = 0; i < nPrimitives; ++i) {
+            int pn = primNums[i];
+            const Bounds3f &bounds = allPrimBounds[pn];
+            edges[axis][2 * i] = BoundEdge(bounds.pMin[axis], pn, true);
+            edges[axis][2 * i + 1] = BoundEdge(bounds.pMax[axis], pn, false);
+        }
+
+        // Sort _edges_ for _axis_
+        std::sort(&edges[axis][0], &edges[axis][2 * nPrimitives],
+                  [](const BoundEdge &e0, const BoundEdge &e1) -> bool {
+                      if (e0.t == e1.t)
+                          return (int)e0.type < (int)e1.type;
+                      else
+                          return e0.t < e1.t;
+                  });
+    };
+    if (sortAxesInParallel) {
+        ParallelFor([&](int64_t axis) { initAxis(axis); }, 3);
+        for (int axis = 0; axis < 3; ++axis)
+            EvalKdSplits(axis, &edges[axis][0], nPrimitives, nodeBounds,
+                         isectCost, traversalCost, emptyBonus, choice);
+    } else {
+        int axis = nodeBounds.MaximumExtent();
+        for (int retries = 0; retries < 3; ++retries) {
+            initAxis(axis);
+            EvalKdSplits(axis, &edges[axis][0], nPrimitives, nodeBounds,
+                         isectCost, traversalCost, emptyBonus, choice);
+            if (choice->bestAxis != -1) break;
+            axis = (axis + 1) % 3;
+        }
+    }
+}
+
+// Builds a kd-subtree into its own node and primitive-index arrays so
+// that disjoint subtrees can be built concurrently; the finished blocks
+// are spliced into the final tree with their child and index offsets
+// rebased.
+struct KdSubtreeBuilder {
+    KdSubtreeBuilder(int isectCost, int traversalCost, Float emptyBonus,
+                     int maxPrims, int nPrimitives, int maxDepth,
+                     const std::vector<Bounds3f> &allPrimBounds)
+        : isectCost(isectCost),
+          traversalCost(traversalCost),
+          maxPrims(maxPrims),
+          emptyBonus(emptyBonus),
+          allPrimBounds(allPrimBounds) {
+        for (int i = 0; i < 3; ++i)
+            edges[i].reset(new BoundEdge[2 * nPrimitives]);
+        prims0.reset(new int[nPrimitives]);
+        prims1.reset(new int[(maxDepth + 1) * nPrimitives]);
+    }
+    void build(const Bounds3f &nodeBounds, int *primNums, int nPrimitives,
+               int depth, int *p0, int *p1, int badRefines) {
+        int nodeNum = nodes.size();
+        nodes.push_back(KdAccelNode());
+
+        // Initialize leaf node if termination criteria met
+        if (nPrimitives <= maxPrims || depth == 0) {
+            nodes[nodeNum].InitLeaf(primNums, nPrimitives, &primitiveIndices);
+            return;
+        }
+
+        // Choose split axis position for interior node
+        KdSplitChoice choice;
+        ChooseKdSplit(nodeBounds, allPrimBounds, primNums, nPrimitives,
+                      isectCost, traversalCost, emptyBonus, edges, false,
+                      &choice);
+
+        // Create leaf if no good splits were found
+        Float oldCost = isectCost * Float(nPrimitives);
+        if (choice.bestCost > oldCost) ++badRefines;
+        if ((choice.bestCost > 4 * oldCost && nPrimitives < 16) ||
+            choice.bestAxis == -1 || badRefines == 3) {
+            nodes[nodeNum].InitLeaf(primNums, nPrimitives, &primitiveIndices);
+            return;
+        }
+        int bestAxis = choice.bestAxis, bestOffset = choice.bestOffset;
+
+        // Classify primitives with respect to split
+        int n0 = 0, n1 = 0;
+        for (int i = 0; i < bestOffset; ++i)
+            if (edges[bestAxis][i].type == EdgeType::Start)
+                p0[n0++] = edges[bestAxis][i].primNum;
+        for (int i = bestOffset + 1; i < 2 * nPrimitives; ++i)
+            if (edges[bestAxis][i].type == EdgeType::End)
+                p1[n1++] = edges[bestAxis][i].primNum;
+
+        // Recursively initialize children nodes
+        Float tSplit = edges[bestAxis][bestOffset].t;
+        Bounds3f bounds0 = nodeBounds, bounds1 = nodeBounds;
+        bounds0.pMax[bestAxis] = bounds1.pMin[bestAxis] = tSplit;
+        build(bounds0, p0, n0, depth - 1, p0, p1 + nPrimitives, badRefines);
+        int aboveChild = nodes.size();
+        nodes[nodeNum].InitInterior(bestAxis, aboveChild, tSplit);
+        build(bounds1, p1, n1, depth - 1, p0, p1 + nPrimitives, badRefines);
+    }
+
+    const int isectCost, traversalCost, maxPrims;
+    const Float emptyBonus;
+    const std::vector<Bounds3f> &allPrimBounds;
+    std::vector<KdAccelNode> nodes;
+    std::vector<int> primitiveIndices;
+    std::unique_ptr<BoundEdge[]> edges[3];
+    std::unique_ptr<int[]> prims0, prims1;
+};
+
 // KdTreeAccel Method Definitions
 KdTreeAccel::KdTreeAccel(const std::vector<std::shared_ptr<Primitive>> &p,
                          int isectCost, int traversalCost, Float emptyBonus,
@@ -112,9 +299,159 @@ KdTreeAccel::KdTreeAccel(const std::vector<std::shared_ptr<Primitive>> &p,
     std::unique_ptr<int[]> primNums(new int[primitives.size()]);
     for (size_t i = 0; i < primitives.size(); ++i) primNums[i] = i;
 
+    // Build subtrees as parallel tasks if the scene is large enough
+    const int nThreads = MaxThreadIndex();
+    const int taskThreshold =
+        std::max(4096, (int)(primitives.size() / (8 * nThreads)));
+    if (nThreads > 1 && (int)primitives.size() > 2 * taskThreshold) {
+        // Split the top of the tree on this thread, sorting the
+        // candidate edges of all three axes concurrently, until ranges
+        // fall below _taskThreshold_ and become subtree build tasks.
+        struct KdSkelNode {
+            int axis;
+            Float split;
+            int taskIndex = -1;
+            std::unique_ptr<KdSkelNode> below, above;
+        };
+        struct KdBuildTask {
+            std::vector<int> primNums;
+            Bounds3f bounds;
+            int depth, badRefines;
+        };
+        std::vector<KdBuildTask> tasks;
+        std::function<KdSkelNode *(const Bounds3f &, int *, int, int, int *,
+                                   int *, int)>
+            split = [&](const Bounds3f &nodeBounds, int *pn, int n, int depth,
+                        int *p0, int *p1, int badRefines) -> KdSkelNode * {
+            KdSkelNode *skel = new KdSkelNode;
+            auto makeTask = [&]() {
+                skel->taskIndex = tasks.size();
+                tasks.push_back({std::vector<int>(pn, pn + n), nodeBounds,
+                                 depth, badRefines});
+                return skel;
+            };
+            if (n <= taskThreshold || depth == 0) return makeTask();
+            KdSplitChoice choice;
+            ChooseKdSplit(nodeBounds, primBounds, pn, n, isectCost,
+                          traversalCost, emptyBonus, edges, true, &choice);
+            Float oldCost = isectCost * Float(n);
+            if (choice.bestCost > oldCost) ++badRefines;
+            if ((choice.bestCost > 4 * oldCost && n < 16) ||
+                choice.bestAxis == -1 || badRefines == 3)
+                return makeTask();
+            int bestAxis = choice.bestAxis, bestOffset = choice.bestOffset;
+            int n0 = 0, n1 = 0;
+            for (int i = 0; i < bestOffset; ++i)
+                if (edges[bestAxis][i].type == EdgeType::Start)
+                    p0[n0++] = edges[bestAxis][i].primNum;
+            for (int i = bestOffset + 1; i < 2 * n; ++i)
+                if (edges[bestAxis][i].type == EdgeType::End)
+                    p1[n1++] = edges[bestAxis][i].primNum;
+            Float tSplit = edges[bestAxis][bestOffset].t;
+            Bounds3f bounds0 = nodeBounds, bounds1 = nodeBounds;
+            bounds0.pMax[bestAxis] = bounds1.pMin[bestAxis] = tSplit;
+            skel->axis = bestAxis;
+            skel->split = tSplit;
+            skel->below.reset(
+                split(bounds0, p0, n0, depth - 1, p0, p1 + n, badRefines));
+            skel->above.reset(
+                split(bounds1, p1, n1, depth - 1, p0, p1 + n, badRefines));
+            return skel;
+        };
+        std::unique_ptr<KdSkelNode> root(
+            split(bounds, primNums.get(), primitives.size(), maxDepth,
+                  prims0.get(), prims1.get(), 0));
+
+        // Build each subtree task concurrently with its own builder
+        std::vector<std::unique_ptr<KdSubtreeBuilder>> builders(tasks.size());
+        ParallelFor([&](int64_t i) {
+            KdBuildTask &task = tasks[i];
+            builders[i].reset(new KdSubtreeBuilder(
+                isectCost, traversalCost, emptyBonus, maxPrims,
+                task.primNums.size(), task.depth, primBounds));
+            builders[i]->build(task.bounds, task.primNums.data(),
+                               task.primNums.size(), task.depth,
+                               builders[i]->prims0.get(),
+                               builders[i]->prims1.get(), task.badRefines);
+        }, tasks.size());
+
+        // Splice skeleton and subtree blocks into the final node array
+        std::function<int(const KdSkelNode *)> countNodes =
+            [&](const KdSkelNode *s) -> int {
+            if (s->taskIndex >= 0)
+                return builders[s->taskIndex]->nodes.size();
+            return 1 + countNodes(s->below.get()) + countNodes(s->above.get());
+        };
+        int totalNodes = countNodes(root.get());
+        nodes = AllocAligned<KdAccelNode>(totalNodes);
+        nAllocedNodes = totalNodes;
+        std::function<int(const KdSkelNode *)> emit =
+            [&](const KdSkelNode *s) -> int {
+            if (s->taskIndex >= 0) {
+                // Copy the subtree block, rebasing child and index
+                // offsets to their final positions
+                KdSubtreeBuilder &b = *builders[s->taskIndex];
+                int nodeBase = nextFreeNode;
+                int indexBase = primitiveIndices.size();
+                primitiveIndices.insert(primitiveIndices.end(),
+                                        b.primitiveIndices.begin(),
+                                        b.primitiveIndices.end());
+                for (KdAccelNode n : b.nodes) {
+                    if (n.IsLeaf()) {
+                        if (n.HasExternalIndices())
+                            n.primitiveIndicesOffset += indexBase;
+                    } else
+                        n.RebaseAboveChild(nodeBase);
+                    nodes[nextFreeNode++] = n;
+                }
+                return nodeBase;
+            }
+            int nodeNum = nextFreeNode++;
+            int belowChild = emit(s->below.get());
+            Assert(belowChild == nodeNum + 1);
+            (void)belowChild;
+            int aboveChild = emit(s->above.get());
+            nodes[nodeNum].InitInterior(s->axis, aboveChild, s->split);
+            return nodeNum;
+        };
+        emit(root.get());
+        Assert(nextFreeNode == totalNodes);
+        ReorderChildPairs();
+        return;
+    }
+
     // Start recursive construction of kd-tree
     buildTree(0, bounds, primBounds, primNums.get(), primitives.size(),
               maxDepth, edges, prims0.get(), prims1.get());
+    ReorderChildPairs();
+}
+
+// Re-lay out the node array so that each interior node's two children
+// are adjacent (above = below + 1): descending to either child then
+// touches the same cache line about half the time, where the build
+// order's preorder spine only helps the below chain.  Child links are
+// rewritten for the new positions.
+void KdTreeAccel::ReorderChildPairs() {
+    if (nextFreeNode <= 1) return;
+    std::vector<KdAccelNode> reordered(nextFreeNode);
+    std::vector<std::pair<int, int>> stack;  // old index, new index
+    int next = 1;
+    stack.push_back(std::make_pair(0, 0));
+    while (!stack.empty()) {
+        int oldIndex = stack.back().first, newIndex = stack.back().second;
+        stack.pop_back();
+        KdAccelNode node = nodes[oldIndex];
+        if (!node.IsLeaf()) {
+            int newBelow = next++, newAbove = next++;
+            int oldAbove = node.AboveChild();
+            node.SetAboveChild(newAbove);
+            stack.push_back(std::make_pair(oldIndex + 1, newBelow));
+            stack.push_back(std::make_pair(oldAbove, newAbove));
+        }
+        reordered[newIndex] = node;
+    }
+    Assert(next == nextFreeNode);
+    memcpy(nodes, &reordered[0], nextFreeNode * sizeof(KdAccelNode));
 }
 
 void KdAccelNode::InitLeaf(int *primNums, int np,
@@ -126,7 +463,12 @@ void KdAccelNode::InitLeaf(int *primNums, int np,
         onePrimitive = 0;
     else if (np == 1)
         onePrimitive = primNums[0];
-    else {
+    else if (np == 2 && primNums[0] < 0x7fff && primNums[1] < 0x7fff) {
+        // Inline both indices in the node (see TwoInlinePrimitives())
+        onePrimitive =
+            (int)(0x80000000u | (uint32_t)primNums[0] |
+                  ((uint32_t)primNums[1] << 15));
+    } else {
         primitiveIndicesOffset = primitiveIndices->size();
         for (int i = 0; i < np; ++i) primitiveIndices->push_back(primNums[i]);
     }
@@ -162,81 +504,19 @@ void KdTreeAccel::buildTree(int nodeNum, const Bounds3f &nodeBounds,
     // Initialize interior node and continue recursion
 
     // Choose split axis position for interior node
-    int bestAxis = -1, bestOffset = -1;
-    Float bestCost = Infinity;
-    Float oldCost = isectCost * Float(nPrimitives);
-    Float totalSA = nodeBounds.SurfaceArea();
-    Float invTotalSA = 1 / totalSA;
-    Vector3f d = nodeBounds.pMax - nodeBounds.pMin;
-
-    // Choose which axis to split along
-    int axis = nodeBounds.MaximumExtent();
-    int retries = 0;
-retrySplit:
-
-    // Initialize edges for _axis_
-    for (int i = 0; i < nPrimitives; ++i) {
-        int pn = primNums[i];
-        const Bounds3f &bounds = allPrimBounds[pn];
-        edges[axis][2 * i] = BoundEdge(bounds.pMin[axis], pn, true);
-        edges[axis][2 * i + 1] = BoundEdge(bounds.pMax[axis], pn, false);
-    }
-
-    // Sort _edges_ for _axis_
-    std::sort(&edges[axis][0], &edges[axis][2 * nPrimitives],
-              [](const BoundEdge &e0, const BoundEdge &e1) -> bool {
-                  if (e0.t == e1.t)
-                      return (int)e0.type < (int)e1.type;
-                  else
-                      return e0.t < e1.t;
-              });
-
-    // Compute cost of all splits for _axis_ to find best
-    int nBelow = 0, nAbove = nPrimitives;
-    for (int i = 0; i < 2 * nPrimitives; ++i) {
-        if (edges[axis][i].type == EdgeType::End) --nAbove;
-        Float edgeT = edges[axis][i].t;
-        if (edgeT > nodeBounds.pMin[axis] && edgeT < nodeBounds.pMax[axis]) {
-            // Compute cost for split at _i_th edge
-
-            // Compute child surface areas for split at _edgeT_
-            int otherAxis0 = (axis + 1) % 3, otherAxis1 = (axis + 2) % 3;
-            Float belowSA = 2 * (d[otherAxis0] * d[otherAxis1] +
-                                 (edgeT - nodeBounds.pMin[axis]) *
-                                     (d[otherAxis0] + d[otherAxis1]));
-            Float aboveSA = 2 * (d[otherAxis0] * d[otherAxis1] +
-                                 (nodeBounds.pMax[axis] - edgeT) *
-                                     (d[otherAxis0] + d[otherAxis1]));
-            Float pBelow = belowSA * invTotalSA;
-            Float pAbove = aboveSA * invTotalSA;
-            Float eb = (nAbove == 0 || nBelow == 0) ? emptyBonus : 0;
-            Float cost =
-                traversalCost +
-                isectCost * (1 - eb) * (pBelow * nBelow + pAbove * nAbove);
-
-            // Update best split if this is lowest cost so far
-            if (cost < bestCost) {
-                bestCost = cost;
-                bestAxis = axis;
-                bestOffset = i;
-            }
-        }
-        if (edges[axis][i].type == EdgeType::Start) ++nBelow;
-    }
-    Assert(nBelow == nPrimitives && nAbove == 0);
+    KdSplitChoice choice;
+    ChooseKdSplit(nodeBounds, allPrimBounds, primNums, nPrimitives, isectCost,
+                  traversalCost, emptyBonus, edges, false, &choice);
 
     // Create leaf if no good splits were found
-    if (bestAxis == -1 && retries < 2) {
-        ++retries;
-        axis = (axis + 1) % 3;
-        goto retrySplit;
-    }
-    if (bestCost > oldCost) ++badRefines;
-    if ((bestCost > 4 * oldCost && nPrimitives < 16) || bestAxis == -1 ||
-        badRefines == 3) {
+    Float oldCost = isectCost * Float(nPrimitives);
+    if (choice.bestCost > oldCost) ++badRefines;
+    if ((choice.bestCost > 4 * oldCost && nPrimitives < 16) ||
+        choice.bestAxis == -1 || badRefines == 3) {
         nodes[nodeNum].InitLeaf(primNums, nPrimitives, &primitiveIndices);
         return;
     }
+    int bestAxis = choice.bestAxis, bestOffset = choice.bestOffset;
 
     // Classify primitives with respect to split
     int n0 = 0, n1 = 0;
@@ -292,11 +572,11 @@ bool KdTreeAccel::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
                 (ray.o[axis] < node->SplitPos()) ||
                 (ray.o[axis] == node->SplitPos() && ray.d[axis] <= 0);
             if (belowFirst) {
-                firstChild = node + 1;
+                firstChild = &nodes[node->AboveChild() - 1];
                 secondChild = &nodes[node->AboveChild()];
             } else {
                 firstChild = &nodes[node->AboveChild()];
-                secondChild = node + 1;
+                secondChild = &nodes[node->AboveChild() - 1];
             }
 
             // Advance to next child node, possibly enqueue other child
@@ -321,6 +601,12 @@ bool KdTreeAccel::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
                     primitives[node->onePrimitive];
                 // Check one primitive inside leaf node
                 if (p->Intersect(ray, isect)) hit = true;
+            } else if (nPrimitives == 2 && node->TwoInlinePrimitives()) {
+                for (int i = 0; i < 2; ++i) {
+                    const std::shared_ptr<Primitive> &p =
+                        primitives[node->InlinePrimitive(i)];
+                    if (p->Intersect(ray, isect)) hit = true;
+                }
             } else {
                 for (int i = 0; i < nPrimitives; ++i) {
                     int index =
@@ -368,6 +654,12 @@ bool KdTreeAccel::IntersectP(const Ray &ray) const {
                 if (p->IntersectP(ray)) {
                     return true;
                 }
+            } else if (nPrimitives == 2 && node->TwoInlinePrimitives()) {
+                for (int i = 0; i < 2; ++i) {
+                    const std::shared_ptr<Primitive> &p =
+                        primitives[node->InlinePrimitive(i)];
+                    if (p->IntersectP(ray)) return true;
+                }
             } else {
                 for (int i = 0; i < nPrimitives; ++i) {
                     int primitiveIndex =
@@ -401,11 +693,11 @@ bool KdTreeAccel::IntersectP(const Ray &ray) const {
                 (ray.o[axis] < node->SplitPos()) ||
                 (ray.o[axis] == node->SplitPos() && ray.d[axis] <= 0);
             if (belowFirst) {
-                firstChild = node + 1;
+                firstChild = &nodes[node->AboveChild() - 1];
                 secondChild = &nodes[node->AboveChild()];
             } else {
                 firstChild = &nodes[node->AboveChild()];
-                secondChild = node + 1;
+                secondChild = &nodes[node->AboveChild() - 1];
             }
 
             // Advance to next child node, possibly enqueue other child
@@ -58,6 +58,7 @@ class KdTreeAccel : public Aggregate {
 
   private:
     // KdTreeAccel Private Methods
+    void ReorderChildPairs();
     void buildTree(int nodeNum, const Bounds3f &bounds,
                    const std::vector<Bounds3f> &primBounds, int *primNums,
                    int nprims, int depth,
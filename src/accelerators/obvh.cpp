@@ -0,0 +1,416 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// accelerators/obvh.cpp*
+#include "accelerators/obvh.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "stats.h"
+#include <algorithm>
+
+#if defined(__AVX2__) && !defined(PBRT_FLOAT_AS_DOUBLE)
+#include <immintrin.h>
+#define PBRT_OBVH_HAVE_AVX2
+#endif
+
+STAT_MEMORY_COUNTER("Memory/OBVH tree", obvhTreeBytes);
+STAT_COUNTER("OBVH/8-wide nodes", obvhNodeCount);
+
+// A quantized 8-wide node: child bounds are stored as 8-bit offsets
+// from the node's union box, rounded outward so that the decompressed
+// bounds conservatively contain the originals.  Roughly a third the
+// size of an uncompressed OBVHNode.
+struct CompressedOBVHNode {
+    Float origin[3];
+    Float scale[3];
+    uint8_t qMin[3][8];
+    uint8_t qMax[3][8];
+    int32_t child[8];
+    uint16_t nPrimitives[8];
+};
+
+// OBVHAccel Local Declarations
+
+// An 8-wide BVH node storing the child bounds in structure-of-arrays
+// layout so that a single ray can be tested against all eight child
+// boxes at once.  Lanes are interpreted as follows: _nPrimitives[i]_ > 0
+// denotes a leaf whose primitives start at _child[i]_; _nPrimitives[i]_
+// == 0 with _child[i]_ >= 0 denotes an interior child node; _child[i]_
+// < 0 marks an unused lane (its bounds are degenerate so the box test
+// always fails).
+struct OBVHNode {
+    Float boundsMin[3][8];
+    Float boundsMax[3][8];
+    int32_t child[8];
+    uint16_t nPrimitives[8];
+};
+
+// Test the ray against all eight child boxes of _node_; returns a bit
+// mask of the lanes that were hit and writes the entry distance for each
+// hit lane to _tNear_.  Follows the conservative slab test used by
+// Bounds3::IntersectP, including the 2*gamma(3) expansion of tFar.
+// Slabs are selected by _dirIsNeg_ and accumulated with the NaN
+// operand first, so a 0 * inf slab distance (an axis-aligned ray
+// whose origin lies exactly on a slab plane) drops out as "no
+// constraint" exactly as the scalar reference's comparisons do,
+// instead of poisoning the interval and culling the subtree.
+static inline int IntersectBounds8(const OBVHNode &node, const Point3f &o,
+                                   const Vector3f &invDir,
+                                   const int dirIsNeg[3], Float rayTMax,
+                                   Float *tNear) {
+    const float *nearBounds[3], *farBounds[3];
+    for (int a = 0; a < 3; ++a) {
+        nearBounds[a] = dirIsNeg[a] ? node.boundsMax[a] : node.boundsMin[a];
+        farBounds[a] = dirIsNeg[a] ? node.boundsMin[a] : node.boundsMax[a];
+    }
+#ifdef PBRT_OBVH_HAVE_AVX2
+    __m256 ox = _mm256_set1_ps(o.x), oy = _mm256_set1_ps(o.y),
+           oz = _mm256_set1_ps(o.z);
+    __m256 ix = _mm256_set1_ps(invDir.x), iy = _mm256_set1_ps(invDir.y),
+           iz = _mm256_set1_ps(invDir.z);
+    __m256 errScale = _mm256_set1_ps(1 + 2 * gamma(3));
+    // max/min return their second operand when the first is NaN, so
+    // accumulating with the slab distance first drops NaN lanes
+    __m256 tMin = _mm256_setzero_ps();
+    tMin = _mm256_max_ps(
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(nearBounds[0]), ox), ix),
+        tMin);
+    tMin = _mm256_max_ps(
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(nearBounds[1]), oy), iy),
+        tMin);
+    tMin = _mm256_max_ps(
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(nearBounds[2]), oz), iz),
+        tMin);
+    __m256 tMax = _mm256_set1_ps(rayTMax);
+    tMax = _mm256_min_ps(
+        _mm256_mul_ps(
+            _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(farBounds[0]), ox),
+                          ix),
+            errScale),
+        tMax);
+    tMax = _mm256_min_ps(
+        _mm256_mul_ps(
+            _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(farBounds[1]), oy),
+                          iy),
+            errScale),
+        tMax);
+    tMax = _mm256_min_ps(
+        _mm256_mul_ps(
+            _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(farBounds[2]), oz),
+                          iz),
+            errScale),
+        tMax);
+    _mm256_storeu_ps(tNear, tMin);
+    return _mm256_movemask_ps(_mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ));
+#else
+    const Float oArr[3] = {o.x, o.y, o.z};
+    const Float invArr[3] = {invDir.x, invDir.y, invDir.z};
+    const Float errScale = 1 + 2 * gamma(3);
+    int mask = 0;
+    for (int i = 0; i < 8; ++i) {
+        Float tMin = 0, tMax = rayTMax;
+        for (int a = 0; a < 3; ++a) {
+            Float tN = (nearBounds[a][i] - oArr[a]) * invArr[a];
+            Float tF = (farBounds[a][i] - oArr[a]) * invArr[a] * errScale;
+            // NaN comparisons are false, so a NaN slab leaves the
+            // interval unchanged
+            if (tN > tMin) tMin = tN;
+            if (tF < tMax) tMax = tF;
+        }
+        tNear[i] = tMin;
+        if (tMin <= tMax) mask |= 1 << i;
+    }
+    return mask;
+#endif  // PBRT_OBVH_HAVE_AVX2
+}
+
+// OBVHAccel Method Definitions
+OBVHAccel::OBVHAccel(const std::vector<std::shared_ptr<Primitive>> &p,
+                     int maxPrimsInNode, SplitMethod splitMethod,
+                     bool quantizeBounds)
+    : BVHAccel(p, maxPrimsInNode, splitMethod) {
+    // Collapse the binary BVH into 8-wide nodes; a single-leaf tree is
+    // left alone and handled by the base class traversal.
+    if (!nodes || nodes[0].nPrimitives > 0) return;
+    obvhNodes.reserve(primitives.size() / 4);
+    collapseBVHTree(0);
+    obvhNodes.shrink_to_fit();
+    obvhNodeCount += obvhNodes.size();
+    if (quantizeBounds) {
+        quantizeNodes();
+        obvhTreeBytes += compressedNodes.size() * sizeof(CompressedOBVHNode);
+    } else
+        obvhTreeBytes += obvhNodes.size() * sizeof(OBVHNode);
+}
+
+OBVHAccel::~OBVHAccel() {}
+
+int OBVHAccel::collapseBVHTree(int linearNodeIndex) {
+    int obvhIndex = obvhNodes.size();
+    obvhNodes.push_back(OBVHNode());
+
+    // Gather up to eight descendants of _linearNodeIndex_ to become the
+    // children of the 8-wide node, greedily expanding the interior
+    // candidate with the largest surface area so that large boxes are
+    // culled as early as possible.
+    int slots[8] = {linearNodeIndex + 1,
+                    nodes[linearNodeIndex].secondChildOffset};
+    int nSlots = 2;
+    while (nSlots < 8) {
+        int expand = -1;
+        Float maxArea = 0;
+        for (int i = 0; i < nSlots; ++i) {
+            if (nodes[slots[i]].nPrimitives > 0) continue;
+            Float area = nodes[slots[i]].bounds.SurfaceArea();
+            if (expand == -1 || area > maxArea) {
+                expand = i;
+                maxArea = area;
+            }
+        }
+        if (expand == -1) break;
+        int interior = slots[expand];
+        slots[expand] = interior + 1;
+        slots[nSlots++] = nodes[interior].secondChildOffset;
+    }
+
+    // Initialize the lanes of the 8-wide node; recursion below may grow
+    // _obvhNodes_, so the node is re-addressed by index each iteration.
+    for (int i = 0; i < 8; ++i) {
+        if (i >= nSlots) {
+            // Mark unused lane with degenerate bounds
+            OBVHNode &node = obvhNodes[obvhIndex];
+            for (int d = 0; d < 3; ++d) {
+                node.boundsMin[d][i] = Infinity;
+                node.boundsMax[d][i] = -Infinity;
+            }
+            node.child[i] = -1;
+            node.nPrimitives[i] = 0;
+            continue;
+        }
+        const LinearBVHNode &ln = nodes[slots[i]];
+        int32_t child;
+        if (ln.nPrimitives > 0)
+            child = ln.primitivesOffset;
+        else
+            child = collapseBVHTree(slots[i]);
+        OBVHNode &node = obvhNodes[obvhIndex];
+        for (int d = 0; d < 3; ++d) {
+            node.boundsMin[d][i] = ln.bounds.pMin[d];
+            node.boundsMax[d][i] = ln.bounds.pMax[d];
+        }
+        node.child[i] = child;
+        node.nPrimitives[i] = ln.nPrimitives;
+    }
+    return obvhIndex;
+}
+
+void OBVHAccel::quantizeNodes() {
+    compressedNodes.resize(obvhNodes.size());
+    for (size_t i = 0; i < obvhNodes.size(); ++i) {
+        const OBVHNode &n = obvhNodes[i];
+        CompressedOBVHNode &c = compressedNodes[i];
+        // Compute union of the live lanes' bounds
+        Bounds3f nodeBounds;
+        for (int lane = 0; lane < 8; ++lane) {
+            if (n.child[lane] < 0 && n.nPrimitives[lane] == 0) continue;
+            for (int d = 0; d < 3; ++d) {
+                nodeBounds.pMin[d] =
+                    std::min(nodeBounds.pMin[d], n.boundsMin[d][lane]);
+                nodeBounds.pMax[d] =
+                    std::max(nodeBounds.pMax[d], n.boundsMax[d][lane]);
+            }
+        }
+        for (int d = 0; d < 3; ++d) {
+            c.origin[d] = nodeBounds.pMin[d];
+            Float extent = nodeBounds.pMax[d] - nodeBounds.pMin[d];
+            c.scale[d] = extent > 0 ? extent / 255 : (Float)0;
+            for (int lane = 0; lane < 8; ++lane) {
+                if (n.child[lane] < 0 && n.nPrimitives[lane] == 0) {
+                    // Dead lane: decompresses to an inverted box
+                    c.qMin[d][lane] = 255;
+                    c.qMax[d][lane] = 0;
+                    continue;
+                }
+                if (c.scale[d] == 0) {
+                    c.qMin[d][lane] = c.qMax[d][lane] = 0;
+                    continue;
+                }
+                c.qMin[d][lane] = (uint8_t)Clamp(
+                    std::floor((n.boundsMin[d][lane] - c.origin[d]) /
+                               c.scale[d]),
+                    (Float)0, (Float)255);
+                c.qMax[d][lane] = (uint8_t)Clamp(
+                    std::ceil((n.boundsMax[d][lane] - c.origin[d]) /
+                              c.scale[d]),
+                    (Float)0, (Float)255);
+            }
+        }
+        for (int lane = 0; lane < 8; ++lane) {
+            c.child[lane] = n.child[lane];
+            c.nPrimitives[lane] = n.nPrimitives[lane];
+        }
+    }
+    // Release the uncompressed layout
+    std::vector<OBVHNode>().swap(obvhNodes);
+}
+
+void OBVHAccel::decompressNode(int index, OBVHNode *node) const {
+    const CompressedOBVHNode &c = compressedNodes[index];
+    for (int d = 0; d < 3; ++d)
+        for (int lane = 0; lane < 8; ++lane) {
+            node->boundsMin[d][lane] =
+                c.origin[d] + c.qMin[d][lane] * c.scale[d];
+            node->boundsMax[d][lane] =
+                c.origin[d] + c.qMax[d][lane] * c.scale[d];
+        }
+    for (int lane = 0; lane < 8; ++lane) {
+        node->child[lane] = c.child[lane];
+        node->nPrimitives[lane] = c.nPrimitives[lane];
+    }
+}
+
+bool OBVHAccel::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
+    if (obvhNodes.empty() && compressedNodes.empty())
+        return BVHAccel::Intersect(ray, isect);
+    ProfilePhase p(Prof::AccelIntersect);
+    bool hit = false;
+    Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+    int dirIsNeg[3] = {invDir.x < 0, invDir.y < 0, invDir.z < 0};
+    // Follow ray through 8-wide BVH nodes to find primitive intersections
+    int toVisitOffset = 0, currentNodeIndex = 0;
+    int nodesToVisit[256];
+    OBVHNode scratch;
+    while (true) {
+        const OBVHNode &node =
+            compressedNodes.empty()
+                ? obvhNodes[currentNodeIndex]
+                : (decompressNode(currentNodeIndex, &scratch), scratch);
+        Float tNear[8];
+        int mask =
+            IntersectBounds8(node, ray.o, invDir, dirIsNeg, ray.tMax, tNear);
+        // Intersect leaf lanes and collect hit interior lanes
+        int interior[8], nInterior = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (!(mask & (1 << i)) || node.child[i] < 0) continue;
+            if (node.nPrimitives[i] > 0) {
+                for (int j = 0; j < node.nPrimitives[i]; ++j)
+                    if (primitives[node.child[i] + j]->Intersect(ray, isect))
+                        hit = true;
+            } else
+                interior[nInterior++] = i;
+        }
+        // Sort hit interior lanes by entry distance and push far-to-near
+        for (int i = 1; i < nInterior; ++i) {
+            int lane = interior[i];
+            int j = i - 1;
+            while (j >= 0 && tNear[interior[j]] < tNear[lane]) {
+                interior[j + 1] = interior[j];
+                --j;
+            }
+            interior[j + 1] = lane;
+        }
+        for (int i = 0; i < nInterior - 1; ++i)
+            nodesToVisit[toVisitOffset++] = node.child[interior[i]];
+        if (nInterior > 0)
+            currentNodeIndex = node.child[interior[nInterior - 1]];
+        else {
+            if (toVisitOffset == 0) break;
+            currentNodeIndex = nodesToVisit[--toVisitOffset];
+        }
+    }
+    return hit;
+}
+
+bool OBVHAccel::IntersectP(const Ray &ray) const {
+    if (obvhNodes.empty() && compressedNodes.empty())
+        return BVHAccel::IntersectP(ray);
+    ProfilePhase p(Prof::AccelIntersectP);
+    Vector3f invDir(1 / ray.d.x, 1 / ray.d.y, 1 / ray.d.z);
+    int dirIsNeg[3] = {invDir.x < 0, invDir.y < 0, invDir.z < 0};
+    int toVisitOffset = 0, currentNodeIndex = 0;
+    int nodesToVisit[256];
+    OBVHNode scratch;
+    while (true) {
+        const OBVHNode &node =
+            compressedNodes.empty()
+                ? obvhNodes[currentNodeIndex]
+                : (decompressNode(currentNodeIndex, &scratch), scratch);
+        Float tNear[8];
+        int mask =
+            IntersectBounds8(node, ray.o, invDir, dirIsNeg, ray.tMax, tNear);
+        int nInterior = 0;
+        int interior[8];
+        for (int i = 0; i < 8; ++i) {
+            if (!(mask & (1 << i)) || node.child[i] < 0) continue;
+            if (node.nPrimitives[i] > 0) {
+                for (int j = 0; j < node.nPrimitives[i]; ++j)
+                    if (primitives[node.child[i] + j]->IntersectP(ray))
+                        return true;
+            } else
+                interior[nInterior++] = i;
+        }
+        for (int i = 0; i < nInterior - 1; ++i)
+            nodesToVisit[toVisitOffset++] = node.child[interior[i]];
+        if (nInterior > 0)
+            currentNodeIndex = node.child[interior[nInterior - 1]];
+        else {
+            if (toVisitOffset == 0) break;
+            currentNodeIndex = nodesToVisit[--toVisitOffset];
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<OBVHAccel> CreateOBVHAccelerator(
+    const std::vector<std::shared_ptr<Primitive>> &prims, const ParamSet &ps) {
+    std::string splitMethodName = ps.FindOneString("splitmethod", "sah");
+    BVHAccel::SplitMethod splitMethod;
+    if (splitMethodName == "sah")
+        splitMethod = BVHAccel::SplitMethod::SAH;
+    else if (splitMethodName == "hlbvh")
+        splitMethod = BVHAccel::SplitMethod::HLBVH;
+    else if (splitMethodName == "middle")
+        splitMethod = BVHAccel::SplitMethod::Middle;
+    else if (splitMethodName == "equal")
+        splitMethod = BVHAccel::SplitMethod::EqualCounts;
+    else {
+        Warning("BVH split method \"%s\" unknown.  Using \"sah\".",
+                splitMethodName.c_str());
+        splitMethod = BVHAccel::SplitMethod::SAH;
+    }
+
+    int maxPrimsInNode = ps.FindOneInt("maxnodeprims", 4);
+    bool quantize = ps.FindOneBool("quantize", false);
+    return std::make_shared<OBVHAccel>(prims, maxPrimsInNode, splitMethod,
+                                       quantize);
+}
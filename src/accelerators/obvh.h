@@ -0,0 +1,74 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_ACCELERATORS_OBVH_H
+#define PBRT_ACCELERATORS_OBVH_H
+
+// accelerators/obvh.h*
+#include "pbrt.h"
+#include "accelerators/bvh.h"
+
+struct OBVHNode;
+struct CompressedOBVHNode;
+
+// OBVHAccel Declarations
+class OBVHAccel : public BVHAccel {
+  public:
+    // OBVHAccel Public Methods
+    OBVHAccel(const std::vector<std::shared_ptr<Primitive>> &p,
+              int maxPrimsInNode = 1,
+              SplitMethod splitMethod = SplitMethod::SAH,
+              bool quantizeBounds = false);
+    ~OBVHAccel();
+    bool Intersect(const Ray &ray, SurfaceInteraction *isect) const;
+    bool IntersectP(const Ray &ray) const;
+
+  private:
+    // OBVHAccel Private Methods
+    int collapseBVHTree(int linearNodeIndex);
+    void quantizeNodes();
+    void decompressNode(int index, OBVHNode *node) const;
+
+    // OBVHAccel Private Data
+    std::vector<OBVHNode> obvhNodes;
+    std::vector<CompressedOBVHNode> compressedNodes;
+};
+
+std::shared_ptr<OBVHAccel> CreateOBVHAccelerator(
+    const std::vector<std::shared_ptr<Primitive>> &prims, const ParamSet &ps);
+
+#endif  // PBRT_ACCELERATORS_OBVH_H
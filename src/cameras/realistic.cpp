@@ -45,12 +45,91 @@
 STAT_PERCENT("Camera/Rays vignetted by lens system", vignettedRays, totalRays);
 
 // RealisticCamera Method Definitions
+// Lens cache file layout: _LensCacheHeader_, then the focused rear
+// element thickness, then the exit pupil bounds array verbatim.  The
+// key hashes the lens configuration, focus setting, and film diagonal,
+// so an animation whose lens doesn't change pays the exit-pupil
+// bounding once instead of per frame.
+struct LensCacheHeader {
+    uint32_t magic, version, floatSize, nSegments;
+    uint64_t key;
+};
+static const uint32_t lensCacheMagic = 0x534c4250;  // "PBLS"
+static const uint32_t lensCacheVersion = 1;
+
+static uint64_t HashLensConfiguration(const void *elementData,
+                                      size_t elementBytes,
+                                      Float apertureDiameter,
+                                      Float focusDistance, Float diagonal) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size) {
+        const unsigned char *bytes = (const unsigned char *)data;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(elementData, elementBytes);
+    mix(&apertureDiameter, sizeof(apertureDiameter));
+    mix(&focusDistance, sizeof(focusDistance));
+    mix(&diagonal, sizeof(diagonal));
+    return hash;
+}
+
+static bool ReadLensCache(const std::string &filename, uint64_t key,
+                          int nSegments, Float *rearThickness,
+                          Bounds2f *exitPupilBounds) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    LensCacheHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != lensCacheMagic ||
+        header.version != lensCacheVersion ||
+        header.floatSize != sizeof(Float) ||
+        header.nSegments != (uint32_t)nSegments || header.key != key) {
+        fclose(f);
+        return false;
+    }
+    bool ok = fread(rearThickness, sizeof(Float), 1, f) == 1 &&
+              fread(exitPupilBounds, sizeof(Bounds2f), nSegments, f) ==
+                  (size_t)nSegments;
+    fclose(f);
+    return ok;
+}
+
+static void WriteLensCache(const std::string &filename, uint64_t key,
+                           int nSegments, Float rearThickness,
+                           const Bounds2f *exitPupilBounds) {
+    // Write to a temporary file and rename into place so a partial
+    // write never leaves a torn cache entry
+    std::string tmpName = filename + ".tmp";
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (!f) return;
+    LensCacheHeader header;
+    header.magic = lensCacheMagic;
+    header.version = lensCacheVersion;
+    header.floatSize = sizeof(Float);
+    header.nSegments = nSegments;
+    header.key = key;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(&rearThickness, sizeof(Float), 1, f) == 1 &&
+              fwrite(exitPupilBounds, sizeof(Bounds2f), nSegments, f) ==
+                  (size_t)nSegments;
+    ok &= fclose(f) == 0;
+    if (!ok || rename(tmpName.c_str(), filename.c_str()) != 0) {
+        Warning("Unable to write lens cache \"%s\"", filename.c_str());
+        remove(tmpName.c_str());
+    }
+}
+
 RealisticCamera::RealisticCamera(const AnimatedTransform &CameraToWorld,
                                  Float shutterOpen, Float shutterClose,
                                  Float apertureDiameter, Float focusDistance,
                                  bool simpleWeighting,
                                  std::vector<Float> &lensData, Film *film,
-                                 const Medium *medium)
+                                 const Medium *medium,
+                                 const std::string &lensFile, bool rayProxy,
+                                 Float proxyError)
     : Camera(CameraToWorld, shutterOpen, shutterClose, film, medium),
       simpleWeighting(simpleWeighting) {
     for (int i = 0; i < (int)lensData.size(); i += 4) {
@@ -69,6 +148,25 @@ RealisticCamera::RealisticCamera(const AnimatedTransform &CameraToWorld,
              lensData[i + 2], lensData[i + 3] * Float(.001) / Float(2.)}));
     }
 
+    // Reuse the cached focus solution and exit pupil bounds when the
+    // lens configuration hasn't changed
+    int nSamples = 64;
+    exitPupilBounds.resize(nSamples);
+    uint64_t cacheKey = HashLensConfiguration(
+        elementInterfaces.data(),
+        elementInterfaces.size() * sizeof(LensElementInterface),
+        apertureDiameter, focusDistance, film->diagonal);
+    std::string cacheFilename =
+        lensFile.empty() ? "" : lensFile + ".lenscache";
+    if (!cacheFilename.empty() &&
+        ReadLensCache(cacheFilename, cacheKey, nSamples,
+                      &elementInterfaces.back().thickness,
+                      &exitPupilBounds[0])) {
+        Info("Loaded lens cache \"%s\"", cacheFilename.c_str());
+        if (rayProxy) useProxy = FitRayProxy(proxyError);
+        return;
+    }
+
     // Compute lens--film distance for given focus distance
     Float fb = FocusBinarySearch(focusDistance);
     Info("Binary search focus: %f -> %f\n", fb, FocusDistance(fb));
@@ -76,14 +174,191 @@ RealisticCamera::RealisticCamera(const AnimatedTransform &CameraToWorld,
     Info("Thick lens focus: %f -> %f\n", elementInterfaces.back().thickness,
          FocusDistance(elementInterfaces.back().thickness));
 
-    // Compute exit pupil bounds at sampled points on the film
-    int nSamples = 64;
-    exitPupilBounds.resize(nSamples);
+    // Compute exit pupil bounds at sampled points on the film (already
+    // parallel across the radial segments)
     ParallelFor([&](int i) {
         Float r0 = (Float)i / nSamples * film->diagonal / 2;
         Float r1 = (Float)(i + 1) / nSamples * film->diagonal / 2;
         exitPupilBounds[i] = BoundExitPupil(r0, r1);
     }, nSamples);
+
+    if (!cacheFilename.empty())
+        WriteLensCache(cacheFilename, cacheKey, nSamples,
+                       elementInterfaces.back().thickness,
+                       &exitPupilBounds[0]);
+
+    if (rayProxy) useProxy = FitRayProxy(proxyError);
+}
+
+// Evaluate the 35 monomials of total degree <= 4 in (x, y, z)
+static void ProxyBasis(Float x, Float y, Float z, Float *basis) {
+    Float xp[5] = {1, x, x * x, x * x * x, x * x * x * x};
+    Float yp[5] = {1, y, y * y, y * y * y, y * y * y * y};
+    Float zp[5] = {1, z, z * z, z * z * z, z * z * z * z};
+    int t = 0;
+    for (int i = 0; i <= 4; ++i)
+        for (int j = 0; i + j <= 4; ++j)
+            for (int k = 0; i + j + k <= 4; ++k)
+                basis[t++] = xp[i] * yp[j] * zp[k];
+}
+
+// Solve the n x n system A x = b in place by Gaussian elimination with
+// partial pivoting; returns false for a (numerically) singular system.
+static bool SolveLinearSystem(std::vector<double> &A, std::vector<double> &b,
+                              int n) {
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < n; ++row)
+            if (std::abs(A[row * n + col]) > std::abs(A[pivot * n + col]))
+                pivot = row;
+        if (std::abs(A[pivot * n + col]) < 1e-15) return false;
+        if (pivot != col) {
+            for (int k = 0; k < n; ++k)
+                std::swap(A[col * n + k], A[pivot * n + k]);
+            std::swap(b[col], b[pivot]);
+        }
+        for (int row = col + 1; row < n; ++row) {
+            double m = A[row * n + col] / A[col * n + col];
+            for (int k = col; k < n; ++k) A[row * n + k] -= m * A[col * n + k];
+            b[row] -= m * b[col];
+        }
+    }
+    for (int row = n - 1; row >= 0; --row) {
+        double sum = b[row];
+        for (int k = row + 1; k < n; ++k) sum -= A[row * n + k] * b[k];
+        b[row] = sum / A[row * n + row];
+    }
+    return true;
+}
+
+bool RealisticCamera::FitRayProxy(Float errorBound) {
+    // Input normalization scales: film radius and the widest pupil
+    // bound seen across the radial segments
+    proxyScaleR = 2 / film->diagonal;
+    Float maxPupil = 0;
+    for (const Bounds2f &b : exitPupilBounds)
+        for (int c = 0; c < 2; ++c)
+            maxPupil = std::max(
+                {maxPupil, std::abs(b.pMin[c]), std::abs(b.pMax[c])});
+    if (maxPupil == 0) return false;
+    proxyScaleUV = 1 / maxPupil;
+
+    // Collect exact-tracer samples over the canonical frame: film
+    // point (r, 0, 0), pupil point (u, v, rear z)
+    const int nR = 96, nPupil = 64;
+    std::vector<Float> inputs;   // r, u, v triples (normalized)
+    std::vector<Float> outputs;  // origin xyz, direction xyz
+    RNG rng(6023);
+    for (int i = 0; i < nR; ++i) {
+        Float r = (i + rng.UniformFloat()) / nR * film->diagonal / 2;
+        int rIndex = std::min((int)exitPupilBounds.size() - 1,
+                              int(r * proxyScaleR * exitPupilBounds.size()));
+        const Bounds2f &pupilBounds = exitPupilBounds[rIndex];
+        for (int j = 0; j < nPupil; ++j) {
+            Point2f pLens = pupilBounds.Lerp(
+                Point2f(rng.UniformFloat(), rng.UniformFloat()));
+            Ray rFilm(Point3f(r, 0, 0),
+                      Point3f(pLens.x, pLens.y, LensRearZ()) -
+                          Point3f(r, 0, 0));
+            Ray rOut;
+            if (!TraceLensesFromFilm(rFilm, &rOut)) continue;
+            Vector3f d = Normalize(rOut.d);
+            inputs.push_back(r * proxyScaleR);
+            inputs.push_back(pLens.x * proxyScaleUV);
+            inputs.push_back(pLens.y * proxyScaleUV);
+            outputs.push_back(rOut.o.x);
+            outputs.push_back(rOut.o.y);
+            outputs.push_back(rOut.o.z);
+            outputs.push_back(d.x);
+            outputs.push_back(d.y);
+            outputs.push_back(d.z);
+        }
+    }
+    int nSamples = (int)(inputs.size() / 3);
+    if (nSamples < 4 * NumProxyTerms) {
+        Warning("Lens ray proxy: too few unvignetted samples (%d); "
+                "keeping the exact tracer.",
+                nSamples);
+        return false;
+    }
+
+    // Fit each output by least squares over the shared monomial basis
+    std::vector<double> ata(NumProxyTerms * NumProxyTerms);
+    std::vector<double> atb[NumProxyOutputs];
+    for (int out = 0; out < NumProxyOutputs; ++out)
+        atb[out].assign(NumProxyTerms, 0.);
+    Float basis[NumProxyTerms];
+    for (int i = 0; i < nSamples; ++i) {
+        ProxyBasis(inputs[3 * i], inputs[3 * i + 1], inputs[3 * i + 2],
+                   basis);
+        for (int a = 0; a < NumProxyTerms; ++a) {
+            for (int b = a; b < NumProxyTerms; ++b)
+                ata[a * NumProxyTerms + b] += (double)basis[a] * basis[b];
+            for (int out = 0; out < NumProxyOutputs; ++out)
+                atb[out][a] +=
+                    (double)basis[a] * outputs[NumProxyOutputs * i + out];
+        }
+    }
+    for (int a = 0; a < NumProxyTerms; ++a)
+        for (int b = 0; b < a; ++b)
+            ata[a * NumProxyTerms + b] = ata[b * NumProxyTerms + a];
+    for (int out = 0; out < NumProxyOutputs; ++out) {
+        std::vector<double> A = ata;
+        if (!SolveLinearSystem(A, atb[out], NumProxyTerms)) {
+            Warning("Lens ray proxy: singular fit; keeping the exact "
+                    "tracer.");
+            return false;
+        }
+        for (int a = 0; a < NumProxyTerms; ++a)
+            proxyCoeffs[out][a] = (Float)atb[out][a];
+    }
+
+    // Validate against held-out exact traces: direction error in
+    // radians and origin error relative to the rear element radius
+    // must stay within _errorBound_
+    Float maxErr = 0;
+    for (int i = 0; i < 512; ++i) {
+        Float r = rng.UniformFloat() * film->diagonal / 2;
+        int rIndex = std::min((int)exitPupilBounds.size() - 1,
+                              int(r * proxyScaleR * exitPupilBounds.size()));
+        Point2f pLens = exitPupilBounds[rIndex].Lerp(
+            Point2f(rng.UniformFloat(), rng.UniformFloat()));
+        Ray rFilm(Point3f(r, 0, 0),
+                  Point3f(pLens.x, pLens.y, LensRearZ()) - Point3f(r, 0, 0));
+        Ray rExact, rProxy;
+        if (!TraceLensesFromFilm(rFilm, &rExact)) continue;
+        EvaluateRayProxy(r, pLens, &rProxy);
+        Float dirErr = std::acos(
+            Clamp(Dot(Normalize(rExact.d), Normalize(rProxy.d)), -1, 1));
+        Float orgErr =
+            Distance(rExact.o, rProxy.o) / std::max(RearElementRadius(),
+                                                    (Float)1e-6);
+        maxErr = std::max({maxErr, dirErr, orgErr});
+    }
+    if (maxErr > errorBound) {
+        Warning("Lens ray proxy: fit error %g exceeds bound %g; keeping "
+                "the exact tracer.",
+                maxErr, errorBound);
+        return false;
+    }
+    Info("Lens ray proxy: fit error %g within bound %g", maxErr, errorBound);
+    return true;
+}
+
+void RealisticCamera::EvaluateRayProxy(Float rFilm, const Point2f &pLens,
+                                       Ray *rOut) const {
+    Float basis[NumProxyTerms];
+    ProxyBasis(rFilm * proxyScaleR, pLens.x * proxyScaleUV,
+               pLens.y * proxyScaleUV, basis);
+    Float v[NumProxyOutputs];
+    for (int out = 0; out < NumProxyOutputs; ++out) {
+        Float sum = 0;
+        for (int a = 0; a < NumProxyTerms; ++a)
+            sum += proxyCoeffs[out][a] * basis[a];
+        v[out] = sum;
+    }
+    rOut->o = Point3f(v[0], v[1], v[2]);
+    rOut->d = Vector3f(v[3], v[4], v[5]);
 }
 
 bool RealisticCamera::TraceLensesFromFilm(const Ray &rCamera, Ray *rOut) const {
@@ -662,7 +937,29 @@ Float RealisticCamera::GenerateRay(const CameraSample &sample, Ray *ray) const {
                                     &exitPupilBoundsArea);
     Ray rFilm(pFilm, pRear - pFilm, Infinity,
               Lerp(sample.time, shutterOpen, shutterClose));
-    if (!TraceLensesFromFilm(rFilm, ray)) {
+    if (useProxy) {
+        // Evaluate the fitted polynomial in the canonical frame and
+        // rotate the result to the film point's azimuth; pupil-bound
+        // sampling already accounts for most vignetting, and residual
+        // vignetted rays are within the configured error budget
+        Float r = std::sqrt(pFilm.x * pFilm.x + pFilm.y * pFilm.y);
+        Float sinTheta = (r != 0) ? pFilm.y / r : 0;
+        Float cosTheta = (r != 0) ? pFilm.x / r : 1;
+        int rIndex = std::min((int)exitPupilBounds.size() - 1,
+                              int(r / (film->diagonal / 2) *
+                                  exitPupilBounds.size()));
+        Point2f pLens = exitPupilBounds[rIndex].Lerp(sample.pLens);
+        Ray rCanonical;
+        EvaluateRayProxy(r, pLens, &rCanonical);
+        ray->o = Point3f(cosTheta * rCanonical.o.x - sinTheta * rCanonical.o.y,
+                         sinTheta * rCanonical.o.x + cosTheta * rCanonical.o.y,
+                         rCanonical.o.z);
+        ray->d = Vector3f(cosTheta * rCanonical.d.x - sinTheta * rCanonical.d.y,
+                          sinTheta * rCanonical.d.x + cosTheta * rCanonical.d.y,
+                          rCanonical.d.z);
+        ray->time = rFilm.time;
+        ray->tMax = Infinity;
+    } else if (!TraceLensesFromFilm(rFilm, ray)) {
         ++vignettedRays;
         return 0;
     }
@@ -698,6 +995,8 @@ RealisticCamera *CreateRealisticCamera(const ParamSet &params,
     Float apertureDiameter = params.FindOneFloat("aperturediameter", 1.0);
     Float focusDistance = params.FindOneFloat("focusdistance", 10.0);
     bool simpleWeighting = params.FindOneBool("simpleweighting", true);
+    bool rayProxy = params.FindOneBool("rayproxy", false);
+    Float proxyError = params.FindOneFloat("proxyerror", 0.001f);
     if (lensFile == "") {
         Error("No lens description file supplied!");
         return nullptr;
@@ -719,5 +1018,6 @@ RealisticCamera *CreateRealisticCamera(const ParamSet &params,
 
     return new RealisticCamera(cam2world, shutteropen, shutterclose,
                                apertureDiameter, focusDistance, simpleWeighting,
-                               lensData, film, medium);
+                               lensData, film, medium, lensFile, rayProxy,
+                               proxyError);
 }
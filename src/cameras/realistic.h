@@ -51,7 +51,8 @@ class RealisticCamera : public Camera {
                     Float shutterClose, Float apertureDiameter,
                     Float focusDistance, bool simpleWeighting,
                     std::vector<Float> &lensData, Film *film,
-                    const Medium *medium);
+                    const Medium *medium, const std::string &lensFile = "",
+                    bool rayProxy = false, Float proxyError = 0.001f);
     Float GenerateRay(const CameraSample &sample, Ray *) const;
 
   private:
@@ -68,6 +69,18 @@ class RealisticCamera : public Camera {
     std::vector<LensElementInterface> elementInterfaces;
     std::vector<Bounds2f> exitPupilBounds;
 
+    // Polynomial proxy for the film-to-world ray mapping ("rayproxy"):
+    // degree-4 trivariate polynomials in the canonical frame (film
+    // point rotated onto +x, inputs r, u, v normalized to [-1,1]) fit
+    // against the exact tracer; evaluation replaces the per-element
+    // lens walk in GenerateRay when the fit met the error bound
+    static PBRT_CONSTEXPR int ProxyDegree = 4;
+    static PBRT_CONSTEXPR int NumProxyTerms = 35;  // C(ProxyDegree + 3, 3)
+    static PBRT_CONSTEXPR int NumProxyOutputs = 6;  // origin xyz, dir xyz
+    bool useProxy = false;
+    Float proxyCoeffs[NumProxyOutputs][NumProxyTerms];
+    Float proxyScaleR = 1, proxyScaleUV = 1;
+
     // RealisticCamera Private Methods
     Float LensRearZ() const { return elementInterfaces.back().thickness; }
     Float LensFrontZ() const {
@@ -99,6 +112,8 @@ class RealisticCamera : public Camera {
     void RenderExitPupil(Float sx, Float sy, const char *filename) const;
     Point3f SampleExitPupil(const Point2f &pFilm, const Point2f &lensSample,
                             Float *sampleBoundsArea) const;
+    bool FitRayProxy(Float errorBound);
+    void EvaluateRayProxy(Float rFilm, const Point2f &pLens, Ray *rOut) const;
     void TestExitPupilBounds() const;
 };
 
@@ -38,12 +38,14 @@
 #include "spectrum.h"
 #include "scene.h"
 #include "film.h"
+#include "imageio.h"
 #include "medium.h"
 #include "stats.h"
 
 // API Additional Headers
 #include "accelerators/bvh.h"
 #include "accelerators/kdtreeaccel.h"
+#include "accelerators/obvh.h"
 #include "cameras/environment.h"
 #include "cameras/orthographic.h"
 #include "cameras/perspective.h"
@@ -57,9 +59,12 @@
 #include "integrators/directlighting.h"
 #include "integrators/mlt.h"
 #include "integrators/path.h"
+#include "integrators/wavefrontpath.h"
+#include "integrators/gradientpath.h"
 #include "integrators/sppm.h"
 #include "integrators/volpath.h"
 #include "integrators/whitted.h"
+#include "integrators/vpl.h"
 #include "lights/diffuse.h"
 #include "lights/distant.h"
 #include "lights/goniometric.h"
@@ -84,6 +89,7 @@
 #include "samplers/random.h"
 #include "samplers/sobol.h"
 #include "samplers/stratified.h"
+#include "samplers/pmj02.h"
 #include "samplers/zerotwosequence.h"
 #include "shapes/cone.h"
 #include "shapes/curve.h"
@@ -111,12 +117,19 @@
 #include "textures/wrinkled.h"
 #include "media/grid.h"
 #include "media/homogeneous.h"
+#include <chrono>
 #include <map>
 #include <stdio.h>
+#if defined(PBRT_IS_LINUX) || defined(PBRT_IS_OSX)
+#include <sys/resource.h>
+#endif
 
 // API Global Variables
 Options PbrtOptions;
 
+// Wall-clock start of the parse phase, for --benchmark reporting
+static std::chrono::steady_clock::time_point benchParseStart;
+
 // API Local Classes
 PBRT_CONSTEXPR int MaxTransforms = 2;
 PBRT_CONSTEXPR int StartTransformBits = 1 << 0;
@@ -182,11 +195,41 @@ struct GraphicsState {
 
     // Graphics State
     std::string currentInsideMedium, currentOutsideMedium;
-    std::map<std::string, std::shared_ptr<Texture<Float>>> floatTextures;
-    std::map<std::string, std::shared_ptr<Texture<Spectrum>>> spectrumTextures;
+    // The texture and named-material tables are copy-on-write:
+    // AttributeBegin copies only the shared pointers, so deeply nested
+    // attribute blocks cost O(1) until a block actually adds an entry,
+    // at which point the Mutable* accessors clone the shared table
+    using FloatTextureMap =
+        std::map<std::string, std::shared_ptr<Texture<Float>>>;
+    using SpectrumTextureMap =
+        std::map<std::string, std::shared_ptr<Texture<Spectrum>>>;
+    using NamedMaterialMap =
+        std::map<std::string, std::shared_ptr<Material>>;
+    std::shared_ptr<FloatTextureMap> floatTextures =
+        std::make_shared<FloatTextureMap>();
+    std::shared_ptr<SpectrumTextureMap> spectrumTextures =
+        std::make_shared<SpectrumTextureMap>();
+    std::shared_ptr<NamedMaterialMap> namedMaterials =
+        std::make_shared<NamedMaterialMap>();
+    FloatTextureMap *MutableFloatTextures() {
+        if (!floatTextures.unique())
+            floatTextures = std::make_shared<FloatTextureMap>(*floatTextures);
+        return floatTextures.get();
+    }
+    SpectrumTextureMap *MutableSpectrumTextures() {
+        if (!spectrumTextures.unique())
+            spectrumTextures =
+                std::make_shared<SpectrumTextureMap>(*spectrumTextures);
+        return spectrumTextures.get();
+    }
+    NamedMaterialMap *MutableNamedMaterials() {
+        if (!namedMaterials.unique())
+            namedMaterials =
+                std::make_shared<NamedMaterialMap>(*namedMaterials);
+        return namedMaterials.get();
+    }
     ParamSet materialParams;
     std::string material = "matte";
-    std::map<std::string, std::shared_ptr<Material>> namedMaterials;
     std::string currentNamedMaterial;
     ParamSet areaLightParams;
     std::string areaLight;
@@ -196,31 +239,189 @@ struct GraphicsState {
 class TransformCache {
   public:
     // TransformCache Public Methods
+    TransformCache() { entries.resize(512); }
     void Lookup(const Transform &t, Transform **tCached,
                 Transform **tCachedInverse) {
-        auto iter = cache.find(t);
-        if (iter == cache.end()) {
-            Transform *tr = arena.Alloc<Transform>();
-            *tr = t;
-            Transform *tinv = arena.Alloc<Transform>();
-            *tinv = Transform(Inverse(t));
-            cache[t] = std::make_pair(tr, tinv);
-            iter = cache.find(t);
+        // Open-addressed probe keyed on a hash of the matrix bytes;
+        // the stored hash rejects almost every non-match before the
+        // 16-float comparison runs
+        uint64_t hash = HashTransform(t);
+        size_t mask = entries.size() - 1;
+        size_t slot = hash & mask;
+        while (entries[slot].t) {
+            if (entries[slot].hash == hash && *entries[slot].t == t) {
+                if (tCached) *tCached = entries[slot].t;
+                if (tCachedInverse) *tCachedInverse = entries[slot].tInverse;
+                return;
+            }
+            slot = (slot + 1) & mask;
         }
-        if (tCached) *tCached = iter->second.first;
-        if (tCachedInverse) *tCachedInverse = iter->second.second;
+
+        // Intern the new transform pair from the arena
+        Transform *tr = arena.Alloc<Transform>();
+        *tr = t;
+        Transform *tinv = arena.Alloc<Transform>();
+        *tinv = Transform(Inverse(t));
+        entries[slot].hash = hash;
+        entries[slot].t = tr;
+        entries[slot].tInverse = tinv;
+        if (++nEntries * 2 > entries.size()) Grow();
+        if (tCached) *tCached = tr;
+        if (tCachedInverse) *tCachedInverse = tinv;
     }
     void Clear() {
         arena.Reset();
-        cache.erase(cache.begin(), cache.end());
+        entries.clear();
+        entries.resize(512);
+        nEntries = 0;
     }
 
   private:
+    // TransformCache Private Declarations
+    struct Entry {
+        uint64_t hash = 0;
+        Transform *t = nullptr;
+        Transform *tInverse = nullptr;
+    };
+
+    // TransformCache Private Methods
+    static uint64_t HashTransform(const Transform &t) {
+        const char *bytes = (const char *)&t.GetMatrix();
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(Matrix4x4); ++i) {
+            hash ^= (unsigned char)bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+    void Grow() {
+        std::vector<Entry> old = std::move(entries);
+        entries.clear();
+        entries.resize(old.size() * 2);
+        size_t mask = entries.size() - 1;
+        for (const Entry &entry : old) {
+            if (!entry.t) continue;
+            size_t slot = entry.hash & mask;
+            while (entries[slot].t) slot = (slot + 1) & mask;
+            entries[slot] = entry;
+        }
+    }
+
     // TransformCache Private Data
-    std::map<Transform, std::pair<Transform *, Transform *>> cache;
+    std::vector<Entry> entries;
+    size_t nEntries = 0;
     MemoryArena arena;
 };
 
+// Intern AnimatedTransform pairs: repeated instances with the same
+// endpoint transforms and times share one decomposition instead of
+// re-running it per shape.
+static const AnimatedTransform &LookupAnimatedTransform(
+    const Transform *startT, Float startTime, const Transform *endT,
+    Float endTime) {
+    static std::map<std::tuple<const Transform *, const Transform *, Float,
+                               Float>,
+                    std::unique_ptr<AnimatedTransform>>
+        animatedCache;
+    auto key = std::make_tuple(startT, endT, startTime, endTime);
+    std::unique_ptr<AnimatedTransform> &entry = animatedCache[key];
+    if (!entry)
+        entry.reset(
+            new AnimatedTransform(startT, startTime, endT, endTime));
+    return *entry;
+}
+
+// Dry-run analysis (--dry-run): directives are costed instead of
+// materialized, and WorldEnd prints a projected memory report (and
+// enforces --memory-budget) before any geometry or texture is built.
+struct DryRunStats {
+    int64_t nShapes = 0, nTriangles = 0, geometryBytes = 0;
+    int64_t nTextures = 0, textureBytes = 0, unknownTextures = 0;
+    int64_t nLights = 0;
+};
+static DryRunStats dryRunStats;
+
+// Sniff image dimensions from the file header without decoding
+static bool SniffImageDimensions(const std::string &filename, int *width,
+                                 int *height) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    unsigned char header[26];
+    size_t n = fread(header, 1, sizeof(header), f);
+    fclose(f);
+    if (n < 18) return false;
+    static const unsigned char pngSig[8] = {0x89, 'P', 'N', 'G', '\r', '\n',
+                                            0x1a, '\n'};
+    if (n >= 24 && memcmp(header, pngSig, 8) == 0) {
+        *width = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) |
+                 header[19];
+        *height = (header[20] << 24) | (header[21] << 16) |
+                  (header[22] << 8) | header[23];
+        return true;
+    }
+    if (HasExtension(filename, "tga")) {
+        *width = header[12] | (header[13] << 8);
+        *height = header[14] | (header[15] << 8);
+        return true;
+    }
+    return false;
+}
+
+// Estimate the triangle and vertex counts of a mesh file from its
+// header alone
+static bool SniffMeshCounts(const std::string &filename, int64_t *nTriangles,
+                            int64_t *nVertices) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    char line[256];
+    *nTriangles = *nVertices = 0;
+    bool isPly = fgets(line, sizeof(line), f) && strncmp(line, "ply", 3) == 0;
+    if (isPly) {
+        while (fgets(line, sizeof(line), f)) {
+            long count;
+            if (sscanf(line, "element vertex %ld", &count) == 1)
+                *nVertices = count;
+            else if (sscanf(line, "element face %ld", &count) == 1)
+                *nTriangles = count;  // quads split later; close enough
+            else if (strncmp(line, "end_header", 10) == 0)
+                break;
+        }
+    }
+    fclose(f);
+    return isPly && (*nVertices > 0 || *nTriangles > 0);
+}
+
+// Record a shape directive's projected cost instead of building it
+static void DryRunShape(const std::string &name, const ParamSet &params) {
+    ++dryRunStats.nShapes;
+    int64_t nTris = 0, nVerts = 0;
+    if (name == "plymesh") {
+        std::string filename = params.FindOneFilename("filename", "");
+        SniffMeshCounts(filename, &nTris, &nVerts);
+    } else if (name == "trianglemesh") {
+        int nItems;
+        if (params.FindInt("indices", &nItems)) nTris = nItems / 3;
+        if (params.FindPoint3f("P", &nItems)) nVerts = nItems;
+    } else if (name == "loopsubdiv") {
+        int nItems;
+        if (params.FindInt("indices", &nItems)) {
+            int levels = params.FindOneInt("nlevels", 3);
+            nTris = (int64_t)(nItems / 3) << (2 * levels);
+            nVerts = nTris / 2;
+        }
+    } else {
+        dryRunStats.geometryBytes += 1024;  // analytic shape + primitive
+        return;
+    }
+    dryRunStats.nTriangles += nTris;
+    // Attributes + indices + per-triangle shape/primitive objects and
+    // an estimated 40 bytes of BVH per primitive
+    dryRunStats.geometryBytes +=
+        nVerts * (int64_t)(sizeof(Point3f) + sizeof(Normal3f) +
+                           sizeof(Point2f)) +
+        nTris * (int64_t)(3 * sizeof(int) + 96 + 40);
+}
+
 // API Static Data
 enum class APIState { Uninitialized, OptionsBlock, WorldBlock };
 static APIState currentApiState = APIState::Uninitialized;
@@ -234,6 +435,19 @@ static std::vector<TransformSet> pushedTransforms;
 static std::vector<uint32_t> pushedActiveTransformBits;
 static TransformCache transformCache;
 static int catIndentCount = 0;
+// Scene state retained after pbrtWorldEnd() so that pbrtRerender() can
+// re-render with updated primitive transforms without re-parsing.
+static std::unique_ptr<Integrator> retainedIntegrator;
+static std::unique_ptr<Scene> retainedScene;
+static std::shared_ptr<Primitive> retainedAggregate;
+// Daemon scene updates (--daemon): while set, a re-parse of the scene
+// file rebuilds only the light list -- geometry, the aggregate, and
+// loaded textures are reused from the retained render session -- and
+// WorldEnd re-renders against the retained aggregate.
+static bool updatingRetainedScene = false;
+static std::shared_ptr<Camera> retainedCamera;
+static std::map<std::string, std::vector<TransformedPrimitive *>>
+    retainedInstances;
 
 // API Forward Declarations
 std::vector<std::shared_ptr<Shape>> MakeShapes(const std::string &name,
@@ -377,16 +591,21 @@ std::vector<std::shared_ptr<Shape>> MakeShapes(const std::string &name,
         } else
             shapes = CreateTriangleMeshShape(object2world, world2object,
                                              reverseOrientation, paramSet,
-                                             &graphicsState.floatTextures);
+                                             graphicsState.floatTextures.get());
     } else if (name == "plymesh")
         shapes = CreatePLYMesh(object2world, world2object, reverseOrientation,
-                               paramSet, &graphicsState.floatTextures);
+                               paramSet, graphicsState.floatTextures.get());
     else if (name == "heightfield")
         shapes = CreateHeightfield(object2world, world2object,
                                    reverseOrientation, paramSet);
-    else if (name == "loopsubdiv")
+    else if (name == "loopsubdiv") {
+        // Give the subdivider the camera position so it can bound its
+        // depth by screen-space edge length ("maxedgeangle")
+        Point3f cameraPos =
+            renderOptions->CameraToWorld[0](Point3f(0, 0, 0));
         shapes = CreateLoopSubdiv(object2world, world2object,
-                                  reverseOrientation, paramSet);
+                                  reverseOrientation, paramSet, &cameraPos);
+    }
     else if (name == "nurbs")
         shapes = CreateNURBS(object2world, world2object, reverseOrientation,
                              paramSet);
@@ -399,6 +618,7 @@ std::vector<std::shared_ptr<Shape>> MakeShapes(const std::string &name,
 std::shared_ptr<Material> MakeMaterial(const std::string &name,
                                        const TextureParams &mp) {
     Material *material = nullptr;
+    bool mixChildrenNeedDifferentials = false;
     if (name == "" || name == "none")
         return nullptr;
     else if (name == "matte")
@@ -414,8 +634,8 @@ std::shared_ptr<Material> MakeMaterial(const std::string &name,
     else if (name == "mix") {
         std::string m1 = mp.FindString("namedmaterial1", "");
         std::string m2 = mp.FindString("namedmaterial2", "");
-        std::shared_ptr<Material> mat1 = graphicsState.namedMaterials[m1];
-        std::shared_ptr<Material> mat2 = graphicsState.namedMaterials[m2];
+        std::shared_ptr<Material> mat1 = (*graphicsState.namedMaterials)[m1];
+        std::shared_ptr<Material> mat2 = (*graphicsState.namedMaterials)[m2];
         if (!mat1) {
             Error("Named material \"%s\" undefined.  Using \"matte\"",
                   m1.c_str());
@@ -427,7 +647,27 @@ std::shared_ptr<Material> MakeMaterial(const std::string &name,
             mat2 = MakeMaterial("matte", mp);
         }
 
+        // Constant-fold degenerate mixes: a constant amount of 0 or 1
+        // selects one child outright, so rewrite the material graph to
+        // skip the MixMaterial (and the second material's texture
+        // evaluations and BxDF allocations) entirely
+        std::shared_ptr<Texture<Spectrum>> amount =
+            mp.GetSpectrumTexture("amount", Spectrum(0.5f));
+        const ConstantTexture<Spectrum> *constAmount =
+            dynamic_cast<const ConstantTexture<Spectrum> *>(amount.get());
+        if (constAmount) {
+            Spectrum a = constAmount->Evaluate(SurfaceInteraction()).Clamp();
+            if (a.IsBlack() || (Spectrum(1.f) - a).Clamp().IsBlack()) {
+                mp.ReportUnused();
+                return a.IsBlack() ? mat2 : mat1;
+            }
+        }
         material = CreateMixMaterial(mp, mat1, mat2);
+        // The mix's children evaluate under the same interaction, so
+        // their differentials requirement is inherited below
+        mixChildrenNeedDifferentials =
+            (mat1 && mat1->needsDifferentials) ||
+            (mat2 && mat2->needsDifferentials);
     } else if (name == "metal")
         material = CreateMetalMaterial(mp);
     else if (name == "substrate")
@@ -454,6 +694,37 @@ std::shared_ptr<Material> MakeMaterial(const std::string &name,
 
     mp.ReportUnused();
     if (!material) Error("Unable to create material \"%s\"", name.c_str());
+
+    // Differentials metadata: when every texture the material binds
+    // (directly or through the active Material directive's defaults)
+    // is constant -- or there are none -- shading never reads the ray
+    // differentials, and ComputeScatteringFunctions() skips the dual
+    // plane-intersection solve
+    if (material) {
+        bool needsDifferentials = false;
+        std::vector<std::string> textureNames = mp.GetShapeParamSet().AllTextureNames();
+        std::vector<std::string> materialNames =
+            mp.GetMaterialParamSet().AllTextureNames();
+        textureNames.insert(textureNames.end(), materialNames.begin(),
+                            materialNames.end());
+        for (const std::string &textureName : textureNames) {
+            auto floatIter = graphicsState.floatTextures->find(textureName);
+            if (floatIter != graphicsState.floatTextures->end()) {
+                if (floatIter->second->NeedsDifferentials())
+                    needsDifferentials = true;
+                continue;
+            }
+            auto spectrumIter =
+                graphicsState.spectrumTextures->find(textureName);
+            if (spectrumIter != graphicsState.spectrumTextures->end()) {
+                if (spectrumIter->second->NeedsDifferentials())
+                    needsDifferentials = true;
+            } else
+                needsDifferentials = true;  // unknown; stay conservative
+        }
+        material->needsDifferentials =
+            needsDifferentials || mixChildrenNeedDifferentials;
+    }
     return std::shared_ptr<Material>(material);
 }
 
@@ -546,6 +817,26 @@ std::shared_ptr<Medium> MakeMedium(const std::string &name,
         m = new HomogeneousMedium(sig_a, sig_s, g);
     } else if (name == "heterogeneous") {
         int nitems;
+        std::string trEstimator =
+            paramSet.FindOneString("trackingestimator", "ratio");
+        if (trEstimator != "ratio" && trEstimator != "delta")
+            Warning("Tracking estimator \"%s\" unknown; using \"ratio\".",
+                    trEstimator.c_str());
+        bool deltaTr = trEstimator == "delta";
+        // A sparse volume file replaces inline density data entirely
+        std::string volumeFile = paramSet.FindOneFilename("volumefile", "");
+        if (volumeFile != "") {
+            Point3f p0 = paramSet.FindOnePoint3f("p0", Point3f(0.f, 0.f, 0.f));
+            Point3f p1 = paramSet.FindOnePoint3f("p1", Point3f(1.f, 1.f, 1.f));
+            Transform data2Medium =
+                Translate(Vector3f(p0)) *
+                Scale(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z);
+            m = GridDensityMedium::CreateFromSparseFile(
+                sig_a, sig_s, g, volumeFile, medium2world * data2Medium,
+                deltaTr);
+            paramSet.ReportUnused();
+            return std::shared_ptr<Medium>(m);
+        }
         const Float *data = paramSet.FindFloat("density", &nitems);
         if (!data) {
             Error("No \"density\" values provided for heterogeneous medium?");
@@ -566,7 +857,7 @@ std::shared_ptr<Medium> MakeMedium(const std::string &name,
         Transform data2Medium = Translate(Vector3f(p0)) *
                                 Scale(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z);
         m = new GridDensityMedium(sig_a, sig_s, g, nx, ny, nz,
-                                  medium2world * data2Medium, data);
+                                  medium2world * data2Medium, data, deltaTr);
     } else
         Warning("Medium \"%s\" unknown.", name.c_str());
     paramSet.ReportUnused();
@@ -628,6 +919,8 @@ std::shared_ptr<Primitive> MakeAccelerator(
     std::shared_ptr<Primitive> accel;
     if (name == "bvh")
         accel = CreateBVHAccelerator(prims, paramSet);
+    else if (name == "obvh")
+        accel = CreateOBVHAccelerator(prims, paramSet);
     else if (name == "kdtree")
         accel = CreateKdTreeAccelerator(prims, paramSet);
     else
@@ -669,10 +962,21 @@ std::shared_ptr<Sampler> MakeSampler(const std::string &name,
                                      const ParamSet &paramSet,
                                      const Film *film) {
     Sampler *sampler = nullptr;
+    // Frame-coherence controls (see sampler.h): the seed and temporal
+    // scrambling mode are set before the sampler is constructed so
+    // its tables and scrambles pick them up
+    int seed = paramSet.FindOneInt("seed", PbrtOptions.seed);
+    std::string temporalSeed = paramSet.FindOneString("temporalseed", "none");
+    if (temporalSeed != "none" && temporalSeed != "bluenoise")
+        Warning("Unknown temporal seed mode \"%s\"; using \"none\".",
+                temporalSeed.c_str());
+    SetSamplerSeed((uint64_t)seed, temporalSeed == "bluenoise");
     if (name == "lowdiscrepancy" || name == "02sequence")
         sampler = CreateZeroTwoSequenceSampler(paramSet);
     else if (name == "maxmindist")
         sampler = CreateMaxMinDistSampler(paramSet);
+    else if (name == "pmj02")
+        sampler = CreatePMJ02Sampler(paramSet);
     else if (name == "halton")
         sampler = CreateHaltonSampler(paramSet, film->GetSampleBounds());
     else if (name == "sobol")
@@ -722,6 +1026,18 @@ Film *MakeFilm(const std::string &name, const ParamSet &paramSet,
 // API Function Definitions
 void pbrtInit(const Options &opt) {
     PbrtOptions = opt;
+    // Configure profiler sampling (--profilesample); rounded to a
+    // power of two so the tick test is a single mask
+    if (opt.profileSampleRate > 1)
+        profileSampleMask = RoundUpPow2(opt.profileSampleRate) - 1;
+    if (opt.traceFile != "") InitProfilerTrace(opt.traceFile);
+#ifdef PBRT_IS_LINUX
+    perfCountersEnabled = opt.perfCounters;
+#else
+    if (opt.perfCounters)
+        Warning("--perfcounters requires Linux perf_event; ignoring.");
+#endif  // PBRT_IS_LINUX
+    benchParseStart = std::chrono::steady_clock::now();
     // API Initialization
     if (currentApiState != APIState::Uninitialized)
         Error("pbrtInit() has already been called.");
@@ -744,6 +1060,16 @@ void pbrtCleanup() {
     currentApiState = APIState::Uninitialized;
     TerminateWorkerThreads();
     renderOptions.reset(nullptr);
+
+    WaitForImageWrites();
+    WriteProfilerTrace();
+
+    // Release the retained render session
+    retainedIntegrator.reset();
+    retainedScene.reset();
+    retainedAggregate.reset();
+    retainedCamera.reset();
+    retainedInstances.clear();
 }
 
 void pbrtIdentity() {
@@ -1034,29 +1360,45 @@ void pbrtTransformEnd() {
     }
 }
 
+static void DryRunTexture(const ParamSet &params) {
+    ++dryRunStats.nTextures;
+    std::string filename = params.FindOneFilename("filename", "");
+    int width, height;
+    if (filename != "" && SniffImageDimensions(filename, &width, &height))
+        // Full-float MIP pyramid: 4/3 of the base level
+        dryRunStats.textureBytes +=
+            (int64_t)width * height * sizeof(RGBSpectrum) * 4 / 3;
+    else if (filename != "")
+        ++dryRunStats.unknownTextures;
+}
+
 void pbrtTexture(const std::string &name, const std::string &type,
                  const std::string &texname, const ParamSet &params) {
     VERIFY_WORLD("Texture");
-    TextureParams tp(params, params, graphicsState.floatTextures,
-                     graphicsState.spectrumTextures);
+    if (PbrtOptions.dryRun) {
+        if (texname == "imagemap") DryRunTexture(params);
+        return;
+    }
+    TextureParams tp(params, params, *graphicsState.floatTextures,
+                     *graphicsState.spectrumTextures);
     if (type == "float") {
         // Create _Float_ texture and store in _floatTextures_
-        if (graphicsState.floatTextures.find(name) !=
-            graphicsState.floatTextures.end())
+        if (graphicsState.floatTextures->find(name) !=
+            graphicsState.floatTextures->end())
             Info("Texture \"%s\" being redefined", name.c_str());
         WARN_IF_ANIMATED_TRANSFORM("Texture");
         std::shared_ptr<Texture<Float>> ft =
             MakeFloatTexture(texname, curTransform[0], tp);
-        if (ft) graphicsState.floatTextures[name] = ft;
+        if (ft) (*graphicsState.MutableFloatTextures())[name] = ft;
     } else if (type == "color" || type == "spectrum") {
         // Create _color_ texture and store in _spectrumTextures_
-        if (graphicsState.spectrumTextures.find(name) !=
-            graphicsState.spectrumTextures.end())
+        if (graphicsState.spectrumTextures->find(name) !=
+            graphicsState.spectrumTextures->end())
             Info("Texture \"%s\" being redefined", name.c_str());
         WARN_IF_ANIMATED_TRANSFORM("Texture");
         std::shared_ptr<Texture<Spectrum>> st =
             MakeSpectrumTexture(texname, curTransform[0], tp);
-        if (st) graphicsState.spectrumTextures[name] = st;
+        if (st) (*graphicsState.MutableSpectrumTextures())[name] = st;
     } else
         Error("Texture type \"%s\" unknown.", type.c_str());
     if (PbrtOptions.cat || PbrtOptions.toPly) {
@@ -1083,15 +1425,15 @@ void pbrtMakeNamedMaterial(const std::string &name, const ParamSet &params) {
     VERIFY_WORLD("MakeNamedMaterial");
     // error checking, warning if replace, what to use for transform?
     ParamSet emptyParams;
-    TextureParams mp(params, emptyParams, graphicsState.floatTextures,
-                     graphicsState.spectrumTextures);
+    TextureParams mp(params, emptyParams, *graphicsState.floatTextures,
+                     *graphicsState.spectrumTextures);
     std::string matName = mp.FindString("type");
     WARN_IF_ANIMATED_TRANSFORM("MakeNamedMaterial");
     if (matName == "")
         Error("No parameter string \"type\" found in MakeNamedMaterial");
     else {
         std::shared_ptr<Material> mtl = MakeMaterial(matName, mp);
-        if (mtl) graphicsState.namedMaterials[name] = mtl;
+        if (mtl) (*graphicsState.MutableNamedMaterials())[name] = mtl;
     }
     if (PbrtOptions.cat || PbrtOptions.toPly) {
         printf("%*sMakeNamedMaterial \"%s\" ", catIndentCount, "",
@@ -1110,6 +1452,11 @@ void pbrtNamedMaterial(const std::string &name) {
 
 void pbrtLightSource(const std::string &name, const ParamSet &params) {
     VERIFY_WORLD("LightSource");
+    if (PbrtOptions.dryRun) {
+        ++dryRunStats.nLights;
+        if (name == "infinite") DryRunTexture(params);
+        return;
+    }
     WARN_IF_ANIMATED_TRANSFORM("LightSource");
     MediumInterface mi = graphicsState.CreateMediumInterface();
     std::shared_ptr<Light> lt = MakeLight(name, params, curTransform[0], mi);
@@ -1135,8 +1482,183 @@ void pbrtAreaLightSource(const std::string &name, const ParamSet &params) {
     }
 }
 
+// Create the _GeometricPrimitive_s (and any area lights) for a set of
+// shapes, allocating the primitives in one block sharing a single
+// control block (see CreateTriangleMesh for the same pattern) rather
+// than one heap object and control block per primitive.
+// Look up the shape's cutout alpha ("texture alpha" / "float alpha"),
+// evaluated stochastically during traversal by GeometricPrimitive;
+// trianglemesh and plymesh keep their existing in-shape alpha masks,
+// which already reject fully transparent hits during intersection.
+static std::shared_ptr<Texture<Float>> ShapeAlphaTexture(
+    const std::string &shapeName, const ParamSet &params) {
+    if (shapeName == "trianglemesh" || shapeName == "plymesh") return nullptr;
+    std::string texName = params.FindTexture("alpha");
+    if (texName != "") {
+        auto iter = graphicsState.floatTextures->find(texName);
+        if (iter != graphicsState.floatTextures->end()) return iter->second;
+        Error("Couldn't find float texture \"%s\" for \"alpha\" parameter",
+              texName.c_str());
+    } else {
+        int count;
+        const Float *alpha = params.FindFloat("alpha", &count);
+        if (alpha && count == 1 && *alpha < 1)
+            return std::make_shared<ConstantTexture<Float>>(*alpha);
+    }
+    return nullptr;
+}
+
+static void MakeGeometricPrimitives(
+    const std::vector<std::shared_ptr<Shape>> &shapes,
+    const std::shared_ptr<Material> &mtl, const MediumInterface &mi,
+    const std::string &areaLightName, const ParamSet &areaLightParams,
+    const Transform &light2world,
+    std::vector<std::shared_ptr<Primitive>> *prims,
+    std::vector<std::shared_ptr<AreaLight>> *areaLights,
+    const std::shared_ptr<Texture<Float>> &alphaTexture = nullptr) {
+    size_t nPrims = shapes.size();
+    GeometricPrimitive *primBlock = (GeometricPrimitive *)AllocAligned(
+        nPrims * sizeof(GeometricPrimitive));
+    for (size_t i = 0; i < nPrims; ++i) {
+        // Possibly create area light for shape
+        std::shared_ptr<AreaLight> area;
+        if (areaLightName != "") {
+            area = MakeAreaLight(areaLightName, light2world, mi,
+                                 areaLightParams, shapes[i]);
+            if (area) areaLights->push_back(area);
+        }
+        new (&primBlock[i])
+            GeometricPrimitive(shapes[i], mtl, area, mi, alphaTexture);
+    }
+    std::shared_ptr<GeometricPrimitive> block(
+        primBlock, [nPrims](GeometricPrimitive *p) {
+            for (size_t i = 0; i < nPrims; ++i) p[i].~GeometricPrimitive();
+            FreeAligned(p);
+        });
+    for (size_t i = 0; i < nPrims; ++i)
+        prims->push_back(std::shared_ptr<Primitive>(block, &primBlock[i]));
+}
+
+// Deferred shape descriptors (--deferredshapes): static, non-instance
+// shape directives record their inputs here and are materialized in
+// directive order at WorldEnd, each descriptor released as soon as it
+// is consumed, so shape construction's transient buffers don't stack
+// on top of the whole parse.  Descriptors are genuinely lightweight
+// for file-backed geometry (plymesh/bmesh), which is where load-time
+// memory goes on large scenes.
+struct DeferredShape {
+    std::string name;
+    ParamSet params;
+    Transform *ObjToWorld, *WorldToObj;
+    bool reverseOrientation;
+    std::shared_ptr<Material> material;
+    MediumInterface mediumInterface;
+    std::string areaLightName;
+    ParamSet areaLightParams;
+    Transform lightToWorld;
+    std::shared_ptr<Texture<Float>> alphaTexture;
+};
+static std::vector<DeferredShape> deferredShapes;
+
+// Auto-instancing (--autoinstance): inline-duplicated meshes are
+// fingerprinted by their object-space geometry arrays; later copies
+// that differ only by transform reuse the first copy's primitives
+// through a TransformedPrimitive carrying the relative transform,
+// instead of paying memory and BVH cost again.  Keyed additionally on
+// the active material directive, orientation, and area-light absence
+// so shaded appearance is preserved.
+struct AutoInstanceEntry {
+    Transform objToWorld;
+    std::shared_ptr<Primitive> prim;
+};
+static std::map<uint64_t, AutoInstanceEntry> autoInstancedShapes;
+static int64_t nAutoInstanced = 0;
+
+static uint64_t FingerprintShapeGeometry(const std::string &name,
+                                         const ParamSet &params) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size) {
+        const unsigned char *bytes = (const unsigned char *)data;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(name.data(), name.size());
+    if (name == "plymesh") {
+        std::string filename = params.FindOneFilename("filename", "");
+        mix(filename.data(), filename.size());
+    } else {
+        int n;
+        if (const int *indices = params.FindInt("indices", &n))
+            mix(indices, n * sizeof(int));
+        if (const Point3f *P = params.FindPoint3f("P", &n))
+            mix(P, n * sizeof(Point3f));
+        if (const Normal3f *N = params.FindNormal3f("N", &n))
+            mix(N, n * sizeof(Normal3f));
+        if (const Point2f *uv = params.FindPoint2f("uv", &n))
+            mix(uv, n * sizeof(Point2f));
+        if (const Point2f *st = params.FindPoint2f("st", &n))
+            mix(st, n * sizeof(Point2f));
+        if (const Float *uvf = params.FindFloat("uv", &n))
+            mix(uvf, n * sizeof(Float));
+        if (const Float *stf = params.FindFloat("st", &n))
+            mix(stf, n * sizeof(Float));
+    }
+    mix(graphicsState.material.data(), graphicsState.material.size());
+    mix(graphicsState.currentNamedMaterial.data(),
+        graphicsState.currentNamedMaterial.size());
+    // The full material specification, not just its type name: the
+    // active Material directive's parameters plus the shape parameters
+    // that CreateMaterial() lets override them
+    uint64_t materialHash = graphicsState.materialParams.ContentHash();
+    mix(&materialHash, sizeof(materialHash));
+    uint64_t shapeParamHash = params.ContentHash();
+    mix(&shapeParamHash, sizeof(shapeParamHash));
+    uint8_t reverse = graphicsState.reverseOrientation ? 1 : 0;
+    mix(&reverse, 1);
+    return hash;
+}
+
+static void CreateDeferredShapes() {
+    for (size_t i = 0; i < deferredShapes.size(); ++i) {
+        DeferredShape &ds = deferredShapes[i];
+        std::vector<std::shared_ptr<Primitive>> prims;
+        std::vector<std::shared_ptr<AreaLight>> areaLights;
+        std::vector<std::shared_ptr<Shape>> shapes =
+            MakeShapes(ds.name, ds.ObjToWorld, ds.WorldToObj,
+                       ds.reverseOrientation, ds.params);
+        ds.params.ReportUnused();
+        if (shapes.size()) {
+            MakeGeometricPrimitives(shapes, ds.material, ds.mediumInterface,
+                                    ds.areaLightName, ds.areaLightParams,
+                                    ds.lightToWorld, &prims, &areaLights,
+                                    ds.alphaTexture);
+            renderOptions->primitives.insert(renderOptions->primitives.end(),
+                                             prims.begin(), prims.end());
+            if (areaLights.size())
+                renderOptions->lights.insert(renderOptions->lights.end(),
+                                             areaLights.begin(),
+                                             areaLights.end());
+        }
+
+        // Release this descriptor's parameter storage before moving on
+        ds = DeferredShape();
+    }
+    deferredShapes.clear();
+    deferredShapes.shrink_to_fit();
+}
+
 void pbrtShape(const std::string &name, const ParamSet &params) {
     VERIFY_WORLD("Shape");
+    // During a daemon update only lights and re-specified object
+    // definitions are rebuilt; scene-level geometry (and the aggregate
+    // over it) is reused from the retained session
+    if (updatingRetainedScene && !renderOptions->currentInstance) return;
+    if (PbrtOptions.dryRun) {
+        DryRunShape(name, params);
+        return;
+    }
     std::vector<std::shared_ptr<Primitive>> prims;
     std::vector<std::shared_ptr<AreaLight>> areaLights;
     if (PbrtOptions.cat || (PbrtOptions.toPly && name != "trianglemesh")) {
@@ -1151,6 +1673,56 @@ void pbrtShape(const std::string &name, const ParamSet &params) {
         // Create shapes for shape _name_
         Transform *ObjToWorld, *WorldToObj;
         transformCache.Lookup(curTransform[0], &ObjToWorld, &WorldToObj);
+
+        // Auto-instancing: a repeated mesh that differs only by
+        // transform becomes an instance of the first copy
+        uint64_t autoKey = 0;
+        bool autoEligible =
+            PbrtOptions.autoInstance && !PbrtOptions.deferredShapes &&
+            !renderOptions->currentInstance &&
+            graphicsState.areaLight == "" &&
+            (name == "trianglemesh" || name == "plymesh");
+        if (autoEligible) {
+            autoKey = FingerprintShapeGeometry(name, params);
+            auto instanceIter = autoInstancedShapes.find(autoKey);
+            if (instanceIter != autoInstancedShapes.end()) {
+                Transform relative =
+                    curTransform[0] *
+                    Inverse(instanceIter->second.objToWorld);
+                Transform *t;
+                transformCache.Lookup(relative, &t, nullptr);
+                const AnimatedTransform &instanceToWorld =
+                    LookupAnimatedTransform(
+                        t, renderOptions->transformStartTime, t,
+                        renderOptions->transformEndTime);
+                std::shared_ptr<Primitive> sharedPrim =
+                    instanceIter->second.prim;
+                renderOptions->primitives.push_back(
+                    std::make_shared<TransformedPrimitive>(sharedPrim,
+                                                           instanceToWorld));
+                ++nAutoInstanced;
+                return;
+            }
+        }
+        if (PbrtOptions.deferredShapes && !renderOptions->currentInstance) {
+            // Record a descriptor and materialize the shape at WorldEnd
+            // instead of building it during parsing; the material and
+            // medium snapshot the current graphics state now
+            DeferredShape ds;
+            ds.name = name;
+            ds.params = params;
+            ds.ObjToWorld = ObjToWorld;
+            ds.WorldToObj = WorldToObj;
+            ds.reverseOrientation = graphicsState.reverseOrientation;
+            ds.material = graphicsState.CreateMaterial(params);
+            ds.mediumInterface = graphicsState.CreateMediumInterface();
+            ds.areaLightName = graphicsState.areaLight;
+            ds.areaLightParams = graphicsState.areaLightParams;
+            ds.lightToWorld = curTransform[0];
+            ds.alphaTexture = ShapeAlphaTexture(name, params);
+            deferredShapes.push_back(std::move(ds));
+            return;
+        }
         std::vector<std::shared_ptr<Shape>> shapes =
             MakeShapes(name, ObjToWorld, WorldToObj,
                        graphicsState.reverseOrientation, params);
@@ -1158,17 +1730,20 @@ void pbrtShape(const std::string &name, const ParamSet &params) {
         std::shared_ptr<Material> mtl = graphicsState.CreateMaterial(params);
         params.ReportUnused();
         MediumInterface mi = graphicsState.CreateMediumInterface();
-        for (auto s : shapes) {
-            // Possibly create area light for shape
-            std::shared_ptr<AreaLight> area;
-            if (graphicsState.areaLight != "") {
-                area = MakeAreaLight(graphicsState.areaLight, curTransform[0],
-                                     mi, graphicsState.areaLightParams, s);
-                if (area)
-                    areaLights.push_back(area);
-            }
-            prims.push_back(
-                std::make_shared<GeometricPrimitive>(s, mtl, area, mi));
+        MakeGeometricPrimitives(shapes, mtl, mi, graphicsState.areaLight,
+                                graphicsState.areaLightParams, curTransform[0],
+                                &prims, &areaLights,
+                                ShapeAlphaTexture(name, params));
+
+        // Register the first copy so later duplicates instance it; the
+        // shared aggregate stands in for the copy's primitives
+        if (autoEligible && !prims.empty()) {
+            std::shared_ptr<Primitive> aggregate =
+                prims.size() == 1 ? prims[0]
+                                  : std::make_shared<BVHAccel>(prims);
+            autoInstancedShapes[autoKey] = {curTransform[0], aggregate};
+            prims.clear();
+            prims.push_back(aggregate);
         }
     } else {
         // Initialize _prims_ and _areaLights_ for animated shape
@@ -1188,9 +1763,24 @@ void pbrtShape(const std::string &name, const ParamSet &params) {
         std::shared_ptr<Material> mtl = graphicsState.CreateMaterial(params);
         params.ReportUnused();
         MediumInterface mi = graphicsState.CreateMediumInterface();
-        for (auto s : shapes)
+        size_t nPrims = shapes.size();
+        GeometricPrimitive *primBlock =
+            (GeometricPrimitive *)AllocAligned(nPrims *
+                                               sizeof(GeometricPrimitive));
+        std::shared_ptr<Texture<Float>> alphaTexture =
+            ShapeAlphaTexture(name, params);
+        for (size_t i = 0; i < nPrims; ++i)
+            new (&primBlock[i])
+                GeometricPrimitive(shapes[i], mtl, nullptr, mi, alphaTexture);
+        std::shared_ptr<GeometricPrimitive> block(
+            primBlock, [nPrims](GeometricPrimitive *p) {
+                for (size_t i = 0; i < nPrims; ++i)
+                    p[i].~GeometricPrimitive();
+                FreeAligned(p);
+            });
+        for (size_t i = 0; i < nPrims; ++i)
             prims.push_back(
-                std::make_shared<GeometricPrimitive>(s, mtl, nullptr, mi));
+                std::shared_ptr<Primitive>(block, &primBlock[i]));
 
         // Create single _TransformedPrimitive_ for _prims_
 
@@ -1199,9 +1789,11 @@ void pbrtShape(const std::string &name, const ParamSet &params) {
         Transform *ObjToWorld[2];
         transformCache.Lookup(curTransform[0], &ObjToWorld[0], nullptr);
         transformCache.Lookup(curTransform[1], &ObjToWorld[1], nullptr);
-        AnimatedTransform animatedObjectToWorld(
-            ObjToWorld[0], renderOptions->transformStartTime, ObjToWorld[1],
-            renderOptions->transformEndTime);
+        const AnimatedTransform &animatedObjectToWorld =
+            LookupAnimatedTransform(ObjToWorld[0],
+                                    renderOptions->transformStartTime,
+                                    ObjToWorld[1],
+                                    renderOptions->transformEndTime);
         if (prims.size() > 1) {
             std::shared_ptr<Primitive> bvh = std::make_shared<BVHAccel>(prims);
             prims.clear();
@@ -1227,11 +1819,12 @@ void pbrtShape(const std::string &name, const ParamSet &params) {
 
 std::shared_ptr<Material> GraphicsState::CreateMaterial(
     const ParamSet &params) {
-    TextureParams mp(params, materialParams, floatTextures, spectrumTextures);
+    TextureParams mp(params, materialParams, *floatTextures,
+                     *spectrumTextures);
     std::shared_ptr<Material> mtl;
     if (currentNamedMaterial != "" &&
-        namedMaterials.find(currentNamedMaterial) != namedMaterials.end())
-        mtl = namedMaterials[graphicsState.currentNamedMaterial];
+        namedMaterials->find(currentNamedMaterial) != namedMaterials->end())
+        mtl = (*namedMaterials)[graphicsState.currentNamedMaterial];
     if (!mtl) mtl = MakeMaterial(material, mp);
     if (!mtl && material != "" && material != "none")
         mtl = MakeMaterial("matte", mp);
@@ -1266,6 +1859,8 @@ void pbrtReverseOrientation() {
         printf("%*sReverseOrientation\n", catIndentCount, "");
 }
 
+static std::string currentInstanceName;
+
 void pbrtObjectBegin(const std::string &name) {
     VERIFY_WORLD("ObjectBegin");
     pbrtAttributeBegin();
@@ -1273,6 +1868,7 @@ void pbrtObjectBegin(const std::string &name) {
         Error("ObjectBegin called inside of instance definition");
     renderOptions->instances[name] = std::vector<std::shared_ptr<Primitive>>();
     renderOptions->currentInstance = &renderOptions->instances[name];
+    currentInstanceName = name;
     if (PbrtOptions.cat || PbrtOptions.toPly)
         printf("%*sObjectBegin \"%s\"\n", catIndentCount, "", name.c_str());
 }
@@ -1283,17 +1879,37 @@ void pbrtObjectEnd() {
     VERIFY_WORLD("ObjectEnd");
     if (!renderOptions->currentInstance)
         Error("ObjectEnd called outside of instance definition");
+    // Build this object's aggregate (BLAS) now rather than lazily at its
+    // first ObjectInstance use; the build itself runs multi-threaded, and
+    // instances then only reference the finished aggregate.
+    if (renderOptions->currentInstance &&
+        renderOptions->currentInstance->size() > 1 && !PbrtOptions.cat &&
+        !PbrtOptions.toPly) {
+        std::vector<std::shared_ptr<Primitive>> &in =
+            *renderOptions->currentInstance;
+        std::shared_ptr<Primitive> accel(
+            MakeAccelerator(renderOptions->AcceleratorName, in,
+                            renderOptions->AcceleratorParams));
+        if (!accel) accel = std::make_shared<BVHAccel>(in);
+        in.erase(in.begin(), in.end());
+        in.push_back(accel);
+    }
     renderOptions->currentInstance = nullptr;
     pbrtAttributeEnd();
     ++nObjectInstancesCreated;
     if (PbrtOptions.cat || PbrtOptions.toPly)
         printf("%*sObjectEnd\n", catIndentCount, "");
+    // During a daemon update, a re-specified object definition is
+    // spliced into the retained scene immediately: swap the fresh
+    // BLAS into the object's retained instances and refit the TLAS
+    if (updatingRetainedScene) pbrtObjectUpdate(currentInstanceName);
 }
 
 STAT_COUNTER("Scene/Object instances used", nObjectInstancesUsed);
 
 void pbrtObjectInstance(const std::string &name) {
     VERIFY_WORLD("ObjectInstance");
+    if (updatingRetainedScene) return;
     // Perform object instance error checking
     if (PbrtOptions.cat || PbrtOptions.toPly)
         printf("%*sObjectInstance \"%s\"\n", catIndentCount, "", name.c_str());
@@ -1323,16 +1939,146 @@ void pbrtObjectInstance(const std::string &name) {
     Transform *InstanceToWorld[2];
     transformCache.Lookup(curTransform[0], &InstanceToWorld[0], nullptr);
     transformCache.Lookup(curTransform[1], &InstanceToWorld[1], nullptr);
-    AnimatedTransform animatedInstanceToWorld(
+    const AnimatedTransform &animatedInstanceToWorld = LookupAnimatedTransform(
         InstanceToWorld[0], renderOptions->transformStartTime, InstanceToWorld[1],
         renderOptions->transformEndTime);
-    std::shared_ptr<Primitive> prim(
-        std::make_shared<TransformedPrimitive>(in[0], animatedInstanceToWorld));
+    std::shared_ptr<TransformedPrimitive> xformedPrim =
+        std::make_shared<TransformedPrimitive>(in[0], animatedInstanceToWorld);
+    // Proxy-LOD convention: an object named "<name>.lod" is the
+    // simplified stand-in for instances of "<name>"; rays whose
+    // footprint projects the instance below --lodpixels pixels
+    // traverse the proxy instead of the full geometry
+    auto lodIter = renderOptions->instances.find(name + ".lod");
+    if (lodIter != renderOptions->instances.end() &&
+        !lodIter->second.empty()) {
+        std::vector<std::shared_ptr<Primitive>> &lodIn = lodIter->second;
+        if (lodIn.size() > 1) {
+            std::shared_ptr<Primitive> lodAccel = std::make_shared<BVHAccel>(lodIn);
+            lodIn.clear();
+            lodIn.push_back(lodAccel);
+        }
+        xformedPrim->SetLODProxy(lodIn[0]);
+    }
+    retainedInstances[name].push_back(xformedPrim.get());
+    std::shared_ptr<Primitive> prim = xformedPrim;
     renderOptions->primitives.push_back(prim);
 }
 
+// Append one machine-readable record of this render's phase timings,
+// ray throughput, and peak RSS to PbrtOptions.benchmarkFile so CI can
+// diff whole-render performance across commits.
+static int64_t GetPeakRSSBytes() {
+    int64_t peakRSSBytes = 0;
+#if defined(PBRT_IS_LINUX) || defined(PBRT_IS_OSX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+#ifdef PBRT_IS_OSX
+        peakRSSBytes = usage.ru_maxrss;
+#else
+        peakRSSBytes = usage.ru_maxrss * int64_t(1024);
+#endif
+#endif  // PBRT_IS_LINUX || PBRT_IS_OSX
+    return peakRSSBytes;
+}
+
+static void WriteBenchmarkReport(double parseSeconds, double buildSeconds,
+                                 double renderSeconds) {
+    // Fold the main thread's counters in so the ray totals are complete
+    // (worker threads report as TerminateWorkerThreads() joins them).
+    ReportThreadStats();
+    int64_t nRays =
+        StatsCounterValue("Intersections/Regular ray intersection tests") +
+        StatsCounterValue("Intersections/Shadow ray intersection tests");
+    int64_t peakRSSBytes = GetPeakRSSBytes();
+    FILE *f = fopen(PbrtOptions.benchmarkFile.c_str(), "a");
+    if (!f) {
+        Error("Unable to open benchmark file \"%s\"",
+              PbrtOptions.benchmarkFile.c_str());
+        return;
+    }
+    fprintf(f,
+            "{\"integrator\": \"%s\", \"parse_s\": %.3f, "
+            "\"build_s\": %.3f, \"render_s\": %.3f, "
+            "\"rays\": %lld, \"rays_per_s\": %.0f, "
+            "\"peak_rss_bytes\": %lld}\n",
+            renderOptions->IntegratorName.c_str(), parseSeconds, buildSeconds,
+            renderSeconds, (long long)nRays,
+            renderSeconds > 0 ? nRays / renderSeconds : 0,
+            (long long)peakRSSBytes);
+    fclose(f);
+}
+
+void pbrtBeginSceneUpdate() { updatingRetainedScene = true; }
+
+void pbrtEndSceneUpdate() { updatingRetainedScene = false; }
+
 void pbrtWorldEnd() {
     VERIFY_WORLD("WorldEnd");
+
+    // Daemon update: swap the freshly parsed light list into a Scene
+    // that shares the retained aggregate, clear the film, and
+    // re-render; parse+BVH+texture costs are all skipped
+    if (updatingRetainedScene) {
+        while (pushedGraphicsStates.size()) {
+            Warning("Missing end to pbrtAttributeBegin()");
+            pushedGraphicsStates.pop_back();
+            pushedTransforms.pop_back();
+        }
+        while (pushedTransforms.size()) {
+            Warning("Missing end to pbrtTransformBegin()");
+            pushedTransforms.pop_back();
+        }
+        if (!retainedAggregate || !retainedIntegrator || !retainedCamera) {
+            Error("Daemon update requested before an initial render");
+        } else {
+            retainedScene.reset(
+                new Scene(retainedAggregate, renderOptions->lights));
+            renderOptions->lights.clear();
+            retainedCamera->film->Clear();
+            retainedIntegrator->Render(*retainedScene);
+            TerminateWorkerThreads();
+        }
+        graphicsState = GraphicsState();
+        currentApiState = APIState::OptionsBlock;
+        ReportThreadStats();
+        for (int i = 0; i < MaxTransforms; ++i) curTransform[i] = Transform();
+        activeTransformBits = AllTransformsBits;
+        namedCoordinateSystems.erase(namedCoordinateSystems.begin(),
+                                     namedCoordinateSystems.end());
+        return;
+    }
+
+    // In a dry run, print the projected memory report and stop; if a
+    // budget was given and exceeded, exit nonzero so farm wrappers can
+    // reject the job before materialization
+    if (PbrtOptions.dryRun) {
+        int64_t totalMB =
+            (dryRunStats.geometryBytes + dryRunStats.textureBytes) >> 20;
+        printf("Dry run: %" PRId64 " shapes, %" PRId64
+               " triangles -> ~%" PRId64 " MB geometry (incl. BVH)\n",
+               dryRunStats.nShapes, dryRunStats.nTriangles,
+               dryRunStats.geometryBytes >> 20);
+        printf("Dry run: %" PRId64 " image textures -> ~%" PRId64
+               " MB resident (%" PRId64 " with unknown dimensions)\n",
+               dryRunStats.nTextures, dryRunStats.textureBytes >> 20,
+               dryRunStats.unknownTextures);
+        printf("Dry run: %" PRId64 " lights; projected total ~%" PRId64
+               " MB\n",
+               dryRunStats.nLights, totalMB);
+        if (PbrtOptions.memoryBudgetMB > 0 &&
+            totalMB > PbrtOptions.memoryBudgetMB) {
+            fprintf(stderr,
+                    "pbrt: projected memory %" PRId64
+                    " MB exceeds budget %d MB; aborting.\n",
+                    totalMB, PbrtOptions.memoryBudgetMB);
+            exit(1);
+        }
+        return;
+    }
+
+    // Materialize any deferred shapes now, streaming them into the
+    // scene's primitive list one directive at a time
+    CreateDeferredShapes();
     // Ensure there are no pushed graphics states
     while (pushedGraphicsStates.size()) {
         Warning("Missing end to pbrtAttributeBegin()");
@@ -1348,14 +2094,62 @@ void pbrtWorldEnd() {
     if (PbrtOptions.cat || PbrtOptions.toPly) {
         printf("%*sWorldEnd\n", catIndentCount, "");
     } else {
+        std::chrono::steady_clock::time_point buildStart =
+            std::chrono::steady_clock::now();
         std::unique_ptr<Integrator> integrator(renderOptions->MakeIntegrator());
         std::unique_ptr<Scene> scene(renderOptions->MakeScene());
+
+        // Compact before rendering: drop parse-phase storage wholesale
+        // (interned parameter tables, the now-consumed primitive and
+        // light vectors, cached spectra) and return the freed heap to
+        // the OS, closing the gap between post-parse RSS and what the
+        // render actually needs
+        FreeInternedParamItems();
+        renderOptions->primitives.clear();
+        renderOptions->primitives.shrink_to_fit();
+        renderOptions->lights.clear();
+        renderOptions->lights.shrink_to_fit();
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+
+        std::chrono::steady_clock::time_point renderStart =
+            std::chrono::steady_clock::now();
         if (scene && integrator) integrator->Render(*scene);
+        // Retain the scene and integrator so that pbrtRerender() can
+        // re-render after primitive transforms have been updated.
+        retainedIntegrator = std::move(integrator);
+        retainedScene = std::move(scene);
         TerminateWorkerThreads();
+        if (PbrtOptions.benchmarkFile != "" || PbrtOptions.statsDb != "") {
+            using FloatSeconds = std::chrono::duration<double>;
+            std::chrono::steady_clock::time_point renderEnd =
+                std::chrono::steady_clock::now();
+            double parseSeconds =
+                FloatSeconds(buildStart - benchParseStart).count();
+            double buildSeconds =
+                FloatSeconds(renderStart - buildStart).count();
+            double renderSeconds =
+                FloatSeconds(renderEnd - renderStart).count();
+            if (PbrtOptions.benchmarkFile != "")
+                WriteBenchmarkReport(parseSeconds, buildSeconds,
+                                     renderSeconds);
+            if (PbrtOptions.statsDb != "") {
+                // The database record wants the merged counters too
+                ReportThreadStats();
+                AppendStatsDatabaseRecord(
+                    PbrtOptions.statsDb, PbrtOptions.sceneFile, parseSeconds,
+                    buildSeconds, renderSeconds, GetPeakRSSBytes());
+            }
+        }
     }
 
     // Clean up after rendering
     graphicsState = GraphicsState();
+    if (nAutoInstanced > 0)
+        Info("Auto-instanced %d repeated meshes", (int)nAutoInstanced);
+    autoInstancedShapes.clear();
+    nAutoInstanced = 0;
     transformCache.Clear();
     currentApiState = APIState::OptionsBlock;
     ReportThreadStats();
@@ -1369,12 +2163,130 @@ void pbrtWorldEnd() {
                                  namedCoordinateSystems.end());
     ImageTexture<Float, Float>::ClearCache();
     ImageTexture<RGBSpectrum, Spectrum>::ClearCache();
+#ifdef PBRT_SAMPLED_SPECTRUM
+    ImageTexture<SampledSpectrum, Spectrum>::ClearCache();
+#endif  // PBRT_SAMPLED_SPECTRUM
+}
+
+// Session API: between pbrtWorldEnd()/pbrtRerender() calls, the
+// retained scene's camera, shutter, output file, and named instance
+// transforms can be updated, so a shot's frames amortize one parse,
+// texture load, and BVH build.
+void pbrtSessionSetCameraTransform(const Transform &cam2world) {
+    if (!retainedCamera) {
+        Error("pbrtSessionSetCameraTransform() called before rendering");
+        return;
+    }
+    Transform *t, *tInv;
+    transformCache.Lookup(cam2world, &t, &tInv);
+    retainedCamera->CameraToWorld =
+        AnimatedTransform(t, retainedCamera->shutterOpen, t,
+                          retainedCamera->shutterClose);
+}
+
+void pbrtSessionSetShutter(Float open, Float close) {
+    if (!retainedCamera) {
+        Error("pbrtSessionSetShutter() called before rendering");
+        return;
+    }
+    retainedCamera->shutterOpen = open;
+    retainedCamera->shutterClose = close;
+}
+
+void pbrtSessionSetOutputFile(const std::string &filename) {
+    if (!retainedCamera) {
+        Error("pbrtSessionSetOutputFile() called before rendering");
+        return;
+    }
+    retainedCamera->film->filename = filename;
+}
+
+bool pbrtSessionSetObjectTransform(const std::string &name,
+                                   const Transform &objectToWorld) {
+    auto iter = retainedInstances.find(name);
+    if (iter == retainedInstances.end()) {
+        Error("pbrtSessionSetObjectTransform(): unknown object \"%s\"",
+              name.c_str());
+        return false;
+    }
+    Transform *t, *tInv;
+    transformCache.Lookup(objectToWorld, &t, &tInv);
+    for (TransformedPrimitive *prim : iter->second)
+        prim->SetTransform(AnimatedTransform(t, 0, t, 0));
+    return true;
+}
+
+// Localized acceleration update for interactive edits: rebuild the
+// named object's BLAS from its (re-specified) instance primitive list,
+// swap it into every retained instance of the object, and refit the
+// top-level BVH -- the TLAS topology is unchanged because the same
+// TransformedPrimitives remain its leaves, so a refit suffices where a
+// whole-scene rebuild used to run.
+bool pbrtObjectUpdate(const std::string &name) {
+    auto instanceIter = retainedInstances.find(name);
+    if (instanceIter == retainedInstances.end() ||
+        instanceIter->second.empty()) {
+        Error("pbrtObjectUpdate(): no retained instances of object \"%s\"",
+              name.c_str());
+        return false;
+    }
+    auto geometryIter = renderOptions->instances.find(name);
+    if (geometryIter == renderOptions->instances.end() ||
+        geometryIter->second.empty()) {
+        Error("pbrtObjectUpdate(): object \"%s\" has no geometry",
+              name.c_str());
+        return false;
+    }
+    std::vector<std::shared_ptr<Primitive>> &in = geometryIter->second;
+    if (in.size() > 1) {
+        std::shared_ptr<Primitive> blas = std::make_shared<BVHAccel>(in);
+        in.clear();
+        in.push_back(blas);
+    }
+    for (TransformedPrimitive *instance : instanceIter->second)
+        instance->SetPrimitive(in[0]);
+    if (BVHAccel *bvh = dynamic_cast<BVHAccel *>(retainedAggregate.get()))
+        bvh->Refit();
+    return true;
+}
+
+void pbrtRerender() {
+    if (!retainedScene || !retainedIntegrator) {
+        Error("pbrtRerender() called before a scene has been rendered");
+        return;
+    }
+    if (BVHAccel *bvh = dynamic_cast<BVHAccel *>(retainedAggregate.get()))
+        bvh->Refit();
+    retainedIntegrator->Render(*retainedScene);
+    TerminateWorkerThreads();
 }
 
 Scene *RenderOptions::MakeScene() {
+    // With the accelerator "twolevel" parameter set, gather the
+    // non-instanced primitives into their own bottom-level aggregate so
+    // the top-level structure contains only instances plus that
+    // aggregate; the small TLAS is then cheap to rebuild when instance
+    // transforms change.
+    if (AcceleratorParams.FindOneBool("twolevel", false)) {
+        std::vector<std::shared_ptr<Primitive>> tlasPrims, blasPrims;
+        for (const std::shared_ptr<Primitive> &prim : primitives) {
+            if (dynamic_cast<const TransformedPrimitive *>(prim.get()))
+                tlasPrims.push_back(prim);
+            else
+                blasPrims.push_back(prim);
+        }
+        if (!blasPrims.empty()) {
+            std::shared_ptr<Primitive> blas =
+                MakeAccelerator(AcceleratorName, blasPrims, AcceleratorParams);
+            if (!blas) blas = std::make_shared<BVHAccel>(blasPrims);
+            tlasPrims.push_back(blas);
+        }
+        primitives.swap(tlasPrims);
+    }
     std::shared_ptr<Primitive> accelerator =
         MakeAccelerator(AcceleratorName, primitives, AcceleratorParams);
     if (!accelerator) accelerator = std::make_shared<BVHAccel>(primitives);
+    retainedAggregate = accelerator;
     Scene *scene = new Scene(accelerator, lights);
     // Erase primitives and lights from _RenderOptions_
     primitives.erase(primitives.begin(), primitives.end());
@@ -1383,7 +2295,9 @@ Scene *RenderOptions::MakeScene() {
 }
 
 Integrator *RenderOptions::MakeIntegrator() const {
-    std::shared_ptr<const Camera> camera(MakeCamera());
+    std::shared_ptr<Camera> mutableCamera(MakeCamera());
+    retainedCamera = mutableCamera;
+    std::shared_ptr<const Camera> camera = mutableCamera;
     if (!camera) {
         Error("Unable to create camera");
         return nullptr;
@@ -1404,6 +2318,14 @@ Integrator *RenderOptions::MakeIntegrator() const {
             CreateDirectLightingIntegrator(IntegratorParams, sampler, camera);
     else if (IntegratorName == "path")
         integrator = CreatePathIntegrator(IntegratorParams, sampler, camera);
+    else if (IntegratorName == "wavefrontpath")
+        integrator =
+            CreateWavefrontPathIntegrator(IntegratorParams, sampler, camera);
+    else if (IntegratorName == "gradientpath")
+        integrator =
+            CreateGradientPathIntegrator(IntegratorParams, sampler, camera);
+    else if (IntegratorName == "vpl")
+        integrator = CreateVPLIntegrator(IntegratorParams, sampler, camera);
     else if (IntegratorName == "volpath")
         integrator = CreateVolPathIntegrator(IntegratorParams, sampler, camera);
     else if (IntegratorName == "bdpt") {
@@ -86,4 +86,26 @@ void pbrtObjectEnd();
 void pbrtObjectInstance(const std::string &name);
 void pbrtWorldEnd();
 
+// Re-render the scene retained from the last pbrtWorldEnd() after
+// refitting the BVH around updated primitive transforms (see
+// TransformedPrimitive::SetTransform()); intended for per-frame
+// animation workflows that would otherwise re-parse and rebuild.
+void pbrtRerender();
+// Daemon scene updates: between pbrtBeginSceneUpdate() and
+// pbrtEndSceneUpdate(), re-parsing the scene file rebuilds only its
+// light list against the retained aggregate and re-renders.
+void pbrtBeginSceneUpdate();
+void pbrtEndSceneUpdate();
+// Localized acceleration update: rebuild the named object's aggregate
+// from its re-specified instance geometry, swap it into every retained
+// instance, and refit the top-level BVH.
+bool pbrtObjectUpdate(const std::string &name);
+// Session API for multi-frame rendering from one loaded scene (see
+// pbrtRerender()); all take effect on the next pbrtRerender() call
+void pbrtSessionSetCameraTransform(const Transform &cam2world);
+void pbrtSessionSetShutter(Float open, Float close);
+void pbrtSessionSetOutputFile(const std::string &filename);
+bool pbrtSessionSetObjectTransform(const std::string &name,
+                                   const Transform &objectToWorld);
+
 #endif  // PBRT_CORE_API_H
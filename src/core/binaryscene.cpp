@@ -0,0 +1,517 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// core/binaryscene.cpp*
+#include "binaryscene.h"
+#include "fileutil.h"
+#include "paramset.h"
+#include "parallel.h"
+#include <map>
+// The generated parser header provides the token ids and yylval; it is
+// produced into the build directory by bison at build time.
+#include "paramarray.h"
+#include "pbrtparse.h"
+#include <cstring>
+#if defined(PBRT_IS_LINUX) || defined(PBRT_IS_OSX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PBRT_BINSCENE_HAVE_MMAP
+#endif
+
+extern int yylex();
+extern FILE *yyin;
+extern void include_push(char *filename);
+extern std::string current_file;
+extern int line_num;
+
+// Binary scene file layout: _BinarySceneHeader_, then a stream of
+// records: an int16 token id, followed by a payload for NUM (a double)
+// and for STRING/ID (a uint32 length plus the bytes, unterminated).  A
+// token id of zero ends the stream.
+struct BinarySceneHeader {
+    uint32_t magic, version;
+};
+static const uint32_t binarySceneMagic = 0x42424250;  // "PBBB"
+static const uint32_t binarySceneVersion = 1;
+
+bool pbrtUsingBinaryScene = false;
+
+// Binary Scene Local State
+static const char *replayCursor = nullptr, *replayEnd = nullptr;
+static void *replayMapping = nullptr;
+static size_t replayMappingSize = 0;
+static std::vector<char> replayBuffer;
+
+// Binary Scene Function Definitions
+bool WriteBinaryScene(const std::string &inFilename,
+                      const std::string &outFilename) {
+    yyin = fopen(inFilename.c_str(), "r");
+    if (!yyin) {
+        Error("Unable to open scene file \"%s\"", inFilename.c_str());
+        return false;
+    }
+    SetSearchDirectory(DirectoryContaining(inFilename));
+    current_file = inFilename;
+    line_num = 1;
+    FILE *out = fopen(outFilename.c_str(), "wb");
+    if (!out) {
+        Error("Unable to open output file \"%s\"", outFilename.c_str());
+        fclose(yyin);
+        return false;
+    }
+    BinarySceneHeader header;
+    header.magic = binarySceneMagic;
+    header.version = binarySceneVersion;
+    fwrite(&header, sizeof(header), 1, out);
+
+    // Drain the lexer, expanding Include directives in place so the
+    // emitted stream is fully flattened
+    int token;
+    while ((token = yylex()) != 0) {
+        if (token == INCLUDE) {
+            int nameToken = yylex();
+            if (nameToken != STRING) {
+                Error("Expected filename after Include");
+                break;
+            }
+            include_push(yylval.string);
+            continue;
+        }
+        int16_t t = (int16_t)token;
+        fwrite(&t, sizeof(t), 1, out);
+        if (token == NUM)
+            fwrite(&yylval.num, sizeof(double), 1, out);
+        else if (token == STRING || token == ID) {
+            uint32_t length = (uint32_t)strlen(yylval.string);
+            fwrite(&length, sizeof(length), 1, out);
+            fwrite(yylval.string, 1, length, out);
+        } else if (token == NUM_ARRAY) {
+            // Serialize the lexer's bulk numeric array: count, then
+            // the doubles; the grammar never sees this token here, so
+            // the writer owns and releases the array
+            ParamArray *bulk = yylval.ribarray;
+            uint32_t count = (uint32_t)bulk->nelems;
+            fwrite(&count, sizeof(count), 1, out);
+            fwrite(bulk->array, sizeof(double), count, out);
+            free(bulk->array);
+            delete bulk;
+        }
+    }
+    int16_t terminator = 0;
+    fwrite(&terminator, sizeof(terminator), 1, out);
+    fclose(out);
+    fclose(yyin);
+    yyin = nullptr;
+    current_file = "";
+    line_num = 0;
+    return true;
+}
+
+bool BeginBinarySceneReplay(const std::string &filename) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        Error("Unable to open binary scene \"%s\"", filename.c_str());
+        return false;
+    }
+    BinarySceneHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != binarySceneMagic ||
+        header.version != binarySceneVersion) {
+        Error("Invalid binary scene file \"%s\"", filename.c_str());
+        fclose(f);
+        return false;
+    }
+#ifdef PBRT_BINSCENE_HAVE_MMAP
+    struct stat sb;
+    if (fstat(fileno(f), &sb) == 0) {
+        void *m = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED,
+                       fileno(f), 0);
+        if (m != MAP_FAILED) {
+            replayMapping = m;
+            replayMappingSize = sb.st_size;
+            replayCursor = (const char *)m + sizeof(header);
+            replayEnd = (const char *)m + sb.st_size;
+        }
+    }
+#endif  // PBRT_BINSCENE_HAVE_MMAP
+    if (!replayCursor) {
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, sizeof(header), SEEK_SET);
+        replayBuffer.resize(size - sizeof(header));
+        if (fread(&replayBuffer[0], 1, replayBuffer.size(), f) !=
+            replayBuffer.size()) {
+            Error("Truncated binary scene file \"%s\"", filename.c_str());
+            fclose(f);
+            return false;
+        }
+        replayCursor = &replayBuffer[0];
+        replayEnd = replayCursor + replayBuffer.size();
+    }
+    fclose(f);
+    pbrtUsingBinaryScene = true;
+    return true;
+}
+
+void EndBinarySceneReplay() {
+    pbrtUsingBinaryScene = false;
+#ifdef PBRT_BINSCENE_HAVE_MMAP
+    if (replayMapping) munmap(replayMapping, replayMappingSize);
+#endif
+    replayMapping = nullptr;
+    replayMappingSize = 0;
+    replayCursor = replayEnd = nullptr;
+    replayBuffer.clear();
+    replayBuffer.shrink_to_fit();
+}
+
+int BinarySceneYylex() {
+    if (replayCursor + sizeof(int16_t) > replayEnd) return 0;
+    int16_t token;
+    memcpy(&token, replayCursor, sizeof(token));
+    replayCursor += sizeof(token);
+    if (token == 0) return 0;
+    if (token == NUM) {
+        double value;
+        if (replayCursor + sizeof(value) > replayEnd) return 0;
+        memcpy(&value, replayCursor, sizeof(value));
+        replayCursor += sizeof(value);
+        yylval.num = value;
+    } else if (token == STRING || token == ID) {
+        uint32_t length;
+        if (replayCursor + sizeof(length) > replayEnd) return 0;
+        memcpy(&length, replayCursor, sizeof(length));
+        replayCursor += sizeof(length);
+        if (replayCursor + length > replayEnd ||
+            length >= sizeof(yylval.string))
+            return 0;
+        memcpy(yylval.string, replayCursor, length);
+        yylval.string[length] = '\0';
+        replayCursor += length;
+    } else if (token == NUM_ARRAY) {
+        // Rebuild the bulk numeric array; the grammar consumes and
+        // frees it exactly as it would the lexer's
+        uint32_t count;
+        if (replayCursor + sizeof(count) > replayEnd) return 0;
+        memcpy(&count, replayCursor, sizeof(count));
+        replayCursor += sizeof(count);
+        if (replayCursor + count * sizeof(double) > replayEnd) return 0;
+        ParamArray *bulk = new ParamArray;
+        bulk->element_size = sizeof(double);
+        bulk->isString = false;
+        bulk->allocated = bulk->nelems = (int)count;
+        bulk->array = malloc(count * sizeof(double));
+        memcpy(bulk->array, replayCursor, count * sizeof(double));
+        replayCursor += count * sizeof(double);
+        yylval.ribarray = bulk;
+    }
+    return token;
+}
+
+// Standalone scene tokenizer used for parallel parsing: emits the same
+// token records the flex lexer would, so independent Include files can
+// be tokenized concurrently and their streams concatenated in order.
+static int SceneKeywordToken(const std::string &word) {
+    static const std::map<std::string, int> keywords = {
+        {"Accelerator", ACCELERATOR},
+        {"ActiveTransform", ACTIVETRANSFORM},
+        {"All", ALL},
+        {"AreaLightSource", AREALIGHTSOURCE},
+        {"AttributeBegin", ATTRIBUTEBEGIN},
+        {"AttributeEnd", ATTRIBUTEEND},
+        {"Camera", CAMERA},
+        {"ConcatTransform", CONCATTRANSFORM},
+        {"CoordinateSystem", COORDINATESYSTEM},
+        {"CoordSysTransform", COORDSYSTRANSFORM},
+        {"EndTime", ENDTIME},
+        {"Film", FILM},
+        {"Identity", IDENTITY},
+        {"Include", INCLUDE},
+        {"LightSource", LIGHTSOURCE},
+        {"LookAt", LOOKAT},
+        {"MakeNamedMedium", MAKENAMEDMEDIUM},
+        {"MakeNamedMaterial", MAKENAMEDMATERIAL},
+        {"Material", MATERIAL},
+        {"MediumInterface", MEDIUMINTERFACE},
+        {"NamedMaterial", NAMEDMATERIAL},
+        {"ObjectBegin", OBJECTBEGIN},
+        {"ObjectEnd", OBJECTEND},
+        {"ObjectInstance", OBJECTINSTANCE},
+        {"PixelFilter", PIXELFILTER},
+        {"ReverseOrientation", REVERSEORIENTATION},
+        {"Rotate", ROTATE},
+        {"Sampler", SAMPLER},
+        {"Scale", SCALE},
+        {"Shape", SHAPE},
+        {"StartTime", STARTTIME},
+        {"Integrator", INTEGRATOR},
+        {"Texture", TEXTURE},
+        {"TransformBegin", TRANSFORMBEGIN},
+        {"TransformEnd", TRANSFORMEND},
+        {"TransformTimes", TRANSFORMTIMES},
+        {"Transform", TRANSFORM},
+        {"Translate", TRANSLATE},
+        {"WorldBegin", WORLDBEGIN},
+        {"WorldEnd", WORLDEND}};
+    auto iter = keywords.find(word);
+    return iter == keywords.end() ? 0 : iter->second;
+}
+
+static void AppendToken(std::vector<char> *out, int16_t token) {
+    out->insert(out->end(), (const char *)&token,
+                (const char *)&token + sizeof(token));
+}
+
+static void AppendString(std::vector<char> *out, int16_t token,
+                         const std::string &value) {
+    AppendToken(out, token);
+    uint32_t length = (uint32_t)value.size();
+    out->insert(out->end(), (const char *)&length,
+                (const char *)&length + sizeof(length));
+    out->insert(out->end(), value.begin(), value.end());
+}
+
+static void AppendNumber(std::vector<char> *out, double value) {
+    AppendToken(out, (int16_t)NUM);
+    out->insert(out->end(), (const char *)&value,
+                (const char *)&value + sizeof(value));
+}
+
+// Tokenize one scene file into _out_; nested Include files recurse on
+// the calling thread (the top-level fan-out provides the parallelism)
+static bool TokenizeSceneFile(const std::string &filename,
+                              std::vector<char> *out) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        Error("Unable to open included scene file \"%s\"",
+              filename.c_str());
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    std::vector<char> text(size);
+    if (size > 0 && fread(&text[0], 1, size, f) != (size_t)size) {
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+
+    const char *c = size > 0 ? &text[0] : nullptr, *end = c + size;
+    while (c < end) {
+        char ch = *c;
+        if (isspace((unsigned char)ch)) {
+            ++c;
+        } else if (ch == '#') {
+            while (c < end && *c != '\n') ++c;
+        } else if (ch == '[') {
+            AppendToken(out, (int16_t)LBRACK);
+            ++c;
+        } else if (ch == ']') {
+            AppendToken(out, (int16_t)RBRACK);
+            ++c;
+        } else if (ch == '"') {
+            const char *start = ++c;
+            while (c < end && *c != '"') ++c;
+            std::string value(start, c);
+            if (c < end) ++c;
+            AppendString(out, (int16_t)STRING, value);
+        } else if (isdigit((unsigned char)ch) || ch == '-' || ch == '+' ||
+                   ch == '.') {
+            char *numEnd;
+            double value = strtod(c, &numEnd);
+            AppendNumber(out, value);
+            c = numEnd;
+        } else {
+            const char *start = c;
+            while (c < end && !isspace((unsigned char)*c) && *c != '"' &&
+                   *c != '[' && *c != ']' && *c != '#')
+                ++c;
+            std::string word(start, c);
+            int token = SceneKeywordToken(word);
+            if (token == INCLUDE) {
+                // Inline the included file's tokens; the quoted
+                // filename follows
+                while (c < end && isspace((unsigned char)*c)) ++c;
+                if (c >= end || *c != '"') {
+                    Error("Expected filename after Include in \"%s\"",
+                          filename.c_str());
+                    return false;
+                }
+                const char *nameStart = ++c;
+                while (c < end && *c != '"') ++c;
+                std::string included = AbsolutePath(
+                    ResolveFilename(std::string(nameStart, c)));
+                if (c < end) ++c;
+                if (!TokenizeSceneFile(included, out)) return false;
+            } else if (token != 0)
+                AppendToken(out, (int16_t)token);
+            else
+                AppendString(out, (int16_t)ID, word);
+        }
+    }
+    return true;
+}
+
+bool BeginParallelSceneReplay(const std::string &filename) {
+    // Read the master file and split it at top-level Include
+    // directives; the segments and the included files then tokenize
+    // concurrently and concatenate in order
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    std::string text(size, '\0');
+    if (size > 0 && fread(&text[0], 1, size, f) != (size_t)size) {
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+    SetSearchDirectory(DirectoryContaining(filename));
+
+    // Work units: literal master-text segments and included filenames
+    struct ParseUnit {
+        std::string text;      // master segment to tokenize (if no file)
+        std::string file;      // included file to tokenize
+        std::vector<char> tokens;
+    };
+    std::vector<ParseUnit> units;
+    size_t segmentStart = 0, pos = 0;
+    while ((pos = text.find("Include", pos)) != std::string::npos) {
+        // Only accept a real directive: preceded by whitespace/newline
+        // and followed by a quoted name on the same logical position
+        bool atStart = pos == 0 || isspace((unsigned char)text[pos - 1]);
+        // Reject directives on commented lines, which the serial
+        // lexer would ignore: scan back to the start of line for '#'
+        if (atStart) {
+            for (size_t i = pos; i > 0;) {
+                --i;
+                if (text[i] == '\n') break;
+                if (text[i] == '#') {
+                    atStart = false;
+                    break;
+                }
+            }
+        }
+        size_t nameStart = text.find('"', pos + 7);
+        if (!atStart || nameStart == std::string::npos) {
+            pos += 7;
+            continue;
+        }
+        size_t between = pos + 7;
+        bool onlySpace = true;
+        for (size_t i = between; i < nameStart; ++i)
+            if (!isspace((unsigned char)text[i])) onlySpace = false;
+        size_t nameEnd = text.find('"', nameStart + 1);
+        if (!onlySpace || nameEnd == std::string::npos) {
+            pos += 7;
+            continue;
+        }
+        ParseUnit segment;
+        segment.text = text.substr(segmentStart, pos - segmentStart);
+        units.push_back(std::move(segment));
+        ParseUnit include;
+        include.file = AbsolutePath(ResolveFilename(
+            text.substr(nameStart + 1, nameEnd - nameStart - 1)));
+        units.push_back(std::move(include));
+        pos = segmentStart = nameEnd + 1;
+    }
+    ParseUnit tail;
+    tail.text = text.substr(segmentStart);
+    units.push_back(std::move(tail));
+
+    // Tokenize every unit in parallel
+    std::atomic<bool> failed(false);
+    ParallelFor([&](int64_t i) {
+        ParseUnit &unit = units[i];
+        if (unit.file != "") {
+            if (!TokenizeSceneFile(unit.file, &unit.tokens)) failed = true;
+        } else if (unit.text != "") {
+            // Tokenize the literal segment via a temporary file-less
+            // path: reuse TokenizeSceneFile's scanner on the string
+            const std::string &t = unit.text;
+            std::vector<char> &out = unit.tokens;
+            // (duplicate of the scanner loop, operating on the string)
+            const char *c = t.data(), *end = c + t.size();
+            while (c < end) {
+                char ch = *c;
+                if (isspace((unsigned char)ch)) ++c;
+                else if (ch == '#') {
+                    while (c < end && *c != '\n') ++c;
+                } else if (ch == '[') {
+                    AppendToken(&out, (int16_t)LBRACK);
+                    ++c;
+                } else if (ch == ']') {
+                    AppendToken(&out, (int16_t)RBRACK);
+                    ++c;
+                } else if (ch == '"') {
+                    const char *start = ++c;
+                    while (c < end && *c != '"') ++c;
+                    AppendString(&out, (int16_t)STRING,
+                                 std::string(start, c));
+                    if (c < end) ++c;
+                } else if (isdigit((unsigned char)ch) || ch == '-' ||
+                           ch == '+' || ch == '.') {
+                    char *numEnd;
+                    AppendNumber(&out, strtod(c, &numEnd));
+                    c = numEnd;
+                } else {
+                    const char *start = c;
+                    while (c < end && !isspace((unsigned char)*c) &&
+                           *c != '"' && *c != '[' && *c != ']' && *c != '#')
+                        ++c;
+                    std::string word(start, c);
+                    int token = SceneKeywordToken(word);
+                    if (token != 0)
+                        AppendToken(&out, (int16_t)token);
+                    else
+                        AppendString(&out, (int16_t)ID, word);
+                }
+            }
+        }
+    }, units.size());
+    if (failed) return false;
+
+    // Concatenate in directive order and start the replay
+    replayBuffer.clear();
+    for (const ParseUnit &unit : units)
+        replayBuffer.insert(replayBuffer.end(), unit.tokens.begin(),
+                            unit.tokens.end());
+    AppendToken(&replayBuffer, 0);
+    replayCursor = &replayBuffer[0];
+    replayEnd = replayCursor + replayBuffer.size();
+    pbrtUsingBinaryScene = true;
+    return true;
+}
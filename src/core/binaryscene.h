@@ -0,0 +1,71 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_BINARYSCENE_H
+#define PBRT_CORE_BINARYSCENE_H
+
+// core/binaryscene.h*
+#include "pbrt.h"
+
+// Compiled binary scene support (.pbb): a scene is lexed once --
+// Include directives expanded, numbers converted -- into a flat token
+// stream with pre-parsed payloads; ParseFile() then replays the stream
+// straight into the yacc grammar through a drop-in lexer, so loading
+// runs at I/O speed instead of re-lexing gigabytes of text.
+
+// Lex the .pbrt scene in _inFilename_ (expanding includes) and write
+// its token stream to _outFilename_
+bool WriteBinaryScene(const std::string &inFilename,
+                      const std::string &outFilename);
+
+// Begin/end replaying a binary scene; between the two, the parser's
+// yylex dispatches to the binary stream reader
+bool BeginBinarySceneReplay(const std::string &filename);
+void EndBinarySceneReplay();
+
+// Tokenize the scene and its Include files concurrently with a
+// standalone lexer and begin replaying the concatenated, in-order
+// stream (--parallelparse)
+bool BeginParallelSceneReplay(const std::string &filename);
+
+// True while a binary scene is being replayed (consulted by the
+// parser's lexer dispatch)
+extern bool pbrtUsingBinaryScene;
+// The replacement yylex used during replay
+int BinarySceneYylex();
+
+#endif  // PBRT_CORE_BINARYSCENE_H
@@ -35,6 +35,13 @@
 #include "bssrdf.h"
 #include "interpolation.h"
 #include "scene.h"
+#include <map>
+#include <mutex>
+#ifdef PBRT_IS_WINDOWS
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif  // PBRT_IS_WINDOWS
 
 // BSSRDF Utility Functions
 Float FresnelMoment1(Float eta) {
@@ -171,6 +178,106 @@ void ComputeBeamDiffusionBSSRDF(Float g, Float eta, BSSRDFTable *t) {
     }, t->nRhoSamples);
 }
 
+// BSSRDF table cache file layout: _BSSRDFTableCacheHeader_, then the
+// rho samples, radius samples, profile, rhoEff, and profileCDF arrays
+// verbatim.
+struct BSSRDFTableCacheHeader {
+    uint32_t magic, version, floatSize;
+    uint32_t nRhoSamples, nRadiusSamples;
+    Float g, eta;
+};
+static const uint32_t bssrdfCacheMagic = 0x54444250;  // "PBDT"
+static const uint32_t bssrdfCacheVersion = 1;
+static const char *bssrdfCacheDir = ".bssrdf_cache";
+
+static std::string BSSRDFTableCacheFilename(Float g, Float eta) {
+    char filename[128];
+    snprintf(filename, sizeof(filename), "%s/bd_%.6f_%.6f.tbl",
+             bssrdfCacheDir, (double)g, (double)eta);
+    return filename;
+}
+
+static bool ReadBSSRDFTableCache(Float g, Float eta, BSSRDFTable *t) {
+    FILE *f = fopen(BSSRDFTableCacheFilename(g, eta).c_str(), "rb");
+    if (!f) return false;
+    BSSRDFTableCacheHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != bssrdfCacheMagic ||
+        header.version != bssrdfCacheVersion ||
+        header.floatSize != sizeof(Float) ||
+        header.nRhoSamples != (uint32_t)t->nRhoSamples ||
+        header.nRadiusSamples != (uint32_t)t->nRadiusSamples ||
+        header.g != g || header.eta != eta) {
+        fclose(f);
+        return false;
+    }
+    size_t nRho = t->nRhoSamples, nRadius = t->nRadiusSamples;
+    bool ok = fread(t->rhoSamples.get(), sizeof(Float), nRho, f) == nRho &&
+              fread(t->radiusSamples.get(), sizeof(Float), nRadius, f) ==
+                  nRadius &&
+              fread(t->profile.get(), sizeof(Float), nRho * nRadius, f) ==
+                  nRho * nRadius &&
+              fread(t->rhoEff.get(), sizeof(Float), nRho, f) == nRho &&
+              fread(t->profileCDF.get(), sizeof(Float), nRho * nRadius, f) ==
+                  nRho * nRadius;
+    fclose(f);
+    return ok;
+}
+
+static void WriteBSSRDFTableCache(Float g, Float eta, const BSSRDFTable &t) {
+#ifdef PBRT_IS_WINDOWS
+    _mkdir(bssrdfCacheDir);
+#else
+    mkdir(bssrdfCacheDir, 0777);
+#endif  // PBRT_IS_WINDOWS
+    // Write to a temporary file and rename into place so a partial
+    // write (or a concurrent render) never leaves a torn cache entry
+    std::string filename = BSSRDFTableCacheFilename(g, eta);
+    std::string tmpName = filename + ".tmp";
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (!f) return;
+    BSSRDFTableCacheHeader header;
+    header.magic = bssrdfCacheMagic;
+    header.version = bssrdfCacheVersion;
+    header.floatSize = sizeof(Float);
+    header.nRhoSamples = t.nRhoSamples;
+    header.nRadiusSamples = t.nRadiusSamples;
+    header.g = g;
+    header.eta = eta;
+    size_t nRho = t.nRhoSamples, nRadius = t.nRadiusSamples;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(t.rhoSamples.get(), sizeof(Float), nRho, f) == nRho &&
+              fwrite(t.radiusSamples.get(), sizeof(Float), nRadius, f) ==
+                  nRadius &&
+              fwrite(t.profile.get(), sizeof(Float), nRho * nRadius, f) ==
+                  nRho * nRadius &&
+              fwrite(t.rhoEff.get(), sizeof(Float), nRho, f) == nRho &&
+              fwrite(t.profileCDF.get(), sizeof(Float), nRho * nRadius, f) ==
+                  nRho * nRadius;
+    ok &= fclose(f) == 0;
+    if (!ok || rename(tmpName.c_str(), filename.c_str()) != 0) {
+        Warning("Unable to write BSSRDF table cache \"%s\"",
+                filename.c_str());
+        remove(tmpName.c_str());
+    }
+}
+
+std::shared_ptr<BSSRDFTable> GetBeamDiffusionBSSRDFTable(Float g, Float eta) {
+    static std::map<std::pair<Float, Float>, std::shared_ptr<BSSRDFTable>>
+        loadedTables;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = loadedTables.find(std::make_pair(g, eta));
+    if (iter != loadedTables.end()) return iter->second;
+    std::shared_ptr<BSSRDFTable> table = std::make_shared<BSSRDFTable>(100, 64);
+    if (!ReadBSSRDFTableCache(g, eta, table.get())) {
+        ComputeBeamDiffusionBSSRDF(g, eta, table.get());
+        WriteBSSRDFTableCache(g, eta, *table);
+    }
+    loadedTables[std::make_pair(g, eta)] = table;
+    return table;
+}
+
 void SubsurfaceFromDiffuse(const BSSRDFTable &t, const Spectrum &rhoEff,
                            const Spectrum &mfp, Spectrum *sigma_a,
                            Spectrum *sigma_s) {
@@ -192,31 +299,73 @@ BSSRDFTable::BSSRDFTable(int nRhoSamples, int nRadiusSamples)
       rhoEff(new Float[nRhoSamples]),
       profileCDF(new Float[nRadiusSamples * nRhoSamples]) {}
 
+TabulatedBSSRDF::TabulatedBSSRDF(const SurfaceInteraction &po,
+                                 const Material *material, TransportMode mode,
+                                 Float eta, const Spectrum &sigma_a,
+                                 const Spectrum &sigma_s,
+                                 const BSSRDFTable &table, MemoryArena &arena)
+    : SeparableBSSRDF(po, eta, material, mode), table(table) {
+    sigma_t = sigma_a + sigma_s;
+    for (int c = 0; c < Spectrum::nSamples; ++c)
+        rho[c] = sigma_t[c] != 0 ? (sigma_s[c] / sigma_t[c]) : 0;
+
+    // Collapse the table's albedo dimension for this instance's rho:
+    // the per-channel radial slices below turn every later profile
+    // lookup into a 1D spline evaluation
+    int nRadius = table.nRadiusSamples;
+    radialProfile = arena.Alloc<Float>(Spectrum::nSamples * nRadius, false);
+    radialCDF = arena.Alloc<Float>(Spectrum::nSamples * nRadius, false);
+    for (int c = 0; c < Spectrum::nSamples; ++c) {
+        sliceValid[c] = false;
+        rhoEffCh[c] = 0;
+        if (sigma_t[c] == 0) continue;
+        int rhoOffset;
+        Float rhoWeights[4];
+        if (!CatmullRomWeights(table.nRhoSamples, table.rhoSamples.get(),
+                               rho[c], &rhoOffset, rhoWeights))
+            continue;
+        sliceValid[c] = true;
+        Float *profileSlice = radialProfile + c * nRadius;
+        Float *cdfSlice = radialCDF + c * nRadius;
+        for (int j = 0; j < nRadius; ++j) {
+            Float p = 0, cdf = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (rhoWeights[i] == 0) continue;
+                p += rhoWeights[i] *
+                     table.profile[(rhoOffset + i) * nRadius + j];
+                cdf += rhoWeights[i] *
+                       table.profileCDF[(rhoOffset + i) * nRadius + j];
+            }
+            profileSlice[j] = p;
+            cdfSlice[j] = cdf;
+        }
+        Float eff = 0;
+        for (int i = 0; i < 4; ++i)
+            if (rhoWeights[i] != 0)
+                eff += rhoWeights[i] * table.rhoEff[rhoOffset + i];
+        rhoEffCh[c] = eff;
+    }
+}
+
 Spectrum TabulatedBSSRDF::Sr(Float r) const {
     Spectrum Sr(0.f);
     for (int ch = 0; ch < Spectrum::nSamples; ++ch) {
+        if (!sliceValid[ch]) continue;
         // Convert $r$ into unitless optical radius $r_{\roman{optical}}$
         Float rOptical = r * sigma_t[ch];
 
-        // Compute spline weights to interpolate BSSRDF on channel _ch_
-        int rhoOffset, radiusOffset;
-        Float rhoWeights[4], radiusWeights[4];
-        if (!CatmullRomWeights(table.nRhoSamples, table.rhoSamples.get(),
-                               rho[ch], &rhoOffset, rhoWeights) ||
-            !CatmullRomWeights(table.nRadiusSamples, table.radiusSamples.get(),
+        // Interpolate the channel's precomputed radial profile slice
+        int radiusOffset;
+        Float radiusWeights[4];
+        if (!CatmullRomWeights(table.nRadiusSamples, table.radiusSamples.get(),
                                rOptical, &radiusOffset, radiusWeights))
             continue;
-
-        // Set BSSRDF value _Sr[ch]_ using tensor spline interpolation
+        const Float *profileSlice =
+            radialProfile + ch * table.nRadiusSamples;
         Float sr = 0;
-        for (int i = 0; i < 4; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                Float weight = rhoWeights[i] * radiusWeights[j];
-                if (weight != 0)
-                    sr += weight *
-                          table.EvalProfile(rhoOffset + i, radiusOffset + j);
-            }
-        }
+        for (int j = 0; j < 4; ++j)
+            if (radiusWeights[j] != 0)
+                sr += radiusWeights[j] * profileSlice[radiusOffset + j];
 
         // Cancel marginal PDF factor from tabulated BSSRDF profile
         if (rOptical != 0) sr /= 2 * Pi * rOptical;
@@ -344,40 +493,32 @@ Float SeparableBSSRDF::Pdf_Sp(const SurfaceInteraction &pi) const {
 }
 
 Float TabulatedBSSRDF::Sample_Sr(int ch, Float u) const {
-    if (sigma_t[ch] == 0) return -1;
-    return SampleCatmullRom2D(table.nRhoSamples, table.nRadiusSamples,
-                              table.rhoSamples.get(), table.radiusSamples.get(),
-                              table.profile.get(), table.profileCDF.get(),
-                              rho[ch], u) /
+    if (sigma_t[ch] == 0 || !sliceValid[ch]) return -1;
+    return SampleCatmullRom(table.nRadiusSamples, table.radiusSamples.get(),
+                            radialProfile + ch * table.nRadiusSamples,
+                            radialCDF + ch * table.nRadiusSamples, u) /
            sigma_t[ch];
 }
 
 Float TabulatedBSSRDF::Pdf_Sr(int ch, Float r) const {
+    if (!sliceValid[ch]) return 0.f;
     // Convert $r$ into unitless optical radius $r_{\roman{optical}}$
     Float rOptical = r * sigma_t[ch];
 
-    // Compute spline weights to interpolate BSSRDF density on channel _ch_
-    int rhoOffset, radiusOffset;
-    Float rhoWeights[4], radiusWeights[4];
-    if (!CatmullRomWeights(table.nRhoSamples, table.rhoSamples.get(), rho[ch],
-                           &rhoOffset, rhoWeights) ||
-        !CatmullRomWeights(table.nRadiusSamples, table.radiusSamples.get(),
+    // Interpolate the channel's precomputed radial profile slice
+    int radiusOffset;
+    Float radiusWeights[4];
+    if (!CatmullRomWeights(table.nRadiusSamples, table.radiusSamples.get(),
                            rOptical, &radiusOffset, radiusWeights))
         return 0.f;
-
-    // Return BSSRDF profile density for channel _ch_
-    Float sr = 0, rhoEff = 0;
-    for (int i = 0; i < 4; ++i) {
-        if (rhoWeights[i] == 0) continue;
-        rhoEff += table.rhoEff[rhoOffset + i] * rhoWeights[i];
-        for (int j = 0; j < 4; ++j) {
-            if (radiusWeights[j] == 0) continue;
-            sr += table.EvalProfile(rhoOffset + i, radiusOffset + j) *
-                  rhoWeights[i] * radiusWeights[j];
-        }
-    }
+    const Float *profileSlice = radialProfile + ch * table.nRadiusSamples;
+    Float sr = 0;
+    for (int j = 0; j < 4; ++j)
+        if (radiusWeights[j] != 0)
+            sr += radiusWeights[j] * profileSlice[radiusOffset + j];
 
     // Cancel marginal PDF factor from tabulated BSSRDF profile
     if (rOptical != 0) sr /= 2 * Pi * rOptical;
-    return std::max((Float)0, sr * sigma_t[ch] * sigma_t[ch] / rhoEff);
+    return std::max((Float)0,
+                    sr * sigma_t[ch] * sigma_t[ch] / rhoEffCh[ch]);
 }
@@ -116,12 +116,8 @@ class TabulatedBSSRDF : public SeparableBSSRDF {
     // TabulatedBSSRDF Public Methods
     TabulatedBSSRDF(const SurfaceInteraction &po, const Material *material,
                     TransportMode mode, Float eta, const Spectrum &sigma_a,
-                    const Spectrum &sigma_s, const BSSRDFTable &table)
-        : SeparableBSSRDF(po, eta, material, mode), table(table) {
-        sigma_t = sigma_a + sigma_s;
-        for (int c = 0; c < Spectrum::nSamples; ++c)
-            rho[c] = sigma_t[c] != 0 ? (sigma_s[c] / sigma_t[c]) : 0;
-    }
+                    const Spectrum &sigma_s, const BSSRDFTable &table,
+                    MemoryArena &arena);
     Spectrum Sr(Float distance) const;
     Float Pdf_Sr(int ch, Float distance) const;
     Float Sample_Sr(int ch, Float sample) const;
@@ -130,6 +126,14 @@ class TabulatedBSSRDF : public SeparableBSSRDF {
     // TabulatedBSSRDF Private Data
     const BSSRDFTable &table;
     Spectrum sigma_t, rho;
+    // Per-channel radial slices of the profile and its CDF: rho is
+    // fixed per instance, so the albedo dimension of the table is
+    // collapsed once at construction and every Sr/Pdf_Sr/Sample_Sr
+    // call reduces to a 1D radial spline instead of re-deriving the
+    // 2D Catmull-Rom weights per probe
+    Float *radialProfile, *radialCDF;
+    Spectrum rhoEffCh;
+    bool sliceValid[Spectrum::nSamples];
 };
 
 struct BSSRDFTable {
@@ -170,6 +174,11 @@ Float BeamDiffusionSS(Float sigma_s, Float sigma_a, Float g, Float eta,
 Float BeamDiffusionMS(Float sigma_s, Float sigma_a, Float g, Float eta,
                       Float r);
 void ComputeBeamDiffusionBSSRDF(Float g, Float eta, BSSRDFTable *t);
+// Return the shared 100x64 beam-diffusion table for (g, eta) -- the
+// only parameters the table depends on; sigma_a/sigma_s enter at
+// lookup time.  Tables are computed at most once per process and
+// persisted in an on-disk cache so repeated presets load instantly.
+std::shared_ptr<BSSRDFTable> GetBeamDiffusionBSSRDFTable(Float g, Float eta);
 void SubsurfaceFromDiffuse(const BSSRDFTable &table, const Spectrum &rhoEff,
                            const Spectrum &mfp, Spectrum *sigma_a,
                            Spectrum *sigma_s);
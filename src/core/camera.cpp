@@ -76,6 +76,11 @@ Float Camera::GenerateRayDifferential(const CameraSample &sample,
     rd->ryOrigin = ry.o;
     rd->ryDirection = ry.d;
     rd->hasDifferentials = true;
+    // Record the per-pixel angular spread so instanced geometry can
+    // estimate its projected size for proxy-LOD selection
+    rd->footprintSpread =
+        std::max((Normalize(rd->rxDirection) - Normalize(rd->d)).Length(),
+                 (Normalize(rd->ryDirection) - Normalize(rd->d)).Length());
     return wt;
 }
 
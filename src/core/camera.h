@@ -62,7 +62,7 @@ class Camera {
 
     // Camera Public Data
     AnimatedTransform CameraToWorld;
-    const Float shutterOpen, shutterClose;
+    Float shutterOpen, shutterClose;
     Film *film;
     const Medium *medium;
 };
@@ -0,0 +1,249 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// core/distributed.cpp*
+#include "distributed.h"
+#include "film.h"
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#if !defined(PBRT_IS_WINDOWS)
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define PBRT_DIST_HAVE_SOCKETS
+#endif
+
+// Distributed Rendering Local Definitions
+static std::mutex distMutex;
+static bool distInitialized = false;
+static bool isCoordinator = false;
+static int nWorkers = 0;
+#ifdef PBRT_DIST_HAVE_SOCKETS
+static int listenFd = -1, workerFd = -1;
+static std::thread acceptThread;
+static std::set<uint64_t> claimedUnits;
+static std::vector<std::vector<Float>> receivedFilms;
+static std::mutex claimMutex;
+static std::vector<std::thread> connectionThreads;
+
+static bool ReadAll(int fd, void *buffer, size_t size) {
+    char *dst = (char *)buffer;
+    while (size > 0) {
+        ssize_t n = read(fd, dst, size);
+        if (n <= 0) return false;
+        dst += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool WriteAll(int fd, const void *buffer, size_t size) {
+    const char *src = (const char *)buffer;
+    while (size > 0) {
+        ssize_t n = write(fd, src, size);
+        if (n <= 0) return false;
+        src += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Serve one worker connection: claim requests until the final film dump
+static void ServeConnection(int fd) {
+    for (;;) {
+        char op;
+        if (!ReadAll(fd, &op, 1)) break;
+        if (op == 'C') {
+            uint64_t key;
+            if (!ReadAll(fd, &key, sizeof(key))) break;
+            char granted;
+            {
+                std::lock_guard<std::mutex> lock(claimMutex);
+                granted = claimedUnits.insert(key).second ? 1 : 0;
+            }
+            if (!WriteAll(fd, &granted, 1)) break;
+        } else if (op == 'F') {
+            int64_t count;
+            if (!ReadAll(fd, &count, sizeof(count))) break;
+            std::vector<Float> sums(count);
+            if (!ReadAll(fd, &sums[0], count * sizeof(Float))) break;
+            std::lock_guard<std::mutex> lock(claimMutex);
+            receivedFilms.push_back(std::move(sums));
+            break;
+        } else
+            break;
+    }
+    close(fd);
+}
+#endif  // PBRT_DIST_HAVE_SOCKETS
+
+static void DistInitialize() {
+    std::lock_guard<std::mutex> lock(distMutex);
+    if (distInitialized) return;
+    distInitialized = true;
+#ifdef PBRT_DIST_HAVE_SOCKETS
+    if (PbrtOptions.distServe != "") {
+        // Parse "port:nworkers" and start accepting worker connections
+        isCoordinator = true;
+        int port = atoi(PbrtOptions.distServe.c_str());
+        size_t colon = PbrtOptions.distServe.find(':');
+        nWorkers = colon == std::string::npos
+                       ? 0
+                       : atoi(PbrtOptions.distServe.c_str() + colon + 1);
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = INADDR_ANY;
+        addr.sin_port = htons(port);
+        if (listenFd < 0 ||
+            bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            listen(listenFd, 64) != 0)
+            Severe("Unable to listen on coordinator port %d", port);
+        acceptThread = std::thread([]() {
+            for (;;) {
+                int fd = accept(listenFd, nullptr, nullptr);
+                if (fd < 0) return;
+                std::lock_guard<std::mutex> lock(claimMutex);
+                connectionThreads.push_back(
+                    std::thread(ServeConnection, fd));
+            }
+        });
+    } else if (PbrtOptions.distWorker != "") {
+        // Connect to "host:port"
+        size_t colon = PbrtOptions.distWorker.find(':');
+        if (colon == std::string::npos)
+            Severe("--distworker expects host:port");
+        std::string host = PbrtOptions.distWorker.substr(0, colon);
+        int port = atoi(PbrtOptions.distWorker.c_str() + colon + 1);
+        struct hostent *entry = gethostbyname(host.c_str());
+        if (!entry) Severe("Unable to resolve coordinator \"%s\"",
+                           host.c_str());
+        workerFd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        memcpy(&addr.sin_addr, entry->h_addr_list[0], entry->h_length);
+        addr.sin_port = htons(port);
+        if (workerFd < 0 ||
+            connect(workerFd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+            Severe("Unable to connect to coordinator \"%s\"",
+                   PbrtOptions.distWorker.c_str());
+    }
+#else
+    if (PbrtOptions.distServe != "" || PbrtOptions.distWorker != "")
+        Severe("Distributed rendering requires socket support");
+#endif  // PBRT_DIST_HAVE_SOCKETS
+}
+
+// Distributed Rendering Function Definitions
+bool DistEnabled() {
+    return PbrtOptions.distServe != "" || PbrtOptions.distWorker != "";
+}
+
+bool DistIsCoordinator() {
+    return PbrtOptions.distWorker == "";
+}
+
+bool DistClaimWorkUnit(const char *scope, int64_t id) {
+    if (!DistEnabled()) return true;
+    DistInitialize();
+
+    // Derive a stable key from the scope name and unit id
+    uint64_t key = 14695981039346656037ull;
+    for (const char *c = scope; *c; ++c) {
+        key ^= (unsigned char)*c;
+        key *= 1099511628211ull;
+    }
+    key ^= (uint64_t)id;
+    key *= 1099511628211ull;
+#ifdef PBRT_DIST_HAVE_SOCKETS
+    if (isCoordinator) {
+        std::lock_guard<std::mutex> lock(claimMutex);
+        return claimedUnits.insert(key).second;
+    }
+    // One claim round-trip at a time per worker
+    static std::mutex workerMutex;
+    std::lock_guard<std::mutex> lock(workerMutex);
+    char op = 'C', granted = 0;
+    if (!WriteAll(workerFd, &op, 1) ||
+        !WriteAll(workerFd, &key, sizeof(key)) ||
+        !ReadAll(workerFd, &granted, 1))
+        Severe("Lost connection to coordinator");
+    return granted != 0;
+#else
+    return true;
+#endif  // PBRT_DIST_HAVE_SOCKETS
+}
+
+bool DistFinishFilm(Film *film) {
+    if (!DistEnabled()) return true;
+    DistInitialize();
+#ifdef PBRT_DIST_HAVE_SOCKETS
+    if (!isCoordinator) {
+        // Stream this worker's pixel and splat sums to the coordinator
+        std::vector<Float> sums;
+        film->ExportPixelSums(&sums);
+        char op = 'F';
+        int64_t count = sums.size();
+        if (!WriteAll(workerFd, &op, 1) ||
+            !WriteAll(workerFd, &count, sizeof(count)) ||
+            !WriteAll(workerFd, &sums[0], count * sizeof(Float)))
+            Severe("Lost connection to coordinator");
+        close(workerFd);
+        return false;
+    }
+
+    // Wait for every worker's film, then fold the sums into ours
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(claimMutex);
+            if ((int)receivedFilms.size() >= nWorkers) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    std::lock_guard<std::mutex> lock(claimMutex);
+    for (const std::vector<Float> &sums : receivedFilms)
+        film->MergePixelSums(&sums[0], sums.size());
+    return true;
+#else
+    return true;
+#endif  // PBRT_DIST_HAVE_SOCKETS
+}
@@ -0,0 +1,69 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_DISTRIBUTED_H
+#define PBRT_CORE_DISTRIBUTED_H
+
+// core/distributed.h*
+#include "pbrt.h"
+
+// Distributed rendering across nodes sharing one frame: every instance
+// parses the same scene; the coordinator (--distserve port:nworkers)
+// hands out work-unit claims over a socket and the workers
+// (--distworker host:port) claim units before rendering them.  Each
+// integrator's natural unit is used (render tiles, MLT chain batches),
+// claimed through DistClaimWorkUnit() by a deterministic id, so all
+// nodes enumerate identical units and each is rendered exactly once.
+// When rendering finishes, workers stream their whole film (pixel and
+// splat sums) to the coordinator, which adds them into its own film --
+// splats merge additively, so splatting integrators are correct across
+// tile seams -- and only the coordinator writes the image.
+
+// True when -​-distserve or --distworker was given
+bool DistEnabled();
+// True on the coordinating instance (or when not distributed at all)
+bool DistIsCoordinator();
+// Claim work unit _id_ within the named scope; exactly one node's
+// claim succeeds.  Scopes keep ids from different integrator phases
+// distinct.
+bool DistClaimWorkUnit(const char *scope, int64_t id);
+// Finish the frame: workers send their film's sums to the coordinator
+// and return false; the coordinator folds every worker's sums into
+// _film_ and returns true, meaning this node should write the image.
+bool DistFinishFilm(Film *film);
+
+#endif  // PBRT_CORE_DISTRIBUTED_H
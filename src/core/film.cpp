@@ -35,16 +35,21 @@
 #include "film.h"
 #include "paramset.h"
 #include "imageio.h"
+#include "framestream.h"
 
 // Film Method Definitions
 Film::Film(const Point2i &resolution, const Bounds2f &cropWindow,
            std::unique_ptr<Filter> filt, Float diagonal,
-           const std::string &filename, Float scale)
-    : fullResolution(resolution),
+           const std::string &filename, Float scale, bool trackMoments,
+           bool bucketed)
+    : bucketed(bucketed),
+      fullResolution(resolution),
       diagonal(diagonal * .001),
       filter(std::move(filt)),
       filename(filename),
-      scale(scale) {
+      scale(scale),
+      previewWriting(false),
+      lastPreviewTime(std::chrono::steady_clock::now()) {
     // Compute film image bounds
     croppedPixelBounds =
         Bounds2i(Point2i(std::ceil(fullResolution.x * cropWindow.pMin.x),
@@ -52,8 +57,35 @@ Film::Film(const Point2i &resolution, const Bounds2f &cropWindow,
                  Point2i(std::ceil(fullResolution.x * cropWindow.pMax.x),
                          std::ceil(fullResolution.y * cropWindow.pMax.y)));
 
-    // Allocate film image storage
-    pixels = std::unique_ptr<Pixel[]>(new Pixel[croppedPixelBounds.Area()]);
+    // Allocate film image storage and per-thread splat caches; in
+    // bucketed mode there is no full-resolution array -- pixel sums
+    // live in on-demand buckets that stream out as they complete
+    if (!bucketed)
+        pixels =
+            std::unique_ptr<Pixel[]>(new Pixel[croppedPixelBounds.Area()]);
+    else {
+        std::string streamName = filename;
+        size_t dot = streamName.find_last_of('.');
+        if (dot != std::string::npos) streamName.resize(dot);
+        streamName += ".pfs";
+        // The bucketed film only writes the .pfs tile stream; make the
+        // substituted output path visible rather than silently leaving
+        // the configured image file unwritten
+        if (streamName != filename)
+            Warning("Bucketed film writes the tile stream \"%s\" instead "
+                    "of \"%s\"; any ReadImage consumer (e.g. hdrtoldr, "
+                    "exrdiff) can assemble the frame from it.",
+                    streamName.c_str(), filename.c_str());
+        bucketWriter.reset(new FrameStreamWriter(streamName, fullResolution,
+                                                 croppedPixelBounds));
+        if (!bucketWriter->Good())
+            Error("Unable to open bucketed film stream \"%s\"",
+                  streamName.c_str());
+    }
+    if (trackMoments)
+        moments = std::unique_ptr<MomentsPixel[]>(
+            new MomentsPixel[croppedPixelBounds.Area()]);
+    splatCaches.resize(MaxThreadIndex());
 
     // Precompute filter weight table
     int offset = 0;
@@ -67,6 +99,189 @@ Film::Film(const Point2i &resolution, const Bounds2f &cropWindow,
     }
 }
 
+Film::~Film() {}
+
+// Film checkpoint file layout: _FilmCheckpointHeader_, then the
+// per-pixel xyz, filterWeightSum, and splatXYZ sums for every pixel in
+// _croppedPixelBounds_ in row-major order.
+struct FilmCheckpointHeader {
+    uint32_t magic, version;
+    uint32_t floatSize;
+    int32_t resolutionX, resolutionY;
+    int32_t boundsMinX, boundsMinY, boundsMaxX, boundsMaxY;
+    int64_t progress;
+};
+static const uint32_t filmCheckpointMagic = 0x50434250;  // "PBCP"
+static const uint32_t filmCheckpointVersion = 1;
+static PBRT_CONSTEXPR int nCheckpointChannels = 7;
+
+std::string Film::CheckpointFilename() const { return filename + ".ckpt"; }
+
+bool Film::WriteCheckpoint(int64_t progress) {
+    if (bucketed) return false;
+    MergeSplatStripes();
+    // Write the checkpoint to a temporary file and rename it into place
+    // so that a preemption mid-write can't corrupt an older checkpoint.
+    std::string ckptName = CheckpointFilename();
+    std::string tmpName = ckptName + ".tmp";
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (!f) {
+        Warning("Unable to write checkpoint file \"%s\"", tmpName.c_str());
+        return false;
+    }
+    FilmCheckpointHeader header;
+    header.magic = filmCheckpointMagic;
+    header.version = filmCheckpointVersion;
+    header.floatSize = sizeof(Float);
+    header.resolutionX = fullResolution.x;
+    header.resolutionY = fullResolution.y;
+    header.boundsMinX = croppedPixelBounds.pMin.x;
+    header.boundsMinY = croppedPixelBounds.pMin.y;
+    header.boundsMaxX = croppedPixelBounds.pMax.x;
+    header.boundsMaxY = croppedPixelBounds.pMax.y;
+    header.progress = progress;
+    int nPixels = croppedPixelBounds.Area();
+    std::vector<Float> buf(nCheckpointChannels * (size_t)nPixels);
+    for (int i = 0; i < nPixels; ++i) {
+        const Pixel &p = pixels[i];
+        Float *dst = &buf[nCheckpointChannels * (size_t)i];
+        for (int c = 0; c < 3; ++c) dst[c] = p.xyz[c];
+        dst[3] = p.filterWeightSum;
+        for (int c = 0; c < 3; ++c) dst[4 + c] = p.splatXYZ[c];
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(buf.data(), sizeof(Float), buf.size(), f) == buf.size();
+    fclose(f);
+    if (!ok || rename(tmpName.c_str(), ckptName.c_str()) != 0) {
+        Warning("Error writing checkpoint file \"%s\"", ckptName.c_str());
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Film::ReadCheckpoint(int64_t *progress) {
+    if (bucketed) return false;
+    std::string ckptName = CheckpointFilename();
+    FILE *f = fopen(ckptName.c_str(), "rb");
+    if (!f) return false;
+    FilmCheckpointHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != filmCheckpointMagic ||
+        header.version != filmCheckpointVersion ||
+        header.floatSize != sizeof(Float) ||
+        header.resolutionX != fullResolution.x ||
+        header.resolutionY != fullResolution.y ||
+        header.boundsMinX != croppedPixelBounds.pMin.x ||
+        header.boundsMinY != croppedPixelBounds.pMin.y ||
+        header.boundsMaxX != croppedPixelBounds.pMax.x ||
+        header.boundsMaxY != croppedPixelBounds.pMax.y) {
+        Warning("Ignoring checkpoint file \"%s\": stale or incompatible",
+                ckptName.c_str());
+        fclose(f);
+        return false;
+    }
+    int nPixels = croppedPixelBounds.Area();
+    std::vector<Float> buf(nCheckpointChannels * (size_t)nPixels);
+    if (fread(buf.data(), sizeof(Float), buf.size(), f) != buf.size()) {
+        Warning("Ignoring checkpoint file \"%s\": truncated",
+                ckptName.c_str());
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+    for (int i = 0; i < nPixels; ++i) {
+        Pixel &p = pixels[i];
+        const Float *src = &buf[nCheckpointChannels * (size_t)i];
+        for (int c = 0; c < 3; ++c) p.xyz[c] = src[c];
+        p.filterWeightSum = src[3];
+        for (int c = 0; c < 3; ++c) p.splatXYZ[c] = src[4 + c];
+    }
+    *progress = header.progress;
+    return true;
+}
+
+void Film::RemoveCheckpoint() { remove(CheckpointFilename().c_str()); }
+
+void Film::ExportPixelSums(std::vector<Float> *sums) const {
+    if (bucketed) {
+        sums->clear();
+        return;
+    }
+    const_cast<Film *>(this)->MergeSplatStripes();
+    // Serialize the per-pixel xyz, filterWeightSum, and splatXYZ sums
+    // (the distributed-rendering wire format)
+    int nPixels = croppedPixelBounds.Area();
+    sums->resize(nCheckpointChannels * (size_t)nPixels);
+    for (int i = 0; i < nPixels; ++i) {
+        const Pixel &p = pixels[i];
+        Float *dst = &(*sums)[nCheckpointChannels * (size_t)i];
+        for (int c = 0; c < 3; ++c) dst[c] = p.xyz[c];
+        dst[3] = p.filterWeightSum;
+        for (int c = 0; c < 3; ++c) dst[4 + c] = p.splatXYZ[c];
+    }
+}
+
+void Film::MergePixelSums(const Float *sums, size_t count) {
+    if (bucketed) return;
+    int nPixels = croppedPixelBounds.Area();
+    if (count != nCheckpointChannels * (size_t)nPixels) {
+        Warning("Ignoring film sums with mismatched size");
+        return;
+    }
+    for (int i = 0; i < nPixels; ++i) {
+        Pixel &p = pixels[i];
+        const Float *src = &sums[nCheckpointChannels * (size_t)i];
+        for (int c = 0; c < 3; ++c) p.xyz[c].Add(src[c]);
+        p.filterWeightSum.Add(src[3]);
+        for (int c = 0; c < 3; ++c) p.splatXYZ[c].Add(src[4 + c]);
+    }
+}
+
+void Film::StreamTileTo(FrameStreamWriter *writer,
+                        const Bounds2i &tileBounds) {
+    if (bucketed) return;
+    // Emit the tile's current weighted-average RGB to the frame
+    // stream; pixels still awaiting neighboring tiles' filter overlap
+    // are refined by later passes of downstream consumers re-reading
+    Bounds2i bounds = Intersect(tileBounds, croppedPixelBounds);
+    if (bounds.Area() <= 0) return;
+    std::vector<Float> rgb(3 * (size_t)bounds.Area());
+    int i = 0;
+    for (Point2i p : bounds) {
+        const Pixel &pixel = GetPixel(p);
+        Float xyz[3] = {pixel.xyz[0], pixel.xyz[1], pixel.xyz[2]};
+        Float weight = pixel.filterWeightSum;
+        Float out[3];
+        XYZToRGB(xyz, out);
+        for (int c = 0; c < 3; ++c)
+            rgb[3 * i + c] = weight > 0 ? out[c] / weight : 0;
+        ++i;
+    }
+    writer->WriteTile(bounds, &rgb[0]);
+}
+
+void Film::WritePreviewImage(Float splatScale) {
+    if (bucketed) return;
+    MergeSplatStripes();
+    // Write a rolling snapshot of the (atomically merged) pixel sums to
+    // the output image so in-progress renders can be inspected.  A
+    // single thread writes at a time; callers that lose the race or
+    // arrive before the preview interval has elapsed return immediately,
+    // so the cost stays negligible relative to rendering.
+    if (PbrtOptions.previewSeconds <= 0) return;
+    if (previewWriting.exchange(true)) return;
+    Float sinceLastPreview =
+        std::chrono::duration<Float>(std::chrono::steady_clock::now() -
+                                     lastPreviewTime)
+            .count();
+    if (sinceLastPreview >= PbrtOptions.previewSeconds) {
+        WriteImage(splatScale);
+        lastPreviewTime = std::chrono::steady_clock::now();
+    }
+    previewWriting = false;
+}
+
 Bounds2i Film::GetSampleBounds() const {
     Bounds2f floatBounds(Floor(Point2f(croppedPixelBounds.pMin) +
                                Vector2f(0.5f, 0.5f) - filter->radius),
@@ -90,35 +305,182 @@ std::unique_ptr<FilmTile> Film::GetFilmTile(const Bounds2i &sampleBounds) {
     Point2i p1 = (Point2i)Floor(floatBounds.pMax - halfPixel + filter->radius) +
                  Point2i(1, 1);
     Bounds2i tilePixelBounds = Intersect(Bounds2i(p0, p1), croppedPixelBounds);
-    return std::unique_ptr<FilmTile>(new FilmTile(
-        tilePixelBounds, filter->radius, filterTable, filterTableWidth));
+    return std::unique_ptr<FilmTile>(
+        new FilmTile(tilePixelBounds, filter->radius, filterTable,
+                     filterTableWidth, moments != nullptr,
+                     filter->IsBox()));
+}
+
+static PBRT_CONSTEXPR int filmBucketSize = 64;
+
+Film::FilmBucket *Film::GetBucket(const Point2i &p) {
+    // Callers hold _bucketsMutex_
+    int bx = p.x >= 0 ? p.x / filmBucketSize
+                      : -((-p.x + filmBucketSize - 1) / filmBucketSize);
+    int by = p.y >= 0 ? p.y / filmBucketSize
+                      : -((-p.y + filmBucketSize - 1) / filmBucketSize);
+    uint64_t key = ((uint64_t)(uint32_t)bx << 32) | (uint32_t)by;
+    auto iter = buckets.find(key);
+    if (iter != buckets.end()) return iter->second.get();
+    std::unique_ptr<FilmBucket> bucket(new FilmBucket);
+    bucket->pixelBounds = Intersect(
+        Bounds2i(Point2i(bx * filmBucketSize, by * filmBucketSize),
+                 Point2i((bx + 1) * filmBucketSize,
+                         (by + 1) * filmBucketSize)),
+        croppedPixelBounds);
+    bucket->sums.assign((size_t)bucket->pixelBounds.Area() * 4, 0);
+    // The bucket is complete once every sample position that can
+    // reach it through the filter has been reported
+    Bounds2f reach((Point2f)bucket->pixelBounds.pMin -
+                       filter->radius - Vector2f(0.5f, 0.5f),
+                   (Point2f)bucket->pixelBounds.pMax + filter->radius +
+                       Vector2f(0.5f, 0.5f));
+    Bounds2f sampleBounds = (Bounds2f)GetSampleBounds();
+    Bounds2f clipped(Max(reach.pMin, sampleBounds.pMin),
+                     Min(reach.pMax, sampleBounds.pMax));
+    Vector2f d = clipped.pMax - clipped.pMin;
+    bucket->remainingArea = std::max((Float)0, d.x) * std::max((Float)0, d.y);
+    FilmBucket *result = bucket.get();
+    buckets[key] = std::move(bucket);
+    return result;
+}
+
+void Film::FlushBucket(FilmBucket *bucket) {
+    // Convert the bucket's sums to RGB and append it to the stream
+    int nPixels = bucket->pixelBounds.Area();
+    std::vector<Float> rgb(3 * (size_t)nPixels);
+    for (int i = 0; i < nPixels; ++i) {
+        Float xyz[3] = {bucket->sums[4 * i], bucket->sums[4 * i + 1],
+                        bucket->sums[4 * i + 2]};
+        XYZToRGB(xyz, &rgb[3 * i]);
+        Float weight = bucket->sums[4 * i + 3];
+        Float invWt = weight != 0 ? 1 / weight : 0;
+        for (int c = 0; c < 3; ++c)
+            rgb[3 * i + c] =
+                std::max((Float)0, rgb[3 * i + c] * invWt) * scale;
+    }
+    if (bucketWriter && bucketWriter->Good())
+        bucketWriter->WriteTile(bucket->pixelBounds, &rgb[0]);
+}
+
+void Film::ReportSampleRegionComplete(const Bounds2i &sampleRegion) {
+    if (!bucketed) return;
+    std::lock_guard<std::mutex> lock(bucketsMutex);
+    // Subtract this region's area from every bucket it can reach;
+    // buckets whose reachable sample area is exhausted stream out and
+    // are dropped from memory
+    Bounds2f region = (Bounds2f)sampleRegion;
+    for (auto iter = buckets.begin(); iter != buckets.end();) {
+        FilmBucket *bucket = iter->second.get();
+        Bounds2f reach((Point2f)bucket->pixelBounds.pMin -
+                           filter->radius - Vector2f(0.5f, 0.5f),
+                       (Point2f)bucket->pixelBounds.pMax + filter->radius +
+                           Vector2f(0.5f, 0.5f));
+        Bounds2f overlap(Max(reach.pMin, region.pMin),
+                         Min(reach.pMax, region.pMax));
+        Vector2f d = overlap.pMax - overlap.pMin;
+        if (d.x > 0 && d.y > 0) {
+            bucket->remainingArea -= d.x * d.y;
+            if (bucket->remainingArea <= 0.5f) {
+                FlushBucket(bucket);
+                iter = buckets.erase(iter);
+                continue;
+            }
+        }
+        ++iter;
+    }
 }
 
 void Film::MergeFilmTile(std::unique_ptr<FilmTile> tile) {
     ProfilePhase p(Prof::MergeFilmTile);
-    std::lock_guard<std::mutex> lock(mutex);
+    if (bucketed) {
+        // Accumulate into on-demand buckets under the bucket mutex
+        std::lock_guard<std::mutex> lock(bucketsMutex);
+        for (Point2i pixel : tile->GetPixelBounds()) {
+            const FilmTilePixel &tilePixel = tile->GetPixel(pixel);
+            FilmBucket *bucket = GetBucket(pixel);
+            int width =
+                bucket->pixelBounds.pMax.x - bucket->pixelBounds.pMin.x;
+            int offset = (pixel.x - bucket->pixelBounds.pMin.x) +
+                         (pixel.y - bucket->pixelBounds.pMin.y) * width;
+            Float xyz[3];
+            tilePixel.contribSum.ToXYZ(xyz);
+            for (int i = 0; i < 3; ++i) bucket->sums[4 * offset + i] += xyz[i];
+            bucket->sums[4 * offset + 3] += tilePixel.filterWeightSum;
+        }
+        return;
+    }
     for (Point2i pixel : tile->GetPixelBounds()) {
-        // Merge _pixel_ into _Film::pixels_
+        // Merge _pixel_ into _Film::pixels_; atomic adds let merging
+        // threads proceed concurrently, so no film mutex is needed
         const FilmTilePixel &tilePixel = tile->GetPixel(pixel);
         Pixel &mergePixel = GetPixel(pixel);
         Float xyz[3];
         tilePixel.contribSum.ToXYZ(xyz);
-        for (int i = 0; i < 3; ++i) mergePixel.xyz[i] += xyz[i];
-        mergePixel.filterWeightSum += tilePixel.filterWeightSum;
+        for (int i = 0; i < 3; ++i) mergePixel.xyz[i].Add(xyz[i]);
+        mergePixel.filterWeightSum.Add(tilePixel.filterWeightSum);
+    }
+
+    // Combine the tile's sample moments with the film's (Chan et al.
+    // pairwise formulas); a mutex is fine here since each tile merges
+    // once
+    if (moments && tile->HasMoments()) {
+        std::lock_guard<std::mutex> lock(momentsMutex);
+        for (Point2i pixel : tile->GetPixelBounds()) {
+            const MomentsPixel &b = tile->GetMoments(pixel);
+            if (b.n == 0) continue;
+            int offset = (pixel.x - croppedPixelBounds.pMin.x) +
+                         (pixel.y - croppedPixelBounds.pMin.y) *
+                             (croppedPixelBounds.pMax.x -
+                              croppedPixelBounds.pMin.x);
+            MomentsPixel &a = moments[offset];
+            double nAB = a.n + b.n;
+            double dLum = b.meanLum - a.meanLum;
+            a.m2Lum += b.m2Lum + dLum * dLum * a.n * b.n / nAB;
+            a.meanLum += dLum * b.n / nAB;
+            double d[3];
+            for (int c = 0; c < 3; ++c) d[c] = b.mean[c] - a.mean[c];
+            a.cov[0] += b.cov[0] + d[0] * d[1] * a.n * b.n / nAB;
+            a.cov[1] += b.cov[1] + d[0] * d[2] * a.n * b.n / nAB;
+            a.cov[2] += b.cov[2] + d[1] * d[2] * a.n * b.n / nAB;
+            for (int c = 0; c < 3; ++c) a.mean[c] += d[c] * b.n / nAB;
+            a.n = nAB;
+        }
     }
 }
 
 void Film::SetImage(const Spectrum *img) const {
+    if (bucketed) return;
     int nPixels = croppedPixelBounds.Area();
     for (int i = 0; i < nPixels; ++i) {
         Pixel &p = pixels[i];
-        img[i].ToXYZ(p.xyz);
+        Float xyz[3];
+        img[i].ToXYZ(xyz);
+        for (int c = 0; c < 3; ++c) p.xyz[c] = xyz[c];
         p.filterWeightSum = 1;
         p.splatXYZ[0] = p.splatXYZ[1] = p.splatXYZ[2] = 0;
     }
 }
 
+void Film::Clear() {
+    if (bucketed) return;
+    MergeSplatStripes();
+    for (Point2i p : croppedPixelBounds) {
+        Pixel &pixel = GetPixel(p);
+        for (int c = 0; c < 3; ++c)
+            pixel.splatXYZ[c] = pixel.xyz[c] = 0;
+        pixel.filterWeightSum = 0;
+    }
+}
+
 void Film::AddSplat(const Point2f &p, const Spectrum &v) {
+    if (bucketed) {
+        static std::atomic<bool> warned(false);
+        if (!warned.exchange(true))
+            Warning("Splats are not supported by the bucketed film; "
+                    "ignoring them.");
+        return;
+    }
     if (v.HasNaNs()) {
         Warning("Film ignoring splatted spectrum with NaN values");
         return;
@@ -127,48 +489,168 @@ void Film::AddSplat(const Point2f &p, const Spectrum &v) {
     if (!InsideExclusive((Point2i)p, croppedPixelBounds)) return;
     Float xyz[3];
     v.ToXYZ(xyz);
-    Pixel &pixel = GetPixel((Point2i)p);
-    for (int i = 0; i < 3; ++i) pixel.splatXYZ[i].Add(xyz[i]);
+
+    // Accumulate the splat in this thread's cache; the atomic sums are
+    // only touched when a direct-mapped slot is evicted by a splat to a
+    // different pixel.
+    Point2i pi = (Point2i)p;
+    int width = croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x;
+    int32_t offset = (pi.x - croppedPixelBounds.pMin.x) +
+                     (pi.y - croppedPixelBounds.pMin.y) * width;
+    SplatCacheEntry &entry =
+        splatCaches[ThreadIndex].entries[offset & (splatCacheSize - 1)];
+    if (entry.offset != offset) {
+        FlushSplatCacheEntry(entry);
+        entry.offset = offset;
+        entry.xyz[0] = entry.xyz[1] = entry.xyz[2] = 0;
+    }
+    for (int i = 0; i < 3; ++i) entry.xyz[i] += xyz[i];
+}
+
+void Film::FlushSplatCacheEntry(SplatCacheEntry &entry) {
+    if (entry.offset < 0) return;
+    if (splatStripes) {
+        AtomicFloat *stripe =
+            &splatStripes[((size_t)(ThreadIndex & (nSplatStripes - 1)) *
+                               croppedPixelBounds.Area() +
+                           entry.offset) *
+                          3];
+        for (int i = 0; i < 3; ++i) stripe[i].Add(entry.xyz[i]);
+        return;
+    }
+    Pixel &pixel = pixels[entry.offset];
+    for (int i = 0; i < 3; ++i) pixel.splatXYZ[i].Add(entry.xyz[i]);
+}
+
+void Film::EnableSplatStriping() {
+    if (splatStripes) return;
+    splatStripes = std::unique_ptr<AtomicFloat[]>(
+        new AtomicFloat[(size_t)nSplatStripes * croppedPixelBounds.Area() *
+                        3]);
+}
+
+void Film::MergeSplatStripes() {
+    if (!splatStripes) return;
+    int nPixels = croppedPixelBounds.Area();
+    ParallelForRange(
+        [&](int64_t begin, int64_t end) {
+            for (int64_t pixelOffset = begin; pixelOffset < end;
+                 ++pixelOffset) {
+                Pixel &pixel = pixels[pixelOffset];
+                for (int stripe = 0; stripe < nSplatStripes; ++stripe) {
+                    AtomicFloat *sums =
+                        &splatStripes[((size_t)stripe * nPixels +
+                                       pixelOffset) *
+                                      3];
+                    for (int i = 0; i < 3; ++i) {
+                        Float value = sums[i].Exchange(0);
+                        if (value != 0) pixel.splatXYZ[i].Add(value);
+                    }
+                }
+            }
+        },
+        nPixels, 4096);
+}
+
+void Film::FlushSplats() {
+    // Drain every thread's splat cache into the atomic sums.  Only safe
+    // to call while no render threads are splatting, i.e. between
+    // parallel phases or after rendering has finished.
+    for (SplatCache &cache : splatCaches)
+        for (SplatCacheEntry &entry : cache.entries) {
+            FlushSplatCacheEntry(entry);
+            entry.offset = -1;
+        }
 }
 
 void Film::WriteImage(Float splatScale) {
+    // In bucketed mode the image has been streaming out as buckets
+    // completed; flush whatever remains and finish the stream
+    if (bucketed) {
+        {
+            std::lock_guard<std::mutex> lock(bucketsMutex);
+            for (auto &entry : buckets) FlushBucket(entry.second.get());
+            buckets.clear();
+        }
+        if (bucketWriter) bucketWriter->Finish();
+        return;
+    }
+    MergeSplatStripes();
     // Convert image to RGB and compute final pixel values
     std::unique_ptr<Float[]> rgb(new Float[3 * croppedPixelBounds.Area()]);
-    int offset = 0;
-    for (Point2i p : croppedPixelBounds) {
-        // Convert pixel XYZ color to RGB
-        Pixel &pixel = GetPixel(p);
-        XYZToRGB(pixel.xyz, &rgb[3 * offset]);
-
-        // Normalize pixel with weight sum
-        Float filterWeightSum = pixel.filterWeightSum;
-        if (filterWeightSum != 0) {
-            Float invWt = (Float)1 / filterWeightSum;
-            rgb[3 * offset] = std::max((Float)0, rgb[3 * offset] * invWt);
-            rgb[3 * offset + 1] =
-                std::max((Float)0, rgb[3 * offset + 1] * invWt);
-            rgb[3 * offset + 2] =
-                std::max((Float)0, rgb[3 * offset + 2] * invWt);
-        }
+    ParallelForRange(
+        [&](int64_t begin, int64_t end) {
+            for (int64_t offset = begin; offset < end; ++offset) {
+                // Convert pixel XYZ color to RGB
+                Pixel &pixel = pixels[offset];
+                Float xyz[3] = {pixel.xyz[0], pixel.xyz[1], pixel.xyz[2]};
+                XYZToRGB(xyz, &rgb[3 * offset]);
 
-        // Add splat value at pixel
-        Float splatRGB[3];
-        Float splatXYZ[3] = {pixel.splatXYZ[0], pixel.splatXYZ[1],
-                             pixel.splatXYZ[2]};
-        XYZToRGB(splatXYZ, splatRGB);
-        rgb[3 * offset] += splatScale * splatRGB[0];
-        rgb[3 * offset + 1] += splatScale * splatRGB[1];
-        rgb[3 * offset + 2] += splatScale * splatRGB[2];
+                // Normalize pixel with weight sum
+                Float filterWeightSum = pixel.filterWeightSum;
+                if (filterWeightSum != 0) {
+                    Float invWt = (Float)1 / filterWeightSum;
+                    rgb[3 * offset] =
+                        std::max((Float)0, rgb[3 * offset] * invWt);
+                    rgb[3 * offset + 1] =
+                        std::max((Float)0, rgb[3 * offset + 1] * invWt);
+                    rgb[3 * offset + 2] =
+                        std::max((Float)0, rgb[3 * offset + 2] * invWt);
+                }
 
-        // Scale pixel value by _scale_
-        rgb[3 * offset] *= scale;
-        rgb[3 * offset + 1] *= scale;
-        rgb[3 * offset + 2] *= scale;
-        ++offset;
-    }
+                // Add splat value at pixel
+                Float splatRGB[3];
+                Float splatXYZ[3] = {pixel.splatXYZ[0], pixel.splatXYZ[1],
+                                     pixel.splatXYZ[2]};
+                XYZToRGB(splatXYZ, splatRGB);
+                rgb[3 * offset] += splatScale * splatRGB[0];
+                rgb[3 * offset + 1] += splatScale * splatRGB[1];
+                rgb[3 * offset + 2] += splatScale * splatRGB[2];
 
-    // Write RGB image
-    ::WriteImage(filename, &rgb[0], croppedPixelBounds, fullResolution);
+                // Scale pixel value by _scale_
+                rgb[3 * offset] *= scale;
+                rgb[3 * offset + 1] *= scale;
+                rgb[3 * offset + 2] *= scale;
+            }
+        },
+        croppedPixelBounds.Area(), 4096);
+
+    // Write RGB image; with --pipeline the compression and I/O run on
+    // a background thread so the next frame's parse and build overlap
+    if (PbrtOptions.framePipeline)
+        WriteImageAsync(filename, std::move(rgb), croppedPixelBounds,
+                        fullResolution);
+    else
+        ::WriteImage(filename, &rgb[0], croppedPixelBounds, fullResolution);
+
+    // Write the sample-moment planes ("bool moments"): a variance
+    // image (variance of the pixel mean, per-sample luminance
+    // variance, sample count) and a color-covariance image (rg, rb,
+    // gb), for confidence-weighted denoising
+    if (moments) {
+        int nPixels = croppedPixelBounds.Area();
+        std::unique_ptr<Float[]> varPlane(new Float[3 * nPixels]);
+        std::unique_ptr<Float[]> covPlane(new Float[3 * nPixels]);
+        for (int i = 0; i < nPixels; ++i) {
+            const MomentsPixel &m = moments[i];
+            double variance = m.n > 1 ? m.m2Lum / (m.n - 1) : 0;
+            varPlane[3 * i] = m.n > 0 ? (Float)(variance / m.n) : 0;
+            varPlane[3 * i + 1] = (Float)variance;
+            varPlane[3 * i + 2] = (Float)m.n;
+            for (int c = 0; c < 3; ++c)
+                covPlane[3 * i + c] =
+                    m.n > 1 ? (Float)(m.cov[c] / (m.n - 1)) : 0;
+        }
+        size_t dot = filename.find_last_of('.');
+        std::string base =
+            dot == std::string::npos ? filename : filename.substr(0, dot);
+        std::string ext =
+            dot == std::string::npos ? ".exr" : filename.substr(dot);
+        ::WriteImage(base + "_variance" + ext, &varPlane[0],
+                     croppedPixelBounds, fullResolution);
+        ::WriteImage(base + "_cov" + ext, &covPlane[0], croppedPixelBounds,
+                     fullResolution);
+    }
 }
 
 Film *CreateFilm(const ParamSet &params, std::unique_ptr<Filter> filter) {
@@ -203,8 +685,15 @@ Film *CreateFilm(const ParamSet &params, std::unique_ptr<Filter> filter) {
         Error("%d values supplied for \"cropwindow\". Expected 4.", cwi);
 
     Float scale = params.FindOneFloat("scale", 1.);
+    bool trackMoments = params.FindOneBool("moments", false);
+    bool bucketed = params.FindOneBool("bucketed", false);
+    if (bucketed && trackMoments) {
+        Warning("\"moments\" is not supported with the bucketed film; "
+                "disabling it.");
+        trackMoments = false;
+    }
     Float diagonal = params.FindOneFloat("diagonal", 35.);
 
     return new Film(Point2i(xres, yres), crop, std::move(filter), diagonal,
-                    filename, scale);
+                    filename, scale, trackMoments, bucketed);
 }
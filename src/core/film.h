@@ -44,6 +44,9 @@
 #include "spectrum.h"
 #include "filter.h"
 #include "stats.h"
+#include "parallel.h"
+#include <chrono>
+#include <map>
 
 // FilmTilePixel Declarations
 struct FilmTilePixel {
@@ -52,42 +55,128 @@ struct FilmTilePixel {
 };
 
 // Film Declarations
+// Streaming per-pixel sample moments ("bool moments" film parameter):
+// Welford accumulators for luminance mean/variance, per-channel means,
+// and the off-diagonal color co-moments -- a few values per pixel,
+// merged across tiles with the pairwise-combination formulas.
+struct MomentsPixel {
+    double n = 0;
+    double meanLum = 0, m2Lum = 0;
+    double mean[3] = {0, 0, 0};
+    double cov[3] = {0, 0, 0};  // co-moment sums for (rg, rb, gb)
+};
+
 class Film {
   public:
     // Film Public Methods
     Film(const Point2i &resolution, const Bounds2f &cropWindow,
          std::unique_ptr<Filter> filter, Float diagonal,
-         const std::string &filename, Float scale);
+         const std::string &filename, Float scale,
+         bool trackMoments = false, bool bucketed = false);
+    ~Film();
     Bounds2i GetSampleBounds() const;
     Bounds2f GetPhysicalExtent() const;
     std::unique_ptr<FilmTile> GetFilmTile(const Bounds2i &sampleBounds);
     void MergeFilmTile(std::unique_ptr<FilmTile> tile);
     void SetImage(const Spectrum *img) const;
     void AddSplat(const Point2f &p, const Spectrum &v);
+    void FlushSplats();
+    // Striped splat accumulation for splat-heavy integrators: evicted
+    // splat-cache entries land on one of K per-pixel shadow stripes
+    // selected by thread index, dividing CAS contention on hot pixels
+    // by K; the stripes are folded back into the pixel sums by
+    // MergeSplatStripes() before any splat reader runs.
+    void EnableSplatStriping();
+    void MergeSplatStripes();
+    // Bucketed mode ("bool bucketed"): no full-resolution pixel array
+    // is allocated; MergeFilmTile accumulates into on-demand 64x64
+    // buckets, and each bucket streams out and is dropped from memory
+    // as soon as every sample that can reach it has been reported
+    // complete, capping film residency at the active-tile working set
+    // regardless of resolution.  The only supported output is the
+    // .pfs tile stream (ReadImage and the downstream tools assemble
+    // it): the configured filename's extension is replaced with .pfs
+    // and the substitution is announced at startup, since writing an
+    // incremental tiled EXR would need the Imf tiled API that the
+    // image I/O here doesn't use.
+    bool Bucketed() const { return bucketed; }
+    void ReportSampleRegionComplete(const Bounds2i &sampleRegion);
     void WriteImage(Float splatScale = 1);
     void Clear();
+    std::string CheckpointFilename() const;
+    bool WriteCheckpoint(int64_t progress);
+    bool ReadCheckpoint(int64_t *progress);
+    void RemoveCheckpoint();
+    void WritePreviewImage(Float splatScale = 1);
+    void ExportPixelSums(std::vector<Float> *sums) const;
+    void MergePixelSums(const Float *sums, size_t count);
+    void StreamTileTo(class FrameStreamWriter *writer,
+                      const Bounds2i &tileBounds);
 
     // Film Public Data
     const Point2i fullResolution;
     const Float diagonal;
     std::unique_ptr<Filter> filter;
-    const std::string filename;
+    std::string filename;
     Bounds2i croppedPixelBounds;
 
   private:
     // Film Private Data
+    // Per-pixel sample moments ("bool moments"); merged under
+    // _momentsMutex_ since tiles combine several fields at once
+    std::unique_ptr<MomentsPixel[]> moments;
+    std::mutex momentsMutex;
+    // Bucketed-mode state
+    const bool bucketed;
+    struct FilmBucket {
+        Bounds2i pixelBounds;
+        std::vector<Float> sums;  // xyz + filter weight per pixel
+        Float remainingArea;
+    };
+    std::map<uint64_t, std::unique_ptr<FilmBucket>> buckets;
+    std::mutex bucketsMutex;
+    std::unique_ptr<class FrameStreamWriter> bucketWriter;
+    void FlushBucket(FilmBucket *bucket);
+    FilmBucket *GetBucket(const Point2i &p);
+    static PBRT_CONSTEXPR int nSplatStripes = 8;
+    std::unique_ptr<AtomicFloat[]> splatStripes;  // [stripe][pixel][3]
     struct Pixel {
-        Pixel() { xyz[0] = xyz[1] = xyz[2] = filterWeightSum = 0; }
-        Float xyz[3];
-        Float filterWeightSum;
+        // All of the sums are accumulated with atomic adds so that
+        // MergeFilmTile() doesn't need to serialize merging threads
+        // behind a film-wide mutex.
+        AtomicFloat xyz[3];
+        AtomicFloat filterWeightSum;
         AtomicFloat splatXYZ[3];
         Float pad;
     };
     std::unique_ptr<Pixel[]> pixels;
     static PBRT_CONSTEXPR int filterTableWidth = 16;
     Float filterTable[filterTableWidth * filterTableWidth];
-    std::mutex mutex;
     const Float scale;
+    // Progressive preview state; _previewWriting_ admits a single
+    // writer at a time and _lastPreviewTime_ is only touched while it
+    // is held (see WritePreviewImage())
+    std::atomic<bool> previewWriting;
+    std::chrono::steady_clock::time_point lastPreviewTime;
+
+    // Per-thread splat caches: repeated splats to the same pixel (the
+    // common case for MLT chains) accumulate locally and only reach the
+    // atomic splatXYZ sums when a slot is evicted or FlushSplats() runs
+    // at a point where no render threads are splatting.
+    static PBRT_CONSTEXPR int splatCacheSize = 256;  // must be a power of 2
+    struct SplatCacheEntry {
+        int32_t offset = -1;
+        Float xyz[3];
+    };
+    struct
+#ifdef PBRT_HAVE_ALIGNAS
+    alignas(PBRT_L1_CACHE_LINE_SIZE)
+#endif  // PBRT_HAVE_ALIGNAS
+        SplatCache {
+        SplatCacheEntry entries[splatCacheSize];
+    };
+    std::vector<SplatCache> splatCaches;
+    void FlushSplatCacheEntry(SplatCacheEntry &entry);
 
     // Film Private Methods
     Pixel &GetPixel(const Point2i &p) {
@@ -103,16 +192,38 @@ class FilmTile {
   public:
     // FilmTile Public Methods
     FilmTile(const Bounds2i &pixelBounds, const Vector2f &filterRadius,
-             const Float *filterTable, int filterTableSize)
+             const Float *filterTable, int filterTableSize,
+             bool trackMoments = false, bool boxFilter = false)
         : pixelBounds(pixelBounds),
           filterRadius(filterRadius),
           invFilterRadius(1 / filterRadius.x, 1 / filterRadius.y),
           filterTable(filterTable),
           filterTableSize(filterTableSize) {
         pixels = std::vector<FilmTilePixel>(std::max(0, pixelBounds.Area()));
+        if (trackMoments)
+            moments = std::vector<MomentsPixel>(
+                std::max(0, pixelBounds.Area()));
+        // Box-filter specialization: only for an actual box filter
+        // (constant weight) whose radius keeps every sample inside a
+        // single pixel does AddSample() reduce to one unit-weight
+        // accumulate; narrow non-box filters keep their
+        // position-dependent weights through the table path
+        isBoxFilter =
+            boxFilter && filterRadius.x <= 0.5f && filterRadius.y <= 0.5f;
     }
     void AddSample(const Point2f &pFilm, const Spectrum &L,
                    Float sampleWeight = 1.) {
+        if (isBoxFilter) {
+            // Direct add: the whole filter-table machinery reduces to
+            // one accumulate for the box filter
+            Point2i p = (Point2i)Floor(pFilm);
+            if (!InsideExclusive(p, pixelBounds)) return;
+            FilmTilePixel &pixel = GetPixel(p);
+            pixel.contribSum += L * sampleWeight;
+            pixel.filterWeightSum += 1;
+            if (!moments.empty()) AddMomentsSample(pFilm, L);
+            return;
+        }
         // Compute sample's raster bounds
         Point2f pFilmDiscrete = pFilm - Vector2f(0.5f, 0.5f);
         Point2i p0 = (Point2i)Ceil(pFilmDiscrete - filterRadius);
@@ -148,6 +259,39 @@ class FilmTile {
                 pixel.filterWeightSum += filterWeight;
             }
         }
+
+        // Bin the unweighted sample into its pixel's moment
+        // accumulators
+        if (!moments.empty()) AddMomentsSample(pFilm, L);
+    }
+    // Welford update of the sample's pixel moment accumulators
+    void AddMomentsSample(const Point2f &pFilm, const Spectrum &L) {
+        Point2i p = (Point2i)Floor(pFilm);
+        if (!InsideExclusive(p, pixelBounds)) return;
+        MomentsPixel &m = GetMoments(p);
+        Float rgb[3];
+        L.ToRGB(rgb);
+        double lum = L.y();
+        m.n += 1;
+        double dLum = lum - m.meanLum;
+        m.meanLum += dLum / m.n;
+        m.m2Lum += dLum * (lum - m.meanLum);
+        double d[3];
+        for (int c = 0; c < 3; ++c) {
+            d[c] = rgb[c] - m.mean[c];
+            m.mean[c] += d[c] / m.n;
+        }
+        m.cov[0] += d[0] * (rgb[1] - m.mean[1]);
+        m.cov[1] += d[0] * (rgb[2] - m.mean[2]);
+        m.cov[2] += d[1] * (rgb[2] - m.mean[2]);
+    }
+    bool HasMoments() const { return !moments.empty(); }
+    MomentsPixel &GetMoments(const Point2i &p) {
+        Assert(InsideExclusive(p, pixelBounds));
+        int width = pixelBounds.pMax.x - pixelBounds.pMin.x;
+        int offset =
+            (p.x - pixelBounds.pMin.x) + (p.y - pixelBounds.pMin.y) * width;
+        return moments[offset];
     }
     FilmTilePixel &GetPixel(const Point2i &p) {
         Assert(InsideExclusive(p, pixelBounds));
@@ -172,6 +316,8 @@ class FilmTile {
     const Float *filterTable;
     const int filterTableSize;
     std::vector<FilmTilePixel> pixels;
+    std::vector<MomentsPixel> moments;
+    bool isBoxFilter;
     friend class Film;
 };
 
@@ -50,6 +50,10 @@ class Filter {
     Filter(const Vector2f &radius)
         : radius(radius), invRadius(Vector2f(1 / radius.x, 1 / radius.y)) {}
     virtual Float Evaluate(const Point2f &p) const = 0;
+    // True for the box filter, whose constant unit weight lets
+    // FilmTile::AddSample skip the filter-table machinery when the
+    // radius also keeps each sample inside one pixel
+    virtual bool IsBox() const { return false; }
 
     // Filter Public Data
     const Vector2f radius, invRadius;
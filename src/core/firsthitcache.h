@@ -0,0 +1,94 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_FIRSTHITCACHE_H
+#define PBRT_CORE_FIRSTHITCACHE_H
+
+// core/firsthitcache.h*
+#include "pbrt.h"
+#include "interaction.h"
+#include <atomic>
+
+// Cache of deterministic camera-ray first hits (--firsthitcache): a
+// camera ray is a pure function of its film, lens, and time sample, so
+// whenever the same (pixel, camera sample) is traced again -- repeated
+// Render() invocations on a static camera, replayed sample sequences --
+// the first Scene::Intersect can be served from here.  Slots are
+// claimed by key with a CAS; only the claiming pixel's thread ever
+// writes a slot, so no further locking is needed, and key collisions
+// simply bypass the cache.
+class FirstHitCache {
+  public:
+    // FirstHitCache Public Methods
+    FirstHitCache() : keys(new std::atomic<uint64_t>[tableSize]),
+                      entries(new Entry[tableSize]) {
+        for (size_t i = 0; i < tableSize; ++i) keys[i] = 0;
+    }
+    struct Entry {
+        SurfaceInteraction isect;
+        bool hit;
+        std::atomic<bool> ready{false};
+    };
+    // Return the slot for _key_ (claiming it if free), or nullptr on a
+    // collision with a different key
+    Entry *Probe(uint64_t key) {
+        if (key == 0) key = 1;
+        size_t slot = (key * 0x9e3779b97f4a7c15ull) & (tableSize - 1);
+        uint64_t stored = keys[slot].load(std::memory_order_acquire);
+        if (stored == key) return &entries[slot];
+        if (stored != 0) return nullptr;
+        uint64_t expected = 0;
+        if (keys[slot].compare_exchange_strong(expected, key) ||
+            expected == key)
+            return &entries[slot];
+        return nullptr;
+    }
+
+  private:
+    // FirstHitCache Private Data
+    static PBRT_CONSTEXPR size_t tableSize = 1 << 19;
+    std::unique_ptr<std::atomic<uint64_t>[]> keys;
+    std::unique_ptr<Entry[]> entries;
+};
+
+// Thread-local slot protocol: the render loop probes the cache for the
+// sample it is about to trace and points _firstHitCacheSlot_ at the
+// slot; the integrator's first-bounce intersection consults and fills
+// it.
+extern PBRT_THREAD_LOCAL FirstHitCache::Entry *firstHitCacheSlot;
+
+#endif  // PBRT_CORE_FIRSTHITCACHE_H
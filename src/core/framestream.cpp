@@ -0,0 +1,179 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// core/framestream.cpp*
+#include "framestream.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+// Frame stream file layout: _FrameStreamHeader_, then a sequence of
+// records, each _FrameStreamRecord_ followed by its half-float
+// payload.  A record of type 2 (no payload) terminates the stream.
+struct FrameStreamHeader {
+    uint32_t magic, version;
+    int32_t resX, resY;
+    int32_t boundsMinX, boundsMinY, boundsMaxX, boundsMaxY;
+};
+struct FrameStreamRecord {
+    uint32_t type;  // 1 = tile, 2 = end of stream
+    int32_t x0, y0, x1, y1;
+    uint32_t nValues;
+    uint64_t checksum;
+};
+static const uint32_t frameStreamMagic = 0x53464250;  // "PBFS"
+static const uint32_t frameStreamVersion = 1;
+
+static uint64_t ChecksumValues(const uint16_t *values, uint32_t n) {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t i = 0; i < n; ++i) {
+        hash ^= values[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// FrameStreamWriter Method Definitions
+FrameStreamWriter::FrameStreamWriter(const std::string &filename,
+                                     const Point2i &fullResolution,
+                                     const Bounds2i &pixelBounds) {
+    file = fopen(filename.c_str(), "wb");
+    if (!file) {
+        Warning("Unable to open frame stream \"%s\"", filename.c_str());
+        return;
+    }
+    FrameStreamHeader header;
+    header.magic = frameStreamMagic;
+    header.version = frameStreamVersion;
+    header.resX = fullResolution.x;
+    header.resY = fullResolution.y;
+    header.boundsMinX = pixelBounds.pMin.x;
+    header.boundsMinY = pixelBounds.pMin.y;
+    header.boundsMaxX = pixelBounds.pMax.x;
+    header.boundsMaxY = pixelBounds.pMax.y;
+    fwrite(&header, sizeof(header), 1, file);
+    fflush(file);
+}
+
+FrameStreamWriter::~FrameStreamWriter() {
+    if (file) fclose(file);
+}
+
+void FrameStreamWriter::WriteTile(const Bounds2i &tileBounds,
+                                  const Float *rgb) {
+    if (!file) return;
+    uint32_t nValues = 3 * (uint32_t)tileBounds.Area();
+    std::vector<uint16_t> half(nValues);
+    for (uint32_t i = 0; i < nValues; ++i)
+        half[i] = FloatToHalf((float)rgb[i]);
+    FrameStreamRecord record;
+    record.type = 1;
+    record.x0 = tileBounds.pMin.x;
+    record.y0 = tileBounds.pMin.y;
+    record.x1 = tileBounds.pMax.x;
+    record.y1 = tileBounds.pMax.y;
+    record.nValues = nValues;
+    record.checksum = ChecksumValues(&half[0], nValues);
+
+    // One appended, flushed record per tile so downstream readers see
+    // it immediately
+    std::lock_guard<std::mutex> lock(mutex);
+    fwrite(&record, sizeof(record), 1, file);
+    fwrite(&half[0], sizeof(uint16_t), nValues, file);
+    fflush(file);
+}
+
+void FrameStreamWriter::Finish() {
+    if (!file) return;
+    FrameStreamRecord record = {};
+    record.type = 2;
+    std::lock_guard<std::mutex> lock(mutex);
+    fwrite(&record, sizeof(record), 1, file);
+    fclose(file);
+    file = nullptr;
+}
+
+bool ReadFrameStream(const std::string &filename, bool blocking,
+                     Point2i *resolution, std::vector<Float> *rgb) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    FrameStreamHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != frameStreamMagic ||
+        header.version != frameStreamVersion) {
+        fclose(f);
+        return false;
+    }
+    *resolution = Point2i(header.resX, header.resY);
+    rgb->assign(3 * (size_t)header.resX * header.resY, 0);
+
+    // Consume records as they appear; with _blocking_, wait for more
+    // data until the terminator arrives
+    std::vector<uint16_t> half;
+    for (;;) {
+        long recordStart = ftell(f);
+        FrameStreamRecord record;
+        if (fread(&record, sizeof(record), 1, f) != 1) {
+            if (!blocking) break;
+            clearerr(f);
+            fseek(f, recordStart, SEEK_SET);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (record.type == 2) break;
+        half.resize(record.nValues);
+        if (fread(&half[0], sizeof(uint16_t), record.nValues, f) !=
+            record.nValues) {
+            if (!blocking) break;
+            clearerr(f);
+            fseek(f, recordStart, SEEK_SET);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (ChecksumValues(&half[0], record.nValues) != record.checksum) {
+            Warning("Skipping corrupt frame stream tile in \"%s\"",
+                    filename.c_str());
+            continue;
+        }
+        int i = 0;
+        for (int y = record.y0; y < record.y1; ++y)
+            for (int x = record.x0; x < record.x1; ++x)
+                for (int c = 0; c < 3; ++c, ++i)
+                    if (x >= 0 && x < header.resX && y >= 0 &&
+                        y < header.resY)
+                        (*rgb)[3 * ((size_t)y * header.resX + x) + c] =
+                            HalfToFloat(half[i]);
+    }
+    fclose(f);
+    return true;
+}
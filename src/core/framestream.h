@@ -0,0 +1,80 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_FRAMESTREAM_H
+#define PBRT_CORE_FRAMESTREAM_H
+
+// core/framestream.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include <cstdio>
+#include <mutex>
+
+// Streaming frame interchange (.pfs): an upstream render appends one
+// checksummed half-float tile record per completed tile (--streamout),
+// and a downstream process can consume the file incrementally --
+// records are valid as soon as they are flushed, and a terminator
+// record marks completion.  Half-float payloads halve the stream
+// relative to full-float EXR handoff; corrupted records are detected
+// by their checksums and skipped.
+class FrameStreamWriter {
+  public:
+    // FrameStreamWriter Public Methods
+    FrameStreamWriter(const std::string &filename,
+                      const Point2i &fullResolution,
+                      const Bounds2i &pixelBounds);
+    ~FrameStreamWriter();
+    bool Good() const { return file != nullptr; }
+    // Append one tile's RGB values (tile-major, three floats per
+    // pixel) and flush so readers can pick the record up immediately
+    void WriteTile(const Bounds2i &tileBounds, const Float *rgb);
+    // Append the terminator record and close the stream
+    void Finish();
+
+  private:
+    // FrameStreamWriter Private Data
+    FILE *file = nullptr;
+    std::mutex mutex;
+};
+
+// Assemble a frame stream into an RGB image.  With _blocking_ set, the
+// call follows the file until the terminator record appears, so a
+// downstream process can start before the upstream render finishes.
+bool ReadFrameStream(const std::string &filename, bool blocking,
+                     Point2i *resolution, std::vector<Float> *rgb);
+
+#endif  // PBRT_CORE_FRAMESTREAM_H
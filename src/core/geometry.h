@@ -832,6 +832,10 @@ class Ray {
     mutable Float tMax;
     Float time;
     const Medium *medium;
+    // Angular footprint growth per unit distance (from the camera's
+    // ray differentials); zero for rays without footprint information.
+    // Used for proxy-LOD selection in TransformedPrimitive.
+    Float footprintSpread = 0;
 };
 
 class RayDifferential : public Ray {
@@ -32,13 +32,23 @@
 
 // core/imageio.cpp*
 #include "imageio.h"
+#include "parallel.h"
+#if defined(__AVX2__) && !defined(PBRT_FLOAT_AS_DOUBLE)
+#include <immintrin.h>
+#define PBRT_IMAGEIO_HAVE_AVX2
+#endif
+#include "framestream.h"
 #include <string.h>
+#include <future>
+#include <mutex>
+#include <chrono>
 #include "spectrum.h"
 #include "ext/targa.h"
 #include "ext/lodepng.h"
 
 #include <ImfRgba.h>
 #include <ImfRgbaFile.h>
+#include <ImfThreading.h>
 
 // ImageIO Local Declarations
 static RGBSpectrum *ReadImageEXR(const std::string &name, int *width,
@@ -59,6 +69,18 @@ static RGBSpectrum *ReadImagePFM(const std::string &filename, int *xres,
 // ImageIO Function Definitions
 std::unique_ptr<RGBSpectrum[]> ReadImage(const std::string &name,
                                          Point2i *resolution) {
+    // Consume streaming frame-interchange files, following the stream
+    // until the upstream render finishes
+    if (HasExtension(name, "pfs")) {
+        std::vector<Float> rgb;
+        if (ReadFrameStream(name, true, resolution, &rgb)) {
+            RGBSpectrum *ret = new RGBSpectrum[resolution->x * resolution->y];
+            for (int i = 0; i < resolution->x * resolution->y; ++i)
+                ret[i] = RGBSpectrum::FromRGB(&rgb[3 * i]);
+            return std::unique_ptr<RGBSpectrum[]>(ret);
+        }
+        return nullptr;
+    }
     if (HasExtension(name, ".exr"))
         return std::unique_ptr<RGBSpectrum[]>(
             ReadImageEXR(name, &resolution->x, &resolution->y));
@@ -83,6 +105,107 @@ std::unique_ptr<RGBSpectrum[]> ReadImage(const std::string &name,
     return std::unique_ptr<RGBSpectrum[]>(ret);
 }
 
+
+// sRGB encoding via a degree-6 polynomial in sqrt(x): writing the
+// transfer curve as a function of t = sqrt(x) tames the infinite
+// derivative at zero, and the fit is within 0.13/255 of the exact
+// curve over the nonlinear segment (the linear toe stays exact).
+// Horner coefficients, constant term first.
+static const float srgbEncodeCoeffs[7] = {
+    -0.0406057282f, 1.54078739f,  -1.65437642f, 3.1089492f,
+    -3.73764627f,   2.43415891f,  -0.651426923f};
+
+static inline float SRGBEncodeFast(float x) {
+    x = Clamp(x, 0.f, 1.f);
+    if (x <= 0.0031308f) return 12.92f * x;
+    float t = std::sqrt(x);
+    float v = srgbEncodeCoeffs[6];
+    for (int i = 5; i >= 0; --i) v = v * t + srgbEncodeCoeffs[i];
+    return v;
+}
+
+#ifdef PBRT_IMAGEIO_HAVE_AVX2
+// Encode _n_ values, eight per iteration
+static void SRGBEncodeSpan(const float *src, float *dst, int n) {
+    __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.f);
+    __m256 linThreshold = _mm256_set1_ps(0.0031308f);
+    __m256 linScale = _mm256_set1_ps(12.92f);
+    __m256 c[7];
+    for (int i = 0; i < 7; ++i) c[i] = _mm256_set1_ps(srgbEncodeCoeffs[i]);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_min_ps(one,
+                                 _mm256_max_ps(zero, _mm256_loadu_ps(src + i)));
+        __m256 lin = _mm256_mul_ps(linScale, x);
+        __m256 t = _mm256_sqrt_ps(x);
+        __m256 v = c[6];
+        for (int k = 5; k >= 0; --k) v = _mm256_fmadd_ps(v, t, c[k]);
+        __m256 isLinear = _mm256_cmp_ps(x, linThreshold, _CMP_LE_OQ);
+        _mm256_storeu_ps(dst + i, _mm256_blendv_ps(v, lin, isLinear));
+    }
+    for (; i < n; ++i) dst[i] = SRGBEncodeFast(src[i]);
+}
+#endif  // PBRT_IMAGEIO_HAVE_AVX2
+
+void SRGBEncodeToBytes(const Float *rgb, const Point2i &resolution,
+                       uint8_t *dst, bool dither) {
+    // 4x4 Bayer thresholds in (0, 1); replacing the rounding offset
+    // with the per-pixel threshold turns truncation into ordered
+    // dithering
+    static const Float bayer4[4][4] = {
+        {0.5f / 16, 8.5f / 16, 2.5f / 16, 10.5f / 16},
+        {12.5f / 16, 4.5f / 16, 14.5f / 16, 6.5f / 16},
+        {3.5f / 16, 11.5f / 16, 1.5f / 16, 9.5f / 16},
+        {15.5f / 16, 7.5f / 16, 13.5f / 16, 5.5f / 16}};
+    ParallelFor([&](int64_t y) {
+        const Float *src = rgb + 3 * y * resolution.x;
+        uint8_t *out = dst + 3 * y * resolution.x;
+        int n = 3 * resolution.x;
+        std::vector<float> encoded(n);
+#ifdef PBRT_IMAGEIO_HAVE_AVX2
+        SRGBEncodeSpan(src, &encoded[0], n);
+#else
+        for (int i = 0; i < n; ++i) encoded[i] = SRGBEncodeFast((float)src[i]);
+#endif
+        for (int x = 0; x < resolution.x; ++x) {
+            Float offset = dither ? bayer4[y & 3][x & 3] : (Float)0.5f;
+            for (int c = 0; c < 3; ++c)
+                out[3 * x + c] = (uint8_t)Clamp(
+                    255.f * encoded[3 * x + c] + offset, (Float)0, (Float)255);
+        }
+    }, resolution.y, 16);
+}
+
+// Pending asynchronous image writes (--pipeline)
+static std::vector<std::future<void>> pendingImageWrites;
+static std::mutex pendingImageWritesMutex;
+
+void WriteImageAsync(const std::string &name, std::unique_ptr<Float[]> rgb,
+                     const Bounds2i &outputBounds,
+                     const Point2i &totalResolution) {
+    std::shared_ptr<Float> pixels(rgb.release(),
+                                  [](Float *p) { delete[] p; });
+    std::lock_guard<std::mutex> lock(pendingImageWritesMutex);
+    // Opportunistically drop completed writes so the queue stays short
+    for (size_t i = 0; i < pendingImageWrites.size();) {
+        if (pendingImageWrites[i].wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready)
+            pendingImageWrites.erase(pendingImageWrites.begin() + i);
+        else
+            ++i;
+    }
+    pendingImageWrites.push_back(std::async(
+        std::launch::async, [name, pixels, outputBounds, totalResolution]() {
+            WriteImage(name, pixels.get(), outputBounds, totalResolution);
+        }));
+}
+
+void WaitForImageWrites() {
+    std::lock_guard<std::mutex> lock(pendingImageWritesMutex);
+    for (std::future<void> &write : pendingImageWrites) write.wait();
+    pendingImageWrites.clear();
+}
+
 void WriteImage(const std::string &name, const Float *rgb,
                 const Bounds2i &outputBounds, const Point2i &totalResolution) {
     Vector2i resolution = outputBounds.Diagonal();
@@ -93,21 +216,13 @@ void WriteImage(const std::string &name, const Float *rgb,
     } else if (HasExtension(name, ".pfm")) {
         WriteImagePFM(name, rgb, resolution.x, resolution.y);
     } else if (HasExtension(name, ".tga") || HasExtension(name, ".png")) {
-        // 8-bit formats; apply gamma
+        // 8-bit formats; apply gamma through the vectorized sRGB
+        // encoder, dithering when requested (--dither)
         Vector2i resolution = outputBounds.Diagonal();
         std::unique_ptr<uint8_t[]> rgb8(
             new uint8_t[3 * resolution.x * resolution.y]);
-        uint8_t *dst = rgb8.get();
-        for (int y = 0; y < resolution.y; ++y) {
-            for (int x = 0; x < resolution.x; ++x) {
-#define TO_BYTE(v) (uint8_t) Clamp(255.f * GammaCorrect(v) + 0.5f, 0.f, 255.f)
-                dst[0] = TO_BYTE(rgb[3 * (y * resolution.x + x) + 0]);
-                dst[1] = TO_BYTE(rgb[3 * (y * resolution.x + x) + 1]);
-                dst[2] = TO_BYTE(rgb[3 * (y * resolution.x + x) + 2]);
-#undef TO_BYTE
-                dst += 3;
-            }
-        }
+        SRGBEncodeToBytes(rgb, Point2i(resolution.x, resolution.y), rgb8.get(),
+                          PbrtOptions.ditherOutput);
 
         if (HasExtension(name, ".tga"))
             WriteImageTGA(
@@ -161,9 +276,16 @@ static void WriteImageEXR(const std::string &name, const Float *pixels,
     using namespace Imf;
     using namespace Imath;
 
+    // Let OpenEXR compress scanline chunks on all cores; pixels are
+    // written half-float (Rgba), so the file is half the size of a
+    // full-float image to begin with
+    setGlobalThreadCount(NumSystemCores());
+
+    // Convert to half in parallel
     Rgba *hrgba = new Rgba[xRes * yRes];
-    for (int i = 0; i < xRes * yRes; ++i)
+    ParallelFor([&](int64_t i) {
         hrgba[i] = Rgba(pixels[3 * i], pixels[3 * i + 1], pixels[3 * i + 2]);
+    }, (int64_t)xRes * yRes, 32768);
 
     Box2i displayWindow(V2i(0, 0), V2i(totalXRes - 1, totalYRes - 1));
     Box2i dataWindow(V2i(xOffset, yOffset),
@@ -42,6 +42,7 @@
 #include "pbrt.h"
 #include "geometry.h"
 #include <cctype>
+#include <memory>
 
 // ImageIO Declarations
 inline bool HasExtension(const std::string &value, const std::string &ending) {
@@ -55,5 +56,18 @@ std::unique_ptr<RGBSpectrum[]> ReadImage(const std::string &name,
                                          Point2i *resolution);
 void WriteImage(const std::string &name, const Float *rgb,
                 const Bounds2i &outputBounds, const Point2i &totalResolution);
+// Convert a scanline-ordered float RGB buffer to 8-bit sRGB using the
+// vectorized polynomial encoder; with _dither_ set, 4x4 ordered
+// dithering replaces round-to-nearest quantization.
+void SRGBEncodeToBytes(const Float *rgb, const Point2i &resolution,
+                       uint8_t *dst, bool dither);
+// Queue the write on a background thread (--pipeline), taking
+// ownership of _rgb_, so the next frame of a batch can parse and
+// build while this frame's EXR compression and I/O finish;
+// WaitForImageWrites() drains the queue (called from pbrtCleanup()).
+void WriteImageAsync(const std::string &name, std::unique_ptr<Float[]> rgb,
+                     const Bounds2i &outputBounds,
+                     const Point2i &totalResolution);
+void WaitForImageWrites();
 
 #endif  // PBRT_CORE_IMAGEIO_H
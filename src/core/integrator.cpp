@@ -33,6 +33,7 @@
 
 // core/integrator.cpp*
 #include "integrator.h"
+#include "cameras/perspective.h"
 #include "scene.h"
 #include "interaction.h"
 #include "sampling.h"
@@ -43,63 +44,270 @@
 #include "progressreporter.h"
 #include "camera.h"
 #include "stats.h"
+#include "imageio.h"
+#include "lighttree.h"
+#include "distributed.h"
+#include "firsthitcache.h"
+#include "framestream.h"
+#include <chrono>
+#include <thread>
 STAT_COUNTER("Integrator/Camera rays traced", nCameraRays);
 STAT_TIMER("Time/Rendering", renderingTime);
 
+PBRT_THREAD_LOCAL AOVSample *aovSample;
+PBRT_THREAD_LOCAL FirstHitCache::Entry *firstHitCacheSlot;
+
 // Integrator Method Definitions
 Integrator::~Integrator() {}
 
 // Integrator Utility Functions
+static Spectrum EstimateDirectArray(const SurfaceInteraction &isect,
+                                    const Point2f *uScatteringArray,
+                                    const Light &light,
+                                    const Point2f *uLightArray, int nSamples,
+                                    const Scene &scene, MemoryArena &arena,
+                                    ShadowRayBatch *shadowBatch);
+
+PBRT_THREAD_LOCAL PrimaryShadingCache *primaryShadingCache;
+
+void ResetPrimaryShadingCache() {
+    if (primaryShadingCache) primaryShadingCache->Reset();
+}
+
+void ComputeOrReusePrimaryShading(SurfaceInteraction *isect,
+                                  const RayDifferential &ray,
+                                  Float uvTolerance) {
+    if (!primaryShadingCache) primaryShadingCache = new PrimaryShadingCache;
+    PrimaryShadingCache &cache = *primaryShadingCache;
+    if (cache.valid && cache.primitive == isect->primitive &&
+        std::abs(cache.uv.x - isect->uv.x) <= uvTolerance &&
+        std::abs(cache.uv.y - isect->uv.y) <= uvTolerance) {
+        // Reuse the evaluated BSDF (its textures in particular); the
+        // lobes are re-evaluated against this sample's own directions
+        isect->bsdf = cache.bsdf;
+        return;
+    }
+    isect->ComputeScatteringFunctions(ray, cache.arena);
+    cache.valid = isect->bsdf != nullptr;
+    cache.primitive = isect->primitive;
+    cache.uv = isect->uv;
+    cache.bsdf = isect->bsdf;
+}
+
 Spectrum UniformSampleAllLights(const Interaction &it, const Scene &scene,
                                 MemoryArena &arena, Sampler &sampler,
                                 const std::vector<int> &nLightSamples,
-                                bool handleMedia) {
+                                bool handleMedia,
+                                const std::vector<int> *lightSet) {
     ProfilePhase p(Prof::DirectLighting);
     Spectrum L(0.f);
+    // Queue light-sample shadow rays per light and resolve them in
+    // sorted batches instead of interleaving a BVH traversal into the
+    // middle of each light's BSDF math
+    ShadowRayBatch localBatch;
+    ShadowRayBatch *shadowBatch = handleMedia ? nullptr : &localBatch;
+    size_t setPos = 0;
     for (size_t j = 0; j < scene.lights.size(); ++j) {
+        // Skip lights culled for this region, but still consume their
+        // requested sample arrays so the sampler's array sequence stays
+        // aligned with the Preprocess() requests
+        bool culled = false;
+        if (lightSet) {
+            if (setPos < lightSet->size() && (size_t)(*lightSet)[setPos] == j)
+                ++setPos;
+            else
+                culled = true;
+        }
+
         // Accumulate contribution of _j_th light to _L_
         const std::shared_ptr<Light> &light = scene.lights[j];
         int nSamples = nLightSamples[j];
         const Point2f *uLightArray = sampler.Get2DArray(nSamples);
         const Point2f *uScatteringArray = sampler.Get2DArray(nSamples);
+        if (culled) continue;
         if (!uLightArray || !uScatteringArray) {
             // Use a single sample for illumination from _light_
             Point2f uLight = sampler.Get2D();
             Point2f uScattering = sampler.Get2D();
             L += EstimateDirect(it, uScattering, *light, uLight, scene, sampler,
-                                arena, handleMedia);
+                                arena, handleMedia, false, shadowBatch);
+        } else if (!handleMedia && it.IsSurfaceInteraction()) {
+            // Estimate direct lighting with the batch entry points
+            L += EstimateDirectArray((const SurfaceInteraction &)it,
+                                     uScatteringArray, *light, uLightArray,
+                                     nSamples, scene, arena, shadowBatch) /
+                 nSamples;
         } else {
             // Estimate direct lighting using sample arrays
             Spectrum Ld(0.f);
             for (int k = 0; k < nSamples; ++k)
                 Ld += EstimateDirect(it, uScatteringArray[k], *light,
                                      uLightArray[k], scene, sampler, arena,
-                                     handleMedia);
+                                     handleMedia, false, shadowBatch);
             L += Ld / nSamples;
         }
+        if (shadowBatch && nSamples > 0) {
+            // Deferred contributions were queued unscaled by the
+            // per-light sample count; resolve and scale them now
+            Spectrum Lv = ResolveShadowBatch(*shadowBatch, scene);
+            L += (uLightArray && uScatteringArray) ? Lv / nSamples : Lv;
+        }
     }
     return L;
 }
 
+Spectrum ResolveShadowBatch(ShadowRayBatch &batch, const Scene &scene) {
+    Spectrum L(0.f);
+    int n = (int)batch.rays.size();
+    if (n == 0) return L;
+
+    // Resolve the rays in direction-sorted order through the any-hit
+    // stream so traversal stays coherent
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        const Vector3f &da = batch.rays[a].d, &db = batch.rays[b].d;
+        int oa = (da.x > 0) | ((da.y > 0) << 1) | ((da.z > 0) << 2);
+        int ob = (db.x > 0) | ((db.y > 0) << 1) | ((db.z > 0) << 2);
+        return oa < ob;
+    });
+    std::vector<Ray> sorted(n);
+    for (int i = 0; i < n; ++i) sorted[i] = batch.rays[order[i]];
+    std::unique_ptr<bool[]> occluded(new bool[n]);
+    scene.IntersectPStream(&sorted[0], occluded.get(), n);
+    for (int i = 0; i < n; ++i)
+        if (!occluded[i]) L += batch.contributions[order[i]];
+    batch.rays.clear();
+    batch.contributions.clear();
+    return L;
+}
+
 Spectrum UniformSampleOneLight(const Interaction &it, const Scene &scene,
                                MemoryArena &arena, Sampler &sampler,
-                               bool handleMedia) {
+                               bool handleMedia,
+                               const Distribution1D *lightDistrib) {
     ProfilePhase p(Prof::DirectLighting);
     // Randomly choose a single light to sample, _light_
     int nLights = int(scene.lights.size());
     if (nLights == 0) return Spectrum(0.f);
-    int lightNum = std::min((int)(sampler.Get1D() * nLights), nLights - 1);
+    int lightNum;
+    Float lightPmf;
+    if (lightDistrib) {
+        lightNum =
+            lightDistrib->SampleDiscreteAlias(sampler.Get1D(), &lightPmf);
+        if (lightPmf == 0) return Spectrum(0.f);
+    } else {
+        lightNum = std::min((int)(sampler.Get1D() * nLights), nLights - 1);
+        lightPmf = Float(1) / nLights;
+    }
+    const std::shared_ptr<Light> &light = scene.lights[lightNum];
+    Point2f uLight = sampler.Get2D();
+    Point2f uScattering = sampler.Get2D();
+    return EstimateDirect(it, uScattering, *light, uLight, scene, sampler,
+                          arena, handleMedia) /
+           lightPmf;
+}
+
+Spectrum SampleOneLightHierarchical(const Interaction &it, const Scene &scene,
+                                    MemoryArena &arena, Sampler &sampler,
+                                    const LightTree &lightTree,
+                                    bool handleMedia) {
+    ProfilePhase p(Prof::DirectLighting);
+    // Choose a light from the hierarchy using the shading point
+    Float pmf;
+    int lightNum = lightTree.SampleLight(it.p, sampler.Get1D(), &pmf);
+    if (lightNum < 0 || pmf == 0) return Spectrum(0.f);
     const std::shared_ptr<Light> &light = scene.lights[lightNum];
     Point2f uLight = sampler.Get2D();
     Point2f uScattering = sampler.Get2D();
-    return (Float)nLights * EstimateDirect(it, uScattering, *light, uLight,
-                                           scene, sampler, arena, handleMedia);
+    return EstimateDirect(it, uScattering, *light, uLight, scene, sampler,
+                          arena, handleMedia) /
+           pmf;
+}
+
+// Batched variant of EstimateDirect's light-sampling half for surface
+// interactions without participating media: one Sample_Li_batch and
+// one f_batch call per light cover all of the array samples, and the
+// BSDF-sampling MIS half then runs per sample as usual.
+static Spectrum EstimateDirectArray(const SurfaceInteraction &isect,
+                                    const Point2f *uScatteringArray,
+                                    const Light &light,
+                                    const Point2f *uLightArray, int nSamples,
+                                    const Scene &scene, MemoryArena &arena,
+                                    ShadowRayBatch *shadowBatch) {
+    BxDFType bsdfFlags = BxDFType(BSDF_ALL & ~BSDF_SPECULAR);
+    Spectrum Ld(0.f);
+
+    // Sample the light and evaluate the BSDF for all samples at once
+    Vector3f *wi = arena.Alloc<Vector3f>(nSamples, false);
+    Float *lightPdf = arena.Alloc<Float>(nSamples, false);
+    Spectrum *Li = arena.Alloc<Spectrum>(nSamples, false);
+    VisibilityTester *vis = arena.Alloc<VisibilityTester>(nSamples);
+    light.Sample_Li_batch(isect, uLightArray, nSamples, wi, lightPdf, Li, vis);
+    Spectrum *f = arena.Alloc<Spectrum>(nSamples, false);
+    Float *scatteringPdf = arena.Alloc<Float>(nSamples, false);
+    isect.bsdf->f_batch(isect.wo, wi, nSamples, bsdfFlags, f, scatteringPdf);
+    for (int k = 0; k < nSamples; ++k) {
+        if (lightPdf[k] <= 0 || Li[k].IsBlack()) continue;
+        Spectrum fk = f[k] * AbsDot(wi[k], isect.shading.n);
+        if (fk.IsBlack()) continue;
+        Spectrum contribution;
+        if (IsDeltaLight(light.flags))
+            contribution = fk * Li[k] / lightPdf[k];
+        else {
+            Float weight =
+                PowerHeuristic(1, lightPdf[k], 1, scatteringPdf[k]);
+            contribution = fk * Li[k] * weight / lightPdf[k];
+        }
+        if (contribution.IsBlack()) continue;
+        if (shadowBatch) {
+            shadowBatch->rays.push_back(
+                vis[k].P0().SpawnRayTo(vis[k].P1()));
+            shadowBatch->contributions.push_back(contribution);
+        } else if (vis[k].Unoccluded(scene))
+            Ld += contribution;
+    }
+
+    // Sample BSDF with multiple importance sampling
+    if (!IsDeltaLight(light.flags)) {
+        for (int k = 0; k < nSamples; ++k) {
+            Vector3f wiScattered;
+            Float scatterPdf;
+            BxDFType sampledType;
+            Spectrum fS =
+                isect.bsdf->Sample_f(isect.wo, &wiScattered,
+                                     uScatteringArray[k], &scatterPdf,
+                                     bsdfFlags, &sampledType);
+            fS *= AbsDot(wiScattered, isect.shading.n);
+            if (fS.IsBlack() || scatterPdf <= 0) continue;
+
+            // Account for light contributions along sampled direction
+            Float weight = 1;
+            if (!(sampledType & BSDF_SPECULAR)) {
+                Float lp = light.Pdf_Li(isect, wiScattered);
+                if (lp == 0) continue;
+                weight = PowerHeuristic(1, scatterPdf, 1, lp);
+            }
+            SurfaceInteraction lightIsect;
+            Ray ray = isect.SpawnRay(wiScattered);
+            Spectrum LiScattered(0.f);
+            if (scene.Intersect(ray, &lightIsect)) {
+                if (lightIsect.primitive->GetAreaLight() == &light)
+                    LiScattered = lightIsect.Le(-wiScattered);
+            } else
+                LiScattered = light.Le(ray);
+            if (!LiScattered.IsBlack())
+                Ld += fS * LiScattered * weight / scatterPdf;
+        }
+    }
+    return Ld;
 }
 
 Spectrum EstimateDirect(const Interaction &it, const Point2f &uScattering,
                         const Light &light, const Point2f &uLight,
                         const Scene &scene, Sampler &sampler,
-                        MemoryArena &arena, bool handleMedia, bool specular) {
+                        MemoryArena &arena, bool handleMedia, bool specular,
+                        ShadowRayBatch *shadowBatch) {
     BxDFType bsdfFlags =
         specular ? BSDF_ALL : BxDFType(BSDF_ALL & ~BSDF_SPECULAR);
     Spectrum Ld(0.f);
@@ -125,20 +333,38 @@ Spectrum EstimateDirect(const Interaction &it, const Point2f &uScattering,
             scatteringPdf = p;
         }
         if (!f.IsBlack()) {
-            // Compute effect of visibility for light source sample
-            if (handleMedia)
-                Li *= visibility.Tr(scene, sampler);
-            else if (!visibility.Unoccluded(scene))
-                Li = Spectrum(0.f);
-
-            // Add light's contribution to reflected radiance
-            if (!Li.IsBlack()) {
+            if (shadowBatch && !handleMedia) {
+                // Defer the visibility ray: queue the candidate
+                // contribution and let the caller resolve the batch
+                Spectrum contribution;
                 if (IsDeltaLight(light.flags))
-                    Ld += f * Li / lightPdf;
+                    contribution = f * Li / lightPdf;
                 else {
                     Float weight =
                         PowerHeuristic(1, lightPdf, 1, scatteringPdf);
-                    Ld += f * Li * weight / lightPdf;
+                    contribution = f * Li * weight / lightPdf;
+                }
+                if (!contribution.IsBlack()) {
+                    shadowBatch->rays.push_back(
+                        visibility.P0().SpawnRayTo(visibility.P1()));
+                    shadowBatch->contributions.push_back(contribution);
+                }
+            } else {
+                // Compute effect of visibility for light source sample
+                if (handleMedia)
+                    Li *= visibility.Tr(scene, sampler);
+                else if (!visibility.Unoccluded(scene))
+                    Li = Spectrum(0.f);
+
+                // Add light's contribution to reflected radiance
+                if (!Li.IsBlack()) {
+                    if (IsDeltaLight(light.flags))
+                        Ld += f * Li / lightPdf;
+                    else {
+                        Float weight =
+                            PowerHeuristic(1, lightPdf, 1, scatteringPdf);
+                        Ld += f * Li * weight / lightPdf;
+                    }
                 }
             }
         }
@@ -209,96 +435,487 @@ void SamplerIntegrator::Render(const Scene &scene) {
     Preprocess(scene, *sampler);
     // Render image tiles in parallel
 
-    // Compute number of tiles, _nTiles_, to use for parallel rendering
+    // Seed the tile queue with large tiles; expensive ones hand their
+    // unrendered rows back as smaller tiles while they render, so the
+    // tail of the render keeps all of the worker threads busy.
     Bounds2i sampleBounds = camera->film->GetSampleBounds();
     Vector2i sampleExtent = sampleBounds.Diagonal();
-    const int tileSize = 16;
-    Point2i nTiles((sampleExtent.x + tileSize - 1) / tileSize,
-                   (sampleExtent.y + tileSize - 1) / tileSize);
-    ProgressReporter reporter(nTiles.x * nTiles.y, "Rendering");
+    const int maxTileSize = 64, minTileSplitRows = 8;
+    std::vector<Bounds2i> tileQueue;
+    std::mutex tileQueueMutex;
+    std::atomic<int> tilesOutstanding(0);
+
+    // With --seconds, samples are rendered in progressive passes over
+    // the tile set so the wall-clock budget can stop cleanly between
+    // (or gracefully within) passes; every pixel gets its first-pass
+    // samples before the budget is enforced, so a usable frame always
+    // comes out.
+    const int64_t spp = sampler->samplesPerPixel;
+    const bool budgeted = PbrtOptions.renderSeconds > 0;
+    const int64_t passSize =
+        budgeted ? Clamp(spp / 8, (int64_t)1, spp) : spp;
+    const int64_t nPasses = (spp + passSize - 1) / passSize;
+    auto renderStart = std::chrono::steady_clock::now();
+    std::atomic<bool> budgetExhausted(false);
+
+    // Streaming interchange output (--streamout): completed tiles are
+    // appended to the stream so downstream passes can start consuming
+    // before this render finishes
+    std::unique_ptr<FrameStreamWriter> streamWriter;
+    if (PbrtOptions.streamOutFile != "")
+        streamWriter.reset(new FrameStreamWriter(
+            PbrtOptions.streamOutFile, camera->film->fullResolution,
+            camera->film->croppedPixelBounds));
+
+    // First-hit cache shared by all of this render's camera samples
+    static std::unique_ptr<FirstHitCache> firstHitCache;
+    if (PbrtOptions.firstHitCache && !firstHitCache)
+        firstHitCache.reset(new FirstHitCache());
+    auto fillTileQueue = [&](int64_t pass) {
+        int64_t tileId = 0;
+        for (int y = sampleBounds.pMin.y; y < sampleBounds.pMax.y;
+             y += maxTileSize)
+            for (int x = sampleBounds.pMin.x; x < sampleBounds.pMax.x;
+                 x += maxTileSize) {
+                // In distributed renders, only tiles this node claims
+                // are queued; splits of a claimed tile stay local
+                if (!DistClaimWorkUnit("render-tile",
+                                       pass * (int64_t)1 << 40 | tileId++))
+                    continue;
+                tileQueue.push_back(Bounds2i(
+                    Point2i(x, y),
+                    Point2i(std::min(x + maxTileSize, sampleBounds.pMax.x),
+                            std::min(y + maxTileSize, sampleBounds.pMax.y))));
+            }
+        tilesOutstanding = (int)tileQueue.size();
+    };
+
+    // Running per-pixel cost estimate used to recognize hot tiles
+    std::atomic<int64_t> pixelsRendered(0);
+    AtomicFloat secondsRendered;
+
+    // Allocate per-pixel statistics planes (seconds, intersection
+    // tests, non-shadow tests) if a statistics image was requested;
+    // each pixel is rendered by exactly one thread, so plain stores
+    // suffice.
+    const Bounds2i statsBounds = camera->film->croppedPixelBounds;
+    std::unique_ptr<Float[]> statsPlanes;
+    if (PbrtOptions.statsImage)
+        statsPlanes.reset(new Float[3 * (size_t)statsBounds.Area()]());
+
+    // Allocate the denoiser AOV planes (--aovs): albedo, shading
+    // normal, depth, and the direct/indirect split, box filtered per
+    // pixel; each pixel is rendered by one thread, so plain stores
+    // suffice
+    std::unique_ptr<Float[]> aovPlanes;
+    PBRT_CONSTEXPR int nAOVChannels = 14;  // 3+3+1+3+3 + sample count
+    if (PbrtOptions.aovs)
+        aovPlanes.reset(
+            new Float[nAOVChannels * (size_t)statsBounds.Area()]());
+
+    ProgressReporter reporter(
+        (int64_t)sampleExtent.x * sampleExtent.y * nPasses, "Rendering");
     {
         StatTimer timer(&renderingTime);
-        ParallelFor2D([&](Point2i tile) {
-            // Render section of image corresponding to _tile_
-
-            // Allocate _MemoryArena_ for tile
+        for (int64_t passStart = 0; passStart < spp && !budgetExhausted;
+             passStart += passSize) {
+        const int64_t passEnd = std::min(spp, passStart + passSize);
+        fillTileQueue(passStart / passSize);
+        ParallelFor([&](int64_t) {
+            // Allocate _MemoryArena_ for tiles rendered by this worker
             MemoryArena arena;
-
-            // Get sampler instance for tile
-            int seed = tile.y * nTiles.x + tile.x;
-            std::unique_ptr<Sampler> tileSampler = sampler->Clone(seed);
-
-            // Compute sample bounds for tile
-            int x0 = sampleBounds.pMin.x + tile.x * tileSize;
-            int x1 = std::min(x0 + tileSize, sampleBounds.pMax.x);
-            int y0 = sampleBounds.pMin.y + tile.y * tileSize;
-            int y1 = std::min(y0 + tileSize, sampleBounds.pMax.y);
-            Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
-
-            // Get _FilmTile_ for tile
-            std::unique_ptr<FilmTile> filmTile =
-                camera->film->GetFilmTile(tileBounds);
-
-            // Loop over pixels in tile to render them
-            for (Point2i pixel : tileBounds) {
+            for (;;) {
+                // Take the next tile from _tileQueue_, if any
+                Bounds2i tileBounds;
+                bool gotTile = false;
                 {
-                    ProfilePhase pp(Prof::StartPixel);
-                    tileSampler->StartPixel(pixel);
+                    std::lock_guard<std::mutex> lock(tileQueueMutex);
+                    if (!tileQueue.empty()) {
+                        tileBounds = tileQueue.back();
+                        tileQueue.pop_back();
+                        gotTile = true;
+                    }
+                }
+                if (!gotTile) {
+                    // Wait for in-flight tiles, which may yet be split
+                    if (tilesOutstanding == 0) break;
+                    std::this_thread::yield();
+                    continue;
                 }
-                do {
-                    // Initialize _CameraSample_ for current sample
-                    CameraSample cameraSample =
-                        tileSampler->GetCameraSample(pixel);
-
-                    // Generate camera ray for current sample
-                    RayDifferential ray;
-                    Float rayWeight =
-                        camera->GenerateRayDifferential(cameraSample, &ray);
-                    ray.ScaleDifferentials(
-                        1 / std::sqrt((Float)tileSampler->samplesPerPixel));
-                    ++nCameraRays;
-
-                    // Evaluate radiance along camera ray
-                    Spectrum L(0.f);
-                    if (rayWeight > 0) L = Li(ray, scene, *tileSampler, arena);
-
-                    // Issue warning if unexpected radiance value returned
-                    if (L.HasNaNs()) {
-                        Error(
-                            "Not-a-number radiance value returned "
-                            "for image sample.  Setting to black.");
-                        L = Spectrum(0.f);
-                    } else if (L.y() < -1e-5) {
-                        Error(
-                            "Negative luminance value, %f, returned "
-                            "for image sample.  Setting to black.",
-                            L.y());
-                        L = Spectrum(0.f);
-                    } else if (std::isinf(L.y())) {
-                        Error(
-                            "Infinite luminance value returned "
-                            "for image sample.  Setting to black.");
-                        L = Spectrum(0.f);
+
+                // Get sampler instance for tile; seeding by the tile
+                // origin keeps sub-tiles from reusing sample patterns
+                int seed = MixFrameSeed(
+                    (tileBounds.pMin.y - sampleBounds.pMin.y) *
+                        sampleExtent.x +
+                    (tileBounds.pMin.x - sampleBounds.pMin.x));
+                std::unique_ptr<Sampler> tileSampler = sampler->Clone(seed);
+
+                // Get _FilmTile_ for tile
+                std::unique_ptr<FilmTile> filmTile =
+                    camera->film->GetFilmTile(tileBounds);
+
+                // Beam setup: bound the tile's camera rays with a
+                // frustum through the tile's film corners and find the
+                // BVH subtrees it can touch, so each camera ray starts
+                // traversal from that culled set instead of the root.
+                // Only valid when the camera's rays share one origin
+                // and direction field over lens and shutter (pinhole,
+                // static), which the probe rays check.
+                std::vector<int> beamEntry;
+                bool haveBeam = false;
+                // Only the perspective camera's projective mapping
+                // guarantees that a film rectangle maps exactly onto
+                // the frustum of its corner directions
+                if (dynamic_cast<const PerspectiveCamera *>(camera.get())) {
+                    CameraSample cs;
+                    cs.pLens = Point2f(.5f, .5f);
+                    cs.time = .5f;
+                    Point2f corners[4] = {
+                        Point2f(tileBounds.pMin.x, tileBounds.pMin.y),
+                        Point2f(tileBounds.pMax.x, tileBounds.pMin.y),
+                        Point2f(tileBounds.pMax.x, tileBounds.pMax.y),
+                        Point2f(tileBounds.pMin.x, tileBounds.pMax.y)};
+                    Ray cornerRays[4];
+                    bool beamOk = true;
+                    for (int c = 0; c < 4 && beamOk; ++c) {
+                        cs.pFilm = corners[c];
+                        beamOk = camera->GenerateRay(cs, &cornerRays[c]) > 0;
+                    }
+                    // All four corners must share one apex (rules out
+                    // orthographic and environment cameras)
+                    for (int c = 1; c < 4 && beamOk; ++c)
+                        beamOk = Distance(cornerRays[c].o, cornerRays[0].o) == 0;
+                    if (beamOk) {
+                        Ray probe;
+                        cs.pFilm = corners[0];
+                        cs.pLens = Point2f(0, 0);
+                        cs.time = 1;
+                        beamOk = camera->GenerateRay(cs, &probe) > 0 &&
+                                 Distance(probe.o, cornerRays[0].o) == 0 &&
+                                 (probe.d - cornerRays[0].d).Length() <
+                                     1e-6f;
                     }
+                    if (beamOk) {
+                        Vector3f dirs[4] = {cornerRays[0].d, cornerRays[1].d,
+                                            cornerRays[2].d, cornerRays[3].d};
+                        haveBeam = scene.ComputeBeamEntry(cornerRays[0].o,
+                                                          dirs, &beamEntry);
+                    }
+                }
 
-                    // Add camera ray's contribution to image
-                    filmTile->AddSample(cameraSample.pFilm, L, rayWeight);
+                // Loop over rows of pixels in tile to render them
+                auto tileStart = std::chrono::steady_clock::now();
+                int64_t tilePixels = 0;
+                Bounds2i completedBounds = tileBounds;
+                for (int py = tileBounds.pMin.y; py < tileBounds.pMax.y;
+                     ++py) {
+                    if (budgetExhausted && passStart > 0) break;
+                    for (int px = tileBounds.pMin.x; px < tileBounds.pMax.x;
+                         ++px) {
+                        Point2i pixel(px, py);
+                        ResetPrimaryShadingCache();
+                        // Record this pixel's starting time and ray
+                        // counts for the statistics image
+                        std::chrono::steady_clock::time_point pixelStart;
+                        uint64_t pixelIsects = 0, pixelShadow = 0;
+                        if (statsPlanes) {
+                            pixelStart = std::chrono::steady_clock::now();
+                            pixelIsects = threadIntersectTests;
+                            pixelShadow = threadShadowTests;
+                        }
+                        {
+                            ProfilePhase pp(Prof::StartPixel);
+                            tileSampler->StartPixel(pixel);
+                        }
+                        if (passStart > 0 &&
+                            !tileSampler->SetSampleNumber(passStart))
+                            continue;
+                        // Adaptive sampling state: running mean and M2
+                        // of the pixel's sample luminances (Welford)
+                        int64_t nPixelSamples = 0;
+                        Float meanLum = 0, lumM2 = 0;
+                        do {
+                            // Initialize _CameraSample_ for current sample
+                            CameraSample cameraSample =
+                                tileSampler->GetCameraSample(pixel);
+
+                            // Generate camera ray for current sample
+                            RayDifferential ray;
+                            Float rayWeight = camera->GenerateRayDifferential(
+                                cameraSample, &ray);
+                            ray.ScaleDifferentials(
+                                1 /
+                                std::sqrt(
+                                    (Float)tileSampler->samplesPerPixel));
+                            ++nCameraRays;
+
+                            // Evaluate radiance along camera ray,
+                            // pointing the integrator at this sample's
+                            // first-hit cache slot if caching is on
+                            Spectrum L(0.f);
+                            AOVSample aov;
+                            if (aovPlanes) aovSample = &aov;
+                            if (firstHitCache) {
+                                uint64_t key = 14695981039346656037ull;
+                                auto mix = [&key](uint32_t v) {
+                                    key ^= v;
+                                    key *= 1099511628211ull;
+                                };
+                                mix(pixel.x);
+                                mix(pixel.y);
+                                mix(FloatToBits(
+                                    (float)cameraSample.pFilm.x));
+                                mix(FloatToBits(
+                                    (float)cameraSample.pFilm.y));
+                                mix(FloatToBits(
+                                    (float)cameraSample.pLens.x));
+                                mix(FloatToBits(
+                                    (float)cameraSample.pLens.y));
+                                mix(FloatToBits((float)cameraSample.time));
+                                firstHitCacheSlot = firstHitCache->Probe(key);
+                            }
+                            if (haveBeam) threadBeamEntry = &beamEntry;
+                            if (rayWeight > 0)
+                                L = Li(ray, scene, *tileSampler, arena);
+                            threadBeamEntry = nullptr;
+                            firstHitCacheSlot = nullptr;
+                            if (aovPlanes) {
+                                aovSample = nullptr;
+                                if (InsideExclusive(pixel, statsBounds)) {
+                                    // Accumulate this sample's AOVs
+                                    Float *dst =
+                                        &aovPlanes[nAOVChannels *
+                                                   ((pixel.y -
+                                                     statsBounds.pMin.y) *
+                                                        (size_t)(statsBounds
+                                                                     .pMax.x -
+                                                                 statsBounds
+                                                                     .pMin.x) +
+                                                    pixel.x -
+                                                    statsBounds.pMin.x)];
+                                    Float rgb[3];
+                                    aov.albedo.ToRGB(rgb);
+                                    for (int c = 0; c < 3; ++c)
+                                        dst[c] += rgb[c];
+                                    dst[3] += aov.n.x;
+                                    dst[4] += aov.n.y;
+                                    dst[5] += aov.n.z;
+                                    dst[6] += aov.depth;
+                                    aov.direct.ToRGB(rgb);
+                                    for (int c = 0; c < 3; ++c)
+                                        dst[7 + c] += rgb[c];
+                                    Spectrum indirect = L - aov.direct;
+                                    indirect.ToRGB(rgb);
+                                    for (int c = 0; c < 3; ++c)
+                                        dst[10 + c] += rgb[c];
+                                    dst[13] += 1;
+                                }
+                            }
+
+                            // Issue warning if unexpected radiance value
+                            // returned
+                            if (L.HasNaNs()) {
+                                Error(
+                                    "Not-a-number radiance value returned "
+                                    "for image sample.  Setting to black.");
+                                L = Spectrum(0.f);
+                            } else if (L.y() < -1e-5) {
+                                Error(
+                                    "Negative luminance value, %f, returned "
+                                    "for image sample.  Setting to black.",
+                                    L.y());
+                                L = Spectrum(0.f);
+                            } else if (std::isinf(L.y())) {
+                                Error(
+                                    "Infinite luminance value returned "
+                                    "for image sample.  Setting to black.");
+                                L = Spectrum(0.f);
+                            }
+
+                            // Add camera ray's contribution to image
+                            filmTile->AddSample(cameraSample.pFilm, L,
+                                                rayWeight);
+
+                            // Free _MemoryArena_ memory from computing image
+                            // sample value
+                            arena.Reset();
+
+                            // With --adaptive, periodically test the
+                            // pixel's standard-error estimate against
+                            // the threshold and stop sampling early;
+                            // unused tail samples of the pixel's
+                            // sequence are simply never requested, so
+                            // sampler state stays consistent
+                            if (PbrtOptions.adaptiveThreshold > 0) {
+                                ++nPixelSamples;
+                                Float lum = L.y();
+                                Float delta = lum - meanLum;
+                                meanLum += delta / nPixelSamples;
+                                lumM2 += delta * (lum - meanLum);
+                                if (nPixelSamples >= 32 &&
+                                    (nPixelSamples & 15) == 0) {
+                                    Float variance =
+                                        lumM2 / (nPixelSamples - 1);
+                                    Float error =
+                                        std::sqrt(variance / nPixelSamples);
+                                    if (error <
+                                        PbrtOptions.adaptiveThreshold *
+                                            std::max(meanLum, (Float).01))
+                                        break;
+                                }
+                            }
+                        } while (tileSampler->StartNextSample() &&
+                                 tileSampler->CurrentSampleNumber() < passEnd);
+                        if (budgeted && !budgetExhausted &&
+                            std::chrono::duration<Float>(
+                                std::chrono::steady_clock::now() -
+                                renderStart)
+                                    .count() >= PbrtOptions.renderSeconds)
+                            budgetExhausted = true;
+
+                        // Store this pixel's cost in the statistics
+                        // planes
+                        if (statsPlanes &&
+                            InsideExclusive(pixel, statsBounds)) {
+                            size_t statsOffset =
+                                3 *
+                                ((pixel.y - statsBounds.pMin.y) *
+                                     (size_t)(statsBounds.pMax.x -
+                                              statsBounds.pMin.x) +
+                                 (pixel.x - statsBounds.pMin.x));
+                            statsPlanes[statsOffset] +=
+                                std::chrono::duration<Float>(
+                                    std::chrono::steady_clock::now() -
+                                    pixelStart)
+                                    .count();
+                            statsPlanes[statsOffset + 1] +=
+                                (threadIntersectTests - pixelIsects) +
+                                (threadShadowTests - pixelShadow);
+                            statsPlanes[statsOffset + 2] +=
+                                threadIntersectTests - pixelIsects;
+                        }
+                    }
+                    tilePixels += tileBounds.pMax.x - tileBounds.pMin.x;
+
+                    // Hand remaining rows back to the queue if this tile
+                    // has turned out to be much more expensive than the
+                    // average tile
+                    int rowsLeft = tileBounds.pMax.y - (py + 1);
+                    if (rowsLeft < minTileSplitRows) continue;
+                    int64_t nRendered = pixelsRendered;
+                    if (nRendered < (int64_t)maxTileSize * maxTileSize)
+                        continue;
+                    Float avgPixelCost = secondsRendered / nRendered;
+                    Float elapsed =
+                        std::chrono::duration<Float>(
+                            std::chrono::steady_clock::now() - tileStart)
+                            .count();
+                    if (elapsed > 4 * avgPixelCost * tileBounds.Area()) {
+                        // Split the unrendered rows in half along _x_ and
+                        // push both halves for idle workers to pick up
+                        completedBounds.pMax.y = py + 1;
+                        Bounds2i rest(Point2i(tileBounds.pMin.x, py + 1),
+                                      tileBounds.pMax);
+                        int xMid = (rest.pMin.x + rest.pMax.x) / 2;
+                        std::lock_guard<std::mutex> lock(tileQueueMutex);
+                        if (xMid > rest.pMin.x && xMid < rest.pMax.x) {
+                            tileQueue.push_back(Bounds2i(
+                                rest.pMin, Point2i(xMid, rest.pMax.y)));
+                            tileQueue.push_back(Bounds2i(
+                                Point2i(xMid, rest.pMin.y), rest.pMax));
+                            tilesOutstanding += 2;
+                        } else {
+                            tileQueue.push_back(rest);
+                            ++tilesOutstanding;
+                        }
+                        break;
+                    }
+                }
 
-                    // Free _MemoryArena_ memory from computing image sample
-                    // value
-                    arena.Reset();
-                } while (tileSampler->StartNextSample());
+                // Merge image tile into _Film_ and update cost
+                // statistics; trim the arena back toward this tile's
+                // actual needs so per-thread footprint doesn't stay at
+                // the worst case seen
+                camera->film->MergeFilmTile(std::move(filmTile));
+                // Bucketed film: the samples of this tile's completed
+                // rows are final once the last pass has merged them
+                if (camera->film->Bucketed() && passEnd == spp)
+                    camera->film->ReportSampleRegionComplete(completedBounds);
+                camera->film->WritePreviewImage();
+                arena.ReleaseExcess(4 * 262144);
+                if (streamWriter)
+                    camera->film->StreamTileTo(streamWriter.get(),
+                                               tileBounds);
+                secondsRendered.Add(
+                    std::chrono::duration<Float>(
+                        std::chrono::steady_clock::now() - tileStart)
+                        .count());
+                pixelsRendered += tilePixels;
+                reporter.Update(tilePixels);
+                --tilesOutstanding;
             }
-
-            // Merge image tile into _Film_
-            camera->film->MergeFilmTile(std::move(filmTile));
-            reporter.Update();
-        }, nTiles);
+        }, MaxThreadIndex(), 1);
+
+        // Enforce the wall-clock budget between passes
+        if (budgeted &&
+            std::chrono::duration<Float>(std::chrono::steady_clock::now() -
+                                         renderStart)
+                    .count() >= PbrtOptions.renderSeconds)
+            budgetExhausted = true;
+        }
         reporter.Done();
     }
 
-    // Save final image after rendering
-    camera->film->WriteImage();
+    if (streamWriter) streamWriter->Finish();
+
+    // Save final image after rendering (in distributed renders the
+    // workers stream their film to the coordinator instead)
+    camera->film->FlushSplats();
+    if (DistFinishFilm(camera->film)) camera->film->WriteImage();
+
+    // Write the statistics heatmap image, if requested: R holds seconds
+    // spent per pixel, G total intersection tests, and B non-shadow
+    // tests (approximately path vertices).
+    if (statsPlanes) {
+        std::string statsFilename = camera->film->filename;
+        size_t dot = statsFilename.find_last_of('.');
+        if (dot == std::string::npos)
+            statsFilename += "_stats.exr";
+        else
+            statsFilename = statsFilename.substr(0, dot) + "_stats" +
+                            statsFilename.substr(dot);
+        ::WriteImage(statsFilename, statsPlanes.get(), statsBounds,
+                     camera->film->fullResolution);
+    }
+
+    // Write the denoiser AOV images, normalized by per-pixel sample
+    // counts; depth is replicated across the three channels
+    if (aovPlanes) {
+        std::string base = camera->film->filename;
+        size_t dot = base.find_last_of('.');
+        std::string ext =
+            dot == std::string::npos ? ".exr" : base.substr(dot);
+        if (dot != std::string::npos) base = base.substr(0, dot);
+        const char *names[5] = {"_albedo", "_normal", "_depth", "_direct",
+                                "_indirect"};
+        const int offsets[5] = {0, 3, 6, 7, 10};
+        const int widths[5] = {3, 3, 1, 3, 3};
+        size_t nPixels = (size_t)statsBounds.Area();
+        std::vector<Float> rgb(3 * nPixels);
+        for (int plane = 0; plane < 5; ++plane) {
+            for (size_t i = 0; i < nPixels; ++i) {
+                const Float *src = &aovPlanes[nAOVChannels * i];
+                Float invN = src[13] > 0 ? 1 / src[13] : 0;
+                for (int c = 0; c < 3; ++c)
+                    rgb[3 * i + c] =
+                        src[offsets[plane] + std::min(c, widths[plane] - 1)] *
+                        invN;
+            }
+            ::WriteImage(base + names[plane] + ext, &rgb[0], statsBounds,
+                         camera->film->fullResolution);
+        }
+    }
 }
 
 Spectrum SamplerIntegrator::SpecularReflect(
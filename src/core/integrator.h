@@ -55,22 +55,78 @@ class Integrator {
     virtual void Render(const Scene &scene) = 0;
 };
 
+// Per-sample AOV record for denoiser outputs (--aovs): integrators
+// that support it fill the record pointed to by the thread-local
+// _aovSample_ while evaluating Li(); the render loop owns the pointer
+// and accumulates the results into the AOV planes.
+struct AOVSample {
+    Spectrum albedo, direct;
+    Normal3f n;
+    Float depth = 0;
+    bool valid = false;
+};
+extern PBRT_THREAD_LOCAL AOVSample *aovSample;
+
+// Deferred shadow rays: EstimateDirect() can queue its light-sample
+// visibility ray and candidate contribution here instead of tracing
+// immediately; ResolveShadowBatch() then resolves the whole batch
+// through the any-hit ray stream, ordered by direction, and returns
+// the sum of the unoccluded contributions.
+struct ShadowRayBatch {
+    std::vector<Ray> rays;
+    std::vector<Spectrum> contributions;
+};
+Spectrum ResolveShadowBatch(ShadowRayBatch &batch, const Scene &scene);
+
 Spectrum UniformSampleAllLights(const Interaction &it, const Scene &scene,
                                 MemoryArena &arena, Sampler &sampler,
                                 const std::vector<int> &nLightSamples,
-                                bool handleMedia = false);
+                                bool handleMedia = false,
+                                const std::vector<int> *lightSet = nullptr);
 Spectrum UniformSampleOneLight(const Interaction &it, const Scene &scene,
                                MemoryArena &arena, Sampler &sampler,
-                               bool handleMedia = false);
+                               bool handleMedia = false,
+                               const Distribution1D *lightDistrib = nullptr);
+Spectrum SampleOneLightHierarchical(const Interaction &it, const Scene &scene,
+                                    MemoryArena &arena, Sampler &sampler,
+                                    const LightTree &lightTree,
+                                    bool handleMedia = false);
 Spectrum EstimateDirect(const Interaction &it, const Point2f &uShading,
                         const Light &light, const Point2f &uLight,
                         const Scene &scene, Sampler &sampler,
                         MemoryArena &arena, bool handleMedia = false,
-                        bool specular = false);
+                        bool specular = false,
+                        ShadowRayBatch *shadowBatch = nullptr);
 std::unique_ptr<Distribution1D> ComputeLightPowerDistribution(
     const Scene &scene);
 
 // SamplerIntegrator Declarations
+// Primary-hit shading reuse (preview integrators, "shadingreuse"):
+// successive pixel samples that land on the same primitive within a
+// UV tolerance reuse the first sample's evaluated BSDF -- texture
+// lookups included -- from a per-thread arena that outlives the
+// per-sample arena resets.  The cache is cleared at each pixel by
+// SamplerIntegrator::Render().
+struct PrimaryShadingCache {
+    MemoryArena arena;
+    bool valid = false;
+    const Primitive *primitive = nullptr;
+    Point2f uv;
+    BSDF *bsdf = nullptr;
+    void Reset() {
+        valid = false;
+        bsdf = nullptr;
+        arena.Reset();
+    }
+};
+extern PBRT_THREAD_LOCAL PrimaryShadingCache *primaryShadingCache;
+void ResetPrimaryShadingCache();
+// Serve _isect_'s scattering functions from the cache or compute and
+// record them; only for depth-0 hits of integrators that opt in.
+void ComputeOrReusePrimaryShading(SurfaceInteraction *isect,
+                                  const RayDifferential &ray,
+                                  Float uvTolerance);
+
 class SamplerIntegrator : public Integrator {
   public:
     // SamplerIntegrator Public Methods
@@ -94,9 +150,6 @@ class SamplerIntegrator : public Integrator {
   protected:
     // SamplerIntegrator Protected Data
     std::shared_ptr<const Camera> camera;
-
-  private:
-    // SamplerIntegrator Private Data
     std::shared_ptr<Sampler> sampler;
 };
 
@@ -33,6 +33,7 @@
 
 // core/interaction.cpp*
 #include "interaction.h"
+#include "material.h"
 #include "transform.h"
 #include "primitive.h"
 #include "shape.h"
@@ -91,7 +92,20 @@ void SurfaceInteraction::ComputeScatteringFunctions(const RayDifferential &ray,
                                                     MemoryArena &arena,
                                                     bool allowMultipleLobes,
                                                     TransportMode mode) {
-    ComputeDifferentials(ray);
+    // Finalize shading geometry deferred by the intersection routine
+    if (shadingDeferred && shape) {
+        shape->ComputeDeferredShading(this);
+        shadingDeferred = false;
+    }
+    // Skip the dual plane-intersection solve when the material's
+    // texture graph never reads differentials (MakeMaterial metadata)
+    const Material *material = primitive->GetMaterial();
+    if (!material || material->needsDifferentials)
+        ComputeDifferentials(ray);
+    else {
+        dudx = dvdx = dudy = dvdy = 0;
+        dpdx = dpdy = Vector3f(0, 0, 0);
+    }
     primitive->ComputeScatteringFunctions(this, arena, mode,
                                           allowMultipleLobes);
 }
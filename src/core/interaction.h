@@ -146,6 +146,22 @@ class SurfaceInteraction : public Interaction {
     BSSRDF *bssrdf = nullptr;
     mutable Vector3f dpdx, dpdy;
     mutable Float dudx = 0, dvdx = 0, dudy = 0, dvdy = 0;
+    // Index of the (base) face this interaction lies on, for per-face
+    // texturing; triangle meshes use the triangle number unless the
+    // mesh carries explicit face indices (e.g. subdivision ancestors)
+    int faceIndex = 0;
+    // Hero-wavelength state: an integrator that samples a per-path
+    // wavelength stores it here before computing scattering functions;
+    // materials that evaluate a wavelength-dependent index of
+    // refraction from it set _dispersive_ in response.
+    Float wavelength = 0;
+    bool dispersive = false;
+    // Deferred shading geometry: shapes may record their barycentrics
+    // here and postpone interpolated-normal/tangent setup until
+    // ComputeScatteringFunctions(), so hits overwritten during BVH
+    // traversal skip that work entirely
+    mutable bool shadingDeferred = false;
+    Float deferredB0 = 0, deferredB1 = 0;
 };
 
 #endif  // PBRT_CORE_INTERACTION_H
@@ -33,6 +33,10 @@
 
 // core/interpolation.cpp*
 #include "interpolation.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PBRT_INTERP_HAVE_AVX2
+#endif
 
 // Spline Interpolation Definitions
 Float CatmullRom(int size, const Float *nodes, const Float *values, Float x) {
@@ -344,12 +348,63 @@ Float InvertCatmullRom(int n, const Float *x, const Float *values, Float u) {
 }
 
 // Fourier Interpolation Definitions
+#ifdef PBRT_INTERP_HAVE_AVX2
+// Load four consecutive _Float_ coefficients as doubles
+static inline __m256d LoadFloat4d(const Float *p) {
+#ifdef PBRT_FLOAT_AS_DOUBLE
+    return _mm256_loadu_pd(p);
+#else
+    return _mm256_cvtps_pd(_mm_loadu_ps(p));
+#endif
+}
+#endif  // PBRT_INTERP_HAVE_AVX2
+
 Float Fourier(const Float *a, int m, double cosPhi) {
     double value = 0.0;
+    int k = 0;
+#ifdef PBRT_INTERP_HAVE_AVX2
+    // Evaluate four summands per FMA using the blocked Chebyshev
+    // recurrence cos((k+4)phi) = 2 cos(4 phi) cos(k phi) -
+    // cos((k-4)phi): the contiguous _a_ coefficients stream straight
+    // into fused multiply-adds with double-precision accumulation.
+    if (m >= 16) {
+        // Compute the first eight cosine iterates with the scalar
+        // recurrence to seed two blocks of four
+        double c[8] = {1, cosPhi};
+        for (int i = 2; i < 8; ++i) c[i] = 2 * cosPhi * c[i - 1] - c[i - 2];
+        __m256d vPrev = _mm256_loadu_pd(c);
+        __m256d vCur = _mm256_loadu_pd(c + 4);
+        __m256d twoCos4 = _mm256_set1_pd(2 * c[4]);
+        __m256d sum = _mm256_mul_pd(LoadFloat4d(a), vPrev);
+        for (k = 4; k + 4 <= m; k += 4) {
+            sum = _mm256_fmadd_pd(LoadFloat4d(a + k), vCur, sum);
+            __m256d vNext = _mm256_fmsub_pd(twoCos4, vCur, vPrev);
+            vPrev = vCur;
+            vCur = vNext;
+        }
+        __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(sum),
+                                _mm256_extractf128_pd(sum, 1));
+        value = _mm_cvtsd_f64(lo) +
+                _mm_cvtsd_f64(_mm_unpackhi_pd(lo, lo));
+        if (k == m) return value;
+        // Reseed the scalar iterates for the tail from the last blocks
+        double cur[4], prev[4];
+        _mm256_storeu_pd(cur, vCur);
+        _mm256_storeu_pd(prev, vPrev);
+        double cosKMinusOnePhi = prev[3], cosKPhi = cur[0];
+        for (; k < m; ++k) {
+            value += a[k] * cosKPhi;
+            double cosKPlusOnePhi = 2 * cosPhi * cosKPhi - cosKMinusOnePhi;
+            cosKMinusOnePhi = cosKPhi;
+            cosKPhi = cosKPlusOnePhi;
+        }
+        return value;
+    }
+#endif  // PBRT_INTERP_HAVE_AVX2
     // Initialize cosine iterates
     double cosKMinusOnePhi = cosPhi;
     double cosKPhi = 1;
-    for (int k = 0; k < m; ++k) {
+    for (; k < m; ++k) {
         // Add the current summand and update the cosine iterates
         value += a[k] * cosKPhi;
         double cosKPlusOnePhi = 2 * cosPhi * cosKPhi - cosKMinusOnePhi;
@@ -65,3 +65,10 @@ Spectrum VisibilityTester::Tr(const Scene &scene, Sampler &sampler) const {
 }
 
 Spectrum Light::Le(const RayDifferential &ray) const { return Spectrum(0.f); }
+
+void Light::Sample_Li_batch(const Interaction &ref, const Point2f *u, int n,
+                            Vector3f *wi, Float *pdf, Spectrum *Li,
+                            VisibilityTester *vis) const {
+    for (int i = 0; i < n; ++i)
+        Li[i] = Sample_Li(ref, u[i], &wi[i], &pdf[i], &vis[i]);
+}
@@ -80,7 +80,19 @@ class Light {
     virtual Spectrum Sample_Li(const Interaction &ref, const Point2f &u,
                                Vector3f *wi, Float *pdf,
                                VisibilityTester *vis) const = 0;
+    // Draw _n_ light samples toward _ref_ in one call; the default
+    // forwards to Sample_Li() per sample, but a single batch entry
+    // point lets the all-lights strategy amortize the per-call virtual
+    // dispatch over its sample arrays.
+    virtual void Sample_Li_batch(const Interaction &ref, const Point2f *u,
+                                 int n, Vector3f *wi, Float *pdf,
+                                 Spectrum *Li, VisibilityTester *vis) const;
     virtual Spectrum Power() const = 0;
+    // Optional world-space bound for light-sampling hierarchies;
+    // lights without a meaningful finite bound (distant, infinite)
+    // keep the default degenerate bounds and are sampled outside the
+    // hierarchy.
+    virtual Bounds3f WorldBound() const { return Bounds3f(); }
     virtual void Preprocess(const Scene &scene) {}
     virtual Spectrum Le(const RayDifferential &r) const;
     virtual Float Pdf_Li(const Interaction &ref, const Vector3f &wi) const = 0;
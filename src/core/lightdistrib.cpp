@@ -0,0 +1,136 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// core/lightdistrib.cpp*
+#include "lightdistrib.h"
+#include "scene.h"
+#include "light.h"
+#include "interaction.h"
+#include "stats.h"
+
+STAT_COUNTER("Lights/Spatial light voxels built", nLightVoxelsBuilt);
+
+// SpatialLightDistribution Method Definitions
+SpatialLightDistribution::SpatialLightDistribution(const Scene &scene,
+                                                   int maxVoxels)
+    : scene(scene) {
+    // Resolve voxel counts proportional to the scene extents
+    Vector3f diag = scene.WorldBound().Diagonal();
+    Float maxExtent = std::max(diag.x, std::max(diag.y, diag.z));
+    for (int i = 0; i < 3; ++i)
+        nVoxels[i] = std::max(1, (int)std::round(diag[i] / maxExtent *
+                                                 maxVoxels));
+}
+
+const SpatialLightDistribution::VoxelEntry *
+SpatialLightDistribution::LookupEntry(const Point3f &p) const {
+    // Compute the voxel coordinates and packed key for _p_
+    Vector3f offset = scene.WorldBound().Offset(p);
+    Point3i pi;
+    for (int i = 0; i < 3; ++i)
+        pi[i] = Clamp((int)(offset[i] * nVoxels[i]), 0, nVoxels[i] - 1);
+    uint64_t key = (((uint64_t)pi.x << 40) | ((uint64_t)pi.y << 20) |
+                    (uint64_t)pi.z);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = voxelDistribs.find(key);
+        if (iter != voxelDistribs.end()) return iter->second.get();
+    }
+
+    // Build this voxel's entry outside the lock, keeping the first one
+    // if another thread built it concurrently
+    VoxelEntry *built = ComputeEntry(pi);
+    ++nLightVoxelsBuilt;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<VoxelEntry> &entry = voxelDistribs[key];
+    if (!entry) entry.reset(built);
+    else delete built;
+    return entry.get();
+}
+
+const Distribution1D *SpatialLightDistribution::Lookup(
+    const Point3f &p) const {
+    return LookupEntry(p)->distrib.get();
+}
+
+const std::vector<int> *SpatialLightDistribution::CulledLights(
+    const Point3f &p) const {
+    return &LookupEntry(p)->culledLights;
+}
+
+SpatialLightDistribution::VoxelEntry *SpatialLightDistribution::ComputeEntry(
+    const Point3i &pi) const {
+    // Estimate each light's contribution at sample points in the voxel
+    Bounds3f world = scene.WorldBound();
+    Bounds3f voxel(
+        world.Lerp(Point3f((Float)pi.x / nVoxels[0], (Float)pi.y / nVoxels[1],
+                           (Float)pi.z / nVoxels[2])),
+        world.Lerp(Point3f((Float)(pi.x + 1) / nVoxels[0],
+                           (Float)(pi.y + 1) / nVoxels[1],
+                           (Float)(pi.z + 1) / nVoxels[2])));
+    const Point3f samplePoints[] = {
+        voxel.Lerp(Point3f(.5f, .5f, .5f)), voxel.Lerp(Point3f(.125f, .25f, .375f)),
+        voxel.Lerp(Point3f(.875f, .625f, .75f))};
+    std::vector<Float> contrib(scene.lights.size(), 0);
+    for (size_t i = 0; i < scene.lights.size(); ++i) {
+        for (const Point3f &p : samplePoints) {
+            Interaction intr(p, Normal3f(), Vector3f(), Vector3f(1, 0, 0), 0,
+                             MediumInterface());
+            Vector3f wi;
+            Float pdf;
+            VisibilityTester vis;
+            Spectrum Li =
+                scene.lights[i]->Sample_Li(intr, Point2f(.5f, .5f), &wi, &pdf,
+                                           &vis);
+            if (pdf > 0) contrib[i] += Li.y() / pdf;
+        }
+    }
+
+    // Record the lights that pass the cull threshold relative to the
+    // strongest contributor at this voxel
+    VoxelEntry *entry = new VoxelEntry;
+    Float maxContrib = 0;
+    for (Float c : contrib) maxContrib = std::max(maxContrib, c);
+    for (size_t i = 0; i < contrib.size(); ++i)
+        if (contrib[i] >= cullThreshold * maxContrib)
+            entry->culledLights.push_back(i);
+
+    // Give every light a floor of a fraction of the average so distant
+    // contributors are never unreachable
+    Float sum = 0;
+    for (Float c : contrib) sum += c;
+    Float floor = sum > 0 ? .001f * sum / contrib.size() : 1;
+    for (Float &c : contrib) c = std::max(c, floor);
+    entry->distrib.reset(new Distribution1D(&contrib[0], (int)contrib.size()));
+    return entry;
+}
@@ -0,0 +1,83 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_LIGHTDISTRIB_H
+#define PBRT_CORE_LIGHTDISTRIB_H
+
+// core/lightdistrib.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include "sampling.h"
+#include <map>
+#include <mutex>
+
+// Spatially varying light sampling distributions: the scene bounds are
+// voxelized and each voxel lazily builds a Distribution1D over the
+// scene's lights from their estimated contribution at the voxel, so
+// shading points draw lights that actually matter nearby instead of
+// using one global power distribution.  Voxels are created on first
+// touch, so memory tracks visited space.
+class SpatialLightDistribution {
+  public:
+    // SpatialLightDistribution Public Methods
+    SpatialLightDistribution(const Scene &scene, int maxVoxels = 64);
+    // Return the light distribution for the voxel containing _p_
+    const Distribution1D *Lookup(const Point3f &p) const;
+    // Return the indices of the lights whose estimated contribution at
+    // the voxel containing _p_ is at least _cullThreshold_ of the
+    // strongest light's (for O(N) all-lights shading loops); built
+    // lazily with the voxel's distribution
+    const std::vector<int> *CulledLights(const Point3f &p) const;
+
+  private:
+    // SpatialLightDistribution Private Methods
+    struct VoxelEntry {
+        std::unique_ptr<Distribution1D> distrib;
+        std::vector<int> culledLights;
+    };
+    const VoxelEntry *LookupEntry(const Point3f &p) const;
+    VoxelEntry *ComputeEntry(const Point3i &pi) const;
+
+    // SpatialLightDistribution Private Data
+    const Scene &scene;
+    int nVoxels[3];
+    Float cullThreshold = 1e-3f;
+    mutable std::map<uint64_t, std::unique_ptr<VoxelEntry>> voxelDistribs;
+    mutable std::mutex mutex;
+};
+
+#endif  // PBRT_CORE_LIGHTDISTRIB_H
@@ -0,0 +1,231 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// core/lighttree.cpp*
+#include "lighttree.h"
+#include "light.h"
+#include "integrator.h"
+#include "sampler.h"
+#include "rng.h"
+#include <algorithm>
+
+// LightTree Method Definitions
+LightTree::LightTree(const std::vector<std::shared_ptr<Light>> &lights)
+    : sceneLights(lights) {
+    // Partition lights into bounded hierarchy inputs and the unbounded
+    // side set
+    std::vector<std::pair<int, Bounds3f>> build;
+    std::vector<Float> &power = lightPower;
+    power.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        power[i] = lights[i]->Power().y();
+        if (power[i] <= 0) continue;
+        Bounds3f b = lights[i]->WorldBound();
+        if (b.pMin.x <= b.pMax.x) {
+            build.push_back(std::make_pair((int)i, b));
+            totalBoundedPower += power[i];
+        } else {
+            unbounded.push_back(i);
+            unboundedPower.push_back(power[i]);
+            totalUnboundedPower += power[i];
+        }
+    }
+    if (!build.empty()) {
+        nodes.reserve(2 * build.size());
+        buildRecursive(build, 0, (int)build.size(), power);
+    }
+}
+
+int LightTree::buildRecursive(std::vector<std::pair<int, Bounds3f>> &build,
+                              int start, int end,
+                              const std::vector<Float> &power) {
+    int nodeIndex = (int)nodes.size();
+    nodes.push_back(LightTreeNode());
+    Bounds3f bounds;
+    Float nodePower = 0;
+    for (int i = start; i < end; ++i) {
+        bounds = Union(bounds, build[i].second);
+        nodePower += power[build[i].first];
+    }
+    nodes[nodeIndex].bounds = bounds;
+    nodes[nodeIndex].power = nodePower;
+    int rep = build[start].first;
+    for (int i = start + 1; i < end; ++i)
+        if (power[build[i].first] > power[rep]) rep = build[i].first;
+    nodes[nodeIndex].repLight = rep;
+    if (end - start == 1) {
+        nodes[nodeIndex].lightIndex = build[start].first;
+        return nodeIndex;
+    }
+
+    // Median split along the largest extent of the light centroids
+    Bounds3f centroidBounds;
+    for (int i = start; i < end; ++i)
+        centroidBounds = Union(centroidBounds,
+                               build[i].second.pMin +
+                                   build[i].second.Diagonal() * 0.5f);
+    int axis = centroidBounds.MaximumExtent();
+    int mid = (start + end) / 2;
+    std::nth_element(&build[start], &build[mid], &build[0] + end,
+                     [axis](const std::pair<int, Bounds3f> &a,
+                            const std::pair<int, Bounds3f> &b) {
+                         return a.second.pMin[axis] + a.second.pMax[axis] <
+                                b.second.pMin[axis] + b.second.pMax[axis];
+                     });
+    buildRecursive(build, start, mid, power);
+    nodes[nodeIndex].rightChild = buildRecursive(build, mid, end, power);
+    return nodeIndex;
+}
+
+Float LightTree::Importance(const LightTreeNode &node, const Point3f &p) const {
+    // Power over squared distance, with the distance clamped to the
+    // cluster's radius so a point inside a cluster doesn't see an
+    // unbounded importance
+    Vector3f d = node.bounds.pMin + node.bounds.Diagonal() * 0.5f - p;
+    Float radius2 = node.bounds.Diagonal().LengthSquared() * 0.25f;
+    return node.power / std::max(d.LengthSquared(), std::max(radius2,
+                                                             (Float)1e-6f));
+}
+
+int LightTree::SampleLight(const Point3f &p, Float u, Float *pmf) const {
+    Float total = totalBoundedPower + totalUnboundedPower;
+    if (total <= 0) {
+        *pmf = 0;
+        return -1;
+    }
+
+    // Choose between the unbounded set and the hierarchy by power share
+    Float pUnbounded = totalUnboundedPower / total;
+    if (u < pUnbounded) {
+        // Pick an unbounded light in proportion to its power
+        Float target = u / pUnbounded * totalUnboundedPower, sum = 0;
+        for (size_t i = 0; i < unbounded.size(); ++i) {
+            sum += unboundedPower[i];
+            if (target < sum || i + 1 == unbounded.size()) {
+                *pmf = pUnbounded * unboundedPower[i] / totalUnboundedPower;
+                return unbounded[i];
+            }
+        }
+    }
+    if (nodes.empty()) {
+        *pmf = 0;
+        return -1;
+    }
+    u = (u - pUnbounded) / (1 - pUnbounded);
+
+    // Descend the hierarchy, choosing children by importance at _p_
+    Float prob = 1 - pUnbounded;
+    int node = 0;
+    for (;;) {
+        const LightTreeNode &n = nodes[node];
+        if (n.lightIndex >= 0) {
+            *pmf = prob;
+            return n.lightIndex;
+        }
+        const LightTreeNode &left = nodes[node + 1];
+        const LightTreeNode &right = nodes[n.rightChild];
+        Float iLeft = Importance(left, p), iRight = Importance(right, p);
+        Float iSum = iLeft + iRight;
+        Float pLeft = iSum > 0 ? iLeft / iSum : 0.5f;
+        if (u < pLeft) {
+            u = pLeft > 0 ? u / pLeft : 0;
+            prob *= pLeft;
+            node = node + 1;
+        } else {
+            u = pLeft < 1 ? (u - pLeft) / (1 - pLeft) : 0;
+            prob *= 1 - pLeft;
+            node = n.rightChild;
+        }
+        u = std::min(u, OneMinusEpsilon);
+    }
+}
+
+Spectrum LightTree::ShadeLightcut(const Interaction &it, const Scene &scene,
+                                  MemoryArena &arena, Sampler &sampler,
+                                  Float errorThreshold, int maxCut) const {
+    Spectrum L(0.f);
+
+    // Unbounded lights are few; shade them individually
+    for (int index : unbounded)
+        L += EstimateDirect(it, sampler.Get2D(), *sceneLights[index],
+                            sampler.Get2D(), scene, sampler, arena);
+    if (nodes.empty()) return L;
+
+    // Evaluate a cluster through its representative light, scaled by
+    // the cluster's share of power
+    auto evaluateCluster = [&](int node) {
+        const LightTreeNode &n = nodes[node];
+        Spectrum Lrep = EstimateDirect(it, sampler.Get2D(),
+                                       *sceneLights[n.repLight],
+                                       sampler.Get2D(), scene, sampler,
+                                       arena);
+        return Lrep * (n.power / lightPower[n.repLight]);
+    };
+
+    // Maintain the cut ordered by each cluster's importance bound,
+    // refining the worst cluster while its bound is significant
+    struct CutEntry {
+        int node;
+        Float bound;
+        Spectrum estimate;
+    };
+    std::vector<CutEntry> cut;
+    cut.push_back({0, Importance(nodes[0], it.p), evaluateCluster(0)});
+    Float totalLum = cut[0].estimate.y();
+    for (;;) {
+        // Find the cluster with the largest bound
+        int worst = -1;
+        Float worstBound = 0;
+        for (size_t i = 0; i < cut.size(); ++i)
+            if (nodes[cut[i].node].lightIndex < 0 &&
+                cut[i].bound > worstBound) {
+                worstBound = cut[i].bound;
+                worst = (int)i;
+            }
+        if (worst < 0 || (int)cut.size() >= maxCut ||
+            worstBound <= errorThreshold * std::max(totalLum, (Float)1e-4))
+            break;
+
+        // Replace the cluster with its two children
+        int node = cut[worst].node;
+        totalLum -= cut[worst].estimate.y();
+        int left = node + 1, right = nodes[node].rightChild;
+        cut[worst] = {left, Importance(nodes[left], it.p),
+                      evaluateCluster(left)};
+        cut.push_back({right, Importance(nodes[right], it.p),
+                       evaluateCluster(right)});
+        totalLum += cut[worst].estimate.y() + cut.back().estimate.y();
+    }
+    for (const CutEntry &entry : cut) L += entry.estimate;
+    return L;
+}
@@ -0,0 +1,98 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_LIGHTTREE_H
+#define PBRT_CORE_LIGHTTREE_H
+
+// core/lighttree.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include <memory>
+#include <vector>
+
+// A BVH over the scene's finitely bounded lights, traversed per
+// shading point with a distance- and power-aware importance so
+// many-light scenes pick relevant lights instead of sampling all of
+// them uniformly.  Unbounded lights (distant, infinite) are kept in a
+// side set chosen in proportion to their share of total power.
+class LightTree {
+  public:
+    // LightTree Public Methods
+    LightTree(const std::vector<std::shared_ptr<Light>> &lights);
+    // Choose a light for shading point _p_, returning its index into
+    // the scene's light vector and the probability of the choice;
+    // returns -1 if the scene has no lights with power.
+    int SampleLight(const Point3f &p, Float u, Float *pmf) const;
+    // Lightcuts-style shading: evaluate direct lighting at _it_ against
+    // an adaptively refined cut through the tree, approximating each
+    // cluster by its representative light scaled by the cluster's
+    // power, refining clusters whose importance bound exceeds
+    // _errorThreshold_ times the running estimate (up to _maxCut_
+    // clusters).
+    Spectrum ShadeLightcut(const Interaction &it, const Scene &scene,
+                           MemoryArena &arena, Sampler &sampler,
+                           Float errorThreshold, int maxCut) const;
+
+  private:
+    // LightTree Private Declarations
+    struct LightTreeNode {
+        Bounds3f bounds;
+        Float power;
+        // Interior nodes store their second child's offset; leaves
+        // store the light's index in the scene light vector
+        int rightChild = -1;
+        int lightIndex = -1;
+        // Highest-power light of the subtree, the cluster
+        // representative for lightcuts shading
+        int repLight = -1;
+    };
+
+    // LightTree Private Methods
+    int buildRecursive(std::vector<std::pair<int, Bounds3f>> &build, int start,
+                       int end, const std::vector<Float> &power);
+    Float Importance(const LightTreeNode &node, const Point3f &p) const;
+
+    // LightTree Private Data
+    const std::vector<std::shared_ptr<Light>> &sceneLights;
+    std::vector<Float> lightPower;
+    std::vector<LightTreeNode> nodes;
+    std::vector<int> unbounded;
+    std::vector<Float> unboundedPower;
+    Float totalBoundedPower = 0, totalUnboundedPower = 0;
+};
+
+#endif  // PBRT_CORE_LIGHTTREE_H
@@ -39,6 +39,8 @@
 #include "reflection.h"
 
 // Material Method Definitions
+PBRT_THREAD_LOCAL Float regularizeRoughness;
+
 Material::~Material() {}
 
 void Material::Bump(const std::shared_ptr<Texture<Float>> &d,
@@ -46,6 +46,14 @@
 enum class TransportMode { Radiance, Importance };
 
 // Material Declarations
+
+// Path regularization (the path integrator's "regularize" parameter):
+// before evaluating scattering functions at a vertex past the first
+// diffuse bounce, the integrator sets this per-thread roughness floor
+// and clears it afterward; specular materials then build a narrow
+// microfacet lobe instead of a delta lobe, trading a controlled bias
+// for sampleable specular-diffuse-specular (caustic) paths.
+extern PBRT_THREAD_LOCAL Float regularizeRoughness;
 class Material {
   public:
     // Material Interface
@@ -56,6 +64,13 @@ class Material {
     virtual ~Material();
     static void Bump(const std::shared_ptr<Texture<Float>> &d,
                      SurfaceInteraction *si);
+
+    // Material Public Data
+    // False when none of the material's bound textures needs ray
+    // differentials (set by MakeMaterial() from the texture graph);
+    // SurfaceInteraction::ComputeScatteringFunctions() then skips the
+    // dual plane-intersection solve in ComputeDifferentials().
+    bool needsDifferentials = true;
 };
 
 #endif  // PBRT_CORE_MATERIAL_H
@@ -41,6 +41,7 @@
 // core/memory.h*
 #include "pbrt.h"
 #include "parallel.h"
+#include <vector>
 #include <list>
 
 // Memory Declarations
@@ -51,7 +52,16 @@ T *AllocAligned(size_t count) {
     return (T *)AllocAligned(count * sizeof(T));
 }
 
+void *AllocAlignedInterleaved(size_t size);
+template <typename T>
+T *AllocAlignedInterleaved(size_t count) {
+    return (T *)AllocAlignedInterleaved(count * sizeof(T));
+}
+
 void FreeAligned(void *);
+// Arena blocks are allocated lazily by the thread using the arena;
+// since parallel.cpp pins worker threads to CPUs, first-touch placement
+// keeps per-thread arena storage on the thread's own NUMA node.
 class
 #ifdef PBRT_HAVE_ALIGNAS
 alignas(128)
@@ -63,7 +73,8 @@ alignas(128)
     ~MemoryArena() {
         FreeAligned(currentBlock);
         for (auto &block : usedBlocks) FreeAligned(block.second);
-        for (auto &block : availableBlocks) FreeAligned(block.second);
+        for (uint8_t *block : availableStandard) FreeAligned(block);
+        for (auto &block : availableOversize) FreeAligned(block.second);
     }
     void *Alloc(size_t nBytes) {
         // Round up _nBytes_ to minimum machine alignment
@@ -77,16 +88,22 @@ alignas(128)
                 currentAllocSize = 0;
             }
 
-            // Get new block of memory for _MemoryArena_
-
-            // Try to get memory block from _availableBlocks_
-            for (auto iter = availableBlocks.begin();
-                 iter != availableBlocks.end(); ++iter) {
-                if (iter->first >= nBytes) {
-                    currentAllocSize = iter->first;
-                    currentBlock = iter->second;
-                    availableBlocks.erase(iter);
-                    break;
+            // Get new block of memory for _MemoryArena_: standard-size
+            // requests recycle from the exact-size freelist in O(1),
+            // and only oversize requests scan the (short) oversize list
+            if (nBytes <= blockSize && !availableStandard.empty()) {
+                currentAllocSize = blockSize;
+                currentBlock = availableStandard.back();
+                availableStandard.pop_back();
+            } else {
+                for (auto iter = availableOversize.begin();
+                     iter != availableOversize.end(); ++iter) {
+                    if (iter->first >= nBytes) {
+                        currentAllocSize = iter->first;
+                        currentBlock = iter->second;
+                        availableOversize.erase(iter);
+                        break;
+                    }
                 }
             }
             if (!currentBlock) {
@@ -108,12 +125,34 @@ alignas(128)
     }
     void Reset() {
         currentBlockPos = 0;
-        availableBlocks.splice(availableBlocks.begin(), usedBlocks);
+        for (auto &block : usedBlocks) {
+            if (block.first == blockSize)
+                availableStandard.push_back(block.second);
+            else
+                availableOversize.push_back(block);
+        }
+        usedBlocks.clear();
+    }
+    // Free retained blocks beyond _maxRetainBytes_ so a thread's arena
+    // footprint tracks its recent needs instead of its worst case;
+    // oversize blocks (rare, from single large allocations) go first
+    void ReleaseExcess(size_t maxRetainBytes) {
+        while (!availableOversize.empty() &&
+               TotalAllocated() > maxRetainBytes) {
+            FreeAligned(availableOversize.back().second);
+            availableOversize.pop_back();
+        }
+        while (!availableStandard.empty() &&
+               TotalAllocated() > maxRetainBytes) {
+            FreeAligned(availableStandard.back());
+            availableStandard.pop_back();
+        }
     }
     size_t TotalAllocated() const {
         size_t total = currentAllocSize;
         for (const auto &alloc : usedBlocks) total += alloc.first;
-        for (const auto &alloc : availableBlocks) total += alloc.first;
+        total += availableStandard.size() * blockSize;
+        for (const auto &alloc : availableOversize) total += alloc.first;
         return total;
     }
 
@@ -124,21 +163,40 @@ alignas(128)
     const size_t blockSize;
     size_t currentBlockPos = 0, currentAllocSize = 0;
     uint8_t *currentBlock = nullptr;
-    std::list<std::pair<size_t, uint8_t *>> usedBlocks, availableBlocks;
+    std::vector<std::pair<size_t, uint8_t *>> usedBlocks;
+    std::vector<uint8_t *> availableStandard;
+    std::vector<std::pair<size_t, uint8_t *>> availableOversize;
 };
 
 template <typename T, int logBlockSize>
 class BlockedArray {
   public:
     // BlockedArray Public Methods
-    BlockedArray(int uRes, int vRes, const T *d = nullptr)
-        : uRes(uRes), vRes(vRes), uBlocks(RoundUp(uRes) >> logBlockSize) {
+    // With _storage_ given, the array is a non-owning view over
+    // caller-provided memory (which must hold TotalAllocSize(uRes,
+    // vRes) elements), letting e.g. a whole MIP pyramid share one
+    // contiguous allocation.
+    // With _initialize_ false (shared-memory attach), the provided
+    // storage already holds the final texels and is left untouched.
+    BlockedArray(int uRes, int vRes, const T *d = nullptr,
+                 T *storage = nullptr, bool initialize = true)
+        : uRes(uRes),
+          vRes(vRes),
+          uBlocks(RoundUp(uRes) >> logBlockSize),
+          ownsData(storage == nullptr) {
         int nAlloc = RoundUp(uRes) * RoundUp(vRes);
-        data = AllocAligned<T>(nAlloc);
-        for (int i = 0; i < nAlloc; ++i) new (&data[i]) T();
-        if (d)
-            for (int v = 0; v < vRes; ++v)
-                for (int u = 0; u < uRes; ++u) (*this)(u, v) = d[v * uRes + u];
+        data = storage ? storage : AllocAligned<T>(nAlloc);
+        if (initialize) {
+            for (int i = 0; i < nAlloc; ++i) new (&data[i]) T();
+            if (d)
+                for (int v = 0; v < vRes; ++v)
+                    for (int u = 0; u < uRes; ++u)
+                        (*this)(u, v) = d[v * uRes + u];
+        }
+    }
+    static int TotalAllocSize(int uRes, int vRes) {
+        PBRT_CONSTEXPR int bs = 1 << logBlockSize;
+        return ((uRes + bs - 1) & ~(bs - 1)) * ((vRes + bs - 1) & ~(bs - 1));
     }
     PBRT_CONSTEXPR int BlockSize() const { return 1 << logBlockSize; }
     int RoundUp(int x) const {
@@ -148,7 +206,7 @@ class BlockedArray {
     int vSize() const { return vRes; }
     ~BlockedArray() {
         for (int i = 0; i < uRes * vRes; ++i) data[i].~T();
-        FreeAligned(data);
+        if (ownsData) FreeAligned(data);
     }
     int Block(int a) const { return a >> logBlockSize; }
     int Offset(int a) const { return (a & (BlockSize() - 1)); }
@@ -175,6 +233,7 @@ class BlockedArray {
     // BlockedArray Private Data
     T *data;
     const int uRes, vRes, uBlocks;
+    const bool ownsData;
 };
 
 #endif  // PBRT_CORE_MEMORY_H
@@ -224,76 +224,40 @@ Vector3f BeckmannDistribution::Sample_wh(const Vector3f &wo,
     }
 }
 
-static void TrowbridgeReitzSample11(Float cosTheta, Float U1, Float U2,
-                                    Float *slope_x, Float *slope_y) {
-    // special case (normal incidence)
-    if (cosTheta > .9999) {
-        Float r = sqrt(U1 / (1 - U1));
-        Float phi = 6.28318530718 * U2;
-        *slope_x = r * cos(phi);
-        *slope_y = r * sin(phi);
-        return;
-    }
-
-    Float sinTheta =
-        std::sqrt(std::max((Float)0, (Float)1 - cosTheta * cosTheta));
-    Float tanTheta = sinTheta / cosTheta;
-    Float a = 1 / tanTheta;
-    Float G1 = 2 / (1 + std::sqrt(1.f + 1.f / (a * a)));
-
-    // sample slope_x
-    Float A = 2 * U1 / G1 - 1;
-    Float tmp = 1.f / (A * A - 1.f);
-    if (tmp > 1e10) tmp = 1e10;
-    Float B = tanTheta;
-    Float D = std::sqrt(
-        std::max(Float(B * B * tmp * tmp - (A * A - B * B) * tmp), Float(0)));
-    Float slope_x_1 = B * tmp - D;
-    Float slope_x_2 = B * tmp + D;
-    *slope_x = (A < 0 || slope_x_2 > 1.f / tanTheta) ? slope_x_1 : slope_x_2;
-
-    Assert(!std::isinf(*slope_x));
-    Assert(!std::isnan(*slope_x));
-
-    // sample slope_y
-    Float S;
-    if (U2 > 0.5f) {
-        S = 1.f;
-        U2 = 2.f * (U2 - .5f);
-    } else {
-        S = -1.f;
-        U2 = 2.f * (.5f - U2);
-    }
-    Float z =
-        (U2 * (U2 * (U2 * 0.27385f - 0.73369f) + 0.46341f)) /
-        (U2 * (U2 * (U2 * 0.093073f + 0.309420f) - 1.000000f) + 0.597999f);
-    *slope_y = S * z * std::sqrt(1.f + *slope_x * *slope_x);
-
-    Assert(!std::isinf(*slope_y));
-    Assert(!std::isnan(*slope_y));
-}
-
-static Vector3f TrowbridgeReitzSample(const Vector3f &wi, Float alpha_x,
-                                      Float alpha_y, Float U1, Float U2) {
-    // 1. stretch wi
+// Sample the GGX distribution of visible normals by uniformly sampling
+// a spherical cap in the hemisphere configuration (Heitz 2018,
+// "Sampling the GGX Distribution of Visible Normals"): closed form, so
+// each sample costs two square roots instead of the slope-space
+// inversion's transcendentals and curve fits, and the distribution is
+// exact.  _wi_ must have wi.z > 0.
+static Vector3f TrowbridgeReitzSampleVisible(const Vector3f &wi, Float alpha_x,
+                                             Float alpha_y, Float U1,
+                                             Float U2) {
+    // Transform the view direction to the hemisphere configuration
     Vector3f wiStretched =
         Normalize(Vector3f(alpha_x * wi.x, alpha_y * wi.y, wi.z));
 
-    // 2. simulate P22_{wi}(x_slope, y_slope, 1, 1)
-    Float slope_x, slope_y;
-    TrowbridgeReitzSample11(CosTheta(wiStretched), U1, U2, &slope_x, &slope_y);
-
-    // 3. rotate
-    Float tmp = CosPhi(wiStretched) * slope_x - SinPhi(wiStretched) * slope_y;
-    slope_y = SinPhi(wiStretched) * slope_x + CosPhi(wiStretched) * slope_y;
-    slope_x = tmp;
-
-    // 4. unstretch
-    slope_x = alpha_x * slope_x;
-    slope_y = alpha_y * slope_y;
-
-    // 5. compute normal
-    return Normalize(Vector3f(-slope_x, -slope_y, 1.));
+    // Build an orthonormal basis with wiStretched as the z axis
+    Float lensq = wiStretched.x * wiStretched.x + wiStretched.y * wiStretched.y;
+    Vector3f T1 = lensq > 0 ? Vector3f(-wiStretched.y, wiStretched.x, 0) /
+                                  std::sqrt(lensq)
+                            : Vector3f(1, 0, 0);
+    Vector3f T2 = Cross(wiStretched, T1);
+
+    // Sample a disk position, warped toward the cap visible from wi
+    Float r = std::sqrt(U1);
+    Float phi = 2 * Pi * U2;
+    Float t1 = r * std::cos(phi);
+    Float t2 = r * std::sin(phi);
+    Float s = 0.5f * (1 + wiStretched.z);
+    t2 = (1 - s) * std::sqrt(std::max((Float)0, 1 - t1 * t1)) + s * t2;
+
+    // Project back onto the hemisphere and unstretch
+    Vector3f nh =
+        t1 * T1 + t2 * T2 +
+        std::sqrt(std::max((Float)0, 1 - t1 * t1 - t2 * t2)) * wiStretched;
+    return Normalize(Vector3f(alpha_x * nh.x, alpha_y * nh.y,
+                              std::max((Float)1e-6, nh.z)));
 }
 
 Vector3f TrowbridgeReitzDistribution::Sample_wh(const Vector3f &wo,
@@ -321,7 +285,8 @@ Vector3f TrowbridgeReitzDistribution::Sample_wh(const Vector3f &wo,
         if (!SameHemisphere(wo, wh)) wh = -wh;
     } else {
         bool flip = wo.z < 0;
-        wh = TrowbridgeReitzSample(flip ? -wo : wo, alphax, alphay, u[0], u[1]);
+        wh = TrowbridgeReitzSampleVisible(flip ? -wo : wo, alphax, alphay,
+                                          u[0], u[1]);
         if (flip) wh = -wh;
     }
     return wh;
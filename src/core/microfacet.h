@@ -58,6 +58,7 @@ class MicrofacetDistribution {
     }
     virtual Vector3f Sample_wh(const Vector3f &wo, const Point2f &u) const = 0;
     Float Pdf(const Vector3f &wo, const Vector3f &wh) const;
+    bool SamplesVisibleArea() const { return sampleVisibleArea; }
 
   protected:
     // MicrofacetDistribution Protected Methods
@@ -42,7 +42,13 @@
 #include "pbrt.h"
 #include "spectrum.h"
 #include "texture.h"
+#include "texcache.h"
+#include "sharedmem.h"
 #include "stats.h"
+#if defined(__AVX2__) && !defined(PBRT_FLOAT_AS_DOUBLE)
+#include <immintrin.h>
+#define PBRT_MIPMAP_HAVE_AVX2
+#endif
 STAT_COUNTER("Texture/Texture map EWA lookups", nEWALookups);
 STAT_COUNTER("Texture/Texture map trilerp lookups", nTrilerpLookups);
 STAT_MEMORY_COUNTER("Memory/Texture MIP maps", mipMapMemory);
@@ -50,6 +56,8 @@ STAT_TIMER("Time/MIP map creation", mipMapTime);
 
 // MIPMap Helper Declarations
 enum class ImageWrap { Repeat, Black, Clamp };
+enum class MIPMapStorage { Full, Half };
+
 struct ResampleWeight {
     int firstTexel;
     Float weight[4];
@@ -60,12 +68,99 @@ template <typename T>
 class MIPMap {
   public:
     // MIPMap Public Methods
+    // Cached-tile MIPMap: texels are fetched on demand from the tiled
+    // texture cache rather than from a resident pyramid
+    MIPMap(TiledTextureCache *cache, int cacheTexId, const Point2i &res,
+           std::vector<Point2i> levelRes, bool doTrilinear, Float maxAnisotropy,
+           ImageWrap wrapMode)
+        : doTrilinear(doTrilinear),
+          maxAnisotropy(maxAnisotropy),
+          wrapMode(wrapMode),
+          resolution(res),
+          cache(cache),
+          cacheTexId(cacheTexId),
+          levelRes(std::move(levelRes)) {
+        InitEWAWeightsIfNeeded();
+    }
+    static void InitEWAWeightsIfNeeded() {
+        if (weightLut[0] == 0.) {
+            for (int i = 0; i < WeightLUTSize; ++i) {
+                Float alpha = 2;
+                Float r2 = Float(i) / Float(WeightLUTSize - 1);
+                weightLut[i] = std::exp(-alpha * r2) - std::exp(-alpha);
+            }
+        }
+    }
     MIPMap(const Point2i &resolution, const T *data, bool doTri = false,
-           Float maxAniso = 8.f, ImageWrap wrapMode = ImageWrap::Repeat);
+           Float maxAniso = 8.f, ImageWrap wrapMode = ImageWrap::Repeat,
+           MIPMapStorage storage = MIPMapStorage::Full,
+           uint64_t shareKey = 0);
     int Width() const { return resolution[0]; }
     int Height() const { return resolution[1]; }
-    int Levels() const { return pyramid.size(); }
+    int Levels() const {
+        if (cache) return levelRes.size();
+        return halfPyramid.empty() ? pyramid.size() : halfPyramid.size();
+    }
     const T &Texel(int level, int s, int t) const;
+    int LevelWidth(int level) const {
+        if (cache) return levelRes[level].x;
+        return halfPyramid.empty() ? pyramid[level]->uSize()
+                                   : halfPyramid[level]->uSize();
+    }
+    int LevelHeight(int level) const {
+        if (cache) return levelRes[level].y;
+        return halfPyramid.empty() ? pyramid[level]->vSize()
+                                   : halfPyramid[level]->vSize();
+    }
+    // Export a resident pyramid to the tiled texture cache file
+    // _filename_ so later renders can stream its tiles on demand
+    bool WriteCacheFile(const std::string &filename) const {
+        if (cache) return false;
+        std::vector<Point2i> res;
+        std::vector<std::unique_ptr<T[]>> linear;
+        std::vector<const Float *> levels;
+        for (size_t i = 0; i < pyramid.size(); ++i) {
+            int u = pyramid[i]->uSize(), v = pyramid[i]->vSize();
+            linear.emplace_back(new T[u * v]);
+            pyramid[i]->GetLinearArray(linear.back().get());
+            res.push_back(Point2i(u, v));
+            levels.push_back((const Float *)linear.back().get());
+        }
+        return TiledTextureCache::WriteCacheFile(
+            filename, sizeof(T) / sizeof(Float), res, levels);
+    }
+    // Fetch texel (s, t) from the resident full or half-precision
+    // pyramid, or on demand from the tiled texture cache
+    T FetchTexel(int level, int s, int t) const {
+        int sRes = LevelWidth(level), tRes = LevelHeight(level);
+        switch (wrapMode) {
+        case ImageWrap::Repeat:
+            s = Mod(s, sRes);
+            t = Mod(t, tRes);
+            break;
+        case ImageWrap::Clamp:
+            s = Clamp(s, 0, sRes - 1);
+            t = Clamp(t, 0, tRes - 1);
+            break;
+        case ImageWrap::Black:
+            if (s < 0 || s >= sRes || t < 0 || t >= tRes) return T(0.f);
+            break;
+        }
+        if (cache) {
+            T ret;
+            cache->GetTexel(cacheTexId, level, s, t, (Float *)&ret);
+            return ret;
+        }
+        if (!halfPyramid.empty()) {
+            // Decode the half-precision texel channels
+            const HalfTexel &ht = (*halfPyramid[level])(s, t);
+            T ret;
+            for (int c = 0; c < (int)(sizeof(T) / sizeof(Float)); ++c)
+                ((Float *)&ret)[c] = HalfToFloat(ht.h[c]);
+            return ret;
+        }
+        return (*pyramid[level])(s, t);
+    }
     T Lookup(const Point2f &st, Float width = 0.f) const;
     T Lookup(const Point2f &st, Vector2f dstdx, Vector2f dstdy) const;
 
@@ -104,7 +199,32 @@ class MIPMap {
     const Float maxAnisotropy;
     const ImageWrap wrapMode;
     Point2i resolution;
-    std::vector<std::unique_ptr<BlockedArray<T>>> pyramid;
+    // Block geometry tuned to the texel size (half-texel levels use
+    // 8x8 blocks so a block still spans cache lines), and all levels
+    // of a pyramid share one contiguous allocation so trilinear's
+    // two-level access pattern stays within one prefetch stream
+    static PBRT_CONSTEXPR int pyramidLogBlock = sizeof(T) >= 8 ? 2 : 3;
+    typedef BlockedArray<T, pyramidLogBlock> PyramidLevel;
+    std::vector<std::unique_ptr<PyramidLevel>> pyramid;
+    std::unique_ptr<T[]> pyramidStorage;
+    // Non-null when the pyramid lives in a cross-process shared
+    // segment (--sharedmem); the segment is never freed here
+    T *sharedPyramid = nullptr;
+    // Half-precision pyramid used with MIPMapStorage::Half; texels are
+    // decoded in FetchTexel(), halving resident texture memory at the
+    // cost of a conversion on fetch
+    struct HalfTexel {
+        uint16_t h[sizeof(T) / sizeof(Float)];
+    };
+    // Half texels are 2 bytes per channel, so 8x8 blocks keep a block
+    // spanning whole cache lines
+    typedef BlockedArray<HalfTexel, 3> HalfLevel;
+    std::vector<std::unique_ptr<HalfLevel>> halfPyramid;
+    std::unique_ptr<uint8_t[]> halfStorage;
+    // MIPMap cached-mode data
+    TiledTextureCache *cache = nullptr;
+    int cacheTexId = -1;
+    std::vector<Point2i> levelRes;
     static PBRT_CONSTEXPR int WeightLUTSize = 128;
     static Float weightLut[WeightLUTSize];
 };
@@ -112,7 +232,8 @@ class MIPMap {
 // MIPMap Method Definitions
 template <typename T>
 MIPMap<T>::MIPMap(const Point2i &res, const T *img, bool doTrilinear,
-                  Float maxAnisotropy, ImageWrap wrapMode)
+                  Float maxAnisotropy, ImageWrap wrapMode,
+                  MIPMapStorage storage, uint64_t shareKey)
     : doTrilinear(doTrilinear),
       maxAnisotropy(maxAnisotropy),
       wrapMode(wrapMode),
@@ -175,19 +296,67 @@ MIPMap<T>::MIPMap(const Point2i &res, const T *img, bool doTrilinear,
         for (auto ptr : resampleBufs) delete[] ptr;
         resolution = resPow2;
     }
-    // Initialize levels of MIPMap from image
+    // Initialize levels of MIPMap from image, backing the whole
+    // pyramid with a single contiguous allocation
     int nLevels = 1 + Log2Int(std::max(resolution[0], resolution[1]));
     pyramid.resize(nLevels);
+    std::vector<Point2i> levelDims(nLevels);
+    levelDims[0] = Point2i(resolution[0], resolution[1]);
+    size_t totalTexels =
+        PyramidLevel::TotalAllocSize(resolution[0], resolution[1]);
+    for (int i = 1; i < nLevels; ++i) {
+        levelDims[i] = Point2i(std::max(1, levelDims[i - 1].x / 2),
+                               std::max(1, levelDims[i - 1].y / 2));
+        totalTexels +=
+            PyramidLevel::TotalAllocSize(levelDims[i].x, levelDims[i].y);
+    }
+    // With --sharedmem and a content key, back the pyramid with a
+    // named shared segment: the first process builds into it and
+    // marks it ready; others attach the finished texels and skip the
+    // build entirely, so one resident copy serves every job on the
+    // node
+    T *storageBase = nullptr;
+    bool sharedCreator = false;
+    if (shareKey != 0 && SharedSceneEnabled() &&
+        storage == MIPMapStorage::Full) {
+        sharedPyramid = (T *)SharedScenePublishOrAttach(
+            shareKey, totalTexels * sizeof(T), &sharedCreator);
+        if (sharedPyramid) storageBase = sharedPyramid;
+        if (sharedPyramid && !sharedCreator) {
+            // Attach the finished texels and skip the build
+            SharedSceneWaitReady(sharedPyramid);
+            size_t offset = 0;
+            for (int i = 0; i < nLevels; ++i) {
+                pyramid[i].reset(new PyramidLevel(levelDims[i].x,
+                                                  levelDims[i].y, nullptr,
+                                                  &storageBase[offset],
+                                                  false));
+                offset +=
+                    PyramidLevel::TotalAllocSize(levelDims[i].x,
+                                                 levelDims[i].y);
+            }
+            InitEWAWeightsIfNeeded();
+            return;
+        }
+    }
+    if (!storageBase) {
+        pyramidStorage.reset(new T[totalTexels]);
+        storageBase = pyramidStorage.get();
+    }
+    size_t levelOffset = 0;
 
     // Initialize most detailed level of MIPMap
-    pyramid[0].reset(
-        new BlockedArray<T>(resolution[0], resolution[1],
-                            resampledImage ? resampledImage.get() : img));
+    pyramid[0].reset(new PyramidLevel(
+        resolution[0], resolution[1],
+        resampledImage ? resampledImage.get() : img,
+        &storageBase[levelOffset]));
+    levelOffset += PyramidLevel::TotalAllocSize(resolution[0], resolution[1]);
     for (int i = 1; i < nLevels; ++i) {
         // Initialize $i$th MIPMap level from $i-1$st level
-        int sRes = std::max(1, pyramid[i - 1]->uSize() / 2);
-        int tRes = std::max(1, pyramid[i - 1]->vSize() / 2);
-        pyramid[i].reset(new BlockedArray<T>(sRes, tRes));
+        int sRes = levelDims[i].x, tRes = levelDims[i].y;
+        pyramid[i].reset(new PyramidLevel(sRes, tRes, nullptr,
+                                          &storageBase[levelOffset]));
+        levelOffset += PyramidLevel::TotalAllocSize(sRes, tRes);
 
         // Filter four texels from finer level of pyramid
         ParallelFor([&](int t) {
@@ -201,20 +370,47 @@ MIPMap<T>::MIPMap(const Point2i &res, const T *img, bool doTrilinear,
     }
 
     // Initialize EWA filter weights if needed
-    if (weightLut[0] == 0.) {
-        for (int i = 0; i < WeightLUTSize; ++i) {
-            Float alpha = 2;
-            Float r2 = Float(i) / Float(WeightLUTSize - 1);
-            weightLut[i] = std::exp(-alpha * r2) - std::exp(-alpha);
+    InitEWAWeightsIfNeeded();
+
+    // Publish the finished shared pyramid to sibling processes
+    if (sharedPyramid && sharedCreator) SharedSceneMarkReady(sharedPyramid);
+    // Convert the pyramid to half-precision storage if requested,
+    // releasing the full-precision levels as they are converted
+    if (storage == MIPMapStorage::Half) {
+        halfPyramid.resize(pyramid.size());
+        size_t totalHalf = 0;
+        for (size_t i = 0; i < pyramid.size(); ++i)
+            totalHalf += HalfLevel::TotalAllocSize(pyramid[i]->uSize(),
+                                                   pyramid[i]->vSize());
+        halfStorage.reset(new uint8_t[totalHalf * sizeof(HalfTexel)]);
+        size_t halfOffset = 0;
+        for (size_t i = 0; i < pyramid.size(); ++i) {
+            int u = pyramid[i]->uSize(), v = pyramid[i]->vSize();
+            halfPyramid[i].reset(new HalfLevel(
+                u, v, nullptr,
+                (HalfTexel *)&halfStorage[halfOffset * sizeof(HalfTexel)]));
+            halfOffset += HalfLevel::TotalAllocSize(u, v);
+            for (int t = 0; t < v; ++t)
+                for (int s = 0; s < u; ++s) {
+                    const T &texel = (*pyramid[i])(s, t);
+                    HalfTexel &ht = (*halfPyramid[i])(s, t);
+                    for (int c = 0; c < (int)(sizeof(T) / sizeof(Float)); ++c)
+                        ht.h[c] =
+                            FloatToHalf((float)((const Float *)&texel)[c]);
+                }
+            pyramid[i].reset();
         }
-    }
-    mipMapMemory += (4 * resolution[0] * resolution[1] * sizeof(T)) / 3;
+        pyramid.clear();
+        mipMapMemory +=
+            (4 * resolution[0] * resolution[1] * sizeof(HalfTexel)) / 3;
+    } else
+        mipMapMemory += (4 * resolution[0] * resolution[1] * sizeof(T)) / 3;
 }
 
 template <typename T>
 const T &MIPMap<T>::Texel(int level, int s, int t) const {
     Assert(level < pyramid.size());
-    const BlockedArray<T> &l = *pyramid[level];
+    const PyramidLevel &l = *pyramid[level];
     // Compute texel $(s,t)$ accounting for boundary conditions
     switch (wrapMode) {
     case ImageWrap::Repeat:
@@ -246,7 +442,7 @@ T MIPMap<T>::Lookup(const Point2f &st, Float width) const {
     if (level < 0)
         return triangle(0, st);
     else if (level >= Levels() - 1)
-        return Texel(Levels() - 1, 0, 0);
+        return FetchTexel(Levels() - 1, 0, 0);
     else {
         int iLevel = std::floor(level);
         Float delta = level - iLevel;
@@ -257,14 +453,14 @@ T MIPMap<T>::Lookup(const Point2f &st, Float width) const {
 template <typename T>
 T MIPMap<T>::triangle(int level, const Point2f &st) const {
     level = Clamp(level, 0, Levels() - 1);
-    Float s = st[0] * pyramid[level]->uSize() - 0.5f;
-    Float t = st[1] * pyramid[level]->vSize() - 0.5f;
+    Float s = st[0] * LevelWidth(level) - 0.5f;
+    Float t = st[1] * LevelHeight(level) - 0.5f;
     int s0 = std::floor(s), t0 = std::floor(t);
     Float ds = s - s0, dt = t - t0;
-    return (1 - ds) * (1 - dt) * Texel(level, s0, t0) +
-           (1 - ds) * dt * Texel(level, s0, t0 + 1) +
-           ds * (1 - dt) * Texel(level, s0 + 1, t0) +
-           ds * dt * Texel(level, s0 + 1, t0 + 1);
+    return (1 - ds) * (1 - dt) * FetchTexel(level, s0, t0) +
+           (1 - ds) * dt * FetchTexel(level, s0, t0 + 1) +
+           ds * (1 - dt) * FetchTexel(level, s0 + 1, t0) +
+           ds * dt * FetchTexel(level, s0 + 1, t0 + 1);
 }
 
 template <typename T>
@@ -298,14 +494,14 @@ T MIPMap<T>::Lookup(const Point2f &st, Vector2f dst0, Vector2f dst1) const {
 
 template <typename T>
 T MIPMap<T>::EWA(int level, Point2f st, Vector2f dst0, Vector2f dst1) const {
-    if (level >= Levels()) return Texel(Levels() - 1, 0, 0);
+    if (level >= Levels()) return FetchTexel(Levels() - 1, 0, 0);
     // Convert EWA coordinates to appropriate scale for level
-    st[0] = st[0] * pyramid[level]->uSize() - 0.5f;
-    st[1] = st[1] * pyramid[level]->vSize() - 0.5f;
-    dst0[0] *= pyramid[level]->uSize();
-    dst0[1] *= pyramid[level]->vSize();
-    dst1[0] *= pyramid[level]->uSize();
-    dst1[1] *= pyramid[level]->vSize();
+    st[0] = st[0] * LevelWidth(level) - 0.5f;
+    st[1] = st[1] * LevelHeight(level) - 0.5f;
+    dst0[0] *= LevelWidth(level);
+    dst0[1] *= LevelHeight(level);
+    dst1[0] *= LevelWidth(level);
+    dst1[1] *= LevelHeight(level);
 
     // Compute ellipse coefficients to bound EWA filter region
     Float A = dst0[1] * dst0[1] + dst1[1] * dst1[1] + 1;
@@ -328,6 +524,47 @@ T MIPMap<T>::EWA(int level, Point2f st, Vector2f dst0, Vector2f dst1) const {
     // Scan over ellipse bound and compute quadratic equation
     T sum(0.f);
     Float sumWts = 0;
+#ifdef PBRT_MIPMAP_HAVE_AVX2
+    // Evaluate the ellipse test and Gaussian weight lookup for eight
+    // texels per iteration; only the lanes inside the ellipse reach
+    // the (scalar) texel fetch and accumulation.
+    const __m256 iota =
+        _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+    const __m256i iotaInt = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 vA = _mm256_set1_ps(A);
+    for (int it = t0; it <= t1; ++it) {
+        Float tt = it - st[1];
+        const __m256 vBtt = _mm256_set1_ps(B * tt);
+        const __m256 vCtt2 = _mm256_set1_ps(C * tt * tt);
+        for (int is = s0; is <= s1; is += 8) {
+            __m256 ss =
+                _mm256_add_ps(_mm256_set1_ps(is - st[0]), iota);
+            // r2 = A*ss^2 + B*ss*tt + C*tt^2
+            __m256 r2 = _mm256_fmadd_ps(
+                _mm256_fmadd_ps(vA, ss, vBtt), ss, vCtt2);
+            __m256 inside =
+                _mm256_cmp_ps(r2, _mm256_set1_ps(1.f), _CMP_LT_OQ);
+            __m256 lanes = _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+                _mm256_set1_epi32(s1 - is + 1), iotaInt));
+            inside = _mm256_and_ps(inside, lanes);
+            int mask = _mm256_movemask_ps(inside);
+            if (!mask) continue;
+            __m256i index = _mm256_min_epi32(
+                _mm256_cvttps_epi32(_mm256_mul_ps(
+                    r2, _mm256_set1_ps((Float)WeightLUTSize))),
+                _mm256_set1_epi32(WeightLUTSize - 1));
+            __m256 weight = _mm256_mask_i32gather_ps(
+                _mm256_setzero_ps(), weightLut, index, inside, 4);
+            Float w[8];
+            _mm256_storeu_ps(w, weight);
+            for (int lane = 0; lane < 8; ++lane)
+                if (mask & (1 << lane)) {
+                    sum += FetchTexel(level, is + lane, it) * w[lane];
+                    sumWts += w[lane];
+                }
+        }
+    }
+#else
     for (int it = t0; it <= t1; ++it) {
         Float tt = it - st[1];
         for (int is = s0; is <= s1; ++is) {
@@ -338,11 +575,12 @@ T MIPMap<T>::EWA(int level, Point2f st, Vector2f dst0, Vector2f dst1) const {
                 int index =
                     std::min((int)(r2 * WeightLUTSize), WeightLUTSize - 1);
                 Float weight = weightLut[index];
-                sum += Texel(level, is, it) * weight;
+                sum += FetchTexel(level, is, it) * weight;
                 sumWts += weight;
             }
         }
     }
+#endif  // PBRT_MIPMAP_HAVE_AVX2
     return sum / sumWts;
 }
 
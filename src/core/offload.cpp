@@ -0,0 +1,59 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+// core/offload.cpp*
+#include "offload.h"
+#include "scene.h"
+
+// The default backend forwards primary rays to the aggregate's
+// coherent stream kernel; it is what runs when no accelerator backend
+// registered itself.
+namespace {
+class StreamPrimaryHitBackend : public PrimaryHitBackend {
+  public:
+    void TracePrimary(const Scene &scene, Ray *rays,
+                      SurfaceInteraction *isects, bool *hits, int n) {
+        scene.IntersectStream(rays, isects, hits, n);
+    }
+};
+
+std::unique_ptr<PrimaryHitBackend> activeBackend;
+}  // namespace
+
+PrimaryHitBackend *GetPrimaryHitBackend() {
+    if (!activeBackend) activeBackend.reset(new StreamPrimaryHitBackend);
+    return activeBackend.get();
+}
+
+void SetPrimaryHitBackend(std::unique_ptr<PrimaryHitBackend> backend) {
+    activeBackend = std::move(backend);
+}
@@ -0,0 +1,70 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_OFFLOAD_H
+#define PBRT_CORE_OFFLOAD_H
+
+// core/offload.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include <memory>
+
+// First-hit offload declarations.  The primary-visibility pass (the
+// camera-ray hits and G-buffer data the integrators consume) is routed
+// through a pluggable backend so the most coherent part of the ray
+// workload can run on an accelerator while light transport stays on
+// the CPU.  The built-in backend runs the aggregate's coherent stream
+// kernel; a GPU backend (built behind its own flag, when the toolkit
+// and hardware are present) registers itself with
+// SetPrimaryHitBackend() at startup and receives the flattened
+// LinearBVHNode and triangle buffers through the Scene it is handed.
+class PrimaryHitBackend {
+  public:
+    virtual ~PrimaryHitBackend() {}
+    // Trace _n_ primary rays, storing each ray's hit flag and
+    // intersection at its original index.
+    virtual void TracePrimary(const Scene &scene, Ray *rays,
+                              SurfaceInteraction *isects, bool *hits,
+                              int n) = 0;
+};
+
+// Returns the active backend (never null; defaults to the CPU stream
+// backend).
+PrimaryHitBackend *GetPrimaryHitBackend();
+void SetPrimaryHitBackend(std::unique_ptr<PrimaryHitBackend> backend);
+
+#endif  // PBRT_CORE_OFFLOAD_H
@@ -35,16 +35,21 @@
 #include "parallel.h"
 #include "memory.h"
 #include "stats.h"
-#include <list>
+#include <deque>
 #include <thread>
 #include <condition_variable>
+#ifdef PBRT_IS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#include <sstream>
+#endif  // PBRT_IS_LINUX
 
 // Parallel Local Definitions
 static std::vector<std::thread> threads;
-static bool shutdownThreads = false;
+static std::atomic<bool> shutdownThreads(false);
 class ParallelForLoop;
-static ParallelForLoop *workList = nullptr;
-static std::mutex workListMutex;
+
 class ParallelForLoop {
   public:
     // ParallelForLoop Public Methods
@@ -53,83 +58,269 @@ class ParallelForLoop {
         : func1D(std::move(func1D)),
           maxIndex(maxIndex),
           chunkSize(chunkSize),
-          profilerState(profilerState) {}
+          profilerState(profilerState),
+          itersRemaining(maxIndex) {}
     ParallelForLoop(const std::function<void(Point2i)> &f, const Point2i &count,
                     int profilerState)
         : func2D(f),
           maxIndex(count.x * count.y),
           chunkSize(1),
-          profilerState(profilerState) {
+          profilerState(profilerState),
+          itersRemaining(count.x * count.y) {
         nX = count.x;
     }
+    ParallelForLoop(std::function<void(int64_t, int64_t)> funcRange,
+                    int64_t maxIndex, int chunkSize, int profilerState)
+        : funcRange(std::move(funcRange)),
+          maxIndex(maxIndex),
+          chunkSize(chunkSize),
+          profilerState(profilerState),
+          itersRemaining(maxIndex) {}
 
   public:
     // ParallelForLoop Private Data
     std::function<void(int64_t)> func1D;
     std::function<void(Point2i)> func2D;
+    std::function<void(int64_t, int64_t)> funcRange;
     const int64_t maxIndex;
     const int chunkSize, profilerState;
-    int64_t nextIndex = 0;
-    int activeWorkers = 0;
-    ParallelForLoop *next = nullptr;
+    std::atomic<int64_t> itersRemaining;
     int nX = -1;
 
     // ParallelForLoop Private Methods
-    bool Finished() const {
-        return nextIndex >= maxIndex && activeWorkers == 0;
+    bool Finished() const { return itersRemaining <= 0; }
+};
+
+// A chunk of loop iterations waiting to be run by some worker
+struct WorkChunk {
+    ParallelForLoop *loop;
+    int64_t start, end;
+};
+
+// Per-thread chunk deque: the owning thread pushes and pops at the back
+// and thieves take from the front.  Each deque has its own mutex, so a
+// thread ordinarily synchronizes only with the occasional thief instead
+// of funneling through one global work-list lock.
+class WorkerDeque {
+  public:
+    void Push(const WorkChunk &chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.push_back(chunk);
+    }
+    bool PopBack(WorkChunk *chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (chunks.empty()) return false;
+        *chunk = chunks.back();
+        chunks.pop_back();
+        return true;
     }
+    bool StealFront(WorkChunk *chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (chunks.empty()) return false;
+        *chunk = chunks.front();
+        chunks.pop_front();
+        return true;
+    }
+    // Take the newest chunk belonging to _loop_, if the deque holds one.
+    // Used by nested ParallelFor calls so that a joining worker runs its
+    // own sub-loop's chunks before helping with unrelated loops.
+    bool TakeFor(const ParallelForLoop *loop, WorkChunk *chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto iter = chunks.rbegin(); iter != chunks.rend(); ++iter) {
+            if (iter->loop == loop) {
+                *chunk = *iter;
+                chunks.erase(std::next(iter).base());
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    std::mutex mutex;
+    std::deque<WorkChunk> chunks;
 };
 
-static std::condition_variable workListCondition;
+static std::vector<std::unique_ptr<WorkerDeque>> workerDeques;
+static std::atomic<int64_t> pendingChunks(0);
+static std::mutex sleepMutex;
+static std::condition_variable wakeCondition;
+
+// NUMA Local Definitions
+static int nNumaNodes = 1;
+
+#ifdef PBRT_IS_LINUX
+// Parse the set of CPUs belonging to each NUMA node from
+// /sys/devices/system/node so that worker threads can be pinned and
+// large allocations interleaved without a libnuma dependency.
+static void InitNumaTopology() {
+    for (int node = 0;; ++node) {
+        std::ifstream cpuList("/sys/devices/system/node/node" +
+                              std::to_string(node) + "/cpulist");
+        if (!cpuList) break;
+        nNumaNodes = node + 1;
+    }
+}
+
+// Pin the calling thread to one CPU so that it stays on a single NUMA
+// node and the arena memory it first-touches remains node-local.
+static void PinThreadToCpu(int cpu) {
+    int nCpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu % nCpus, &cpuSet);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+}
+#else
+static void InitNumaTopology() {}
+static void PinThreadToCpu(int cpu) {}
+#endif  // PBRT_IS_LINUX
+
+// Run the iterations of _chunk_ on the calling thread
+static void RunChunk(const WorkChunk &chunk) {
+    ParallelForLoop &loop = *chunk.loop;
+    uint64_t traceStart =
+        profilerTraceEnabled ? TraceTimeNowUs() : 0;
+    uint64_t perfStart[NumPerfCounterEvents];
+    bool perfValid = perfCountersEnabled && ReadPerfCounters(perfStart);
+    int oldState = profilerState;
+    profilerState = loop.profilerState;
+    if (loop.funcRange) {
+        // A single dispatch covers the whole chunk; the body's per-index
+        // loop is inlined at the call site of the templated ParallelFor.
+        loop.funcRange(chunk.start, chunk.end);
+    } else {
+        for (int64_t index = chunk.start; index < chunk.end; ++index) {
+            if (loop.func1D) {
+                loop.func1D(index);
+            }
+            // Handle other types of loops
+            else {
+                Assert(loop.func2D);
+                loop.func2D(Point2i(index % loop.nX, index / loop.nX));
+            }
+        }
+    }
+    profilerState = oldState;
+    if (profilerTraceEnabled)
+        RecordTraceEvent((int)Prof::NumProfEvents, traceStart,
+                         TraceTimeNowUs() - traceStart);
+    if (perfValid) {
+        uint64_t perfEnd[NumPerfCounterEvents];
+        if (ReadPerfCounters(perfEnd))
+            ReportPerfCounterInterval((int)Prof::NumProfEvents, perfStart,
+                                      perfEnd);
+    }
+    // This decrement must be the last access to _loop_: as soon as it
+    // reaches zero, the submitting thread is free to destroy the loop.
+    loop.itersRemaining -= chunk.end - chunk.start;
+}
+
+// Take a chunk from this thread's deque, or steal one from another
+// thread's, returning false if no work could be found anywhere
+static bool AcquireChunk(WorkChunk *chunk) {
+    int nDeques = workerDeques.size();
+    if (nDeques == 0) return false;
+    int self = ThreadIndex < nDeques ? ThreadIndex : 0;
+    if (workerDeques[self]->PopBack(chunk)) {
+        --pendingChunks;
+        return true;
+    }
+    for (int i = 0; i < nDeques; ++i) {
+        int victim = (self + 1 + i) % nDeques;
+        if (workerDeques[victim]->StealFront(chunk)) {
+            --pendingChunks;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Take a chunk belonging to _loop_ from any deque, returning false if
+// none of _loop_'s chunks remain queued
+static bool AcquireChunkFor(const ParallelForLoop *loop, WorkChunk *chunk) {
+    int nDeques = workerDeques.size();
+    if (nDeques == 0) return false;
+    int self = ThreadIndex < nDeques ? ThreadIndex : 0;
+    for (int i = 0; i < nDeques; ++i) {
+        if (workerDeques[(self + i) % nDeques]->TakeFor(loop, chunk)) {
+            --pendingChunks;
+            return true;
+        }
+    }
+    return false;
+}
+
 static void workerThreadFunc(int tIndex) {
     ThreadIndex = tIndex;
-    std::unique_lock<std::mutex> lock(workListMutex);
+    PinThreadToCpu(tIndex);
     while (!shutdownThreads) {
-        if (!workList) {
+        WorkChunk chunk;
+        if (AcquireChunk(&chunk))
+            RunChunk(chunk);
+        else {
             // Sleep until there are more tasks to run
-            workListCondition.wait(lock);
-        } else {
-            // Get work from _workList_ and run loop iterations
-            ParallelForLoop &loop = *workList;
-
-            // Run a chunk of loop iterations for _loop_
-
-            // Find the set of loop iterations to run next
-            int64_t indexStart = loop.nextIndex;
-            int64_t indexEnd =
-                std::min(indexStart + loop.chunkSize, loop.maxIndex);
-
-            // Update _loop_ to reflect iterations this thread will run
-            loop.nextIndex = indexEnd;
-            if (loop.nextIndex == loop.maxIndex) workList = loop.next;
-            loop.activeWorkers++;
-
-            // Run loop indices in _[indexStart, indexEnd)_
-            lock.unlock();
-            for (int64_t index = indexStart; index < indexEnd; ++index) {
-                int oldState = profilerState;
-                profilerState = loop.profilerState;
-                if (loop.func1D) {
-                    loop.func1D(index);
-                }
-                // Handle other types of loops
-                else {
-                    Assert(loop.func2D);
-                    loop.func2D(Point2i(index % loop.nX, index / loop.nX));
-                }
-                profilerState = oldState;
-            }
-            lock.lock();
-
-            // Update _loop_ to reflect completion of iterations
-            loop.activeWorkers--;
-            if (loop.Finished()) workListCondition.notify_all();
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeCondition.wait(lock, []() {
+                return shutdownThreads.load() || pendingChunks.load() > 0;
+            });
         }
     }
     // Report thread statistics at worker thread exit
     ReportThreadStats();
 }
 
+// Launch worker threads and their deques if needed
+static void LaunchWorkerThreads() {
+    if (threads.size() > 0 || PbrtOptions.nThreads == 1) return;
+    int nThreads = NumSystemCores();
+    ThreadIndex = 0;
+    NumNumaNodes();
+    PinThreadToCpu(0);
+    workerDeques.resize(nThreads);
+    for (int i = 0; i < nThreads; ++i) workerDeques[i].reset(new WorkerDeque);
+    for (int i = 0; i < nThreads - 1; ++i)
+        threads.push_back(std::thread(workerThreadFunc, i + 1));
+}
+
+// Split _loop_ into chunks, distribute them round-robin over the worker
+// deques (starting with the calling thread's own), and help run chunks
+// until the loop has finished.
+static void EnqueueAndRun(ParallelForLoop &loop) {
+    int nDeques = workerDeques.size();
+    int64_t nChunks = (loop.maxIndex + loop.chunkSize - 1) / loop.chunkSize;
+    int deque = ThreadIndex < nDeques ? ThreadIndex : 0;
+    for (int64_t c = 0; c < nChunks; ++c) {
+        int64_t start = c * loop.chunkSize;
+        workerDeques[deque]->Push(
+            {&loop, start,
+             std::min(start + (int64_t)loop.chunkSize, loop.maxIndex)});
+        deque = (deque + 1) % nDeques;
+    }
+    pendingChunks += nChunks;
+
+    // Notify worker threads of work to be done
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeCondition.notify_all();
+
+    // Help out with parallel loop iterations in the current thread,
+    // running this loop's own chunks first so that a nested ParallelFor
+    // issued from a worker joins promptly; falling back to chunks of
+    // other in-flight loops keeps the system deadlock-free while some
+    // of this loop's chunks are still running elsewhere.
+    WorkChunk chunk;
+    while (!loop.Finished()) {
+        if (AcquireChunkFor(&loop, &chunk))
+            RunChunk(chunk);
+        else if (AcquireChunk(&chunk))
+            RunChunk(chunk);
+        else
+            std::this_thread::yield();
+    }
+}
+
 // Parallel Definitions
 void ParallelFor(std::function<void(int64_t)> func, int64_t count,
                  int chunkSize) {
@@ -140,70 +331,36 @@ void ParallelFor(std::function<void(int64_t)> func, int64_t count,
     }
 
     // Launch worker threads if needed
-    if (threads.size() == 0) {
-        Assert(PbrtOptions.nThreads != 1);
-        ThreadIndex = 0;
-        for (int i = 0; i < NumSystemCores() - 1; ++i)
-            threads.push_back(std::thread(workerThreadFunc, i + 1));
-    }
+    LaunchWorkerThreads();
 
-    // Create and enqueue _ParallelForLoop_ for this loop
+    // Create _ParallelForLoop_ for this loop and run it to completion
     ParallelForLoop loop(std::move(func), count, chunkSize,
                          CurrentProfilerState());
-    workListMutex.lock();
-    loop.next = workList;
-    workList = &loop;
-    workListMutex.unlock();
+    EnqueueAndRun(loop);
+}
 
-    // Notify worker threads of work to be done
-    std::unique_lock<std::mutex> lock(workListMutex);
-    workListCondition.notify_all();
+void ParallelForRange(std::function<void(int64_t, int64_t)> func,
+                      int64_t count, int chunkSize) {
+    // Run iterations immediately if not using threads or if _count_ is small
+    if (PbrtOptions.nThreads == 1 || count < chunkSize) {
+        if (count > 0) func(0, count);
+        return;
+    }
 
-    // Help out with parallel loop iterations in the current thread
-    while (!loop.Finished()) {
-        // Run a chunk of loop iterations for _loop_
-
-        // Find the set of loop iterations to run next
-        int64_t indexStart = loop.nextIndex;
-        int64_t indexEnd = std::min(indexStart + loop.chunkSize, loop.maxIndex);
-
-        // Update _loop_ to reflect iterations this thread will run
-        loop.nextIndex = indexEnd;
-        if (loop.nextIndex == loop.maxIndex) workList = loop.next;
-        loop.activeWorkers++;
-
-        // Run loop indices in _[indexStart, indexEnd)_
-        lock.unlock();
-        for (int64_t index = indexStart; index < indexEnd; ++index) {
-            int oldState = profilerState;
-            profilerState = loop.profilerState;
-            if (loop.func1D) {
-                loop.func1D(index);
-            }
-            // Handle other types of loops
-            else {
-                Assert(loop.func2D);
-                loop.func2D(Point2i(index % loop.nX, index / loop.nX));
-            }
-            profilerState = oldState;
-        }
-        lock.lock();
+    // Launch worker threads if needed
+    LaunchWorkerThreads();
 
-        // Update _loop_ to reflect completion of iterations
-        loop.activeWorkers--;
-    }
+    // Create _ParallelForLoop_ for this loop and run it to completion
+    ParallelForLoop loop(std::move(func), count, chunkSize,
+                         CurrentProfilerState());
+    EnqueueAndRun(loop);
 }
 
 PBRT_THREAD_LOCAL int ThreadIndex;
 int MaxThreadIndex() {
     if (PbrtOptions.nThreads != 1) {
         // Launch worker threads if needed
-        if (threads.size() == 0) {
-            Assert(PbrtOptions.nThreads != 1);
-            ThreadIndex = 0;
-            for (int i = 0; i < NumSystemCores() - 1; ++i)
-                threads.push_back(std::thread(workerThreadFunc, i + 1));
-        }
+        LaunchWorkerThreads();
     }
     return 1 + threads.size();
 }
@@ -215,56 +372,16 @@ void ParallelFor2D(std::function<void(Point2i)> func, const Point2i &count) {
         return;
     }
     // Launch worker threads if needed
-    if (threads.size() == 0) {
-        Assert(PbrtOptions.nThreads != 1);
-        ThreadIndex = 0;
-        for (int i = 0; i < NumSystemCores() - 1; ++i)
-            threads.push_back(std::thread(workerThreadFunc, i + 1));
-    }
+    LaunchWorkerThreads();
 
     ParallelForLoop loop(std::move(func), count, CurrentProfilerState());
-    {
-        std::lock_guard<std::mutex> lock(workListMutex);
-        loop.next = workList;
-        workList = &loop;
-    }
-
-    std::unique_lock<std::mutex> lock(workListMutex);
-    workListCondition.notify_all();
-
-    // Help out with parallel loop iterations in the current thread
-    while (!loop.Finished()) {
-        // Run a chunk of loop iterations for _loop_
-
-        // Find the set of loop iterations to run next
-        int64_t indexStart = loop.nextIndex;
-        int64_t indexEnd = std::min(indexStart + loop.chunkSize, loop.maxIndex);
-
-        // Update _loop_ to reflect iterations this thread will run
-        loop.nextIndex = indexEnd;
-        if (loop.nextIndex == loop.maxIndex) workList = loop.next;
-        loop.activeWorkers++;
-
-        // Run loop indices in _[indexStart, indexEnd)_
-        lock.unlock();
-        for (int64_t index = indexStart; index < indexEnd; ++index) {
-            int oldState = profilerState;
-            profilerState = loop.profilerState;
-            if (loop.func1D) {
-                loop.func1D(index);
-            }
-            // Handle other types of loops
-            else {
-                Assert(loop.func2D);
-                loop.func2D(Point2i(index % loop.nX, index / loop.nX));
-            }
-            profilerState = oldState;
-        }
-        lock.lock();
+    EnqueueAndRun(loop);
+}
 
-        // Update _loop_ to reflect completion of iterations
-        loop.activeWorkers--;
-    }
+int NumNumaNodes() {
+    static std::once_flag flag;
+    std::call_once(flag, InitNumaTopology);
+    return nNumaNodes;
 }
 
 int NumSystemCores() {
@@ -276,12 +393,13 @@ void TerminateWorkerThreads() {
     if (threads.size() == 0) return;
 
     {
-        std::lock_guard<std::mutex> lock(workListMutex);
+        std::lock_guard<std::mutex> lock(sleepMutex);
         shutdownThreads = true;
-        workListCondition.notify_all();
+        wakeCondition.notify_all();
     }
 
     for (std::thread &thread : threads) thread.join();
     threads.erase(threads.begin(), threads.end());
+    workerDeques.clear();
     shutdownThreads = false;
 }
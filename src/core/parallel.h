@@ -65,6 +65,11 @@ class AtomicFloat {
             newBits = FloatToBits(BitsToFloat(oldBits) + v);
         } while (!bits.compare_exchange_weak(oldBits, newBits));
     }
+    // Atomically replace the value, returning the previous one; lets
+    // accumulator stripes be drained without losing concurrent adds
+    Float Exchange(Float v) {
+        return BitsToFloat(bits.exchange(FloatToBits(v)));
+    }
 
   private:
 // AtomicFloat Private Data
@@ -77,10 +82,25 @@ class AtomicFloat {
 
 void ParallelFor(std::function<void(int64_t)> func, int64_t count,
                  int chunkSize = 1);
+void ParallelForRange(std::function<void(int64_t, int64_t)> func,
+                      int64_t count, int chunkSize = 1);
+// Templated overload: the loop body is wrapped in a lambda that runs a
+// whole [begin, end) chunk per dispatch, so _func_ is inlined into the
+// chunk loop (and can be vectorized) rather than being called through a
+// std::function indirection once per index.
+template <typename Func>
+void ParallelFor(Func func, int64_t count, int chunkSize = 1) {
+    ParallelForRange(
+        [&func](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) func(i);
+        },
+        count, chunkSize);
+}
 extern PBRT_THREAD_LOCAL int ThreadIndex;
 void ParallelFor2D(std::function<void(Point2i)> func, const Point2i &count);
 int MaxThreadIndex();
 int NumSystemCores();
+int NumNumaNodes();
 void TerminateWorkerThreads();
 
 #endif  // PBRT_CORE_PARALLEL_H
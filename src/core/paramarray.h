@@ -0,0 +1,68 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_PARAMARRAY_H
+#define PBRT_CORE_PARAMARRAY_H
+
+// core/paramarray.h*
+// The parser's dynamically grown parameter array, shared between the
+// yacc grammar and the lexer's bulk numeric-array fast path.
+#include <stdlib.h>
+#include <stdint.h>
+
+struct ParamArray {
+    ParamArray() {
+        isString = false;
+        element_size = allocated = nelems = 0;
+        array = nullptr;
+    }
+    bool isString;
+    int element_size;
+    int allocated;
+    int nelems;
+    void *array;
+};
+
+inline void ParamArrayPushDouble(ParamArray *a, double v) {
+    if (a->nelems >= a->allocated) {
+        a->allocated = 2 * a->allocated + 4096;
+        a->array = realloc(a->array, a->allocated * sizeof(double));
+    }
+    ((double *)a->array)[a->nelems++] = v;
+}
+
+#endif  // PBRT_CORE_PARAMARRAY_H
@@ -37,30 +37,142 @@
 #include "textures/constant.h"
 
 // ParamSet Macros
+// Interning table for ParamSetItem payloads: generated scenes repeat
+// identical parameters (the same "Kd" spectrum, texture reference,
+// etc.) thousands of times, so equal (name, values) items share one
+// allocation instead of every directive carrying its own copy.  The
+// per-type tables deliberately persist for the whole process so
+// sharing also spans multiple scenes rendered by one invocation.
+template <typename T>
+static void AppendItemKey(const T *values, int nValues, std::string *key) {
+    key->append((const char *)values, nValues * sizeof(T));
+}
+
+static void AppendItemKey(const std::string *values, int nValues,
+                          std::string *key) {
+    for (int i = 0; i < nValues; ++i) {
+        key->append(values[i]);
+        key->push_back('\0');
+    }
+}
+
+// Registry of per-type intern-table cleaners, run by
+// FreeInternedParamItems() once parsing is done
+static std::vector<std::function<void()>> internTableCleaners;
+static std::mutex internCleanerMutex;
+
+void FreeInternedParamItems() {
+    std::lock_guard<std::mutex> lock(internCleanerMutex);
+    for (const auto &cleaner : internTableCleaners) cleaner();
+}
+
+template <typename T>
+static std::shared_ptr<ParamSetItem<T>> InternItem(const std::string &name,
+                                                   std::unique_ptr<T[]> values,
+                                                   int nValues) {
+    static std::map<std::string, std::shared_ptr<ParamSetItem<T>>> table;
+    static std::mutex mutex;
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        std::lock_guard<std::mutex> lock(internCleanerMutex);
+        internTableCleaners.push_back([]() {
+            std::lock_guard<std::mutex> tableLock(mutex);
+            table.clear();
+        });
+    });
+    std::string key = name;
+    key.push_back('\0');
+    AppendItemKey(values.get(), nValues, &key);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = table.find(key);
+    if (iter != table.end()) return iter->second;
+    std::shared_ptr<ParamSetItem<T>> item(
+        new ParamSetItem<T>(name, std::move(values), nValues));
+    table[key] = item;
+    return item;
+}
+
 #define ADD_PARAM_TYPE(T, vec) \
-    (vec).emplace_back(new ParamSetItem<T>(name, std::move(values), nValues));
-#define LOOKUP_PTR(vec)             \
-    for (const auto &v : vec)       \
-        if (v->name == name) {      \
-            *nValues = v->nValues;  \
-            v->lookedUp = true;     \
-            return v->values.get(); \
-        }                           \
+    (vec).push_back(InternItem<T>(name, std::move(values), nValues));
+#define LOOKUP_PTR(vec)                                   \
+    const uint32_t nameHash_ = ParamNameHash(name);       \
+    for (const auto &v : vec)                             \
+        if (v->nameHash == nameHash_ && v->name == name) { \
+            *nValues = v->nValues;                        \
+            v->lookedUp = true;                           \
+            return v->values.get();                       \
+        }                                                 \
     return nullptr
-#define LOOKUP_ONE(vec)                           \
-    for (const auto &v : vec)                     \
-        if (v->name == name && v->nValues == 1) { \
-            v->lookedUp = true;                   \
-            return v->values[0];                  \
-        }                                         \
+#define LOOKUP_ONE(vec)                             \
+    const uint32_t nameHash_ = ParamNameHash(name); \
+    for (const auto &v : vec)                       \
+        if (v->nameHash == nameHash_ &&             \
+            v->name == name && v->nValues == 1) {   \
+            v->lookedUp = true;                     \
+            return v->values[0];                    \
+        }                                           \
     return d
 
 // ParamSet Methods
+static void HashContentBytes(const void *data, size_t size,
+                             uint64_t *hash) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; ++i) {
+        *hash ^= bytes[i];
+        *hash *= 1099511628211ull;
+    }
+}
+
+template <typename T>
+static void HashParamItems(
+    const std::vector<std::shared_ptr<ParamSetItem<T>>> &items,
+    uint64_t *hash) {
+    for (const auto &item : items) {
+        HashContentBytes(item->name.data(), item->name.size(), hash);
+        HashContentBytes(item->values.get(),
+                         item->nValues * sizeof(item->values[0]), hash);
+    }
+}
+
+static void HashParamItems(
+    const std::vector<std::shared_ptr<ParamSetItem<std::string>>> &items,
+    uint64_t *hash) {
+    for (const auto &item : items) {
+        HashContentBytes(item->name.data(), item->name.size(), hash);
+        for (int i = 0; i < item->nValues; ++i)
+            HashContentBytes(item->values[i].data(), item->values[i].size(),
+                             hash);
+    }
+}
+
+uint64_t ParamSet::ContentHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    HashParamItems(bools, &hash);
+    HashParamItems(ints, &hash);
+    HashParamItems(floats, &hash);
+    HashParamItems(point2fs, &hash);
+    HashParamItems(vector2fs, &hash);
+    HashParamItems(point3fs, &hash);
+    HashParamItems(vector3fs, &hash);
+    HashParamItems(normals, &hash);
+    HashParamItems(spectra, &hash);
+    HashParamItems(strings, &hash);
+    HashParamItems(textures, &hash);
+    return hash;
+}
+
+std::vector<std::string> ParamSet::AllTextureNames() const {
+    std::vector<std::string> names;
+    for (const auto &item : textures)
+        for (int i = 0; i < item->nValues; ++i)
+            names.push_back(item->values[i]);
+    return names;
+}
+
 void ParamSet::AddFloat(const std::string &name,
                         std::unique_ptr<Float[]> values, int nValues) {
     EraseFloat(name);
-    floats.emplace_back(
-        new ParamSetItem<Float>(name, std::move(values), nValues));
+    ADD_PARAM_TYPE(Float, floats);
 }
 
 void ParamSet::AddInt(const std::string &name, std::unique_ptr<int[]> values,
@@ -112,9 +224,7 @@ void ParamSet::AddRGBSpectrum(const std::string &name,
     nValues /= 3;
     std::unique_ptr<Spectrum[]> s(new Spectrum[nValues]);
     for (int i = 0; i < nValues; ++i) s[i] = Spectrum::FromRGB(&values[3 * i]);
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
-    spectra.push_back(psi);
+    spectra.push_back(InternItem<Spectrum>(name, std::move(s), nValues));
 }
 
 void ParamSet::AddXYZSpectrum(const std::string &name,
@@ -124,9 +234,7 @@ void ParamSet::AddXYZSpectrum(const std::string &name,
     nValues /= 3;
     std::unique_ptr<Spectrum[]> s(new Spectrum[nValues]);
     for (int i = 0; i < nValues; ++i) s[i] = Spectrum::FromXYZ(&values[3 * i]);
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
-    spectra.push_back(psi);
+    spectra.push_back(InternItem<Spectrum>(name, std::move(s), nValues));
 }
 
 void ParamSet::AddBlackbodySpectrum(const std::string &name,
@@ -142,9 +250,7 @@ void ParamSet::AddBlackbodySpectrum(const std::string &name,
         s[i] = values[2 * i + 1] *
                Spectrum::FromSampled(CIE_lambda, v.get(), nCIESamples);
     }
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
-    spectra.push_back(psi);
+    spectra.push_back(InternItem<Spectrum>(name, std::move(s), nValues));
 }
 
 void ParamSet::AddSampledSpectrum(const std::string &name,
@@ -161,9 +267,7 @@ void ParamSet::AddSampledSpectrum(const std::string &name,
     }
     std::unique_ptr<Spectrum[]> s(new Spectrum[1]);
     s[0] = Spectrum::FromSampled(wl.get(), v.get(), nValues);
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), 1));
-    spectra.push_back(psi);
+    spectra.push_back(InternItem<Spectrum>(name, std::move(s), 1));
 }
 
 void ParamSet::AddSampledSpectrumFiles(const std::string &name,
@@ -200,9 +304,7 @@ void ParamSet::AddSampledSpectrumFiles(const std::string &name,
         cachedSpectra[fn] = s[i];
     }
 
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
-    spectra.push_back(psi);
+    spectra.push_back(InternItem<Spectrum>(name, std::move(s), nValues));
 }
 
 std::map<std::string, Spectrum> ParamSet::cachedSpectra;
@@ -216,9 +318,7 @@ void ParamSet::AddTexture(const std::string &name, const std::string &value) {
     EraseTexture(name);
     std::unique_ptr<std::string[]> str(new std::string[1]);
     str[0] = value;
-    std::shared_ptr<ParamSetItem<std::string>> psi(
-        new ParamSetItem<std::string>(name, std::move(str), 1));
-    textures.push_back(psi);
+    textures.push_back(InternItem<std::string>(name, std::move(str), 1));
 }
 
 bool ParamSet::EraseInt(const std::string &n) {
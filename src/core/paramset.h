@@ -47,6 +47,23 @@
 #include <stdio.h>
 #include <map>
 
+// Cheap FNV-1a hash of a parameter name, compared before the string
+// itself during lookups so million-directive scenes don't spend parse
+// time in byte-wise string compares
+inline uint32_t ParamNameHash(const std::string &name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= (unsigned char)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Release every interned parameter payload table (items still
+// referenced by live ParamSets survive through their shared pointers);
+// called once the scene is built to drop parse-phase storage.
+void FreeInternedParamItems();
+
 // ParamSet Declarations
 class ParamSet {
   public:
@@ -103,6 +120,14 @@ class ParamSet {
     std::string FindOneFilename(const std::string &,
                                 const std::string &d) const;
     std::string FindTexture(const std::string &) const;
+    // Names of all textures this ParamSet references, for texture
+    // graph inspection (e.g. the differentials metadata in
+    // MakeMaterial())
+    std::vector<std::string> AllTextureNames() const;
+    // Order-sensitive FNV-1a hash over every parameter's name and
+    // payload, used e.g. to key auto-instancing fingerprints on the
+    // full material specification rather than just its type name
+    uint64_t ContentHash() const;
     const Float *FindFloat(const std::string &, int *n) const;
     const int *FindInt(const std::string &, int *nValues) const;
     const bool *FindBool(const std::string &, int *nValues) const;
@@ -142,6 +167,7 @@ struct ParamSetItem {
 
     // ParamSetItem Data
     const std::string name;
+    const uint32_t nameHash;
     const std::unique_ptr<T[]> values;
     const int nValues;
     mutable bool lookedUp = false;
@@ -151,7 +177,10 @@ struct ParamSetItem {
 template <typename T>
 ParamSetItem<T>::ParamSetItem(const std::string &name, std::unique_ptr<T[]> v,
                               int nValues)
-    : name(name), values(std::move(v)), nValues(nValues) {}
+    : name(name),
+      nameHash(ParamNameHash(name)),
+      values(std::move(v)),
+      nValues(nValues) {}
 
 // TextureParams Declarations
 class TextureParams {
@@ -171,6 +200,8 @@ class TextureParams {
                                                     Float def) const;
     std::shared_ptr<Texture<Float>> GetFloatTextureOrNull(
         const std::string &name) const;
+    const ParamSet &GetShapeParamSet() const { return geomParams; }
+    const ParamSet &GetMaterialParamSet() const { return materialParams; }
     Float FindFloat(const std::string &n, Float d) const {
         return geomParams.FindOneFloat(n, materialParams.FindOneFloat(n, d));
     }
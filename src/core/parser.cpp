@@ -34,6 +34,8 @@
 // core/parser.cpp*
 #include "parser.h"
 #include "fileutil.h"
+#include "binaryscene.h"
+#include "imageio.h"
 
 // Parsing Global Interface
 bool ParseFile(const std::string &filename) {
@@ -45,6 +47,35 @@ bool ParseFile(const std::string &filename) {
 
     if (getenv("PBRT_YYDEBUG") != nullptr) yydebug = 1;
 
+    // Parallel ingestion: tokenize the master file's segments and its
+    // Include files concurrently, then replay the in-order stream
+    if (PbrtOptions.parallelParse && filename != "-" &&
+        !HasExtension(filename, "pbb")) {
+        if (BeginParallelSceneReplay(filename)) {
+            current_file = filename;
+            line_num = 1;
+            yyparse();
+            EndBinarySceneReplay();
+            current_file = "";
+            line_num = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // Replay compiled binary scenes straight into the grammar
+    if (HasExtension(filename, "pbb")) {
+        if (!BeginBinarySceneReplay(filename)) return false;
+        SetSearchDirectory(DirectoryContaining(filename));
+        current_file = filename;
+        line_num = 1;
+        yyparse();
+        EndBinarySceneReplay();
+        current_file = "";
+        line_num = 0;
+        return true;
+    }
+
     if (filename == "-")
         yyin = stdin;
     else {
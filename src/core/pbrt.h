@@ -104,8 +104,15 @@ template <int nSpectrumSamples>
 class CoefficientSpectrum;
 class RGBSpectrum;
 class SampledSpectrum;
+// The spectral representation is selected at build time with the
+// PBRT_SAMPLED_SPECTRUM definition (see the CMake option of the same
+// name); the --spectrum command-line flag validates at startup that a
+// scene is being run against the intended pipeline.
+#ifdef PBRT_SAMPLED_SPECTRUM
+typedef SampledSpectrum Spectrum;
+#else
 typedef RGBSpectrum Spectrum;
-// typedef SampledSpectrum Spectrum;
+#endif  // PBRT_SAMPLED_SPECTRUM
 class Camera;
 struct CameraSample;
 class ProjectiveCamera;
@@ -128,6 +135,7 @@ class SeparableBSSRDF;
 class TabulatedBSSRDF;
 struct BSSRDFTable;
 class Light;
+class LightTree;
 class VisibilityTester;
 class AreaLight;
 struct Distribution1D;
@@ -151,6 +159,40 @@ struct Options {
     bool quickRender = false;
     bool quiet = false, verbose = false;
     bool cat = false, toPly = false;
+    bool resume = false;
+    int checkpointSeconds = 0;
+    int previewSeconds = 0;
+    bool statsImage = false;
+    int texCacheMB = 0;
+    bool deferredShapes = false;
+    int displaceCacheMB = 256;
+    Float adaptiveThreshold = 0;
+    std::string distServe, distWorker;
+    bool aovs = false;
+    Float renderSeconds = 0;
+    bool firstHitCache = false;
+    std::string toBinaryFile;
+    bool parallelParse = false;
+    bool dryRun = false;
+    int memoryBudgetMB = 0;
+    std::string streamOutFile;
+    bool hugePages = false;
+    int profileSampleRate = 1;
+    std::string traceFile;
+    std::string benchmarkFile;
+    bool perfCounters = false;
+    bool ditherOutput = false;
+    Float lodPixels = 16;
+    bool autoInstance = false;
+    std::string progressJson;
+    int seed = 0;
+    bool daemon = false;
+    int motionBuckets = 0;
+    bool sharedMem = false;
+    bool framePipeline = false;
+    std::string statsDb;
+    std::string sceneFile;
+    std::string spectrum;
     std::string imageFile;
 };
 
@@ -259,6 +301,49 @@ inline double NextFloatDown(double v, int delta = 1) {
     return BitsToFloat(ui);
 }
 
+// Half-precision conversion helpers (used by the compact texture and
+// mesh attribute representations)
+inline uint16_t FloatToHalf(float f) {
+    uint32_t bits = FloatToBits(f);
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (exponent <= 0) {
+        // Too small for a normalized half; flush to (signed) zero
+        return (uint16_t)sign;
+    } else if (exponent >= 31) {
+        // Overflow (or inf/NaN): return infinity with NaNs preserved;
+        // a float inf/NaN exponent (0xff) rebiases to 0xff - 127 + 15
+        return (uint16_t)(sign | 0x7c00 | (mantissa && exponent == 0x8f
+                                               ? 0x200
+                                               : 0));
+    }
+    // Round the mantissa to nearest even
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    if ((mantissa & 0x1fff) > (0x1000 - ((mantissa >> 13) & 1))) ++half;
+    return (uint16_t)half;
+}
+
+inline float HalfToFloat(uint16_t h) {
+    uint32_t sign = ((uint32_t)h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    if (exponent == 0) {
+        if (mantissa == 0) return BitsToFloat(sign);
+        // Normalize the denormalized half
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        ++exponent;
+        mantissa &= ~0x400u;
+    } else if (exponent == 31) {
+        return BitsToFloat(sign | 0x7f800000 | (mantissa << 13));
+    }
+    return BitsToFloat(sign | ((exponent - 15 + 127) << 23) |
+                       (mantissa << 13));
+}
+
 inline Float gamma(int n) {
     return (n * MachineEpsilon) / (1 - n * MachineEpsilon);
 }
@@ -37,8 +37,7 @@
 #include "pbrt.h"
 #include "api.h"
 #include "fileutil.h"
-
-struct ParamArray;
+#include "paramarray.h"
 
 #if defined(PBRT_IS_MSVC)
 #include <io.h>
@@ -175,7 +174,59 @@ WorldEnd                { return WORLDEND; }
 }
 
 
-"[" { return LBRACK; }
+"[" {
+    // Bulk numeric-array fast path: if the bracket opens a numeric
+    // array, consume the entire run of numbers here with a tight
+    // character scanner, bypassing the per-token regex machinery and
+    // the per-number yacc reductions entirely.
+    int c = yyinput();
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#') {
+        // Comments are legal anywhere, including inside arrays
+        if (c == '#')
+            while (c != '\n' && c != EOF && c != 0) c = yyinput();
+        if (c == '\n') line_num++;
+        if (c == EOF || c == 0) break;
+        c = yyinput();
+    }
+    if (!(isdigit(c) || c == '-' || c == '+' || c == '.')) {
+        unput(c);
+        return LBRACK;
+    }
+    ParamArray *bulk = new ParamArray;
+    bulk->element_size = sizeof(double);
+    bulk->isString = false;
+    for (;;) {
+        // Parse one number starting at _c_
+        char buf[64];
+        int n = 0;
+        while (c != EOF && c != 0 && n + 1 < (int)sizeof(buf) &&
+               (isdigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' ||
+                c == 'E')) {
+            buf[n++] = (char)c;
+            c = yyinput();
+        }
+        buf[n] = '\0';
+        ParamArrayPushDouble(bulk, atof(buf));
+
+        // Skip separators (and comments) and stop at the closing
+        // bracket
+        while (c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+               c == '#') {
+            if (c == '#')
+                while (c != '\n' && c != EOF && c != 0) c = yyinput();
+            if (c == '\n') line_num++;
+            if (c == EOF || c == 0) break;
+            c = yyinput();
+        }
+        if (c == ']' || c == EOF || c == 0) break;
+        if (!(isdigit(c) || c == '-' || c == '+' || c == '.')) {
+            Error("Unexpected character '%c' in numeric array", c);
+            break;
+        }
+    }
+    yylval.ribarray = bulk;
+    return NUM_ARRAY;
+}
 "]" { return RBRACK; }
 \" { BEGIN STR; str_pos = 0; yylval.string[0] = '\0'; }
 <STR>\\n {add_string_char('\n');}
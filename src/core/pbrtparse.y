@@ -43,6 +43,16 @@
 #endif // PBRT_IS_MSVC
 
 extern int yylex();
+
+// Dispatch to the binary-scene token stream when one is being
+// replayed (see core/binaryscene.h); the macro below routes the
+// parser's yylex calls through this shim.
+extern bool pbrtUsingBinaryScene;
+extern int BinarySceneYylex();
+static int pbrtYylexDispatch() {
+    return pbrtUsingBinaryScene ? BinarySceneYylex() : yylex();
+}
+#define yylex pbrtYylexDispatch
 extern void include_push(char *filename);
 int line_num = 0;
 std::string current_file;
@@ -56,18 +66,7 @@ void yyerror(const char *str) {
 
 
 
-struct ParamArray {
-    ParamArray() {
-        isString = false;
-        element_size = allocated = nelems = 0;
-        array = nullptr;
-    }
-    bool isString;
-    int element_size;
-    int allocated;
-    int nelems;
-    void *array;
-};
+#include "paramarray.h"
 
 
 
@@ -166,6 +165,7 @@ ParamArray *ribarray;
 %token <string> STRING ID
 %token <num> NUM
 %token LBRACK RBRACK
+%token <ribarray> NUM_ARRAY
 
 %token ACCELERATOR ACTIVETRANSFORM ALL AREALIGHTSOURCE ATTRIBUTEBEGIN
 %token ATTRIBUTEEND CAMERA CONCATTRANSFORM COORDINATESYSTEM COORDSYSTRANSFORM
@@ -270,6 +270,13 @@ num_array: array_init LBRACK num_list RBRACK
 }
 
 
+| NUM_ARRAY
+{
+    // Bulk-scanned numeric array produced by the lexer fast path
+    $$ = $1;
+}
+
+
 | single_element_num_array
 {
     $$ = cur_array;
@@ -33,6 +33,7 @@
 
 // core/primitive.cpp*
 #include "primitive.h"
+#include "texture.h"
 #include "light.h"
 #include "interaction.h"
 #include "stats.h"
@@ -63,13 +64,126 @@ void Aggregate::ComputeScatteringFunctions(SurfaceInteraction *isect,
 }
 
 // TransformedPrimitive Method Definitions
+void TransformedPrimitive::ComputeSegmentBounds() {
+    segmentTransforms.clear();
+    segmentBounds.clear();
+    bucketTransforms.clear();
+    bucketInverses.clear();
+    if (!PrimitiveToWorld.IsAnimated()) return;
+    // Precompute the shutter-time strata transforms (--motionbuckets)
+    if (PbrtOptions.motionBuckets > 0) {
+        int nBuckets = PbrtOptions.motionBuckets;
+        bucketTransforms.resize(nBuckets);
+        bucketInverses.resize(nBuckets);
+        for (int i = 0; i < nBuckets; ++i) {
+            Float time =
+                Lerp((i + 0.5f) / nBuckets, PrimitiveToWorld.StartTime(),
+                     PrimitiveToWorld.EndTime());
+            PrimitiveToWorld.Interpolate(time, &bucketTransforms[i]);
+            bucketInverses[i] = Inverse(bucketTransforms[i]);
+        }
+    }
+    Bounds3f b = primitive->WorldBound();
+    Float time0 = PrimitiveToWorld.StartTime();
+    Float time1 = PrimitiveToWorld.EndTime();
+    segmentTransforms.resize(nTimeSegments + 1);
+    for (int i = 0; i <= nTimeSegments; ++i)
+        PrimitiveToWorld.Interpolate(
+            Lerp((Float)i / nTimeSegments, time0, time1),
+            &segmentTransforms[i]);
+    segmentBounds.resize(nTimeSegments);
+    for (int i = 0; i < nTimeSegments; ++i) {
+        // The decomposed interpolation between two transforms sampled
+        // on the original path retraces that path segment (slerp is
+        // geodesic), so each segment's MotionBounds is a valid
+        // conservative bound for its part of the shutter
+        AnimatedTransform segment(
+            &segmentTransforms[i], Lerp((Float)i / nTimeSegments, time0, time1),
+            &segmentTransforms[i + 1],
+            Lerp((Float)(i + 1) / nTimeSegments, time0, time1));
+        segmentBounds[i] = segment.MotionBounds(b);
+    }
+}
+
+// Reject _r_ against the segment bound covering its time; returns true
+// when the ray can't hit the primitive anywhere in that time segment
+bool TransformedPrimitive::RejectBySegmentBounds(const Ray &r) const {
+    if (segmentBounds.empty()) return false;
+    Float time0 = PrimitiveToWorld.StartTime();
+    Float time1 = PrimitiveToWorld.EndTime();
+    int segment =
+        Clamp((int)((r.time - time0) / (time1 - time0) * nTimeSegments), 0,
+              nTimeSegments - 1);
+    Float hit0, hit1;
+    return !segmentBounds[segment].IntersectP(r, &hit0, &hit1);
+}
+
+// Choose between the full geometry and the registered LOD proxy from
+// the ray's angular footprint: when the instance's projected diameter
+// falls below PbrtOptions.lodPixels pixels, the proxy's traversal cost
+// is all a wide shot ever needed
+const Primitive *TransformedPrimitive::SelectLOD(const Ray &r) const {
+    if (!lodProxy || r.footprintSpread <= 0) return primitive.get();
+    Bounds3f bound = WorldBound();
+    Float diameter = Distance(bound.pMin, bound.pMax);
+    Float dist = Distance(r.o, (bound.pMin + bound.pMax) * 0.5f);
+    Float footprint = r.footprintSpread * dist;
+    if (footprint > 0 && diameter / footprint < PbrtOptions.lodPixels)
+        return lodProxy.get();
+    return primitive.get();
+}
+
+// Per-thread exact-match memo for the interpolated transform pair: a
+// path's primary and shadow rays share one time, so repeated tests of
+// the same instance skip the slerp pipeline without quantizing motion
+struct MotionTransformCacheEntry {
+    const void *primitive = nullptr;
+    Float time = 0;
+    Transform primToWorld, worldToPrim;
+};
+static PBRT_THREAD_LOCAL MotionTransformCacheEntry *motionTransformCache;
+
+// Return this ray's primitive-to-world / world-to-primitive pair from
+// the bucket table, the per-thread memo, or a fresh interpolation
+void TransformedPrimitive::GetInterpolatedTransforms(
+    const Ray &r, const Transform **primToWorld,
+    const Transform **worldToPrim) const {
+    if (!bucketTransforms.empty()) {
+        Float time0 = PrimitiveToWorld.StartTime();
+        Float time1 = PrimitiveToWorld.EndTime();
+        int bucket = Clamp((int)((r.time - time0) / (time1 - time0) *
+                                 bucketTransforms.size()),
+                           0, (int)bucketTransforms.size() - 1);
+        *primToWorld = &bucketTransforms[bucket];
+        *worldToPrim = &bucketInverses[bucket];
+        return;
+    }
+    if (!motionTransformCache)
+        motionTransformCache = new MotionTransformCacheEntry;
+    MotionTransformCacheEntry &entry = *motionTransformCache;
+    if (entry.primitive != this || entry.time != r.time) {
+        PrimitiveToWorld.Interpolate(r.time, &entry.primToWorld);
+        entry.worldToPrim = Inverse(entry.primToWorld);
+        entry.primitive = this;
+        entry.time = r.time;
+    }
+    *primToWorld = &entry.primToWorld;
+    *worldToPrim = &entry.worldToPrim;
+}
+
 bool TransformedPrimitive::Intersect(const Ray &r,
                                      SurfaceInteraction *isect) const {
-    // Compute _ray_ after transformation by _PrimitiveToWorld_
-    Transform InterpolatedPrimToWorld;
-    PrimitiveToWorld.Interpolate(r.time, &InterpolatedPrimToWorld);
-    Ray ray = Inverse(InterpolatedPrimToWorld)(r);
-    if (!primitive->Intersect(ray, isect)) return false;
+    if (RejectBySegmentBounds(r)) return false;
+    // Compute _ray_ after transformation by _PrimitiveToWorld_.  The
+    // primitive-to-world transform is copied by value: an animated
+    // shape inside an instanced object nests a TransformedPrimitive
+    // under this one, and its Intersect() re-enters the per-thread
+    // memo, overwriting the entry this call received.
+    const Transform *primToWorld, *worldToPrim;
+    GetInterpolatedTransforms(r, &primToWorld, &worldToPrim);
+    const Transform InterpolatedPrimToWorld = *primToWorld;
+    Ray ray = (*worldToPrim)(r);
+    if (!SelectLOD(r)->Intersect(ray, isect)) return false;
     r.tMax = ray.tMax;
     // Transform instance's intersection data to world space
     if (!InterpolatedPrimToWorld.IsIdentity())
@@ -79,23 +193,73 @@ bool TransformedPrimitive::Intersect(const Ray &r,
 }
 
 bool TransformedPrimitive::IntersectP(const Ray &r) const {
-    Transform InterpolatedPrimToWorld;
-    PrimitiveToWorld.Interpolate(r.time, &InterpolatedPrimToWorld);
-    Transform InterpolatedWorldToPrim = Inverse(InterpolatedPrimToWorld);
-    return primitive->IntersectP(InterpolatedWorldToPrim(r));
+    if (RejectBySegmentBounds(r)) return false;
+    const Transform *primToWorld, *worldToPrim;
+    GetInterpolatedTransforms(r, &primToWorld, &worldToPrim);
+    return SelectLOD(r)->IntersectP((*worldToPrim)(r));
 }
 
 // GeometricPrimitive Method Definitions
 Bounds3f GeometricPrimitive::WorldBound() const { return shape->WorldBound(); }
 
+// Per-thread generator for stochastic alpha cutouts; acceptance draws
+// only need decorrelated numbers, not a sampler dimension
+static PBRT_THREAD_LOCAL uint64_t alphaCutoutState;
+
+static Float NextAlphaCutoutSample() {
+    alphaCutoutState =
+        alphaCutoutState * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t bits = alphaCutoutState;
+    bits ^= bits >> 31;
+    return (Float)(bits >> 40) * (Float)(1.f / (1 << 24));
+}
+
 bool GeometricPrimitive::IntersectP(const Ray &r) const {
-    return shape->IntersectP(r);
+    if (!alphaTexture) return shape->IntersectP(r);
+    // Cutout shapes need the hit's uv to evaluate alpha, so trace
+    // through rejected hits with the full intersection routine
+    Ray ray = r;
+    SurfaceInteraction isect;
+    Float tHit;
+    for (int pass = 0; pass < 64; ++pass) {
+        if (!shape->Intersect(ray, &tHit, &isect)) return false;
+        Float alpha = Clamp(alphaTexture->Evaluate(isect), 0, 1);
+        if (alpha >= 1 || (alpha > 0 && NextAlphaCutoutSample() < alpha))
+            return true;
+        Ray next = isect.SpawnRay(ray.d);
+        next.tMax = ray.tMax - tHit;
+        ray = next;
+    }
+    return true;
 }
 
 bool GeometricPrimitive::Intersect(const Ray &r,
                                    SurfaceInteraction *isect) const {
     Float tHit;
-    if (!shape->Intersect(r, &tHit, isect)) return false;
+    if (alphaTexture) {
+        // Evaluate the cutout during traversal: accept the hit with
+        // probability alpha and otherwise continue the ray through,
+        // so transparent texels never reach material shading
+        Ray ray = r;
+        Float tAccum = 0;
+        bool accepted = false;
+        for (int pass = 0; pass < 64 && !accepted; ++pass) {
+            if (!shape->Intersect(ray, &tHit, isect)) return false;
+            Float alpha = Clamp(alphaTexture->Evaluate(*isect), 0, 1);
+            if (alpha >= 1 ||
+                (alpha > 0 && NextAlphaCutoutSample() < alpha)) {
+                accepted = true;
+                break;
+            }
+            tAccum += tHit;
+            Ray next = isect->SpawnRay(ray.d);
+            next.tMax = ray.tMax - tHit;
+            ray = next;
+        }
+        if (!accepted) return false;
+        tHit += tAccum;
+    } else if (!shape->Intersect(r, &tHit, isect))
+        return false;
     r.tMax = tHit;
     isect->primitive = this;
     Assert(Dot(isect->n, isect->shading.n) >= 0.);
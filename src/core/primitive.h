@@ -70,11 +70,14 @@ class GeometricPrimitive : public Primitive {
     GeometricPrimitive(const std::shared_ptr<Shape> &shape,
                        const std::shared_ptr<Material> &material,
                        const std::shared_ptr<AreaLight> &areaLight,
-                       const MediumInterface &mediumInterface)
+                       const MediumInterface &mediumInterface,
+                       const std::shared_ptr<Texture<Float>> &alphaTexture =
+                           nullptr)
         : shape(shape),
           material(material),
           areaLight(areaLight),
-          mediumInterface(mediumInterface) {}
+          mediumInterface(mediumInterface),
+          alphaTexture(alphaTexture) {}
     const AreaLight *GetAreaLight() const;
     const Material *GetMaterial() const;
     void ComputeScatteringFunctions(SurfaceInteraction *isect,
@@ -87,6 +90,11 @@ class GeometricPrimitive : public Primitive {
     std::shared_ptr<Material> material;
     std::shared_ptr<AreaLight> areaLight;
     MediumInterface mediumInterface;
+    // Cutout alpha ("texture alpha"/"float alpha" on the shape):
+    // evaluated during traversal with stochastic acceptance, so a
+    // transparent texel costs one texture fetch instead of a full
+    // BSDF bounce through a transmission lobe
+    std::shared_ptr<Texture<Float>> alphaTexture;
 };
 
 // TransformedPrimitive Declarations
@@ -95,7 +103,9 @@ class TransformedPrimitive : public Primitive {
     // TransformedPrimitive Public Methods
     TransformedPrimitive(std::shared_ptr<Primitive> &primitive,
                          const AnimatedTransform &PrimitiveToWorld)
-        : primitive(primitive), PrimitiveToWorld(PrimitiveToWorld) {}
+        : primitive(primitive), PrimitiveToWorld(PrimitiveToWorld) {
+        ComputeSegmentBounds();
+    }
     bool Intersect(const Ray &r, SurfaceInteraction *in) const;
     bool IntersectP(const Ray &r) const;
     const AreaLight *GetAreaLight() const { return nullptr; }
@@ -110,11 +120,55 @@ class TransformedPrimitive : public Primitive {
     Bounds3f WorldBound() const {
         return PrimitiveToWorld.MotionBounds(primitive->WorldBound());
     }
+    // Update the primitive-to-world transform (e.g. between frames of an
+    // animation); the caller is responsible for refitting or rebuilding
+    // any acceleration structures that hold this primitive.
+    void SetTransform(const AnimatedTransform &p2w) {
+        PrimitiveToWorld = p2w;
+        ComputeSegmentBounds();
+    }
+    // Register a simplified stand-in: rays whose footprint projects
+    // this instance below PbrtOptions.lodPixels pixels traverse the
+    // proxy's (much smaller) BVH instead of the full geometry
+    void SetLODProxy(const std::shared_ptr<Primitive> &proxy) {
+        lodProxy = proxy;
+    }
+    // Replace the instanced geometry after an interactive object edit;
+    // the time-segment bounds are recomputed against the new geometry
+    void SetPrimitive(const std::shared_ptr<Primitive> &prim) {
+        primitive = prim;
+        ComputeSegmentBounds();
+    }
 
   private:
+    // TransformedPrimitive Private Methods
+    void ComputeSegmentBounds();
+    bool RejectBySegmentBounds(const Ray &r) const;
+    const Primitive *SelectLOD(const Ray &r) const;
+    void GetInterpolatedTransforms(const Ray &r,
+                                   const Transform **primToWorld,
+                                   const Transform **worldToPrim) const;
+
     // TransformedPrimitive Private Data
     std::shared_ptr<Primitive> primitive;
-    const AnimatedTransform PrimitiveToWorld;
+    AnimatedTransform PrimitiveToWorld;
+    // Time-segmented world bounds for animated instances: each shutter
+    // segment's motion bound is far tighter than the whole-shutter
+    // union that WorldBound() reports to the BVH, so Intersect() can
+    // reject a ray against the bound for its time before interpolating
+    // and inverting the transform.  Empty for static transforms.
+    static PBRT_CONSTEXPR int nTimeSegments = 8;
+    std::vector<Transform> segmentTransforms;
+    std::vector<Bounds3f> segmentBounds;
+    // Bucketed interpolation cache (--motionbuckets N): transform and
+    // inverse pairs precomputed at N shutter-time strata centers;
+    // rays pick their bucket, so motion-blurred traversal is a matrix
+    // fetch instead of a decompose-slerp-recompose plus inverse per
+    // ray, at the cost of quantizing motion to N times.  Empty when
+    // disabled, in which case a per-thread exact (primitive, time)
+    // memo still short-circuits repeated interpolations along a path.
+    std::vector<Transform> bucketTransforms, bucketInverses;
+    std::shared_ptr<Primitive> lodProxy;
 };
 
 // Aggregate Declarations
@@ -126,6 +180,35 @@ class Aggregate : public Primitive {
     void ComputeScatteringFunctions(SurfaceInteraction *isect,
                                     MemoryArena &arena, TransportMode mode,
                                     bool allowMultipleLobes) const;
+    // Intersect a batch of rays, recording each ray's hit status in
+    // _hits_ and its intersection in the corresponding entry of
+    // _isects_.  Aggregates may reorder the traversal internally to
+    // exploit coherence between the rays, but results are stored at each
+    // ray's original index.  The default forwards to one-at-a-time
+    // Intersect().
+    virtual void IntersectStream(Ray *rays, SurfaceInteraction *isects,
+                                 bool *hits, int nRays) const {
+        for (int i = 0; i < nRays; ++i)
+            hits[i] = Intersect(rays[i], &isects[i]);
+    }
+    // Beam traversal for camera tiles: collect the subtree roots that
+    // a tile frustum (apex _origin_, four corner directions in winding
+    // order) can reach, so each of the tile's rays starts traversal
+    // from those instead of the root.  Returns false when the
+    // aggregate doesn't support beams.
+    virtual bool ComputeBeamEntry(const Point3f &origin,
+                                  const Vector3f cornerDirections[4],
+                                  std::vector<int> *entryNodes) const {
+        return false;
+    }
+    virtual bool IntersectFromEntry(const Ray &ray, SurfaceInteraction *isect,
+                                    const std::vector<int> &entryNodes) const {
+        return Intersect(ray, isect);
+    }
+    // Batched equivalent of IntersectP() for occlusion rays.
+    virtual void IntersectPStream(Ray *rays, bool *hits, int nRays) const {
+        for (int i = 0; i < nRays; ++i) hits[i] = IntersectP(rays[i]);
+    }
 };
 
 #endif  // PBRT_CORE_PRIMITIVE_H
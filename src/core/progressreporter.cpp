@@ -34,7 +34,9 @@
 // core/progressreporter.cpp*
 #include "progressreporter.h"
 #include <chrono>
+#include <vector>
 #include "parallel.h"
+#include "stats.h"
 #ifdef PBRT_IS_WINDOWS
 #include <windows.h>
 #else
@@ -50,17 +52,24 @@ ProgressReporter::ProgressReporter(int64_t totalWork, const std::string &title)
       startTime(std::chrono::system_clock::now()) {
     workDone = 0;
     exitThread = false;
-    // Launch thread to periodically update progress bar
-    if (!PbrtOptions.quiet)
+    // Launch thread to periodically report progress: structured JSON
+    // lines when --progressjson was given (farm-log safe, no terminal
+    // codes), the interactive bar otherwise
+    if (PbrtOptions.progressJson != "") {
+        hasUpdateThread = true;
+        updateThread = std::thread([this]() { EmitJSONLines(); });
+    } else if (!PbrtOptions.quiet) {
+        hasUpdateThread = true;
         updateThread = std::thread([this]() { PrintBar(); });
+    }
 }
 
 ProgressReporter::~ProgressReporter() {
-    if (!PbrtOptions.quiet) {
+    if (hasUpdateThread) {
         workDone = totalWork;
         exitThread = true;
         updateThread.join();
-        printf("\n");
+        if (PbrtOptions.progressJson == "") printf("\n");
     }
 }
 
@@ -119,6 +128,65 @@ void ProgressReporter::PrintBar() {
     }
 }
 
+// Structured progress channel (--progressjson <file|->): one JSON
+// object per line with work counts, elapsed time, live ray
+// throughput, the top profiler phases, and a trailing-window ETA.
+// The ETA uses the completion rate over the last ~30 seconds of
+// finished work instead of whole-run linear extrapolation, which
+// cost-skewed adaptive tiles make wildly wrong.
+void ProgressReporter::EmitJSONLines() {
+    FILE *f = PbrtOptions.progressJson == "-"
+                  ? stdout
+                  : fopen(PbrtOptions.progressJson.c_str(), "a");
+    if (!f) {
+        Warning("Unable to open progress file \"%s\"",
+                PbrtOptions.progressJson.c_str());
+        return;
+    }
+    std::vector<std::pair<Float, int64_t>> history;
+    uint64_t lastRays = GlobalRayCounter();
+    Float lastSeconds = 0;
+    auto emit = [&](bool final) {
+        Float seconds = ElapsedMS() / 1000.f;
+        int64_t done = final ? totalWork : workDone.load();
+        history.push_back(std::make_pair(seconds, done));
+        // Rate over the trailing window
+        size_t w = 0;
+        while (w + 1 < history.size() &&
+               history[w].first < seconds - 30)
+            ++w;
+        Float dt = seconds - history[w].first;
+        int64_t dw = done - history[w].second;
+        double etaSeconds;
+        if (dw > 0 && dt > 0)
+            etaSeconds = (double)(totalWork - done) * dt / dw;
+        else if (done > 0 && seconds > 0)
+            etaSeconds = (double)(totalWork - done) * seconds / done;
+        else
+            etaSeconds = -1;
+        uint64_t rays = GlobalRayCounter();
+        double raysPerSec = seconds > lastSeconds
+                                ? (rays - lastRays) / (seconds - lastSeconds)
+                                : 0;
+        lastRays = rays;
+        lastSeconds = seconds;
+        fprintf(f,
+                "{\"title\": \"%s\", \"done\": %lld, \"total\": "
+                "%lld, \"elapsed_s\": %.1f, \"eta_s\": %.1f, "
+                "\"rays_per_s\": %.0f, \"phases\": %s}\n",
+                title.c_str(), (long long)done, (long long)totalWork,
+                seconds, etaSeconds, raysPerSec,
+                ProfilerPhaseBreakdownJSON().c_str());
+        fflush(f);
+    };
+    while (!exitThread) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+        if (!exitThread) emit(false);
+    }
+    emit(true);
+    if (f != stdout) fclose(f);
+}
+
 void ProgressReporter::Done() {
     workDone = totalWork;
 }
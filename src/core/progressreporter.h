@@ -50,7 +50,9 @@ class ProgressReporter {
     ProgressReporter(int64_t totalWork, const std::string &title);
     ~ProgressReporter();
     void Update(int64_t num = 1) {
-        if (num == 0 || PbrtOptions.quiet) return;
+        if (num == 0 ||
+            (PbrtOptions.quiet && PbrtOptions.progressJson == ""))
+            return;
         workDone += num;
     }
     Float ElapsedMS() const {
@@ -67,6 +69,7 @@ class ProgressReporter {
   private:
     // ProgressReporter Private Methods
     void PrintBar();
+    void EmitJSONLines();
 
     // ProgressReporter Private Data
     const int64_t totalWork;
@@ -74,6 +77,7 @@ class ProgressReporter {
     const std::chrono::system_clock::time_point startTime;
     std::atomic<int64_t> workDone;
     std::atomic<bool> exitThread;
+    bool hasUpdateThread = false;
     std::thread updateThread;
 };
 
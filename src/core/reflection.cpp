@@ -352,12 +352,25 @@ Spectrum MicrofacetReflection::Sample_f(const Vector3f &wo, Vector3f *wi,
     if (wo.z == 0)
         return 0.;
     Vector3f wh = distribution->Sample_wh(wo, u);
+    if (Dot(wo, wh) <= 0) return Spectrum(0.f);
     *wi = Reflect(wo, wh);
     if (!SameHemisphere(wo, *wi)) return Spectrum(0.f);
+    Float cosThetaO = AbsCosTheta(wo), cosThetaI = AbsCosTheta(*wi);
+    if (cosThetaI == 0 || cosThetaO == 0) return Spectrum(0.);
 
-    // Compute PDF of _wi_ for microfacet reflection
-    *pdf = distribution->Pdf(wo, wh) / (4 * Dot(wo, wh));
-    return f(wo, *wi);
+    // Fused PDF and BRDF evaluation: D(wh) and the Lambda shadowing
+    // terms are shared between the two instead of being recomputed by
+    // separate Pdf() and f() calls
+    Float D = distribution->D(wh);
+    Float lambdaO = distribution->Lambda(wo);
+    Float lambdaI = distribution->Lambda(*wi);
+    if (distribution->SamplesVisibleArea())
+        *pdf = D / ((1 + lambdaO) * 4 * cosThetaO);
+    else
+        *pdf = D * AbsCosTheta(wh) / (4 * Dot(wo, wh));
+    Spectrum F = fresnel->Evaluate(Dot(*wi, wh));
+    return R * D * F /
+           ((1 + lambdaO + lambdaI) * (4 * cosThetaI * cosThetaO));
 }
 
 Float MicrofacetReflection::Pdf(const Vector3f &wo, const Vector3f &wi) const {
@@ -684,6 +697,29 @@ Spectrum BSDF::Sample_f(const Vector3f &woWorld, Vector3f *wiWorld,
     return f;
 }
 
+void BSDF::f_batch(const Vector3f &woW, const Vector3f *wiW, int n,
+                   BxDFType flags, Spectrum *f, Float *pdf) const {
+    ProfilePhase pp(Prof::BSDFEvaluation);
+    Vector3f wo = WorldToLocal(woW);
+    Float cosWoNg = Dot(woW, ng);
+    int matchingComps = pdf ? NumComponents(flags) : 0;
+    for (int s = 0; s < n; ++s) {
+        f[s] = Spectrum(0.f);
+        if (pdf) pdf[s] = 0;
+        if (wo.z == 0) continue;
+        Vector3f wi = WorldToLocal(wiW[s]);
+        bool reflect = Dot(wiW[s], ng) * cosWoNg > 0;
+        for (int i = 0; i < nBxDFs; ++i) {
+            if (!bxdfs[i]->MatchesFlags(flags)) continue;
+            if ((reflect && (bxdfs[i]->type & BSDF_REFLECTION)) ||
+                (!reflect && (bxdfs[i]->type & BSDF_TRANSMISSION)))
+                f[s] += bxdfs[i]->f(wo, wi);
+            if (pdf) pdf[s] += bxdfs[i]->Pdf(wo, wi);
+        }
+        if (pdf && matchingComps > 1) pdf[s] /= matchingComps;
+    }
+}
+
 Float BSDF::Pdf(const Vector3f &woWorld, const Vector3f &wiWorld,
                 BxDFType flags) const {
     if (nBxDFs == 0.f) return 0.f;
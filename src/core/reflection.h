@@ -42,8 +42,10 @@
 #include "pbrt.h"
 #include "geometry.h"
 #include "microfacet.h"
+#include "rng.h"
 #include "shape.h"
 #include "spectrum.h"
+#include "stats.h"
 
 // Reflection Declarations
 Float FrDielectric(Float cosThetaI, Float etaI, Float etaT);
@@ -170,26 +172,35 @@ class BSDF {
                         ss.y * v.x + ts.y * v.y + ns.y * v.z,
                         ss.z * v.x + ts.z * v.y + ns.z * v.z);
     }
-    Spectrum f(const Vector3f &woW, const Vector3f &wiW,
-               BxDFType flags = BSDF_ALL) const;
+    virtual Spectrum f(const Vector3f &woW, const Vector3f &wiW,
+                       BxDFType flags = BSDF_ALL) const;
     Spectrum rho(int nSamples, const Point2f *samples1, const Point2f *samples2,
                  BxDFType flags = BSDF_ALL) const;
     Spectrum rho(const Vector3f &wo, int nSamples, const Point2f *samples,
                  BxDFType flags = BSDF_ALL) const;
-    Spectrum Sample_f(const Vector3f &wo, Vector3f *wi, const Point2f &u,
-                      Float *pdf, BxDFType type = BSDF_ALL,
-                      BxDFType *sampledType = nullptr) const;
-    Float Pdf(const Vector3f &wo, const Vector3f &wi,
-              BxDFType flags = BSDF_ALL) const;
+    virtual Spectrum Sample_f(const Vector3f &wo, Vector3f *wi,
+                              const Point2f &u, Float *pdf,
+                              BxDFType type = BSDF_ALL,
+                              BxDFType *sampledType = nullptr) const;
+    virtual Float Pdf(const Vector3f &wo, const Vector3f &wi,
+                      BxDFType flags = BSDF_ALL) const;
+    // Evaluate the BSDF (and, when _pdf_ is non-null, its PDF) for _n_
+    // incident directions sharing one outgoing direction; _wo_ is
+    // transformed once and the lobes dispatched once per batch rather
+    // than once per sample.
+    virtual void f_batch(const Vector3f &woW, const Vector3f *wiW, int n,
+                         BxDFType flags, Spectrum *f,
+                         Float *pdf = nullptr) const;
 
     // BSDF Public Data
     const Float eta;
 
-  private:
-    // BSDF Private Methods
+  protected:
+    // BSDF Protected Methods
+    // BSDFs are allocated from a MemoryArena and never deleted
     ~BSDF() {}
 
-    // BSDF Private Data
+    // BSDF Protected Data
     const Normal3f ns, ng;
     const Vector3f ss, ts;
     int nBxDFs = 0;
@@ -219,6 +230,177 @@ class BxDF {
     const BxDFType type;
 };
 
+
+// Compile-time BSDF composition: these subclasses hold their lobes by
+// value with the concrete type known statically, so f(), Sample_f(),
+// and Pdf() call the lobes directly and the compiler can devirtualize
+// and inline them instead of looping over the BxDF pointer array.
+// ComputeScatteringFunctions selects them for the common material
+// archetypes (one diffuse lobe for matte, diffuse+glossy for
+// plastic); materials with dynamic lobe sets keep the generic BSDF.
+// The lobes are still registered via Add() so that NumComponents(),
+// rho(), and MixMaterial's lobe rewrapping keep working.
+template <typename BxDF1>
+class SingleBxDFBSDF : public BSDF {
+  public:
+    SingleBxDFBSDF(const SurfaceInteraction &si, const BxDF1 &b, Float eta = 1)
+        : BSDF(si, eta), bxdf(b) {
+        Add(&bxdf);
+    }
+    Spectrum f(const Vector3f &woW, const Vector3f &wiW,
+               BxDFType flags = BSDF_ALL) const {
+        ProfilePhase pp(Prof::BSDFEvaluation);
+        Vector3f wi = WorldToLocal(wiW), wo = WorldToLocal(woW);
+        if (wo.z == 0) return 0.;
+        bool reflect = Dot(wiW, ng) * Dot(woW, ng) > 0;
+        if (!bxdf.MatchesFlags(flags) ||
+            (reflect && !(bxdf.type & BSDF_REFLECTION)) ||
+            (!reflect && !(bxdf.type & BSDF_TRANSMISSION)))
+            return Spectrum(0.f);
+        return bxdf.f(wo, wi);
+    }
+    Spectrum Sample_f(const Vector3f &woWorld, Vector3f *wiWorld,
+                      const Point2f &u, Float *pdf, BxDFType type = BSDF_ALL,
+                      BxDFType *sampledType = nullptr) const {
+        ProfilePhase pp(Prof::BSDFEvaluation);
+        if (!bxdf.MatchesFlags(type)) {
+            *pdf = 0;
+            if (sampledType) *sampledType = BxDFType(0);
+            return Spectrum(0);
+        }
+        Vector3f wi, wo = WorldToLocal(woWorld);
+        if (wo.z == 0) return 0.;
+        *pdf = 0;
+        if (sampledType) *sampledType = bxdf.type;
+        Spectrum f = bxdf.Sample_f(wo, &wi, u, pdf, sampledType);
+        if (*pdf == 0) {
+            if (sampledType) *sampledType = BxDFType(0);
+            return 0;
+        }
+        *wiWorld = LocalToWorld(wi);
+        return f;
+    }
+    Float Pdf(const Vector3f &woWorld, const Vector3f &wiWorld,
+              BxDFType flags = BSDF_ALL) const {
+        if (!bxdf.MatchesFlags(flags)) return 0;
+        Vector3f wo = WorldToLocal(woWorld), wi = WorldToLocal(wiWorld);
+        if (wo.z == 0) return 0.;
+        return bxdf.Pdf(wo, wi);
+    }
+    void f_batch(const Vector3f &woW, const Vector3f *wiW, int n,
+                 BxDFType flags, Spectrum *f, Float *pdf = nullptr) const {
+        ProfilePhase pp(Prof::BSDFEvaluation);
+        Vector3f wo = WorldToLocal(woW);
+        bool matches = bxdf.MatchesFlags(flags);
+        Float cosWoNg = Dot(woW, ng);
+        for (int s = 0; s < n; ++s) {
+            f[s] = Spectrum(0.f);
+            if (pdf) pdf[s] = 0;
+            if (wo.z == 0 || !matches) continue;
+            Vector3f wi = WorldToLocal(wiW[s]);
+            bool reflect = Dot(wiW[s], ng) * cosWoNg > 0;
+            if ((reflect && (bxdf.type & BSDF_REFLECTION)) ||
+                (!reflect && (bxdf.type & BSDF_TRANSMISSION)))
+                f[s] = bxdf.f(wo, wi);
+            if (pdf) pdf[s] = bxdf.Pdf(wo, wi);
+        }
+    }
+
+  private:
+    BxDF1 bxdf;
+};
+
+template <typename BxDF1, typename BxDF2>
+class TwoBxDFBSDF : public BSDF {
+  public:
+    TwoBxDFBSDF(const SurfaceInteraction &si, const BxDF1 &b1, const BxDF2 &b2,
+                Float eta = 1)
+        : BSDF(si, eta), bxdf1(b1), bxdf2(b2) {
+        Add(&bxdf1);
+        Add(&bxdf2);
+    }
+    Spectrum f(const Vector3f &woW, const Vector3f &wiW,
+               BxDFType flags = BSDF_ALL) const {
+        ProfilePhase pp(Prof::BSDFEvaluation);
+        Vector3f wi = WorldToLocal(wiW), wo = WorldToLocal(woW);
+        if (wo.z == 0) return 0.;
+        bool reflect = Dot(wiW, ng) * Dot(woW, ng) > 0;
+        Spectrum f(0.f);
+        if (bxdf1.MatchesFlags(flags) &&
+            ((reflect && (bxdf1.type & BSDF_REFLECTION)) ||
+             (!reflect && (bxdf1.type & BSDF_TRANSMISSION))))
+            f += bxdf1.f(wo, wi);
+        if (bxdf2.MatchesFlags(flags) &&
+            ((reflect && (bxdf2.type & BSDF_REFLECTION)) ||
+             (!reflect && (bxdf2.type & BSDF_TRANSMISSION))))
+            f += bxdf2.f(wo, wi);
+        return f;
+    }
+    Spectrum Sample_f(const Vector3f &woWorld, Vector3f *wiWorld,
+                      const Point2f &u, Float *pdf, BxDFType type = BSDF_ALL,
+                      BxDFType *sampledType = nullptr) const {
+        ProfilePhase pp(Prof::BSDFEvaluation);
+        // Choose which lobe to sample
+        bool matches1 = bxdf1.MatchesFlags(type),
+             matches2 = bxdf2.MatchesFlags(type);
+        int matchingComps = (int)matches1 + (int)matches2;
+        if (matchingComps == 0) {
+            *pdf = 0;
+            if (sampledType) *sampledType = BxDFType(0);
+            return Spectrum(0);
+        }
+        int comp =
+            std::min((int)std::floor(u[0] * matchingComps), matchingComps - 1);
+        bool sampleFirst = matches1 && comp == 0;
+
+        // Remap sample _u_ to $[0,1)^2$ and sample the chosen lobe
+        Point2f uRemapped(std::min(u[0] * matchingComps - comp,
+                                   OneMinusEpsilon),
+                          u[1]);
+        Vector3f wi, wo = WorldToLocal(woWorld);
+        if (wo.z == 0) return 0.;
+        *pdf = 0;
+        BxDFType sampledBxDFType = sampleFirst ? bxdf1.type : bxdf2.type;
+        if (sampledType) *sampledType = sampledBxDFType;
+        Spectrum f = sampleFirst
+                         ? bxdf1.Sample_f(wo, &wi, uRemapped, pdf, sampledType)
+                         : bxdf2.Sample_f(wo, &wi, uRemapped, pdf, sampledType);
+        if (*pdf == 0) {
+            if (sampledType) *sampledType = BxDFType(0);
+            return 0;
+        }
+        *wiWorld = LocalToWorld(wi);
+
+        // Compute overall PDF and BSDF value with both matching lobes
+        if (!(sampledBxDFType & BSDF_SPECULAR) && matchingComps > 1)
+            *pdf += sampleFirst ? bxdf2.Pdf(wo, wi) : bxdf1.Pdf(wo, wi);
+        if (matchingComps > 1) *pdf /= matchingComps;
+        if (!(sampledBxDFType & BSDF_SPECULAR) && matchingComps > 1)
+            f = TwoBxDFBSDF::f(woWorld, *wiWorld, type);
+        return f;
+    }
+    Float Pdf(const Vector3f &woWorld, const Vector3f &wiWorld,
+              BxDFType flags = BSDF_ALL) const {
+        Vector3f wo = WorldToLocal(woWorld), wi = WorldToLocal(wiWorld);
+        if (wo.z == 0) return 0.;
+        Float pdf = 0;
+        int matchingComps = 0;
+        if (bxdf1.MatchesFlags(flags)) {
+            ++matchingComps;
+            pdf += bxdf1.Pdf(wo, wi);
+        }
+        if (bxdf2.MatchesFlags(flags)) {
+            ++matchingComps;
+            pdf += bxdf2.Pdf(wo, wi);
+        }
+        return matchingComps > 0 ? pdf / matchingComps : 0;
+    }
+
+  private:
+    BxDF1 bxdf1;
+    BxDF2 bxdf2;
+};
+
 class ScaledBxDF : public BxDF {
   public:
     // ScaledBxDF Public Methods
@@ -76,6 +76,42 @@ class RNG {
         return std::min(OneMinusEpsilon, Float(UniformUInt32() * 0x1p-32f));
 #endif
     }
+    // Fill u[0..n) with the next n uniforms, bit-identical to n
+    // UniformFloat() calls.  Four stride-4 lanes (lane i holds the
+    // state after i single steps; each advances by the 4-step
+    // constants) break pcg32's serial dependency so the 64-bit
+    // multiplies pipeline and vectorize.
+    void FillUniform(Float *u, int n) {
+        int i = 0;
+        if (n >= 8) {
+            uint64_t lane[4];
+            lane[0] = state;
+            for (int k = 1; k < 4; ++k)
+                lane[k] = lane[k - 1] * PCG32_MULT + inc;
+            const uint64_t mult2 = PCG32_MULT * PCG32_MULT;
+            const uint64_t mult4 = mult2 * mult2;
+            const uint64_t inc4 =
+                (mult2 * PCG32_MULT + mult2 + PCG32_MULT + 1) * inc;
+            for (; i + 4 <= n; i += 4) {
+                for (int k = 0; k < 4; ++k) {
+                    uint64_t oldstate = lane[k];
+                    lane[k] = oldstate * mult4 + inc4;
+                    uint32_t xorshifted =
+                        (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+                    uint32_t rot = (uint32_t)(oldstate >> 59u);
+                    uint32_t bits = (xorshifted >> rot) |
+                                    (xorshifted << ((~rot + 1u) & 31));
+                    u[i + k] = std::min(
+                        OneMinusEpsilon,
+                        Float(bits * 2.3283064365386963e-10f));
+                }
+            }
+            // Lane 0 has taken i/4 four-steps, which is exactly the
+            // state after i single steps
+            state = lane[0];
+        }
+        for (; i < n; ++i) u[i] = UniformFloat();
+    }
     template <typename Iterator>
     void Shuffle(Iterator begin, Iterator end) {
         for (Iterator it = end - 1; it > begin; --it)
@@ -37,6 +37,18 @@
 #include "camera.h"
 
 // Sampler Method Definitions
+static uint64_t samplerSeed = 0;
+static bool samplerBlueNoiseTemporal = false;
+
+void SetSamplerSeed(uint64_t seed, bool blueNoiseTemporal) {
+    samplerSeed = seed;
+    samplerBlueNoiseTemporal = blueNoiseTemporal;
+}
+
+uint64_t SamplerSeed() { return samplerSeed; }
+
+bool SamplerBlueNoiseTemporal() { return samplerBlueNoiseTemporal; }
+
 Sampler::~Sampler() {}
 
 Sampler::Sampler(int64_t samplesPerPixel) : samplesPerPixel(samplesPerPixel) {}
@@ -71,27 +83,29 @@ bool Sampler::SetSampleNumber(int64_t sampleNum) {
 void Sampler::Request1DArray(int n) {
     Assert(n == RoundCount(n));
     samples1DArraySizes.push_back(n);
-    sampleArray1D.push_back(std::vector<Float>(n * samplesPerPixel));
+    array1DStarts.push_back(sampleArray1D.size());
+    sampleArray1D.resize(sampleArray1D.size() + n * samplesPerPixel);
 }
 
 void Sampler::Request2DArray(int n) {
     Assert(n == RoundCount(n));
     samples2DArraySizes.push_back(n);
-    sampleArray2D.push_back(std::vector<Point2f>(n * samplesPerPixel));
+    array2DStarts.push_back(sampleArray2D.size());
+    sampleArray2D.resize(sampleArray2D.size() + n * samplesPerPixel);
 }
 
 const Float *Sampler::Get1DArray(int n) {
-    if (array1DOffset == sampleArray1D.size()) return nullptr;
+    if (array1DOffset == samples1DArraySizes.size()) return nullptr;
     Assert(n == samples1DArraySizes[array1DOffset]);
     Assert(currentPixelSampleIndex < samplesPerPixel);
-    return &sampleArray1D[array1DOffset++][currentPixelSampleIndex * n];
+    return Array1D(array1DOffset++) + currentPixelSampleIndex * n;
 }
 
 const Point2f *Sampler::Get2DArray(int n) {
-    if (array2DOffset == sampleArray2D.size()) return nullptr;
+    if (array2DOffset == samples2DArraySizes.size()) return nullptr;
     Assert(n == samples2DArraySizes[array2DOffset]);
     Assert(currentPixelSampleIndex < samplesPerPixel);
-    return &sampleArray2D[array2DOffset++][currentPixelSampleIndex * n];
+    return Array2D(array2DOffset++) + currentPixelSampleIndex * n;
 }
 
 PixelSampler::PixelSampler(int64_t samplesPerPixel, int nSampledDimensions)
@@ -102,6 +116,12 @@ PixelSampler::PixelSampler(int64_t samplesPerPixel, int nSampledDimensions)
     }
 }
 
+void PixelSampler::StartPixel(const Point2i &p) {
+    // Mark all dimensions as ungenerated for lazy subclasses
+    nGenerated1D = nGenerated2D = 0;
+    Sampler::StartPixel(p);
+}
+
 bool PixelSampler::StartNextSample() {
     current1DDimension = current2DDimension = 0;
     return Sampler::StartNextSample();
@@ -114,34 +134,87 @@ bool PixelSampler::SetSampleNumber(int64_t sampleNum) {
 
 Float PixelSampler::Get1D() {
     Assert(currentPixelSampleIndex < samplesPerPixel);
-    if (current1DDimension < samples1D.size())
+    if (current1DDimension < samples1D.size()) {
+        // Dimensions are consumed in increasing order, so lazily
+        // generating the next one on first use fills a contiguous
+        // prefix of the dimension vectors.
+        if (lazyDimensions && current1DDimension >= nGenerated1D)
+            GenerateDimension1D(nGenerated1D++);
         return samples1D[current1DDimension++][currentPixelSampleIndex];
-    else
+    } else
         return rng.UniformFloat();
 }
 
 Point2f PixelSampler::Get2D() {
     Assert(currentPixelSampleIndex < samplesPerPixel);
-    if (current2DDimension < samples2D.size())
+    if (current2DDimension < samples2D.size()) {
+        if (lazyDimensions && current2DDimension >= nGenerated2D)
+            GenerateDimension2D(nGenerated2D++);
         return samples2D[current2DDimension++][currentPixelSampleIndex];
-    else
+    } else
         return Point2f(rng.UniformFloat(), rng.UniformFloat());
 }
 
+Sampler::SamplerState Sampler::SaveState() const {
+    SamplerState state;
+    state.pixel = currentPixel;
+    state.sampleIndex = currentPixelSampleIndex;
+    state.dimension1D = state.dimension2D = 0;
+    return state;
+}
+
+void Sampler::RestoreState(const SamplerState &state) {
+    // The base restore replays the pixel's precomputed state and then
+    // seeks to the sample; stream-capable subclasses restore their
+    // dimension counters on top of this
+    StartPixel(state.pixel);
+    SetSampleNumber(state.sampleIndex);
+}
+
+Sampler::SamplerState PixelSampler::SaveState() const {
+    SamplerState state = Sampler::SaveState();
+    state.dimension1D = current1DDimension;
+    state.dimension2D = current2DDimension;
+    return state;
+}
+
+void PixelSampler::RestoreState(const SamplerState &state) {
+    Sampler::RestoreState(state);
+    current1DDimension = state.dimension1D;
+    current2DDimension = state.dimension2D;
+}
+
+Sampler::SamplerState GlobalSampler::SaveState() const {
+    SamplerState state = Sampler::SaveState();
+    state.dimension1D = dimension;
+    return state;
+}
+
+void GlobalSampler::RestoreState(const SamplerState &state) {
+    Sampler::RestoreState(state);
+    // Reconstruct the mid-sample position directly: the global sample
+    // index comes back from GetIndexForSample() and the dimension
+    // counter is part of the saved state, so no samples are
+    // regenerated
+    dimension = state.dimension1D;
+    intervalSampleIndex = GetIndexForSample(state.sampleIndex);
+}
+
 void GlobalSampler::StartPixel(const Point2i &p) {
     Sampler::StartPixel(p);
     dimension = 0;
     intervalSampleIndex = GetIndexForSample(0);
     // Compute _arrayEndDim_ for dimensions used for array samples
-    arrayEndDim =
-        arrayStartDim + sampleArray1D.size() + 2 * sampleArray2D.size();
+    arrayEndDim = arrayStartDim + samples1DArraySizes.size() +
+                  2 * samples2DArraySizes.size();
 
     // Compute 1D array samples for _GlobalSampler_
     for (size_t i = 0; i < samples1DArraySizes.size(); ++i) {
         int nSamples = samples1DArraySizes[i] * samplesPerPixel;
+        Float *array = Array1D(i);
         for (int j = 0; j < nSamples; ++j) {
             int64_t index = GetIndexForSample(j);
-            sampleArray1D[i][j] = SampleDimension(index, arrayStartDim + i);
+            array[j] = SampleDimension(index, arrayStartDim + i);
         }
     }
 
@@ -149,10 +222,11 @@ void GlobalSampler::StartPixel(const Point2i &p) {
     int dim = arrayStartDim + samples1DArraySizes.size();
     for (size_t i = 0; i < samples2DArraySizes.size(); ++i) {
         int nSamples = samples2DArraySizes[i] * samplesPerPixel;
+        Point2f *array = Array2D(i);
         for (int j = 0; j < nSamples; ++j) {
             int64_t idx = GetIndexForSample(j);
-            sampleArray2D[i][j].x = SampleDimension(idx, dim);
-            sampleArray2D[i][j].y = SampleDimension(idx, dim + 1);
+            array[j].x = SampleDimension(idx, dim);
+            array[j].y = SampleDimension(idx, dim + 1);
         }
         dim += 2;
     }
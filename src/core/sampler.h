@@ -45,6 +45,25 @@
 #include <inttypes.h>
 
 // Sampler Declarations
+
+// Frame-coherence seed control: the sampler's "integer seed" parameter
+// (or --seed) mixes into every sampler's scrambling so animations can
+// choose per-frame decorrelation (different seed per frame), frozen
+// patterns (fixed seed), or -- with "string temporalseed"
+// "bluenoise" -- a per-frame toroidal shift of the pmj02 sampler's
+// blue-noise mask, which keeps each frame's error blue in space while
+// cycling it smoothly over time for temporal accumulation.
+void SetSamplerSeed(uint64_t seed, bool blueNoiseTemporal);
+uint64_t SamplerSeed();
+bool SamplerBlueNoiseTemporal();
+// Combine an integrator's per-tile seed with the frame seed
+inline int MixFrameSeed(int tileSeed) {
+    if (SamplerSeed() == 0) return tileSeed;
+    uint64_t mixed =
+        SamplerSeed() * 0x9e3779b97f4a7c15ull + (uint64_t)tileSeed;
+    mixed ^= mixed >> 31;
+    return (int)(mixed & 0x7fffffff);
+}
 class Sampler {
   public:
     // Sampler Interface
@@ -62,6 +81,18 @@ class Sampler {
     virtual bool StartNextSample();
     virtual std::unique_ptr<Sampler> Clone(int seed) = 0;
     virtual bool SetSampleNumber(int64_t sampleNum);
+    int64_t CurrentSampleNumber() const { return currentPixelSampleIndex; }
+    // Compact, serializable sampler position (plain data, so
+    // checkpoints can write it verbatim): enough to put the sampler
+    // back mid-pixel -- and, for global samplers, mid-sample -- via
+    // RestoreState() instead of replaying the sample stream.
+    struct SamplerState {
+        Point2i pixel;
+        int64_t sampleIndex;
+        int dimension1D, dimension2D;
+    };
+    virtual SamplerState SaveState() const;
+    virtual void RestoreState(const SamplerState &state);
 
     // Sampler Public Data
     const int64_t samplesPerPixel;
@@ -71,11 +102,20 @@ class Sampler {
     Point2i currentPixel;
     int64_t currentPixelSampleIndex;
     std::vector<int> samples1DArraySizes, samples2DArraySizes;
-    std::vector<std::vector<Float>> sampleArray1D;
-    std::vector<std::vector<Point2f>> sampleArray2D;
+    // All requested sample arrays live in two flat pooled allocations
+    // that are sized as arrays are requested, reused across pixels, and
+    // copied as a single block when the sampler is cloned, rather than
+    // one heap vector per request per clone.
+    std::vector<Float> sampleArray1D;
+    std::vector<Point2f> sampleArray2D;
+
+    // Sampler Protected Methods
+    Float *Array1D(size_t i) { return &sampleArray1D[array1DStarts[i]]; }
+    Point2f *Array2D(size_t i) { return &sampleArray2D[array2DStarts[i]]; }
 
   private:
     // Sampler Private Data
+    std::vector<size_t> array1DStarts, array2DStarts;
     size_t array1DOffset, array2DOffset;
 };
 
@@ -83,16 +123,30 @@ class PixelSampler : public Sampler {
   public:
     // PixelSampler Public Methods
     PixelSampler(int64_t samplesPerPixel, int nSampledDimensions);
+    void StartPixel(const Point2i &p);
     bool StartNextSample();
     bool SetSampleNumber(int64_t);
     Float Get1D();
     Point2f Get2D();
+    SamplerState SaveState() const;
+    void RestoreState(const SamplerState &state);
 
   protected:
+    // PixelSampler Protected Methods
+    // Subclasses that can produce a single dimension's samples on
+    // demand set _lazyDimensions_ and override these; the dimension
+    // vectors are then filled on first use in each pixel rather than
+    // all at once in StartPixel(), so dimensions past the deepest one
+    // an integrator actually consumes are never generated.
+    virtual void GenerateDimension1D(int dim) {}
+    virtual void GenerateDimension2D(int dim) {}
+
     // PixelSampler Protected Data
     std::vector<std::vector<Float>> samples1D;
     std::vector<std::vector<Point2f>> samples2D;
     int current1DDimension = 0, current2DDimension = 0;
+    bool lazyDimensions = false;
+    int nGenerated1D = 0, nGenerated2D = 0;
     RNG rng;
 };
 
@@ -107,6 +161,8 @@ class GlobalSampler : public Sampler {
     GlobalSampler(int64_t samplesPerPixel) : Sampler(samplesPerPixel) {}
     virtual int64_t GetIndexForSample(int64_t sampleNum) const = 0;
     virtual Float SampleDimension(int64_t index, int dimension) const = 0;
+    SamplerState SaveState() const;
+    void RestoreState(const SamplerState &state);
 
   private:
     // GlobalSampler Private Data
@@ -33,6 +33,7 @@
 
 // core/sampling.cpp*
 #include "sampling.h"
+#include "parallel.h"
 #include "geometry.h"
 #include "shape.h"
 
@@ -155,11 +156,13 @@ Point2f UniformSampleTriangle(const Point2f &u) {
 }
 
 Distribution2D::Distribution2D(const Float *func, int nu, int nv) {
-    pConditionalV.reserve(nv);
-    for (int v = 0; v < nv; ++v) {
-        // Compute conditional sampling distribution for $\tilde{v}$
-        pConditionalV.emplace_back(new Distribution1D(&func[v * nu], nu));
-    }
+    // Compute conditional sampling distributions for $\tilde{v}$; each
+    // row's CDF (and alias table) builds independently, so large
+    // environment maps construct across all cores
+    pConditionalV.resize(nv);
+    ParallelFor([&](int64_t v) {
+        pConditionalV[v].reset(new Distribution1D(&func[v * nu], nu));
+    }, nv, 16);
     // Compute marginal sampling distribution $p[\tilde{v}]$
     std::vector<Float> marginalFunc;
     marginalFunc.reserve(nv);
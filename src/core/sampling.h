@@ -42,6 +42,7 @@
 #include "pbrt.h"
 #include "geometry.h"
 #include "rng.h"
+#include "parallel.h"
 #include <algorithm>
 
 // Sampling Declarations
@@ -53,9 +54,40 @@ void LatinHypercube(Float *samples, int nSamples, int nDim, RNG &rng);
 struct Distribution1D {
     // Distribution1D Public Methods
     Distribution1D(const Float *f, int n) : func(f, f + n), cdf(n + 1) {
-        // Compute integral of step function at $x_i$
+        // Compute integral of step function at $x_i$; for large tables
+        // (e.g. MLT bootstrap weights) the prefix sum runs as a blocked
+        // parallel scan -- per-block sums in parallel, a serial carry,
+        // then parallel block completion -- instead of one serial pass
         cdf[0] = 0;
-        for (int i = 1; i < n + 1; ++i) cdf[i] = cdf[i - 1] + func[i - 1] / n;
+        PBRT_CONSTEXPR int parallelThreshold = 1 << 14;
+        if (n < parallelThreshold) {
+            for (int i = 1; i < n + 1; ++i)
+                cdf[i] = cdf[i - 1] + func[i - 1] / n;
+        } else {
+            int blockSize = 4096, nBlocks = (n + blockSize - 1) / blockSize;
+            std::vector<Float> blockSums(nBlocks);
+            ParallelFor([&](int64_t b) {
+                int begin = b * blockSize,
+                    end = std::min(n, (int)(b + 1) * blockSize);
+                Float sum = 0;
+                for (int i = begin; i < end; ++i) {
+                    sum += func[i] / n;
+                    cdf[i + 1] = sum;
+                }
+                blockSums[b] = sum;
+            }, nBlocks);
+            Float carry = 0;
+            std::vector<Float> blockOffsets(nBlocks);
+            for (int b = 0; b < nBlocks; ++b) {
+                blockOffsets[b] = carry;
+                carry += blockSums[b];
+            }
+            ParallelFor([&](int64_t b) {
+                int begin = b * blockSize,
+                    end = std::min(n, (int)(b + 1) * blockSize);
+                for (int i = begin; i < end; ++i) cdf[i + 1] += blockOffsets[b];
+            }, nBlocks);
+        }
 
         // Transform step function integral into CDF
         funcInt = cdf[n];
@@ -64,8 +96,75 @@ struct Distribution1D {
         } else {
             for (int i = 1; i < n + 1; ++i) cdf[i] /= funcInt;
         }
+
+        // Build the constant-time alias table for large distributions
+        if (n >= 4096) BuildAliasTable();
     }
     int Count() const { return func.size(); }
+    // Build the O(1) alias table (Vose's method) used by the *Alias
+    // sampling methods; built automatically for large distributions,
+    // where the CDF binary search is cache-hostile.  Alias sampling
+    // draws from the same distribution but permutes the mapping from
+    // uniform samples to outcomes, so callers that rely on preserving
+    // sample stratification should keep using the CDF methods.
+    void BuildAliasTable() {
+        int n = Count();
+        aliasProb.assign(n, 1);
+        aliasIndex.resize(n);
+        for (int i = 0; i < n; ++i) aliasIndex[i] = i;
+        Float sum = 0;
+        for (int i = 0; i < n; ++i) sum += func[i];
+        if (sum <= 0) return;
+        std::vector<Float> scaled(n);
+        std::vector<int> small, large;
+        for (int i = 0; i < n; ++i) {
+            scaled[i] = func[i] * n / sum;
+            (scaled[i] < 1 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            int s = small.back(), l = large.back();
+            small.pop_back();
+            large.pop_back();
+            aliasProb[s] = scaled[s];
+            aliasIndex[s] = l;
+            scaled[l] = (scaled[l] + scaled[s]) - 1;
+            (scaled[l] < 1 ? small : large).push_back(l);
+        }
+        // Leftovers are numerically full buckets
+        for (int i : small) aliasProb[i] = 1;
+        for (int i : large) aliasProb[i] = 1;
+    }
+    int SampleDiscreteAlias(Float u, Float *pdf = nullptr) const {
+        if (aliasProb.empty()) return SampleDiscrete(u, pdf);
+        int n = Count();
+        Float scaled = std::min(u * n, (Float)n * OneMinusEpsilon);
+        int j = (int)scaled;
+        Float f = scaled - j;
+        int index = f < aliasProb[j] ? j : aliasIndex[j];
+        if (pdf) *pdf = funcInt > 0 ? func[index] / (funcInt * n) : 0;
+        return index;
+    }
+    Float SampleContinuousAlias(Float u, Float *pdf,
+                                int *off = nullptr) const {
+        if (aliasProb.empty()) return SampleContinuous(u, pdf, off);
+        int n = Count();
+        Float scaled = std::min(u * n, (Float)n * OneMinusEpsilon);
+        int j = (int)scaled;
+        Float f = scaled - j;
+        int index;
+        Float du;
+        if (f < aliasProb[j]) {
+            index = j;
+            du = f / aliasProb[j];
+        } else {
+            index = aliasIndex[j];
+            du = aliasProb[j] < 1 ? (f - aliasProb[j]) / (1 - aliasProb[j])
+                                  : f;
+        }
+        if (off) *off = index;
+        if (pdf) *pdf = funcInt > 0 ? func[index] / funcInt : 0;
+        return (index + std::min(du, OneMinusEpsilon)) / n;
+    }
     Float SampleContinuous(Float u, Float *pdf, int *off = nullptr) const {
         // Find surrounding CDF segments and _offset_
         int offset = FindInterval(cdf.size(),
@@ -101,6 +200,8 @@ struct Distribution1D {
 
     // Distribution1D Public Data
     std::vector<Float> func, cdf;
+    std::vector<Float> aliasProb;
+    std::vector<int> aliasIndex;
     Float funcInt;
 };
 
@@ -128,6 +229,14 @@ class Distribution2D {
         *pdf = pdfs[0] * pdfs[1];
         return Point2f(d0, d1);
     }
+    Point2f SampleContinuousAlias(const Point2f &u, Float *pdf) const {
+        Float pdfs[2];
+        int v;
+        Float d1 = pMarginal->SampleContinuousAlias(u[1], &pdfs[1], &v);
+        Float d0 = pConditionalV[v]->SampleContinuousAlias(u[0], &pdfs[0]);
+        *pdf = pdfs[0] * pdfs[1];
+        return Point2f(d0, d1);
+    }
     Float Pdf(const Point2f &p) const {
         int iu = Clamp(int(p[0] * pConditionalV[0]->Count()), 0,
                        pConditionalV[0]->Count() - 1);
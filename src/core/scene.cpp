@@ -44,16 +44,59 @@ STAT_COUNTER("Intersections/Regular ray intersection tests",
 STAT_COUNTER("Intersections/Shadow ray intersection tests", nShadowTests);
 
 // Scene Method Definitions
+PBRT_THREAD_LOCAL const std::vector<int> *threadBeamEntry;
+
+bool Scene::ComputeBeamEntry(const Point3f &origin,
+                             const Vector3f cornerDirections[4],
+                             std::vector<int> *entryNodes) const {
+    if (const Aggregate *agg = dynamic_cast<const Aggregate *>(aggregate.get()))
+        return agg->ComputeBeamEntry(origin, cornerDirections, entryNodes);
+    return false;
+}
+
 bool Scene::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
     ++nIntersectionTests;
+    ++threadIntersectTests;
+    if ((threadIntersectTests & 4095) == 0) globalRayCounter += 4096;
+    if (threadBeamEntry) {
+        const std::vector<int> *entry = threadBeamEntry;
+        threadBeamEntry = nullptr;
+        if (const Aggregate *agg =
+                dynamic_cast<const Aggregate *>(aggregate.get()))
+            return agg->IntersectFromEntry(ray, isect, *entry);
+    }
     return aggregate->Intersect(ray, isect);
 }
 
 bool Scene::IntersectP(const Ray &ray) const {
     ++nShadowTests;
+    ++threadShadowTests;
+    if ((threadShadowTests & 4095) == 0) globalRayCounter += 4096;
     return aggregate->IntersectP(ray);
 }
 
+void Scene::IntersectStream(Ray *rays, SurfaceInteraction *isects, bool *hits,
+                            int nRays) const {
+    nIntersectionTests += nRays;
+    threadIntersectTests += nRays;
+    globalRayCounter += nRays;
+    if (const Aggregate *agg = dynamic_cast<const Aggregate *>(aggregate.get()))
+        agg->IntersectStream(rays, isects, hits, nRays);
+    else
+        for (int i = 0; i < nRays; ++i)
+            hits[i] = aggregate->Intersect(rays[i], &isects[i]);
+}
+
+void Scene::IntersectPStream(Ray *rays, bool *hits, int nRays) const {
+    nShadowTests += nRays;
+    threadShadowTests += nRays;
+    globalRayCounter += nRays;
+    if (const Aggregate *agg = dynamic_cast<const Aggregate *>(aggregate.get()))
+        agg->IntersectPStream(rays, hits, nRays);
+    else
+        for (int i = 0; i < nRays; ++i) hits[i] = aggregate->IntersectP(rays[i]);
+}
+
 bool Scene::IntersectTr(Ray ray, Sampler &sampler, SurfaceInteraction *isect,
                         Spectrum *Tr) const {
     *Tr = Spectrum(1.f);
@@ -59,6 +59,12 @@ class Scene {
     bool IntersectP(const Ray &ray) const;
     bool IntersectTr(Ray ray, Sampler &sampler, SurfaceInteraction *isect,
                      Spectrum *transmittance) const;
+    void IntersectStream(Ray *rays, SurfaceInteraction *isects, bool *hits,
+                         int nRays) const;
+    void IntersectPStream(Ray *rays, bool *hits, int nRays) const;
+    bool ComputeBeamEntry(const Point3f &origin,
+                          const Vector3f cornerDirections[4],
+                          std::vector<int> *entryNodes) const;
 
     // Scene Public Data
     std::vector<std::shared_ptr<Light>> lights;
@@ -69,4 +75,10 @@ class Scene {
     Bounds3f worldBound;
 };
 
+// One-shot beam arming for camera rays: when non-null, the next
+// Scene::Intersect() on this thread traverses from the armed tile
+// frustum's entry nodes and clears the pointer, so only the camera
+// ray of each Li() call uses the beam.
+extern PBRT_THREAD_LOCAL const std::vector<int> *threadBeamEntry;
+
 #endif  // PBRT_CORE_SCENE_H
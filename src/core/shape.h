@@ -70,6 +70,18 @@ class Shape {
         return Sample(u);
     }
     virtual Float Pdf(const Interaction &ref, const Vector3f &wi) const;
+    // Bounding cone of the shape's surface normals in world space
+    // (axis and the cosine of the maximum half-angle), used to cull
+    // provably unlit emitter/receiver pairs before sampling; shapes
+    // without a cheap cone leave the default and return false
+    virtual bool OrientationCone(Vector3f *axis, Float *cosThetaMax) const {
+        return false;
+    }
+    // Finalize an interaction whose shading geometry was deferred by
+    // Intersect() (see SurfaceInteraction::shadingDeferred); shapes
+    // with expensive shading setup override this so hits overwritten
+    // during traversal never pay for it
+    virtual void ComputeDeferredShading(SurfaceInteraction *isect) const {}
 
     // Shape Public Data
     const Transform *ObjectToWorld, *WorldToObject;
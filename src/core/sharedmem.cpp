@@ -0,0 +1,127 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+// core/sharedmem.cpp*
+#include "sharedmem.h"
+#include <atomic>
+#if defined(PBRT_IS_LINUX) || defined(PBRT_IS_OSX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PBRT_SHAREDMEM_HAVE_SHM
+#endif
+
+// Shared segment layout: one cache-line header, then the payload.
+struct SharedSegmentHeader {
+    uint32_t magic;
+    std::atomic<uint32_t> ready;
+    uint64_t bytes;
+    uint8_t pad[48];
+};
+static const uint32_t sharedSegmentMagic = 0x4d535250;  // "PRSM"
+
+bool SharedSceneEnabled() {
+#ifdef PBRT_SHAREDMEM_HAVE_SHM
+    return PbrtOptions.sharedMem;
+#else
+    return false;
+#endif
+}
+
+void *SharedScenePublishOrAttach(uint64_t key, size_t bytes, bool *creator) {
+    *creator = false;
+#ifndef PBRT_SHAREDMEM_HAVE_SHM
+    return nullptr;
+#else
+    if (!PbrtOptions.sharedMem) return nullptr;
+    char name[64];
+    snprintf(name, sizeof(name), "/pbrt-scene-%016llx",
+             (unsigned long long)key);
+    size_t total = sizeof(SharedSegmentHeader) + bytes;
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    bool created = fd >= 0;
+    if (!created) {
+        fd = shm_open(name, O_RDWR, 0666);
+        if (fd < 0) return nullptr;
+        // The creator may not have sized the segment yet
+        struct stat status;
+        for (int tries = 0; tries < 10000; ++tries) {
+            if (fstat(fd, &status) == 0 && (size_t)status.st_size >= total)
+                break;
+            usleep(1000);
+        }
+        if ((size_t)status.st_size < total) {
+            close(fd);
+            return nullptr;
+        }
+    } else if (ftruncate(fd, total) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return nullptr;
+    }
+    void *mapping =
+        mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+    SharedSegmentHeader *header = (SharedSegmentHeader *)mapping;
+    if (created) {
+        header->bytes = bytes;
+        header->ready.store(0);
+        header->magic = sharedSegmentMagic;
+        *creator = true;
+    } else if (header->bytes != bytes) {
+        // Key collision with different content size; fall back
+        munmap(mapping, total);
+        return nullptr;
+    }
+    return (uint8_t *)mapping + sizeof(SharedSegmentHeader);
+#endif  // PBRT_SHAREDMEM_HAVE_SHM
+}
+
+void SharedSceneMarkReady(void *data) {
+#ifdef PBRT_SHAREDMEM_HAVE_SHM
+    SharedSegmentHeader *header =
+        (SharedSegmentHeader *)((uint8_t *)data -
+                                sizeof(SharedSegmentHeader));
+    header->ready.store(1);
+#endif
+}
+
+void SharedSceneWaitReady(void *data) {
+#ifdef PBRT_SHAREDMEM_HAVE_SHM
+    SharedSegmentHeader *header =
+        (SharedSegmentHeader *)((uint8_t *)data -
+                                sizeof(SharedSegmentHeader));
+    while (header->ready.load() == 0) usleep(1000);
+#endif
+}
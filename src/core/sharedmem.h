@@ -0,0 +1,61 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_SHAREDMEM_H
+#define PBRT_CORE_SHAREDMEM_H
+
+// core/sharedmem.h*
+#include "pbrt.h"
+
+// Shared scene residency (--sharedmem): large read-only arrays --
+// texture MIP pyramids and cached BVH node blocks -- are placed in
+// named shared-memory segments keyed by content hash, so several pbrt
+// processes rendering frames of one shot on a node keep a single
+// resident copy.  The first process to open a key creates and fills
+// the segment, then marks it ready; later processes attach and wait
+// for the ready flag.  Segments persist in /dev/shm until the farm's
+// job wrapper removes pbrt-scene-* entries.
+bool SharedSceneEnabled();
+// Returns the segment's data region (header excluded) or nullptr when
+// sharing is unavailable; *creator tells the caller whether it must
+// fill the region and call SharedSceneMarkReady().
+void *SharedScenePublishOrAttach(uint64_t key, size_t bytes, bool *creator);
+void SharedSceneMarkReady(void *data);
+// Blocks (briefly) until the creator marks the segment ready.
+void SharedSceneWaitReady(void *data);
+
+#endif  // PBRT_CORE_SHAREDMEM_H
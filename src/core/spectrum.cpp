@@ -95,6 +95,45 @@ RGBSpectrum SampledSpectrum::ToRGBSpectrum() const {
 
 SampledSpectrum SampledSpectrum::FromRGB(const Float rgb[3],
                                          SpectrumType type) {
+    // Serve the conversion from the precomputed RGB-cube LUT with a
+    // trilinear fetch; FromRGBDirect() is positively homogeneous, so
+    // HDR inputs are scaled into the unit cube and the result scaled
+    // back.  Negative components (and startup calls before Init()) use
+    // the direct path.
+    const std::vector<Float> &lut =
+        rgb2SpectLUT[type == SpectrumType::Reflectance ? 0 : 1];
+    if (!lut.empty() && rgb[0] >= 0 && rgb[1] >= 0 && rgb[2] >= 0) {
+        Float m = std::max((Float)1, std::max(rgb[0], std::max(rgb[1], rgb[2])));
+        int i0[3];
+        Float t[3];
+        for (int c = 0; c < 3; ++c) {
+            Float q = rgb[c] / m * (rgb2SpectLUTRes - 1);
+            i0[c] = std::min((int)q, rgb2SpectLUTRes - 2);
+            t[c] = q - i0[c];
+        }
+        SampledSpectrum r;
+        for (int dr = 0; dr < 2; ++dr)
+            for (int dg = 0; dg < 2; ++dg)
+                for (int db = 0; db < 2; ++db) {
+                    Float w = (dr ? t[0] : 1 - t[0]) * (dg ? t[1] : 1 - t[1]) *
+                              (db ? t[2] : 1 - t[2]);
+                    if (w == 0) continue;
+                    const Float *entry =
+                        &lut[((((size_t)i0[0] + dr) * rgb2SpectLUTRes +
+                               i0[1] + dg) *
+                                  rgb2SpectLUTRes +
+                              i0[2] + db) *
+                             nSpectralSamples];
+                    for (int i = 0; i < nSpectralSamples; ++i)
+                        r.c[i] += w * entry[i];
+                }
+        return r * m;
+    }
+    return FromRGBDirect(rgb, type);
+}
+
+SampledSpectrum SampledSpectrum::FromRGBDirect(const Float rgb[3],
+                                               SpectrumType type) {
     SampledSpectrum r;
     if (type == SpectrumType::Reflectance) {
         // Convert reflectance spectrum to RGB
@@ -185,6 +224,24 @@ Float InterpolateSpectrumSamples(const Float *lambda, const Float *vals, int n,
     return Lerp(t, vals[offset], vals[offset + 1]);
 }
 
+Spectrum WavelengthToSpectrum(Float lambda) {
+    // Convert a monochromatic line at _lambda_ to the rendering
+    // spectrum via the CIE matching functions, scaled so that a path
+    // whose wavelength is sampled uniformly over the visible range
+    // averages to white; out-of-gamut responses are clamped to zero.
+    Float xyz[3] = {
+        InterpolateSpectrumSamples(CIE_lambda, CIE_X, nCIESamples, lambda),
+        InterpolateSpectrumSamples(CIE_lambda, CIE_Y, nCIESamples, lambda),
+        InterpolateSpectrumSamples(CIE_lambda, CIE_Z, nCIESamples, lambda)};
+    Float scale = Float(sampledLambdaEnd - sampledLambdaStart) /
+                  Float(CIE_Y_integral);
+    for (int c = 0; c < 3; ++c) xyz[c] *= scale;
+    Float rgb[3];
+    XYZToRGB(xyz, rgb);
+    for (int c = 0; c < 3; ++c) rgb[c] = std::max((Float)0, rgb[c]);
+    return Spectrum::FromRGB(rgb, SpectrumType::Illuminant);
+}
+
 const Float CIE_X[nCIESamples] = {
     // CIE X function values
     0.0001299000f,   0.0001458470f,   0.0001638021f,   0.0001840037f,
@@ -962,6 +1019,7 @@ void BlackbodyNormalized(const Float *lambda, int n, Float T, Float *Le) {
 }
 
 // Spectral Data Definitions
+std::vector<Float> SampledSpectrum::rgb2SpectLUT[2];
 SampledSpectrum SampledSpectrum::X;
 SampledSpectrum SampledSpectrum::Y;
 SampledSpectrum SampledSpectrum::Z;
@@ -41,6 +41,10 @@
 // core/spectrum.h*
 #include "pbrt.h"
 #include "parallel.h"
+#if defined(__AVX2__) && !defined(PBRT_FLOAT_AS_DOUBLE)
+#include <immintrin.h>
+#define PBRT_SPECTRUM_HAVE_AVX2
+#endif
 
 // Spectrum Utility Declarations
 static const int sampledLambdaStart = 400;
@@ -66,6 +70,7 @@ inline void RGBToXYZ(const Float rgb[3], Float xyz[3]) {
 enum class SpectrumType { Reflectance, Illuminant };
 extern Float InterpolateSpectrumSamples(const Float *lambda, const Float *vals,
                                         int n, Float l);
+extern Spectrum WavelengthToSpectrum(Float lambda);
 extern void Blackbody(const Float *lambda, int n, Float T, Float *Le);
 extern void BlackbodyNormalized(const Float *lambda, int n, Float T,
                                 Float *vals);
@@ -100,18 +105,18 @@ class CoefficientSpectrum {
   public:
     // CoefficientSpectrum Public Methods
     CoefficientSpectrum(Float v = 0.f) {
-        for (int i = 0; i < nSpectrumSamples; ++i) c[i] = v;
+        for (int i = 0; i < nPaddedSamples; ++i) c[i] = i < nSpectrumSamples ? v : 0;
         Assert(!HasNaNs());
     }
 #ifdef DEBUG
     CoefficientSpectrum(const CoefficientSpectrum &s) {
         Assert(!s.HasNaNs());
-        for (int i = 0; i < nSpectrumSamples; ++i) c[i] = s.c[i];
+        for (int i = 0; i < nPaddedSamples; ++i) c[i] = s.c[i];
     }
 
     CoefficientSpectrum &operator=(const CoefficientSpectrum &s) {
         Assert(!s.HasNaNs());
-        for (int i = 0; i < nSpectrumSamples; ++i) c[i] = s.c[i];
+        for (int i = 0; i < nPaddedSamples; ++i) c[i] = s.c[i];
         return *this;
     }
 #endif  // DEBUG
@@ -125,46 +130,46 @@ class CoefficientSpectrum {
     }
     CoefficientSpectrum &operator+=(const CoefficientSpectrum &s2) {
         Assert(!s2.HasNaNs());
-        for (int i = 0; i < nSpectrumSamples; ++i) c[i] += s2.c[i];
+        AddSpan(c, s2.c);
         return *this;
     }
     CoefficientSpectrum operator+(const CoefficientSpectrum &s2) const {
         Assert(!s2.HasNaNs());
         CoefficientSpectrum ret = *this;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] += s2.c[i];
+        AddSpan(ret.c, s2.c);
         return ret;
     }
     CoefficientSpectrum operator-(const CoefficientSpectrum &s2) const {
         Assert(!s2.HasNaNs());
         CoefficientSpectrum ret = *this;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] -= s2.c[i];
+        SubSpan(ret.c, s2.c);
         return ret;
     }
     CoefficientSpectrum operator/(const CoefficientSpectrum &s2) const {
         Assert(!s2.HasNaNs());
         CoefficientSpectrum ret = *this;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] /= s2.c[i];
+        DivSpan(ret.c, s2.c);
         return ret;
     }
     CoefficientSpectrum operator*(const CoefficientSpectrum &sp) const {
         Assert(!sp.HasNaNs());
         CoefficientSpectrum ret = *this;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] *= sp.c[i];
+        MulSpan(ret.c, sp.c);
         return ret;
     }
     CoefficientSpectrum &operator*=(const CoefficientSpectrum &sp) {
         Assert(!sp.HasNaNs());
-        for (int i = 0; i < nSpectrumSamples; ++i) c[i] *= sp.c[i];
+        MulSpan(c, sp.c);
         return *this;
     }
     CoefficientSpectrum operator*(Float a) const {
         CoefficientSpectrum ret = *this;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] *= a;
+        ScaleSpan(ret.c, a);
         Assert(!ret.HasNaNs());
         return ret;
     }
     CoefficientSpectrum &operator*=(Float a) {
-        for (int i = 0; i < nSpectrumSamples; ++i) c[i] *= a;
+        ScaleSpan(c, a);
         Assert(!HasNaNs());
         return *this;
     }
@@ -176,13 +181,13 @@ class CoefficientSpectrum {
     CoefficientSpectrum operator/(Float a) const {
         Assert(!std::isnan(a));
         CoefficientSpectrum ret = *this;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] /= a;
+        DivScalarSpan(ret.c, a);
         Assert(!ret.HasNaNs());
         return ret;
     }
     CoefficientSpectrum &operator/=(Float a) {
         Assert(!std::isnan(a));
-        for (int i = 0; i < nSpectrumSamples; ++i) c[i] /= a;
+        DivScalarSpan(c, a);
         return *this;
     }
     bool operator==(const CoefficientSpectrum &sp) const {
@@ -261,7 +266,119 @@ class CoefficientSpectrum {
 
   protected:
     // CoefficientSpectrum Protected Data
-    Float c[nSpectrumSamples];
+    // With AVX2 the coefficient array is padded to the 8-wide vector
+    // width for spectra of at least one full vector (sampled spectra;
+    // RGB stays unpadded) and aligned so the span kernels below can
+    // process whole registers.  Padding lanes are kept zero so dot
+    // products over the padded array are unaffected.
+    static PBRT_CONSTEXPR int nPaddedSamples =
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        nSpectrumSamples >= 8 ? (nSpectrumSamples + 7) & ~7 :
+#endif
+                              nSpectrumSamples;
+#ifdef PBRT_HAVE_ALIGNAS
+    alignas(nPaddedSamples % 8 == 0 ? 32 : alignof(Float))
+#endif  // PBRT_HAVE_ALIGNAS
+        Float c[nPaddedSamples];
+
+    // CoefficientSpectrum Protected Methods
+    // Span kernels behind the arithmetic operators; each runs a full
+    // AVX2 register at a time when the padded array fills whole vectors
+    // and falls back to the scalar loop otherwise.
+    static void AddSpan(Float *dst, const Float *s) {
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        if (nPaddedSamples % 8 == 0) {
+            for (int i = 0; i < nPaddedSamples; i += 8)
+                _mm256_storeu_ps(dst + i,
+                                 _mm256_add_ps(_mm256_loadu_ps(dst + i),
+                                               _mm256_loadu_ps(s + i)));
+            return;
+        }
+#endif  // PBRT_SPECTRUM_HAVE_AVX2
+        for (int i = 0; i < nSpectrumSamples; ++i) dst[i] += s[i];
+    }
+    static void SubSpan(Float *dst, const Float *s) {
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        if (nPaddedSamples % 8 == 0) {
+            for (int i = 0; i < nPaddedSamples; i += 8)
+                _mm256_storeu_ps(dst + i,
+                                 _mm256_sub_ps(_mm256_loadu_ps(dst + i),
+                                               _mm256_loadu_ps(s + i)));
+            return;
+        }
+#endif  // PBRT_SPECTRUM_HAVE_AVX2
+        for (int i = 0; i < nSpectrumSamples; ++i) dst[i] -= s[i];
+    }
+    static void MulSpan(Float *dst, const Float *s) {
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        if (nPaddedSamples % 8 == 0) {
+            for (int i = 0; i < nPaddedSamples; i += 8)
+                _mm256_storeu_ps(dst + i,
+                                 _mm256_mul_ps(_mm256_loadu_ps(dst + i),
+                                               _mm256_loadu_ps(s + i)));
+            return;
+        }
+#endif  // PBRT_SPECTRUM_HAVE_AVX2
+        for (int i = 0; i < nSpectrumSamples; ++i) dst[i] *= s[i];
+    }
+    static void DivSpan(Float *dst, const Float *s) {
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        if (nPaddedSamples % 8 == 0) {
+            for (int i = 0; i < nPaddedSamples; i += 8)
+                _mm256_storeu_ps(dst + i,
+                                 _mm256_div_ps(_mm256_loadu_ps(dst + i),
+                                               _mm256_loadu_ps(s + i)));
+            // Re-zero the padding lanes, which divide zero by zero
+            for (int i = nSpectrumSamples; i < nPaddedSamples; ++i)
+                dst[i] = 0;
+            return;
+        }
+#endif  // PBRT_SPECTRUM_HAVE_AVX2
+        for (int i = 0; i < nSpectrumSamples; ++i) dst[i] /= s[i];
+    }
+    static void ScaleSpan(Float *dst, Float a) {
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        if (nPaddedSamples % 8 == 0) {
+            __m256 va = _mm256_set1_ps(a);
+            for (int i = 0; i < nPaddedSamples; i += 8)
+                _mm256_storeu_ps(dst + i,
+                                 _mm256_mul_ps(_mm256_loadu_ps(dst + i), va));
+            return;
+        }
+#endif  // PBRT_SPECTRUM_HAVE_AVX2
+        for (int i = 0; i < nSpectrumSamples; ++i) dst[i] *= a;
+    }
+    static void DivScalarSpan(Float *dst, Float a) {
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        if (nPaddedSamples % 8 == 0) {
+            __m256 va = _mm256_set1_ps(a);
+            for (int i = 0; i < nPaddedSamples; i += 8)
+                _mm256_storeu_ps(dst + i,
+                                 _mm256_div_ps(_mm256_loadu_ps(dst + i), va));
+            return;
+        }
+#endif  // PBRT_SPECTRUM_HAVE_AVX2
+        for (int i = 0; i < nSpectrumSamples; ++i) dst[i] /= a;
+    }
+    static Float DotSpans(const Float *a, const Float *b) {
+#ifdef PBRT_SPECTRUM_HAVE_AVX2
+        if (nPaddedSamples % 8 == 0) {
+            __m256 sum = _mm256_setzero_ps();
+            for (int i = 0; i < nPaddedSamples; i += 8)
+                sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                                      _mm256_loadu_ps(b + i), sum);
+            __m128 lo = _mm256_castps256_ps128(sum);
+            __m128 hi = _mm256_extractf128_ps(sum, 1);
+            lo = _mm_add_ps(lo, hi);
+            lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+            lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+            return _mm_cvtss_f32(lo);
+        }
+#endif  // PBRT_SPECTRUM_HAVE_AVX2
+        Float sum = 0;
+        for (int i = 0; i < nSpectrumSamples; ++i) sum += a[i] * b[i];
+        return sum;
+    }
 };
 
 class SampledSpectrum : public CoefficientSpectrum<nSpectralSamples> {
@@ -354,24 +471,39 @@ class SampledSpectrum : public CoefficientSpectrum<nSpectralSamples> {
                 AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectBlue,
                                        nRGB2SpectSamples, wl0, wl1);
         }
+
+        // Precompute the RGB-cube-to-spectrum lookup tables for
+        // FromRGB(); FromRGB() is positively homogeneous in rgb, so the
+        // unit cube covers HDR inputs after scaling by the maximum
+        // component.
+        for (int t = 0; t < 2; ++t) {
+            SpectrumType type = t == 0 ? SpectrumType::Reflectance
+                                       : SpectrumType::Illuminant;
+            std::vector<Float> &lut = rgb2SpectLUT[t];
+            lut.resize((size_t)rgb2SpectLUTRes * rgb2SpectLUTRes *
+                       rgb2SpectLUTRes * nSpectralSamples);
+            size_t offset = 0;
+            for (int ir = 0; ir < rgb2SpectLUTRes; ++ir)
+                for (int ig = 0; ig < rgb2SpectLUTRes; ++ig)
+                    for (int ib = 0; ib < rgb2SpectLUTRes; ++ib) {
+                        Float rgb[3] = {ir / Float(rgb2SpectLUTRes - 1),
+                                        ig / Float(rgb2SpectLUTRes - 1),
+                                        ib / Float(rgb2SpectLUTRes - 1)};
+                        SampledSpectrum s = FromRGBDirect(rgb, type);
+                        for (int i = 0; i < nSpectralSamples; ++i)
+                            lut[offset++] = s.c[i];
+                    }
+        }
     }
     void ToXYZ(Float xyz[3]) const {
-        xyz[0] = xyz[1] = xyz[2] = 0.f;
-        for (int i = 0; i < nSpectralSamples; ++i) {
-            xyz[0] += X.c[i] * c[i];
-            xyz[1] += Y.c[i] * c[i];
-            xyz[2] += Z.c[i] * c[i];
-        }
         Float scale = Float(sampledLambdaEnd - sampledLambdaStart) /
                       Float(CIE_Y_integral * nSpectralSamples);
-        xyz[0] *= scale;
-        xyz[1] *= scale;
-        xyz[2] *= scale;
+        xyz[0] = DotSpans(X.c, c) * scale;
+        xyz[1] = DotSpans(Y.c, c) * scale;
+        xyz[2] = DotSpans(Z.c, c) * scale;
     }
     Float y() const {
-        Float yy = 0.f;
-        for (int i = 0; i < nSpectralSamples; ++i) yy += Y.c[i] * c[i];
-        return yy * Float(sampledLambdaEnd - sampledLambdaStart) /
+        return DotSpans(Y.c, c) * Float(sampledLambdaEnd - sampledLambdaStart) /
                Float(CIE_Y_integral * nSpectralSamples);
     }
     void ToRGB(Float rgb[3]) const {
@@ -382,6 +514,8 @@ class SampledSpectrum : public CoefficientSpectrum<nSpectralSamples> {
     RGBSpectrum ToRGBSpectrum() const;
     static SampledSpectrum FromRGB(
         const Float rgb[3], SpectrumType type = SpectrumType::Illuminant);
+    static SampledSpectrum FromRGBDirect(const Float rgb[3],
+                                         SpectrumType type);
     static SampledSpectrum FromXYZ(
         const Float xyz[3], SpectrumType type = SpectrumType::Reflectance) {
         Float rgb[3];
@@ -394,6 +528,8 @@ class SampledSpectrum : public CoefficientSpectrum<nSpectralSamples> {
   private:
     // SampledSpectrum Private Data
     static SampledSpectrum X, Y, Z;
+    static PBRT_CONSTEXPR int rgb2SpectLUTRes = 16;
+    static std::vector<Float> rgb2SpectLUT[2];
     static SampledSpectrum rgbRefl2SpectWhite, rgbRefl2SpectCyan;
     static SampledSpectrum rgbRefl2SpectMagenta, rgbRefl2SpectYellow;
     static SampledSpectrum rgbRefl2SpectRed, rgbRefl2SpectGreen;
@@ -39,9 +39,17 @@
 #include <type_traits>
 #include <atomic>
 #include <signal.h>
+#include <time.h>
 #ifndef PBRT_IS_WINDOWS
 #include <sys/time.h>
 #endif  // !PBRT_IS_WINDOWS
+#ifdef PBRT_IS_LINUX
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // PBRT_IS_LINUX
 
 // Statistics Local Variables
 std::vector<std::function<void(StatsAccumulator &)>> *StatRegisterer::funcs;
@@ -62,7 +70,163 @@ void StatRegisterer::CallCallbacks(StatsAccumulator &accum) {
     for (auto func : *funcs) func(accum);
 }
 
-void PrintStats(FILE *dest) { statsAccumulator.Print(dest); }
+void PrintStats(FILE *dest) {
+    statsAccumulator.Print(dest);
+    PrintPerfCounters(dest);
+}
+
+int64_t StatsCounterValue(const std::string &name) {
+    return statsAccumulator.CounterValue(name);
+}
+
+// Escape a stat or phase name for embedding in a JSON string
+static std::string JSONEscape(const std::string &name) {
+    std::string escaped;
+    for (char c : name) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void AppendStatsDatabaseRecord(const std::string &path,
+                               const std::string &scene, double parseSeconds,
+                               double buildSeconds, double renderSeconds,
+                               int64_t peakRSSBytes) {
+    FILE *f = fopen(path.c_str(), "a");
+    if (!f) {
+        Error("Unable to open stats database \"%s\"", path.c_str());
+        return;
+    }
+    // Scene identity: the path plus a hash of it, so queries can key
+    // on either
+    uint64_t sceneHash = 14695981039346656037ull;
+    for (char c : scene) {
+        sceneHash ^= (unsigned char)c;
+        sceneHash *= 1099511628211ull;
+    }
+    fprintf(f,
+            "{\"time\": %lld, \"build\": \"%s %s\", "
+            "\"scene\": \"%s\", \"scene_hash\": \"%016llx\", "
+            "\"parse_s\": %.3f, \"build_s\": %.3f, "
+            "\"render_s\": %.3f, \"peak_rss_bytes\": %lld",
+            (long long)time(nullptr), __DATE__, __TIME__,
+            JSONEscape(scene).c_str(), (unsigned long long)sceneHash,
+            parseSeconds, buildSeconds, renderSeconds,
+            (long long)peakRSSBytes);
+    fprintf(f, ", \"phases\": %s",
+            ProfilerPhaseBreakdownJSON((int)Prof::NumProfEvents).c_str());
+    fprintf(f, ", \"counters\": {");
+    bool first = true;
+    for (const auto &counter : statsAccumulator.Counters()) {
+        fprintf(f, "%s\"%s\": %lld", first ? "" : ", ",
+                JSONEscape(counter.first).c_str(), (long long)counter.second);
+        first = false;
+    }
+    fprintf(f, "}}\n");
+    fclose(f);
+}
+
+// Hardware performance-counter state
+bool perfCountersEnabled = false;
+namespace {
+// Inclusive per-category totals: a phase's interval covers any phases
+// nested inside it, so columns don't sum across categories.
+std::atomic<uint64_t>
+    perfTotals[(int)Prof::NumProfEvents + 1][NumPerfCounterEvents];
+std::atomic<uint64_t> perfIntervals[(int)Prof::NumProfEvents + 1];
+}  // namespace
+
+#ifdef PBRT_IS_LINUX
+namespace {
+// Per-thread counter group: the leader (cycles) is read with
+// PERF_FORMAT_GROUP so one read() returns all four values.
+struct PerfEventGroup {
+    int leaderFd = -1;
+};
+PBRT_THREAD_LOCAL PerfEventGroup *threadPerfGroup;
+
+int PerfEventOpen(struct perf_event_attr *attr, int groupFd) {
+    return syscall(SYS_perf_event_open, attr, 0 /* this thread */,
+                   -1 /* any cpu */, groupFd, 0);
+}
+
+PerfEventGroup *OpenPerfEventGroup() {
+    PerfEventGroup *group = new PerfEventGroup;
+    static const uint64_t configs[NumPerfCounterEvents] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < NumPerfCounterEvents; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        if (i == 0) attr.read_format = PERF_FORMAT_GROUP;
+        int fd = PerfEventOpen(&attr, group->leaderFd);
+        if (fd < 0) {
+            static std::atomic<bool> warned(false);
+            if (!warned.exchange(true))
+                Warning(
+                    "perf_event_open failed; hardware counters disabled "
+                    "(check /proc/sys/kernel/perf_event_paranoid)");
+            if (group->leaderFd >= 0) close(group->leaderFd);
+            group->leaderFd = -1;
+            return group;
+        }
+        if (i == 0) group->leaderFd = fd;
+    }
+    return group;
+}
+}  // namespace
+
+bool ReadPerfCounters(uint64_t values[NumPerfCounterEvents]) {
+    PerfEventGroup *group = threadPerfGroup;
+    if (!group) threadPerfGroup = group = OpenPerfEventGroup();
+    if (group->leaderFd < 0) return false;
+    struct {
+        uint64_t nr;
+        uint64_t values[NumPerfCounterEvents];
+    } data;
+    if (read(group->leaderFd, &data, sizeof(data)) != sizeof(data) ||
+        data.nr != NumPerfCounterEvents)
+        return false;
+    for (int i = 0; i < NumPerfCounterEvents; ++i) values[i] = data.values[i];
+    return true;
+}
+#else
+bool ReadPerfCounters(uint64_t values[NumPerfCounterEvents]) { return false; }
+#endif  // PBRT_IS_LINUX
+
+void ReportPerfCounterInterval(int category,
+                               const uint64_t start[NumPerfCounterEvents],
+                               const uint64_t end[NumPerfCounterEvents]) {
+    Assert(category >= 0 && category <= (int)Prof::NumProfEvents);
+    for (int i = 0; i < NumPerfCounterEvents; ++i)
+        if (end[i] >= start[i]) perfTotals[category][i] += end[i] - start[i];
+    ++perfIntervals[category];
+}
+
+void PrintPerfCounters(FILE *dest) {
+    if (!perfCountersEnabled) return;
+    fprintf(dest, "  Hardware perf counters (inclusive of nested phases)\n");
+    fprintf(dest, "    %-42s %10s %10s %6s %10s %10s\n", "", "Mcycles",
+            "Minstr", "IPC", "LLC miss", "br miss");
+    for (int c = 0; c <= (int)Prof::NumProfEvents; ++c) {
+        uint64_t cycles = perfTotals[c][0], instructions = perfTotals[c][1];
+        if (cycles == 0) continue;
+        const char *name = c < (int)Prof::NumProfEvents
+                               ? ProfNames[c]
+                               : "ParallelFor chunk";
+        fprintf(dest,
+                "    %-42s %10.0f %10.0f %6.2f %10" PRIu64 " %10" PRIu64 "\n",
+                name, cycles / 1e6, instructions / 1e6,
+                cycles > 0 ? (double)instructions / cycles : 0.,
+                perfTotals[c][2].load(), perfTotals[c][3].load());
+    }
+}
 
 static void getCategoryAndTitle(const std::string &str, std::string *category,
                                 std::string *title) {
@@ -161,6 +325,125 @@ void StatsAccumulator::Print(FILE *dest) {
 
 static PBRT_CONSTEXPR int NumProfEvents = (int)Prof::NumProfEvents;
 PBRT_THREAD_LOCAL uint32_t profilerState;
+PBRT_THREAD_LOCAL uint64_t threadIntersectTests;
+PBRT_THREAD_LOCAL uint64_t threadShadowTests;
+std::atomic<uint64_t> globalRayCounter(0);
+
+uint64_t GlobalRayCounter() { return globalRayCounter.load(); }
+
+std::string ProfilerPhaseBreakdownJSON(int maxPhases) {
+    char buf[512];
+#ifndef PBRT_IS_WINDOWS
+    if (!profileSamples) return "{}";
+    uint64_t overall = 0;
+    uint64_t eventCount[(int)Prof::NumProfEvents] = {0};
+    for (int i = 0; i < 1 << (int)Prof::NumProfEvents; ++i) {
+        uint64_t count = profileSamples[i].load();
+        if (count == 0) continue;
+        overall += count;
+        for (int b = 0; b < (int)Prof::NumProfEvents; ++b)
+            if (i & (1 << b)) eventCount[b] += count;
+    }
+    if (overall == 0) return "{}";
+    std::vector<int> order((int)Prof::NumProfEvents);
+    for (int i = 0; i < (int)Prof::NumProfEvents; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return eventCount[a] > eventCount[b];
+    });
+    std::string result = "{";
+    int emitted = 0;
+    for (int i = 0; i < (int)Prof::NumProfEvents && emitted < maxPhases;
+         ++i) {
+        if (eventCount[order[i]] == 0) break;
+        snprintf(buf, sizeof(buf), "%s\"%s\": %.3f",
+                 emitted > 0 ? ", " : "", ProfNames[order[i]],
+                 (double)eventCount[order[i]] / overall);
+        result += buf;
+        ++emitted;
+    }
+    return result + "}";
+#else
+    (void)buf;
+    return "{}";
+#endif  // !PBRT_IS_WINDOWS
+}
+uint32_t profileSampleMask;
+PBRT_THREAD_LOCAL uint64_t threadProfileTick;
+
+// Chrome-trace recording state
+bool profilerTraceEnabled = false;
+namespace {
+struct TraceEvent {
+    int32_t category;
+    uint64_t startUs, durUs;
+};
+struct TraceBuffer {
+    int tid;
+    std::vector<TraceEvent> events;
+};
+std::vector<std::unique_ptr<TraceBuffer>> traceBuffers;
+std::mutex traceMutex;
+std::string traceFilename;
+std::chrono::steady_clock::time_point traceEpoch;
+PBRT_THREAD_LOCAL TraceBuffer *threadTraceBuffer;
+PBRT_CONSTEXPR size_t maxTraceEventsPerThread = 1 << 21;
+}  // namespace
+
+void InitProfilerTrace(const std::string &filename) {
+    traceFilename = filename;
+    traceEpoch = std::chrono::steady_clock::now();
+    profilerTraceEnabled = true;
+}
+
+uint64_t TraceTimeNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - traceEpoch)
+        .count();
+}
+
+void RecordTraceEvent(int category, uint64_t startUs, uint64_t durUs) {
+    TraceBuffer *buffer = threadTraceBuffer;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceBuffers.emplace_back(new TraceBuffer);
+        buffer = traceBuffers.back().get();
+        buffer->tid = (int)traceBuffers.size();
+        threadTraceBuffer = buffer;
+    }
+    // Bound memory: drop events past the per-thread cap
+    if (buffer->events.size() >= maxTraceEventsPerThread) return;
+    buffer->events.push_back({(int32_t)category, startUs, durUs});
+}
+
+void WriteProfilerTrace() {
+    if (!profilerTraceEnabled) return;
+    profilerTraceEnabled = false;
+    FILE *f = fopen(traceFilename.c_str(), "w");
+    if (!f) {
+        Warning("Unable to write trace file \"%s\"", traceFilename.c_str());
+        return;
+    }
+    fprintf(f, "[\n");
+    bool first = true;
+    std::lock_guard<std::mutex> lock(traceMutex);
+    for (const auto &buffer : traceBuffers) {
+        for (const TraceEvent &event : buffer->events) {
+            const char *name = event.category < (int)Prof::NumProfEvents
+                                   ? ProfNames[event.category]
+                                   : "ParallelFor chunk";
+            fprintf(f,
+                    "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, "
+                    "\"tid\": %d, \"ts\": %llu, \"dur\": %llu}",
+                    first ? "" : ",\n", name, buffer->tid,
+                    (unsigned long long)event.startUs,
+                    (unsigned long long)event.durUs);
+            first = false;
+        }
+    }
+    fprintf(f, "\n]\n");
+    fclose(f);
+    printf("Wrote trace to \"%s\"\n", traceFilename.c_str());
+}
 
 #ifdef PBRT_IS_OSX
 #include <execinfo.h>
@@ -40,6 +40,7 @@
 
 // core/stats.h*
 #include "pbrt.h"
+#include <atomic>
 #include <map>
 #include <chrono>
 #include <string>
@@ -64,6 +65,18 @@ class StatRegisterer {
 
 void PrintStats(FILE *dest);
 void ReportThreadStats();
+// Value accumulated so far for the STAT_COUNTER registered under
+// _name_ (e.g. "Intersections/Regular ray intersection tests"); only
+// counts from threads that have called ReportThreadStats() are seen.
+int64_t StatsCounterValue(const std::string &name);
+// Append one structured JSONL record -- build id, scene, phase wall
+// times, peak RSS, profiler category shares, and every accumulated
+// counter -- to the --statsdb results store, so per-scene performance
+// can be queried across builds without log scraping.
+void AppendStatsDatabaseRecord(const std::string &path,
+                               const std::string &scene, double parseSeconds,
+                               double buildSeconds, double renderSeconds,
+                               int64_t peakRSSBytes);
 
 class StatsAccumulator {
   public:
@@ -74,6 +87,11 @@ class StatsAccumulator {
     void ReportMemoryCounter(const std::string &name, int64_t val) {
         memoryCounters[name] += val;
     }
+    int64_t CounterValue(const std::string &name) const {
+        auto iter = counters.find(name);
+        return iter != counters.end() ? iter->second : 0;
+    }
+    const std::map<std::string, int64_t> &Counters() const { return counters; }
     void ReportIntDistribution(const std::string &name, int64_t sum,
                                int64_t count, int64_t min, int64_t max) {
         intDistributionSums[name] += sum;
@@ -177,24 +195,104 @@ static const char *ProfNames[] = {
 
 extern PBRT_THREAD_LOCAL uint32_t profilerState;
 inline uint32_t CurrentProfilerState() { return profilerState; }
+
+// Per-thread intersection counters behind the per-pixel statistics
+// image (--statsimage): Scene's intersection methods bump them, and
+// SamplerIntegrator::Render() samples them around each pixel to
+// attribute ray counts to the pixel being rendered.
+extern PBRT_THREAD_LOCAL uint64_t threadIntersectTests;
+extern PBRT_THREAD_LOCAL uint64_t threadShadowTests;
+// Low-resolution global ray count, flushed from the thread-local
+// counters in blocks so progress reporting can read a live total
+// without a per-ray atomic
+extern std::atomic<uint64_t> globalRayCounter;
+uint64_t GlobalRayCounter();
+// Live per-phase profiler breakdown (top categories by sample count)
+// as a JSON object string for the structured progress channel
+std::string ProfilerPhaseBreakdownJSON(int maxPhases = 5);
+
+// Profiling tiers: building with PBRT_DISABLE_PROFILING compiles the
+// profiler-state writes out of the hot path entirely; at runtime,
+// --profilesample N (a power of two) makes only one in N ProfilePhase
+// constructions carry instrumentation, so the sampling profiler keeps
+// statistically valid attributions at a fraction of the overhead.
+extern uint32_t profileSampleMask;
+extern PBRT_THREAD_LOCAL uint64_t threadProfileTick;
+
+// Chrome-trace recording (--trace <file.json>): sampled ProfilePhase
+// activations and ParallelFor chunk executions are recorded as
+// per-thread timeline events and written in trace-event JSON at
+// cleanup, viewable in ui.perfetto.dev / chrome://tracing.
+extern bool profilerTraceEnabled;
+void InitProfilerTrace(const std::string &filename);
+void WriteProfilerTrace();
+uint64_t TraceTimeNowUs();
+void RecordTraceEvent(int category, uint64_t startUs, uint64_t durUs);
+
+// Hardware performance counters (--perfcounters, Linux perf_event):
+// cycles, instructions, LLC misses, and branch misses are read around
+// sampled ProfilePhase activations and ParallelFor chunks and
+// accumulated per category, so cache- and branch-behavior statements
+// about a phase come from the renderer itself.
+static PBRT_CONSTEXPR int NumPerfCounterEvents = 4;
+extern bool perfCountersEnabled;
+bool ReadPerfCounters(uint64_t values[NumPerfCounterEvents]);
+void ReportPerfCounterInterval(int category,
+                               const uint64_t start[NumPerfCounterEvents],
+                               const uint64_t end[NumPerfCounterEvents]);
+void PrintPerfCounters(FILE *dest);
+
 class ProfilePhase {
   public:
     // ProfilePhase Public Methods
     ProfilePhase(Prof p) {
+#ifdef PBRT_DISABLE_PROFILING
+        reset = false;
+        categoryBit = 0;
+#else
+        if (profileSampleMask &&
+            (++threadProfileTick & profileSampleMask) != 0) {
+            // Unsampled: no state writes, destructor is a no-op
+            reset = false;
+            categoryBit = 0;
+            return;
+        }
         categoryBit = (1 << (int)p);
         reset = (profilerState & categoryBit) == 0;
         profilerState |= categoryBit;
+        if (profilerTraceEnabled || perfCountersEnabled) {
+            profIndex = (int)p;
+            if (profilerTraceEnabled) traceStart = TraceTimeNowUs();
+            if (perfCountersEnabled) perfValid = ReadPerfCounters(perfStart);
+        }
+#endif  // PBRT_DISABLE_PROFILING
     }
     ~ProfilePhase() {
         if (reset) profilerState &= ~categoryBit;
+#ifndef PBRT_DISABLE_PROFILING
+        if (profilerTraceEnabled && categoryBit) {
+            uint64_t now = TraceTimeNowUs();
+            RecordTraceEvent(profIndex, traceStart, now - traceStart);
+        }
+        if (perfValid) {
+            uint64_t perfEnd[NumPerfCounterEvents];
+            if (ReadPerfCounters(perfEnd))
+                ReportPerfCounterInterval(profIndex, perfStart, perfEnd);
+        }
+#endif  // PBRT_DISABLE_PROFILING
     }
     ProfilePhase(const ProfilePhase &) = delete;
+
     ProfilePhase &operator=(const ProfilePhase &) = delete;
 
   private:
     // ProfilePhase Private Data
     bool reset;
+    bool perfValid = false;
     uint32_t categoryBit;
+    int profIndex = 0;
+    uint64_t traceStart = 0;
+    uint64_t perfStart[NumPerfCounterEvents];
 };
 
 void InitProfiler();
@@ -0,0 +1,346 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// core/texcache.cpp*
+#include "texcache.h"
+#include "stats.h"
+#if defined(PBRT_IS_LINUX) || defined(PBRT_IS_OSX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PBRT_TEXCACHE_HAVE_MMAP
+#endif
+
+STAT_COUNTER("Texture/Tile cache misses", texCacheMisses);
+STAT_COUNTER("Texture/Tile cache lookups", texCacheLookups);
+STAT_MEMORY_COUNTER("Memory/Texture tile cache", texCacheBytes);
+
+// Per-thread non-blocking state (see SetNonBlocking)
+static PBRT_THREAD_LOCAL bool threadNonBlocking;
+static PBRT_THREAD_LOCAL bool threadTookFault;
+
+// Tiled texture cache file layout: _TxcHeader_, then one
+// _TxcLevelRecord_ per MIP level, then each level's tiles in row-major
+// tile order.  Every tile is stored full-size (tileSize x tileSize x
+// nChannels Floats); edge tiles are zero-padded.
+struct TxcHeader {
+    uint32_t magic, version;
+    uint32_t floatSize, nChannels, tileSize;
+    uint32_t nLevels;
+};
+struct TxcLevelRecord {
+    int32_t sRes, tRes;
+    uint64_t fileOffset;
+};
+static const uint32_t txcMagic = 0x58544250;  // "PBTX"
+static const uint32_t txcVersion = 1;
+
+// TiledTextureCache Method Definitions
+TiledTextureCache *TiledTextureCache::GetInstance() {
+    if (PbrtOptions.texCacheMB <= 0) return nullptr;
+    static TiledTextureCache cache((size_t)PbrtOptions.texCacheMB * 1024 *
+                                   1024);
+    return &cache;
+}
+
+TiledTextureCache::~TiledTextureCache() {
+    if (loaderThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(loaderMutex);
+            shutdownLoader = true;
+            loaderCondition.notify_one();
+        }
+        loaderThread.join();
+    }
+    for (auto &tex : textures) {
+#ifdef PBRT_TEXCACHE_HAVE_MMAP
+        if (tex->mapping) munmap((void *)tex->mapping, tex->mappingSize);
+#endif
+        if (tex->file) fclose(tex->file);
+    }
+}
+
+int TiledTextureCache::OpenTexture(const std::string &filename, int nChannels,
+                                   Point2i *resolution,
+                                   std::vector<Point2i> *levelRes) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return -1;
+    TxcHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != txcMagic || header.version != txcVersion ||
+        header.floatSize != sizeof(Float) ||
+        header.nChannels != (uint32_t)nChannels ||
+        header.tileSize != (uint32_t)tileSize) {
+        Warning("Ignoring texture cache file \"%s\": stale or incompatible",
+                filename.c_str());
+        fclose(f);
+        return -1;
+    }
+    std::unique_ptr<OpenTexture_> tex(new OpenTexture_);
+    tex->file = f;
+    tex->nChannels = nChannels;
+    tex->levels.resize(header.nLevels);
+    levelRes->clear();
+    for (uint32_t i = 0; i < header.nLevels; ++i) {
+        TxcLevelRecord record;
+        if (fread(&record, sizeof(record), 1, f) != 1) {
+            Warning("Truncated texture cache file \"%s\"", filename.c_str());
+            fclose(f);
+            return -1;
+        }
+        tex->levels[i].res = Point2i(record.sRes, record.tRes);
+        tex->levels[i].nTilesX = (record.sRes + tileSize - 1) / tileSize;
+        tex->levels[i].fileOffset = record.fileOffset;
+        levelRes->push_back(tex->levels[i].res);
+    }
+    *resolution = tex->levels[0].res;
+
+#ifdef PBRT_TEXCACHE_HAVE_MMAP
+    // Memory-map the cache file when possible: texel fetches then read
+    // zero-copy from the mapping and residency is handled by the
+    // kernel's page cache instead of the LRU tile list.
+    struct stat sb;
+    if (fstat(fileno(f), &sb) == 0) {
+        void *m = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED,
+                       fileno(f), 0);
+        if (m != MAP_FAILED) {
+            tex->mapping = (const char *)m;
+            tex->mappingSize = sb.st_size;
+        }
+    }
+#endif  // PBRT_TEXCACHE_HAVE_MMAP
+
+    std::lock_guard<std::mutex> lock(texturesMutex);
+    textures.push_back(std::move(tex));
+    return (int)textures.size() - 1;
+}
+
+void TiledTextureCache::GetTexel(int texId, int level, int s, int t,
+                                 Float *out) {
+    ++texCacheLookups;
+    OpenTexture_ &tex = *textures[texId];
+    const TextureLevel &lev = tex.levels[level];
+    int tx = s / tileSize, ty = t / tileSize;
+    uint64_t key = ((uint64_t)texId << 48) | ((uint64_t)level << 40) |
+                   ((uint64_t)tx << 20) | (uint64_t)ty;
+    size_t tileFloats =
+        (size_t)tileSize * tileSize * tex.nChannels;
+
+    // Serve the texel straight from the memory mapping when available
+    if (tex.mapping) {
+        const Float *tileData =
+            (const Float *)(tex.mapping + lev.fileOffset +
+                            (uint64_t)(ty * lev.nTilesX + tx) * tileFloats *
+                                sizeof(Float));
+        const Float *texels = tileData + ((t - ty * tileSize) * tileSize +
+                                          (s - tx * tileSize)) *
+                                             tex.nChannels;
+        for (int c = 0; c < tex.nChannels; ++c) out[c] = texels[c];
+        return;
+    }
+
+    Shard &shard = shards[key % nShards];
+
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    auto iter = shard.tileMap.find(key);
+    if (iter == shard.tileMap.end()) {
+        if (threadNonBlocking) {
+            // Latency hiding: park the caller's work instead of
+            // stalling this worker on disk; the loader thread brings
+            // the tile in while other rays are shaded
+            lock.unlock();
+            threadTookFault = true;
+            {
+                std::lock_guard<std::mutex> loaderLock(loaderMutex);
+                if (!loaderThread.joinable())
+                    loaderThread =
+                        std::thread(&TiledTextureCache::LoaderThread, this);
+                if (queuedKeys.insert(key).second) {
+                    loadQueue.push_back(TileRequest{texId, level, tx, ty, key});
+                    ++loadsInFlight;
+                    loaderCondition.notify_one();
+                }
+            }
+            for (int c = 0; c < tex.nChannels; ++c) out[c] = 0;
+            return;
+        }
+        lock.unlock();
+        LoadTile(texId, level, tx, ty, key);
+        lock.lock();
+        iter = shard.tileMap.find(key);
+        if (iter == shard.tileMap.end())
+            Severe("Texture cache tile evicted immediately after load");
+    } else if (iter->second != shard.tiles.begin()) {
+        // Move the tile to the recently-used end of the list
+        shard.tiles.splice(shard.tiles.begin(), shard.tiles, iter->second);
+    }
+    const Float *texels =
+        &iter->second->texels[((t - ty * tileSize) * tileSize +
+                               (s - tx * tileSize)) *
+                              tex.nChannels];
+    for (int c = 0; c < tex.nChannels; ++c) out[c] = texels[c];
+}
+
+// Read one tile from its cache file and insert it into its shard,
+// evicting least recently used tiles past the shard's budget
+void TiledTextureCache::LoadTile(int texId, int level, int tx, int ty,
+                                 uint64_t key) {
+    ++texCacheMisses;
+    OpenTexture_ &tex = *textures[texId];
+    const TextureLevel &lev = tex.levels[level];
+    size_t tileFloats = (size_t)tileSize * tileSize * tex.nChannels;
+    Tile tile;
+    tile.key = key;
+    tile.texels.resize(tileFloats);
+    {
+        uint64_t offset = lev.fileOffset + (uint64_t)(ty * lev.nTilesX + tx) *
+                                               tileFloats * sizeof(Float);
+        std::lock_guard<std::mutex> fileLock(tex.fileMutex);
+        if (fseek(tex.file, offset, SEEK_SET) != 0 ||
+            fread(&tile.texels[0], sizeof(Float), tileFloats, tex.file) !=
+                tileFloats)
+            Severe("Error reading texture cache tile");
+    }
+    Shard &shard = shards[key % nShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.tileMap.find(key) != shard.tileMap.end()) return;
+    shard.tiles.push_front(std::move(tile));
+    shard.tileMap[key] = shard.tiles.begin();
+    shard.bytes += tileFloats * sizeof(Float);
+    texCacheBytes += tileFloats * sizeof(Float);
+    while (shard.bytes > shardBudget && shard.tiles.size() > 1) {
+        shard.tileMap.erase(shard.tiles.back().key);
+        size_t evicted = shard.tiles.back().texels.size() * sizeof(Float);
+        shard.bytes -= evicted;
+        texCacheBytes -= evicted;
+        shard.tiles.pop_back();
+    }
+}
+
+void TiledTextureCache::SetNonBlocking(bool enabled) {
+    threadNonBlocking = enabled;
+}
+
+bool TiledTextureCache::TookFault() {
+    bool fault = threadTookFault;
+    threadTookFault = false;
+    return fault;
+}
+
+void TiledTextureCache::LoaderThread() {
+    std::unique_lock<std::mutex> lock(loaderMutex);
+    while (!shutdownLoader) {
+        if (loadQueue.empty()) {
+            loaderCondition.wait(lock);
+            continue;
+        }
+        TileRequest request = loadQueue.front();
+        loadQueue.pop_front();
+        lock.unlock();
+        LoadTile(request.texId, request.level, request.tx, request.ty,
+                 request.key);
+        lock.lock();
+        queuedKeys.erase(request.key);
+        if (--loadsInFlight == 0) loadsDoneCondition.notify_all();
+    }
+}
+
+void TiledTextureCache::WaitForPendingLoads() {
+    std::unique_lock<std::mutex> lock(loaderMutex);
+    loadsDoneCondition.wait(lock, [this]() { return loadsInFlight == 0; });
+}
+
+bool TiledTextureCache::WriteCacheFile(
+    const std::string &filename, int nChannels,
+    const std::vector<Point2i> &levelRes,
+    const std::vector<const Float *> &levels) {
+    // Write to a temporary file and rename into place so a partial
+    // conversion is never mistaken for a valid cache file
+    std::string tmpName = filename + ".tmp";
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (!f) {
+        Warning("Unable to write texture cache file \"%s\"", tmpName.c_str());
+        return false;
+    }
+    TxcHeader header;
+    header.magic = txcMagic;
+    header.version = txcVersion;
+    header.floatSize = sizeof(Float);
+    header.nChannels = nChannels;
+    header.tileSize = tileSize;
+    header.nLevels = (uint32_t)levelRes.size();
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    // Lay out the per-level records, then write each level's tiles
+    uint64_t offset = sizeof(TxcHeader) +
+                      levelRes.size() * sizeof(TxcLevelRecord);
+    for (size_t i = 0; i < levelRes.size(); ++i) {
+        TxcLevelRecord record;
+        record.sRes = levelRes[i].x;
+        record.tRes = levelRes[i].y;
+        record.fileOffset = offset;
+        ok &= fwrite(&record, sizeof(record), 1, f) == 1;
+        int nTilesX = (levelRes[i].x + tileSize - 1) / tileSize;
+        int nTilesY = (levelRes[i].y + tileSize - 1) / tileSize;
+        offset += (uint64_t)nTilesX * nTilesY * tileSize * tileSize *
+                  nChannels * sizeof(Float);
+    }
+    std::vector<Float> tile((size_t)tileSize * tileSize * nChannels);
+    for (size_t i = 0; i < levelRes.size(); ++i) {
+        int sRes = levelRes[i].x, tRes = levelRes[i].y;
+        int nTilesX = (sRes + tileSize - 1) / tileSize;
+        int nTilesY = (tRes + tileSize - 1) / tileSize;
+        for (int ty = 0; ty < nTilesY; ++ty)
+            for (int tx = 0; tx < nTilesX; ++tx) {
+                std::fill(tile.begin(), tile.end(), (Float)0);
+                for (int t = 0; t < tileSize && ty * tileSize + t < tRes; ++t)
+                    for (int s = 0; s < tileSize && tx * tileSize + s < sRes;
+                         ++s)
+                        for (int c = 0; c < nChannels; ++c)
+                            tile[(t * tileSize + s) * nChannels + c] =
+                                levels[i][((ty * tileSize + t) * sRes +
+                                           tx * tileSize + s) *
+                                              nChannels +
+                                          c];
+                ok &= fwrite(&tile[0], sizeof(Float), tile.size(), f) ==
+                      tile.size();
+            }
+    }
+    fclose(f);
+    if (!ok || rename(tmpName.c_str(), filename.c_str()) != 0) {
+        Warning("Error writing texture cache file \"%s\"", filename.c_str());
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,145 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_TEXCACHE_H
+#define PBRT_CORE_TEXCACHE_H
+
+// core/texcache.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <set>
+#include <thread>
+#include <map>
+#include <mutex>
+#include <cstdio>
+
+// Tiled texture cache: textures converted to the tiled .txc layout are
+// read 64x64 tiles at a time, on demand, with resident tiles recycled
+// through a sharded LRU under the --texcachemb byte budget, so texture
+// memory tracks what rays actually touch rather than full MIP
+// pyramids.
+class TiledTextureCache {
+  public:
+    // TiledTextureCache Public Methods
+    static PBRT_CONSTEXPR int tileSize = 64;
+    // Returns the cache, or nullptr when no --texcachemb budget was set
+    static TiledTextureCache *GetInstance();
+
+    // Open a .txc file, validating _nChannels_ against its header;
+    // returns a texture id (or -1 on failure) and the texture's
+    // finest-level and per-level resolutions.
+    int OpenTexture(const std::string &filename, int nChannels,
+                    Point2i *resolution, std::vector<Point2i> *levelRes);
+    // Copy the channels of texel (s, t) of _level_ into _out_; (s, t)
+    // must be inside the level's resolution.
+    void GetTexel(int texId, int level, int s, int t, Float *out);
+
+    // Non-blocking mode for wavefront latency hiding: while enabled on
+    // the calling thread, a GetTexel() miss does not stall on disk --
+    // it queues an asynchronous load on the cache's loader thread,
+    // records the fault, and returns zeros.  The caller parks the work
+    // it was doing and retries after WaitForPendingLoads().
+    static void SetNonBlocking(bool enabled);
+    static bool TookFault();  // returns and clears the thread's flag
+    void WaitForPendingLoads();
+
+    // Write a .txc file for a fully built MIP pyramid; _levels_ holds
+    // per-level pointers to row-major texel channel data.
+    static bool WriteCacheFile(const std::string &filename, int nChannels,
+                               const std::vector<Point2i> &levelRes,
+                               const std::vector<const Float *> &levels);
+
+  private:
+    // TiledTextureCache Private Declarations
+    struct TextureLevel {
+        Point2i res;
+        int nTilesX;
+        uint64_t fileOffset;
+    };
+    struct OpenTexture_ {
+        FILE *file;
+        int nChannels;
+        std::vector<TextureLevel> levels;
+        std::mutex fileMutex;
+        // When the cache file could be memory-mapped, texels are read
+        // straight from the mapping (residency is then page-fault
+        // driven) and the LRU tile path is bypassed.
+        const char *mapping = nullptr;
+        size_t mappingSize = 0;
+    };
+    struct Tile {
+        uint64_t key;
+        std::vector<Float> texels;
+    };
+    static PBRT_CONSTEXPR int nShards = 64;
+    struct Shard {
+        std::mutex mutex;
+        std::list<Tile> tiles;  // front is most recently used
+        std::map<uint64_t, std::list<Tile>::iterator> tileMap;
+        size_t bytes = 0;
+    };
+
+    // TiledTextureCache Private Methods
+    TiledTextureCache(size_t budgetBytes) : shardBudget(budgetBytes / nShards) {}
+    ~TiledTextureCache();
+    void LoadTile(int texId, int level, int tx, int ty, uint64_t key);
+    void LoaderThread();
+
+    // TiledTextureCache Private Data
+    size_t shardBudget;
+    std::vector<std::unique_ptr<OpenTexture_>> textures;
+    std::mutex texturesMutex;
+    Shard shards[nShards];
+
+    // Asynchronous tile loading (see SetNonBlocking)
+    struct TileRequest {
+        int texId, level, tx, ty;
+        uint64_t key;
+    };
+    std::thread loaderThread;
+    std::mutex loaderMutex;
+    std::condition_variable loaderCondition, loadsDoneCondition;
+    std::deque<TileRequest> loadQueue;
+    std::set<uint64_t> queuedKeys;
+    int loadsInFlight = 0;
+    bool shutdownLoader = false;
+};
+
+#endif  // PBRT_CORE_TEXCACHE_H
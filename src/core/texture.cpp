@@ -41,6 +41,11 @@ inline Float SmoothStep(Float min, Float max, Float value) {
     return v * v * (-2 * v + 3);
 }
 
+#if defined(__AVX2__) && !defined(PBRT_FLOAT_AS_DOUBLE)
+#include <immintrin.h>
+#define PBRT_TEXTURE_HAVE_AVX2
+#endif
+
 // Texture Forward Declarations
 inline Float Grad(int x, int y, int z, Float dx, Float dy, Float dz);
 inline Float NoiseWeight(Float t);
@@ -203,6 +208,124 @@ inline Float NoiseWeight(Float t) {
     return 6 * t4 * t - 15 * t4 + 10 * t3;
 }
 
+// Per-thread memoization for FBm() and Turbulence(): displacement-heavy
+// shaders evaluate the same shading points repeatedly across bounces,
+// so a small direct-mapped cache keyed on the evaluation point and
+// octave parameters short-circuits the whole octave loop on a repeat.
+// The tables are zero-initialized; key 0 marks an empty entry.
+struct NoiseCacheEntry {
+    uint64_t key;
+    Float value;
+};
+static PBRT_CONSTEXPR int noiseCacheSize = 1024;  // must be a power of 2
+static PBRT_THREAD_LOCAL NoiseCacheEntry fbmCache[noiseCacheSize];
+static PBRT_THREAD_LOCAL NoiseCacheEntry turbulenceCache[noiseCacheSize];
+
+static inline uint64_t NoiseCacheKey(const Point3f &p, Float omega, Float n) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t v) {
+        hash ^= v;
+        hash *= 1099511628211ull;
+    };
+    mix(FloatToBits((float)p.x));
+    mix(FloatToBits((float)p.y));
+    mix(FloatToBits((float)p.z));
+    mix(FloatToBits((float)omega));
+    mix(FloatToBits((float)n));
+    return hash ? hash : 1;
+}
+
+#ifdef PBRT_TEXTURE_HAVE_AVX2
+// Evaluate Noise() for eight independent points held in vector lanes
+static inline __m256 NoiseAVX(__m256 x, __m256 y, __m256 z) {
+    // Compute noise cell coordinates and offsets
+    __m256 fx = _mm256_floor_ps(x), fy = _mm256_floor_ps(y),
+           fz = _mm256_floor_ps(z);
+    __m256 dx = _mm256_sub_ps(x, fx), dy = _mm256_sub_ps(y, fy),
+           dz = _mm256_sub_ps(z, fz);
+    const __m256i permMask = _mm256_set1_epi32(NoisePermSize - 1);
+    __m256i ix = _mm256_and_si256(_mm256_cvtps_epi32(fx), permMask);
+    __m256i iy = _mm256_and_si256(_mm256_cvtps_epi32(fy), permMask);
+    __m256i iz = _mm256_and_si256(_mm256_cvtps_epi32(fz), permMask);
+
+    // Compute gradient weights (vector version of Grad())
+    const __m256 one = _mm256_set1_ps(1.f);
+    auto grad = [&](__m256i gx, __m256i gy, __m256i gz, __m256 gdx,
+                    __m256 gdy, __m256 gdz) {
+        __m256i h = _mm256_i32gather_epi32(NoisePerm, gx, 4);
+        h = _mm256_i32gather_epi32(NoisePerm, _mm256_add_epi32(h, gy), 4);
+        h = _mm256_i32gather_epi32(NoisePerm, _mm256_add_epi32(h, gz), 4);
+        h = _mm256_and_si256(h, _mm256_set1_epi32(15));
+        __m256i eq1213 = _mm256_or_si256(
+            _mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+            _mm256_cmpeq_epi32(h, _mm256_set1_epi32(13)));
+        __m256 selU = _mm256_castsi256_ps(_mm256_or_si256(
+            _mm256_cmpgt_epi32(_mm256_set1_epi32(8), h), eq1213));
+        __m256 selV = _mm256_castsi256_ps(_mm256_or_si256(
+            _mm256_cmpgt_epi32(_mm256_set1_epi32(4), h), eq1213));
+        __m256 u = _mm256_blendv_ps(gdy, gdx, selU);
+        __m256 v = _mm256_blendv_ps(gdz, gdy, selV);
+        // Flip signs where bits 0 and 1 of _h_ are set
+        u = _mm256_xor_ps(u, _mm256_castsi256_ps(_mm256_slli_epi32(
+                                 _mm256_and_si256(h, _mm256_set1_epi32(1)),
+                                 31)));
+        v = _mm256_xor_ps(v, _mm256_castsi256_ps(_mm256_slli_epi32(
+                                 _mm256_and_si256(h, _mm256_set1_epi32(2)),
+                                 30)));
+        return _mm256_add_ps(u, v);
+    };
+    const __m256i oneI = _mm256_set1_epi32(1);
+    __m256i ix1 = _mm256_add_epi32(ix, oneI), iy1 = _mm256_add_epi32(iy, oneI),
+            iz1 = _mm256_add_epi32(iz, oneI);
+    __m256 dx1 = _mm256_sub_ps(dx, one), dy1 = _mm256_sub_ps(dy, one),
+           dz1 = _mm256_sub_ps(dz, one);
+    __m256 w000 = grad(ix, iy, iz, dx, dy, dz);
+    __m256 w100 = grad(ix1, iy, iz, dx1, dy, dz);
+    __m256 w010 = grad(ix, iy1, iz, dx, dy1, dz);
+    __m256 w110 = grad(ix1, iy1, iz, dx1, dy1, dz);
+    __m256 w001 = grad(ix, iy, iz1, dx, dy, dz1);
+    __m256 w101 = grad(ix1, iy, iz1, dx1, dy, dz1);
+    __m256 w011 = grad(ix, iy1, iz1, dx, dy1, dz1);
+    __m256 w111 = grad(ix1, iy1, iz1, dx1, dy1, dz1);
+
+    // Compute trilinear interpolation of weights (vector NoiseWeight())
+    auto noiseWeight = [&](__m256 t) {
+        __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+        __m256 t4 = _mm256_mul_ps(t3, t);
+        return _mm256_fmadd_ps(
+            _mm256_mul_ps(_mm256_set1_ps(6.f), t4), t,
+            _mm256_fmadd_ps(_mm256_set1_ps(-15.f), t4,
+                            _mm256_mul_ps(_mm256_set1_ps(10.f), t3)));
+    };
+    __m256 wx = noiseWeight(dx), wy = noiseWeight(dy), wz = noiseWeight(dz);
+    auto lerp = [&](__m256 t, __m256 a, __m256 b) {
+        return _mm256_fmadd_ps(t, _mm256_sub_ps(b, a), a);
+    };
+    __m256 x00 = lerp(wx, w000, w100);
+    __m256 x10 = lerp(wx, w010, w110);
+    __m256 x01 = lerp(wx, w001, w101);
+    __m256 x11 = lerp(wx, w011, w111);
+    __m256 y0 = lerp(wy, x00, x10);
+    __m256 y1 = lerp(wy, x01, x11);
+    return lerp(wz, y0, y1);
+}
+
+// Fill out[i] = Noise(1.99^i * p) for i < nOctaves (nOctaves <= 8),
+// evaluating all octaves together in vector registers
+static inline void NoiseOctaves(const Point3f &p, int nOctaves, Float *out) {
+    Float lambda[8];
+    lambda[0] = 1;
+    for (int i = 1; i < 8; ++i) lambda[i] = lambda[i - 1] * 1.99f;
+    __m256 l = _mm256_loadu_ps(lambda);
+    __m256 n = NoiseAVX(_mm256_mul_ps(_mm256_set1_ps(p.x), l),
+                        _mm256_mul_ps(_mm256_set1_ps(p.y), l),
+                        _mm256_mul_ps(_mm256_set1_ps(p.z), l));
+    Float lanes[8];
+    _mm256_storeu_ps(lanes, n);
+    for (int i = 0; i < nOctaves; ++i) out[i] = lanes[i];
+}
+#endif  // PBRT_TEXTURE_HAVE_AVX2
+
 Float FBm(const Point3f &p, const Vector3f &dpdx, const Vector3f &dpdy,
           Float omega, int maxOctaves) {
     // Compute number of octaves for antialiased FBm
@@ -210,15 +333,37 @@ Float FBm(const Point3f &p, const Vector3f &dpdx, const Vector3f &dpdy,
     Float n = Clamp(-1 - .5f * Log2(len2), 0, maxOctaves);
     int nInt = std::floor(n);
 
+    // Return a memoized value if this point was evaluated recently
+    uint64_t key = NoiseCacheKey(p, omega, n);
+    NoiseCacheEntry &entry = fbmCache[key & (noiseCacheSize - 1)];
+    if (entry.key == key) return entry.value;
+
     // Compute sum of octaves of noise for FBm
-    Float sum = 0, lambda = 1, o = 1;
-    for (int i = 0; i < nInt; ++i) {
-        sum += o * Noise(lambda * p);
-        lambda *= 1.99f;
-        o *= omega;
+    Float sum = 0, o = 1;
+#ifdef PBRT_TEXTURE_HAVE_AVX2
+    if (nInt < 8) {
+        Float noise[8];
+        NoiseOctaves(p, nInt + 1, noise);
+        for (int i = 0; i < nInt; ++i) {
+            sum += o * noise[i];
+            o *= omega;
+        }
+        Float nPartial = n - nInt;
+        sum += o * SmoothStep(.3f, .7f, nPartial) * noise[nInt];
+    } else
+#endif  // PBRT_TEXTURE_HAVE_AVX2
+    {
+        Float lambda = 1;
+        for (int i = 0; i < nInt; ++i) {
+            sum += o * Noise(lambda * p);
+            lambda *= 1.99f;
+            o *= omega;
+        }
+        Float nPartial = n - nInt;
+        sum += o * SmoothStep(.3f, .7f, nPartial) * Noise(lambda * p);
     }
-    Float nPartial = n - nInt;
-    sum += o * SmoothStep(.3f, .7f, nPartial) * Noise(lambda * p);
+    entry.key = key;
+    entry.value = sum;
     return sum;
 }
 
@@ -229,18 +374,39 @@ Float Turbulence(const Point3f &p, const Vector3f &dpdx, const Vector3f &dpdy,
     Float n = Clamp(-1 - .5f * Log2(len2), 0, maxOctaves);
     int nInt = std::floor(n);
 
+    // Return a memoized value if this point was evaluated recently
+    uint64_t key = NoiseCacheKey(p, omega, n + maxOctaves);
+    NoiseCacheEntry &entry = turbulenceCache[key & (noiseCacheSize - 1)];
+    if (entry.key == key) return entry.value;
+
     // Compute sum of octaves of noise for turbulence
-    Float sum = 0, lambda = 1, o = 1;
-    for (int i = 0; i < nInt; ++i) {
-        sum += o * std::abs(Noise(lambda * p));
-        lambda *= 1.99f;
-        o *= omega;
-    }
+    Float sum = 0, o = 1;
+#ifdef PBRT_TEXTURE_HAVE_AVX2
+    if (nInt < 8) {
+        Float noise[8];
+        NoiseOctaves(p, nInt + 1, noise);
+        for (int i = 0; i < nInt; ++i) {
+            sum += o * std::abs(noise[i]);
+            o *= omega;
+        }
+        Float nPartial = n - nInt;
+        sum += o * Lerp(SmoothStep(.3f, .7f, nPartial), 0.2,
+                        std::abs(noise[nInt]));
+    } else
+#endif  // PBRT_TEXTURE_HAVE_AVX2
+    {
+        Float lambda = 1;
+        for (int i = 0; i < nInt; ++i) {
+            sum += o * std::abs(Noise(lambda * p));
+            lambda *= 1.99f;
+            o *= omega;
+        }
 
-    // Account for contributions of clamped octaves in turbulence
-    Float nPartial = n - nInt;
-    sum += o * Lerp(SmoothStep(.3f, .7f, nPartial), 0.2,
-                    std::abs(Noise(lambda * p)));
+        // Account for contributions of clamped octaves in turbulence
+        Float nPartial = n - nInt;
+        sum += o * Lerp(SmoothStep(.3f, .7f, nPartial), 0.2,
+                        std::abs(Noise(lambda * p)));
+    }
     for (int i = nInt; i < maxOctaves; ++i) {
         sum += o * 0.2f;
         o *= omega;
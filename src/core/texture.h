@@ -134,6 +134,19 @@ class Texture {
   public:
     // Texture Interface
     virtual T Evaluate(const SurfaceInteraction &) const = 0;
+    // Whether this texture's evaluation reads the interaction's ray
+    // differentials; constant textures override this so materials
+    // bound only to constants can skip ComputeDifferentials()
+    virtual bool NeedsDifferentials() const { return true; }
+    // Evaluate the texture for a wavefront of interactions at once,
+    // writing out[i] for si[i].  Textures with memory locality to
+    // exploit (notably image maps) override this to reorder the
+    // requests so lookups stream through their storage; the default
+    // just evaluates in the order given.
+    virtual void EvaluateBatch(const SurfaceInteraction *const *si, int n,
+                               T *out) const {
+        for (int i = 0; i < n; ++i) out[i] = Evaluate(*si[i]);
+    }
     virtual ~Texture() {}
 };
 
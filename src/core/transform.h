@@ -403,12 +403,17 @@ class AnimatedTransform {
     }
     Bounds3f MotionBounds(const Bounds3f &b) const;
     Bounds3f BoundPointMotion(const Point3f &p) const;
+    Float StartTime() const { return startTime; }
+    Float EndTime() const { return endTime; }
+    bool IsAnimated() const { return actuallyAnimated; }
 
   private:
     // AnimatedTransform Private Data
+    // (non-const so that AnimatedTransforms are assignable, which lets
+    // retained primitives be retargeted between frames)
     const Transform *startTransform, *endTransform;
-    const Float startTime, endTime;
-    const bool actuallyAnimated;
+    Float startTime, endTime;
+    bool actuallyAnimated;
     Vector3f T[2];
     Quaternion R[2];
     Matrix4x4 S[2];
@@ -46,6 +46,7 @@ class BoxFilter : public Filter {
   public:
     BoxFilter(const Vector2f &radius) : Filter(radius) {}
     Float Evaluate(const Point2f &p) const;
+    bool IsBox() const { return true; }
 };
 
 BoxFilter *CreateBoxFilter(const ParamSet &ps);
@@ -37,6 +37,7 @@
 #include "sampler.h"
 #include "integrator.h"
 #include "stats.h"
+#include "distributed.h"
 #include "filters/box.h"
 #include "paramset.h"
 #include "progressreporter.h"
@@ -284,6 +285,9 @@ void BDPTIntegrator::Render(const Scene &scene) {
 
     // Partition the image into tiles
     Film *film = camera->film;
+    // Light-subpath splats from every tile share pixels; stripe the
+    // splat sums to divide CAS contention
+    film->EnableSplatStriping();
     const Bounds2i sampleBounds = film->GetSampleBounds();
     const Vector2i sampleExtent = sampleBounds.Diagonal();
     const int tileSize = 16;
@@ -317,6 +321,8 @@ void BDPTIntegrator::Render(const Scene &scene) {
     if (scene.lights.size() > 0) {
         StatTimer timer(&renderingTime);
         ParallelFor2D([&](const Point2i tile) {
+            if (!DistClaimWorkUnit("bdpt-tile", tile.y * nXTiles + tile.x))
+                return;
             // Render a single tile using BDPT
             MemoryArena arena;
             int seed = tile.y * nXTiles + tile.x;
@@ -328,6 +334,31 @@ void BDPTIntegrator::Render(const Scene &scene) {
             Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
             std::unique_ptr<FilmTile> filmTile =
                 camera->film->GetFilmTile(tileBounds);
+
+            // With a light-vertex pool, trace the tile's shared light
+            // subpaths once up front; camera subpaths then connect
+            // against pool paths round-robin instead of each sample
+            // paying for a fresh light subpath.  Pool paths are drawn
+            // from their own sampler stream, so a camera subpath and
+            // its pool partner stay independent and every estimate
+            // remains unbiased (samples become correlated across
+            // pixels, which vanishes as pool use rotates).
+            MemoryArena poolArena;
+            std::vector<Vertex *> poolVertices(lightVertexPool);
+            std::vector<int> poolCounts(lightVertexPool);
+            if (lightVertexPool > 0) {
+                std::unique_ptr<Sampler> poolSampler =
+                    sampler->Clone(seed + nXTiles * nYTiles);
+                poolSampler->StartPixel(tileBounds.pMin);
+                for (int i = 0; i < lightVertexPool; ++i) {
+                    poolVertices[i] = poolArena.Alloc<Vertex>(maxDepth + 1);
+                    poolCounts[i] = GenerateLightSubpath(
+                        scene, *poolSampler, poolArena, maxDepth + 1,
+                        camera->shutterOpen, *lightDistr, poolVertices[i]);
+                    poolSampler->StartNextSample();
+                }
+            }
+            int64_t poolNext = 0;
             for (Point2i pPixel : tileBounds) {
                 tileSampler->StartPixel(pPixel);
                 do {
@@ -340,9 +371,16 @@ void BDPTIntegrator::Render(const Scene &scene) {
                     int nCamera = GenerateCameraSubpath(
                         scene, *tileSampler, arena, maxDepth + 2, *camera,
                         pFilm, cameraVertices);
-                    int nLight = GenerateLightSubpath(
-                        scene, *tileSampler, arena, maxDepth + 1,
-                        cameraVertices[0].time(), *lightDistr, lightVertices);
+                    int nLight;
+                    if (lightVertexPool > 0) {
+                        int poolIndex = poolNext++ % lightVertexPool;
+                        lightVertices = poolVertices[poolIndex];
+                        nLight = poolCounts[poolIndex];
+                    } else
+                        nLight = GenerateLightSubpath(
+                            scene, *tileSampler, arena, maxDepth + 1,
+                            cameraVertices[0].time(), *lightDistr,
+                            lightVertices);
 
                     // Execute all BDPT connection strategies
                     Spectrum L(0.f);
@@ -384,13 +422,18 @@ void BDPTIntegrator::Render(const Scene &scene) {
         }, Point2i(nXTiles, nYTiles));
         reporter.Done();
     }
-    film->WriteImage(1.0f / sampler->samplesPerPixel);
+    film->FlushSplats();
+    if (DistFinishFilm(film))
+        film->WriteImage(1.0f / sampler->samplesPerPixel);
 
     // Write buffers for debug visualization
     if (visualizeStrategies || visualizeWeights) {
         const Float invSampleCount = 1.0f / sampler->samplesPerPixel;
         for (size_t i = 0; i < weightFilms.size(); ++i)
-            if (weightFilms[i]) weightFilms[i]->WriteImage(invSampleCount);
+            if (weightFilms[i]) {
+                weightFilms[i]->FlushSplats();
+                weightFilms[i]->WriteImage(invSampleCount);
+            }
     }
 }
 
@@ -486,6 +529,7 @@ BDPTIntegrator *CreateBDPTIntegrator(const ParamSet &params,
         maxDepth = 5;
     }
 
+    int lightVertexPool = params.FindOneInt("lightvertexpool", 0);
     return new BDPTIntegrator(sampler, camera, maxDepth, visualizeStrategies,
-                              visualizeWeights);
+                              visualizeWeights, lightVertexPool);
 }
@@ -119,12 +119,14 @@ class BDPTIntegrator : public Integrator {
     // BDPTIntegrator Public Methods
     BDPTIntegrator(std::shared_ptr<Sampler> sampler,
                    std::shared_ptr<const Camera> camera, int maxDepth,
-                   bool visualizeStrategies, bool visualizeWeights)
+                   bool visualizeStrategies, bool visualizeWeights,
+                   int lightVertexPool = 0)
         : sampler(sampler),
           camera(camera),
           maxDepth(maxDepth),
           visualizeStrategies(visualizeStrategies),
-          visualizeWeights(visualizeWeights) {}
+          visualizeWeights(visualizeWeights),
+          lightVertexPool(lightVertexPool) {}
     void Render(const Scene &scene);
 
   private:
@@ -134,6 +136,9 @@ class BDPTIntegrator : public Integrator {
     const int maxDepth;
     const bool visualizeStrategies;
     const bool visualizeWeights;
+    // Number of shared light subpaths traced per tile (0 = one fresh
+    // subpath per camera sample, the classic behavior)
+    const int lightVertexPool;
 };
 
 struct Vertex {
@@ -35,11 +35,23 @@
 #include "integrators/directlighting.h"
 #include "interaction.h"
 #include "paramset.h"
+#include "camera.h"
+#include "film.h"
+#include "progressreporter.h"
 #include "stats.h"
+#include <algorithm>
+
+// UV tolerance within which successive primary hits share one BSDF
+// evaluation ("shadingreuse")
+static PBRT_CONSTEXPR Float reuseUVTolerance = 1e-3f;
 
 // DirectLightingIntegrator Method Definitions
 void DirectLightingIntegrator::Preprocess(const Scene &scene,
                                           Sampler &sampler) {
+    if (lightCulling && !cullDistribution)
+        cullDistribution.reset(new SpatialLightDistribution(scene));
+    if (strategy == LightStrategy::Lightcuts && !lightTree)
+        lightTree.reset(new LightTree(scene.lights));
     if (strategy == LightStrategy::UniformSampleAll) {
         // Compute number of samples to use for each light
         for (const auto &light : scene.lights)
@@ -67,8 +79,12 @@ Spectrum DirectLightingIntegrator::Li(const RayDifferential &ray,
         return L;
     }
 
-    // Compute scattering functions for surface interaction
-    isect.ComputeScatteringFunctions(ray, arena);
+    // Compute scattering functions for surface interaction, reusing
+    // the pixel's previous primary-hit evaluation when enabled
+    if (shadingReuse && depth == 0)
+        ComputeOrReusePrimaryShading(&isect, ray, reuseUVTolerance);
+    else
+        isect.ComputeScatteringFunctions(ray, arena);
     if (!isect.bsdf)
         return Li(isect.SpawnRay(ray.d), scene, sampler, arena, depth);
     Vector3f wo = isect.wo;
@@ -77,8 +93,13 @@ Spectrum DirectLightingIntegrator::Li(const RayDifferential &ray,
     if (scene.lights.size() > 0) {
         // Compute direct lighting for _DirectLightingIntegrator_ integrator
         if (strategy == LightStrategy::UniformSampleAll)
-            L += UniformSampleAllLights(isect, scene, arena, sampler,
-                                        nLightSamples);
+            L += UniformSampleAllLights(
+                isect, scene, arena, sampler, nLightSamples, false,
+                cullDistribution ? cullDistribution->CulledLights(isect.p)
+                                 : nullptr);
+        else if (strategy == LightStrategy::Lightcuts)
+            L += lightTree->ShadeLightcut(isect, scene, arena, sampler,
+                                          cutErrorThreshold, maxCutSize);
         else
             L += UniformSampleOneLight(isect, scene, arena, sampler);
     }
@@ -91,6 +112,136 @@ Spectrum DirectLightingIntegrator::Li(const RayDifferential &ray,
     return L;
 }
 
+// Shade one already-found first hit: emitted light, the configured
+// direct lighting strategy, and the specular recursion from Li()
+Spectrum DirectLightingIntegrator::ShadeHit(const RayDifferential &ray,
+                                            SurfaceInteraction &isect,
+                                            const Scene &scene,
+                                            Sampler &sampler,
+                                            MemoryArena &arena) const {
+    isect.ComputeScatteringFunctions(ray, arena);
+    if (!isect.bsdf)
+        return Li(isect.SpawnRay(ray.d), scene, sampler, arena, 0);
+    Spectrum L = isect.Le(isect.wo);
+    if (scene.lights.size() > 0) {
+        if (strategy == LightStrategy::UniformSampleAll)
+            L += UniformSampleAllLights(
+                isect, scene, arena, sampler, nLightSamples, false,
+                cullDistribution ? cullDistribution->CulledLights(isect.p)
+                                 : nullptr);
+        else if (strategy == LightStrategy::Lightcuts)
+            L += lightTree->ShadeLightcut(isect, scene, arena, sampler,
+                                          cutErrorThreshold, maxCutSize);
+        else
+            L += UniformSampleOneLight(isect, scene, arena, sampler);
+    }
+    if (1 < maxDepth) {
+        L += SpecularReflect(ray, isect, scene, sampler, arena, 0);
+        L += SpecularTransmit(ray, isect, scene, sampler, arena, 0);
+    }
+    return L;
+}
+
+void DirectLightingIntegrator::Render(const Scene &scene) {
+    if (!deferred) {
+        SamplerIntegrator::Render(scene);
+        return;
+    }
+    RenderDeferred(scene);
+}
+
+void DirectLightingIntegrator::RenderDeferred(const Scene &scene) {
+    ProfilePhase p(Prof::IntegratorRender);
+    Preprocess(scene, *sampler);
+    Bounds2i sampleBounds = camera->film->GetSampleBounds();
+    Vector2i sampleExtent = sampleBounds.Diagonal();
+    const int tileSize = 16;
+    Point2i nTiles((sampleExtent.x + tileSize - 1) / tileSize,
+                   (sampleExtent.y + tileSize - 1) / tileSize);
+    ProgressReporter reporter(nTiles.x * nTiles.y, "Rendering");
+    ParallelFor2D([&](Point2i tile) {
+        MemoryArena arena;
+        int x0 = sampleBounds.pMin.x + tile.x * tileSize;
+        int x1 = std::min(x0 + tileSize, sampleBounds.pMax.x);
+        int y0 = sampleBounds.pMin.y + tile.y * tileSize;
+        int y1 = std::min(y0 + tileSize, sampleBounds.pMax.y);
+        Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
+        int nPixels = std::max(0, tileBounds.Area());
+        if (nPixels == 0) return;
+        std::unique_ptr<FilmTile> filmTile =
+            camera->film->GetFilmTile(tileBounds);
+        int seed = tile.y * nTiles.x + tile.x;
+
+        // One sampler per pixel so the tile's pixels advance in
+        // lockstep, one deferred batch per sample index
+        std::vector<std::unique_ptr<Sampler>> samplers(nPixels);
+        std::vector<Point2i> pixels(nPixels);
+        {
+            int i = 0;
+            for (Point2i pixel : tileBounds) {
+                samplers[i] = sampler->Clone(seed * nPixels + i);
+                samplers[i]->StartPixel(pixel);
+                pixels[i] = pixel;
+                ++i;
+            }
+        }
+        std::vector<RayDifferential> rays(nPixels);
+        std::vector<SurfaceInteraction> isects(nPixels);
+        std::vector<CameraSample> cameraSamples(nPixels);
+        std::vector<Float> rayWeights(nPixels);
+        std::vector<char> hits(nPixels);
+        std::vector<int> order;
+        bool samplesLeft = true;
+        while (samplesLeft) {
+            // Intersect the batch's camera rays
+            for (int i = 0; i < nPixels; ++i) {
+                cameraSamples[i] = samplers[i]->GetCameraSample(pixels[i]);
+                rayWeights[i] = camera->GenerateRayDifferential(
+                    cameraSamples[i], &rays[i]);
+                rays[i].ScaleDifferentials(
+                    1 / std::sqrt((Float)samplers[i]->samplesPerPixel));
+                hits[i] = rayWeights[i] > 0 &&
+                          scene.Intersect(rays[i], &isects[i]);
+            }
+
+            // Shade the hits sorted by (material, primitive)
+            order.clear();
+            for (int i = 0; i < nPixels; ++i)
+                if (hits[i]) order.push_back(i);
+            std::sort(order.begin(), order.end(), [&](int a, int b) {
+                const Material *ma = isects[a].primitive->GetMaterial();
+                const Material *mb = isects[b].primitive->GetMaterial();
+                if (ma != mb) return ma < mb;
+                return isects[a].primitive < isects[b].primitive;
+            });
+            std::vector<Spectrum> L(nPixels, Spectrum(0.f));
+            for (int i : order)
+                L[i] = ShadeHit(rays[i], isects[i], scene, *samplers[i],
+                                arena);
+
+            // Escaped rays see the scene's infinite lights
+            for (int i = 0; i < nPixels; ++i)
+                if (!hits[i] && rayWeights[i] > 0)
+                    for (const auto &light : scene.lights)
+                        L[i] += light->Le(rays[i]);
+
+            // Deposit the batch and advance the samplers
+            samplesLeft = false;
+            for (int i = 0; i < nPixels; ++i) {
+                filmTile->AddSample(cameraSamples[i].pFilm, L[i],
+                                    rayWeights[i]);
+                if (samplers[i]->StartNextSample()) samplesLeft = true;
+            }
+            arena.Reset();
+        }
+        camera->film->MergeFilmTile(std::move(filmTile));
+        reporter.Update();
+    }, nTiles);
+    reporter.Done();
+    camera->film->FlushSplats();
+    camera->film->WriteImage();
+}
+
 DirectLightingIntegrator *CreateDirectLightingIntegrator(
     const ParamSet &params, std::shared_ptr<Sampler> sampler,
     std::shared_ptr<const Camera> camera) {
@@ -101,6 +252,8 @@ DirectLightingIntegrator *CreateDirectLightingIntegrator(
         strategy = LightStrategy::UniformSampleOne;
     else if (st == "all")
         strategy = LightStrategy::UniformSampleAll;
+    else if (st == "lightcuts")
+        strategy = LightStrategy::Lightcuts;
     else {
         Warning(
             "Strategy \"%s\" for direct lighting unknown. "
@@ -108,5 +261,9 @@ DirectLightingIntegrator *CreateDirectLightingIntegrator(
             st.c_str());
         strategy = LightStrategy::UniformSampleAll;
     }
-    return new DirectLightingIntegrator(strategy, maxDepth, camera, sampler);
+    bool deferred = params.FindOneBool("deferred", false);
+    bool lightCulling = params.FindOneBool("lightculling", false);
+    bool shadingReuse = params.FindOneBool("shadingreuse", false);
+    return new DirectLightingIntegrator(strategy, maxDepth, camera, sampler,
+                                        deferred, lightCulling, shadingReuse);
 }
@@ -42,9 +42,11 @@
 #include "pbrt.h"
 #include "integrator.h"
 #include "scene.h"
+#include "lightdistrib.h"
+#include "lighttree.h"
 
 // LightStrategy Declarations
-enum class LightStrategy { UniformSampleAll, UniformSampleOne };
+enum class LightStrategy { UniformSampleAll, UniformSampleOne, Lightcuts };
 
 // DirectLightingIntegrator Declarations
 class DirectLightingIntegrator : public SamplerIntegrator {
@@ -52,18 +54,44 @@ class DirectLightingIntegrator : public SamplerIntegrator {
     // DirectLightingIntegrator Public Methods
     DirectLightingIntegrator(LightStrategy strategy, int maxDepth,
                              std::shared_ptr<const Camera> camera,
-                             std::shared_ptr<Sampler> sampler)
+                             std::shared_ptr<Sampler> sampler,
+                             bool deferred = false, bool lightCulling = false,
+                             bool shadingReuse = false)
         : SamplerIntegrator(camera, sampler),
           strategy(strategy),
-          maxDepth(maxDepth) {}
+          maxDepth(maxDepth),
+          deferred(deferred),
+          lightCulling(lightCulling),
+          shadingReuse(shadingReuse) {}
     Spectrum Li(const RayDifferential &ray, const Scene &scene,
                 Sampler &sampler, MemoryArena &arena, int depth) const;
     void Preprocess(const Scene &scene, Sampler &sampler);
+    void Render(const Scene &scene);
 
   private:
+    // DirectLightingIntegrator Private Methods
+    void RenderDeferred(const Scene &scene);
+    Spectrum ShadeHit(const RayDifferential &ray, SurfaceInteraction &isect,
+                      const Scene &scene, Sampler &sampler,
+                      MemoryArena &arena) const;
+
     // DirectLightingIntegrator Private Data
     const LightStrategy strategy;
+    const bool shadingReuse = false;
     const int maxDepth;
+    // Deferred first-hit mode: intersect a tile's camera rays up
+    // front, then shade the hits sorted by (material, primitive) for
+    // instruction- and texture-cache coherence
+    const bool deferred;
+    // Regional light culling ("lightculling") for the all-lights
+    // strategy: per-voxel reduced light lists from the spatial light
+    // distribution
+    const bool lightCulling;
+    std::unique_ptr<SpatialLightDistribution> cullDistribution;
+    // Lightcuts state (strategy \"lightcuts\")
+    std::unique_ptr<LightTree> lightTree;
+    Float cutErrorThreshold = 0.02f;
+    int maxCutSize = 64;
     std::vector<int> nLightSamples;
 };
 
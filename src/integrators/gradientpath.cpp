@@ -0,0 +1,192 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// integrators/gradientpath.cpp*
+#include "integrators/gradientpath.h"
+#include "scene.h"
+#include "camera.h"
+#include "film.h"
+#include "sampler.h"
+#include "paramset.h"
+#include "progressreporter.h"
+#include "parallel.h"
+#include "stats.h"
+#include "imageio.h"
+
+STAT_TIMER("Time/Rendering", gradientRenderingTime);
+
+// GradientPathIntegrator Method Definitions
+void GradientPathIntegrator::Render(const Scene &scene) {
+    ProfilePhase prof(Prof::IntegratorRender);
+    Bounds2i pixelBounds = camera->film->croppedPixelBounds;
+    Vector2i extent = pixelBounds.Diagonal();
+    int nPixels = pixelBounds.Area();
+    if (nPixels == 0) return;
+
+    // Primal and forward-difference gradient planes, box filtered
+    std::vector<Spectrum> primal(nPixels), dx(nPixels), dy(nPixels);
+
+    const int tileSize = 16;
+    Point2i nTiles((extent.x + tileSize - 1) / tileSize,
+                   (extent.y + tileSize - 1) / tileSize);
+    ProgressReporter reporter(nTiles.x * nTiles.y, "Rendering");
+    {
+        StatTimer timer(&gradientRenderingTime);
+        ParallelFor2D([&](Point2i tile) {
+            MemoryArena arena;
+            int x0 = pixelBounds.pMin.x + tile.x * tileSize;
+            int x1 = std::min(x0 + tileSize, pixelBounds.pMax.x);
+            int y0 = pixelBounds.pMin.y + tile.y * tileSize;
+            int y1 = std::min(y0 + tileSize, pixelBounds.pMax.y);
+            int seed = tile.y * nTiles.x + tile.x;
+            std::unique_ptr<Sampler> tileSampler = sampler->Clone(seed);
+            for (int py = y0; py < y1; ++py)
+                for (int px = x0; px < x1; ++px) {
+                    Point2i pixel(px, py);
+                    tileSampler->StartPixel(pixel);
+                    Spectrum sumP(0.f), sumDx(0.f), sumDy(0.f);
+                    do {
+                        // Trace the base path and the +x/+y offset
+                        // paths with the same primary sample sequence
+                        int64_t sampleNum =
+                            tileSampler->CurrentSampleNumber();
+                        CameraSample cs =
+                            tileSampler->GetCameraSample(pixel);
+                        Spectrum L[3];
+                        for (int k = 0; k < 3; ++k) {
+                            if (k > 0) {
+                                // Replay the sample's sequence for the
+                                // shifted path
+                                tileSampler->SetSampleNumber(sampleNum);
+                                tileSampler->GetCameraSample(pixel);
+                            }
+                            CameraSample shifted = cs;
+                            if (k == 1) shifted.pFilm.x += 1;
+                            if (k == 2) shifted.pFilm.y += 1;
+                            RayDifferential ray;
+                            Float rayWeight =
+                                camera->GenerateRayDifferential(shifted,
+                                                                &ray);
+                            ray.ScaleDifferentials(
+                                1 / std::sqrt((
+                                        Float)tileSampler->samplesPerPixel));
+                            L[k] = rayWeight > 0
+                                       ? rayWeight *
+                                             basePath.Li(ray, scene,
+                                                         *tileSampler, arena,
+                                                         0)
+                                       : Spectrum(0.f);
+                            if (L[k].HasNaNs() || L[k].y() < -1e-5 ||
+                                std::isinf(L[k].y()))
+                                L[k] = Spectrum(0.f);
+                            arena.Reset();
+                        }
+                        sumP += L[0];
+                        sumDx += L[1] - L[0];
+                        sumDy += L[2] - L[0];
+                    } while (tileSampler->StartNextSample());
+                    Float inv = 1 / (Float)tileSampler->samplesPerPixel;
+                    int offset = (py - pixelBounds.pMin.y) * extent.x +
+                                 (px - pixelBounds.pMin.x);
+                    primal[offset] = sumP * inv;
+                    dx[offset] = sumDx * inv;
+                    dy[offset] = sumDy * inv;
+                }
+            reporter.Update();
+        }, nTiles);
+        reporter.Done();
+    }
+
+    // Reconstruct the image with screened-Poisson Jacobi iterations:
+    // the solution is pulled toward the primal image with weight
+    // _alpha_ and toward agreement with the gradient planes elsewhere
+    std::vector<Spectrum> image = primal, next(nPixels);
+    for (int iter = 0; iter < nReconstructIters; ++iter) {
+        ParallelFor([&](int64_t y) {
+            for (int x = 0; x < extent.x; ++x) {
+                int o = y * extent.x + x;
+                Spectrum sum = alpha * primal[o];
+                Float weight = alpha;
+                if (x + 1 < extent.x) {
+                    sum += image[o + 1] - dx[o];
+                    weight += 1;
+                }
+                if (x > 0) {
+                    sum += image[o - 1] + dx[o - 1];
+                    weight += 1;
+                }
+                if (y + 1 < extent.y) {
+                    sum += image[o + extent.x] - dy[o];
+                    weight += 1;
+                }
+                if (y > 0) {
+                    sum += image[o - extent.x] + dy[o - extent.x];
+                    weight += 1;
+                }
+                next[o] = sum / weight;
+            }
+        }, extent.y);
+        image.swap(next);
+    }
+
+    // Store the reconstructed image and write it, along with the raw
+    // gradient planes as AOVs for inspection
+    camera->film->SetImage(&image[0]);
+    camera->film->WriteImage();
+    std::string filename = camera->film->filename;
+    size_t dot = filename.find_last_of('.');
+    std::string base =
+        dot == std::string::npos ? filename : filename.substr(0, dot);
+    std::string ext = dot == std::string::npos ? ".exr" : filename.substr(dot);
+    std::vector<Float> rgb(3 * nPixels);
+    for (int plane = 0; plane < 2; ++plane) {
+        const std::vector<Spectrum> &g = plane == 0 ? dx : dy;
+        for (int i = 0; i < nPixels; ++i) {
+            Float c[3];
+            g[i].ToRGB(c);
+            for (int j = 0; j < 3; ++j) rgb[3 * i + j] = c[j];
+        }
+        WriteImage(base + (plane == 0 ? "_dx" : "_dy") + ext, &rgb[0],
+                   pixelBounds, camera->film->fullResolution);
+    }
+}
+
+GradientPathIntegrator *CreateGradientPathIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera) {
+    int maxDepth = params.FindOneInt("maxdepth", 5);
+    Float alpha = params.FindOneFloat("reconstructalpha", 0.2f);
+    int iters = params.FindOneInt("reconstructiterations", 50);
+    return new GradientPathIntegrator(maxDepth, camera, sampler, alpha,
+                                      iters);
+}
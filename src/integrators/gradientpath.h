@@ -0,0 +1,83 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_GRADIENTPATH_H
+#define PBRT_INTEGRATORS_GRADIENTPATH_H
+
+// integrators/gradientpath.h*
+#include "pbrt.h"
+#include "integrator.h"
+#include "integrators/path.h"
+
+// GradientPathIntegrator Declarations
+//
+// Gradient-domain path tracing: alongside each base path, offset paths
+// are traced through the +x and +y neighbor pixels with the same
+// primary sample sequence (a primary-sample-space shift map), so the
+// finite differences are strongly correlated and the gradient
+// estimates are far less noisy than the primal image.  A screened
+// Poisson reconstruction combines the primal and gradient planes
+// before the image is written.  Each sample costs three paths, so
+// compare against the base integrator at matched total ray budgets.
+class GradientPathIntegrator : public Integrator {
+  public:
+    // GradientPathIntegrator Public Methods
+    GradientPathIntegrator(int maxDepth, std::shared_ptr<const Camera> camera,
+                           std::shared_ptr<Sampler> sampler, Float alpha,
+                           int nReconstructIters)
+        : camera(camera),
+          sampler(sampler),
+          basePath(maxDepth, camera, sampler),
+          alpha(alpha),
+          nReconstructIters(nReconstructIters) {}
+    void Render(const Scene &scene);
+
+  private:
+    // GradientPathIntegrator Private Data
+    std::shared_ptr<const Camera> camera;
+    std::shared_ptr<Sampler> sampler;
+    PathIntegrator basePath;
+    // Screened-Poisson data weight and iteration count
+    const Float alpha;
+    const int nReconstructIters;
+};
+
+GradientPathIntegrator *CreateGradientPathIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera);
+
+#endif  // PBRT_INTEGRATORS_GRADIENTPATH_H
@@ -0,0 +1,132 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_GUIDING_H
+#define PBRT_INTEGRATORS_GUIDING_H
+
+// integrators/guiding.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include "parallel.h"
+
+// Online spatio-directional radiance distribution used for path
+// guiding: a regular spatial grid over the scene bounds whose cells
+// each hold an equal-solid-angle directional histogram of incident
+// radiance.  Deposits accumulate through AtomicFloat, so learning is
+// lock-free and scales across render threads; cells with no data yet
+// sample and evaluate as the uniform sphere.
+class GuidingDistribution {
+  public:
+    // GuidingDistribution Public Methods
+    GuidingDistribution(const Bounds3f &worldBound)
+        : bounds(worldBound),
+          weights(new AtomicFloat[(size_t)spatialRes * spatialRes *
+                                  spatialRes * nDirBins]) {}
+    void Deposit(const Point3f &p, const Vector3f &w, Float radiance) const {
+        if (!(radiance > 0) || std::isinf(radiance)) return;
+        weights[CellOffset(p) + DirIndex(w)].Add(radiance);
+    }
+    Vector3f Sample(const Point3f &p, const Point2f &u, Float *pdf) const {
+        // Gather the cell's histogram and sample a bin proportionally
+        size_t offset = CellOffset(p);
+        Float w[nDirBins], total = 0;
+        for (int i = 0; i < nDirBins; ++i) {
+            w[i] = weights[offset + i];
+            total += w[i];
+        }
+        if (total == 0) {
+            // Nothing learned here yet: uniform sphere
+            *pdf = Inv4Pi;
+            Float z = 1 - 2 * u[0];
+            Float r = std::sqrt(std::max((Float)0, 1 - z * z));
+            Float phi = 2 * Pi * u[1];
+            return Vector3f(r * std::cos(phi), r * std::sin(phi), z);
+        }
+        Float target = u[0] * total, sum = 0;
+        int bin = nDirBins - 1;
+        for (int i = 0; i < nDirBins; ++i) {
+            sum += w[i];
+            if (target < sum) {
+                bin = i;
+                break;
+            }
+        }
+        *pdf = w[bin] / total * (nDirBins * Inv4Pi);
+
+        // Sample uniformly within the bin; rows are uniform in z, so
+        // every bin subtends the same solid angle
+        Float uBin = Clamp((target - (sum - w[bin])) / w[bin], 0, OneMinusEpsilon);
+        int zi = bin / nPhiBins, pi = bin % nPhiBins;
+        Float z = -1 + 2 * (zi + uBin) / nZBins;
+        Float phi = 2 * Pi * (pi + u[1]) / nPhiBins;
+        Float r = std::sqrt(std::max((Float)0, 1 - z * z));
+        return Vector3f(r * std::cos(phi), r * std::sin(phi), z);
+    }
+    Float Pdf(const Point3f &p, const Vector3f &w) const {
+        size_t offset = CellOffset(p);
+        Float total = 0;
+        for (int i = 0; i < nDirBins; ++i) total += weights[offset + i];
+        if (total == 0) return Inv4Pi;
+        return weights[offset + DirIndex(w)] / total * (nDirBins * Inv4Pi);
+    }
+
+  private:
+    // GuidingDistribution Private Methods
+    size_t CellOffset(const Point3f &p) const {
+        Vector3f t = bounds.Offset(p);
+        int x = Clamp((int)(t.x * spatialRes), 0, spatialRes - 1);
+        int y = Clamp((int)(t.y * spatialRes), 0, spatialRes - 1);
+        int z = Clamp((int)(t.z * spatialRes), 0, spatialRes - 1);
+        return (((size_t)z * spatialRes + y) * spatialRes + x) * nDirBins;
+    }
+    int DirIndex(const Vector3f &w) const {
+        int zi = Clamp((int)((w.z + 1) * 0.5f * nZBins), 0, nZBins - 1);
+        Float phi = std::atan2(w.y, w.x);
+        if (phi < 0) phi += 2 * Pi;
+        int pi = Clamp((int)(phi * Inv2Pi * nPhiBins), 0, nPhiBins - 1);
+        return zi * nPhiBins + pi;
+    }
+
+    // GuidingDistribution Private Data
+    static PBRT_CONSTEXPR int spatialRes = 16;
+    static PBRT_CONSTEXPR int nZBins = 8, nPhiBins = 8;
+    static PBRT_CONSTEXPR int nDirBins = nZBins * nPhiBins;
+    const Bounds3f bounds;
+    std::unique_ptr<AtomicFloat[]> weights;
+};
+
+#endif  // PBRT_INTEGRATORS_GUIDING_H
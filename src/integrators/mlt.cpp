@@ -44,6 +44,8 @@
 #include "paramset.h"
 #include "sampling.h"
 #include "progressreporter.h"
+#include <chrono>
+#include "distributed.h"
 
 STAT_TIMER("Time/Rendering", renderingTime);
 STAT_PERCENT("Integrator/Acceptance rate", acceptedMutations, totalMutations);
@@ -183,15 +185,53 @@ void MLTIntegrator::Render(const Scene &scene) {
                     L(scene, arena, lightDistr, sampler, depth, &pRaster).y();
                 arena.Reset();
             }
-            if ((i + 1 % 256) == 0) progress.Update();
+            if (((i + 1) % 256) == 0) progress.Update();
         }, nBootstrap, chunkSize);
         progress.Done();
     }
     Distribution1D bootstrap(&bootstrapWeights[0], nBootstrapSamples);
     Float b = bootstrap.funcInt * (maxDepth + 1);
 
+    // Precompute the chains' seed states in parallel: each chain's
+    // bootstrap selection is deterministic given its index, so the
+    // seed paths are traced once here and every chain starts from its
+    // snapshot (the sampler object carries the whole primary-sample
+    // state) instead of re-evaluating L
+    struct ChainSeed {
+        MLTSampler sampler;
+        RNG rng;
+        Spectrum L;
+        Point2f pRaster;
+        int depth;
+        ChainSeed(MLTSampler s, RNG r, const Spectrum &L,
+                  const Point2f &pRaster, int depth)
+            : sampler(std::move(s)), rng(r), L(L), pRaster(pRaster),
+              depth(depth) {}
+    };
+    std::vector<std::unique_ptr<ChainSeed>> chainSeeds(nChains);
+    if (scene.lights.size() > 0) {
+        std::vector<MemoryArena> seedThreadArenas(MaxThreadIndex());
+        ParallelFor([&](int i) {
+            MemoryArena &arena = seedThreadArenas[ThreadIndex];
+            RNG rng(i);
+            int bootstrapIndex = bootstrap.SampleDiscrete(rng.UniformFloat());
+            int depth = bootstrapIndex % (maxDepth + 1);
+            MLTSampler sampler(mutationsPerPixel, bootstrapIndex, sigma,
+                               largeStepProbability, nSampleStreams);
+            Point2f pRaster;
+            Spectrum LSeed =
+                L(scene, arena, lightDistr, sampler, depth, &pRaster);
+            chainSeeds[i].reset(
+                new ChainSeed(std::move(sampler), rng, LSeed, pRaster, depth));
+            arena.Reset();
+        }, nChains, 16);
+    }
+
     // Run _nChains_ Markov chains in parallel
     Film &film = *camera->film;
+    // Thousands of chains splatting into the same bright pixels make
+    // the shared CAS loops retry badly; stripe the splat sums
+    film.EnableSplatStriping();
     int64_t nTotalMutations =
         (int64_t)mutationsPerPixel * (int64_t)film.GetSampleBounds().Area();
     if (scene.lights.size() > 0) {
@@ -199,60 +239,104 @@ void MLTIntegrator::Render(const Scene &scene) {
         const int progressFrequency = 32768;
         ProgressReporter progress(nTotalMutations / progressFrequency,
                                   "Rendering");
-        ParallelFor([&](int i) {
-            int64_t nChainMutations =
-                std::min((i + 1) * nTotalMutations / nChains, nTotalMutations) -
-                i * nTotalMutations / nChains;
-            // Follow {i}th Markov chain for _nChainMutations_
-            MemoryArena arena;
-
-            // Select initial state from the set of bootstrap samples
-            RNG rng(i);
-            int bootstrapIndex = bootstrap.SampleDiscrete(rng.UniformFloat());
-            int depth = bootstrapIndex % (maxDepth + 1);
-
-            // Initialize local variables for selected state
-            MLTSampler sampler(mutationsPerPixel, bootstrapIndex, sigma,
-                               largeStepProbability, nSampleStreams);
-            Point2f pCurrent;
-            Spectrum LCurrent =
-                L(scene, arena, lightDistr, sampler, depth, &pCurrent);
-
-            // Run the Markov chain for _nChainMutations_ steps
-            for (int64_t j = 0; j < nChainMutations; ++j) {
-                sampler.StartIteration();
-                Point2f pProposed;
-                Spectrum LProposed =
-                    L(scene, arena, lightDistr, sampler, depth, &pProposed);
-                // Compute acceptance probability for proposed sample
-                Float accept = std::min((Float)1, LProposed.y() / LCurrent.y());
-
-                // Splat both current and proposed samples to _film_
-                if (accept > 0)
-                    film.AddSplat(pProposed,
-                                  LProposed * accept / LProposed.y());
-                film.AddSplat(pCurrent, LCurrent * (1 - accept) / LCurrent.y());
-
-                // Accept or reject the proposal
-                if (rng.UniformFloat() < accept) {
-                    pCurrent = pProposed;
-                    LCurrent = LProposed;
-                    sampler.Accept();
-                    ++acceptedMutations;
-                } else
-                    sampler.Reject();
-                ++totalMutations;
-                if ((i * nTotalMutations / nChains + j) % progressFrequency ==
-                    0)
-                    progress.Update();
-                arena.Reset();
+        // Reload accumulated splats and the completed-chain count if a
+        // checkpoint from a preempted run is being resumed; chains are
+        // seeded by index, so the remaining chains continue exactly.
+        int chainsDone = 0;
+        if (PbrtOptions.resume) {
+            int64_t ckptChains;
+            if (film.ReadCheckpoint(&ckptChains)) {
+                chainsDone = (int)std::min((int64_t)nChains, ckptChains);
+                Warning("Resuming MLT render from checkpoint: %d of %d "
+                        "chains already completed",
+                        chainsDone, nChains);
+            }
+        }
+
+        // Run the chains in batches so the film is quiescent at batch
+        // boundaries, where a checkpoint can be written consistently.
+        int chainBatch = nChains;
+        if (PbrtOptions.checkpointSeconds > 0)
+            chainBatch = Clamp(nChains / 64, MaxThreadIndex(), nChains);
+        auto lastCheckpoint = std::chrono::steady_clock::now();
+        while (chainsDone < nChains) {
+            int batchEnd = std::min(nChains, chainsDone + chainBatch);
+            if (!DistClaimWorkUnit("mlt-batch", chainsDone)) {
+                chainsDone = batchEnd;
+                continue;
             }
-        }, nChains);
+            ParallelFor([&](int batchIndex) {
+                int i = chainsDone + batchIndex;
+                int64_t nChainMutations =
+                    std::min((i + 1) * nTotalMutations / nChains, nTotalMutations) -
+                    i * nTotalMutations / nChains;
+                // Follow {i}th Markov chain for _nChainMutations_
+                MemoryArena arena;
+
+                // Start from the precomputed seed state: the sampler
+                // snapshot carries the seed path's primary samples, so
+                // no L re-evaluation is needed
+                ChainSeed &seed = *chainSeeds[i];
+                RNG rng = seed.rng;
+                int depth = seed.depth;
+                MLTSampler sampler = seed.sampler;
+                Point2f pCurrent = seed.pRaster;
+                Spectrum LCurrent = seed.L;
+
+                // Run the Markov chain for _nChainMutations_ steps
+                for (int64_t j = 0; j < nChainMutations; ++j) {
+                    sampler.StartIteration();
+                    Point2f pProposed;
+                    Spectrum LProposed =
+                        L(scene, arena, lightDistr, sampler, depth, &pProposed);
+                    // Compute acceptance probability for proposed sample
+                    Float accept = std::min((Float)1, LProposed.y() / LCurrent.y());
+
+                    // Splat both current and proposed samples to _film_
+                    if (accept > 0)
+                        film.AddSplat(pProposed,
+                                      LProposed * accept / LProposed.y());
+                    film.AddSplat(pCurrent, LCurrent * (1 - accept) / LCurrent.y());
+
+                    // Accept or reject the proposal
+                    if (rng.UniformFloat() < accept) {
+                        pCurrent = pProposed;
+                        LCurrent = LProposed;
+                        sampler.Accept();
+                        ++acceptedMutations;
+                    } else
+                        sampler.Reject();
+                    ++totalMutations;
+                    if ((i * nTotalMutations / nChains + j) % progressFrequency ==
+                        0)
+                        progress.Update();
+                    arena.Reset();
+                }
+            }, batchEnd - chainsDone);
+            chainsDone = batchEnd;
+
+            // Checkpoint the film and chain count if the interval has passed
+            if (PbrtOptions.checkpointSeconds > 0 && chainsDone < nChains) {
+                Float sinceCheckpoint =
+                    std::chrono::duration<Float>(std::chrono::steady_clock::now() -
+                                                 lastCheckpoint)
+                        .count();
+                if (sinceCheckpoint >= PbrtOptions.checkpointSeconds) {
+                    film.FlushSplats();
+                    film.WriteCheckpoint(chainsDone);
+                    lastCheckpoint = std::chrono::steady_clock::now();
+                }
+            }
+        }
         progress.Done();
     }
 
     // Store final image computed with MLT
-    camera->film->WriteImage(b / mutationsPerPixel);
+    camera->film->FlushSplats();
+    if (DistFinishFilm(camera->film)) {
+        camera->film->WriteImage(b / mutationsPerPixel);
+        camera->film->RemoveCheckpoint();
+    }
 }
 
 MLTIntegrator *CreateMLTIntegrator(const ParamSet &params,
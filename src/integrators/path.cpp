@@ -33,75 +33,227 @@
 
 // integrators/path.cpp*
 #include "integrators/path.h"
+#include "material.h"
 #include "scene.h"
 #include "interaction.h"
 #include "paramset.h"
 #include "bssrdf.h"
+#include "firsthitcache.h"
 #include "stats.h"
 
 STAT_PERCENT("Integrator/Zero-radiance paths", zeroRadiancePaths, totalPaths);
 STAT_INT_DISTRIBUTION("Integrator/Path length", pathLength);
 
 // PathIntegrator Method Definitions
+void PathIntegrator::Preprocess(const Scene &scene, Sampler &sampler) {
+    if (guiding) guide.reset(new GuidingDistribution(scene.WorldBound()));
+    if (useLightTree) lightTree.reset(new LightTree(scene.lights));
+    if (useSpatialLights)
+        spatialLights.reset(new SpatialLightDistribution(scene));
+    if (useRadianceCache)
+        radianceCache.reset(new RadianceCache(scene.WorldBound()));
+}
+
 Spectrum PathIntegrator::Li(const RayDifferential &r, const Scene &scene,
                             Sampler &sampler, MemoryArena &arena,
                             int depth) const {
     ProfilePhase p(Prof::SamplerIntegratorLi);
     Spectrum L(0.f), beta(1.f);
     RayDifferential ray(r);
-    bool specularBounce = false;
+    bool specularBounce = false, diffuseBounceSeen = false;
     int bounces;
+    // Sample this path's hero wavelength if spectral dispersion is
+    // enabled.  Companion wavelengths can't be carried through an RGB
+    // throughput, so at the path's first dispersive scattering event it
+    // collapses to the hero wavelength, weighted by that wavelength's
+    // color response; since only this wavelength can generate the
+    // refracted path, no further MIS weight is needed.
+    Float heroLambda = 0;
+    bool collapsed = false;
+    if (heroWavelength)
+        heroLambda = sampledLambdaStart +
+                     (sampledLambdaEnd - sampledLambdaStart) * sampler.Get1D();
+    // Path-guiding learning state: the previous vertex and sampled
+    // direction, so radiance discovered at this vertex can be
+    // attributed to the direction that found it
+    Point3f guidePrevP;
+    Vector3f guidePrevWi;
+    bool guidePrevValid = false;
+    // Radiance-cache learning state: the first qualifying vertex this
+    // path will deposit its realized continuation into
+    bool cacheDepositPending = false;
+    Point3f cacheP;
+    Normal3f cacheN;
+    Spectrum cacheLBefore, cacheBeta;
     for (bounces = 0;; ++bounces) {
         // Find next path vertex and accumulate contribution
 
-        // Intersect _ray_ with scene and store intersection in _isect_
+        // Intersect _ray_ with scene and store intersection in _isect_,
+        // serving the deterministic camera first hit from the cache
+        // when the same sample was traced before
         SurfaceInteraction isect;
-        bool foundIntersection = scene.Intersect(ray, &isect);
+        bool foundIntersection;
+        if (bounces == 0 && firstHitCacheSlot &&
+            firstHitCacheSlot->ready.load(std::memory_order_acquire)) {
+            isect = firstHitCacheSlot->isect;
+            foundIntersection = firstHitCacheSlot->hit;
+        } else {
+            foundIntersection = scene.Intersect(ray, &isect);
+            if (bounces == 0 && firstHitCacheSlot &&
+                !firstHitCacheSlot->ready.load(std::memory_order_relaxed)) {
+                firstHitCacheSlot->isect = isect;
+                firstHitCacheSlot->isect.bsdf = nullptr;
+                firstHitCacheSlot->isect.bssrdf = nullptr;
+                firstHitCacheSlot->hit = foundIntersection;
+                firstHitCacheSlot->ready.store(true,
+                                               std::memory_order_release);
+            }
+        }
 
         // Possibly add emitted light at intersection
         if (bounces == 0 || specularBounce) {
             // Add emitted light at path vertex or from the environment
-            if (foundIntersection)
+            if (foundIntersection) {
                 L += beta * isect.Le(-ray.d);
-            else
-                for (const auto &light : scene.lights)
+                if (aovSample && bounces == 0)
+                    aovSample->direct += beta * isect.Le(-ray.d);
+            } else
+                for (const auto &light : scene.lights) {
                     L += beta * light->Le(ray);
+                    if (aovSample && bounces == 0)
+                        aovSample->direct += beta * light->Le(ray);
+                }
         }
 
         // Terminate path if ray escaped or _maxDepth_ was reached
         if (!foundIntersection || bounces >= maxDepth) break;
 
-        // Compute scattering functions and skip over medium boundaries
+        // Compute scattering functions and skip over medium boundaries,
+        // regularizing specular lobes once the path has diffused
+        isect.wavelength = heroLambda;
+        if (regularize > 0 && diffuseBounceSeen)
+            regularizeRoughness = regularize;
         isect.ComputeScatteringFunctions(ray, arena, true);
+        regularizeRoughness = 0;
         if (!isect.bsdf) {
             ray = isect.SpawnRay(ray.d);
             bounces--;
             continue;
         }
 
+        // Record the first hit's denoiser AOVs
+        if (aovSample && bounces == 0 && !aovSample->valid) {
+            aovSample->valid = true;
+            aovSample->n = isect.shading.n;
+            aovSample->depth = Distance(ray.o, isect.p);
+            const Point2f rhoSamples[4] = {Point2f(.25f, .5f),
+                                           Point2f(.5f, .25f),
+                                           Point2f(.75f, .5f),
+                                           Point2f(.5f, .75f)};
+            aovSample->albedo = isect.bsdf->rho(-ray.d, 4, rhoSamples);
+        }
+
+        // Collapse the path to its hero wavelength at the first
+        // dispersive scattering event
+        if (isect.dispersive && !collapsed) {
+            beta *= WavelengthToSpectrum(heroLambda);
+            collapsed = true;
+        }
+
         // Sample illumination from lights to find path contribution.
         // (But skip this for perfectly specular BSDFs.)
         if (isect.bsdf->NumComponents(BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) >
             0) {
             ++totalPaths;
-            Spectrum Ld =
-                beta * UniformSampleOneLight(isect, scene, arena, sampler);
+            Spectrum Ld;
+            if (lightTree)
+                Ld = beta * SampleOneLightHierarchical(isect, scene, arena,
+                                                       sampler, *lightTree);
+            else
+                Ld = beta * UniformSampleOneLight(
+                                isect, scene, arena, sampler, false,
+                                spatialLights ? spatialLights->Lookup(isect.p)
+                                              : nullptr);
             if (Ld.IsBlack()) ++zeroRadiancePaths;
             Assert(Ld.y() >= 0.f);
             L += Ld;
+            if (aovSample && bounces == 0) aovSample->direct += Ld;
+
+            // Record this vertex's direct light (and any emission found
+            // here) in the guiding distribution
+            if (guide && guidePrevValid) {
+                Spectrum found = Ld + beta * isect.Le(-ray.d);
+                guide->Deposit(guidePrevP, guidePrevWi, found.y());
+            }
+        }
+
+        // Consult the radiance cache at rough vertices after the first
+        // bounce: a mature entry replaces the whole indirect
+        // continuation, and an immature one earmarks this vertex for a
+        // deposit of the path's realized continuation
+        if (radianceCache && bounces >= 1 &&
+            isect.bsdf->NumComponents(
+                BxDFType(BSDF_DIFFUSE | BSDF_REFLECTION |
+                         BSDF_TRANSMISSION)) > 0 &&
+            isect.bsdf->NumComponents(
+                BxDFType(BSDF_SPECULAR | BSDF_REFLECTION |
+                         BSDF_TRANSMISSION)) == 0) {
+            Spectrum cached;
+            if (radianceCache->Lookup(isect.p, isect.n, &cached)) {
+                L += beta * cached;
+                break;
+            }
+            if (!cacheDepositPending) {
+                cacheDepositPending = true;
+                cacheP = isect.p;
+                cacheN = isect.n;
+                cacheLBefore = L;
+                cacheBeta = beta;
+            }
         }
 
-        // Sample BSDF to get new path direction
+        // Sample BSDF to get new path direction, mixing in the learned
+        // guiding distribution (one-sample MIS over the mixture) at
+        // vertices with non-specular components
         Vector3f wo = -ray.d, wi;
         Float pdf;
         BxDFType flags;
-        Spectrum f = isect.bsdf->Sample_f(wo, &wi, sampler.Get2D(), &pdf,
-                                          BSDF_ALL, &flags);
+        Spectrum f;
+        bool guideHere =
+            guide && isect.bsdf->NumComponents(
+                         BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0;
+        if (guideHere && sampler.Get1D() < guidingFraction) {
+            // Sample a direction from the guide and evaluate the BSDF
+            Float guidePdf;
+            wi = guide->Sample(isect.p, sampler.Get2D(), &guidePdf);
+            f = isect.bsdf->f(wo, wi, BSDF_ALL);
+            pdf = guidingFraction * guidePdf +
+                  (1 - guidingFraction) * isect.bsdf->Pdf(wo, wi, BSDF_ALL);
+            flags = BSDF_ALL;
+        } else {
+            f = isect.bsdf->Sample_f(wo, &wi, sampler.Get2D(), &pdf, BSDF_ALL,
+                                     &flags);
+            if (guideHere && pdf > 0) {
+                if (flags & BSDF_SPECULAR)
+                    // The guide can't generate a specular direction, so
+                    // only the BSDF selection probability applies
+                    pdf *= 1 - guidingFraction;
+                else
+                    pdf = guidingFraction * guide->Pdf(isect.p, wi) +
+                          (1 - guidingFraction) * pdf;
+            }
+        }
         if (f.IsBlack() || pdf == 0.f) break;
         beta *= f * AbsDot(wi, isect.shading.n) / pdf;
+        if (guide) {
+            guidePrevP = isect.p;
+            guidePrevWi = wi;
+            guidePrevValid = true;
+        }
         Assert(beta.y() >= 0.f);
         Assert(std::isinf(beta.y()) == false);
         specularBounce = (flags & BSDF_SPECULAR) != 0;
+        if (!specularBounce) diffuseBounceSeen = true;
         ray = isect.SpawnRay(wi);
 
         // Account for subsurface scattering, if applicable
@@ -128,18 +280,49 @@ Spectrum PathIntegrator::Li(const RayDifferential &r, const Scene &scene,
             Assert(std::isinf(beta.y()) == false);
 #endif
             specularBounce = (flags & BSDF_SPECULAR) != 0;
+            if (!specularBounce) diffuseBounceSeen = true;
             ray = pi.SpawnRay(wi);
         }
 
-        // Possibly terminate the path with Russian roulette
+        // Possibly terminate the path with Russian roulette; with
+        // adaptive RR the survival probability is the path throughput
+        // relative to the learned typical pixel value, so dim paths in
+        // dark scenes survive where the fixed threshold would kill them
+        // and bright scenes terminate paths that no longer matter
         if (bounces > 3) {
-            Float q = std::max((Float).05, 1 - beta.y());
+            Float q;
+            int64_t n = nCompletedPaths.load(std::memory_order_relaxed);
+            if (adaptiveRR && n > 1024) {
+                Float avg = totalPathLuminance / n;
+                Float survival =
+                    avg > 0 ? Clamp(beta.y() / (rrScale * avg), (Float).05,
+                                    (Float)1)
+                            : (Float)1;
+                q = 1 - survival;
+            } else
+                q = std::max((Float).05, 1 - beta.y());
             if (sampler.Get1D() < q) break;
             beta /= 1 - q;
             Assert(std::isinf(beta.y()) == false);
         }
     }
     ReportValue(pathLength, bounces);
+    if (cacheDepositPending) {
+        // Deposit the realized continuation radiance (what the rest of
+        // the path contributed, with this vertex's throughput divided
+        // out channel by channel)
+        Spectrum contribution = L - cacheLBefore;
+        for (int c = 0; c < Spectrum::nSamples; ++c)
+            contribution[c] =
+                cacheBeta[c] > 0 ? contribution[c] / cacheBeta[c] : 0;
+        if (!contribution.HasNaNs())
+            radianceCache->Deposit(cacheP, cacheN, contribution);
+    }
+    if (adaptiveRR) {
+        // Fold this path's value into the cached pixel-value estimate
+        totalPathLuminance.Add(std::min(L.y(), (Float)1e4));
+        ++nCompletedPaths;
+    }
     return L;
 }
 
@@ -147,5 +330,23 @@ PathIntegrator *CreatePathIntegrator(const ParamSet &params,
                                      std::shared_ptr<Sampler> sampler,
                                      std::shared_ptr<const Camera> camera) {
     int maxDepth = params.FindOneInt("maxdepth", 5);
-    return new PathIntegrator(maxDepth, camera, sampler);
+    bool heroWavelength = params.FindOneBool("herowavelength", false);
+    bool guiding = params.FindOneBool("guiding", false);
+    Float guidingFraction =
+        Clamp(params.FindOneFloat("guidingfraction", 0.5f), 0.f, 0.9f);
+    std::string lightStrategy =
+        params.FindOneString("lightsamplestrategy", "uniform");
+    if (lightStrategy != "uniform" && lightStrategy != "bvh" &&
+        lightStrategy != "spatial")
+        Warning("Light sample strategy \"%s\" unknown; using \"uniform\".",
+                lightStrategy.c_str());
+    bool adaptiveRR = params.FindOneBool("adaptiverr", false);
+    Float rrScale = params.FindOneFloat("rrscale", 1.f);
+    bool radianceCache = params.FindOneBool("radiancecache", false);
+    Float regularize = params.FindOneFloat("regularize", 0.f);
+    return new PathIntegrator(maxDepth, camera, sampler, heroWavelength,
+                              guiding, guidingFraction,
+                              lightStrategy == "bvh",
+                              lightStrategy == "spatial", adaptiveRR,
+                              rrScale, radianceCache, regularize);
 }
@@ -41,6 +41,10 @@
 // integrators/path.h*
 #include "pbrt.h"
 #include "integrator.h"
+#include "integrators/guiding.h"
+#include "lighttree.h"
+#include "lightdistrib.h"
+#include "integrators/radiancecache.h"
 
 // PathIntegrator Declarations
 class PathIntegrator : public SamplerIntegrator {
@@ -49,12 +53,56 @@ class PathIntegrator : public SamplerIntegrator {
     Spectrum Li(const RayDifferential &ray, const Scene &scene,
                 Sampler &sampler, MemoryArena &arena, int depth) const;
     PathIntegrator(int maxDepth, std::shared_ptr<const Camera> camera,
-                   std::shared_ptr<Sampler> sampler)
-        : SamplerIntegrator(camera, sampler), maxDepth(maxDepth) {}
+                   std::shared_ptr<Sampler> sampler,
+                   bool heroWavelength = false, bool guiding = false,
+                   Float guidingFraction = 0.5f, bool useLightTree = false,
+                   bool useSpatialLights = false, bool adaptiveRR = false,
+                   Float rrScale = 1, bool useRadianceCache = false,
+                   Float regularize = 0)
+        : SamplerIntegrator(camera, sampler),
+          maxDepth(maxDepth),
+          heroWavelength(heroWavelength),
+          guiding(guiding),
+          guidingFraction(guidingFraction),
+          useLightTree(useLightTree),
+          useSpatialLights(useSpatialLights),
+          adaptiveRR(adaptiveRR),
+          rrScale(rrScale),
+          useRadianceCache(useRadianceCache),
+          regularize(regularize) {}
+    void Preprocess(const Scene &scene, Sampler &sampler);
 
   private:
     // PathIntegrator Private Data
     const int maxDepth;
+    const bool heroWavelength;
+    // Path-space regularization: roughness floor applied to specular
+    // materials past the first diffuse bounce ("regularize"; 0 = off)
+    const Float regularize;
+    // Path-guiding state: an online spatio-directional radiance
+    // distribution mixed with BSDF sampling in Li()
+    const bool guiding;
+    const Float guidingFraction;
+    std::unique_ptr<GuidingDistribution> guide;
+    // Light hierarchy for many-light scenes ("lightsamplestrategy"
+    // "bvh")
+    const bool useLightTree;
+    std::unique_ptr<LightTree> lightTree;
+    // Spatially varying per-voxel light distributions
+    // ("lightsamplestrategy" "spatial")
+    const bool useSpatialLights;
+    std::unique_ptr<SpatialLightDistribution> spatialLights;
+    // Adjoint-driven Russian roulette ("adaptiverr"): survival
+    // probabilities compare the path throughput against a cheap cached
+    // estimate of typical pixel value, learned online
+    const bool adaptiveRR;
+    const Float rrScale;
+    mutable AtomicFloat totalPathLuminance;
+    mutable std::atomic<int64_t> nCompletedPaths{0};
+    // Diffuse indirect radiance cache ("radiancecache"), consulted at
+    // rough vertices after the first bounce
+    const bool useRadianceCache;
+    std::unique_ptr<RadianceCache> radianceCache;
 };
 
 PathIntegrator *CreatePathIntegrator(const ParamSet &params,
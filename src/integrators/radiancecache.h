@@ -0,0 +1,131 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_RADIANCECACHE_H
+#define PBRT_INTEGRATORS_RADIANCECACHE_H
+
+// integrators/radiancecache.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include "spectrum.h"
+#include "parallel.h"
+#include <atomic>
+
+// Lazily populated radiance cache for smooth diffuse interreflection:
+// entries are keyed on a position voxel plus the dominant normal axis
+// and accumulate the mean continuation radiance observed by paths that
+// passed through them.  Writers race only on atomic adds; once an
+// entry has seen enough paths, lookups replace the indirect
+// continuation at rough vertices entirely.
+class RadianceCache {
+  public:
+    // RadianceCache Public Methods
+    RadianceCache(const Bounds3f &worldBound, int minSamples = 64)
+        : bounds(worldBound),
+          minSamples(minSamples),
+          keys(new std::atomic<uint64_t>[tableSize]),
+          entries(new Entry[tableSize]) {
+        for (size_t i = 0; i < tableSize; ++i) keys[i] = 0;
+    }
+    // Return a mature cached continuation estimate, or false while the
+    // cell is still learning
+    bool Lookup(const Point3f &p, const Normal3f &n, Spectrum *value) const {
+        int slot = FindSlot(Key(p, n), false);
+        if (slot < 0) return false;
+        const Entry &entry = entries[slot];
+        int count = entry.count.load(std::memory_order_acquire);
+        if (count < minSamples) return false;
+        for (int c = 0; c < Spectrum::nSamples; ++c)
+            (*value)[c] = entry.sum[c] / count;
+        return true;
+    }
+    void Deposit(const Point3f &p, const Normal3f &n,
+                 const Spectrum &value) const {
+        int slot = FindSlot(Key(p, n), true);
+        if (slot < 0) return;
+        Entry &entry = entries[slot];
+        for (int c = 0; c < Spectrum::nSamples; ++c)
+            entry.sum[c].Add(value[c]);
+        ++entry.count;
+    }
+
+  private:
+    // RadianceCache Private Declarations
+    struct Entry {
+        AtomicFloat sum[Spectrum::nSamples];
+        std::atomic<int> count{0};
+    };
+    static PBRT_CONSTEXPR size_t tableSize = 1 << 20;
+
+    // RadianceCache Private Methods
+    uint64_t Key(const Point3f &p, const Normal3f &n) const {
+        // Voxelize position at 1/128th of the scene's maximum extent
+        // and bin the normal by dominant signed axis
+        Vector3f t = bounds.Offset(p);
+        uint64_t x = Clamp((int)(t.x * 128), 0, 127);
+        uint64_t y = Clamp((int)(t.y * 128), 0, 127);
+        uint64_t z = Clamp((int)(t.z * 128), 0, 127);
+        int axis = MaxDimension(Abs(Vector3f(n.x, n.y, n.z)));
+        uint64_t nBin = 2 * axis + (n[axis] < 0 ? 1 : 0);
+        // Nonzero key so empty slots are distinguishable
+        return (x << 32) | (y << 18) | (z << 4) | (nBin + 1);
+    }
+    int FindSlot(uint64_t key, bool insert) const {
+        uint64_t h = key * 0x9e3779b97f4a7c15ull;
+        for (int probe = 0; probe < 16; ++probe) {
+            size_t slot = (h + probe) & (tableSize - 1);
+            uint64_t stored = keys[slot].load(std::memory_order_acquire);
+            if (stored == key) return (int)slot;
+            if (stored == 0) {
+                if (!insert) return -1;
+                uint64_t expected = 0;
+                if (keys[slot].compare_exchange_strong(expected, key))
+                    return (int)slot;
+                if (expected == key) return (int)slot;
+            }
+        }
+        return -1;  // region of the table is full; skip caching here
+    }
+
+    // RadianceCache Private Data
+    const Bounds3f bounds;
+    const int minSamples;
+    std::unique_ptr<std::atomic<uint64_t>[]> keys;
+    std::unique_ptr<Entry[]> entries;
+};
+
+#endif  // PBRT_INTEGRATORS_RADIANCECACHE_H
@@ -43,7 +43,10 @@
 #include "interaction.h"
 #include "sampling.h"
 #include "samplers/halton.h"
+#include "samplers/random.h"
 #include "stats.h"
+#include "film.h"
+#include <chrono>
 
 STAT_TIMER("Time/SPPM camera pass", hitPointTimer);
 STAT_TIMER("Time/SPPM visible point grid construction", gridConstructionTimer);
@@ -79,6 +82,9 @@ struct SPPMPixel {
         Vector3f wo;
         const BSDF *bsdf = nullptr;
         Spectrum beta;
+        // Set instead of _bsdf_ for volume visible points sampled
+        // inside participating media
+        const PhaseFunction *phase = nullptr;
     } vp;
     AtomicFloat Phi[Spectrum::nSamples];
     std::atomic<int> M;
@@ -86,10 +92,104 @@ struct SPPMPixel {
     Spectrum tau;
 };
 
-struct SPPMPixelListNode {
-    SPPMPixel *pixel;
-    SPPMPixelListNode *next;
+// SPPM checkpoint file layout: _SPPMCheckpointHeader_, then for each
+// pixel its persistent cross-iteration state: radius, N, and the Ld and
+// tau spectrum coefficients.  Per-iteration state (visible points, Phi,
+// M) is always empty at iteration boundaries and is not stored.
+struct SPPMCheckpointHeader {
+    uint32_t magic, version;
+    uint32_t floatSize, nSpectrumSamples;
+    int32_t boundsMinX, boundsMinY, boundsMaxX, boundsMaxY;
+    int32_t iterationsDone;
 };
+static const uint32_t sppmCheckpointMagic = 0x50534250;  // "PBSP"
+static const uint32_t sppmCheckpointVersion = 1;
+static PBRT_CONSTEXPR int nSPPMCheckpointChannels = 2 + 2 * Spectrum::nSamples;
+
+static bool ReadSPPMCheckpoint(const std::string &filename,
+                               const Bounds2i &pixelBounds, SPPMPixel *pixels,
+                               int *iterationsDone) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    SPPMCheckpointHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != sppmCheckpointMagic ||
+        header.version != sppmCheckpointVersion ||
+        header.floatSize != sizeof(Float) ||
+        header.nSpectrumSamples != Spectrum::nSamples ||
+        header.boundsMinX != pixelBounds.pMin.x ||
+        header.boundsMinY != pixelBounds.pMin.y ||
+        header.boundsMaxX != pixelBounds.pMax.x ||
+        header.boundsMaxY != pixelBounds.pMax.y) {
+        Warning("Ignoring checkpoint file \"%s\": stale or incompatible",
+                filename.c_str());
+        fclose(f);
+        return false;
+    }
+    int nPixels = pixelBounds.Area();
+    std::vector<Float> buf(nSPPMCheckpointChannels * (size_t)nPixels);
+    if (fread(buf.data(), sizeof(Float), buf.size(), f) != buf.size()) {
+        Warning("Ignoring checkpoint file \"%s\": truncated",
+                filename.c_str());
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+    for (int i = 0; i < nPixels; ++i) {
+        SPPMPixel &p = pixels[i];
+        const Float *src = &buf[nSPPMCheckpointChannels * (size_t)i];
+        p.radius = src[0];
+        p.N = src[1];
+        for (int j = 0; j < Spectrum::nSamples; ++j) {
+            p.Ld[j] = src[2 + j];
+            p.tau[j] = src[2 + Spectrum::nSamples + j];
+        }
+    }
+    *iterationsDone = header.iterationsDone;
+    return true;
+}
+
+static void WriteSPPMCheckpoint(const std::string &filename,
+                                const Bounds2i &pixelBounds,
+                                const SPPMPixel *pixels, int iterationsDone) {
+    // Write the checkpoint to a temporary file and rename it into place
+    // so that a preemption mid-write can't corrupt an older checkpoint.
+    std::string tmpName = filename + ".tmp";
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (!f) {
+        Warning("Unable to write checkpoint file \"%s\"", tmpName.c_str());
+        return;
+    }
+    SPPMCheckpointHeader header;
+    header.magic = sppmCheckpointMagic;
+    header.version = sppmCheckpointVersion;
+    header.floatSize = sizeof(Float);
+    header.nSpectrumSamples = Spectrum::nSamples;
+    header.boundsMinX = pixelBounds.pMin.x;
+    header.boundsMinY = pixelBounds.pMin.y;
+    header.boundsMaxX = pixelBounds.pMax.x;
+    header.boundsMaxY = pixelBounds.pMax.y;
+    header.iterationsDone = iterationsDone;
+    int nPixels = pixelBounds.Area();
+    std::vector<Float> buf(nSPPMCheckpointChannels * (size_t)nPixels);
+    for (int i = 0; i < nPixels; ++i) {
+        const SPPMPixel &p = pixels[i];
+        Float *dst = &buf[nSPPMCheckpointChannels * (size_t)i];
+        dst[0] = p.radius;
+        dst[1] = p.N;
+        for (int j = 0; j < Spectrum::nSamples; ++j) {
+            dst[2 + j] = p.Ld[j];
+            dst[2 + Spectrum::nSamples + j] = p.tau[j];
+        }
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(buf.data(), sizeof(Float), buf.size(), f) == buf.size();
+    fclose(f);
+    if (!ok || rename(tmpName.c_str(), filename.c_str()) != 0) {
+        Warning("Error writing checkpoint file \"%s\"", filename.c_str());
+        remove(tmpName.c_str());
+    }
+}
 
 static bool ToGrid(const Point3f &p, const Bounds3f &bounds,
                    const int gridRes[3], Point3i *pi) {
@@ -123,6 +223,20 @@ void SPPMIntegrator::Render(const Scene &scene) {
     std::unique_ptr<Distribution1D> lightDistr =
         ComputeLightPowerDistribution(scene);
 
+    // Adaptive photon budgeting: the photon pass draws lights from
+    // _photonDistr_, which starts at the power distribution and is
+    // re-balanced each iteration from the measured per-light
+    // contribution to the camera's visible points, so dim fixtures
+    // the camera actually sees stop starving.  A 25% power floor
+    // keeps every light explored, and the per-photon light PDF keeps
+    // the estimator unbiased under any selection distribution.
+    int nLights = (int)scene.lights.size();
+    std::unique_ptr<Distribution1D> photonDistr;
+    if (lightDistr)
+        photonDistr.reset(
+            new Distribution1D(&lightDistr->func[0], nLights));
+    std::vector<Float> lightContribution(nLights, 0);
+
     // Perform _nIterations_ of SPPM integration
     HaltonSampler sampler(nIterations, pixelBounds);
 
@@ -132,7 +246,23 @@ void SPPMIntegrator::Render(const Scene &scene) {
     Point2i nTiles((pixelExtent.x + tileSize - 1) / tileSize,
                    (pixelExtent.y + tileSize - 1) / tileSize);
     ProgressReporter progress(2 * nIterations, "Rendering");
-    for (int iter = 0; iter < nIterations; ++iter) {
+
+    // Reload persistent pixel state and the completed-iteration count if
+    // a checkpoint from a preempted run is being resumed; photon and
+    // visible-point sample indices are keyed on the iteration number, so
+    // the remaining iterations continue exactly.
+    int iterStart = 0;
+    std::string checkpointName = camera->film->CheckpointFilename();
+    if (PbrtOptions.resume &&
+        ReadSPPMCheckpoint(checkpointName, pixelBounds, pixels.get(),
+                           &iterStart)) {
+        Warning("Resuming SPPM render from checkpoint: %d of %d iterations "
+                "already completed",
+                iterStart, nIterations);
+        progress.Update(2 * (int64_t)iterStart);
+    }
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+    for (int iter = iterStart; iter < nIterations; ++iter) {
         // Generate SPPM visible points
         std::vector<MemoryArena> perThreadArenas(MaxThreadIndex());
         {
@@ -174,7 +304,26 @@ void SPPMIntegrator::Render(const Scene &scene) {
                     for (int depth = 0; depth < maxDepth; ++depth) {
                         SurfaceInteraction isect;
                         ++totalPhotonSurfaceInteractions;
-                        if (!scene.Intersect(ray, &isect)) {
+                        bool hitSurface = scene.Intersect(ray, &isect);
+
+                        // Sample participating media along the camera
+                        // ray, possibly creating a volume visible point
+                        if (ray.medium) {
+                            MediumInteraction mi;
+                            beta *= ray.medium->Sample(ray, *tileSampler,
+                                                       arena, &mi);
+                            if (beta.IsBlack()) break;
+                            if (mi.IsValid()) {
+                                pixel.Ld +=
+                                    beta * UniformSampleOneLight(
+                                               mi, scene, arena,
+                                               *tileSampler, true);
+                                pixel.vp = {mi.p, -ray.d, nullptr, beta};
+                                pixel.vp.phase = mi.phase;
+                                break;
+                            }
+                        }
+                        if (!hitSurface) {
                             // Accumulate light contributions for ray with no
                             // intersection
                             for (const auto &light : scene.lights)
@@ -240,9 +389,16 @@ void SPPMIntegrator::Render(const Scene &scene) {
 
         // Create grid of all SPPM visible points
 
-        // Allocate grid for SPPM visible points
+        // Allocate grid for SPPM visible points; cells are flat
+        // [gridStart[h], gridStart[h + 1]) runs in _gridEntries_ built
+        // by a two-pass counting sort below, so the photon pass walks
+        // contiguous memory instead of CASed linked lists
         int hashSize = nPixels;
-        std::vector<std::atomic<SPPMPixelListNode *>> grid(hashSize);
+        std::vector<std::atomic<int>> gridCount(hashSize);
+        for (int i = 0; i < hashSize; ++i)
+            gridCount[i].store(0, std::memory_order_relaxed);
+        std::vector<int> gridStart(hashSize + 1);
+        std::vector<SPPMPixel *> gridEntries;
 
         // Compute grid bounds for SPPM visible points
         Bounds3f gridBounds;
@@ -264,14 +420,15 @@ void SPPMIntegrator::Render(const Scene &scene) {
         for (int i = 0; i < 3; ++i)
             gridRes[i] = std::max((int)(baseGridRes * diag[i] / maxDiag), 1);
 
-        // Add visible points to SPPM grid
+        // Add visible points to SPPM grid with a two-pass counting
+        // sort: count entries per cell, prefix-sum the counts into run
+        // starts, then scatter the visible points into their runs
         {
             StatTimer timer(&gridConstructionTimer);
             ParallelFor([&](int pixelIndex) {
-                MemoryArena &arena = perThreadArenas[ThreadIndex];
                 SPPMPixel &pixel = pixels[pixelIndex];
                 if (!pixel.vp.beta.IsBlack()) {
-                    // Add pixel's visible point to applicable grid cells
+                    // Count this visible point in its overlapped cells
                     Float radius = pixel.radius;
                     Point3i pMin, pMax;
                     ToGrid(pixel.vp.p - Vector3f(radius, radius, radius),
@@ -280,31 +437,50 @@ void SPPMIntegrator::Render(const Scene &scene) {
                            gridBounds, gridRes, &pMax);
                     for (int z = pMin.z; z <= pMax.z; ++z)
                         for (int y = pMin.y; y <= pMax.y; ++y)
-                            for (int x = pMin.x; x <= pMax.x; ++x) {
-                                // Add visible point to grid cell $(x, y, z)$
-                                int h = hash(Point3i(x, y, z), hashSize);
-                                SPPMPixelListNode *node =
-                                    arena.Alloc<SPPMPixelListNode>();
-                                node->pixel = &pixel;
-
-                                // Atomically add _node_ to the start of
-                                // _grid[h]_'s linked list
-                                node->next = grid[h];
-                                while (grid[h].compare_exchange_weak(
-                                           node->next, node) == false)
-                                    ;
-                            }
+                            for (int x = pMin.x; x <= pMax.x; ++x)
+                                ++gridCount[hash(Point3i(x, y, z), hashSize)];
                     ReportValue(gridCellsPerVisiblePoint,
                                 (1 + pMax.x - pMin.x) * (1 + pMax.y - pMin.y) *
                                     (1 + pMax.z - pMin.z));
                 }
             }, nPixels, 4096);
+
+            // Prefix-sum the cell counts into run starts
+            int totalEntries = 0;
+            for (int i = 0; i < hashSize; ++i) {
+                gridStart[i] = totalEntries;
+                totalEntries += gridCount[i].load(std::memory_order_relaxed);
+                gridCount[i].store(gridStart[i], std::memory_order_relaxed);
+            }
+            gridStart[hashSize] = totalEntries;
+            gridEntries.resize(totalEntries);
+
+            // Scatter the visible points into their cells' runs
+            ParallelFor([&](int pixelIndex) {
+                SPPMPixel &pixel = pixels[pixelIndex];
+                if (!pixel.vp.beta.IsBlack()) {
+                    Float radius = pixel.radius;
+                    Point3i pMin, pMax;
+                    ToGrid(pixel.vp.p - Vector3f(radius, radius, radius),
+                           gridBounds, gridRes, &pMin);
+                    ToGrid(pixel.vp.p + Vector3f(radius, radius, radius),
+                           gridBounds, gridRes, &pMax);
+                    for (int z = pMin.z; z <= pMax.z; ++z)
+                        for (int y = pMin.y; y <= pMax.y; ++y)
+                            for (int x = pMin.x; x <= pMax.x; ++x) {
+                                int h = hash(Point3i(x, y, z), hashSize);
+                                gridEntries[gridCount[h]++] = &pixel;
+                            }
+                }
+            }, nPixels, 4096);
         }
 
         // Trace photons and accumulate contributions
         {
             StatTimer timer(&photonTimer);
             std::vector<MemoryArena> photonShootArenas(MaxThreadIndex());
+            std::vector<std::vector<Float>> threadLightContribution(
+                MaxThreadIndex(), std::vector<Float>(nLights, 0));
             ParallelFor([&](int photonIndex) {
                 MemoryArena &arena = photonShootArenas[ThreadIndex];
                 // Follow photon path for _photonIndex_
@@ -317,7 +493,7 @@ void SPPMIntegrator::Render(const Scene &scene) {
                 Float lightPdf;
                 Float lightSample = RadicalInverse(haltonDim++, haltonIndex);
                 int lightNum =
-                    lightDistr->SampleDiscrete(lightSample, &lightPdf);
+                    photonDistr->SampleDiscrete(lightSample, &lightPdf);
                 const std::shared_ptr<Light> &light = scene.lights[lightNum];
 
                 // Compute sample values for photon ray leaving light source
@@ -344,9 +520,61 @@ void SPPMIntegrator::Render(const Scene &scene) {
 
                 // Follow photon path through scene and record intersections
                 SurfaceInteraction isect;
+                RandomSampler mediumSampler(1, (int)photonIndex);
                 for (int depth = 0; depth < maxDepth; ++depth) {
-                    if (!scene.Intersect(photonRay, &isect)) break;
+                    bool hitSurface = scene.Intersect(photonRay, &isect);
                     ++totalPhotonSurfaceInteractions;
+
+                    // Sample participating media along the photon ray;
+                    // a medium interaction deposits to nearby volume
+                    // visible points and scatters via the phase
+                    // function
+                    if (photonRay.medium) {
+                        MediumInteraction mi;
+                        beta *= photonRay.medium->Sample(
+                            photonRay, mediumSampler, arena, &mi);
+                        if (beta.IsBlack()) break;
+                        if (mi.IsValid()) {
+                            if (depth > 0) {
+                                Point3i photonGridIndex;
+                                if (ToGrid(mi.p, gridBounds, gridRes,
+                                           &photonGridIndex)) {
+                                    int h = hash(photonGridIndex, hashSize);
+                                    for (int entry = gridStart[h];
+                                         entry < gridStart[h + 1]; ++entry) {
+                                        ++visiblePointsChecked;
+                                        SPPMPixel &pixel =
+                                            *gridEntries[entry];
+                                        if (!pixel.vp.phase) continue;
+                                        Float radius = pixel.radius;
+                                        if (DistanceSquared(pixel.vp.p,
+                                                            mi.p) >
+                                            radius * radius)
+                                            continue;
+                                        Vector3f wi = -photonRay.d;
+                                        Spectrum Phi =
+                                            beta * pixel.vp.phase->p(
+                                                       pixel.vp.wo, wi);
+                                        for (int i = 0;
+                                             i < Spectrum::nSamples; ++i)
+                                            pixel.Phi[i].Add(Phi[i]);
+                                        ++pixel.M;
+                                        threadLightContribution[ThreadIndex]
+                                            [lightNum] += Phi.y();
+                                    }
+                                }
+                            }
+                            Vector3f wo = -photonRay.d, wi;
+                            Point2f phaseSample(
+                                RadicalInverse(haltonDim, haltonIndex),
+                                RadicalInverse(haltonDim + 1, haltonIndex));
+                            haltonDim += 2;
+                            mi.phase->Sample_p(wo, &wi, phaseSample);
+                            photonRay = (RayDifferential)mi.SpawnRay(wi);
+                            continue;
+                        }
+                    }
+                    if (!hitSurface) break;
                     if (depth > 0) {
                         // Add photon contribution to nearby visible points
                         Point3i photonGridIndex;
@@ -354,12 +582,12 @@ void SPPMIntegrator::Render(const Scene &scene) {
                                    &photonGridIndex)) {
                             int h = hash(photonGridIndex, hashSize);
                             // Add photon contribution to visible points in
-                            // _grid[h]_
-                            for (SPPMPixelListNode *node =
-                                     grid[h].load(std::memory_order_relaxed);
-                                 node != nullptr; node = node->next) {
+                            // cell _h_'s run
+                            for (int entry = gridStart[h];
+                                 entry < gridStart[h + 1]; ++entry) {
                                 ++visiblePointsChecked;
-                                SPPMPixel &pixel = *node->pixel;
+                                SPPMPixel &pixel = *gridEntries[entry];
+                                if (!pixel.vp.bsdf) continue;
                                 Float radius = pixel.radius;
                                 if (DistanceSquared(pixel.vp.p, isect.p) >
                                     radius * radius)
@@ -372,6 +600,8 @@ void SPPMIntegrator::Render(const Scene &scene) {
                                 for (int i = 0; i < Spectrum::nSamples; ++i)
                                     pixel.Phi[i].Add(Phi[i]);
                                 ++pixel.M;
+                                threadLightContribution[ThreadIndex]
+                                    [lightNum] += Phi.y();
                             }
                         }
                     }
@@ -413,6 +643,30 @@ void SPPMIntegrator::Render(const Scene &scene) {
             }, photonsPerIteration, 8192);
             progress.Update();
             photonPaths += photonsPerIteration;
+
+            // Re-balance the next pass's light selection from this
+            // pass's measured visible-point contributions (smoothed
+            // across iterations), floored by the power distribution
+            for (const std::vector<Float> &threadContribution :
+                 threadLightContribution)
+                for (int i = 0; i < nLights; ++i)
+                    lightContribution[i] =
+                        0.5f * lightContribution[i] +
+                        threadContribution[i];
+            Float contributionSum = 0, powerSum = 0;
+            for (int i = 0; i < nLights; ++i) {
+                contributionSum += lightContribution[i];
+                powerSum += lightDistr->func[i];
+            }
+            if (contributionSum > 0 && powerSum > 0) {
+                std::vector<Float> weights(nLights);
+                for (int i = 0; i < nLights; ++i)
+                    weights[i] =
+                        0.25f * lightDistr->func[i] / powerSum +
+                        0.75f * lightContribution[i] / contributionSum;
+                photonDistr.reset(
+                    new Distribution1D(&weights[0], nLights));
+            }
         }
 
         // Update pixel values from this pass's photons
@@ -429,6 +683,10 @@ void SPPMIntegrator::Render(const Scene &scene) {
                     Spectrum Phi;
                     for (int j = 0; j < Spectrum::nSamples; ++j)
                         Phi[j] = p.Phi[j];
+                    // Volume visible points use the spherical kernel:
+                    // scale so the image pass's disk normalization
+                    // (pi r^2) effectively becomes (4/3) pi r^3
+                    if (p.vp.phase) Phi *= 3 / (4 * p.radius);
                     p.tau = (p.tau + p.vp.beta * Phi) * (Rnew * Rnew) /
                             (p.radius * p.radius);
                     p.N = Nnew;
@@ -440,26 +698,36 @@ void SPPMIntegrator::Render(const Scene &scene) {
                 // Reset _VisiblePoint_ in pixel
                 p.vp.beta = 0.;
                 p.vp.bsdf = nullptr;
+                p.vp.phase = nullptr;
             }, nPixels, 4096);
         }
 
+        // Checkpoint persistent pixel state if the interval has passed
+        if (PbrtOptions.checkpointSeconds > 0 && iter + 1 < nIterations) {
+            Float sinceCheckpoint =
+                std::chrono::duration<Float>(std::chrono::steady_clock::now() -
+                                             lastCheckpoint)
+                    .count();
+            if (sinceCheckpoint >= PbrtOptions.checkpointSeconds) {
+                WriteSPPMCheckpoint(checkpointName, pixelBounds, pixels.get(),
+                                    iter + 1);
+                lastCheckpoint = std::chrono::steady_clock::now();
+            }
+        }
+
         // Periodically store SPPM image in film and write image
         if (iter + 1 == nIterations || ((iter + 1) % writeFrequency) == 0) {
             int x0 = pixelBounds.pMin.x;
             int x1 = pixelBounds.pMax.x;
             uint64_t Np = (uint64_t)(iter + 1) * (uint64_t)photonsPerIteration;
             std::unique_ptr<Spectrum[]> image(new Spectrum[pixelBounds.Area()]);
-            int offset = 0;
-            for (int y = pixelBounds.pMin.y; y < pixelBounds.pMax.y; ++y) {
-                for (int x = x0; x < x1; ++x) {
-                    // Compute radiance _L_ for SPPM pixel _pixel_
-                    const SPPMPixel &pixel =
-                        pixels[(y - pixelBounds.pMin.y) * (x1 - x0) + (x - x0)];
-                    Spectrum L = pixel.Ld / (iter + 1);
-                    L += pixel.tau / (Np * Pi * pixel.radius * pixel.radius);
-                    image[offset++] = L;
-                }
-            }
+            ParallelFor([&](int64_t offset) {
+                // Compute radiance _L_ for SPPM pixel _pixel_
+                const SPPMPixel &pixel = pixels[offset];
+                Spectrum L = pixel.Ld / (iter + 1);
+                L += pixel.tau / (Np * Pi * pixel.radius * pixel.radius);
+                image[offset] = L;
+            }, pixelBounds.Area(), 4096);
             camera->film->SetImage(image.get());
             camera->film->WriteImage();
             // Write SPPM radius image, if requested
@@ -498,6 +766,7 @@ void SPPMIntegrator::Render(const Scene &scene) {
         }
     }
     progress.Done();
+    camera->film->RemoveCheckpoint();
 }
 
 Integrator *CreateSPPMIntegrator(const ParamSet &params,
@@ -33,6 +33,8 @@
 
 // integrators/volpath.cpp*
 #include "integrators/volpath.h"
+#include "media/homogeneous.h"
+#include "sampling.h"
 #include "scene.h"
 #include "interaction.h"
 #include "paramset.h"
@@ -44,6 +46,19 @@ STAT_COUNTER("Integrator/Volume interactions", volumeInteractions);
 STAT_COUNTER("Integrator/Surface interactions", surfaceInteractions);
 
 // VolPathIntegrator Method Definitions
+void VolPathIntegrator::Preprocess(const Scene &scene, Sampler &sampler) {
+    if (useLightTree) lightTree.reset(new LightTree(scene.lights));
+
+    // Collect delta-position light positions for equiangular sampling;
+    // the mixture pdf is evaluated over all of them, so cap the count
+    if (equiangular) {
+        for (const auto &light : scene.lights)
+            if (light->flags & (int)LightFlags::DeltaPosition)
+                deltaLightPositions.push_back(light->WorldBound().pMin);
+        if (deltaLightPositions.size() > 16) deltaLightPositions.clear();
+    }
+}
+
 Spectrum VolPathIntegrator::Li(const RayDifferential &r, const Scene &scene,
                                Sampler &sampler, MemoryArena &arena,
                                int depth) const {
@@ -59,6 +74,7 @@ Spectrum VolPathIntegrator::Li(const RayDifferential &r, const Scene &scene,
 
         // Sample the participating medium, if present
         MediumInteraction mi;
+        Spectrum betaPre = beta;
         if (ray.medium) beta *= ray.medium->Sample(ray, sampler, arena, &mi);
         if (beta.IsBlack()) break;
 
@@ -68,8 +84,83 @@ Spectrum VolPathIntegrator::Li(const RayDifferential &r, const Scene &scene,
             if (bounces >= maxDepth) break;
 
             ++volumeInteractions;
-            // Handle scattering at point in medium for volumetric path tracer
-            L += beta * UniformSampleOneLight(mi, scene, arena, sampler, true);
+            // Handle scattering at point in medium for volumetric path
+            // tracer; in homogeneous media lit by delta-position
+            // lights, the in-scattered direct light is estimated by
+            // MIS between the transmittance-sampled point and an
+            // equiangular-sampled one, which concentrates samples where
+            // light shafts actually peak
+            const HomogeneousMedium *homog =
+                deltaLightPositions.empty()
+                    ? nullptr
+                    : dynamic_cast<const HomogeneousMedium *>(ray.medium);
+            if (homog) {
+                Float len = ray.d.Length();
+                Float tMaxSeg = ray.tMax;
+
+                // Per-t densities of the two strategies: the channel-
+                // averaged transmittance pdf, and the equiangular
+                // mixture over the delta lights
+                auto pTransmittance = [&](Float t) {
+                    const Spectrum &st = homog->SigmaT();
+                    Float pdf = 0;
+                    for (int i = 0; i < Spectrum::nSamples; ++i)
+                        pdf += st[i] * len *
+                               std::exp(-st[i] * t * len);
+                    return pdf / Spectrum::nSamples;
+                };
+                Vector3f dn = ray.d / len;
+                auto equiGeometry = [&](const Point3f &pL, Float *sClosest,
+                                        Float *D, Float *thetaA,
+                                        Float *thetaB) {
+                    *sClosest = Dot(pL - ray.o, dn);
+                    *D = std::max(
+                        Distance(pL, ray.o + *sClosest * dn), (Float)1e-6f);
+                    *thetaA = std::atan2(-*sClosest, *D);
+                    *thetaB = std::atan2(tMaxSeg * len - *sClosest, *D);
+                };
+                auto pEquiangular = [&](Float t) {
+                    Float s = t * len, pdf = 0;
+                    for (const Point3f &pL : deltaLightPositions) {
+                        Float sClosest, D, thetaA, thetaB;
+                        equiGeometry(pL, &sClosest, &D, &thetaA, &thetaB);
+                        Float ds = s - sClosest;
+                        pdf += D / ((thetaB - thetaA) * (D * D + ds * ds));
+                    }
+                    return pdf * len / deltaLightPositions.size();
+                };
+
+                // Weight the transmittance-sampled point's direct light
+                Float tA = Dot(mi.p - ray.o, ray.d) / (len * len);
+                Float pA = pTransmittance(tA), pBatA = pEquiangular(tA);
+                Float wA = PowerHeuristic(1, pA, 1, pBatA);
+                L += beta * wA * SampleLd(mi, scene, arena, sampler);
+
+                // Sample an equiangular point and add its weighted
+                // direct light
+                int pivot = std::min(
+                    (int)(sampler.Get1D() * deltaLightPositions.size()),
+                    (int)deltaLightPositions.size() - 1);
+                Float sClosest, D, thetaA, thetaB;
+                equiGeometry(deltaLightPositions[pivot], &sClosest, &D,
+                             &thetaA, &thetaB);
+                Float theta = Lerp(sampler.Get1D(), thetaA, thetaB);
+                Float tB = (sClosest + D * std::tan(theta)) / len;
+                if (tB > 0 && tB < tMaxSeg) {
+                    Float pB = pEquiangular(tB);
+                    if (pB > 0) {
+                        Float wB =
+                            PowerHeuristic(1, pB, 1, pTransmittance(tB));
+                        Spectrum TrB = Exp(-homog->SigmaT() * tB * len);
+                        MediumInteraction miB(
+                            ray(tB), -ray.d, ray.time, ray.medium,
+                            ARENA_ALLOC(arena, HenyeyGreenstein)(homog->G()));
+                        L += betaPre * TrB * homog->SigmaS() * (wB / pB) *
+                             SampleLd(miB, scene, arena, sampler);
+                    }
+                }
+            } else
+                L += beta * SampleLd(mi, scene, arena, sampler);
 
             Vector3f wo = -ray.d, wi;
             mi.phase->Sample_p(wo, &wi, sampler.Get2D());
@@ -102,7 +193,7 @@ Spectrum VolPathIntegrator::Li(const RayDifferential &r, const Scene &scene,
             // Sample illumination from lights to find attenuated path
             // contribution
             L += beta *
-                 UniformSampleOneLight(isect, scene, arena, sampler, true);
+                 SampleLd(isect, scene, arena, sampler);
 
             // Sample BSDF to get new path direction
             Vector3f wo = -ray.d, wi;
@@ -131,7 +222,7 @@ Spectrum VolPathIntegrator::Li(const RayDifferential &r, const Scene &scene,
                 // Account for the attenuated direct subsurface scattering
                 // component
                 L += beta *
-                     UniformSampleOneLight(pi, scene, arena, sampler, true);
+                     SampleLd(pi, scene, arena, sampler);
 
                 // Account for the indirect subsurface scattering component
                 Spectrum f = pi.bsdf->Sample_f(pi.wo, &wi, sampler.Get2D(),
@@ -162,5 +253,12 @@ VolPathIntegrator *CreateVolPathIntegrator(
     const ParamSet &params, std::shared_ptr<Sampler> sampler,
     std::shared_ptr<const Camera> camera) {
     int maxDepth = params.FindOneInt("maxdepth", 5);
-    return new VolPathIntegrator(maxDepth, camera, sampler);
+    std::string lightStrategy =
+        params.FindOneString("lightsamplestrategy", "uniform");
+    if (lightStrategy != "uniform" && lightStrategy != "bvh")
+        Warning("Light sample strategy \"%s\" unknown; using \"uniform\".",
+                lightStrategy.c_str());
+    bool equiangular = params.FindOneBool("equiangular", true);
+    return new VolPathIntegrator(maxDepth, camera, sampler,
+                                 lightStrategy == "bvh", equiangular);
 }
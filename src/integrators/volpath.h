@@ -41,6 +41,7 @@
 // integrators/volpath.h*
 #include "pbrt.h"
 #include "integrator.h"
+#include "lighttree.h"
 
 // VolPathIntegrator Declarations
 class VolPathIntegrator : public SamplerIntegrator {
@@ -49,12 +50,33 @@ class VolPathIntegrator : public SamplerIntegrator {
     Spectrum Li(const RayDifferential &ray, const Scene &scene,
                 Sampler &sampler, MemoryArena &arena, int depth) const;
     VolPathIntegrator(int maxDepth, std::shared_ptr<const Camera> camera,
-                      std::shared_ptr<Sampler> sampler)
-        : SamplerIntegrator(camera, sampler), maxDepth(maxDepth) {}
+                      std::shared_ptr<Sampler> sampler,
+                      bool useLightTree = false, bool equiangular = true)
+        : SamplerIntegrator(camera, sampler),
+          maxDepth(maxDepth),
+          useLightTree(useLightTree),
+          equiangular(equiangular) {}
+    void Preprocess(const Scene &scene, Sampler &sampler);
 
   private:
+    // VolPathIntegrator Private Methods
+    Spectrum SampleLd(const Interaction &it, const Scene &scene,
+                      MemoryArena &arena, Sampler &sampler) const {
+        return lightTree ? SampleOneLightHierarchical(it, scene, arena,
+                                                      sampler, *lightTree,
+                                                      true)
+                         : UniformSampleOneLight(it, scene, arena, sampler,
+                                                 true);
+    }
+
     // VolPathIntegrator Private Data
     const int maxDepth;
+    const bool useLightTree;
+    std::unique_ptr<LightTree> lightTree;
+    // Equiangular distance sampling for homogeneous media lit by
+    // delta-position lights, MIS'd against transmittance sampling
+    const bool equiangular;
+    std::vector<Point3f> deltaLightPositions;
 };
 
 VolPathIntegrator *CreateVolPathIntegrator(
@@ -0,0 +1,181 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// integrators/vpl.cpp*
+#include "integrators/vpl.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "camera.h"
+#include "film.h"
+#include "reflection.h"
+#include "rng.h"
+#include "sampling.h"
+#include "stats.h"
+
+STAT_COUNTER("Integrator/Virtual point lights", nVPLsStored);
+
+// VPLIntegrator Method Definitions
+void VPLIntegrator::Preprocess(const Scene &scene, Sampler &sampler) {
+    if (scene.lights.size() == 0) return;
+    virtualLights.clear();
+    std::unique_ptr<Distribution1D> lightDistr =
+        ComputeLightPowerDistribution(scene);
+    RNG rng(20210);
+    for (int pathIndex = 0; pathIndex < nLightPaths; ++pathIndex) {
+        // Sample a photon ray leaving a light
+        Float lightPdf;
+        int lightNum = lightDistr->SampleDiscrete(rng.UniformFloat(),
+                                                  &lightPdf);
+        const std::shared_ptr<Light> &light = scene.lights[lightNum];
+        RayDifferential ray;
+        Normal3f nLight;
+        Float pdfPos, pdfDir;
+        Point2f u0(rng.UniformFloat(), rng.UniformFloat());
+        Point2f u1(rng.UniformFloat(), rng.UniformFloat());
+        Spectrum Le = light->Sample_Le(u0, u1, camera->shutterOpen, &ray,
+                                       &nLight, &pdfPos, &pdfDir);
+        if (Le.IsBlack() || pdfPos == 0 || pdfDir == 0) continue;
+        Spectrum beta = Le * AbsDot(nLight, ray.d) /
+                        (lightPdf * pdfPos * pdfDir * nLightPaths);
+
+        // Random-walk the subpath, depositing a VPL at each vertex
+        for (int bounce = 0; bounce < maxDepth; ++bounce) {
+            SurfaceInteraction isect;
+            if (!scene.Intersect(ray, &isect)) break;
+            isect.ComputeScatteringFunctions(RayDifferential(ray), vplArena,
+                                             true, TransportMode::Importance);
+            if (!isect.bsdf) {
+                ray = RayDifferential(isect.SpawnRay(ray.d));
+                --bounce;
+                continue;
+            }
+            if (isect.bsdf->NumComponents(
+                    BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0) {
+                VirtualLight vpl;
+                vpl.p = isect.p;
+                vpl.n = isect.shading.n;
+                vpl.wo = isect.wo;
+                vpl.beta = beta;
+                vpl.bsdf = isect.bsdf;
+                virtualLights.push_back(vpl);
+                ++nVPLsStored;
+            }
+
+            // Continue the walk by BSDF sampling with Russian roulette
+            Vector3f wi;
+            Float pdf;
+            BxDFType flags;
+            Spectrum f = isect.bsdf->Sample_f(
+                isect.wo, &wi, Point2f(rng.UniformFloat(),
+                                       rng.UniformFloat()),
+                &pdf, BSDF_ALL, &flags);
+            if (f.IsBlack() || pdf == 0) break;
+            Spectrum betaNew = beta * f * AbsDot(wi, isect.shading.n) / pdf;
+            Float q = std::min((Float)1, betaNew.y() / beta.y());
+            if (rng.UniformFloat() > q) break;
+            beta = betaNew / q;
+            ray = RayDifferential(isect.SpawnRay(wi));
+        }
+    }
+}
+
+Spectrum VPLIntegrator::Li(const RayDifferential &ray, const Scene &scene,
+                           Sampler &sampler, MemoryArena &arena,
+                           int depth) const {
+    ProfilePhase p(Prof::SamplerIntegratorLi);
+    Spectrum L(0.f);
+    SurfaceInteraction isect;
+    if (!scene.Intersect(ray, &isect)) {
+        for (const auto &light : scene.lights) L += light->Le(ray);
+        return L;
+    }
+    isect.ComputeScatteringFunctions(ray, arena);
+    if (!isect.bsdf)
+        return Li(isect.SpawnRay(ray.d), scene, sampler, arena, depth);
+    Vector3f wo = isect.wo;
+    L += isect.Le(wo);
+
+    // Direct lighting from the scene's real lights
+    if (scene.lights.size() > 0)
+        L += UniformSampleOneLight(isect, scene, arena, sampler);
+
+    // Indirect illumination from a random subset of the VPL set,
+    // scaled to estimate the full sum; the clamped geometry term
+    // bounds the classic VPL spikes near the virtual lights
+    if (!virtualLights.empty() &&
+        isect.bsdf->NumComponents(BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0) {
+        int nSamples = std::min(nVPLSamples, (int)virtualLights.size());
+        Float scale = (Float)virtualLights.size() / nSamples;
+        for (int i = 0; i < nSamples; ++i) {
+            int vplIndex = std::min(
+                (int)(sampler.Get1D() * virtualLights.size()),
+                (int)virtualLights.size() - 1);
+            const VirtualLight &vpl = virtualLights[vplIndex];
+            Vector3f d = vpl.p - isect.p;
+            Float d2 = d.LengthSquared();
+            if (d2 == 0) continue;
+            Vector3f wi = d / std::sqrt(d2);
+            Float G = AbsDot(wi, isect.shading.n) * AbsDot(wi, vpl.n) / d2;
+            G = std::min(G, gLimit);
+            Spectrum f = isect.bsdf->f(wo, wi);
+            Spectrum fVpl = vpl.bsdf->f(vpl.wo, -wi);
+            if (G == 0 || f.IsBlack() || fVpl.IsBlack()) continue;
+            Spectrum contribution = vpl.beta * f * fVpl * G * scale;
+            if (contribution.IsBlack()) continue;
+            Interaction target;
+            target.p = vpl.p;
+            target.n = vpl.n;
+            target.time = isect.time;
+            if (!scene.IntersectP(isect.SpawnRayTo(target)))
+                L += contribution;
+        }
+    }
+
+    // Trace rays for specular reflection and refraction
+    if (depth + 1 < 5) {
+        L += SpecularReflect(ray, isect, scene, sampler, arena, depth);
+        L += SpecularTransmit(ray, isect, scene, sampler, arena, depth);
+    }
+    return L;
+}
+
+VPLIntegrator *CreateVPLIntegrator(const ParamSet &params,
+                                   std::shared_ptr<Sampler> sampler,
+                                   std::shared_ptr<const Camera> camera) {
+    int nLightPaths = params.FindOneInt("nlightpaths", 1024);
+    int maxDepth = params.FindOneInt("maxdepth", 5);
+    int nVPLSamples = params.FindOneInt("vplsamples", 16);
+    Float gLimit = params.FindOneFloat("glimit", 10.f);
+    return new VPLIntegrator(camera, sampler, nLightPaths, maxDepth,
+                             nVPLSamples, gLimit);
+}
@@ -0,0 +1,90 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_VPL_H
+#define PBRT_INTEGRATORS_VPL_H
+
+// integrators/vpl.h*
+#include "pbrt.h"
+#include "integrator.h"
+#include "scene.h"
+
+// VPLIntegrator Declarations
+
+// Instant-radiosity preview integrator: a fixed set of light subpaths
+// is traced once per frame, depositing virtual point lights at their
+// surface vertices; every pixel then shades against a random subset of
+// the VPL set with a clamped geometry term, giving plausible
+// one-or-more-bounce GI at close to direct-lighting cost.
+struct VirtualLight {
+    Point3f p;
+    Normal3f n;
+    Vector3f wo;
+    Spectrum beta;
+    const BSDF *bsdf;
+};
+
+class VPLIntegrator : public SamplerIntegrator {
+  public:
+    // VPLIntegrator Public Methods
+    VPLIntegrator(std::shared_ptr<const Camera> camera,
+                  std::shared_ptr<Sampler> sampler, int nLightPaths,
+                  int maxDepth, int nVPLSamples, Float gLimit)
+        : SamplerIntegrator(camera, sampler),
+          nLightPaths(nLightPaths),
+          maxDepth(maxDepth),
+          nVPLSamples(nVPLSamples),
+          gLimit(gLimit) {}
+    void Preprocess(const Scene &scene, Sampler &sampler);
+    Spectrum Li(const RayDifferential &ray, const Scene &scene,
+                Sampler &sampler, MemoryArena &arena, int depth) const;
+
+  private:
+    // VPLIntegrator Private Data
+    const int nLightPaths, maxDepth, nVPLSamples;
+    const Float gLimit;
+    // The VPLs' BSDFs live in _vplArena_ for the whole render
+    MemoryArena vplArena;
+    std::vector<VirtualLight> virtualLights;
+};
+
+VPLIntegrator *CreateVPLIntegrator(const ParamSet &params,
+                                   std::shared_ptr<Sampler> sampler,
+                                   std::shared_ptr<const Camera> camera);
+
+#endif  // PBRT_INTEGRATORS_VPL_H
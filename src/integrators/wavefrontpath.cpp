@@ -0,0 +1,345 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// integrators/wavefrontpath.cpp*
+#include "integrators/wavefrontpath.h"
+#include "texcache.h"
+#include "offload.h"
+#include "scene.h"
+#include "interaction.h"
+#include "camera.h"
+#include "film.h"
+#include "sampler.h"
+#include "paramset.h"
+#include "progressreporter.h"
+#include "parallel.h"
+#include "stats.h"
+#include <algorithm>
+
+STAT_TIMER("Time/Rendering", wavefrontRenderingTime);
+STAT_COUNTER("Integrator/Camera rays traced", nWavefrontCameraRays);
+
+// Quantize a ray to a 16-bit coherence key: a 3-bit-per-axis origin
+// cell over the scene bounds in the high bits and an 11x11 octahedral
+// direction bucket in the low seven, then stable radix-sort the active
+// list by that key (two 8-bit passes, following the Morton sort in the
+// BVH builder).  Rays with nearby origins and similar directions then
+// run back-to-back through the traversal kernels.
+static void SortRaysByCoherenceKey(const std::vector<RayDifferential> &rays,
+                                   const Bounds3f &worldBound,
+                                   std::vector<int> *active) {
+    size_t n = active->size();
+    std::vector<uint16_t> keys(n);
+    Vector3f diagonal = worldBound.Diagonal();
+    Vector3f invDiagonal(
+        diagonal.x > 0 ? 1 / diagonal.x : 0,
+        diagonal.y > 0 ? 1 / diagonal.y : 0,
+        diagonal.z > 0 ? 1 / diagonal.z : 0);
+    for (size_t a = 0; a < n; ++a) {
+        const Ray &ray = rays[(*active)[a]];
+        Vector3f offset = ray.o - worldBound.pMin;
+        int cx = Clamp((int)(8 * offset.x * invDiagonal.x), 0, 7);
+        int cy = Clamp((int)(8 * offset.y * invDiagonal.y), 0, 7);
+        int cz = Clamp((int)(8 * offset.z * invDiagonal.z), 0, 7);
+        uint32_t cell = (cx << 6) | (cy << 3) | cz;
+        // Octahedral direction bucket
+        Vector3f d = ray.d;
+        Float norm = std::abs(d.x) + std::abs(d.y) + std::abs(d.z);
+        Float ou = norm > 0 ? d.x / norm : 0, ov = norm > 0 ? d.y / norm : 0;
+        if (d.z < 0) {
+            Float u = ou;
+            ou = (1 - std::abs(ov)) * (u >= 0 ? 1 : -1);
+            ov = (1 - std::abs(u)) * (ov >= 0 ? 1 : -1);
+        }
+        int bu = Clamp((int)((ou * .5f + .5f) * 11), 0, 10);
+        int bv = Clamp((int)((ov * .5f + .5f) * 11), 0, 10);
+        keys[a] = (uint16_t)((cell << 7) | (bu * 11 + bv));
+    }
+
+    // Two stable 8-bit counting passes
+    std::vector<int> scratch(n);
+    std::vector<uint16_t> scratchKeys(n);
+    std::vector<int> *in = active, *out = &scratch;
+    std::vector<uint16_t> *inKeys = &keys, *outKeys = &scratchKeys;
+    for (int pass = 0; pass < 2; ++pass) {
+        int shift = 8 * pass;
+        int bucketCount[256] = {0};
+        for (size_t a = 0; a < n; ++a)
+            ++bucketCount[((*inKeys)[a] >> shift) & 0xff];
+        int bucketStart[256];
+        int start = 0;
+        for (int b = 0; b < 256; ++b) {
+            bucketStart[b] = start;
+            start += bucketCount[b];
+        }
+        for (size_t a = 0; a < n; ++a) {
+            int bucket = ((*inKeys)[a] >> shift) & 0xff;
+            (*out)[bucketStart[bucket]] = (*in)[a];
+            (*outKeys)[bucketStart[bucket]++] = (*inKeys)[a];
+        }
+        std::swap(in, out);
+        std::swap(inKeys, outKeys);
+    }
+    // Two passes leave the result back in *active
+}
+
+// WavefrontPathIntegrator Method Definitions
+void WavefrontPathIntegrator::Render(const Scene &scene) {
+    ProfilePhase p(Prof::IntegratorRender);
+    Bounds2i sampleBounds = camera->film->GetSampleBounds();
+    Vector2i sampleExtent = sampleBounds.Diagonal();
+    const int tileSize = 16;
+    Point2i nTiles((sampleExtent.x + tileSize - 1) / tileSize,
+                   (sampleExtent.y + tileSize - 1) / tileSize);
+    ProgressReporter reporter(nTiles.x * nTiles.y, "Rendering");
+    {
+        StatTimer timer(&wavefrontRenderingTime);
+        ParallelFor2D([&](Point2i tile) {
+            MemoryArena arena;
+
+            // Compute sample bounds for tile
+            int x0 = sampleBounds.pMin.x + tile.x * tileSize;
+            int x1 = std::min(x0 + tileSize, sampleBounds.pMax.x);
+            int y0 = sampleBounds.pMin.y + tile.y * tileSize;
+            int y1 = std::min(y0 + tileSize, sampleBounds.pMax.y);
+            Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
+            int nPixels = std::max(0, tileBounds.Area());
+            if (nPixels == 0) return;
+            std::unique_ptr<FilmTile> filmTile =
+                camera->film->GetFilmTile(tileBounds);
+
+            // Per-path wavefront state; each pixel of the tile
+            // contributes one path per wave
+            int seed = tile.y * nTiles.x + tile.x;
+            std::vector<std::unique_ptr<Sampler>> samplers(nPixels);
+            std::vector<Point2i> pixels(nPixels);
+            {
+                int i = 0;
+                for (Point2i pixel : tileBounds) {
+                    samplers[i] = sampler->Clone(seed * nPixels + i);
+                    samplers[i]->StartPixel(pixel);
+                    pixels[i] = pixel;
+                    ++i;
+                }
+            }
+            std::vector<RayDifferential> rays(nPixels);
+            std::vector<Ray> streamRays(nPixels);
+            std::vector<SurfaceInteraction> isects(nPixels);
+            std::vector<SurfaceInteraction> waveIsects(nPixels);
+            std::vector<int> parked;
+            const Bounds3f worldBound = scene.WorldBound();
+            std::unique_ptr<bool[]> waveHits(new bool[nPixels]);
+            std::vector<Spectrum> L(nPixels), beta(nPixels);
+            std::vector<CameraSample> cameraSamples(nPixels);
+            std::vector<char> specularBounce(nPixels);
+            std::vector<int> active, next, shadeOrder;
+
+            // Advance all of the tile's pixels through their samples
+            // in lockstep, one wave per sample index
+            bool samplesLeft = true;
+            while (samplesLeft) {
+                // Launch the wave's camera rays
+                active.clear();
+                for (int i = 0; i < nPixels; ++i) {
+                    cameraSamples[i] =
+                        samplers[i]->GetCameraSample(pixels[i]);
+                    Float rayWeight = camera->GenerateRayDifferential(
+                        cameraSamples[i], &rays[i]);
+                    rays[i].ScaleDifferentials(
+                        1 / std::sqrt((Float)samplers[i]->samplesPerPixel));
+                    ++nWavefrontCameraRays;
+                    L[i] = Spectrum(0.f);
+                    beta[i] = Spectrum(rayWeight);
+                    specularBounce[i] = false;
+                    if (rayWeight > 0) active.push_back(i);
+                }
+
+                // Advance the wave bounce by bounce
+                for (int bounces = 0; !active.empty(); ++bounces) {
+                    // Stage 1: intersect the wave through the ray
+                    // stream interface and map the results back to
+                    // their paths.  Secondary bounces are first binned
+                    // by a 16-bit (origin cell, octahedral direction)
+                    // key and radix-sorted, so even diffuse rays
+                    // traverse the BVH in groups that share upper-tree
+                    // paths.
+                    if (bounces > 0 && active.size() > 64)
+                        SortRaysByCoherenceKey(rays, worldBound, &active);
+                    for (size_t a = 0; a < active.size(); ++a)
+                        streamRays[a] = rays[active[a]];
+                    if (bounces == 0) {
+                        // The coherent first-hit pass goes through the
+                        // pluggable offload backend (GPU when one has
+                        // registered itself, the CPU stream kernel
+                        // otherwise)
+                        GetPrimaryHitBackend()->TracePrimary(
+                            scene, &streamRays[0], &waveIsects[0],
+                            waveHits.get(), (int)active.size());
+                    } else {
+                        scene.IntersectStream(&streamRays[0], &waveIsects[0],
+                                              waveHits.get(),
+                                              (int)active.size());
+                    }
+                    for (size_t a = 0; a < active.size(); ++a) {
+                        if (waveHits[a]) isects[active[a]] = waveIsects[a];
+                        rays[active[a]].tMax = streamRays[a].tMax;
+                    }
+
+                    // Stage 2: handle escaped rays and find the paths
+                    // to shade, ordered by material for coherence
+                    shadeOrder.clear();
+                    for (size_t a = 0; a < active.size(); ++a) {
+                        int i = active[a];
+                        if (!waveHits[a]) {
+                            if (bounces == 0 || specularBounce[i])
+                                for (const auto &light : scene.lights)
+                                    L[i] += beta[i] * light->Le(rays[i]);
+                            continue;
+                        }
+                        if (bounces == 0 || specularBounce[i])
+                            L[i] += beta[i] * isects[i].Le(-rays[i].d);
+                        if (bounces < maxDepth) shadeOrder.push_back(i);
+                    }
+                    std::sort(shadeOrder.begin(), shadeOrder.end(),
+                              [&](int a, int b) {
+                                  const Material *ma =
+                                      isects[a].primitive->GetMaterial();
+                                  const Material *mb =
+                                      isects[b].primitive->GetMaterial();
+                                  return ma < mb;
+                              });
+
+                    // Stage 3: shade the wave's hits in material
+                    // order.  With the tiled texture cache active, a
+                    // path whose scattering-function setup touches a
+                    // non-resident tile is parked -- keyed by the
+                    // asynchronous tile load it triggered -- while the
+                    // worker shades other rays, then reshaded once the
+                    // loader thread has streamed the tiles in.
+                    TiledTextureCache *texCache =
+                        TiledTextureCache::GetInstance();
+                    next.clear();
+                    auto shadePath = [&](int i) {
+                        SurfaceInteraction &isect = isects[i];
+                        Sampler &pathSampler = *samplers[i];
+                        if (!isect.bsdf) {
+                            rays[i] = isect.SpawnRay(rays[i].d);
+                            next.push_back(i);
+                            return;
+                        }
+
+                        // Sample illumination (skipped for perfectly
+                        // specular BSDFs, as in PathIntegrator)
+                        if (isect.bsdf->NumComponents(
+                                BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0)
+                            L[i] += beta[i] * UniformSampleOneLight(
+                                                  isect, scene, arena,
+                                                  pathSampler);
+
+                        // Sample BSDF for the next path direction
+                        Vector3f wo = -rays[i].d, wi;
+                        Float pdf;
+                        BxDFType flags;
+                        Spectrum f = isect.bsdf->Sample_f(
+                            wo, &wi, pathSampler.Get2D(), &pdf, BSDF_ALL,
+                            &flags);
+                        if (f.IsBlack() || pdf == 0.f) return;
+                        beta[i] *= f * AbsDot(wi, isect.shading.n) / pdf;
+                        specularBounce[i] = (flags & BSDF_SPECULAR) != 0;
+                        rays[i] = isect.SpawnRay(wi);
+
+                        // Possibly terminate the path with Russian
+                        // roulette
+                        if (bounces > 3) {
+                            Float q =
+                                std::max((Float).05, 1 - beta[i].y());
+                            if (pathSampler.Get1D() < q) return;
+                            beta[i] /= 1 - q;
+                        }
+                        next.push_back(i);
+                    };
+                    parked.clear();
+                    for (int i : shadeOrder) {
+                        SurfaceInteraction &isect = isects[i];
+                        if (texCache)
+                            TiledTextureCache::SetNonBlocking(true);
+                        isect.ComputeScatteringFunctions(rays[i], arena,
+                                                         true);
+                        if (texCache) {
+                            TiledTextureCache::SetNonBlocking(false);
+                            if (TiledTextureCache::TookFault()) {
+                                // Park: the tile load is in flight;
+                                // only the scattering setup has run,
+                                // so the retry consumes no extra
+                                // sampler state
+                                parked.push_back(i);
+                                continue;
+                            }
+                        }
+                        shadePath(i);
+                    }
+                    if (!parked.empty()) {
+                        texCache->WaitForPendingLoads();
+                        for (int i : parked) {
+                            isects[i].ComputeScatteringFunctions(
+                                rays[i], arena, true);
+                            shadePath(i);
+                        }
+                    }
+                    active.swap(next);
+                    arena.Reset();
+                }
+
+                // Deposit the wave's radiance and advance the samplers
+                samplesLeft = false;
+                for (int i = 0; i < nPixels; ++i) {
+                    filmTile->AddSample(cameraSamples[i].pFilm, L[i],
+                                        1.f);
+                    if (samplers[i]->StartNextSample()) samplesLeft = true;
+                }
+            }
+            camera->film->MergeFilmTile(std::move(filmTile));
+            reporter.Update();
+        }, nTiles);
+        reporter.Done();
+    }
+    camera->film->FlushSplats();
+    camera->film->WriteImage();
+}
+
+WavefrontPathIntegrator *CreateWavefrontPathIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera) {
+    int maxDepth = params.FindOneInt("maxdepth", 5);
+    return new WavefrontPathIntegrator(maxDepth, camera, sampler);
+}
@@ -0,0 +1,75 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_WAVEFRONTPATH_H
+#define PBRT_INTEGRATORS_WAVEFRONTPATH_H
+
+// integrators/wavefrontpath.h*
+#include "pbrt.h"
+#include "integrator.h"
+
+// WavefrontPathIntegrator Declarations
+//
+// Path tracing restructured into per-tile wavefronts: one wave of paths
+// (one camera sample per pixel of a tile) advances bounce by bounce,
+// with each stage run as a batch -- the intersections go through the
+// scene's ray-stream interface and shading visits the wave's hits
+// sorted by material, so BVH traversal, texture access, and BSDF
+// evaluation all touch memory coherently instead of interleaving one
+// divergent path at a time.  Ray differentials are not propagated along
+// wavefront paths; texture lookups beyond the camera hit filter at the
+// finest level, as with the stream interface itself.
+class WavefrontPathIntegrator : public Integrator {
+  public:
+    // WavefrontPathIntegrator Public Methods
+    WavefrontPathIntegrator(int maxDepth, std::shared_ptr<const Camera> camera,
+                            std::shared_ptr<Sampler> sampler)
+        : maxDepth(maxDepth), camera(camera), sampler(sampler) {}
+    void Render(const Scene &scene);
+
+  private:
+    // WavefrontPathIntegrator Private Data
+    const int maxDepth;
+    std::shared_ptr<const Camera> camera;
+    std::shared_ptr<Sampler> sampler;
+};
+
+WavefrontPathIntegrator *CreateWavefrontPathIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera);
+
+#endif  // PBRT_INTEGRATORS_WAVEFRONTPATH_H
@@ -54,8 +54,12 @@ Spectrum WhittedIntegrator::Li(const RayDifferential &ray, const Scene &scene,
     const Normal3f &n = isect.shading.n;
     Vector3f wo = isect.wo;
 
-    // Compute scattering functions for surface interaction
-    isect.ComputeScatteringFunctions(ray, arena);
+    // Compute scattering functions for surface interaction, reusing
+    // the pixel's previous primary-hit evaluation when enabled
+    if (shadingReuse && depth == 0)
+        ComputeOrReusePrimaryShading(&isect, ray, 1e-3f);
+    else
+        isect.ComputeScatteringFunctions(ray, arena);
     if (!isect.bsdf)
         return Li(isect.SpawnRay(ray.d), scene, sampler, arena, depth);
 
@@ -86,5 +90,6 @@ WhittedIntegrator *CreateWhittedIntegrator(
     const ParamSet &params, std::shared_ptr<Sampler> sampler,
     std::shared_ptr<const Camera> camera) {
     int maxDepth = params.FindOneInt("maxdepth", 5);
-    return new WhittedIntegrator(maxDepth, camera, sampler);
+    bool shadingReuse = params.FindOneBool("shadingreuse", false);
+    return new WhittedIntegrator(maxDepth, camera, sampler, shadingReuse);
 }
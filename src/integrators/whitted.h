@@ -48,14 +48,18 @@ class WhittedIntegrator : public SamplerIntegrator {
   public:
     // WhittedIntegrator Public Methods
     WhittedIntegrator(int maxDepth, std::shared_ptr<const Camera> camera,
-                      std::shared_ptr<Sampler> sampler)
-        : SamplerIntegrator(camera, sampler), maxDepth(maxDepth) {}
+                      std::shared_ptr<Sampler> sampler,
+                      bool shadingReuse = false)
+        : SamplerIntegrator(camera, sampler),
+          maxDepth(maxDepth),
+          shadingReuse(shadingReuse) {}
     Spectrum Li(const RayDifferential &ray, const Scene &scene,
                 Sampler &sampler, MemoryArena &arena, int depth) const;
 
   private:
     // WhittedIntegrator Private Data
     const int maxDepth;
+    const bool shadingReuse;
 };
 
 WhittedIntegrator *CreateWhittedIntegrator(
@@ -44,12 +44,42 @@ DiffuseAreaLight::DiffuseAreaLight(const Transform &LightToWorld,
     : AreaLight(LightToWorld, mediumInterface, nSamples),
       Lemit(Lemit),
       shape(shape),
-      area(shape->Area()) {}
+      area(shape->Area()) {
+    // Cache the emitter's normal cone and bound for receiver culling
+    Float cosTheta;
+    coneValid = shape->OrientationCone(&coneAxis, &cosTheta);
+    if (coneValid) {
+        coneSinTheta =
+            std::sqrt(std::max((Float)0, 1 - cosTheta * cosTheta));
+        coneBound = shape->WorldBound();
+    }
+}
+
+bool DiffuseAreaLight::CullReceiver(const Point3f &p) const {
+    if (!coneValid) return false;
+    // The receiver can only be lit if some bound corner sees it within
+    // the emission hemisphere widened by the normal cone's half-angle;
+    // each test is a dot product against the corner direction
+    for (int c = 0; c < 8; ++c) {
+        Point3f corner = coneBound.Corner(c);
+        Vector3f d = p - corner;
+        Float len = d.Length();
+        if (len == 0) return false;
+        if (Dot(coneAxis, d) > -coneSinTheta * len) return false;
+    }
+    return true;
+}
 Spectrum DiffuseAreaLight::Power() const { return Lemit * area * Pi; }
 
 Spectrum DiffuseAreaLight::Sample_Li(const Interaction &ref, const Point2f &u,
                                      Vector3f *wi, Float *pdf,
                                      VisibilityTester *vis) const {
+    // Reject provably back-facing emitter/receiver pairs before
+    // paying for the shape sample
+    if (CullReceiver(ref.p)) {
+        *pdf = 0;
+        return Spectrum(0.f);
+    }
     Interaction pShape = shape->Sample(ref, u);
     pShape.mediumInterface = mediumInterface;
     *wi = Normalize(pShape.p - ref.p);
@@ -54,6 +54,7 @@ class DiffuseAreaLight : public AreaLight {
         return Dot(intr.n, w) > 0.f ? Lemit : Spectrum(0.f);
     }
     Spectrum Power() const;
+    Bounds3f WorldBound() const { return shape->WorldBound(); }
     Spectrum Sample_Li(const Interaction &ref, const Point2f &u, Vector3f *wo,
                        Float *pdf, VisibilityTester *vis) const;
     Float Pdf_Li(const Interaction &, const Vector3f &) const;
@@ -64,10 +65,21 @@ class DiffuseAreaLight : public AreaLight {
                 Float *pdfDir) const;
 
   protected:
+    // DiffuseAreaLight Protected Methods
+    // Conservative orientation cull: true when no point of the
+    // emitter's bound can face _p_ given the shape's normal cone, so
+    // every light sample toward _p_ is provably zero
+    bool CullReceiver(const Point3f &p) const;
+
     // DiffuseAreaLight Protected Data
     const Spectrum Lemit;
     std::shared_ptr<Shape> shape;
     const Float area;
+    // Emitter orientation metadata from Shape::OrientationCone()
+    bool coneValid;
+    Vector3f coneAxis;
+    Float coneSinTheta;
+    Bounds3f coneBound;
 };
 
 std::shared_ptr<AreaLight> CreateDiffuseAreaLight(
@@ -35,6 +35,8 @@
 #include "lights/goniometric.h"
 #include "paramset.h"
 #include "sampling.h"
+#include "floatfile.h"
+#include <cstdio>
 
 // GonioPhotometricLight Method Definitions
 Spectrum GonioPhotometricLight::Sample_Li(const Interaction &ref,
@@ -48,10 +50,147 @@ Spectrum GonioPhotometricLight::Sample_Li(const Interaction &ref,
     return I * Scale(-*wi) / DistanceSquared(pLight, ref.p);
 }
 
+// Parse an IESNA LM-63 photometric file (TILT=NONE) into an
+// equirectangular intensity image: rows span the vertical angles
+// (0 = nadir) and columns the horizontal angles, with the candela grid
+// interpolated bilinearly.
+std::unique_ptr<RGBSpectrum[]> GonioPhotometricLight::ReadIESFile(
+    const std::string &filename, Point2i *resolution) {
+    FILE *f = fopen(filename.c_str(), "r");
+    if (!f) {
+        Warning("Unable to open IES file \"%s\"", filename.c_str());
+        return nullptr;
+    }
+
+    // Skip header lines through the TILT specification
+    char line[512];
+    bool sawTilt = false;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "TILT=", 5) == 0) {
+            sawTilt = true;
+            if (strncmp(line, "TILT=NONE", 9) != 0) {
+                Warning("IES file \"%s\": only TILT=NONE is supported",
+                        filename.c_str());
+                fclose(f);
+                return nullptr;
+            }
+            break;
+        }
+    }
+    if (!sawTilt) {
+        Warning("IES file \"%s\": no TILT line found", filename.c_str());
+        fclose(f);
+        return nullptr;
+    }
+
+    // Read the photometric description and angle/candela tables
+    auto readFloat = [&](Float *v) {
+        float value;
+        if (fscanf(f, "%f", &value) != 1) return false;
+        *v = value;
+        return true;
+    };
+    Float nLamps, lumens, multiplier, nVertF, nHorizF, photometricType,
+        units, width, length, height, ballast, future, watts;
+    bool ok = readFloat(&nLamps) && readFloat(&lumens) &&
+              readFloat(&multiplier) && readFloat(&nVertF) &&
+              readFloat(&nHorizF) && readFloat(&photometricType) &&
+              readFloat(&units) && readFloat(&width) && readFloat(&length) &&
+              readFloat(&height) && readFloat(&ballast) &&
+              readFloat(&future) && readFloat(&watts);
+    int nVert = (int)nVertF, nHoriz = (int)nHorizF;
+    if (!ok || nVert < 2 || nHoriz < 1) {
+        Warning("IES file \"%s\": malformed header", filename.c_str());
+        fclose(f);
+        return nullptr;
+    }
+    std::vector<Float> vertAngles(nVert), horizAngles(nHoriz),
+        candela(nVert * nHoriz);
+    for (int i = 0; ok && i < nVert; ++i) ok = readFloat(&vertAngles[i]);
+    for (int i = 0; ok && i < nHoriz; ++i) ok = readFloat(&horizAngles[i]);
+    for (int h = 0; ok && h < nHoriz; ++h)
+        for (int v = 0; v < nVert && ok; ++v)
+            ok = readFloat(&candela[h * nVert + v]);
+    fclose(f);
+    if (!ok) {
+        Warning("IES file \"%s\": truncated tables", filename.c_str());
+        return nullptr;
+    }
+
+    // Rasterize to an equirectangular image; candela values outside
+    // the tabulated vertical range are zero, and a single horizontal
+    // plane means rotational symmetry
+    auto lookup1D = [](const std::vector<Float> &angles,
+                       const std::vector<Float> &, Float a, int *i0,
+                       Float *t) {
+        if (a <= angles.front()) {
+            *i0 = 0;
+            *t = 0;
+            return a >= angles.front();
+        }
+        if (a >= angles.back()) {
+            *i0 = (int)angles.size() - 2;
+            *t = 1;
+            return a <= angles.back();
+        }
+        int i = 0;
+        while (a > angles[i + 1]) ++i;
+        *i0 = i;
+        *t = (a - angles[i]) / (angles[i + 1] - angles[i]);
+        return true;
+    };
+    *resolution = Point2i(2 * 64, 64);
+    std::unique_ptr<RGBSpectrum[]> texels(
+        new RGBSpectrum[resolution->x * resolution->y]);
+    for (int y = 0; y < resolution->y; ++y) {
+        Float vertAngle = 180 * (y + .5f) / resolution->y;
+        for (int x = 0; x < resolution->x; ++x) {
+            Float horizAngle = 360 * (x + .5f) / resolution->x;
+            if (nHoriz > 1 && horizAngle > horizAngles.back())
+                // Mirror into the tabulated horizontal range
+                horizAngle = std::max(
+                    horizAngles.front(),
+                    std::min(horizAngles.back(),
+                             360 - horizAngle));
+            int vi, hi = 0;
+            Float vt, ht = 0;
+            Float value = 0;
+            if (lookup1D(vertAngles, vertAngles, vertAngle, &vi, &vt) &&
+                (nHoriz == 1 ||
+                 lookup1D(horizAngles, horizAngles, horizAngle, &hi, &ht))) {
+                Float c00 = candela[hi * nVert + vi];
+                Float c01 = candela[hi * nVert + vi + 1];
+                Float c0 = Lerp(vt, c00, c01);
+                if (nHoriz > 1) {
+                    Float c10 = candela[(hi + 1) * nVert + vi];
+                    Float c11 = candela[(hi + 1) * nVert + vi + 1];
+                    c0 = Lerp(ht, c0, Lerp(vt, c10, c11));
+                }
+                value = multiplier * c0;
+            }
+            texels[y * resolution->x + x] = RGBSpectrum(value);
+        }
+    }
+    return texels;
+}
+
 Spectrum GonioPhotometricLight::Power() const {
-    return 4 * Pi * I * Spectrum(mipmap ? mipmap->Lookup(Point2f(.5f, .5f), .5f)
-                                        : RGBSpectrum(1.f),
-                                 SpectrumType::Illuminant);
+    if (!mipmap) return 4 * Pi * I;
+
+    // Integrate the goniometric image over the sphere
+    Float sum = 0;
+    const int nu = 32, nv = 16;
+    for (int v = 0; v < nv; ++v) {
+        Float sinTheta = std::sin(Pi * (v + .5f) / nv);
+        for (int u = 0; u < nu; ++u)
+            sum += mipmap->Lookup(Point2f((u + .5f) / nu, (v + .5f) / nv),
+                                  .5f)
+                       .y() *
+                   sinTheta;
+    }
+    // Midpoint rule over the sphere: each cell covers
+    // (2 pi / nu) x (pi / nv), so the integral is sum * 2 pi^2 / (nu nv)
+    return I * sum * 2 * Pi * Pi / (nu * nv);
 }
 
 Float GonioPhotometricLight::Pdf_Li(const Interaction &,
@@ -63,18 +202,46 @@ Spectrum GonioPhotometricLight::Sample_Le(const Point2f &u1, const Point2f &u2,
                                           Float time, Ray *ray,
                                           Normal3f *nLight, Float *pdfPos,
                                           Float *pdfDir) const {
-    *ray = Ray(pLight, UniformSampleSphere(u1), Infinity, time,
-               mediumInterface.inside);
+    Vector3f w;
+    if (distribution) {
+        // Importance-sample the goniometric distribution for the
+        // emitted direction
+        Float mapPdf;
+        Point2f uv = distribution->SampleContinuous(u1, &mapPdf);
+        if (mapPdf == 0) return Spectrum(0.f);
+        Float theta = uv[1] * Pi, phi = uv[0] * 2 * Pi;
+        Float sinTheta = std::sin(theta);
+        Vector3f wLight(sinTheta * std::cos(phi), sinTheta * std::sin(phi),
+                        std::cos(theta));
+        // Undo the y/z swap applied by Scale()'s parameterization
+        std::swap(wLight.y, wLight.z);
+        w = LightToWorld(wLight);
+        *pdfDir = sinTheta == 0 ? 0 : mapPdf / (2 * Pi * Pi * sinTheta);
+    } else {
+        w = UniformSampleSphere(u1);
+        *pdfDir = UniformSpherePdf();
+    }
+    *ray = Ray(pLight, w, Infinity, time, mediumInterface.inside);
     *nLight = (Normal3f)ray->d;
     *pdfPos = 1.f;
-    *pdfDir = UniformSpherePdf();
     return I * Scale(ray->d);
 }
 
-void GonioPhotometricLight::Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
-                                   Float *pdfDir) const {
+void GonioPhotometricLight::Pdf_Le(const Ray &ray, const Normal3f &,
+                                   Float *pdfPos, Float *pdfDir) const {
     *pdfPos = 0.f;
-    *pdfDir = UniformSpherePdf();
+    if (distribution) {
+        Vector3f wp = Normalize(WorldToLight(ray.d));
+        std::swap(wp.y, wp.z);
+        Float theta = SphericalTheta(wp), phi = SphericalPhi(wp);
+        Float sinTheta = std::sin(theta);
+        *pdfDir = sinTheta == 0
+                      ? 0
+                      : distribution->Pdf(Point2f(phi * Inv2Pi,
+                                                  theta * InvPi)) /
+                            (2 * Pi * Pi * sinTheta);
+    } else
+        *pdfDir = UniformSpherePdf();
 }
 
 std::shared_ptr<GonioPhotometricLight> CreateGoniometricLight(
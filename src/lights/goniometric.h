@@ -44,6 +44,7 @@
 #include "shape.h"
 #include "scene.h"
 #include "mipmap.h"
+#include "sampling.h"
 #include "imageio.h"
 
 // GonioPhotometricLight Declarations
@@ -58,11 +59,36 @@ class GonioPhotometricLight : public Light {
         : Light((int)LightFlags::DeltaPosition, LightToWorld, mediumInterface),
           pLight(LightToWorld(Point3f(0, 0, 0))),
           I(I) {
-        // Create _mipmap_ for _GonioPhotometricLight_
+        // Create _mipmap_ for _GonioPhotometricLight_; .ies photometric
+        // files are ingested into an equirectangular image first
         Point2i resolution;
-        std::unique_ptr<RGBSpectrum[]> texels = ReadImage(texname, &resolution);
-        if (texels)
+        std::unique_ptr<RGBSpectrum[]> texels =
+            HasExtension(texname, "ies")
+                ? ReadIESFile(texname, &resolution)
+                : ReadImage(texname, &resolution);
+        if (texels) {
             mipmap.reset(new MIPMap<RGBSpectrum>(resolution, texels.get()));
+
+            // Build the sampling distribution over the goniometric
+            // image, weighted by row solid angle, so emission sampling
+            // follows the fixture's actual pattern
+            std::unique_ptr<Float[]> img(
+                new Float[resolution.x * resolution.y]);
+            for (int v = 0; v < resolution.y; ++v) {
+                Float sinTheta =
+                    std::sin(Pi * Float(v + .5f) / Float(resolution.y));
+                for (int u = 0; u < resolution.x; ++u)
+                    img[v * resolution.x + u] =
+                        mipmap->Lookup(
+                                  Point2f((u + .5f) / resolution.x,
+                                          (v + .5f) / resolution.y),
+                                  0)
+                            .y() *
+                        sinTheta;
+            }
+            distribution.reset(
+                new Distribution2D(img.get(), resolution.x, resolution.y));
+        }
     }
     Spectrum Scale(const Vector3f &w) const {
         Vector3f wp = Normalize(WorldToLight(w));
@@ -74,6 +100,7 @@ class GonioPhotometricLight : public Light {
                        : Spectrum(mipmap->Lookup(st), SpectrumType::Illuminant);
     }
     Spectrum Power() const;
+    Bounds3f WorldBound() const { return Bounds3f(pLight, pLight); }
     Float Pdf_Li(const Interaction &, const Vector3f &) const;
     Spectrum Sample_Le(const Point2f &u1, const Point2f &u2, Float time,
                        Ray *ray, Normal3f *nLight, Float *pdfPos,
@@ -82,10 +109,16 @@ class GonioPhotometricLight : public Light {
                 Float *pdfDir) const;
 
   private:
+    // GonioPhotometricLight Private Data
+    // GonioPhotometricLight Private Methods
+    static std::unique_ptr<RGBSpectrum[]> ReadIESFile(
+        const std::string &filename, Point2i *resolution);
+
     // GonioPhotometricLight Private Data
     const Point3f pLight;
     const Spectrum I;
     std::unique_ptr<MIPMap<RGBSpectrum>> mipmap;
+    std::unique_ptr<Distribution2D> distribution;
 };
 
 std::shared_ptr<GonioPhotometricLight> CreateGoniometricLight(
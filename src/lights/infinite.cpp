@@ -35,12 +35,77 @@
 #include "lights/infinite.h"
 #include "sampling.h"
 #include "paramset.h"
+#include "parallel.h"
 #include "imageio.h"
 
+// Environment-map luminance cache file layout: a small validated
+// header, then the width*height sin-theta-weighted luminance values
+// the sampling distribution is built from.  The luminance scale
+// applied to the map cancels in the normalized distribution, so one
+// cache serves a sky at any intensity.
+struct LuminanceCacheHeader {
+    uint32_t magic, version;
+    uint32_t floatSize;
+    int32_t width, height;
+    uint64_t sourceSize;  // size of the source map, to catch edits
+};
+static const uint32_t luminanceCacheMagic = 0x4c454250;  // "PBEL"
+static const uint32_t luminanceCacheVersion = 1;
+
+static uint64_t FileSize(const std::string &filename) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size < 0 ? 0 : (uint64_t)size;
+}
+
+static bool ReadLuminanceCache(const std::string &filename,
+                               uint64_t sourceSize, int width, int height,
+                               Float *img) {
+    if (filename.empty()) return false;
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    LuminanceCacheHeader header;
+    size_t count = (size_t)width * height;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              header.magic == luminanceCacheMagic &&
+              header.version == luminanceCacheVersion &&
+              header.floatSize == sizeof(Float) && header.width == width &&
+              header.height == height && header.sourceSize == sourceSize &&
+              fread(img, sizeof(Float), count, f) == count;
+    fclose(f);
+    return ok;
+}
+
+static void WriteLuminanceCache(const std::string &filename,
+                                uint64_t sourceSize, int width, int height,
+                                const Float *img) {
+    if (filename.empty()) return;
+    std::string tmpName = filename + ".tmp";
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (!f) return;
+    LuminanceCacheHeader header;
+    header.magic = luminanceCacheMagic;
+    header.version = luminanceCacheVersion;
+    header.floatSize = sizeof(Float);
+    header.width = width;
+    header.height = height;
+    header.sourceSize = sourceSize;
+    size_t count = (size_t)width * height;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(img, sizeof(Float), count, f) == count;
+    fclose(f);
+    if (!ok || rename(tmpName.c_str(), filename.c_str()) != 0)
+        remove(tmpName.c_str());
+}
+
 // InfiniteAreaLight Method Definitions
 InfiniteAreaLight::InfiniteAreaLight(const Transform &LightToWorld,
                                      const Spectrum &L, int nSamples,
-                                     const std::string &texmap)
+                                     const std::string &texmap,
+                                     bool misCompensation)
     : Light((int)LightFlags::Infinite, LightToWorld, MediumInterface(),
             nSamples) {
     // Read texel data from _texmap_ and initialize _Lmap_
@@ -61,17 +126,62 @@ InfiniteAreaLight::InfiniteAreaLight(const Transform &LightToWorld,
 
     // Initialize sampling PDFs for infinite area light
 
-    // Compute scalar-valued image _img_ from environment map
+    // Compute scalar-valued image _img_ from environment map, reusing
+    // the on-disk luminance cache when this sky was processed before
     int width = Lmap->Width(), height = Lmap->Height();
     std::unique_ptr<Float[]> img(new Float[width * height]);
-    for (int v = 0; v < height; ++v) {
-        Float vp = (Float)v / (Float)height;
-        Float sinTheta = std::sin(Pi * Float(v + .5f) / Float(height));
-        for (int u = 0; u < width; ++u) {
-            Float up = (Float)u / (Float)width;
-            img[u + v * width] = Lmap->Lookup(Point2f(up, vp)).y();
-            img[u + v * width] *= sinTheta;
+    std::string cacheName =
+        texmap != "" ? texmap + ".lumcache" : std::string();
+    uint64_t sourceSize = texmap != "" ? FileSize(texmap) : 0;
+    if (!ReadLuminanceCache(cacheName, sourceSize, width, height,
+                            img.get())) {
+        ParallelFor([&](int64_t v) {
+            Float vp = (Float)v / (Float)height;
+            Float sinTheta = std::sin(Pi * Float(v + .5f) / Float(height));
+            for (int u = 0; u < width; ++u) {
+                Float up = (Float)u / (Float)width;
+                img[u + v * width] = Lmap->Lookup(Point2f(up, vp)).y();
+                img[u + v * width] *= sinTheta;
+            }
+        }, height, 8);
+        WriteLuminanceCache(cacheName, sourceSize, width, height, img.get());
+    }
+
+    // MIS compensation ("bool miscompensation", Karlik et al.):
+    // subtract the map's average luminance before building the
+    // importance map, so regions BSDF sampling already covers well
+    // stop soaking up light samples.  Directions whose weight clamps
+    // to zero stay unbiased through the BSDF-sampling half of the MIS
+    // estimator, which covers them with weight one.
+    if (misCompensation) {
+        double weightedSum = 0, sinSum = 0;
+        for (int v = 0; v < height; ++v) {
+            Float sinTheta = std::sin(Pi * Float(v + .5f) / Float(height));
+            sinSum += (double)width * sinTheta;
+            for (int u = 0; u < width; ++u)
+                weightedSum += img[u + v * width];
+        }
+        Float average = sinSum > 0 ? (Float)(weightedSum / sinSum) : 0;
+        double compensatedSum = 0;
+        for (int v = 0; v < height; ++v) {
+            Float sinTheta = std::sin(Pi * Float(v + .5f) / Float(height));
+            for (int u = 0; u < width; ++u)
+                compensatedSum += std::max(
+                    (Float)0, img[u + v * width] - average * sinTheta);
         }
+        if (compensatedSum > 0) {
+            for (int v = 0; v < height; ++v) {
+                Float sinTheta =
+                    std::sin(Pi * Float(v + .5f) / Float(height));
+                for (int u = 0; u < width; ++u)
+                    img[u + v * width] = std::max(
+                        (Float)0, img[u + v * width] - average * sinTheta);
+            }
+        } else
+            // A constant map compensates to nothing; keep the
+            // uncompensated distribution
+            Warning("MIS compensation disabled for near-constant "
+                    "environment map");
     }
 
     // Compute sampling distributions for rows and columns of image
@@ -90,12 +200,51 @@ Spectrum InfiniteAreaLight::Le(const RayDifferential &ray) const {
     return Spectrum(Lmap->Lookup(st), SpectrumType::Illuminant);
 }
 
+void InfiniteAreaLight::SetPortal(const Point3f corners[4]) {
+    portalOrigin = corners[0];
+    portalE1 = corners[1] - corners[0];
+    portalE2 = corners[3] - corners[0];
+    Vector3f cross = Cross(portalE1, portalE2);
+    portalArea = cross.Length();
+    if (portalArea == 0) {
+        Warning("Ignoring degenerate infinite light portal");
+        return;
+    }
+    portalNormal = cross / portalArea;
+    hasPortal = true;
+}
+
 Spectrum InfiniteAreaLight::Sample_Li(const Interaction &ref, const Point2f &u,
                                       Vector3f *wi, Float *pdf,
                                       VisibilityTester *vis) const {
+    if (hasPortal) {
+        // Sample a point on the portal and weight by the area-to-solid-
+        // angle conversion; the environment is assumed visible through
+        // the portal, so the visibility ray only runs to it
+        Point3f q = portalOrigin + u[0] * portalE1 + u[1] * portalE2;
+        Vector3f d = q - ref.p;
+        Float dist2 = d.LengthSquared();
+        if (dist2 == 0) {
+            *pdf = 0;
+            return Spectrum(0.f);
+        }
+        *wi = d / std::sqrt(dist2);
+        Float cosPortal = AbsDot(*wi, portalNormal);
+        if (cosPortal == 0) {
+            *pdf = 0;
+            return Spectrum(0.f);
+        }
+        *pdf = dist2 / (cosPortal * portalArea);
+        *vis = VisibilityTester(ref,
+                                Interaction(q, ref.time, mediumInterface));
+        Vector3f w = WorldToLight(*wi);
+        Point2f st(SphericalPhi(w) * Inv2Pi, SphericalTheta(w) * InvPi);
+        return Spectrum(Lmap->Lookup(st), SpectrumType::Illuminant);
+    }
+
     // Find $(u,v)$ sample coordinates in infinite light texture
     Float mapPdf;
-    Point2f uv = distribution->SampleContinuous(u, &mapPdf);
+    Point2f uv = distribution->SampleContinuousAlias(u, &mapPdf);
     uv[0] -= (Float)0.5 / Lmap->Width();
     uv[1] -= (Float)0.5 / Lmap->Height();
     if (mapPdf == 0) return Spectrum(0.f);
@@ -117,7 +266,23 @@ Spectrum InfiniteAreaLight::Sample_Li(const Interaction &ref, const Point2f &u,
     return Spectrum(Lmap->Lookup(uv), SpectrumType::Illuminant);
 }
 
-Float InfiniteAreaLight::Pdf_Li(const Interaction &, const Vector3f &w) const {
+Float InfiniteAreaLight::Pdf_Li(const Interaction &it,
+                                const Vector3f &w) const {
+    if (hasPortal) {
+        // Only directions through the portal are sampled; convert the
+        // portal's area pdf at the crossing point to solid angle
+        Float denom = Dot(w, portalNormal);
+        if (denom == 0) return 0;
+        Float t = Dot(portalOrigin - it.p, portalNormal) / denom;
+        if (t <= 0) return 0;
+        Point3f q = it.p + t * w;
+        Vector3f rel = q - portalOrigin;
+        Float a = Dot(rel, portalE1) / portalE1.LengthSquared();
+        Float b = Dot(rel, portalE2) / portalE2.LengthSquared();
+        if (a < 0 || a > 1 || b < 0 || b > 1) return 0;
+        Float dist2 = DistanceSquared(it.p, q);
+        return dist2 / (std::abs(denom) / w.Length() * portalArea);
+    }
     Vector3f wi = WorldToLight(w);
     Float theta = SphericalTheta(wi), phi = SphericalPhi(wi);
     Float sinTheta = std::sin(theta);
@@ -134,7 +299,7 @@ Spectrum InfiniteAreaLight::Sample_Le(const Point2f &u1, const Point2f &u2,
 
     // Find $(u,v)$ sample coordinates in infinite light texture
     Float mapPdf;
-    Point2f uv = distribution->SampleContinuous(u, &mapPdf);
+    Point2f uv = distribution->SampleContinuousAlias(u, &mapPdf);
     uv[0] -= (Float)0.5 / Lmap->Width();
     uv[1] -= (Float)0.5 / Lmap->Height();
     if (mapPdf == 0) return Spectrum(0.f);
@@ -175,6 +340,19 @@ std::shared_ptr<InfiniteAreaLight> CreateInfiniteLight(
     std::string texmap = paramSet.FindOneFilename("mapname", "");
     int nSamples = paramSet.FindOneInt("nsamples", 1);
     if (PbrtOptions.quickRender) nSamples = std::max(1, nSamples / 4);
-    return std::make_shared<InfiniteAreaLight>(light2world, L * sc, nSamples,
-                                               texmap);
+    bool misCompensation = paramSet.FindOneBool("miscompensation", false);
+    std::shared_ptr<InfiniteAreaLight> light =
+        std::make_shared<InfiniteAreaLight>(light2world, L * sc, nSamples,
+                                            texmap, misCompensation);
+
+    // Optional rectangular portal (four corner points in world space)
+    int nPortal;
+    const Point3f *portal = paramSet.FindPoint3f("portal", &nPortal);
+    if (portal) {
+        if (nPortal == 4)
+            light->SetPortal(portal);
+        else
+            Error("Expected four points for infinite light \"portal\"");
+    }
+    return light;
 }
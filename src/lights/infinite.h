@@ -51,7 +51,12 @@ class InfiniteAreaLight : public Light {
   public:
     // InfiniteAreaLight Public Methods
     InfiniteAreaLight(const Transform &LightToWorld, const Spectrum &power,
-                      int nSamples, const std::string &texmap);
+                      int nSamples, const std::string &texmap,
+                      bool misCompensation = false);
+    // Restrict next-event estimation to a rectangular portal (e.g. a
+    // window): Sample_Li then samples points on the portal and Pdf_Li
+    // only credits directions passing through it
+    void SetPortal(const Point3f corners[4]);
     void Preprocess(const Scene &scene) {
         scene.WorldBound().BoundingSphere(&worldCenter, &worldRadius);
     }
@@ -71,6 +76,11 @@ class InfiniteAreaLight : public Light {
     std::unique_ptr<MIPMap<RGBSpectrum>> Lmap;
     Point3f worldCenter;
     Float worldRadius;
+    // Portal state (see SetPortal())
+    bool hasPortal = false;
+    Point3f portalOrigin;
+    Vector3f portalE1, portalE2, portalNormal;
+    Float portalArea = 0;
     std::unique_ptr<Distribution2D> distribution;
 };
 
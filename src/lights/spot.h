@@ -53,6 +53,7 @@ class SpotLight : public Light {
                        Float *pdf, VisibilityTester *vis) const;
     Float Falloff(const Vector3f &w) const;
     Spectrum Power() const;
+    Bounds3f WorldBound() const { return Bounds3f(pLight, pLight); }
     Float Pdf_Li(const Interaction &, const Vector3f &) const;
     Spectrum Sample_Le(const Point2f &u1, const Point2f &u2, Float time,
                        Ray *ray, Normal3f *nLight, Float *pdfPos,
@@ -34,6 +34,10 @@
 // main/pbrt.cpp*
 #include "pbrt.h"
 #include "api.h"
+#include <sys/stat.h>
+#include <chrono>
+#include <thread>
+#include "binaryscene.h"
 #include "parser.h"
 #include "parallel.h"
 
@@ -57,20 +61,107 @@ int main(int argc, char *argv[]) {
             options.cat = true;
         else if (!strcmp(argv[i], "--toply"))
             options.toPly = true;
+        else if (!strcmp(argv[i], "--resume"))
+            options.resume = true;
+        else if (!strcmp(argv[i], "--checkpointinterval"))
+            options.checkpointSeconds = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--previewinterval"))
+            options.previewSeconds = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--statsimage"))
+            options.statsImage = true;
+        else if (!strcmp(argv[i], "--spectrum"))
+            options.spectrum = argv[++i];
+        else if (!strcmp(argv[i], "--texcachemb"))
+            options.texCacheMB = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--deferredshapes"))
+            options.deferredShapes = true;
+        else if (!strcmp(argv[i], "--displacecachemb"))
+            options.displaceCacheMB = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--adaptive"))
+            options.adaptiveThreshold = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--distserve"))
+            options.distServe = argv[++i];
+        else if (!strcmp(argv[i], "--distworker"))
+            options.distWorker = argv[++i];
+        else if (!strcmp(argv[i], "--aovs"))
+            options.aovs = true;
+        else if (!strcmp(argv[i], "--seconds"))
+            options.renderSeconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--firsthitcache"))
+            options.firstHitCache = true;
+        else if (!strcmp(argv[i], "--tobinary"))
+            options.toBinaryFile = argv[++i];
+        else if (!strcmp(argv[i], "--parallelparse"))
+            options.parallelParse = true;
+        else if (!strcmp(argv[i], "--dry-run"))
+            options.dryRun = true;
+        else if (!strcmp(argv[i], "--memory-budget"))
+            options.memoryBudgetMB = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--streamout"))
+            options.streamOutFile = argv[++i];
+        else if (!strcmp(argv[i], "--hugepages"))
+            options.hugePages = true;
+        else if (!strcmp(argv[i], "--profilesample"))
+            options.profileSampleRate = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--trace"))
+            options.traceFile = argv[++i];
+        else if (!strcmp(argv[i], "--benchmark"))
+            options.benchmarkFile = argv[++i];
+        else if (!strcmp(argv[i], "--perfcounters"))
+            options.perfCounters = true;
+        else if (!strcmp(argv[i], "--dither"))
+            options.ditherOutput = true;
+        else if (!strcmp(argv[i], "--lodpixels"))
+            options.lodPixels = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--autoinstance"))
+            options.autoInstance = true;
+        else if (!strcmp(argv[i], "--progressjson"))
+            options.progressJson = argv[++i];
+        else if (!strcmp(argv[i], "--seed"))
+            options.seed = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--daemon"))
+            options.daemon = true;
+        else if (!strcmp(argv[i], "--motionbuckets"))
+            options.motionBuckets = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--sharedmem"))
+            options.sharedMem = true;
+        else if (!strcmp(argv[i], "--pipeline"))
+            options.framePipeline = true;
+        else if (!strcmp(argv[i], "--statsdb"))
+            options.statsDb = argv[++i];
         else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
             printf(
                 "usage: pbrt [--nthreads n] [--outfile filename] [--quick] "
-                "[--quiet] [--cat] [--toply] [--verbose] [--help] "
+                "[--quiet] [--cat] [--toply] [--verbose] "
+                "[--checkpointinterval seconds] [--previewinterval seconds] "
+                "[--resume] [--spectrum rgb|sampled] [--statsimage] "
+                "[--texcachemb n] [--deferredshapes] [--help] "
                 "<filename.pbrt> ...\n");
             return 0;
         } else
             filenames.push_back(argv[i]);
     }
 
+    // Check that the requested spectral pipeline matches this binary
+#ifdef PBRT_SAMPLED_SPECTRUM
+    const char *compiledSpectrum = "sampled";
+#else
+    const char *compiledSpectrum = "rgb";
+#endif  // PBRT_SAMPLED_SPECTRUM
+    if (options.spectrum != "" && options.spectrum != compiledSpectrum) {
+        fprintf(stderr,
+                "pbrt: this binary was built with the \"%s\" spectral "
+                "pipeline; rebuild with PBRT_SAMPLED_SPECTRUM=%s for "
+                "\"%s\".\n",
+                compiledSpectrum, options.spectrum == "sampled" ? "ON" : "OFF",
+                options.spectrum.c_str());
+        return 1;
+    }
+
     // Print welcome banner
     if (!options.quiet && !options.cat && !options.toPly) {
-        printf("pbrt version 3 (built %s at %s) [Detected %d cores]\n",
-               __DATE__, __TIME__, NumSystemCores());
+        printf("pbrt version 3 (built %s at %s) [Detected %d cores, %s spectrum]\n",
+               __DATE__, __TIME__, NumSystemCores(), compiledSpectrum);
 #ifndef NDEBUG
         printf("*** DEBUG BUILD ***\n");
 #endif // !NDEBUG
@@ -83,6 +174,16 @@ int main(int argc, char *argv[]) {
         printf("See the file LICENSE.txt for the conditions of the license.\n");
         fflush(stdout);
     }
+    // Compile the scene to the binary token format and exit, if asked
+    if (options.toBinaryFile != "") {
+        if (filenames.size() != 1) {
+            fprintf(stderr,
+                    "pbrt: --tobinary expects exactly one scene file\n");
+            return 1;
+        }
+        return WriteBinaryScene(filenames[0], options.toBinaryFile) ? 0 : 1;
+    }
+
     pbrtInit(options);
     // Process scene description
     if (filenames.size() == 0) {
@@ -90,9 +191,46 @@ int main(int argc, char *argv[]) {
         ParseFile("-");
     } else {
         // Parse scene from input files
-        for (const std::string &f : filenames)
+        for (const std::string &f : filenames) {
+            PbrtOptions.sceneFile = f;
             if (!ParseFile(f))
                 Error("Couldn't open scene file \"%s\"", f.c_str());
+        }
+    }
+
+    // Daemon mode: stay alive after the first render, watch the scene
+    // file, and on each change re-parse it in update mode -- only the
+    // light list is rebuilt against the retained geometry, textures,
+    // and acceleration structures -- then re-render
+    if (options.daemon) {
+        if (filenames.size() != 1) {
+            fprintf(stderr, "pbrt: --daemon expects exactly one scene file\n");
+        } else {
+            const std::string &sceneFile = filenames[0];
+            auto fileTime = [&]() -> int64_t {
+                struct stat status;
+                return stat(sceneFile.c_str(), &status) == 0
+                           ? (int64_t)status.st_mtime
+                           : 0;
+            };
+            int64_t lastTime = fileTime();
+            printf("pbrt: daemon watching \"%s\"\n", sceneFile.c_str());
+            fflush(stdout);
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                int64_t now = fileTime();
+                if (now == lastTime || now == 0) continue;
+                // Wait for the write to settle before re-parsing
+                std::this_thread::sleep_for(std::chrono::milliseconds(250));
+                lastTime = fileTime();
+                printf("pbrt: scene changed; updating lights and "
+                       "re-rendering\n");
+                fflush(stdout);
+                pbrtBeginSceneUpdate();
+                ParseFile(sceneFile);
+                pbrtEndSceneUpdate();
+            }
+        }
     }
     pbrtCleanup();
     return 0;
@@ -35,6 +35,8 @@
 #include "materials/fourier.h"
 #include "paramset.h"
 #include "interaction.h"
+#include <map>
+#include <mutex>
 
 // FourierMaterial Method Definitions
 /*
@@ -194,7 +196,22 @@ fail:
 FourierMaterial::FourierMaterial(const std::string &filename,
                                  const std::shared_ptr<Texture<Float>> &bumpMap)
     : bumpMap(bumpMap) {
-    FourierBSDFTable::Read(filename, &bsdfTable);
+    // Share one table per file: measured-material scenes instantiate
+    // the same .bsdf dozens of times, so reload (and duplicate) it at
+    // most once per process.  Failed reads are cached too (nChannels
+    // stays zero), so a missing file reports a single error.
+    static std::map<std::string, std::shared_ptr<FourierBSDFTable>>
+        loadedTables;
+    static std::mutex loadedTablesMutex;
+    std::lock_guard<std::mutex> lock(loadedTablesMutex);
+    auto iter = loadedTables.find(filename);
+    if (iter != loadedTables.end()) {
+        bsdfTable = iter->second;
+        return;
+    }
+    bsdfTable = std::make_shared<FourierBSDFTable>();
+    FourierBSDFTable::Read(filename, bsdfTable.get());
+    loadedTables[filename] = bsdfTable;
 }
 
 void FourierMaterial::ComputeScatteringFunctions(
@@ -205,8 +222,8 @@ void FourierMaterial::ComputeScatteringFunctions(
     si->bsdf = ARENA_ALLOC(arena, BSDF)(*si);
     // Checking for zero channels works as a proxy for checking whether the
     // table was successfully read from the file.
-    if (bsdfTable.nChannels > 0)
-        si->bsdf->Add(ARENA_ALLOC(arena, FourierBSDF)(bsdfTable, mode));
+    if (bsdfTable->nChannels > 0)
+        si->bsdf->Add(ARENA_ALLOC(arena, FourierBSDF)(*bsdfTable, mode));
 }
 
 FourierMaterial *CreateFourierMaterial(const TextureParams &mp) {
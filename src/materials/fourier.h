@@ -56,7 +56,9 @@ class FourierMaterial : public Material {
 
   private:
     // FourierMaterial Private Data
-    FourierBSDFTable bsdfTable;
+    // Shared, process-wide table: instances referencing the same .bsdf
+    // file point at one cached FourierBSDFTable
+    std::shared_ptr<FourierBSDFTable> bsdfTable;
     std::shared_ptr<Texture<Float>> bumpMap;
 };
 
@@ -47,8 +47,23 @@ void GlassMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
     // Perform bump mapping with _bumpMap_, if present
     if (bumpMap) Bump(bumpMap, si);
     Float eta = index->Evaluate(*si);
+    // Apply Cauchy dispersion about the sodium D line if the
+    // integrator supplied a hero wavelength for this path
+    Float B = cauchyB->Evaluate(*si);
+    if (B != 0 && si->wavelength > 0) {
+        Float lambdaUm = si->wavelength * 1e-3f;
+        const Float sodiumDUm2 = 0.589f * 0.589f;
+        eta += B * (1 / (lambdaUm * lambdaUm) - 1 / sodiumDUm2);
+        si->dispersive = true;
+    }
     Float urough = uRoughness->Evaluate(*si);
     Float vrough = vRoughness->Evaluate(*si);
+    // Path regularization: floor the roughness so post-diffuse delta
+    // lobes become narrow, sampleable microfacets
+    if (regularizeRoughness > 0) {
+        urough = std::max(urough, regularizeRoughness);
+        vrough = std::max(vrough, regularizeRoughness);
+    }
     Spectrum R = Kr->Evaluate(*si).Clamp();
     Spectrum T = Kt->Evaluate(*si).Clamp();
     // Initialize _bsdf_ for smooth or rough dielectric
@@ -95,6 +110,10 @@ GlassMaterial *CreateGlassMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kt =
         mp.GetSpectrumTexture("Kt", Spectrum(1.f));
     std::shared_ptr<Texture<Float>> index = mp.GetFloatTexture("index", 1.5f);
+    // Cauchy B coefficient in um^2 (e.g. ~0.0042 for BK7); nonzero
+    // enables wavelength-dependent refraction with hero wavelengths
+    std::shared_ptr<Texture<Float>> cauchyB =
+        mp.GetFloatTexture("cauchyb", 0.f);
     std::shared_ptr<Texture<Float>> roughu =
         mp.GetFloatTexture("uroughness", 0.f);
     std::shared_ptr<Texture<Float>> roughv =
@@ -102,6 +121,6 @@ GlassMaterial *CreateGlassMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Float>> bumpMap =
         mp.GetFloatTextureOrNull("bumpmap");
     bool remapRoughness = mp.FindBool("remaproughness", true);
-    return new GlassMaterial(Kr, Kt, roughu, roughv, index, bumpMap,
+    return new GlassMaterial(Kr, Kt, roughu, roughv, index, cauchyB, bumpMap,
                              remapRoughness);
 }
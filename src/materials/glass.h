@@ -51,6 +51,7 @@ class GlassMaterial : public Material {
                   const std::shared_ptr<Texture<Float>> &uRoughness,
                   const std::shared_ptr<Texture<Float>> &vRoughness,
                   const std::shared_ptr<Texture<Float>> &index,
+                  const std::shared_ptr<Texture<Float>> &cauchyB,
                   const std::shared_ptr<Texture<Float>> &bumpMap,
                   bool remapRoughness)
         : Kr(Kr),
@@ -58,6 +59,7 @@ class GlassMaterial : public Material {
           uRoughness(uRoughness),
           vRoughness(vRoughness),
           index(index),
+          cauchyB(cauchyB),
           bumpMap(bumpMap),
           remapRoughness(remapRoughness) {}
     void ComputeScatteringFunctions(SurfaceInteraction *si, MemoryArena &arena,
@@ -69,6 +71,7 @@ class GlassMaterial : public Material {
     std::shared_ptr<Texture<Spectrum>> Kr, Kt;
     std::shared_ptr<Texture<Float>> uRoughness, vRoughness;
     std::shared_ptr<Texture<Float>> index;
+    std::shared_ptr<Texture<Float>> cauchyB;
     std::shared_ptr<Texture<Float>> bumpMap;
     bool remapRoughness;
 };
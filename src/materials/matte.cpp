@@ -48,15 +48,16 @@ void MatteMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
     if (bumpMap) Bump(bumpMap, si);
 
     // Evaluate textures for _MatteMaterial_ material and allocate BRDF
-    si->bsdf = ARENA_ALLOC(arena, BSDF)(*si);
     Spectrum r = Kd->Evaluate(*si).Clamp();
     Float sig = Clamp(sigma->Evaluate(*si), 0, 90);
-    if (!r.IsBlack()) {
-        if (sig == 0)
-            si->bsdf->Add(ARENA_ALLOC(arena, LambertianReflection)(r));
-        else
-            si->bsdf->Add(ARENA_ALLOC(arena, OrenNayar)(r, sig));
-    }
+    if (r.IsBlack())
+        si->bsdf = ARENA_ALLOC(arena, BSDF)(*si);
+    else if (sig == 0)
+        si->bsdf = ARENA_ALLOC(arena, SingleBxDFBSDF<LambertianReflection>)(
+            *si, LambertianReflection(r));
+    else
+        si->bsdf = ARENA_ALLOC(arena, SingleBxDFBSDF<OrenNayar>)(
+            *si, OrenNayar(r, sig));
 }
 
 MatteMaterial *CreateMatteMaterial(const TextureParams &mp) {
@@ -66,6 +66,11 @@ void MetalMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
         uRoughness ? uRoughness->Evaluate(*si) : roughness->Evaluate(*si);
     Float vRough =
         vRoughness ? vRoughness->Evaluate(*si) : roughness->Evaluate(*si);
+    // Path regularization: floor the roughness past a diffuse bounce
+    if (regularizeRoughness > 0) {
+        uRough = std::max(uRough, regularizeRoughness);
+        vRough = std::max(vRough, regularizeRoughness);
+    }
     if (remapRoughness) {
         uRough = TrowbridgeReitzDistribution::RoughnessToAlpha(uRough);
         vRough = TrowbridgeReitzDistribution::RoughnessToAlpha(vRough);
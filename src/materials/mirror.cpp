@@ -35,6 +35,7 @@
 #include "materials/mirror.h"
 #include "spectrum.h"
 #include "reflection.h"
+#include "microfacet.h"
 #include "paramset.h"
 #include "texture.h"
 #include "interaction.h"
@@ -48,7 +49,17 @@ void MirrorMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
     if (bumpMap) Bump(bumpMap, si);
     si->bsdf = ARENA_ALLOC(arena, BSDF)(*si);
     Spectrum R = Kr->Evaluate(*si).Clamp();
-    if (!R.IsBlack())
+    if (R.IsBlack()) return;
+    // Path regularization: swap the delta lobe for a narrow microfacet
+    // past a diffuse bounce
+    if (regularizeRoughness > 0) {
+        Float alpha = TrowbridgeReitzDistribution::RoughnessToAlpha(
+            regularizeRoughness);
+        MicrofacetDistribution *distrib =
+            ARENA_ALLOC(arena, TrowbridgeReitzDistribution)(alpha, alpha);
+        si->bsdf->Add(ARENA_ALLOC(arena, MicrofacetReflection)(
+            R, distrib, ARENA_ALLOC(arena, FresnelNoOp)()));
+    } else
         si->bsdf->Add(ARENA_ALLOC(arena, SpecularReflection)(
             R, ARENA_ALLOC(arena, FresnelNoOp)()));
 }
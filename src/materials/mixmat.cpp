@@ -40,6 +40,20 @@
 #include "texture.h"
 #include "interaction.h"
 
+// MixMaterial Local Definitions
+
+// Per-thread generator for the one-sample material selection; child
+// choice only needs decorrelated draws, not a full sampler dimension.
+static PBRT_THREAD_LOCAL uint64_t mixSelectorState;
+
+static Float NextMixSelectorSample() {
+    mixSelectorState =
+        mixSelectorState * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t bits = mixSelectorState;
+    bits ^= bits >> 31;
+    return (Float)(bits >> 40) * (Float)(1.f / (1 << 24));
+}
+
 // MixMaterial Method Definitions
 void MixMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
                                              MemoryArena &arena,
@@ -48,17 +62,46 @@ void MixMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
     // Compute weights and original _BxDF_s for mix material
     Spectrum s1 = scale->Evaluate(*si).Clamp();
     Spectrum s2 = (Spectrum(1.f) - s1).Clamp();
+    if (stochastic) {
+        // One-sample estimate: evaluate a single child chosen with
+        // probability proportional to its mix weight and rescale by
+        // weight/probability, so only one material's textures are
+        // evaluated and one BxDF set allocated per intersection
+        Float w1 = s1.y(), w2 = s2.y();
+        if (w1 + w2 > 0) {
+            Float p = w1 / (w1 + w2);
+            bool useFirst = NextMixSelectorSample() < p;
+            const Material *m = useFirst ? m1.get() : m2.get();
+            Spectrum weight =
+                useFirst ? s1 / p : s2 / (1 - p);
+            m->ComputeScatteringFunctions(si, arena, mode,
+                                          allowMultipleLobes);
+            if (!si->bsdf) return;
+            // Rebuild as a generic BSDF: the child may have produced a
+            // devirtualized fixed-lobe BSDF whose evaluation wouldn't
+            // see in-place lobe rewrites
+            BSDF *mixed = ARENA_ALLOC(arena, BSDF)(*si, si->bsdf->eta);
+            int n = si->bsdf->NumComponents();
+            for (int i = 0; i < n; ++i)
+                mixed->Add(ARENA_ALLOC(arena, ScaledBxDF)(si->bsdf->bxdfs[i],
+                                                          weight));
+            si->bsdf = mixed;
+            return;
+        }
+    }
     SurfaceInteraction si2 = *si;
     m1->ComputeScatteringFunctions(si, arena, mode, allowMultipleLobes);
     m2->ComputeScatteringFunctions(&si2, arena, mode, allowMultipleLobes);
 
-    // Initialize _si->bsdf_ with weighted mixture of _BxDF_s
+    // Initialize _si->bsdf_ with weighted mixture of _BxDF_s, rebuilt
+    // as a generic BSDF (see above)
+    BSDF *mixed = ARENA_ALLOC(arena, BSDF)(*si, si->bsdf->eta);
     int n1 = si->bsdf->NumComponents(), n2 = si2.bsdf->NumComponents();
     for (int i = 0; i < n1; ++i)
-        si->bsdf->bxdfs[i] =
-            ARENA_ALLOC(arena, ScaledBxDF)(si->bsdf->bxdfs[i], s1);
+        mixed->Add(ARENA_ALLOC(arena, ScaledBxDF)(si->bsdf->bxdfs[i], s1));
     for (int i = 0; i < n2; ++i)
-        si->bsdf->Add(ARENA_ALLOC(arena, ScaledBxDF)(si2.bsdf->bxdfs[i], s2));
+        mixed->Add(ARENA_ALLOC(arena, ScaledBxDF)(si2.bsdf->bxdfs[i], s2));
+    si->bsdf = mixed;
 }
 
 MixMaterial *CreateMixMaterial(const TextureParams &mp,
@@ -66,5 +109,6 @@ MixMaterial *CreateMixMaterial(const TextureParams &mp,
                                const std::shared_ptr<Material> &m2) {
     std::shared_ptr<Texture<Spectrum>> scale =
         mp.GetSpectrumTexture("amount", Spectrum(0.5f));
-    return new MixMaterial(m1, m2, scale);
+    bool stochastic = mp.FindBool("stochastic", true);
+    return new MixMaterial(m1, m2, scale, stochastic);
 }
@@ -48,8 +48,9 @@ class MixMaterial : public Material {
     // MixMaterial Public Methods
     MixMaterial(const std::shared_ptr<Material> &m1,
                 const std::shared_ptr<Material> &m2,
-                const std::shared_ptr<Texture<Spectrum>> &scale)
-        : m1(m1), m2(m2), scale(scale) {}
+                const std::shared_ptr<Texture<Spectrum>> &scale,
+                bool stochastic = true)
+        : m1(m1), m2(m2), scale(scale), stochastic(stochastic) {}
     void ComputeScatteringFunctions(SurfaceInteraction *si, MemoryArena &arena,
                                     TransportMode mode,
                                     bool allowMultipleLobes) const;
@@ -58,6 +59,9 @@ class MixMaterial : public Material {
     // MixMaterial Private Data
     std::shared_ptr<Material> m1, m2;
     std::shared_ptr<Texture<Spectrum>> scale;
+    // One-sample mode: evaluate a single stochastically chosen child
+    // per intersection instead of both ("stochastic" param)
+    const bool stochastic;
 };
 
 MixMaterial *CreateMixMaterial(const TextureParams &mp,
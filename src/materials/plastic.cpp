@@ -45,13 +45,7 @@ void PlasticMaterial::ComputeScatteringFunctions(
     bool allowMultipleLobes) const {
     // Perform bump mapping with _bumpMap_, if present
     if (bumpMap) Bump(bumpMap, si);
-    si->bsdf = ARENA_ALLOC(arena, BSDF)(*si);
-    // Initialize diffuse component of plastic material
     Spectrum kd = Kd->Evaluate(*si).Clamp();
-    if (!kd.IsBlack())
-        si->bsdf->Add(ARENA_ALLOC(arena, LambertianReflection)(kd));
-
-    // Initialize specular component of plastic material
     Spectrum ks = Ks->Evaluate(*si).Clamp();
     if (!ks.IsBlack()) {
         Fresnel *fresnel = ARENA_ALLOC(arena, FresnelDielectric)(1.5f, 1.f);
@@ -61,9 +55,21 @@ void PlasticMaterial::ComputeScatteringFunctions(
             rough = TrowbridgeReitzDistribution::RoughnessToAlpha(rough);
         MicrofacetDistribution *distrib =
             ARENA_ALLOC(arena, TrowbridgeReitzDistribution)(rough, rough);
-        BxDF *spec =
-            ARENA_ALLOC(arena, MicrofacetReflection)(ks, distrib, fresnel);
-        si->bsdf->Add(spec);
+        MicrofacetReflection spec(ks, distrib, fresnel);
+        typedef TwoBxDFBSDF<LambertianReflection, MicrofacetReflection>
+            PlasticBSDF;
+        if (!kd.IsBlack())
+            si->bsdf = ARENA_ALLOC(arena, PlasticBSDF)(
+                *si, LambertianReflection(kd), spec);
+        else
+            si->bsdf =
+                ARENA_ALLOC(arena, SingleBxDFBSDF<MicrofacetReflection>)(
+                    *si, spec);
+    } else if (!kd.IsBlack()) {
+        si->bsdf = ARENA_ALLOC(arena, SingleBxDFBSDF<LambertianReflection>)(
+            *si, LambertianReflection(kd));
+    } else {
+        si->bsdf = ARENA_ALLOC(arena, BSDF)(*si);
     }
 }
 
@@ -33,17 +33,195 @@
 
 // media/grid.cpp*
 #include "media/grid.h"
+#if defined(__AVX2__) && !defined(PBRT_FLOAT_AS_DOUBLE)
+#include <immintrin.h>
+#define PBRT_GRID_HAVE_AVX2
+#endif
+#if defined(PBRT_IS_LINUX) || defined(PBRT_IS_OSX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PBRT_GRID_HAVE_MMAP
+#endif
 #include "paramset.h"
 #include "sampler.h"
 #include "interaction.h"
 
 // GridDensityMedium Method Definitions
+// Sparse volume file layout (.svol): _SparseVolumeHeader_, the brick
+// offset table (one int32 per 4x4x4 brick, -1 = empty), then the brick
+// pool of 64-float slabs.
+struct SparseVolumeHeader {
+    uint32_t magic, version;
+    uint32_t floatSize;
+    int32_t nx, ny, nz;
+    uint64_t nBricks;
+};
+static const uint32_t sparseVolumeMagic = 0x4c4f5653;  // "SVOL"
+static const uint32_t sparseVolumeVersion = 1;
+
+GridDensityMedium::GridDensityMedium(const Spectrum &sigma_a,
+                                     const Spectrum &sigma_s, Float g, int nx,
+                                     int ny, int nz,
+                                     const Transform &mediumToWorld,
+                                     bool deltaTrackingTr)
+    : sigma_a(sigma_a),
+      sigma_s(sigma_s),
+      g(g),
+      nx(nx),
+      ny(ny),
+      nz(nz),
+      WorldToMedium(Inverse(mediumToWorld)),
+      nbx((nx + 3) / 4),
+      nby((ny + 3) / 4),
+      nbz((nz + 3) / 4),
+      deltaTrackingTr(deltaTrackingTr) {}
+
+GridDensityMedium::~GridDensityMedium() {
+#ifdef PBRT_GRID_HAVE_MMAP
+    if (mapping) munmap(mapping, mappingSize);
+#endif
+}
+
+void GridDensityMedium::FinishInitialization() {
+    // Chromatic extinction is supported: tracking uses the maximum
+    // channel as the majorant and weights the others per channel
+    sigma_t = sigma_a + sigma_s;
+    maxSigmaT = 0;
+    avgSigmaT = 0;
+    for (int i = 0; i < Spectrum::nSamples; ++i) {
+        maxSigmaT = std::max(maxSigmaT, sigma_t[i]);
+        avgSigmaT += sigma_t[i];
+    }
+    avgSigmaT /= Spectrum::nSamples;
+    if (maxSigmaT <= 0) Error("GridDensityMedium has zero extinction");
+
+    // Compute the global majorant from the (sparse) brick pool and
+    // build the majorant supergrid; empty bricks contribute nothing
+    size_t nBricks = 0;
+    for (int32_t b : brickOffsets)
+        nBricks = std::max(nBricks, (size_t)(b + 1));
+    Float maxDensity = 0;
+    for (size_t i = 0; i < nBricks * 64; ++i)
+        maxDensity = std::max(maxDensity, densityPool[i]);
+    invMaxDensity = maxDensity > 0 ? 1 / maxDensity : 1;
+    majorants.assign(majorantRes * majorantRes * majorantRes, 0);
+    for (int bz = 0; bz < majorantRes; ++bz)
+        for (int by = 0; by < majorantRes; ++by)
+            for (int bx = 0; bx < majorantRes; ++bx) {
+                int x0 = bx * nx / majorantRes - 1,
+                    x1 = (bx + 1) * nx / majorantRes + 1;
+                int y0 = by * ny / majorantRes - 1,
+                    y1 = (by + 1) * ny / majorantRes + 1;
+                int z0 = bz * nz / majorantRes - 1,
+                    z1 = (bz + 1) * nz / majorantRes + 1;
+                Float m = 0;
+                for (int z = std::max(0, z0); z <= std::min(nz - 1, z1); ++z)
+                    for (int y = std::max(0, y0); y <= std::min(ny - 1, y1);
+                         ++y)
+                        for (int x = std::max(0, x0);
+                             x <= std::min(nx - 1, x1); ++x)
+                            m = std::max(m, D(Point3i(x, y, z)));
+                majorants[(bz * majorantRes + by) * majorantRes + bx] = m;
+            }
+}
+
+GridDensityMedium *GridDensityMedium::CreateFromSparseFile(
+    const Spectrum &sigma_a, const Spectrum &sigma_s, Float g,
+    const std::string &filename, const Transform &mediumToWorld,
+    bool deltaTrackingTr) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        Error("Unable to open sparse volume file \"%s\"", filename.c_str());
+        return nullptr;
+    }
+    SparseVolumeHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != sparseVolumeMagic ||
+        header.version != sparseVolumeVersion ||
+        header.floatSize != sizeof(Float)) {
+        Error("Invalid sparse volume file \"%s\"", filename.c_str());
+        fclose(f);
+        return nullptr;
+    }
+    GridDensityMedium *medium = new GridDensityMedium(
+        sigma_a, sigma_s, g, header.nx, header.ny, header.nz, mediumToWorld,
+        deltaTrackingTr);
+    size_t nTableEntries = (size_t)medium->nbx * medium->nby * medium->nbz;
+    medium->brickOffsets.resize(nTableEntries);
+    bool ok = fread(&medium->brickOffsets[0], sizeof(int32_t), nTableEntries,
+                    f) == nTableEntries;
+    size_t poolFloats = (size_t)header.nBricks * 64;
+#ifdef PBRT_GRID_HAVE_MMAP
+    if (ok) {
+        // Memory-map the brick pool so bricks stream in on first touch
+        struct stat sb;
+        if (fstat(fileno(f), &sb) == 0) {
+            void *m = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED,
+                           fileno(f), 0);
+            if (m != MAP_FAILED) {
+                medium->mapping = m;
+                medium->mappingSize = sb.st_size;
+                medium->densityPool =
+                    (const Float *)((const char *)m + sizeof(header) +
+                                    nTableEntries * sizeof(int32_t));
+            }
+        }
+    }
+#endif  // PBRT_GRID_HAVE_MMAP
+    if (ok && !medium->densityPool) {
+        medium->ownedPool.resize(poolFloats);
+        ok = fread(&medium->ownedPool[0], sizeof(Float), poolFloats, f) ==
+             poolFloats;
+        medium->densityPool = &medium->ownedPool[0];
+    }
+    fclose(f);
+    if (!ok) {
+        Error("Truncated sparse volume file \"%s\"", filename.c_str());
+        delete medium;
+        return nullptr;
+    }
+    medium->FinishInitialization();
+    return medium;
+}
+
 Float GridDensityMedium::Density(const Point3f &p) const {
     // Compute voxel coordinates and offsets for _p_
     Point3f pSamples(p.x * nx - .5f, p.y * ny - .5f, p.z * nz - .5f);
     Point3i pi = (Point3i)Floor(pSamples);
     Vector3f d = pSamples - (Point3f)pi;
 
+    // Interior fast path: all eight corners lie in one nonempty brick,
+    // so the bounds checks and brick indirections drop out and the
+    // corners load (gathered, with AVX2) from that brick's pool slab
+    if (pi.x >= 0 && pi.y >= 0 && pi.z >= 0 && pi.x + 1 < nx &&
+        pi.y + 1 < ny && pi.z + 1 < nz && (pi.x & 3) != 3 &&
+        (pi.y & 3) != 3 && (pi.z & 3) != 3) {
+        int32_t brick =
+            brickOffsets[(((size_t)pi.z >> 2) * nby + (pi.y >> 2)) * nbx +
+                         (pi.x >> 2)];
+        if (brick < 0) return 0;
+        const Float *slab = densityPool + ((size_t)brick << 6);
+        int base = ((pi.z & 3) << 4) | ((pi.y & 3) << 2) | (pi.x & 3);
+        Float c[8];
+#ifdef PBRT_GRID_HAVE_AVX2
+        const __m256i offsets =
+            _mm256_setr_epi32(0, 1, 4, 5, 16, 17, 20, 21);
+        __m256 corners = _mm256_i32gather_ps(
+            slab, _mm256_add_epi32(_mm256_set1_epi32(base), offsets), 4);
+        _mm256_storeu_ps(c, corners);
+#else
+        for (int i = 0; i < 8; ++i)
+            c[i] = slab[base + (((i >> 2) & 1) << 4) +
+                        (((i >> 1) & 1) << 2) + (i & 1)];
+#endif  // PBRT_GRID_HAVE_AVX2
+        Float d00 = Lerp(d.x, c[0], c[1]);
+        Float d10 = Lerp(d.x, c[2], c[3]);
+        Float d01 = Lerp(d.x, c[4], c[5]);
+        Float d11 = Lerp(d.x, c[6], c[7]);
+        return Lerp(d.z, Lerp(d.y, d00, d10), Lerp(d.y, d01, d11));
+    }
+
     // Trilinearly interpolate density values to compute local density
     Float d00 = Lerp(d.x, D(pi), D(pi + Vector3i(1, 0, 0)));
     Float d10 = Lerp(d.x, D(pi + Vector3i(0, 1, 0)), D(pi + Vector3i(1, 1, 0)));
@@ -64,20 +242,39 @@ Spectrum GridDensityMedium::Sample(const Ray &rWorld, Sampler &sampler,
     Float tMin, tMax;
     if (!b.IntersectP(ray, &tMin, &tMax)) return Spectrum(1.f);
 
-    // Run delta-tracking iterations to sample a medium interaction
-    Float t = tMin;
-    while (true) {
-        t -= std::log(1 - sampler.Get1D()) * invMaxDensity / sigma_t;
-        if (t >= tMax) break;
-        if (Density(ray(t)) * invMaxDensity > sampler.Get1D()) {
-            // Populate _mi_ with medium interaction information and return
-            PhaseFunction *phase = ARENA_ALLOC(arena, HenyeyGreenstein)(g);
-            *mi = MediumInteraction(rWorld(t), -rWorld.d, rWorld.time, this,
-                                    phase);
-            return sigma_s / sigma_t;
+    // Run delta-tracking iterations brick by brick along the majorant
+    // supergrid; empty bricks are skipped in one step and dense ones
+    // use their own local majorant
+    MajorantIterator iter(*this, ray, tMin, tMax);
+    Float t0, t1, majorant;
+    Spectrum weight(1.f);
+    while (iter.Next(&t0, &t1, &majorant)) {
+        if (majorant == 0) continue;
+        // Extinction majorant for this brick; real collisions are
+        // accepted with the mean-channel probability and the chromatic
+        // residue carried in _weight_ (weighted spectral delta
+        // tracking)
+        Float m = majorant * maxSigmaT;
+        Float t = t0;
+        while (true) {
+            t -= std::log(1 - sampler.Get1D()) / m;
+            if (t >= t1) break;
+            Float dens = Density(ray(t));
+            Float pReal = std::min((Float)1, dens * avgSigmaT / m);
+            if (sampler.Get1D() < pReal) {
+                // Populate _mi_ with medium interaction information and
+                // return the per-channel scattering weight
+                PhaseFunction *phase = ARENA_ALLOC(arena, HenyeyGreenstein)(g);
+                *mi = MediumInteraction(rWorld(t), -rWorld.d, rWorld.time,
+                                        this, phase);
+                return weight * (dens * sigma_s) / (m * pReal);
+            }
+            if (pReal < 1)
+                weight *= (Spectrum(m) - dens * sigma_t) /
+                          (m * (1 - pReal));
         }
     }
-    return Spectrum(1.f);
+    return weight;
 }
 
 Spectrum GridDensityMedium::Tr(const Ray &rWorld, Sampler &sampler) const {
@@ -88,13 +285,28 @@ Spectrum GridDensityMedium::Tr(const Ray &rWorld, Sampler &sampler) const {
     Float tMin, tMax;
     if (!b.IntersectP(ray, &tMin, &tMax)) return Spectrum(1.f);
 
-    // Perform ratio tracking to estimate the transmittance value
-    Float Tr = 1, t = tMin;
-    while (true) {
-        t -= std::log(1 - sampler.Get1D()) * invMaxDensity / sigma_t;
-        if (t >= tMax) break;
-        Float density = Density(ray(t));
-        Tr *= 1 - std::max((Float)0, density * invMaxDensity);
+    // Perform ratio tracking brick by brick along the majorant
+    // supergrid
+    Spectrum Tr(1.f);
+    MajorantIterator iter(*this, ray, tMin, tMax);
+    Float t0, t1, majorant;
+    while (iter.Next(&t0, &t1, &majorant)) {
+        if (majorant == 0) continue;
+        Float m = majorant * maxSigmaT;
+        Float t = t0;
+        while (true) {
+            t -= std::log(1 - sampler.Get1D()) / m;
+            if (t >= t1) break;
+            Float density = Density(ray(t));
+            if (deltaTrackingTr) {
+                // Cheap binary estimator: terminate on a real collision
+                if (sampler.Get1D() < density * avgSigmaT / m)
+                    return Spectrum(0.f);
+            } else
+                // Per-channel ratio tracking handles tinted media with
+                // one pass and far lower variance in thin regions
+                Tr *= (Spectrum(m) - density * sigma_t) / m;
+        }
     }
-    return Spectrum(Tr);
+    return Tr;
 }
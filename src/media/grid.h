@@ -48,7 +48,7 @@ class GridDensityMedium : public Medium {
     // GridDensityMedium Public Methods
     GridDensityMedium(const Spectrum &sigma_a, const Spectrum &sigma_s, Float g,
                       int nx, int ny, int nz, const Transform &mediumToWorld,
-                      const Float *d)
+                      const Float *d, bool deltaTrackingTr = false)
         : sigma_a(sigma_a),
           sigma_s(sigma_s),
           g(g),
@@ -56,39 +56,147 @@ class GridDensityMedium : public Medium {
           ny(ny),
           nz(nz),
           WorldToMedium(Inverse(mediumToWorld)),
-          density(new Float[nx * ny * nz]) {
-        memcpy((Float *)density.get(), d, sizeof(Float) * nx * ny * nz);
-        // Precompute values for Monte Carlo sampling of _GridDensityMedium_
-        sigma_t = (sigma_a + sigma_s)[0];
-        if (Spectrum(sigma_t) != sigma_a + sigma_s)
-            Error(
-                "GridDensityMedium requires a spectrally uniform attenuation "
-                "coefficient!");
-        Float maxDensity = 0;
-        for (int i = 0; i < nx * ny * nz; ++i)
-            maxDensity = std::max(maxDensity, density[i]);
-        invMaxDensity = 1 / maxDensity;
+          nbx((nx + 3) / 4),
+          nby((ny + 3) / 4),
+          nbz((nz + 3) / 4),
+          deltaTrackingTr(deltaTrackingTr) {
+        // Store the density in sparse 4x4x4 bricks: only bricks with
+        // nonzero density go into the pool, so mostly-empty sims keep
+        // their sparsity, and the eight corners of a trilinear lookup
+        // land in one or a few cache lines
+        brickOffsets.assign((size_t)nbx * nby * nbz, -1);
+        std::vector<Float> pool;
+        for (int bz = 0; bz < nbz; ++bz)
+            for (int by = 0; by < nby; ++by)
+                for (int bx = 0; bx < nbx; ++bx) {
+                    Float brick[64] = {};
+                    bool empty = true;
+                    for (int oz = 0; oz < 4; ++oz)
+                        for (int oy = 0; oy < 4; ++oy)
+                            for (int ox = 0; ox < 4; ++ox) {
+                                int x = 4 * bx + ox, y = 4 * by + oy,
+                                    z = 4 * bz + oz;
+                                if (x >= nx || y >= ny || z >= nz) continue;
+                                Float v = d[(z * ny + y) * nx + x];
+                                brick[(oz << 4) | (oy << 2) | ox] = v;
+                                if (v != 0) empty = false;
+                            }
+                    if (!empty) {
+                        brickOffsets[((size_t)bz * nby + by) * nbx + bx] =
+                            (int32_t)(pool.size() >> 6);
+                        pool.insert(pool.end(), brick, brick + 64);
+                    }
+                }
+        ownedPool = std::move(pool);
+        densityPool = ownedPool.empty() ? nullptr : &ownedPool[0];
+        FinishInitialization();
     }
 
+    // Load a sparse volume file (.svol: header, brick offset table,
+    // brick pool), memory-mapping it where possible so bricks stream
+    // in lazily; returns nullptr on failure
+    static GridDensityMedium *CreateFromSparseFile(
+        const Spectrum &sigma_a, const Spectrum &sigma_s, Float g,
+        const std::string &filename, const Transform &mediumToWorld,
+        bool deltaTrackingTr = false);
     Float Density(const Point3f &p) const;
     Float D(const Point3i &p) const {
         Bounds3i sampleBounds(Point3i(0, 0, 0), Point3i(nx, ny, nz));
         if (!InsideExclusive(p, sampleBounds)) return 0;
-        return density[(p.z * ny + p.y) * nx + p.x];
+        int32_t brick =
+            brickOffsets[(((size_t)p.z >> 2) * nby + (p.y >> 2)) * nbx +
+                         (p.x >> 2)];
+        if (brick < 0) return 0;
+        return densityPool[((size_t)brick << 6) | ((p.z & 3) << 4) |
+                           ((p.y & 3) << 2) | (p.x & 3)];
     }
     Spectrum Sample(const Ray &ray, Sampler &sampler, MemoryArena &arena,
                     MediumInteraction *mi) const;
     Spectrum Tr(const Ray &ray, Sampler &sampler) const;
+    ~GridDensityMedium();
 
   private:
+    // Sparse-file construction path used by CreateFromSparseFile()
+    GridDensityMedium(const Spectrum &sigma_a, const Spectrum &sigma_s,
+                      Float g, int nx, int ny, int nz,
+                      const Transform &mediumToWorld, bool deltaTrackingTr);
+    void FinishInitialization();
+
     // GridDensityMedium Private Data
     const Spectrum sigma_a, sigma_s;
     const Float g;
     const int nx, ny, nz;
     const Transform WorldToMedium;
-    std::unique_ptr<Float[]> density;
-    Float sigma_t;
+    const int nbx, nby, nbz;
+    // Sparse brick storage: per-brick pool offsets (-1 = empty) and
+    // the brick pool, owned directly or backed by a file mapping
+    std::vector<int32_t> brickOffsets;
+    std::vector<Float> ownedPool;
+    const Float *densityPool = nullptr;
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+    // Chromatic extinction: per-channel sigma_t with the maximum and
+    // mean channels precomputed for majorant and collision-probability
+    // use; _deltaTrackingTr_ selects the cheap binary transmittance
+    // estimator over per-channel ratio tracking
+    Spectrum sigma_t;
+    Float maxSigmaT, avgSigmaT;
+    const bool deltaTrackingTr;
     Float invMaxDensity;
+    // Majorant supergrid (see the constructor) and its DDA walker
+    static PBRT_CONSTEXPR int majorantRes = 16;
+    std::vector<Float> majorants;
+    friend class MajorantIterator;
+};
+
+// Walks the majorant supergrid along a medium-space ray with a 3D DDA,
+// handing back one (tEnter, tExit, majorant) segment per brick
+class MajorantIterator {
+  public:
+    MajorantIterator(const GridDensityMedium &medium, const Ray &ray,
+                     Float tMin, Float tMax)
+        : medium(medium), ray(ray), cur(tMin), tMax(tMax) {
+        PBRT_CONSTEXPR int res = GridDensityMedium::majorantRes;
+        Point3f pEnter = ray(tMin);
+        for (int a = 0; a < 3; ++a) {
+            voxel[a] = Clamp((int)(pEnter[a] * res), 0, res - 1);
+            if (ray.d[a] == 0) {
+                step[a] = 0;
+                deltaT[a] = Infinity;
+                nextT[a] = Infinity;
+            } else {
+                step[a] = ray.d[a] > 0 ? 1 : -1;
+                deltaT[a] = 1 / (std::abs(ray.d[a]) * res);
+                Float nextPlane =
+                    (voxel[a] + (ray.d[a] > 0 ? 1 : 0)) / Float(res);
+                nextT[a] = tMin + (nextPlane - pEnter[a]) / ray.d[a];
+            }
+        }
+    }
+    bool Next(Float *t0, Float *t1, Float *majorant) {
+        PBRT_CONSTEXPR int res = GridDensityMedium::majorantRes;
+        if (cur >= tMax) return false;
+        int axis = 0;
+        if (nextT[1] < nextT[axis]) axis = 1;
+        if (nextT[2] < nextT[axis]) axis = 2;
+        Float segEnd = std::min(nextT[axis], tMax);
+        *t0 = cur;
+        *t1 = segEnd;
+        *majorant =
+            medium.majorants[(voxel[2] * res + voxel[1]) * res + voxel[0]];
+        cur = segEnd;
+        voxel[axis] += step[axis];
+        if (voxel[axis] < 0 || voxel[axis] >= res) cur = tMax;
+        nextT[axis] += deltaT[axis];
+        return true;
+    }
+
+  private:
+    const GridDensityMedium &medium;
+    const Ray &ray;
+    Float cur, tMax;
+    int voxel[3], step[3];
+    Float deltaT[3], nextT[3];
 };
 
 #endif  // PBRT_MEDIA_GRID_H
@@ -53,6 +53,11 @@ class HomogeneousMedium : public Medium {
     Spectrum Tr(const Ray &ray, Sampler &sampler) const;
     Spectrum Sample(const Ray &ray, Sampler &sampler, MemoryArena &arena,
                     MediumInteraction *mi) const;
+    // Accessors used by the volumetric integrator's equiangular
+    // sampling path
+    const Spectrum &SigmaS() const { return sigma_s; }
+    const Spectrum &SigmaT() const { return sigma_t; }
+    Float G() const { return g; }
 
   private:
     // HomogeneousMedium Private Data
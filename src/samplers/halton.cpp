@@ -33,6 +33,7 @@
 
 // samplers/halton.cpp*
 #include "samplers/halton.h"
+#include <mutex>
 #include "paramset.h"
 #include "rng.h"
 
@@ -62,10 +63,21 @@ static void extendedGCD(uint64_t a, uint64_t b, int64_t *x, int64_t *y) {
 // HaltonSampler Method Definitions
 HaltonSampler::HaltonSampler(int samplesPerPixel, const Bounds2i &sampleBounds)
     : GlobalSampler(samplesPerPixel) {
-    // Generate random digit permutations for Halton sampler
-    if (radicalInversePermutations.size() == 0) {
-        RNG rng;
-        radicalInversePermutations = ComputeRadicalInversePermutations(rng);
+    // Generate random digit permutations for Halton sampler; the table
+    // is built once per (process, frame seed) -- in parallel -- and
+    // shared by reference from every sampler and clone afterwards.
+    // Rebuilding when the seed changes gives animations per-frame
+    // scramble control.
+    static std::mutex permutationsMutex;
+    static uint64_t permutationsSeed = ~(uint64_t)0;
+    {
+        std::lock_guard<std::mutex> lock(permutationsMutex);
+        if (permutationsSeed != SamplerSeed()) {
+            RNG rng(SamplerSeed());
+            radicalInversePermutations =
+                ComputeRadicalInversePermutations(rng);
+            permutationsSeed = SamplerSeed();
+        }
     }
 
     // Find radical inverse base scales and exponents that cover sampling area
@@ -87,28 +99,49 @@ HaltonSampler::HaltonSampler(int samplesPerPixel, const Bounds2i &sampleBounds)
     // Compute multiplicative inverses for _baseScales_
     multInverse[0] = multiplicativeInverse(baseScales[1], baseScales[0]);
     multInverse[1] = multiplicativeInverse(baseScales[0], baseScales[1]);
+
+    // Precompute the per-pixel sample offsets for the whole pixel tile
+    // in parallel, once per set of base scales, replacing the per-pixel
+    // inverse radical inverse computation in GetIndexForSample()
+    static std::mutex offsetsMutex;
+    std::lock_guard<std::mutex> lock(offsetsMutex);
+    if (pixelSampleOffsets.empty() || offsetsBaseScales != baseScales) {
+        offsetsBaseScales = baseScales;
+        pixelSampleOffsets.resize(kMaxResolution * kMaxResolution);
+        ParallelFor([this](int64_t i) {
+            Point2i pm(i % kMaxResolution, i / kMaxResolution);
+            int64_t offset = 0;
+            if (sampleStride > 1) {
+                for (int d = 0; d < 2; ++d) {
+                    uint64_t dimOffset =
+                        (d == 0)
+                            ? InverseRadicalInverse<2>(pm[d], baseExponents[d])
+                            : InverseRadicalInverse<3>(pm[d],
+                                                       baseExponents[d]);
+                    offset += dimOffset * (sampleStride / baseScales[d]) *
+                              multInverse[d];
+                }
+                offset %= sampleStride;
+            }
+            pixelSampleOffsets[i] = offset;
+        }, kMaxResolution * kMaxResolution, 4096);
+    }
 }
 
 std::vector<uint16_t> HaltonSampler::radicalInversePermutations;
+std::vector<int64_t> HaltonSampler::pixelSampleOffsets;
+Point2i HaltonSampler::offsetsBaseScales;
+void HaltonSampler::StartPixel(const Point2i &p) {
+    // Resolve the pixel's precomputed sample offset once here, so
+    // GetIndexForSample() is straight arithmetic for every sample and
+    // dimension of the pixel
+    Point2i pm(Mod(p[0], kMaxResolution), Mod(p[1], kMaxResolution));
+    offsetForCurrentPixel = pixelSampleOffsets[pm.y * kMaxResolution + pm.x];
+    pixelForOffset = p;
+    GlobalSampler::StartPixel(p);
+}
+
 int64_t HaltonSampler::GetIndexForSample(int64_t sampleNum) const {
-    if (currentPixel != pixelForOffset) {
-        // Compute Halton sample offset for _currentPixel_
-        offsetForCurrentPixel = 0;
-        if (sampleStride > 1) {
-            Point2i pm(Mod(currentPixel[0], kMaxResolution),
-                       Mod(currentPixel[1], kMaxResolution));
-            for (int i = 0; i < 2; ++i) {
-                uint64_t dimOffset =
-                    (i == 0)
-                        ? InverseRadicalInverse<2>(pm[i], baseExponents[i])
-                        : InverseRadicalInverse<3>(pm[i], baseExponents[i]);
-                offsetForCurrentPixel +=
-                    dimOffset * (sampleStride / baseScales[i]) * multInverse[i];
-            }
-            offsetForCurrentPixel %= sampleStride;
-        }
-        pixelForOffset = currentPixel;
-    }
     return offsetForCurrentPixel + sampleNum * sampleStride;
 }
 
@@ -47,6 +47,7 @@ class HaltonSampler : public GlobalSampler {
   public:
     // HaltonSampler Public Methods
     HaltonSampler(int nsamp, const Bounds2i &sampleBounds);
+    void StartPixel(const Point2i &p);
     int64_t GetIndexForSample(int64_t sampleNum) const;
     Float SampleDimension(int64_t index, int dimension) const;
     std::unique_ptr<Sampler> Clone(int seed);
@@ -54,6 +55,13 @@ class HaltonSampler : public GlobalSampler {
   private:
     // HaltonSampler Private Data
     static std::vector<uint16_t> radicalInversePermutations;
+    // Process-wide table of per-pixel sample offsets for the
+    // kMaxResolution x kMaxResolution pixel tile, shared by reference
+    // from all sampler clones; only depends on _baseScales_, which
+    // _offsetsBaseScales_ records so the table is rebuilt if a sampler
+    // over different sample bounds is created.
+    static std::vector<int64_t> pixelSampleOffsets;
+    static Point2i offsetsBaseScales;
     Point2i baseScales, baseExponents;
     int sampleStride;
     int multInverse[2];
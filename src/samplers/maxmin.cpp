@@ -50,12 +50,12 @@ void MaxMinDistSampler::StartPixel(const Point2i &p) {
 
     for (size_t i = 0; i < samples1DArraySizes.size(); ++i) {
         int count = samples1DArraySizes[i];
-        VanDerCorput(count, samplesPerPixel, &sampleArray1D[i][0], rng);
+        VanDerCorput(count, samplesPerPixel, Array1D(i), rng);
     }
 
     for (size_t i = 0; i < samples2DArraySizes.size(); ++i) {
         int count = samples2DArraySizes[i];
-        Sobol2D(count, samplesPerPixel, &sampleArray2D[i][0], rng);
+        Sobol2D(count, samplesPerPixel, Array2D(i), rng);
     }
     PixelSampler::StartPixel(p);
 }
@@ -0,0 +1,225 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// samplers/pmj02.cpp*
+#include "samplers/pmj02.h"
+#include "lowdiscrepancy.h"
+#include "paramset.h"
+#include <mutex>
+
+// PMJ02Sampler Local Definitions
+static inline uint32_t MixSeed(uint32_t seed, uint32_t v) {
+    // Finalizer-style integer hash for decorrelating dimension seeds
+    v ^= seed;
+    v ^= v >> 16;
+    v *= 0x85ebca6bu;
+    v ^= v >> 13;
+    v *= 0xc2b2ae35u;
+    v ^= v >> 16;
+    return v;
+}
+
+// Hash-based Owen scramble of a base-2 radical-inverse value
+// (Laine-Karras permutation of the bit-reversed digits)
+static inline uint32_t OwenScramble(uint32_t v, uint32_t seed) {
+    v = ReverseBits32(v);
+    v += seed;
+    v ^= v * 0x6c50b47cu;
+    v ^= v * 0xb82f1e52u;
+    v ^= v * 0xc7afe638u;
+    v ^= v * 0x8d22f6e6u;
+    return ReverseBits32(v);
+}
+
+// Raw 32-bit Sobol' value of _dimension_ for index _a_
+static inline uint32_t SobolUInt32(uint64_t a, int dimension) {
+    uint32_t v = 0;
+    for (int i = dimension * SobolMatrixSize; a != 0; a >>= 1, i++)
+        if (a & 1) v ^= SobolMatrices32[i];
+    return v;
+}
+
+static inline Float UIntToFloat01(uint32_t v) {
+#ifndef PBRT_HAVE_HEX_FP_CONSTANTS
+    return std::min(OneMinusEpsilon, Float(v * 2.3283064365386963e-10f));
+#else
+    return std::min(OneMinusEpsilon, Float(v * 0x1p-32f));
+#endif
+}
+
+std::vector<Float> PMJ02Sampler::blueNoiseTile;
+
+// Build the shared tileable blue-noise mask with a void-and-cluster
+// style construction: cells are ranked in the order that repeatedly
+// picks the lowest-energy free cell under a toroidal Gaussian energy
+// field, and the normalized ranks are the mask values.
+static void InitBlueNoiseTile(std::vector<Float> *tile, int size) {
+    int n = size * size;
+    std::vector<Float> energy(n, 0);
+    std::vector<bool> placed(n, false);
+    tile->resize(n);
+    const Float invSigma2 = 1 / (1.9f * 1.9f);
+    int cell = 0;
+    for (int rank = 0; rank < n; ++rank) {
+        (*tile)[cell] = (rank + 0.5f) / n;
+        placed[cell] = true;
+        // Splat the placed cell's Gaussian energy toroidally and find
+        // the next lowest-energy free cell
+        int cx = cell % size, cy = cell / size;
+        int next = -1;
+        Float minEnergy = Infinity;
+        for (int y = 0; y < size; ++y) {
+            int dy = std::abs(y - cy);
+            dy = std::min(dy, size - dy);
+            for (int x = 0; x < size; ++x) {
+                int dx = std::abs(x - cx);
+                dx = std::min(dx, size - dx);
+                Float &e = energy[y * size + x];
+                e += std::exp(-(dx * dx + dy * dy) * invSigma2);
+                if (!placed[y * size + x] && e < minEnergy) {
+                    minEnergy = e;
+                    next = y * size + x;
+                }
+            }
+        }
+        cell = next;
+    }
+}
+
+// PMJ02Sampler Method Definitions
+PMJ02Sampler::PMJ02Sampler(int64_t samplesPerPixel, int nSampledDimensions)
+    : PixelSampler(RoundUpPow2(samplesPerPixel), nSampledDimensions) {
+    if (!IsPowerOf2(samplesPerPixel))
+        Warning(
+            "Pixel samples being rounded up to power of 2 "
+            "(from %" PRId64 " to %" PRId64 ").",
+            samplesPerPixel, RoundUpPow2(samplesPerPixel));
+
+    // Build the shared blue-noise tile once per process
+    static std::once_flag tileFlag;
+    std::call_once(tileFlag,
+                   []() { InitBlueNoiseTile(&blueNoiseTile, blueNoiseTileSize); });
+
+    // Precompute the Owen-scrambled progressive (0,2)-sequence points
+    // for every sampled dimension; each dimension gets its own scramble
+    // seed, and prefixes of each point set remain (0,2)-stratified, so
+    // any sample count up to samplesPerPixel is well distributed.
+    for (int d = 0; d < nSampledDimensions; ++d) {
+        basePoints1D.push_back(std::vector<Float>(this->samplesPerPixel));
+        basePoints2D.push_back(std::vector<Point2f>(this->samplesPerPixel));
+        // Without the blue-noise temporal mode, the frame seed
+        // decorrelates the whole point set; with it, the base points
+        // stay fixed and only the mask shift below moves per frame
+        uint32_t frameMix = SamplerBlueNoiseTemporal()
+                                ? 0u
+                                : (uint32_t)SamplerSeed();
+        uint32_t seed1D = MixSeed(0x51633e2du ^ frameMix, d);
+        uint32_t seedX = MixSeed(0x68bc21ebu ^ frameMix, d);
+        uint32_t seedY = MixSeed(0x02e5be93u ^ frameMix, d);
+        for (int64_t i = 0; i < this->samplesPerPixel; ++i) {
+            basePoints1D[d][i] =
+                UIntToFloat01(OwenScramble(SobolUInt32(i, 0), seed1D));
+            basePoints2D[d][i] =
+                Point2f(UIntToFloat01(OwenScramble(SobolUInt32(i, 0), seedX)),
+                        UIntToFloat01(OwenScramble(SobolUInt32(i, 1), seedY)));
+        }
+    }
+}
+
+void PMJ02Sampler::StartPixel(const Point2i &p) {
+    // Toroidally shift the precomputed points by this pixel's
+    // blue-noise mask values so that the sampling error is distributed
+    // as blue noise across neighboring pixels.  In the "bluenoise"
+    // temporal mode the mask lookup itself is shifted per frame along
+    // an R2 low-discrepancy orbit, so successive frames cycle through
+    // decorrelated-but-smooth mask values that temporal accumulation
+    // can average instead of boiling.
+    int frameShiftX = 0, frameShiftY = 0;
+    if (SamplerBlueNoiseTemporal()) {
+        double n = (double)SamplerSeed();
+        frameShiftX = (int)((n * 0.7548776662466927 -
+                             std::floor(n * 0.7548776662466927)) *
+                            blueNoiseTileSize);
+        frameShiftY = (int)((n * 0.5698402909980532 -
+                             std::floor(n * 0.5698402909980532)) *
+                            blueNoiseTileSize);
+    }
+    for (size_t i = 0; i < samples1D.size(); ++i) {
+        int mx = Mod(p.x + frameShiftX + (int)(i * 17), blueNoiseTileSize);
+        int my = Mod(p.y + frameShiftY + (int)(i * 29), blueNoiseTileSize);
+        Float shift = blueNoiseTile[my * blueNoiseTileSize + mx];
+        for (int64_t j = 0; j < samplesPerPixel; ++j) {
+            Float s = basePoints1D[i][j] + shift;
+            if (s >= 1) s -= 1;
+            samples1D[i][j] = std::min(s, OneMinusEpsilon);
+        }
+    }
+    for (size_t i = 0; i < samples2D.size(); ++i) {
+        int mx = Mod(p.x + frameShiftX + (int)(i * 17), blueNoiseTileSize);
+        int my = Mod(p.y + frameShiftY + (int)(i * 29), blueNoiseTileSize);
+        Float shiftX = blueNoiseTile[my * blueNoiseTileSize + mx];
+        Float shiftY =
+            blueNoiseTile[Mod(my + blueNoiseTileSize / 2, blueNoiseTileSize) *
+                              blueNoiseTileSize +
+                          Mod(mx + blueNoiseTileSize / 2, blueNoiseTileSize)];
+        for (int64_t j = 0; j < samplesPerPixel; ++j) {
+            Point2f s = basePoints2D[i][j] + Vector2f(shiftX, shiftY);
+            if (s.x >= 1) s.x -= 1;
+            if (s.y >= 1) s.y -= 1;
+            samples2D[i][j] = Point2f(std::min(s.x, OneMinusEpsilon),
+                                      std::min(s.y, OneMinusEpsilon));
+        }
+    }
+
+    // Generate 1D and 2D array samples using $(0,2)$-sequence
+    for (size_t i = 0; i < samples1DArraySizes.size(); ++i)
+        VanDerCorput(samples1DArraySizes[i], samplesPerPixel,
+                     Array1D(i), rng);
+    for (size_t i = 0; i < samples2DArraySizes.size(); ++i)
+        Sobol2D(samples2DArraySizes[i], samplesPerPixel, Array2D(i),
+                rng);
+    PixelSampler::StartPixel(p);
+}
+
+std::unique_ptr<Sampler> PMJ02Sampler::Clone(int seed) {
+    PMJ02Sampler *s = new PMJ02Sampler(*this);
+    s->rng.SetSequence(seed);
+    return std::unique_ptr<Sampler>(s);
+}
+
+PMJ02Sampler *CreatePMJ02Sampler(const ParamSet &params) {
+    int nsamp = params.FindOneInt("pixelsamples", 16);
+    int sd = params.FindOneInt("dimensions", 4);
+    if (PbrtOptions.quickRender) nsamp = 1;
+    return new PMJ02Sampler(nsamp, sd);
+}
@@ -0,0 +1,67 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_SAMPLERS_PMJ02_H
+#define PBRT_SAMPLERS_PMJ02_H
+
+// samplers/pmj02.h*
+#include "sampler.h"
+
+// PMJ02Sampler Declarations
+class PMJ02Sampler : public PixelSampler {
+  public:
+    // PMJ02Sampler Public Methods
+    PMJ02Sampler(int64_t samplesPerPixel, int nSampledDimensions = 4);
+    void StartPixel(const Point2i &);
+    std::unique_ptr<Sampler> Clone(int seed);
+    int RoundCount(int count) const { return RoundUpPow2(count); }
+
+  private:
+    // PMJ02Sampler Private Data
+    // Owen-scrambled progressive (0,2)-sequence points, identical for
+    // every pixel; StartPixel() toroidally shifts them per pixel by a
+    // value from the shared blue-noise tile so that the residual error
+    // is distributed as blue noise across the image.
+    std::vector<std::vector<Float>> basePoints1D;
+    std::vector<std::vector<Point2f>> basePoints2D;
+    static const int blueNoiseTileSize = 64;
+    static std::vector<Float> blueNoiseTile;
+};
+
+PMJ02Sampler *CreatePMJ02Sampler(const ParamSet &params);
+
+#endif  // PBRT_SAMPLERS_PMJ02_H
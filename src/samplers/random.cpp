@@ -38,30 +38,42 @@
 
 RandomSampler::RandomSampler(int ns, int seed) : Sampler(ns), rng(seed) {}
 
+void RandomSampler::Refill() {
+    rng.FillUniform(uniformBuffer, uniformBufferSize);
+    uniformPos = 0;
+}
+
 Float RandomSampler::Get1D() {
     Assert(currentPixelSampleIndex < samplesPerPixel);
-    return rng.UniformFloat();
+    if (uniformPos == uniformBufferSize) Refill();
+    return uniformBuffer[uniformPos++];
 }
 
 Point2f RandomSampler::Get2D() {
     Assert(currentPixelSampleIndex < samplesPerPixel);
-    return {rng.UniformFloat(), rng.UniformFloat()};
+    Point2f u;
+    u.x = Get1D();
+    u.y = Get1D();
+    return u;
 }
 
 std::unique_ptr<Sampler> RandomSampler::Clone(int seed) {
     RandomSampler *rs = new RandomSampler(*this);
     rs->rng.SetSequence(seed);
+    rs->uniformPos = uniformBufferSize;
     return std::unique_ptr<Sampler>(rs);
 }
 
 void RandomSampler::StartPixel(const Point2i &p) {
+    // The array fills below draw from the generator directly, so the
+    // buffered values (which were generated ahead) must be dropped to
+    // keep the stream order consistent
+    uniformPos = uniformBufferSize;
     for (size_t i = 0; i < sampleArray1D.size(); ++i)
-        for (size_t j = 0; j < sampleArray1D[i].size(); ++j)
-            sampleArray1D[i][j] = rng.UniformFloat();
+        sampleArray1D[i] = rng.UniformFloat();
 
     for (size_t i = 0; i < sampleArray2D.size(); ++i)
-        for (size_t j = 0; j < sampleArray2D[i].size(); ++j)
-            sampleArray2D[i][j] = {rng.UniformFloat(), rng.UniformFloat()};
+        sampleArray2D[i] = {rng.UniformFloat(), rng.UniformFloat()};
     Sampler::StartPixel(p);
 }
 
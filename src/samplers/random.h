@@ -51,6 +51,14 @@ class RandomSampler : public Sampler {
     std::unique_ptr<Sampler> Clone(int seed);
 
   private:
+    // Bulk-refilled uniform buffer: Get1D/Get2D drain values generated
+    // by RNG::FillUniform's pipelined lanes, bit-identical to
+    // one-at-a-time generation; invalidated whenever the generator is
+    // reused directly (StartPixel array fills)
+    void Refill();
+    static PBRT_CONSTEXPR int uniformBufferSize = 16;
+    Float uniformBuffer[uniformBufferSize];
+    int uniformPos = uniformBufferSize;
     RNG rng;
 };
 
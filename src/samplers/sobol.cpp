@@ -37,7 +37,24 @@
 #include "paramset.h"
 
 // SobolSampler Method Definitions
+void SobolSampler::StartPixel(const Point2i &p) {
+    // Fill the per-pixel caches: compute all of the pixel's Sobol'
+    // indices, then batch-generate its leading dimensions
+    pixelSampleIndices.resize(samplesPerPixel);
+    for (int64_t i = 0; i < samplesPerPixel; ++i)
+        pixelSampleIndices[i] = SobolIntervalToIndex(
+            log2Resolution, i, Point2i(p - sampleBounds.pMin));
+    cachedDimensionSamples.resize(nCachedDimensions * samplesPerPixel);
+    for (int dim = 0; dim < nCachedDimensions; ++dim)
+        SobolSampleBatch(pixelSampleIndices.data(), samplesPerPixel, dim,
+                         DimensionScramble(dim),
+                         &cachedDimensionSamples[dim * samplesPerPixel]);
+    GlobalSampler::StartPixel(p);
+}
+
 int64_t SobolSampler::GetIndexForSample(int64_t sampleNum) const {
+    if (sampleNum < (int64_t)pixelSampleIndices.size())
+        return pixelSampleIndices[sampleNum];
     return SobolIntervalToIndex(log2Resolution, sampleNum,
                                 Point2i(currentPixel - sampleBounds.pMin));
 }
@@ -46,7 +63,16 @@ Float SobolSampler::SampleDimension(int64_t index, int dim) const {
     if (dim >= NumSobolDimensions)
         Severe("SobolSampler can only sample up to %d dimensions! Exiting.",
                NumSobolDimensions);
-    Float s = SobolSample(index, dim);
+    // Serve the lookup from the per-pixel cache when it covers this
+    // index and dimension
+    Float s;
+    if (dim < nCachedDimensions &&
+        currentPixelSampleIndex < samplesPerPixel &&
+        index == pixelSampleIndices[currentPixelSampleIndex])
+        s = cachedDimensionSamples[dim * samplesPerPixel +
+                                   currentPixelSampleIndex];
+    else
+        s = SobolSample(index, dim, DimensionScramble(dim));
     // Remap Sobol$'$ dimensions used for pixel samples
     if (dim == 0 || dim == 1) {
         s = s * resolution + sampleBounds.pMin[dim];
@@ -58,6 +58,7 @@ class SobolSampler : public GlobalSampler {
         log2Resolution = Log2Int(resolution);
         Assert((1 << log2Resolution) == resolution);
     }
+    void StartPixel(const Point2i &p);
     int64_t GetIndexForSample(int64_t sampleNum) const;
     Float SampleDimension(int64_t index, int dimension) const;
 
@@ -65,6 +66,26 @@ class SobolSampler : public GlobalSampler {
     // SobolSampler Private Data
     const Bounds2i sampleBounds;
     int resolution, log2Resolution;
+    // Per-dimension scramble value derived from the frame seed (zero
+    // when no seed is set, preserving the unscrambled sequence)
+    uint64_t DimensionScramble(int dim) const {
+        // Dimensions 0 and 1 address the pixel raster and must keep
+        // the canonical sequence
+        if (frameSeed == 0 || dim < 2) return 0;
+        uint64_t bits =
+            (frameSeed ^ (uint64_t)dim) * 0x9e3779b97f4a7c15ull;
+        bits ^= bits >> 31;
+        return bits;
+    }
+    const uint64_t frameSeed = SamplerSeed();
+
+    // Per-pixel cache: the pixel's Sobol' indices and its first
+    // _nCachedDimensions_ dimensions, batch-generated in StartPixel()
+    // so the per-sample bit loops in SobolIntervalToIndex() and
+    // SobolSample() run once per pixel instead of once per lookup.
+    static const int nCachedDimensions = 16;
+    std::vector<int64_t> pixelSampleIndices;
+    std::vector<Float> cachedDimensionSamples;
 };
 
 SobolSampler *CreateSobolSampler(const ParamSet &params,
@@ -37,31 +37,35 @@
 #include "sampling.h"
 
 // StratifiedSampler Method Definitions
+void StratifiedSampler::GenerateDimension1D(int dim) {
+    // Generate a single dimension's stratified samples for the pixel
+    StratifiedSample1D(&samples1D[dim][0], xPixelSamples * yPixelSamples, rng,
+                       jitterSamples);
+    Shuffle(&samples1D[dim][0], xPixelSamples * yPixelSamples, 1, rng);
+}
+
+void StratifiedSampler::GenerateDimension2D(int dim) {
+    StratifiedSample2D(&samples2D[dim][0], xPixelSamples, yPixelSamples, rng,
+                       jitterSamples);
+    Shuffle(&samples2D[dim][0], xPixelSamples * yPixelSamples, 1, rng);
+}
+
 void StratifiedSampler::StartPixel(const Point2i &p) {
-    // Generate single stratified samples for the pixel
-    for (size_t i = 0; i < samples1D.size(); ++i) {
-        StratifiedSample1D(&samples1D[i][0], xPixelSamples * yPixelSamples, rng,
-                           jitterSamples);
-        Shuffle(&samples1D[i][0], xPixelSamples * yPixelSamples, 1, rng);
-    }
-    for (size_t i = 0; i < samples2D.size(); ++i) {
-        StratifiedSample2D(&samples2D[i][0], xPixelSamples, yPixelSamples, rng,
-                           jitterSamples);
-        Shuffle(&samples2D[i][0], xPixelSamples * yPixelSamples, 1, rng);
-    }
+    // Single stratified sample dimensions are generated lazily by
+    // GenerateDimension1D/2D() on first use rather than here
 
     // Generate arrays of stratified samples for the pixel
     for (size_t i = 0; i < samples1DArraySizes.size(); ++i)
         for (int64_t j = 0; j < samplesPerPixel; ++j) {
             int count = samples1DArraySizes[i];
-            StratifiedSample1D(&sampleArray1D[i][j * count], count, rng,
+            StratifiedSample1D(Array1D(i) + j * count, count, rng,
                                jitterSamples);
-            Shuffle(&sampleArray1D[i][j * count], count, 1, rng);
+            Shuffle(Array1D(i) + j * count, count, 1, rng);
         }
     for (size_t i = 0; i < samples2DArraySizes.size(); ++i)
         for (int64_t j = 0; j < samplesPerPixel; ++j) {
             int count = samples2DArraySizes[i];
-            LatinHypercube(&sampleArray2D[i][j * count].x, count, 2, rng);
+            LatinHypercube(&Array2D(i)[j * count].x, count, 2, rng);
         }
     PixelSampler::StartPixel(p);
 }
@@ -51,10 +51,17 @@ class StratifiedSampler : public PixelSampler {
         : PixelSampler(xPixelSamples * yPixelSamples, nSampledDimensions),
           xPixelSamples(xPixelSamples),
           yPixelSamples(yPixelSamples),
-          jitterSamples(jitterSamples) {}
+          jitterSamples(jitterSamples) {
+        lazyDimensions = true;
+    }
     void StartPixel(const Point2i &);
     std::unique_ptr<Sampler> Clone(int seed);
 
+  protected:
+    // StratifiedSampler Protected Methods
+    void GenerateDimension1D(int dim);
+    void GenerateDimension2D(int dim);
+
   private:
     // StratifiedSampler Private Data
     const int xPixelSamples, yPixelSamples;
@@ -57,9 +57,9 @@ void ZeroTwoSequenceSampler::StartPixel(const Point2i &p) {
     // Generate 1D and 2D array samples using $(0,2)$-sequence
     for (size_t i = 0; i < samples1DArraySizes.size(); ++i)
         VanDerCorput(samples1DArraySizes[i], samplesPerPixel,
-                     &sampleArray1D[i][0], rng);
+                     Array1D(i), rng);
     for (size_t i = 0; i < samples2DArraySizes.size(); ++i)
-        Sobol2D(samples2DArraySizes[i], samplesPerPixel, &sampleArray2D[i][0],
+        Sobol2D(samples2DArraySizes[i], samplesPerPixel, Array2D(i),
                 rng);
     PixelSampler::StartPixel(p);
 }
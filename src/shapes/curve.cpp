@@ -33,6 +33,7 @@
 
 // shapes/curve.cpp*
 #include "shapes/curve.h"
+#include <functional>
 #include "paramset.h"
 #include "stats.h"
 STAT_MEMORY_COUNTER("Memory/Curves", curveBytes);
@@ -81,6 +82,20 @@ CurveCommon::CurveCommon(const Point3f c[4], Float width0, Float width1,
     }
 }
 
+// Surface area of the conservative bound for the [u0, u1] span of the
+// curve, used to steer the adaptive pre-split below
+static Float CurveSpanBoundArea(const CurveCommon &common, Float u0,
+                                Float u1) {
+    Point3f cp[4] = {BlossomBezier(common.cpObj, u0, u0, u0),
+                     BlossomBezier(common.cpObj, u0, u0, u1),
+                     BlossomBezier(common.cpObj, u0, u1, u1),
+                     BlossomBezier(common.cpObj, u1, u1, u1)};
+    Bounds3f b = Union(Bounds3f(cp[0], cp[1]), Bounds3f(cp[2], cp[3]));
+    Float width[2] = {Lerp(u0, common.width[0], common.width[1]),
+                      Lerp(u1, common.width[0], common.width[1])};
+    return Expand(b, std::max(width[0], width[1]) * 0.5f).SurfaceArea();
+}
+
 std::vector<std::shared_ptr<Shape>> CreateCurve(
     const Transform *o2w, const Transform *w2o, bool reverseOrientation,
     const Point3f c[4], Float w0, Float w1, CurveType type,
@@ -88,27 +103,56 @@ std::vector<std::shared_ptr<Shape>> CreateCurve(
     std::vector<std::shared_ptr<Shape>> segments;
     std::shared_ptr<CurveCommon> common =
         std::make_shared<CurveCommon>(c, w0, w1, type, norm);
-    const int nSegments = 1 << splitDepth;
-    segments.reserve(nSegments);
-    for (int i = 0; i < nSegments; ++i) {
-        Float uMin = i / (Float)nSegments;
-        Float uMax = (i + 1) / (Float)nSegments;
-        segments.push_back(std::make_shared<Curve>(o2w, w2o, reverseOrientation,
-                                                   common, uMin, uMax));
-    }
-    curveBytes += sizeof(CurveCommon) + nSegments * sizeof(Curve);
+
+    // Adaptively pre-split the strand: keep subdividing a span while
+    // the halves' bounds are meaningfully tighter than its own (the
+    // case exactly where curvature makes the sausage bound slosh), and
+    // stop early on near-straight spans, so the BVH gets more, tighter
+    // segments where they pay and fewer where they don't.  _splitDepth_
+    // bounds the refinement rather than fixing a uniform count.
+    const int maxDepth = Clamp(splitDepth + 4, 4, 10);
+    const Float convergeFactor = 0.8f;
+    std::function<void(Float, Float, int)> subdivide = [&](Float u0, Float u1,
+                                                           int depth) {
+        if (depth < maxDepth) {
+            Float uMid = 0.5f * (u0 + u1);
+            Float parentArea = CurveSpanBoundArea(*common, u0, u1);
+            Float childArea = CurveSpanBoundArea(*common, u0, uMid) +
+                              CurveSpanBoundArea(*common, uMid, u1);
+            if (depth < 2 || childArea < convergeFactor * parentArea) {
+                subdivide(u0, uMid, depth + 1);
+                subdivide(uMid, u1, depth + 1);
+                return;
+            }
+        }
+        segments.push_back(std::make_shared<Curve>(o2w, w2o,
+                                                   reverseOrientation, common,
+                                                   u0, u1));
+    };
+    subdivide(0, 1, 0);
+    curveBytes += sizeof(CurveCommon) + segments.size() * sizeof(Curve);
     return segments;
 }
 
+Curve::Curve(const Transform *ObjectToWorld, const Transform *WorldToObject,
+             bool reverseOrientation, const std::shared_ptr<CurveCommon> &common,
+             Float uMin, Float uMax)
+    : Shape(ObjectToWorld, WorldToObject, reverseOrientation),
+      common(common),
+      uMin(uMin),
+      uMax(uMax) {
+    // Blossom the segment's object-space control points once; every
+    // ray and bound computation reads them from here
+    segCpObj[0] = BlossomBezier(common->cpObj, uMin, uMin, uMin);
+    segCpObj[1] = BlossomBezier(common->cpObj, uMin, uMin, uMax);
+    segCpObj[2] = BlossomBezier(common->cpObj, uMin, uMax, uMax);
+    segCpObj[3] = BlossomBezier(common->cpObj, uMax, uMax, uMax);
+}
+
 Bounds3f Curve::ObjectBound() const {
-    // Compute object-space control points for curve segment, _cpObj_
-    Point3f cpObj[4];
-    cpObj[0] = BlossomBezier(common->cpObj, uMin, uMin, uMin);
-    cpObj[1] = BlossomBezier(common->cpObj, uMin, uMin, uMax);
-    cpObj[2] = BlossomBezier(common->cpObj, uMin, uMax, uMax);
-    cpObj[3] = BlossomBezier(common->cpObj, uMax, uMax, uMax);
     Bounds3f b =
-        Union(Bounds3f(cpObj[0], cpObj[1]), Bounds3f(cpObj[2], cpObj[3]));
+        Union(Bounds3f(segCpObj[0], segCpObj[1]),
+              Bounds3f(segCpObj[2], segCpObj[3]));
     Float width[2] = {Lerp(uMin, common->width[0], common->width[1]),
                       Lerp(uMax, common->width[0], common->width[1])};
     return Expand(b, std::max(width[0], width[1]) * 0.5f);
@@ -121,19 +165,12 @@ bool Curve::Intersect(const Ray &r, Float *tHit, SurfaceInteraction *isect,
     Vector3f oErr, dErr;
     Ray ray = (*WorldToObject)(r, &oErr, &dErr);
 
-    // Compute object-space control points for curve segment, _cpObj_
-    Point3f cpObj[4];
-    cpObj[0] = BlossomBezier(common->cpObj, uMin, uMin, uMin);
-    cpObj[1] = BlossomBezier(common->cpObj, uMin, uMin, uMax);
-    cpObj[2] = BlossomBezier(common->cpObj, uMin, uMax, uMax);
-    cpObj[3] = BlossomBezier(common->cpObj, uMax, uMax, uMax);
-
     // Project curve control points to plane perpendicular to ray
     Vector3f dx, dy;
     CoordinateSystem(ray.d, &dx, &dy);
     Transform objectToRay = LookAt(ray.o, ray.o + ray.d, dx);
-    Point3f cp[4] = {objectToRay(cpObj[0]), objectToRay(cpObj[1]),
-                     objectToRay(cpObj[2]), objectToRay(cpObj[3])};
+    Point3f cp[4] = {objectToRay(segCpObj[0]), objectToRay(segCpObj[1]),
+                     objectToRay(segCpObj[2]), objectToRay(segCpObj[3])};
 
     // Compute refinement depth for curve, _maxDepth_
     Float L0 = 0;
@@ -150,59 +187,59 @@ bool Curve::Intersect(const Ray &r, Float *tHit, SurfaceInteraction *isect,
 #undef LOG4
     int r0 = (int)std::round(fr0);
     int maxDepth = Clamp(r0, 0, 10);
-    return recursiveIntersect(ray, tHit, isect, cp, Inverse(objectToRay), uMin,
-                              uMax, maxDepth);
+    return intersectSpans(ray, tHit, isect, cp, Inverse(objectToRay),
+                          maxDepth);
 }
 
-bool Curve::recursiveIntersect(const Ray &ray, Float *tHit,
-                               SurfaceInteraction *isect, const Point3f cp[4],
-                               const Transform &rayToObject, Float u0, Float u1,
-                               int depth) const {
-    // Try to cull curve segment versus ray
-
-    // Compute bounding box of curve segment, _curveBounds_
-    Bounds3f curveBounds =
-        Union(Bounds3f(cp[0], cp[1]), Bounds3f(cp[2], cp[3]));
-    Float maxWidth = std::max(Lerp(u0, common->width[0], common->width[1]),
-                              Lerp(u1, common->width[0], common->width[1]));
-    curveBounds = Expand(curveBounds, 0.5 * maxWidth);
+bool Curve::intersectSpans(const Ray &ray, Float *tHit,
+                           SurfaceInteraction *isect, const Point3f cp[4],
+                           const Transform &rayToObject, int maxDepth) const {
+    // Depth-first traversal of the implicit subdivision tree with an
+    // explicit span stack (at most one pending sibling per level), so
+    // deep grooms don't pay a recursive call per subdivision and the
+    // ray bounds are computed once instead of at every node
+    struct CurveSpan {
+        Point3f cp[4];
+        Float u0, u1;
+        int depth;
+    };
+    CurveSpan spanStack[11];
+    int stackSize = 0;
+    CurveSpan span;
+    for (int i = 0; i < 4; ++i) span.cp[i] = cp[i];
+    span.u0 = uMin;
+    span.u1 = uMax;
+    span.depth = maxDepth;
 
     // Compute bounding box of ray, _rayBounds_
     Float rayLength = ray.d.Length();
     Float zMax = rayLength * ray.tMax;
     Bounds3f rayBounds(Point3f(0, 0, 0), Point3f(0, 0, zMax));
-    if (Overlaps(curveBounds, rayBounds) == false) return false;
-    if (depth > 0) {
-        // Split curve segment into sub-segments and test for intersection
-        Float uMid = 0.5f * (u0 + u1);
-        Point3f cpSplit[7];
-        SubdivideBezier(cp, cpSplit);
-        return (recursiveIntersect(ray, tHit, isect, &cpSplit[0], rayToObject,
-                                   u0, uMid, depth - 1) ||
-                recursiveIntersect(ray, tHit, isect, &cpSplit[3], rayToObject,
-                                   uMid, u1, depth - 1));
-    } else {
+
+    // Test a leaf span for an actual intersection; reads the current
+    // _span_ and reports the hit through _tHit_/_isect_
+    auto intersectLeafSpan = [&]() -> bool {
         // Intersect ray with curve segment
 
         // Test ray against segment endpoint boundaries
 
         // Test sample point against tangent perpendicular at curve start
-        Float edge =
-            (cp[1].y - cp[0].y) * -cp[0].y + cp[0].x * (cp[0].x - cp[1].x);
+        Float edge = (span.cp[1].y - span.cp[0].y) * -span.cp[0].y +
+                     span.cp[0].x * (span.cp[0].x - span.cp[1].x);
         if (edge < 0) return false;
 
         // Test sample point against tangent perpendicular at curve end
-        edge = (cp[2].y - cp[3].y) * -cp[3].y + cp[3].x * (cp[3].x - cp[2].x);
+        edge = (span.cp[2].y - span.cp[3].y) * -span.cp[3].y + span.cp[3].x * (span.cp[3].x - span.cp[2].x);
         if (edge < 0) return false;
 
         // Compute line $w$ that gives minimum distance to sample point
-        Vector2f segmentDirection = Point2f(cp[3]) - Point2f(cp[0]);
+        Vector2f segmentDirection = Point2f(span.cp[3]) - Point2f(span.cp[0]);
         Float denom = segmentDirection.LengthSquared();
         if (denom == 0) return false;
-        Float w = Dot(-Vector2f(cp[0]), segmentDirection) / denom;
+        Float w = Dot(-Vector2f(span.cp[0]), segmentDirection) / denom;
 
         // Compute $u$ coordinate of curve intersection point and _hitWidth_
-        Float u = Clamp(Lerp(w, u0, u1), u0, u1);
+        Float u = Clamp(Lerp(w, span.u0, span.u1), span.u0, span.u1);
         Float hitWidth = Lerp(u, common->width[0], common->width[1]);
         Normal3f nHit;
         if (common->type == CurveType::Ribbon) {
@@ -260,16 +297,48 @@ bool Curve::recursiveIntersect(const Ray &ray, Float *tHit,
         }
         ++nHits;
         return true;
+    };
+
+    for (;;) {
+        // Try to cull curve segment versus ray
+
+        // Compute bounding box of curve segment, _curveBounds_
+        Bounds3f curveBounds =
+            Union(Bounds3f(span.cp[0], span.cp[1]),
+                  Bounds3f(span.cp[2], span.cp[3]));
+        Float maxWidth =
+            std::max(Lerp(span.u0, common->width[0], common->width[1]),
+                     Lerp(span.u1, common->width[0], common->width[1]));
+        curveBounds = Expand(curveBounds, 0.5 * maxWidth);
+        if (Overlaps(curveBounds, rayBounds)) {
+            if (span.depth > 0) {
+                // Split the span, push the far half, and descend into
+                // the near one (in increasing _u_, matching the
+                // recursive traversal order)
+                Float uMid = 0.5f * (span.u0 + span.u1);
+                Point3f cpSplit[7];
+                SubdivideBezier(span.cp, cpSplit);
+                CurveSpan &rest = spanStack[stackSize++];
+                for (int i = 0; i < 4; ++i) rest.cp[i] = cpSplit[3 + i];
+                rest.u0 = uMid;
+                rest.u1 = span.u1;
+                rest.depth = span.depth - 1;
+                for (int i = 0; i < 4; ++i) span.cp[i] = cpSplit[i];
+                span.u1 = uMid;
+                --span.depth;
+                continue;
+            }
+            if (intersectLeafSpan()) return true;
+        }
+
+        // Take the next pending span, if any
+        if (stackSize == 0) return false;
+        span = spanStack[--stackSize];
     }
 }
 
 Float Curve::Area() const {
-    // Compute object-space control points for curve segment, _cpObj_
-    Point3f cpObj[4];
-    cpObj[0] = BlossomBezier(common->cpObj, uMin, uMin, uMin);
-    cpObj[1] = BlossomBezier(common->cpObj, uMin, uMin, uMax);
-    cpObj[2] = BlossomBezier(common->cpObj, uMin, uMax, uMax);
-    cpObj[3] = BlossomBezier(common->cpObj, uMax, uMax, uMax);
+    const Point3f *cpObj = segCpObj;
     Float width0 = Lerp(uMin, common->width[0], common->width[1]);
     Float width1 = Lerp(uMax, common->width[0], common->width[1]);
     Float avgWidth = (width0 + width1) * 0.5f;
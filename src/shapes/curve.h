@@ -62,11 +62,7 @@ class Curve : public Shape {
     // Curve Public Methods
     Curve(const Transform *ObjectToWorld, const Transform *WorldToObject,
           bool reverseOrientation, const std::shared_ptr<CurveCommon> &common,
-          Float uMin, Float uMax)
-        : Shape(ObjectToWorld, WorldToObject, reverseOrientation),
-          common(common),
-          uMin(uMin),
-          uMax(uMax) {}
+          Float uMin, Float uMax);
     Bounds3f ObjectBound() const;
     bool Intersect(const Ray &ray, Float *tHit, SurfaceInteraction *isect,
                    bool testAlphaTexture) const;
@@ -75,14 +71,16 @@ class Curve : public Shape {
 
   private:
     // Curve Private Methods
-    bool recursiveIntersect(const Ray &r, Float *tHit,
-                            SurfaceInteraction *isect, const Point3f cp[4],
-                            const Transform &rayToObject, Float u0, Float u1,
-                            int depth) const;
+    bool intersectSpans(const Ray &r, Float *tHit, SurfaceInteraction *isect,
+                        const Point3f cp[4], const Transform &rayToObject,
+                        int maxDepth) const;
 
     // Curve Private Data
     const std::shared_ptr<CurveCommon> common;
     const Float uMin, uMax;
+    // Object-space control points of this segment, blossomed once at
+    // construction rather than for every ray and bound computation
+    Point3f segCpObj[4];
 };
 
 std::vector<std::shared_ptr<Shape>> CreateCurveShape(const Transform *o2w,
@@ -121,6 +121,14 @@ Float Disk::Area() const {
     return phiMax * 0.5 * (radius * radius - innerRadius * innerRadius);
 }
 
+bool Disk::OrientationCone(Vector3f *axis, Float *cosThetaMax) const {
+    Normal3f n = Normalize((*ObjectToWorld)(Normal3f(0, 0, 1)));
+    if (reverseOrientation) n *= -1;
+    *axis = Vector3f(n);
+    *cosThetaMax = 1;
+    return true;
+}
+
 Interaction Disk::Sample(const Point2f &u) const {
     Point2f pd = ConcentricSampleDisk(u);
     Point3f pObj(pd.x * radius, pd.y * radius, height);
@@ -59,6 +59,7 @@ class Disk : public Shape {
     bool IntersectP(const Ray &ray, bool testAlphaTexture) const;
     Float Area() const;
     Interaction Sample(const Point2f &u) const;
+    bool OrientationCone(Vector3f *axis, Float *cosThetaMax) const;
 
   private:
     // Disk Private Data
@@ -0,0 +1,298 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// shapes/displaced.cpp*
+#include "shapes/displaced.h"
+#include "interaction.h"
+#include "texture.h"
+#include "stats.h"
+#include <list>
+#include <map>
+#include <mutex>
+
+STAT_COUNTER("Displacement/Micro-grids diced", nGridsDiced);
+STAT_MEMORY_COUNTER("Memory/Displacement micro-grid cache", microGridBytes);
+
+// A diced, displaced micro-triangle grid for one base triangle: the
+// (diceRate+1)*(diceRate+2)/2 displaced lattice vertices with their
+// shading data, indexed in barycentric row-major order.
+struct MicroGrid {
+    int diceRate;
+    std::vector<Point3f> p;
+    std::vector<Normal3f> n;
+    std::vector<Point2f> uv;
+    size_t Bytes() const {
+        return sizeof(*this) + p.size() * (sizeof(Point3f) +
+                                           sizeof(Normal3f) +
+                                           sizeof(Point2f));
+    }
+};
+
+// Bounded global LRU of diced grids, keyed by the DisplacedTriangle's
+// address; grids past the --displacecachemb budget are evicted and
+// re-diced on demand.
+static std::map<const DisplacedTriangle *,
+                std::pair<std::shared_ptr<MicroGrid>,
+                          std::list<const DisplacedTriangle *>::iterator>>
+    gridCache;
+static std::list<const DisplacedTriangle *> gridLRU;  // front = most recent
+static size_t gridCacheBytes = 0;
+static std::mutex gridCacheMutex;
+
+static inline int LatticeIndex(int i, int j, int diceRate) {
+    // Vertices are stored by row _j_ (barycentric v), each row holding
+    // diceRate + 1 - j entries
+    return j * (diceRate + 1) - j * (j - 1) / 2 + i;
+}
+
+// DisplacedTriangle Method Definitions
+DisplacedTriangle::DisplacedTriangle(
+    const Transform *ObjectToWorld, const Transform *WorldToObject,
+    bool reverseOrientation, const std::shared_ptr<TriangleMesh> &mesh,
+    int triNumber, const std::shared_ptr<Texture<Float>> &displacement,
+    Float scale, int diceRate)
+    : Shape(ObjectToWorld, WorldToObject, reverseOrientation),
+      mesh(mesh),
+      triNumber(triNumber),
+      displacement(displacement),
+      scale(scale),
+      diceRate(diceRate) {}
+
+void DisplacedTriangle::GetVertices(Point3f p[3], Normal3f n[3],
+                                    Point2f uv[3]) const {
+    const int *v = nullptr;
+    int vi[3];
+    for (int i = 0; i < 3; ++i) vi[i] = mesh->VertexIndex(3 * triNumber + i);
+    (void)v;
+    for (int i = 0; i < 3; ++i) {
+        p[i] = mesh->p[vi[i]];
+        n[i] = mesh->HasN() ? mesh->N(vi[i]) : Normal3f();
+    }
+    if (!mesh->HasN()) {
+        Normal3f ng(Normalize(Cross(p[1] - p[0], p[2] - p[0])));
+        n[0] = n[1] = n[2] = ng;
+    }
+    if (mesh->HasUV())
+        for (int i = 0; i < 3; ++i) uv[i] = mesh->UV(vi[i]);
+    else {
+        uv[0] = Point2f(0, 0);
+        uv[1] = Point2f(1, 0);
+        uv[2] = Point2f(1, 1);
+    }
+}
+
+// Dice this triangle's displaced micro-grid, or return the cached one
+static std::shared_ptr<MicroGrid> GetMicroGrid(
+    const DisplacedTriangle *tri,
+    const std::function<std::shared_ptr<MicroGrid>()> &dice) {
+    {
+        std::lock_guard<std::mutex> lock(gridCacheMutex);
+        auto iter = gridCache.find(tri);
+        if (iter != gridCache.end()) {
+            // Move to the recently-used end of the LRU
+            gridLRU.splice(gridLRU.begin(), gridLRU, iter->second.second);
+            return iter->second.first;
+        }
+    }
+    std::shared_ptr<MicroGrid> grid = dice();
+    ++nGridsDiced;
+    std::lock_guard<std::mutex> lock(gridCacheMutex);
+    auto iter = gridCache.find(tri);
+    if (iter != gridCache.end()) return iter->second.first;
+    gridLRU.push_front(tri);
+    gridCache[tri] = std::make_pair(grid, gridLRU.begin());
+    gridCacheBytes += grid->Bytes();
+    microGridBytes += grid->Bytes();
+    size_t budget = (size_t)std::max(1, PbrtOptions.displaceCacheMB) * 1024 *
+                    1024;
+    while (gridCacheBytes > budget && gridCache.size() > 1) {
+        auto evict = gridCache.find(gridLRU.back());
+        gridCacheBytes -= evict->second.first->Bytes();
+        microGridBytes -= evict->second.first->Bytes();
+        gridCache.erase(evict);
+        gridLRU.pop_back();
+    }
+    return grid;
+}
+
+Bounds3f DisplacedTriangle::ObjectBound() const {
+    return (*WorldToObject)(WorldBound());
+}
+
+Bounds3f DisplacedTriangle::WorldBound() const {
+    // The displaced surface lies within the base triangle's bounds
+    // padded by the maximum displacement along the shading normals
+    Point3f p[3];
+    Normal3f n[3];
+    Point2f uv[3];
+    GetVertices(p, n, uv);
+    Bounds3f b(p[0], p[1]);
+    b = Union(b, p[2]);
+    return Expand(b, std::abs(scale) * 1.01f + 1e-4f);
+}
+
+bool DisplacedTriangle::Intersect(const Ray &ray, Float *tHit,
+                                  SurfaceInteraction *isect,
+                                  bool testAlphaTexture) const {
+    // Fetch (or dice) this triangle's displaced micro-grid
+    std::shared_ptr<MicroGrid> grid = GetMicroGrid(this, [&]() {
+        std::shared_ptr<MicroGrid> g(new MicroGrid);
+        g->diceRate = diceRate;
+        Point3f p[3];
+        Normal3f n[3];
+        Point2f uv[3];
+        GetVertices(p, n, uv);
+        int nVerts = (diceRate + 1) * (diceRate + 2) / 2;
+        g->p.resize(nVerts);
+        g->n.resize(nVerts);
+        g->uv.resize(nVerts);
+        for (int j = 0; j <= diceRate; ++j)
+            for (int i = 0; i <= diceRate - j; ++i) {
+                Float b1 = (Float)i / diceRate, b2 = (Float)j / diceRate;
+                Float b0 = 1 - b1 - b2;
+                int index = LatticeIndex(i, j, diceRate);
+                Point3f pv = b0 * p[0] + b1 * Vector3f(p[1].x, p[1].y, p[1].z);
+                pv += b2 * Vector3f(p[2].x, p[2].y, p[2].z);
+                Normal3f nv = Normalize(b0 * n[0] + b1 * n[1] + b2 * n[2]);
+                Point2f uvv = b0 * uv[0] + Vector2f(b1 * uv[1].x, b1 * uv[1].y);
+                uvv += Vector2f(b2 * uv[2].x, b2 * uv[2].y);
+
+                // Evaluate the displacement texture at the lattice
+                // point; the interaction only needs uv (and position)
+                SurfaceInteraction si;
+                si.p = pv;
+                si.uv = uvv;
+                Float d = scale * displacement->Evaluate(si);
+                g->p[index] = pv + Vector3f(nv) * d;
+                g->n[index] = nv;
+                g->uv[index] = uvv;
+            }
+        return g;
+    });
+
+    // Intersect the ray with the micro-triangles of the grid, keeping
+    // the nearest hit
+    bool hit = false;
+    Float tMax = ray.tMax;
+    for (int j = 0; j < diceRate; ++j)
+        for (int i = 0; i < diceRate - j; ++i) {
+            int i00 = LatticeIndex(i, j, diceRate);
+            int i10 = LatticeIndex(i + 1, j, diceRate);
+            int i01 = LatticeIndex(i, j + 1, diceRate);
+            const int tris[2][3] = {
+                {i00, i10, i01},
+                {i10, LatticeIndex(i + 1, j + 1, diceRate), i01}};
+            int nTris = (i + 1 <= diceRate - (j + 1)) ? 2 : 1;
+            for (int t = 0; t < nTris; ++t) {
+                const Point3f &p0 = grid->p[tris[t][0]];
+                const Point3f &p1 = grid->p[tris[t][1]];
+                const Point3f &p2 = grid->p[tris[t][2]];
+
+                // Moller-Trumbore test against the micro-triangle
+                Vector3f e1 = p1 - p0, e2 = p2 - p0;
+                Vector3f pv = Cross(ray.d, e2);
+                Float det = Dot(e1, pv);
+                if (std::abs(det) < 1e-12f) continue;
+                Float invDet = 1 / det;
+                Vector3f tv = ray.o - p0;
+                Float b1 = Dot(tv, pv) * invDet;
+                if (b1 < 0 || b1 > 1) continue;
+                Vector3f qv = Cross(tv, e1);
+                Float b2 = Dot(ray.d, qv) * invDet;
+                if (b2 < 0 || b1 + b2 > 1) continue;
+                Float tt = Dot(e2, qv) * invDet;
+                if (tt <= 0 || tt >= tMax) continue;
+                tMax = tt;
+                hit = true;
+                if (tHit) {
+                    *tHit = tt;
+                    Float b0 = 1 - b1 - b2;
+                    Normal3f ns =
+                        Normalize(b0 * grid->n[tris[t][0]] +
+                                  b1 * grid->n[tris[t][1]] +
+                                  b2 * grid->n[tris[t][2]]);
+                    Point2f uvHit =
+                        Point2f(b0 * grid->uv[tris[t][0]].x +
+                                    b1 * grid->uv[tris[t][1]].x +
+                                    b2 * grid->uv[tris[t][2]].x,
+                                b0 * grid->uv[tris[t][0]].y +
+                                    b1 * grid->uv[tris[t][1]].y +
+                                    b2 * grid->uv[tris[t][2]].y);
+                    Vector3f dpdu, dpdv;
+                    CoordinateSystem(Vector3f(Normalize(Cross(e1, e2))),
+                                     &dpdu, &dpdv);
+                    Vector3f pError =
+                        gamma(9) * Abs(Vector3f(ray(tt).x, ray(tt).y,
+                                                ray(tt).z));
+                    *isect = SurfaceInteraction(ray(tt), pError, uvHit,
+                                                -ray.d, dpdu, dpdv,
+                                                Normal3f(0, 0, 0),
+                                                Normal3f(0, 0, 0), ray.time,
+                                                this);
+                    isect->n = Normal3f(Normalize(Cross(e1, e2)));
+                    if (Dot(isect->n, ns) < 0) isect->n = -isect->n;
+                    isect->shading.n = ns;
+                    isect->faceIndex = triNumber;
+                }
+            }
+        }
+    return hit;
+}
+
+Float DisplacedTriangle::Area() const {
+    // Approximate with the base triangle's area
+    Point3f p[3];
+    Normal3f n[3];
+    Point2f uv[3];
+    GetVertices(p, n, uv);
+    return 0.5f * Cross(p[1] - p[0], p[2] - p[0]).Length();
+}
+
+Interaction DisplacedTriangle::Sample(const Point2f &u) const {
+    Severe("DisplacedTriangle::Sample not implemented.");
+    return Interaction();
+}
+
+std::vector<std::shared_ptr<Shape>> CreateDisplacedMesh(
+    const Transform *o2w, const Transform *w2o, bool reverseOrientation,
+    const std::shared_ptr<TriangleMesh> &mesh,
+    const std::shared_ptr<Texture<Float>> &displacement, Float scale,
+    int diceRate) {
+    std::vector<std::shared_ptr<Shape>> shapes;
+    shapes.reserve(mesh->nTriangles);
+    for (int i = 0; i < mesh->nTriangles; ++i)
+        shapes.push_back(std::make_shared<DisplacedTriangle>(
+            o2w, w2o, reverseOrientation, mesh, i, displacement, scale,
+            diceRate));
+    return shapes;
+}
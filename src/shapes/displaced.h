@@ -0,0 +1,85 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_SHAPES_DISPLACED_H
+#define PBRT_SHAPES_DISPLACED_H
+
+// shapes/displaced.h*
+#include "shape.h"
+#include "shapes/triangle.h"
+
+// True displacement mapping: each base triangle of a mesh with a
+// "displacementmap" texture becomes a DisplacedTriangle whose bound is
+// the base triangle padded by the displacement scale.  The
+// micro-triangle grid for a base triangle is diced on first
+// intersection and recycled through a bounded global LRU
+// (--displacecachemb), Reyes-style, so displaced scenes keep a few
+// gigabytes of diced geometry resident instead of everything.
+class DisplacedTriangle : public Shape {
+  public:
+    // DisplacedTriangle Public Methods
+    DisplacedTriangle(const Transform *ObjectToWorld,
+                      const Transform *WorldToObject, bool reverseOrientation,
+                      const std::shared_ptr<TriangleMesh> &mesh, int triNumber,
+                      const std::shared_ptr<Texture<Float>> &displacement,
+                      Float scale, int diceRate);
+    Bounds3f ObjectBound() const;
+    Bounds3f WorldBound() const;
+    bool Intersect(const Ray &ray, Float *tHit, SurfaceInteraction *isect,
+                   bool testAlphaTexture) const;
+    Float Area() const;
+    Interaction Sample(const Point2f &u) const;
+
+  private:
+    // DisplacedTriangle Private Methods
+    void GetVertices(Point3f p[3], Normal3f n[3], Point2f uv[3]) const;
+
+    // DisplacedTriangle Private Data
+    std::shared_ptr<TriangleMesh> mesh;
+    const int triNumber;
+    std::shared_ptr<Texture<Float>> displacement;
+    const Float scale;
+    const int diceRate;
+};
+
+std::vector<std::shared_ptr<Shape>> CreateDisplacedMesh(
+    const Transform *o2w, const Transform *w2o, bool reverseOrientation,
+    const std::shared_ptr<TriangleMesh> &mesh,
+    const std::shared_ptr<Texture<Float>> &displacement, Float scale,
+    int diceRate);
+
+#endif  // PBRT_SHAPES_DISPLACED_H
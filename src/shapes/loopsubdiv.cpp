@@ -33,6 +33,7 @@
 
 // shapes/loopsubdiv.cpp*
 #include "shapes/loopsubdiv.h"
+#include "parallel.h"
 #include "shapes/triangle.h"
 #include "paramset.h"
 #include <set>
@@ -66,6 +67,7 @@ struct SDFace {
             f[i] = nullptr;
         }
         for (int i = 0; i < 4; ++i) children[i] = nullptr;
+        origIndex = -1;
     }
 
     // SDFace Methods
@@ -88,6 +90,9 @@ struct SDFace {
     SDVertex *v[3];
     SDFace *f[3];
     SDFace *children[4];
+    // Index of the ancestor control-mesh face, carried through
+    // subdivision so the output triangles can be textured per face
+    int origIndex;
 };
 
 struct SDEdge {
@@ -157,7 +162,10 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
     }
     int nFaces = nIndices / 3;
     std::unique_ptr<SDFace[]> fs(new SDFace[nFaces]);
-    for (int i = 0; i < nFaces; ++i) faces.push_back(&fs[i]);
+    for (int i = 0; i < nFaces; ++i) {
+        fs[i].origIndex = i;
+        faces.push_back(&fs[i]);
+    }
 
     // Set face to vertex pointers
     const int *vp = vertexIndices;
@@ -228,14 +236,18 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
         for (SDFace *face : f) {
             for (int k = 0; k < 4; ++k) {
                 face->children[k] = arena.Alloc<SDFace>();
+                face->children[k]->origIndex = face->origIndex;
                 newFaces.push_back(face->children[k]);
             }
         }
 
         // Update vertex positions and create new edge vertices
 
-        // Update vertex positions for even vertices
-        for (SDVertex *vertex : v) {
+        // Update vertex positions for even vertices; each vertex only
+        // reads its neighbors' current-level state and writes its own
+        // child, so the level's vertices can be processed in parallel
+        ParallelFor([&](int64_t i) {
+            SDVertex *vertex = v[i];
             if (!vertex->boundary) {
                 // Apply one-ring rule for even vertex
                 if (vertex->regular)
@@ -247,7 +259,7 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
                 // Apply boundary rule for even vertex
                 vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
             }
-        }
+        }, v.size(), 512);
 
         // Compute new odd edge vertices
         std::map<SDEdge, SDVertex *> edgeVerts;
@@ -285,13 +297,16 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
         // Update new mesh topology
 
         // Update even vertex face pointers
-        for (SDVertex *vertex : v) {
+        ParallelFor([&](int64_t i) {
+            SDVertex *vertex = v[i];
             int vertNum = vertex->startFace->vnum(vertex);
             vertex->child->startFace = vertex->startFace->children[vertNum];
-        }
+        }, v.size(), 2048);
 
-        // Update face neighbor pointers
-        for (SDFace *face : f) {
+        // Update face neighbor pointers; each face writes only its own
+        // children's pointers
+        ParallelFor([&](int64_t i) {
+            SDFace *face = f[i];
             for (int j = 0; j < 3; ++j) {
                 // Update children _f_ pointers for siblings
                 face->children[3]->f[j] = face->children[NEXT(j)];
@@ -305,22 +320,25 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
                 face->children[j]->f[PREV(j)] =
                     f2 ? f2->children[f2->vnum(face->v[j])] : nullptr;
             }
-        }
+        }, f.size(), 512);
 
-        // Update face vertex pointers
-        for (SDFace *face : f) {
+        // Update face vertex pointers; _edgeVerts_ is only read here,
+        // so the lookups must not go through the inserting operator[]
+        ParallelFor([&](int64_t i) {
+            SDFace *face = f[i];
             for (int j = 0; j < 3; ++j) {
                 // Update child vertex pointer to new even vertex
                 face->children[j]->v[j] = face->v[j]->child;
 
                 // Update child vertex pointer to new odd vertex
                 SDVertex *vert =
-                    edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
+                    edgeVerts.find(SDEdge(face->v[j], face->v[NEXT(j)]))
+                        ->second;
                 face->children[j]->v[NEXT(j)] = vert;
                 face->children[NEXT(j)]->v[j] = vert;
                 face->children[3]->v[j] = vert;
             }
-        }
+        }, f.size(), 512);
 
         // Prepare for next level of subdivision
         f = newFaces;
@@ -329,51 +347,54 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
 
     // Push vertices to limit surface
     std::unique_ptr<Point3f[]> pLimit(new Point3f[v.size()]);
-    for (size_t i = 0; i < v.size(); ++i) {
+    ParallelFor([&](int64_t i) {
         if (v[i]->boundary)
             pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
         else
             pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
-    }
+    }, v.size(), 512);
     for (size_t i = 0; i < v.size(); ++i) v[i]->p = pLimit[i];
 
-    // Compute vertex tangents on limit surface
-    std::vector<Normal3f> Ns;
-    Ns.reserve(v.size());
-    std::vector<Point3f> pRing(16, Point3f());
-    for (SDVertex *vertex : v) {
-        Vector3f S(0, 0, 0), T(0, 0, 0);
-        int valence = vertex->valence();
-        if (valence > (int)pRing.size()) pRing.resize(valence);
-        vertex->oneRing(&pRing[0]);
-        if (!vertex->boundary) {
-            // Compute tangents of interior face
-            for (int j = 0; j < valence; ++j) {
-                S += std::cos(2 * Pi * j / valence) * Vector3f(pRing[j]);
-                T += std::sin(2 * Pi * j / valence) * Vector3f(pRing[j]);
-            }
-        } else {
-            // Compute tangents of boundary face
-            S = pRing[valence - 1] - pRing[0];
-            if (valence == 2)
-                T = Vector3f(pRing[0] + pRing[1] - 2 * vertex->p);
-            else if (valence == 3)
-                T = pRing[1] - vertex->p;
-            else if (valence == 4)  // regular
-                T = Vector3f(-1 * pRing[0] + 2 * pRing[1] + 2 * pRing[2] +
-                             -1 * pRing[3] + -2 * vertex->p);
-            else {
-                Float theta = Pi / float(valence - 1);
-                T = Vector3f(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
-                for (int k = 1; k < valence - 1; ++k) {
-                    Float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
-                    T += Vector3f(wt * pRing[k]);
+    // Compute vertex tangents on limit surface; each chunk of vertices
+    // carries its own one-ring scratch buffer
+    std::vector<Normal3f> Ns(v.size());
+    ParallelForRange([&](int64_t begin, int64_t end) {
+        std::vector<Point3f> pRing(16, Point3f());
+        for (int64_t vi = begin; vi < end; ++vi) {
+            SDVertex *vertex = v[vi];
+            Vector3f S(0, 0, 0), T(0, 0, 0);
+            int valence = vertex->valence();
+            if (valence > (int)pRing.size()) pRing.resize(valence);
+            vertex->oneRing(&pRing[0]);
+            if (!vertex->boundary) {
+                // Compute tangents of interior face
+                for (int j = 0; j < valence; ++j) {
+                    S += std::cos(2 * Pi * j / valence) * Vector3f(pRing[j]);
+                    T += std::sin(2 * Pi * j / valence) * Vector3f(pRing[j]);
+                }
+            } else {
+                // Compute tangents of boundary face
+                S = pRing[valence - 1] - pRing[0];
+                if (valence == 2)
+                    T = Vector3f(pRing[0] + pRing[1] - 2 * vertex->p);
+                else if (valence == 3)
+                    T = pRing[1] - vertex->p;
+                else if (valence == 4)  // regular
+                    T = Vector3f(-1 * pRing[0] + 2 * pRing[1] + 2 * pRing[2] +
+                                 -1 * pRing[3] + -2 * vertex->p);
+                else {
+                    Float theta = Pi / float(valence - 1);
+                    T = Vector3f(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
+                    for (int k = 1; k < valence - 1; ++k) {
+                        Float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
+                        T += Vector3f(wt * pRing[k]);
+                    }
+                    T = -T;
                 }
-                T = -T;
             }
+            Ns[vi] = Normal3f(Cross(S, T));
         }
-        Ns.push_back(Normal3f(Cross(S, T)));
-    }
+    }, v.size(), 512);
 
     // Create triangle mesh from subdivision mesh
     {
@@ -383,7 +404,9 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
         size_t totVerts = v.size();
         std::map<SDVertex *, int> usedVerts;
         for (size_t i = 0; i < totVerts; ++i) usedVerts[v[i]] = i;
+        std::unique_ptr<int[]> faceIndices(new int[ntris]);
         for (size_t i = 0; i < ntris; ++i) {
+            faceIndices[i] = f[i]->origIndex;
             for (int j = 0; j < 3; ++j) {
                 *vp = usedVerts[f[i]->v[j]];
                 ++vp;
@@ -392,14 +415,14 @@ std::vector<std::shared_ptr<Shape>> LoopSubdivide(
         return CreateTriangleMesh(ObjectToWorld, WorldToObject,
                                   reverseOrientation, ntris, verts.get(),
                                   totVerts, pLimit.get(), nullptr, &Ns[0],
-                                  nullptr, nullptr, nullptr);
+                                  nullptr, nullptr, nullptr,
+                                  faceIndices.get());
     }
 }
 
-std::vector<std::shared_ptr<Shape>> CreateLoopSubdiv(const Transform *o2w,
-                                                     const Transform *w2o,
-                                                     bool reverseOrientation,
-                                                     const ParamSet &params) {
+std::vector<std::shared_ptr<Shape>> CreateLoopSubdiv(
+    const Transform *o2w, const Transform *w2o, bool reverseOrientation,
+    const ParamSet &params, const Point3f *cameraPos) {
     int nLevels = params.FindOneInt("nlevels", 3);
     int nps, nIndices;
     const int *vertexIndices = params.FindInt("indices", &nIndices);
@@ -413,6 +436,39 @@ std::vector<std::shared_ptr<Shape>> CreateLoopSubdiv(const Transform *o2w,
         return std::vector<std::shared_ptr<Shape>>();
     }
 
+    // Choose the subdivision depth adaptively when a screen-space edge
+    // target was given: "maxedgeangle" is the subdivided edge length
+    // per unit of distance from the camera (i.e. approximately the
+    // subtended angle in radians), so distant meshes stop refining
+    // early; "nlevels" remains the upper bound.
+    Float maxEdgeAngle = params.FindOneFloat("maxedgeangle", 0);
+    if (maxEdgeAngle > 0 && cameraPos) {
+        // Compute the mesh's longest world-space edge and its distance
+        // from the camera
+        Bounds3f bounds;
+        Float maxEdge2 = 0;
+        for (int i = 0; i < nps; ++i) bounds = Union(bounds, (*o2w)(P[i]));
+        for (int i = 0; i < nIndices; i += 3)
+            for (int j = 0; j < 3; ++j) {
+                Point3f p0 = (*o2w)(P[vertexIndices[i + j]]);
+                Point3f p1 = (*o2w)(P[vertexIndices[i + (j + 1) % 3]]);
+                maxEdge2 = std::max(maxEdge2, DistanceSquared(p0, p1));
+            }
+        Float distance = std::max(
+            Distance(*cameraPos, bounds.pMin + bounds.Diagonal() * 0.5f) -
+                bounds.Diagonal().Length() * 0.5f,
+            (Float)1e-3f);
+        // Each level halves edge lengths
+        Float targetEdge = maxEdgeAngle * distance;
+        int adaptiveLevels = 0;
+        Float edge = std::sqrt(maxEdge2);
+        while (edge > targetEdge && adaptiveLevels < nLevels) {
+            edge *= 0.5f;
+            ++adaptiveLevels;
+        }
+        nLevels = adaptiveLevels;
+    }
+
     // don't actually use this for now...
     std::string scheme = params.FindOneString("scheme", "loop");
     return LoopSubdivide(o2w, w2o, reverseOrientation, nLevels, nIndices,
@@ -35,6 +35,8 @@
 #include "shapes/nurbs.h"
 #include "shapes/triangle.h"
 #include "paramset.h"
+#include "parallel.h"
+#include <mutex>
 #include "texture.h"
 
 // NURBS Evaluation Functions
@@ -229,6 +231,49 @@ std::vector<std::shared_ptr<Shape>> CreateNURBS(const Transform *o2w,
         return std::vector<std::shared_ptr<Shape>>();
     }
 
+    // Serve the tessellation from the cache if this surface was diced
+    // before: instanced patches hash to the same key and tessellate
+    // only once.  The cache stores object-space geometry, so per-
+    // instance transforms still apply through the TriangleMesh.
+    struct NURBSTessellation {
+        int nTris, nVerts;
+        std::vector<int> indices;
+        std::vector<Point3f> p;
+        std::vector<Normal3f> n;
+        std::vector<Point2f> uv;
+    };
+    static std::map<uint64_t, NURBSTessellation> tessellationCache;
+    static std::mutex tessellationCacheMutex;
+    uint64_t key = 14695981039346656037ull;
+    auto mix = [&key](const void *data, size_t size) {
+        const unsigned char *bytes = (const unsigned char *)data;
+        for (size_t i = 0; i < size; ++i) {
+            key ^= bytes[i];
+            key *= 1099511628211ull;
+        }
+    };
+    mix(&nu, sizeof(nu));
+    mix(&nv, sizeof(nv));
+    mix(&uorder, sizeof(uorder));
+    mix(&vorder, sizeof(vorder));
+    mix(uknots, nuknots * sizeof(Float));
+    mix(vknots, nvknots * sizeof(Float));
+    Float uvRange[4] = {u0, u1, v0, v1};
+    mix(uvRange, sizeof(uvRange));
+    mix(&isHomogeneous, sizeof(isHomogeneous));
+    mix(P, npts * (isHomogeneous ? 4 : 3) * sizeof(Float));
+    {
+        std::lock_guard<std::mutex> lock(tessellationCacheMutex);
+        auto iter = tessellationCache.find(key);
+        if (iter != tessellationCache.end()) {
+            const NURBSTessellation &t = iter->second;
+            return CreateTriangleMesh(o2w, w2o, reverseOrientation, t.nTris,
+                                      &t.indices[0], t.nVerts, &t.p[0],
+                                      nullptr, &t.n[0], &t.uv[0], nullptr,
+                                      nullptr);
+        }
+    }
+
     // Compute NURBS dicing rates
     int diceu = 30, dicev = 30;
     std::unique_ptr<Float[]> ueval(new Float[diceu]);
@@ -264,21 +309,20 @@ std::vector<std::shared_ptr<Shape>> CreateNURBS(const Transform *o2w,
         }
     }
 
-    for (int v = 0; v < dicev; ++v) {
-        for (int u = 0; u < diceu; ++u) {
-            uvs[(v * diceu + u)].x = ueval[u];
-            uvs[(v * diceu + u)].y = veval[v];
-
-            Vector3f dpdu, dpdv;
-            Point3f pt = NURBSEvaluateSurface(uorder, uknots, nu, ueval[u],
-                                              vorder, vknots, nv, veval[v],
-                                              Pw.get(), &dpdu, &dpdv);
-            evalPs[v * diceu + u].x = pt.x;
-            evalPs[v * diceu + u].y = pt.y;
-            evalPs[v * diceu + u].z = pt.z;
-            evalNs[v * diceu + u] = Normal3f(Normalize(Cross(dpdu, dpdv)));
-        }
-    }
+    ParallelFor2D([&](Point2i uv) {
+        int u = uv.x, v = uv.y;
+        uvs[(v * diceu + u)].x = ueval[u];
+        uvs[(v * diceu + u)].y = veval[v];
+
+        Vector3f dpdu, dpdv;
+        Point3f pt = NURBSEvaluateSurface(uorder, uknots, nu, ueval[u],
+                                          vorder, vknots, nv, veval[v],
+                                          Pw.get(), &dpdu, &dpdv);
+        evalPs[v * diceu + u].x = pt.x;
+        evalPs[v * diceu + u].y = pt.y;
+        evalPs[v * diceu + u].z = pt.z;
+        evalNs[v * diceu + u] = Normal3f(Normalize(Cross(dpdu, dpdv)));
+    }, Point2i(diceu, dicev));
 
     // Generate points-polygons mesh
     int nTris = 2 * (diceu - 1) * (dicev - 1);
@@ -300,6 +344,20 @@ std::vector<std::shared_ptr<Shape>> CreateNURBS(const Transform *o2w,
     }
     int nVerts = diceu * dicev;
 
+    // Remember this tessellation for later instances of the surface
+    {
+        std::lock_guard<std::mutex> lock(tessellationCacheMutex);
+        NURBSTessellation &t = tessellationCache[key];
+        if (t.indices.empty()) {
+            t.nTris = nTris;
+            t.nVerts = nVerts;
+            t.indices.assign(vertices.get(), vertices.get() + 3 * nTris);
+            t.p.assign(evalPs.get(), evalPs.get() + nVerts);
+            t.n.assign(evalNs.get(), evalNs.get() + nVerts);
+            t.uv.assign(uvs.get(), uvs.get() + nVerts);
+        }
+    }
+
     return CreateTriangleMesh(o2w, w2o, reverseOrientation, nTris,
                               vertices.get(), nVerts, evalPs.get(), nullptr,
                               evalNs.get(), uvs.get(), nullptr, nullptr);
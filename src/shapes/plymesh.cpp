@@ -36,8 +36,16 @@
 #include "textures/constant.h"
 #include "paramset.h"
 #include "ext/rply.h"
+#include "parallel.h"
+#include "imageio.h"
 
 #include <iostream>
+#if defined(PBRT_IS_LINUX) || defined(PBRT_IS_OSX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PBRT_PLY_HAVE_MMAP
+#endif
 using namespace std;
 
 struct CallbackContext {
@@ -135,103 +143,496 @@ int rply_face_callback(p_ply_argument argument) {
     return 1;
 }
 
+
+// Binary mesh sidecar file layout: _BinaryMeshHeader_, then the int32
+// index array, then the Point3f positions, Normal3f normals (if
+// hasNormals), and Point2f uvs (if hasUVs), all exactly as passed to
+// the TriangleMesh constructor.
+struct BinaryMeshHeader {
+    uint32_t magic, version;
+    uint32_t floatSize;
+    uint32_t hasNormals, hasUVs;
+    uint32_t pad;
+    uint64_t nTriangles, nVertices;
+};
+static const uint32_t binaryMeshMagic = 0x484d4250;  // "PBMH"
+static const uint32_t binaryMeshVersion = 1;
+
+bool WriteBinaryMesh(const std::string &filename, int nTriangles,
+                     const int *indices, int nVertices, const Point3f *P,
+                     const Normal3f *N, const Point2f *UV) {
+    // Write to a temporary file and rename into place so a partial
+    // write is never mistaken for a valid sidecar
+    std::string tmpName = filename + ".tmp";
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (!f) {
+        Warning("Unable to write binary mesh file \"%s\"", tmpName.c_str());
+        return false;
+    }
+    BinaryMeshHeader header;
+    header.magic = binaryMeshMagic;
+    header.version = binaryMeshVersion;
+    header.floatSize = sizeof(Float);
+    header.hasNormals = N != nullptr;
+    header.hasUVs = UV != nullptr;
+    header.pad = 0;
+    header.nTriangles = nTriangles;
+    header.nVertices = nVertices;
+    bool ok =
+        fwrite(&header, sizeof(header), 1, f) == 1 &&
+        fwrite(indices, sizeof(int), 3 * (size_t)nTriangles, f) ==
+            3 * (size_t)nTriangles &&
+        fwrite(P, sizeof(Point3f), nVertices, f) == (size_t)nVertices;
+    if (ok && N)
+        ok = fwrite(N, sizeof(Normal3f), nVertices, f) == (size_t)nVertices;
+    if (ok && UV)
+        ok = fwrite(UV, sizeof(Point2f), nVertices, f) == (size_t)nVertices;
+    fclose(f);
+    if (!ok || rename(tmpName.c_str(), filename.c_str()) != 0) {
+        Warning("Error writing binary mesh file \"%s\"", filename.c_str());
+        remove(tmpName.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Load a .bmesh file into _context_, memory-mapping it where possible
+// so multi-gigabyte geometry pages in lazily
+static bool ReadBinaryMesh(const std::string &filename,
+                           CallbackContext *context, long *vertexCountOut,
+                           long *faceCountOut) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    BinaryMeshHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        header.magic != binaryMeshMagic ||
+        header.version != binaryMeshVersion ||
+        header.floatSize != sizeof(Float)) {
+        Warning("Ignoring binary mesh file \"%s\": stale or incompatible",
+                filename.c_str());
+        fclose(f);
+        return false;
+    }
+    size_t nTriangles = header.nTriangles, nVertices = header.nVertices;
+    size_t indexBytes = 3 * nTriangles * sizeof(int);
+    size_t expected = sizeof(header) + indexBytes +
+                      nVertices * sizeof(Point3f) +
+                      (header.hasNormals ? nVertices * sizeof(Normal3f) : 0) +
+                      (header.hasUVs ? nVertices * sizeof(Point2f) : 0);
+    context->p = new Point3f[nVertices];
+    if (header.hasNormals) context->n = new Normal3f[nVertices];
+    if (header.hasUVs) context->uv = new Point2f[nVertices];
+    context->indices = new int[3 * nTriangles];
+    context->indexCtr = 3 * nTriangles;
+    context->vertexCount = nVertices;
+    bool ok = false;
+#ifdef PBRT_PLY_HAVE_MMAP
+    struct stat sb;
+    if (fstat(fileno(f), &sb) == 0 && (size_t)sb.st_size >= expected) {
+        void *mapping =
+            mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fileno(f), 0);
+        if (mapping != MAP_FAILED) {
+            const char *data = (const char *)mapping + sizeof(header);
+            memcpy(context->indices, data, indexBytes);
+            data += indexBytes;
+            memcpy(context->p, data, nVertices * sizeof(Point3f));
+            data += nVertices * sizeof(Point3f);
+            if (header.hasNormals) {
+                memcpy(context->n, data, nVertices * sizeof(Normal3f));
+                data += nVertices * sizeof(Normal3f);
+            }
+            if (header.hasUVs)
+                memcpy(context->uv, data, nVertices * sizeof(Point2f));
+            munmap(mapping, sb.st_size);
+            ok = true;
+        }
+    }
+#endif  // PBRT_PLY_HAVE_MMAP
+    if (!ok) {
+        ok = fread(context->indices, sizeof(int), 3 * nTriangles, f) ==
+                 3 * nTriangles &&
+             fread(context->p, sizeof(Point3f), nVertices, f) == nVertices;
+        if (ok && header.hasNormals)
+            ok = fread(context->n, sizeof(Normal3f), nVertices, f) ==
+                 nVertices;
+        if (ok && header.hasUVs)
+            ok = fread(context->uv, sizeof(Point2f), nVertices, f) ==
+                 nVertices;
+    }
+    fclose(f);
+    if (!ok) {
+        Warning("Error reading binary mesh file \"%s\"", filename.c_str());
+        context->error = true;
+        return false;
+    }
+    *vertexCountOut = nVertices;
+    *faceCountOut = nTriangles;
+    return true;
+}
+
+#ifdef PBRT_PLY_HAVE_MMAP
+// Size in bytes of a PLY scalar type name, or 0 if unknown
+static int plyTypeSize(const std::string &type) {
+    if (type == "char" || type == "uchar" || type == "int8" ||
+        type == "uint8")
+        return 1;
+    if (type == "short" || type == "ushort" || type == "int16" ||
+        type == "uint16")
+        return 2;
+    if (type == "int" || type == "uint" || type == "int32" ||
+        type == "uint32" || type == "float" || type == "float32")
+        return 4;
+    if (type == "double" || type == "float64") return 8;
+    return 0;
+}
+
+// Fast path for binary_little_endian PLY files with the common layout
+// (scalar vertex properties followed by uchar-counted int face lists):
+// parse the header directly, memory-map the body, and bulk-convert the
+// vertex data with a parallel loop and the faces with a single pointer
+// walk, instead of funneling every value through rply's per-element
+// callbacks.  Returns false for anything unusual so the caller can
+// fall back to rply.
+static bool ReadBinaryPLYFast(const std::string &filename,
+                              CallbackContext *context, long *vertexCountOut,
+                              long *faceCountOut) {
+    // The raw-byte conversion below assumes a little-endian host
+    uint16_t endianProbe = 1;
+    if (*(uint8_t *)&endianProbe != 1) return false;
+
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    char line[512];
+    if (!fgets(line, sizeof(line), f) || strncmp(line, "ply", 3) != 0 ||
+        !fgets(line, sizeof(line), f) ||
+        strncmp(line, "format binary_little_endian", 27) != 0) {
+        fclose(f);
+        return false;
+    }
+
+    // Parse the element and property declarations
+    long vertexCount = 0, faceCount = 0;
+    int vertexStride = 0;
+    int xOffset = -1, nxOffset = -1, uOffset = -1;
+    int yOffset = -1, zOffset = -1, nyOffset = -1, nzOffset = -1,
+        vOffset = -1;
+    int xSize = 4;
+    bool inVertex = false, inFace = false, sawVertex = false, sawFace = false;
+    bool faceListOK = false;
+    for (;;) {
+        if (!fgets(line, sizeof(line), f)) {
+            fclose(f);
+            return false;
+        }
+        char a[128] = {0}, b[128] = {0}, c[128] = {0}, d[128] = {0},
+             e[128] = {0};
+        int nTokens = sscanf(line, "%127s %127s %127s %127s %127s", a, b, c,
+                             d, e);
+        if (!strcmp(a, "end_header")) break;
+        if (!strcmp(a, "comment")) continue;
+        if (!strcmp(a, "element")) {
+            inVertex = inFace = false;
+            if (nTokens == 3 && !strcmp(b, "vertex")) {
+                // The vertex element must precede the face element for
+                // the simple sequential layout assumed here
+                if (sawFace) {
+                    fclose(f);
+                    return false;
+                }
+                inVertex = sawVertex = true;
+                vertexCount = atol(c);
+            } else if (nTokens == 3 && !strcmp(b, "face")) {
+                inFace = sawFace = true;
+                faceCount = atol(c);
+            } else {
+                // Unknown elements would shift the data layout
+                fclose(f);
+                return false;
+            }
+        } else if (!strcmp(a, "property")) {
+            if (inVertex) {
+                if (nTokens != 3) {
+                    fclose(f);
+                    return false;
+                }
+                int size = plyTypeSize(b);
+                if (size == 0) {
+                    fclose(f);
+                    return false;
+                }
+                bool isFloat = !strcmp(b, "float") || !strcmp(b, "float32");
+                if (!strcmp(c, "x")) {
+                    if (!isFloat) {
+                        fclose(f);
+                        return false;
+                    }
+                    xOffset = vertexStride;
+                } else if (!strcmp(c, "y") && isFloat)
+                    yOffset = vertexStride;
+                else if (!strcmp(c, "z") && isFloat)
+                    zOffset = vertexStride;
+                else if (!strcmp(c, "nx")) {
+                    if (!isFloat) {
+                        fclose(f);
+                        return false;
+                    }
+                    nxOffset = vertexStride;
+                } else if (!strcmp(c, "ny") && isFloat)
+                    nyOffset = vertexStride;
+                else if (!strcmp(c, "nz") && isFloat)
+                    nzOffset = vertexStride;
+                else if (isFloat && (!strcmp(c, "u") || !strcmp(c, "s") ||
+                                     !strcmp(c, "texture_u") ||
+                                     !strcmp(c, "texture_s")))
+                    uOffset = vertexStride;
+                else if (isFloat && (!strcmp(c, "v") || !strcmp(c, "t") ||
+                                     !strcmp(c, "texture_v") ||
+                                     !strcmp(c, "texture_t")))
+                    vOffset = vertexStride;
+                vertexStride += size;
+            } else if (inFace) {
+                // Require the common uchar-counted 32-bit index list
+                faceListOK =
+                    nTokens == 5 && !strcmp(b, "list") &&
+                    plyTypeSize(c) == 1 && plyTypeSize(d) == 4 &&
+                    strcmp(d, "float") != 0 && strcmp(d, "float32") != 0 &&
+                    (!strcmp(e, "vertex_indices") ||
+                     !strcmp(e, "vertex_index"));
+                if (!faceListOK) {
+                    fclose(f);
+                    return false;
+                }
+            } else {
+                fclose(f);
+                return false;
+            }
+        }
+    }
+    long headerSize = ftell(f);
+    if (!sawVertex || !sawFace || vertexCount == 0 || faceCount == 0 ||
+        xOffset < 0 || !faceListOK) {
+        fclose(f);
+        return false;
+    }
+    // The bulk copies below read each attribute as adjacent floats, so
+    // anything but exact x y z / nx ny nz / u v layouts (e.g. an
+    // interleaved extra property) must fall back to the general reader
+    if (yOffset != xOffset + 4 || zOffset != xOffset + 8 ||
+        (nxOffset >= 0 &&
+         (nyOffset != nxOffset + 4 || nzOffset != nxOffset + 8)) ||
+        (uOffset >= 0 && vOffset != uOffset + 4)) {
+        fclose(f);
+        return false;
+    }
+
+    // Memory-map the file and locate the element data
+    struct stat sb;
+    if (fstat(fileno(f), &sb) != 0 ||
+        sb.st_size < headerSize + (int64_t)vertexCount * vertexStride) {
+        fclose(f);
+        return false;
+    }
+    void *mapping =
+        mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fileno(f), 0);
+    fclose(f);
+    if (mapping == MAP_FAILED) return false;
+    const char *vertexData = (const char *)mapping + headerSize;
+    const char *faceData = vertexData + (int64_t)vertexCount * vertexStride;
+    const char *fileEnd = (const char *)mapping + sb.st_size;
+
+    // Bulk-convert the vertex attributes in parallel
+    context->p = new Point3f[vertexCount];
+    if (nxOffset >= 0) context->n = new Normal3f[vertexCount];
+    if (uOffset >= 0) context->uv = new Point2f[vertexCount];
+    ParallelFor([&](int64_t i) {
+        const char *v = vertexData + i * vertexStride;
+        float xyz[3];
+        memcpy(xyz, v + xOffset, sizeof(xyz));
+        context->p[i] = Point3f(xyz[0], xyz[1], xyz[2]);
+        if (nxOffset >= 0) {
+            memcpy(xyz, v + nxOffset, sizeof(xyz));
+            context->n[i] = Normal3f(xyz[0], xyz[1], xyz[2]);
+        }
+        if (uOffset >= 0) {
+            memcpy(xyz, v + uOffset, 2 * sizeof(float));
+            context->uv[i] = Point2f(xyz[0], xyz[1]);
+        }
+    }, vertexCount, 65536);
+
+    // Walk the face lists sequentially, triangulating quads like the
+    // rply callback does
+    context->indices = new int[faceCount * 6];
+    context->vertexCount = vertexCount;
+    const char *fp = faceData;
+    for (long i = 0; i < faceCount; ++i) {
+        if (fp + 1 > fileEnd) goto fail;
+        int length = (uint8_t)*fp++;
+        if (fp + 4 * length > fileEnd) goto fail;
+        int face[4];
+        if (length == 3 || length == 4)
+            memcpy(face, fp, length * sizeof(int));
+        else
+            Warning(
+                "plymesh: Ignoring face with %i vertices (only triangles and "
+                "quads are supported!)",
+                length);
+        fp += 4 * (int64_t)length;
+        if (length != 3 && length != 4) continue;
+        for (int j = 0; j < length; ++j)
+            if (face[j] < 0 || face[j] >= vertexCount) {
+                Error(
+                    "plymesh: Vertex reference %i is out of bounds! "
+                    "Valid range is [0..%i)",
+                    face[j], (int)vertexCount);
+                goto fail;
+            }
+        for (int j = 0; j < 3; ++j)
+            context->indices[context->indexCtr++] = face[j];
+        if (length == 4) {
+            /* This was a quad */
+            context->indices[context->indexCtr++] = face[3];
+            context->indices[context->indexCtr++] = face[0];
+            context->indices[context->indexCtr++] = face[2];
+        }
+    }
+    munmap(mapping, sb.st_size);
+    *vertexCountOut = vertexCount;
+    *faceCountOut = faceCount;
+    return true;
+
+fail:
+    munmap(mapping, sb.st_size);
+    context->error = true;
+    return false;
+}
+#endif  // PBRT_PLY_HAVE_MMAP
+
 std::vector<std::shared_ptr<Shape>> CreatePLYMesh(
     const Transform *o2w, const Transform *w2o, bool reverseOrientation,
     const ParamSet &params,
     std::map<std::string, std::shared_ptr<Texture<Float>>> *floatTextures) {
     const std::string filename = params.FindOneFilename("filename", "");
-    p_ply ply = ply_open(filename.c_str(), rply_message_callback, 0, nullptr);
-    if (!ply) {
-        Error("Couldn't open PLY file \"%s\"", filename.c_str());
+    CallbackContext context;
+    long vertexCount = 0, faceCount = 0;
+    bool loaded = false;
+    bool isBinaryMesh = HasExtension(filename, "bmesh");
+
+    // Load the binary mesh sidecar when present -- either the file
+    // itself is a .bmesh or one was written next to it by an earlier
+    // run -- and otherwise parse the source and write the sidecar so
+    // the conversion happens once
+    std::string sidecarName = isBinaryMesh ? filename : filename + ".bmesh";
+    loaded = ReadBinaryMesh(sidecarName, &context, &vertexCount, &faceCount);
+    if (context.error) return std::vector<std::shared_ptr<Shape>>();
+    if (!loaded && isBinaryMesh) {
+        Error("Couldn't load binary mesh file \"%s\"", filename.c_str());
         return std::vector<std::shared_ptr<Shape>>();
     }
-
-    if (!ply_read_header(ply)) {
-        Error("Unable to read the header of PLY file \"%s\"", filename.c_str());
-        return std::vector<std::shared_ptr<Shape>>();
+#ifdef PBRT_PLY_HAVE_MMAP
+    // Try the memory-mapped bulk-conversion fast path next
+    if (!loaded) {
+        loaded =
+            ReadBinaryPLYFast(filename, &context, &vertexCount, &faceCount);
+        if (context.error) return std::vector<std::shared_ptr<Shape>>();
+        if (loaded)
+            WriteBinaryMesh(sidecarName, context.indexCtr / 3,
+                            context.indices, vertexCount, context.p,
+                            context.n, context.uv);
     }
+#endif  // PBRT_PLY_HAVE_MMAP
+    if (!loaded) {
+        p_ply ply = ply_open(filename.c_str(), rply_message_callback, 0, nullptr);
+        if (!ply) {
+            Error("Couldn't open PLY file \"%s\"", filename.c_str());
+            return std::vector<std::shared_ptr<Shape>>();
+        }
 
-    p_ply_element element = nullptr;
-    long vertexCount = 0, faceCount = 0;
+        if (!ply_read_header(ply)) {
+            Error("Unable to read the header of PLY file \"%s\"", filename.c_str());
+            return std::vector<std::shared_ptr<Shape>>();
+        }
 
-    /* Inspect the structure of the PLY file */
-    while ((element = ply_get_next_element(ply, element)) != nullptr) {
-        const char *name;
-        long nInstances;
+        p_ply_element element = nullptr;
 
-        ply_get_element_info(element, &name, &nInstances);
-        if (!strcmp(name, "vertex"))
-            vertexCount = nInstances;
-        else if (!strcmp(name, "face"))
-            faceCount = nInstances;
-    }
+        /* Inspect the structure of the PLY file */
+        while ((element = ply_get_next_element(ply, element)) != nullptr) {
+            const char *name;
+            long nInstances;
 
-    if (vertexCount == 0 || faceCount == 0) {
-        Error("PLY file \"%s\" is invalid! No face/vertex elements found!",
-              filename.c_str());
-        return std::vector<std::shared_ptr<Shape>>();
-    }
+            ply_get_element_info(element, &name, &nInstances);
+            if (!strcmp(name, "vertex"))
+                vertexCount = nInstances;
+            else if (!strcmp(name, "face"))
+                faceCount = nInstances;
+        }
 
-    CallbackContext context;
+        if (vertexCount == 0 || faceCount == 0) {
+            Error("PLY file \"%s\" is invalid! No face/vertex elements found!",
+                  filename.c_str());
+            return std::vector<std::shared_ptr<Shape>>();
+        }
 
-    if (ply_set_read_cb(ply, "vertex", "x", rply_vertex_callback, &context,
-                        0x030) &&
-        ply_set_read_cb(ply, "vertex", "y", rply_vertex_callback, &context,
-                        0x031) &&
-        ply_set_read_cb(ply, "vertex", "z", rply_vertex_callback, &context,
-                        0x032)) {
-        context.p = new Point3f[vertexCount];
-    } else {
-        Error("PLY file \"%s\": Vertex coordinate property not found!",
-              filename.c_str());
-        return std::vector<std::shared_ptr<Shape>>();
-    }
+        if (ply_set_read_cb(ply, "vertex", "x", rply_vertex_callback, &context,
+                            0x030) &&
+            ply_set_read_cb(ply, "vertex", "y", rply_vertex_callback, &context,
+                            0x031) &&
+            ply_set_read_cb(ply, "vertex", "z", rply_vertex_callback, &context,
+                            0x032)) {
+            context.p = new Point3f[vertexCount];
+        } else {
+            Error("PLY file \"%s\": Vertex coordinate property not found!",
+                  filename.c_str());
+            return std::vector<std::shared_ptr<Shape>>();
+        }
 
-    if (ply_set_read_cb(ply, "vertex", "nx", rply_vertex_callback, &context,
-                        0x130) &&
-        ply_set_read_cb(ply, "vertex", "ny", rply_vertex_callback, &context,
-                        0x131) &&
-        ply_set_read_cb(ply, "vertex", "nz", rply_vertex_callback, &context,
-                        0x132))
-        context.n = new Normal3f[vertexCount];
-
-    /* There seem to be lots of different conventions regarding UV coordinate
-     * names */
-    if ((ply_set_read_cb(ply, "vertex", "u", rply_vertex_callback, &context,
-                         0x220) &&
-         ply_set_read_cb(ply, "vertex", "v", rply_vertex_callback, &context,
-                         0x221)) ||
-        (ply_set_read_cb(ply, "vertex", "s", rply_vertex_callback, &context,
-                         0x220) &&
-         ply_set_read_cb(ply, "vertex", "t", rply_vertex_callback, &context,
-                         0x221)) ||
-        (ply_set_read_cb(ply, "vertex", "texture_u", rply_vertex_callback,
-                         &context, 0x220) &&
-         ply_set_read_cb(ply, "vertex", "texture_v", rply_vertex_callback,
-                         &context, 0x221)) ||
-        (ply_set_read_cb(ply, "vertex", "texture_s", rply_vertex_callback,
-                         &context, 0x220) &&
-         ply_set_read_cb(ply, "vertex", "texture_t", rply_vertex_callback,
-                         &context, 0x221)))
-        context.uv = new Point2f[vertexCount];
-
-    /* Allocate enough space in case all faces are quads */
-    context.indices = new int[faceCount * 6];
-    context.vertexCount = vertexCount;
-
-    ply_set_read_cb(ply, "face", "vertex_indices", rply_face_callback, &context,
-                    0);
-
-    if (!ply_read(ply)) {
-        Error("Unable to read the contents of PLY file \"%s\"",
-              filename.c_str());
-        ply_close(ply);
-        return std::vector<std::shared_ptr<Shape>>();
-    }
+        if (ply_set_read_cb(ply, "vertex", "nx", rply_vertex_callback, &context,
+                            0x130) &&
+            ply_set_read_cb(ply, "vertex", "ny", rply_vertex_callback, &context,
+                            0x131) &&
+            ply_set_read_cb(ply, "vertex", "nz", rply_vertex_callback, &context,
+                            0x132))
+            context.n = new Normal3f[vertexCount];
+
+        /* There seem to be lots of different conventions regarding UV coordinate
+         * names */
+        if ((ply_set_read_cb(ply, "vertex", "u", rply_vertex_callback, &context,
+                             0x220) &&
+             ply_set_read_cb(ply, "vertex", "v", rply_vertex_callback, &context,
+                             0x221)) ||
+            (ply_set_read_cb(ply, "vertex", "s", rply_vertex_callback, &context,
+                             0x220) &&
+             ply_set_read_cb(ply, "vertex", "t", rply_vertex_callback, &context,
+                             0x221)) ||
+            (ply_set_read_cb(ply, "vertex", "texture_u", rply_vertex_callback,
+                             &context, 0x220) &&
+             ply_set_read_cb(ply, "vertex", "texture_v", rply_vertex_callback,
+                             &context, 0x221)) ||
+            (ply_set_read_cb(ply, "vertex", "texture_s", rply_vertex_callback,
+                             &context, 0x220) &&
+             ply_set_read_cb(ply, "vertex", "texture_t", rply_vertex_callback,
+                             &context, 0x221)))
+            context.uv = new Point2f[vertexCount];
+
+        /* Allocate enough space in case all faces are quads */
+        context.indices = new int[faceCount * 6];
+        context.vertexCount = vertexCount;
+
+        ply_set_read_cb(ply, "face", "vertex_indices", rply_face_callback, &context,
+                        0);
+
+        if (!ply_read(ply)) {
+            Error("Unable to read the contents of PLY file \"%s\"",
+                  filename.c_str());
+            ply_close(ply);
+            return std::vector<std::shared_ptr<Shape>>();
+        }
 
-    ply_close(ply);
+        ply_close(ply);
 
-    if (context.error) return std::vector<std::shared_ptr<Shape>>();
+        if (context.error) return std::vector<std::shared_ptr<Shape>>();
+        WriteBinaryMesh(sidecarName, context.indexCtr / 3, context.indices,
+                        vertexCount, context.p, context.n, context.uv);
+    }
 
     // Look up an alpha texture, if applicable
     std::shared_ptr<Texture<Float>> alphaTex;
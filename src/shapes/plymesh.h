@@ -41,6 +41,13 @@
 // shapes/plymesh.h*
 #include "shapes/triangle.h"
 
+// Write geometry to the binary mesh sidecar format (.bmesh), which
+// serializes the TriangleMesh inputs verbatim so a later run can load
+// the mesh by memory-mapping instead of re-parsing its source file
+bool WriteBinaryMesh(const std::string &filename, int nTriangles,
+                     const int *indices, int nVertices, const Point3f *P,
+                     const Normal3f *N, const Point2f *UV);
+
 std::vector<std::shared_ptr<Shape>> CreatePLYMesh(
     const Transform *o2w, const Transform *w2o, bool reverseOrientation,
     const ParamSet &params,
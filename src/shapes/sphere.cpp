@@ -155,32 +155,33 @@ bool Sphere::IntersectP(const Ray &r, bool testAlphaTexture) const {
     Float phi;
     Point3f pHit;
     // Transform _Ray_ to object space
-    Vector3f oErr, dErr;
-    Ray ray = (*WorldToObject)(r, &oErr, &dErr);
+    Ray ray = (*WorldToObject)(r);
 
-    // Compute quadratic sphere coefficients
-
-    // Initialize _EFloat_ ray coordinate values
-    EFloat ox(ray.o.x, oErr.x), oy(ray.o.y, oErr.y), oz(ray.o.z, oErr.z);
-    EFloat dx(ray.d.x, dErr.x), dy(ray.d.y, dErr.y), dz(ray.d.z, dErr.z);
-    EFloat a = dx * dx + dy * dy + dz * dz;
-    EFloat b = 2 * (dx * ox + dy * oy + dz * oz);
-    EFloat c = ox * ox + oy * oy + oz * oz - EFloat(radius) * EFloat(radius);
+    // Compute quadratic sphere coefficients with plain floats: the
+    // boolean result doesn't need EFloat interval tracking, and the
+    // conservatively shrunk t window below covers the transformed
+    // ray's rounding error (Quadratic() already solves in double)
+    Float a = ray.d.x * ray.d.x + ray.d.y * ray.d.y + ray.d.z * ray.d.z;
+    Float b = 2 * (ray.d.x * ray.o.x + ray.d.y * ray.o.y + ray.d.z * ray.o.z);
+    Float c = ray.o.x * ray.o.x + ray.o.y * ray.o.y + ray.o.z * ray.o.z -
+              radius * radius;
 
     // Solve quadratic equation for _t_ values
-    EFloat t0, t1;
+    Float t0, t1;
     if (!Quadratic(a, b, c, &t0, &t1)) return false;
 
-    // Check quadric shape _t0_ and _t1_ for nearest intersection
-    if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0) return false;
-    EFloat tShapeHit = t0;
-    if (tShapeHit.LowerBound() <= 0) {
+    // Check quadric shape _t0_ and _t1_ for nearest intersection,
+    // never reporting occlusion past the shrunk _tMax_
+    Float tMax = ray.tMax * (1 - (Float)1e-5);
+    if (t0 > tMax || t1 <= 0) return false;
+    Float tShapeHit = t0;
+    if (tShapeHit <= 0) {
         tShapeHit = t1;
-        if (tShapeHit.UpperBound() > ray.tMax) return false;
+        if (tShapeHit > tMax) return false;
     }
 
     // Compute sphere hit position and $\phi$
-    pHit = ray((Float)tShapeHit);
+    pHit = ray(tShapeHit);
 
     // Refine sphere intersection point
     pHit *= radius / Distance(pHit, Point3f(0, 0, 0));
@@ -192,10 +193,10 @@ bool Sphere::IntersectP(const Ray &r, bool testAlphaTexture) const {
     if ((zMin > -radius && pHit.z < zMin) || (zMax < radius && pHit.z > zMax) ||
         phi > phiMax) {
         if (tShapeHit == t1) return false;
-        if (t1.UpperBound() > ray.tMax) return false;
+        if (t1 > tMax) return false;
         tShapeHit = t1;
         // Compute sphere hit position and $\phi$
-        pHit = ray((Float)tShapeHit);
+        pHit = ray(tShapeHit);
 
         // Refine sphere intersection point
         pHit *= radius / Distance(pHit, Point3f(0, 0, 0));
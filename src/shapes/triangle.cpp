@@ -38,9 +38,44 @@
 #include "paramset.h"
 #include "sampling.h"
 #include "efloat.h"
+#include "memory.h"
+#include "shapes/displaced.h"
 #include "ext/rply.h"
 STAT_PERCENT("Intersections/Ray-triangle intersection tests", nHits, nTests);
 
+// Per-thread cache of the watertight test's ray-dependent constants:
+// every triangle tested against the same ray direction (BVH leaf runs,
+// a ray's whole traversal) reuses the permutation and shear divisions
+// instead of recomputing them per triangle.  Zero-initialized; a zero
+// direction never matches a valid ray.
+struct RayShearCache {
+    Float dx, dy, dz;
+    int kx, ky, kz;
+    Float Sx, Sy, Sz;
+};
+static PBRT_THREAD_LOCAL RayShearCache rayShear;
+
+static inline void UpdateRayShearCache(const Ray &ray) {
+    if (ray.d.x == rayShear.dx && ray.d.y == rayShear.dy &&
+        ray.d.z == rayShear.dz)
+        return;
+    int kz = MaxDimension(Abs(ray.d));
+    int kx = kz + 1;
+    if (kx == 3) kx = 0;
+    int ky = kx + 1;
+    if (ky == 3) ky = 0;
+    Vector3f d = Permute(ray.d, kx, ky, kz);
+    rayShear.dx = ray.d.x;
+    rayShear.dy = ray.d.y;
+    rayShear.dz = ray.d.z;
+    rayShear.kx = kx;
+    rayShear.ky = ky;
+    rayShear.kz = kz;
+    rayShear.Sx = -d.x / d.z;
+    rayShear.Sy = -d.y / d.z;
+    rayShear.Sz = 1.f / d.z;
+}
+
 // Triangle Local Definitions
 static void PlyErrorCallback(p_ply, const char *message) {
     Error("PLY writing error: %s", message);
@@ -52,12 +87,20 @@ TriangleMesh::TriangleMesh(
     const Transform &ObjectToWorld, int nTriangles, const int *vertexIndices,
     int nVertices, const Point3f *P, const Vector3f *S, const Normal3f *N,
     const Point2f *UV, const std::shared_ptr<Texture<Float>> &alphaMask,
-    const std::shared_ptr<Texture<Float>> &shadowAlphaMask)
+    const std::shared_ptr<Texture<Float>> &shadowAlphaMask,
+    const int *fIndices, bool compact, bool bakeFrames)
     : nTriangles(nTriangles),
       nVertices(nVertices),
-      vertexIndices(vertexIndices, vertexIndices + 3 * nTriangles),
       alphaMask(alphaMask),
       shadowAlphaMask(shadowAlphaMask) {
+    // Select the vertex index width
+    if (compact && nVertices <= 65535)
+        this->vertexIndices16 = std::vector<uint16_t>(
+            vertexIndices, vertexIndices + 3 * nTriangles);
+    else
+        this->vertexIndices =
+            std::vector<int>(vertexIndices, vertexIndices + 3 * nTriangles);
+    if (fIndices) faceIndices = std::vector<int>(fIndices, fIndices + nTriangles);
     ++nMeshes;
     nTris += nTriangles;
     triMeshBytes += sizeof(*this) + (3 * nTriangles * sizeof(int)) +
@@ -68,19 +111,91 @@ TriangleMesh::TriangleMesh(
     p.reset(new Point3f[nVertices]);
     for (int i = 0; i < nVertices; ++i) p[i] = ObjectToWorld(P[i]);
 
-    // Copy _UV_, _N_, and _S_ vertex data, if present
+    // Copy _UV_, _N_, and _S_ vertex data, if present; the compact
+    // representation quantizes uvs to half precision and normals to
+    // 16-bit octahedral form as they are copied
     if (UV) {
-        uv.reset(new Point2f[nVertices]);
-        memcpy(uv.get(), UV, nVertices * sizeof(Point2f));
+        if (compact) {
+            halfUVs.reset(new uint16_t[2 * nVertices]);
+            for (int i = 0; i < nVertices; ++i) {
+                halfUVs[2 * i] = FloatToHalf((float)UV[i].x);
+                halfUVs[2 * i + 1] = FloatToHalf((float)UV[i].y);
+            }
+        } else {
+            uv.reset(new Point2f[nVertices]);
+            memcpy(uv.get(), UV, nVertices * sizeof(Point2f));
+        }
     }
     if (N) {
-        n.reset(new Normal3f[nVertices]);
-        for (int i = 0; i < nVertices; ++i) n[i] = ObjectToWorld(N[i]);
+        if (compact) {
+            octNormals.reset(new int16_t[2 * nVertices]);
+            for (int i = 0; i < nVertices; ++i)
+                OctEncodeNormal(Normalize(ObjectToWorld(N[i])),
+                                &octNormals[2 * i]);
+        } else {
+            n.reset(new Normal3f[nVertices]);
+            for (int i = 0; i < nVertices; ++i) n[i] = ObjectToWorld(N[i]);
+        }
     }
     if (S) {
         s.reset(new Vector3f[nVertices]);
         for (int i = 0; i < nVertices; ++i) s[i] = ObjectToWorld(S[i]);
     }
+
+    // Bake per-vertex shading frames and per-triangle normal
+    // derivatives ("bakeframes"): deferred shading setup then reduces
+    // to a quaternion fetch+blend and two array fetches instead of
+    // re-orthogonalizing and solving the 2x2 system on every hit
+    if (bakeFrames && HasN()) {
+        bakedFrames.reset(new Quaternion[nVertices]);
+        for (int i = 0; i < nVertices; ++i) {
+            Vector3f ns = (Vector3f)this->N(i);
+            if (ns.LengthSquared() > 0)
+                ns = Normalize(ns);
+            else
+                ns = Vector3f(0, 0, 1);
+            Vector3f ss, ts;
+            if (s) {
+                // Gram-Schmidt the supplied tangent against the normal
+                ss = this->s[i] - Dot(this->s[i], ns) * ns;
+                if (ss.LengthSquared() > 0)
+                    ss = Normalize(ss);
+                else
+                    CoordinateSystem(ns, &ss, &ts);
+            } else
+                CoordinateSystem(ns, &ss, &ts);
+            ts = Cross(ns, ss);
+            // Columns (ss, ts, ns) form a proper rotation
+            Matrix4x4 frame(ss.x, ts.x, ns.x, 0, ss.y, ts.y, ns.y, 0, ss.z,
+                            ts.z, ns.z, 0, 0, 0, 0, 1);
+            bakedFrames[i] = Quaternion(Transform(frame));
+        }
+        bakedDndu.reset(new Normal3f[nTriangles]);
+        bakedDndv.reset(new Normal3f[nTriangles]);
+        for (int t = 0; t < nTriangles; ++t) {
+            int v0 = VertexIndex(3 * t), v1 = VertexIndex(3 * t + 1),
+                v2 = VertexIndex(3 * t + 2);
+            Point2f uv0(0, 0), uv1(1, 0), uv2(1, 1);
+            if (HasUV()) {
+                uv0 = this->UV(v0);
+                uv1 = this->UV(v1);
+                uv2 = this->UV(v2);
+            }
+            Vector2f duv02 = uv0 - uv2, duv12 = uv1 - uv2;
+            Normal3f dn1 = this->N(v0) - this->N(v2);
+            Normal3f dn2 = this->N(v1) - this->N(v2);
+            Float determinant = duv02[0] * duv12[1] - duv02[1] * duv12[0];
+            if (determinant == 0)
+                bakedDndu[t] = bakedDndv[t] = Normal3f(0, 0, 0);
+            else {
+                Float invDet = 1 / determinant;
+                bakedDndu[t] = (duv12[1] * dn1 - duv02[1] * dn2) * invDet;
+                bakedDndv[t] = (-duv12[0] * dn1 + duv02[0] * dn2) * invDet;
+            }
+        }
+        triMeshBytes += nVertices * sizeof(Quaternion) +
+                        2 * nTriangles * sizeof(Normal3f);
+    }
 }
 
 std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(
@@ -88,15 +203,28 @@ std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(
     bool reverseOrientation, int nTriangles, const int *vertexIndices,
     int nVertices, const Point3f *p, const Vector3f *s, const Normal3f *n,
     const Point2f *uv, const std::shared_ptr<Texture<Float>> &alphaMask,
-    const std::shared_ptr<Texture<Float>> &shadowAlphaMask) {
+    const std::shared_ptr<Texture<Float>> &shadowAlphaMask,
+    const int *faceIndices, bool compact, bool bakeFrames) {
     std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>(
         *ObjectToWorld, nTriangles, vertexIndices, nVertices, p, s, n, uv,
-        alphaMask, shadowAlphaMask);
+        alphaMask, shadowAlphaMask, faceIndices, compact, bakeFrames);
     std::vector<std::shared_ptr<Shape>> tris;
     tris.reserve(nTriangles);
+
+    // Allocate every _Triangle_ of the mesh in one block whose aliased
+    // shared pointers share a single control block, instead of one
+    // heap object plus control block per triangle
+    Triangle *triangleBlock =
+        (Triangle *)AllocAligned(nTriangles * sizeof(Triangle));
+    for (int i = 0; i < nTriangles; ++i)
+        new (&triangleBlock[i]) Triangle(ObjectToWorld, WorldToObject,
+                                         reverseOrientation, mesh, i);
+    std::shared_ptr<Triangle> block(triangleBlock, [nTriangles](Triangle *t) {
+        for (int i = 0; i < nTriangles; ++i) t[i].~Triangle();
+        FreeAligned(t);
+    });
     for (int i = 0; i < nTriangles; ++i)
-        tris.push_back(std::make_shared<Triangle>(ObjectToWorld, WorldToObject,
-                                                  reverseOrientation, mesh, i));
+        tris.push_back(std::shared_ptr<Shape>(block, &triangleBlock[i]));
     return tris;
 }
 
@@ -156,18 +284,18 @@ bool WritePlyFile(const std::string &filename, int nTriangles,
 
 Bounds3f Triangle::ObjectBound() const {
     // Get triangle vertices in _p0_, _p1_, and _p2_
-    const Point3f &p0 = mesh->p[v[0]];
-    const Point3f &p1 = mesh->p[v[1]];
-    const Point3f &p2 = mesh->p[v[2]];
+    const Point3f &p0 = mesh->p[vi(0)];
+    const Point3f &p1 = mesh->p[vi(1)];
+    const Point3f &p2 = mesh->p[vi(2)];
     return Union(Bounds3f((*WorldToObject)(p0), (*WorldToObject)(p1)),
                  (*WorldToObject)(p2));
 }
 
 Bounds3f Triangle::WorldBound() const {
     // Get triangle vertices in _p0_, _p1_, and _p2_
-    const Point3f &p0 = mesh->p[v[0]];
-    const Point3f &p1 = mesh->p[v[1]];
-    const Point3f &p2 = mesh->p[v[2]];
+    const Point3f &p0 = mesh->p[vi(0)];
+    const Point3f &p1 = mesh->p[vi(1)];
+    const Point3f &p2 = mesh->p[vi(2)];
     return Union(Bounds3f(p0, p1), p2);
 }
 
@@ -176,9 +304,9 @@ bool Triangle::Intersect(const Ray &ray, Float *tHit, SurfaceInteraction *isect,
     ProfilePhase p(Prof::TriIntersect);
     ++nTests;
     // Get triangle vertices in _p0_, _p1_, and _p2_
-    const Point3f &p0 = mesh->p[v[0]];
-    const Point3f &p1 = mesh->p[v[1]];
-    const Point3f &p2 = mesh->p[v[2]];
+    const Point3f &p0 = mesh->p[vi(0)];
+    const Point3f &p1 = mesh->p[vi(1)];
+    const Point3f &p2 = mesh->p[vi(2)];
 
     // Perform ray--triangle intersection test
 
@@ -189,21 +317,18 @@ bool Triangle::Intersect(const Ray &ray, Float *tHit, SurfaceInteraction *isect,
     Point3f p1t = p1 - Vector3f(ray.o);
     Point3f p2t = p2 - Vector3f(ray.o);
 
-    // Permute components of triangle vertices and ray direction
-    int kz = MaxDimension(Abs(ray.d));
-    int kx = kz + 1;
-    if (kx == 3) kx = 0;
-    int ky = kx + 1;
-    if (ky == 3) ky = 0;
-    Vector3f d = Permute(ray.d, kx, ky, kz);
+    // Permute components of triangle vertices using the cached
+    // ray-dependent constants
+    UpdateRayShearCache(ray);
+    int kx = rayShear.kx, ky = rayShear.ky, kz = rayShear.kz;
     p0t = Permute(p0t, kx, ky, kz);
     p1t = Permute(p1t, kx, ky, kz);
     p2t = Permute(p2t, kx, ky, kz);
 
     // Apply shear transformation to translated vertex positions
-    Float Sx = -d.x / d.z;
-    Float Sy = -d.y / d.z;
-    Float Sz = 1.f / d.z;
+    Float Sx = rayShear.Sx;
+    Float Sy = rayShear.Sy;
+    Float Sz = rayShear.Sz;
     p0t.x += Sx * p0t.z;
     p0t.y += Sy * p0t.z;
     p1t.x += Sx * p1t.z;
@@ -319,83 +444,126 @@ bool Triangle::Intersect(const Ray &ray, Float *tHit, SurfaceInteraction *isect,
     *isect = SurfaceInteraction(pHit, pError, uvHit, -ray.d, dpdu, dpdv,
                                 Normal3f(0, 0, 0), Normal3f(0, 0, 0), ray.time,
                                 this);
+    isect->faceIndex = faceIndex;
 
-    // Override surface normal in _isect_ for triangle
+    // Override surface normal in _isect_ for triangle and defer the
+    // interpolated shading-geometry setup: it only runs (from
+    // ComputeScatteringFunctions) for the hit that actually shades,
+    // not for every closer-hit candidate found during traversal
     isect->n = isect->shading.n = Normal3f(Normalize(Cross(dp02, dp12)));
-    if (mesh->n || mesh->s) {
-        // Initialize _Triangle_ shading geometry
-
-        // Compute shading normal _ns_ for triangle
-        Normal3f ns;
-        if (mesh->n) {
-            ns = (b0 * mesh->n[v[0]] + b1 * mesh->n[v[1]] +
-                  b2 * mesh->n[v[2]]);
-            if (ns.LengthSquared() > 0)
-                ns = Normalize(ns);
-            else
-                ns = isect->n;
-        } else
-            ns = isect->n;
+    if (mesh->HasN()) {
+        // Orient the geometric normal now (an unnormalized
+        // interpolated normal suffices for the sign test) so emission
+        // queries made before shading finalization see the right side
+        Normal3f nsApprox = b0 * mesh->N(vi(0)) + b1 * mesh->N(vi(1)) +
+                            (1 - b0 - b1) * mesh->N(vi(2));
+        isect->n = Faceforward(isect->n, nsApprox);
+        isect->shading.n = isect->n;
+    } else if (reverseOrientation ^ transformSwapsHandedness)
+        isect->n = isect->shading.n = -isect->n;
+    if (mesh->HasN() || mesh->s) {
+        isect->shadingDeferred = true;
+        isect->deferredB0 = b0;
+        isect->deferredB1 = b1;
+    }
+    *tHit = t;
+    ++nHits;
+    return true;
+}
 
-        // Compute shading tangent _ss_ for triangle
-        Vector3f ss;
-        if (mesh->s) {
-            ss = (b0 * mesh->s[v[0]] + b1 * mesh->s[v[1]] +
-                  b2 * mesh->s[v[2]]);
-            if (ss.LengthSquared() > 0)
-                ss = Normalize(ss);
-            else
-                ss = Normalize(isect->dpdu);
-        }
+
+// Rotate _v_ by the unit quaternion _q_
+static inline Vector3f RotateVector(const Quaternion &q, const Vector3f &v) {
+    Vector3f t = 2 * Cross(q.v, v);
+    return v + q.w * t + Cross(q.v, t);
+}
+
+void Triangle::ComputeDeferredShading(SurfaceInteraction *isect) const {
+    Float b0 = isect->deferredB0, b1 = isect->deferredB1;
+    Float b2 = 1 - b0 - b1;
+    if (mesh->bakedFrames) {
+        // Blend the vertices' baked frames (sign-aligned normalized
+        // lerp) and fetch the triangle's constant normal derivatives
+        Quaternion q0 = mesh->bakedFrames[vi(0)];
+        Quaternion q1 = mesh->bakedFrames[vi(1)];
+        Quaternion q2 = mesh->bakedFrames[vi(2)];
+        if (Dot(q0, q1) < 0) q1 = q1 * -1.f;
+        if (Dot(q0, q2) < 0) q2 = q2 * -1.f;
+        Quaternion q = Normalize(b0 * q0 + b1 * q1 + b2 * q2);
+        Vector3f ss = RotateVector(q, Vector3f(1, 0, 0));
+        Vector3f ts = RotateVector(q, Vector3f(0, 1, 0));
+        int triIndex = firstIndex / 3;
+        isect->SetShadingGeometry(ss, ts, mesh->bakedDndu[triIndex],
+                                  mesh->bakedDndv[triIndex], true);
+        return;
+    }
+    Point2f uv[3];
+    GetUVs(uv);
+    // Initialize _Triangle_ shading geometry
+
+    // Compute shading normal _ns_ for triangle
+    Normal3f ns;
+    if (mesh->HasN()) {
+        ns = (b0 * mesh->N(vi(0)) + b1 * mesh->N(vi(1)) +
+              b2 * mesh->N(vi(2)));
+        if (ns.LengthSquared() > 0)
+            ns = Normalize(ns);
+        else
+            ns = isect->n;
+    } else
+        ns = isect->n;
+
+    // Compute shading tangent _ss_ for triangle
+    Vector3f ss;
+    if (mesh->s) {
+        ss = (b0 * mesh->s[vi(0)] + b1 * mesh->s[vi(1)] +
+              b2 * mesh->s[vi(2)]);
+        if (ss.LengthSquared() > 0)
+            ss = Normalize(ss);
         else
             ss = Normalize(isect->dpdu);
-
-        // Compute shading bitangent _ts_ for triangle and adjust _ss_
-        Vector3f ts = Cross(ss, ns);
-        if (ts.LengthSquared() > 0.f) {
-            ts = Normalize(ts);
-            ss = Cross(ts, ns);
-        } else
-            CoordinateSystem((Vector3f)ns, &ss, &ts);
-
-        // Compute $\dndu$ and $\dndv$ for triangle shading geometry
-        Normal3f dndu, dndv;
-        if (mesh->n) {
-            // Compute deltas for triangle partial derivatives of normal
-            Vector2f duv02 = uv[0] - uv[2];
-            Vector2f duv12 = uv[1] - uv[2];
-            Normal3f dn1 = mesh->n[v[0]] - mesh->n[v[2]];
-            Normal3f dn2 = mesh->n[v[1]] - mesh->n[v[2]];
-            Float determinant = duv02[0] * duv12[1] - duv02[1] * duv12[0];
-            if (determinant == 0)
-                dndu = dndv = Normal3f(0, 0, 0);
-            else {
-                Float invDet = 1 / determinant;
-                dndu = (duv12[1] * dn1 - duv02[1] * dn2) * invDet;
-                dndv = (-duv12[0] * dn1 + duv02[0] * dn2) * invDet;
-            }
-        } else
+    } else
+        ss = Normalize(isect->dpdu);
+
+    // Compute shading bitangent _ts_ for triangle and adjust _ss_
+    Vector3f ts = Cross(ss, ns);
+    if (ts.LengthSquared() > 0.f) {
+        ts = Normalize(ts);
+        ss = Cross(ts, ns);
+    } else
+        CoordinateSystem((Vector3f)ns, &ss, &ts);
+
+    // Compute $\dndu$ and $\dndv$ for triangle shading geometry
+    Normal3f dndu, dndv;
+    if (mesh->HasN()) {
+        // Compute deltas for triangle partial derivatives of normal
+        Vector2f duv02 = uv[0] - uv[2];
+        Vector2f duv12 = uv[1] - uv[2];
+        Normal3f dn1 = mesh->N(vi(0)) - mesh->N(vi(2));
+        Normal3f dn2 = mesh->N(vi(1)) - mesh->N(vi(2));
+        Float determinant = duv02[0] * duv12[1] - duv02[1] * duv12[0];
+        if (determinant == 0)
             dndu = dndv = Normal3f(0, 0, 0);
-        isect->SetShadingGeometry(ss, ts, dndu, dndv, true);
-    }
+        else {
+            Float invDet = 1 / determinant;
+            dndu = (duv12[1] * dn1 - duv02[1] * dn2) * invDet;
+            dndv = (-duv12[0] * dn1 + duv02[0] * dn2) * invDet;
+        }
+    } else
+        dndu = dndv = Normal3f(0, 0, 0);
+    isect->SetShadingGeometry(ss, ts, dndu, dndv, true);
 
     // Ensure correct orientation of the geometric normal
-    if (mesh->n)
-        isect->n = Faceforward(isect->n, isect->shading.n);
-    else if (reverseOrientation ^ transformSwapsHandedness)
-        isect->n = isect->shading.n = -isect->n;
-    *tHit = t;
-    ++nHits;
-    return true;
+    if (mesh->HasN()) isect->n = Faceforward(isect->n, isect->shading.n);
 }
 
 bool Triangle::IntersectP(const Ray &ray, bool testAlphaTexture) const {
     ProfilePhase p(Prof::TriIntersectP);
     ++nTests;
     // Get triangle vertices in _p0_, _p1_, and _p2_
-    const Point3f &p0 = mesh->p[v[0]];
-    const Point3f &p1 = mesh->p[v[1]];
-    const Point3f &p2 = mesh->p[v[2]];
+    const Point3f &p0 = mesh->p[vi(0)];
+    const Point3f &p1 = mesh->p[vi(1)];
+    const Point3f &p2 = mesh->p[vi(2)];
 
     // Perform ray--triangle intersection test
 
@@ -406,21 +574,18 @@ bool Triangle::IntersectP(const Ray &ray, bool testAlphaTexture) const {
     Point3f p1t = p1 - Vector3f(ray.o);
     Point3f p2t = p2 - Vector3f(ray.o);
 
-    // Permute components of triangle vertices and ray direction
-    int kz = MaxDimension(Abs(ray.d));
-    int kx = kz + 1;
-    if (kx == 3) kx = 0;
-    int ky = kx + 1;
-    if (ky == 3) ky = 0;
-    Vector3f d = Permute(ray.d, kx, ky, kz);
+    // Permute components of triangle vertices using the cached
+    // ray-dependent constants
+    UpdateRayShearCache(ray);
+    int kx = rayShear.kx, ky = rayShear.ky, kz = rayShear.kz;
     p0t = Permute(p0t, kx, ky, kz);
     p1t = Permute(p1t, kx, ky, kz);
     p2t = Permute(p2t, kx, ky, kz);
 
     // Apply shear transformation to translated vertex positions
-    Float Sx = -d.x / d.z;
-    Float Sy = -d.y / d.z;
-    Float Sz = 1.f / d.z;
+    Float Sx = rayShear.Sx;
+    Float Sy = rayShear.Sy;
+    Float Sz = rayShear.Sz;
     p0t.x += Sx * p0t.z;
     p0t.y += Sy * p0t.z;
     p1t.x += Sx * p1t.z;
@@ -531,24 +696,185 @@ bool Triangle::IntersectP(const Ray &ray, bool testAlphaTexture) const {
 
 Float Triangle::Area() const {
     // Get triangle vertices in _p0_, _p1_, and _p2_
-    const Point3f &p0 = mesh->p[v[0]];
-    const Point3f &p1 = mesh->p[v[1]];
-    const Point3f &p2 = mesh->p[v[2]];
+    const Point3f &p0 = mesh->p[vi(0)];
+    const Point3f &p1 = mesh->p[vi(1)];
+    const Point3f &p2 = mesh->p[vi(2)];
     return 0.5 * Cross(p1 - p0, p2 - p0).Length();
 }
 
+bool Triangle::OrientationCone(Vector3f *axis, Float *cosThetaMax) const {
+    // Mirror the normal orientation that Sample() reports for emission
+    if (mesh->HasN()) {
+        // Bound the interpolated shading normals by the cone of the
+        // vertex normals
+        Vector3f n[3];
+        for (int i = 0; i < 3; ++i) {
+            Normal3f ni = mesh->N(vi(i));
+            if (ni.LengthSquared() == 0) return false;
+            n[i] = Normalize(Vector3f(ni));
+        }
+        Vector3f a = n[0] + n[1] + n[2];
+        if (a.LengthSquared() == 0) return false;
+        a = Normalize(a);
+        Float cosTheta = 1;
+        for (int i = 0; i < 3; ++i)
+            cosTheta = std::min(cosTheta, Dot(a, n[i]));
+        // Past a hemisphere the cone can't cull anything
+        if (cosTheta <= 0) return false;
+        *axis = reverseOrientation ? -a : a;
+        *cosThetaMax = cosTheta;
+        return true;
+    }
+    const Point3f &p0 = mesh->p[vi(0)], &p1 = mesh->p[vi(1)],
+                  &p2 = mesh->p[vi(2)];
+    Vector3f n = Cross(p1 - p0, p2 - p0);
+    if (n.LengthSquared() == 0) return false;
+    n = Normalize(n);
+    *axis = reverseOrientation ? -n : n;
+    *cosThetaMax = 1;
+    return true;
+}
+
+// Spherical excess subtended by the triangle from _p_ (the solid
+// angle of its projection onto the unit sphere about _p_)
+Float Triangle::SolidAngle(const Point3f &p) const {
+    Vector3f a = Normalize(mesh->p[vi(0)] - p);
+    Vector3f b = Normalize(mesh->p[vi(1)] - p);
+    Vector3f c = Normalize(mesh->p[vi(2)] - p);
+    Vector3f nAB = Cross(a, b), nBC = Cross(b, c), nCA = Cross(c, a);
+    if (nAB.LengthSquared() == 0 || nBC.LengthSquared() == 0 ||
+        nCA.LengthSquared() == 0)
+        return 0;
+    nAB = Normalize(nAB);
+    nBC = Normalize(nBC);
+    nCA = Normalize(nCA);
+    Float alpha = std::acos(Clamp(Dot(nAB, -nCA), -1, 1));
+    Float beta = std::acos(Clamp(Dot(nBC, -nAB), -1, 1));
+    Float gamma = std::acos(Clamp(Dot(nCA, -nBC), -1, 1));
+    return std::max((Float)0, alpha + beta + gamma - Pi);
+}
+
+// Below this subtended solid angle, uniform area sampling is both
+// accurate enough and numerically safer than the spherical walk
+static PBRT_CONSTEXPR Float MinSphericalSampleArea = 3e-4f;
+
+Interaction Triangle::Sample(const Interaction &ref, const Point2f &u) const {
+    // Sample the triangle uniformly in solid angle (Arvo, "Stratified
+    // Sampling of Spherical Triangles"); close emitters otherwise
+    // concentrate area samples where the geometric term explodes
+    Float sphericalArea = SolidAngle(ref.p);
+    if (sphericalArea < MinSphericalSampleArea) return Shape::Sample(ref, u);
+
+    const Point3f &p0 = mesh->p[vi(0)], &p1 = mesh->p[vi(1)],
+                  &p2 = mesh->p[vi(2)];
+    Vector3f a = Normalize(p0 - ref.p), b = Normalize(p1 - ref.p),
+             c = Normalize(p2 - ref.p);
+    Vector3f nAB = Normalize(Cross(a, b)), nBC = Normalize(Cross(b, c)),
+             nCA = Normalize(Cross(c, a));
+    Float angleA = std::acos(Clamp(Dot(nAB, -nCA), -1, 1));
+
+    // Pick a sub-triangle with area proportional to u[0]
+    Float aPartial = u[0] * sphericalArea;
+    Float s = std::sin(aPartial - angleA), t = std::cos(aPartial - angleA);
+    Float cosAlpha = std::cos(angleA), sinAlpha = std::sin(angleA);
+    Float uu = t - cosAlpha;
+    Float vv = s + sinAlpha * Dot(a, b);
+    Float q = ((vv * t - uu * s) * cosAlpha - vv) /
+              ((vv * s + uu * t) * sinAlpha);
+    q = Clamp(q, -1, 1);
+
+    // Construct the sub-triangle's third vertex and sample along the
+    // arc toward it
+    Vector3f cPerp = c - Dot(c, a) * a;
+    if (cPerp.LengthSquared() == 0) return Shape::Sample(ref, u);
+    Vector3f cHat =
+        q * a + std::sqrt(std::max((Float)0, 1 - q * q)) * Normalize(cPerp);
+    Float z = 1 - u[1] * (1 - Dot(cHat, b));
+    Vector3f wPerp = cHat - Dot(cHat, b) * b;
+    if (wPerp.LengthSquared() == 0) return Shape::Sample(ref, u);
+    Vector3f w =
+        z * b + std::sqrt(std::max((Float)0, 1 - z * z)) * Normalize(wPerp);
+
+    // Intersect the sampled direction with the triangle's plane and
+    // recover barycentrics for the normal and error bounds
+    Vector3f e1 = p1 - p0, e2 = p2 - p0;
+    Vector3f nPlane = Cross(e1, e2);
+    Float denom = Dot(w, nPlane);
+    if (denom == 0) return Shape::Sample(ref, u);
+    Float tHit = Dot(p0 - ref.p, nPlane) / denom;
+    if (tHit <= 0) return Shape::Sample(ref, u);
+    Point3f pHit = ref.p + tHit * w;
+    Vector3f d = pHit - p0;
+    Float d11 = Dot(e1, e1), d12 = Dot(e1, e2), d22 = Dot(e2, e2);
+    Float dd1 = Dot(d, e1), dd2 = Dot(d, e2);
+    Float det = d11 * d22 - d12 * d12;
+    Float b1 = det != 0 ? (d22 * dd1 - d12 * dd2) / det : 0;
+    Float b2 = det != 0 ? (d11 * dd2 - d12 * dd1) / det : 0;
+    b1 = Clamp(b1, 0, 1);
+    b2 = Clamp(b2, 0, 1 - b1);
+    Float b0 = 1 - b1 - b2;
+
+    Interaction it;
+    it.p = pHit;
+    if (mesh->HasN())
+        it.n = Normalize(b0 * mesh->N(vi(0)) + b1 * mesh->N(vi(1)) +
+                         b2 * mesh->N(vi(2)));
+    else
+        it.n = Normalize(Normal3f(nPlane));
+    if (reverseOrientation) it.n *= -1;
+    Point3f pAbsSum = Abs(b0 * p0) + Abs(b1 * p1) + Abs(b2 * p2);
+    it.pError = gamma(6) * Vector3f(pAbsSum.x, pAbsSum.y, pAbsSum.z);
+    return it;
+}
+
+Float Triangle::Pdf(const Interaction &ref, const Vector3f &wi) const {
+    // Zero-allocation fast path for the solid-angle pdf used by area
+    // light MIS: a bare ray-triangle test replaces the base class's
+    // full Intersect with its SurfaceInteraction construction
+    const Point3f &p0 = mesh->p[vi(0)];
+    const Point3f &p1 = mesh->p[vi(1)];
+    const Point3f &p2 = mesh->p[vi(2)];
+    Vector3f e1 = p1 - p0, e2 = p2 - p0;
+    Vector3f pv = Cross(wi, e2);
+    Float det = Dot(e1, pv);
+    if (std::abs(det) < 1e-12f) return 0;
+    Float invDet = 1 / det;
+    Vector3f tv = ref.p - p0;
+    Float b1 = Dot(tv, pv) * invDet;
+    if (b1 < 0 || b1 > 1) return 0;
+    Vector3f qv = Cross(tv, e1);
+    Float b2 = Dot(wi, qv) * invDet;
+    if (b2 < 0 || b1 + b2 > 1) return 0;
+    Float t = Dot(e2, qv) * invDet;
+    if (t <= 0) return 0;
+
+    // Match Sample(ref, u): uniform over the subtended solid angle
+    // when it is large enough for the spherical walk
+    Float sphericalArea = SolidAngle(ref.p);
+    if (sphericalArea >= MinSphericalSampleArea) return 1 / sphericalArea;
+
+    // Convert light sample weight to solid angle measure
+    Vector3f n = Cross(e1, e2);
+    Float area = 0.5f * n.Length();
+    Float cosTheta = AbsDot(Normalize(n), wi);
+    if (cosTheta == 0 || area == 0) return 0;
+    Float pdf = t * t / (cosTheta * area);
+    if (std::isinf(pdf)) pdf = 0.f;
+    return pdf;
+}
+
 Interaction Triangle::Sample(const Point2f &u) const {
     Point2f b = UniformSampleTriangle(u);
     // Get triangle vertices in _p0_, _p1_, and _p2_
-    const Point3f &p0 = mesh->p[v[0]];
-    const Point3f &p1 = mesh->p[v[1]];
-    const Point3f &p2 = mesh->p[v[2]];
+    const Point3f &p0 = mesh->p[vi(0)];
+    const Point3f &p1 = mesh->p[vi(1)];
+    const Point3f &p2 = mesh->p[vi(2)];
     Interaction it;
     it.p = b[0] * p0 + b[1] * p1 + (1 - b[0] - b[1]) * p2;
     // Compute surface normal for sampled point on triangle
-    if (mesh->n)
-        it.n = Normalize(b[0] * mesh->n[v[0]] + b[1] * mesh->n[v[1]] +
-                         (1 - b[0] - b[1]) * mesh->n[v[2]]);
+    if (mesh->HasN())
+        it.n = Normalize(b[0] * mesh->N(vi(0)) + b[1] * mesh->N(vi(1)) +
+                         (1 - b[0] - b[1]) * mesh->N(vi(2)));
     else
         it.n = Normalize(Normal3f(Cross(p1 - p0, p2 - p0)));
     if (reverseOrientation) it.n *= -1;
@@ -670,6 +996,32 @@ std::vector<std::shared_ptr<Shape>> CreateTriangleMeshShape(
     } else if (params.FindOneFloat("shadowalpha", 1.f) == 0.f)
         shadowAlphaTex.reset(new ConstantTexture<Float>(0.f));
 
+    bool compact = params.FindOneBool("compact", false);
+    bool bakeFrames = params.FindOneBool("bakeframes", false);
+
+    // With a displacement map, build the mesh and wrap each base
+    // triangle in a DisplacedTriangle that dices on demand
+    std::string displaceTexName = params.FindTexture("displacementmap");
+    if (displaceTexName != "" && floatTextures) {
+        auto iter = floatTextures->find(displaceTexName);
+        if (iter == floatTextures->end())
+            Error(
+                "Couldn't find float texture \"%s\" for "
+                "\"displacementmap\" parameter",
+                displaceTexName.c_str());
+        else {
+            Float displaceScale = params.FindOneFloat("displacementscale", 1);
+            int diceRate = params.FindOneInt("dicerate", 8);
+            std::shared_ptr<TriangleMesh> mesh =
+                std::make_shared<TriangleMesh>(*o2w, nvi / 3, vi, npi, P, S,
+                                               N, uvs, alphaTex,
+                                               shadowAlphaTex, nullptr,
+                                               compact);
+            return CreateDisplacedMesh(o2w, w2o, reverseOrientation, mesh,
+                                       iter->second, displaceScale, diceRate);
+        }
+    }
     return CreateTriangleMesh(o2w, w2o, reverseOrientation, nvi / 3, vi, npi, P,
-                              S, N, uvs, alphaTex, shadowAlphaTex);
+                              S, N, uvs, alphaTex, shadowAlphaTex, nullptr,
+                              compact, bakeFrames);
 }
@@ -40,10 +40,36 @@
 
 // shapes/triangle.h*
 #include "shape.h"
+#include "quaternion.h"
 #include "stats.h"
 #include <map>
 STAT_MEMORY_COUNTER("Memory/Triangle meshes", triMeshBytes);
 
+// Octahedral encoding of unit normals into two signed 16-bit values,
+// used by the compact triangle mesh representation
+inline void OctEncodeNormal(const Normal3f &n, int16_t *oct) {
+    Float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    Float u = l1 == 0 ? 0 : n.x / l1, v = l1 == 0 ? 0 : n.y / l1;
+    if (n.z < 0) {
+        Float uo = u;
+        u = (1 - std::abs(v)) * (uo >= 0 ? 1 : -1);
+        v = (1 - std::abs(uo)) * (v >= 0 ? 1 : -1);
+    }
+    oct[0] = (int16_t)Clamp((int)std::floor(u * 32767.f + 0.5f), -32767, 32767);
+    oct[1] = (int16_t)Clamp((int)std::floor(v * 32767.f + 0.5f), -32767, 32767);
+}
+
+inline Normal3f OctDecodeNormal(const int16_t *oct) {
+    Float u = oct[0] * (1.f / 32767.f), v = oct[1] * (1.f / 32767.f);
+    Float z = 1 - std::abs(u) - std::abs(v);
+    if (z < 0) {
+        Float uo = u;
+        u = (1 - std::abs(v)) * (uo >= 0 ? 1 : -1);
+        v = (1 - std::abs(uo)) * (v >= 0 ? 1 : -1);
+    }
+    return Normalize(Normal3f(u, v, z));
+}
+
 // Triangle Declarations
 struct TriangleMesh {
     // TriangleMesh Public Methods
@@ -51,15 +77,49 @@ struct TriangleMesh {
                  const int *vertexIndices, int nVertices, const Point3f *P,
                  const Vector3f *S, const Normal3f *N, const Point2f *uv,
                  const std::shared_ptr<Texture<Float>> &alphaMask,
-                 const std::shared_ptr<Texture<Float>> &shadowAlphaMask);
+                 const std::shared_ptr<Texture<Float>> &shadowAlphaMask,
+                 const int *faceIndices = nullptr, bool compact = false,
+                 bool bakeFrames = false);
+
+    // TriangleMesh Public Methods
+    // Attribute accessors that decode whichever representation is
+    // present; the compact form stores octahedral 16-bit normals,
+    // half-precision uvs, and (for small meshes) 16-bit indices
+    bool HasN() const { return n || octNormals; }
+    bool HasUV() const { return uv || halfUVs; }
+    Normal3f N(int i) const {
+        if (n) return n[i];
+        return OctDecodeNormal(&octNormals[2 * i]);
+    }
+    Point2f UV(int i) const {
+        if (uv) return uv[i];
+        return Point2f(HalfToFloat(halfUVs[2 * i]),
+                       HalfToFloat(halfUVs[2 * i + 1]));
+    }
+    int VertexIndex(int i) const {
+        return vertexIndices16.empty() ? vertexIndices[i]
+                                       : vertexIndices16[i];
+    }
 
     // TriangleMesh Data
     const int nTriangles, nVertices;
     std::vector<int> vertexIndices;
+    // Optional per-triangle base-face indices for per-face texturing
+    std::vector<int> faceIndices;
     std::unique_ptr<Point3f[]> p;
     std::unique_ptr<Normal3f[]> n;
     std::unique_ptr<Vector3f[]> s;
     std::unique_ptr<Point2f[]> uv;
+    // Compact attribute storage (see the "compact" mesh parameter)
+    std::unique_ptr<int16_t[]> octNormals;
+    std::unique_ptr<uint16_t[]> halfUVs;
+    std::vector<uint16_t> vertexIndices16;
+    // Baked shading geometry ("bakeframes"): per-vertex orthonormal
+    // frames as quaternions plus per-triangle normal derivatives, so
+    // deferred shading setup is a fetch+blend instead of the
+    // per-hit orthogonalization and 2x2 solve
+    std::unique_ptr<Quaternion[]> bakedFrames;
+    std::unique_ptr<Normal3f[]> bakedDndu, bakedDndv;
     std::shared_ptr<Texture<Float>> alphaMask, shadowAlphaMask;
 };
 
@@ -69,8 +129,11 @@ class Triangle : public Shape {
     Triangle(const Transform *ObjectToWorld, const Transform *WorldToObject,
              bool reverseOrientation, const std::shared_ptr<TriangleMesh> &mesh,
              int triNumber)
-        : Shape(ObjectToWorld, WorldToObject, reverseOrientation), mesh(mesh) {
-        v = &mesh->vertexIndices[3 * triNumber];
+        : Shape(ObjectToWorld, WorldToObject, reverseOrientation),
+          mesh(mesh),
+          firstIndex(3 * triNumber),
+          faceIndex(mesh->faceIndices.size() ? mesh->faceIndices[triNumber]
+                                             : triNumber) {
         triMeshBytes += sizeof(*this);
     }
     Bounds3f ObjectBound() const;
@@ -80,24 +143,31 @@ class Triangle : public Shape {
     bool IntersectP(const Ray &ray, bool testAlphaTexture) const;
     Float Area() const;
     Interaction Sample(const Point2f &u) const;
+    Interaction Sample(const Interaction &ref, const Point2f &u) const;
+    Float Pdf(const Interaction &ref, const Vector3f &wi) const;
+    Float SolidAngle(const Point3f &p) const;
+    bool OrientationCone(Vector3f *axis, Float *cosThetaMax) const;
+    void ComputeDeferredShading(SurfaceInteraction *isect) const;
 
   private:
     // Triangle Private Methods
     void GetUVs(Point2f uv[3]) const {
-        if (mesh->uv) {
-            uv[0] = mesh->uv[v[0]];
-            uv[1] = mesh->uv[v[1]];
-            uv[2] = mesh->uv[v[2]];
+        if (mesh->HasUV()) {
+            uv[0] = mesh->UV(vi(0));
+            uv[1] = mesh->UV(vi(1));
+            uv[2] = mesh->UV(vi(2));
         } else {
             uv[0] = Point2f(0, 0);
             uv[1] = Point2f(1, 0);
             uv[2] = Point2f(1, 1);
         }
     }
+    int vi(int i) const { return mesh->VertexIndex(firstIndex + i); }
 
     // Triangle Private Data
     std::shared_ptr<TriangleMesh> mesh;
-    const int *v;
+    const int firstIndex;
+    const int faceIndex;
 };
 
 std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(
@@ -105,7 +175,9 @@ std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(
     int nTriangles, const int *vertexIndices, int nVertices, const Point3f *p,
     const Vector3f *s, const Normal3f *n, const Point2f *uv,
     const std::shared_ptr<Texture<Float>> &alphaTexture,
-    const std::shared_ptr<Texture<Float>> &shadowAlphaTexture);
+    const std::shared_ptr<Texture<Float>> &shadowAlphaTexture,
+    const int *faceIndices = nullptr, bool compact = false,
+    bool bakeFrames = false);
 std::vector<std::shared_ptr<Shape>> CreateTriangleMeshShape(
     const Transform *o2w, const Transform *w2o, bool reverseOrientation,
     const ParamSet &params,
@@ -0,0 +1,78 @@
+
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+#include "lowdiscrepancy.h"
+#include "rng.h"
+#include <algorithm>
+#include <vector>
+
+// Straightforward per-digit references for the radical inverse, which
+// the shipping implementation computes with precomputed magic-number
+// division.
+
+static Float ReferenceRadicalInverse(int base, uint64_t a) {
+    const Float invBase = (Float)1 / (Float)base;
+    uint64_t reversedDigits = 0;
+    Float invBaseN = 1;
+    while (a) {
+        uint64_t next = a / base;
+        uint64_t digit = a - next * base;
+        reversedDigits = reversedDigits * base + digit;
+        invBaseN *= invBase;
+        a = next;
+    }
+    return std::min(reversedDigits * invBaseN, OneMinusEpsilon);
+}
+
+static Float ReferenceScrambledRadicalInverse(int base, uint64_t a,
+                                              const uint16_t *perm) {
+    const Float invBase = (Float)1 / (Float)base;
+    uint64_t reversedDigits = 0;
+    Float invBaseN = 1;
+    while (a) {
+        uint64_t next = a / base;
+        uint64_t digit = a - next * base;
+        reversedDigits = reversedDigits * base + perm[digit];
+        invBaseN *= invBase;
+        a = next;
+    }
+    return std::min(
+        invBaseN * (reversedDigits + invBase * perm[0] / (1 - invBase)),
+        OneMinusEpsilon);
+}
+
+TEST(RadicalInverse, MatchesReference) {
+    RNG rng;
+    for (int baseIndex = 0; baseIndex < PrimeTableSize; baseIndex += 7) {
+        int base = Primes[baseIndex];
+        // Small indices exhaustively, larger ones sampled
+        for (uint64_t a = 0; a < 1024; ++a)
+            EXPECT_EQ(ReferenceRadicalInverse(base, a),
+                      RadicalInverse(baseIndex, a));
+        for (int i = 0; i < 64; ++i) {
+            uint64_t a = ((uint64_t)rng.UniformUInt32() << 20) |
+                         rng.UniformUInt32();
+            EXPECT_EQ(ReferenceRadicalInverse(base, a),
+                      RadicalInverse(baseIndex, a));
+        }
+    }
+}
+
+TEST(RadicalInverse, ScrambledMatchesReference) {
+    RNG rng;
+    for (int baseIndex = 0; baseIndex < PrimeTableSize; baseIndex += 13) {
+        int base = Primes[baseIndex];
+        std::vector<uint16_t> perm(base);
+        for (int i = 0; i < base; ++i) perm[i] = i;
+        rng.Shuffle(perm.begin(), perm.end());
+        for (uint64_t a = 0; a < 512; ++a)
+            EXPECT_EQ(ReferenceScrambledRadicalInverse(base, a, &perm[0]),
+                      ScrambledRadicalInverse(baseIndex, a, &perm[0]));
+        for (int i = 0; i < 64; ++i) {
+            uint64_t a = ((uint64_t)rng.UniformUInt32() << 20) |
+                         rng.UniformUInt32();
+            EXPECT_EQ(ReferenceScrambledRadicalInverse(base, a, &perm[0]),
+                      ScrambledRadicalInverse(baseIndex, a, &perm[0]));
+        }
+    }
+}
@@ -356,3 +356,52 @@ TEST(Paraboloid, Reintersect) {
     }
 }
 #endif
+
+TEST(Triangle, SolidAngleSampling) {
+    // Solid-angle sampling consistency for an emitter-sized triangle
+    // close to the receiver: sampled directions hit the triangle, the
+    // reported pdf is the reciprocal subtended solid angle, and that
+    // solid angle agrees with a Monte Carlo estimate.
+    Transform identity;
+    int indices[3] = {0, 1, 2};
+    Point3f p[3] = {Point3f(-1, -1, 2), Point3f(1.5f, -.8f, 2.2f),
+                    Point3f(-.3f, 1.2f, 1.9f)};
+    std::vector<std::shared_ptr<Shape>> tris =
+        CreateTriangleMesh(&identity, &identity, false, 1, indices, 3, p,
+                           nullptr, nullptr, nullptr, nullptr, nullptr);
+    ASSERT_EQ(1u, tris.size());
+    const Triangle *tri = static_cast<const Triangle *>(tris[0].get());
+
+    Interaction ref;
+    ref.p = Point3f(0, 0, 0);
+    ref.n = Normal3f(0, 0, 1);
+    ref.time = 0;
+    Float solidAngle = tri->SolidAngle(ref.p);
+    ASSERT_GT(solidAngle, 0);
+
+    // Monte Carlo estimate of the subtended solid angle
+    RNG rng;
+    int hits = 0;
+    const int nDirections = 1000000;
+    for (int i = 0; i < nDirections; ++i) {
+        Vector3f d = UniformSampleSphere(
+            Point2f(rng.UniformFloat(), rng.UniformFloat()));
+        if (tris[0]->IntersectP(Ray(ref.p, d))) ++hits;
+    }
+    Float mcSolidAngle = 4 * Pi * (Float)hits / nDirections;
+    EXPECT_NEAR(solidAngle, mcSolidAngle, .02 * solidAngle);
+
+    // Every spherical sample must land on the triangle with pdf
+    // 1 / solid angle
+    const int sqrtN = 32;
+    for (int i = 0; i < sqrtN; ++i)
+        for (int j = 0; j < sqrtN; ++j) {
+            Point2f u((i + rng.UniformFloat()) / sqrtN,
+                      (j + rng.UniformFloat()) / sqrtN);
+            Interaction sampled = tris[0]->Sample(ref, u);
+            Vector3f wi = Normalize(sampled.p - ref.p);
+            EXPECT_TRUE(tris[0]->IntersectP(Ray(ref.p, wi)));
+            Float pdf = tris[0]->Pdf(ref, wi);
+            EXPECT_NEAR(1 / solidAngle, pdf, 1e-3f / solidAngle);
+        }
+}
@@ -50,6 +50,7 @@ class ConstantTexture : public Texture<T> {
     // ConstantTexture Public Methods
     ConstantTexture(const T &value) : value(value) {}
     T Evaluate(const SurfaceInteraction &) const { return value; }
+    bool NeedsDifferentials() const { return false; }
 
   private:
     T value;
@@ -34,26 +34,178 @@
 // textures/imagemap.cpp*
 #include "textures/imagemap.h"
 #include "imageio.h"
+#include "texcache.h"
+
+// Bound how many textures are being decoded and mip-built at once to
+// the core count; constructors block for a slot before launching their
+// background build, which gives natural backpressure during parsing.
+static int texturePrepSlots = -1;
+static std::mutex texturePrepMutex;
+static std::condition_variable texturePrepCondition;
+
+static void AcquireTexturePrepSlot() {
+    std::unique_lock<std::mutex> lock(texturePrepMutex);
+    if (texturePrepSlots < 0) texturePrepSlots = NumSystemCores();
+    texturePrepCondition.wait(lock, []() { return texturePrepSlots > 0; });
+    --texturePrepSlots;
+}
+
+static void ReleaseTexturePrepSlot() {
+    std::lock_guard<std::mutex> lock(texturePrepMutex);
+    ++texturePrepSlots;
+    texturePrepCondition.notify_one();
+}
 
 // ImageTexture Method Definitions
 template <typename Tmemory, typename Treturn>
 ImageTexture<Tmemory, Treturn>::ImageTexture(
     std::unique_ptr<TextureMapping2D> mapping, const std::string &filename,
     bool doTrilinear, Float maxAniso, ImageWrap wrapMode, Float scale,
-    bool gamma)
+    bool gamma, MIPMapStorage storage)
     : mapping(std::move(mapping)) {
-    mipmap =
-        GetTexture(filename, doTrilinear, maxAniso, wrapMode, scale, gamma);
+    if (filename.find("<FACE>") != std::string::npos) {
+        // Defer per-face loading: each base face's map is instantiated
+        // by GetFaceTile() on first shading access, so residency
+        // follows the faces rays actually see instead of an atlas
+        perFace = true;
+        udimFilename = filename;
+        udimTrilinear = doTrilinear;
+        udimMaxAniso = maxAniso;
+        udimWrap = wrapMode;
+        udimScale = scale;
+        udimGamma = gamma;
+        udimStorage = storage;
+        mipmap = nullptr;
+        return;
+    }
+    if (filename.find("<UDIM>") != std::string::npos) {
+        // Defer per-tile loading: tiles of a UDIM set are instantiated
+        // by GetUDIMTile() on first access, so only the tiles rays
+        // actually shade are ever read
+        udimFilename = filename;
+        udimTrilinear = doTrilinear;
+        udimMaxAniso = maxAniso;
+        udimWrap = wrapMode;
+        udimScale = scale;
+        udimGamma = gamma;
+        udimStorage = storage;
+        udimTiles.reset(
+            new std::atomic<MIPMap<Tmemory> *>[10 * udimRows]);
+        for (int i = 0; i < 10 * udimRows; ++i) udimTiles[i] = nullptr;
+        mipmap = nullptr;
+        return;
+    }
+    // Decode the image and build its MIP pyramid in the background so
+    // that preparation of many textures overlaps during scene parsing;
+    // the first lookup waits for completion in WaitForMipmap()
+    mipmap = nullptr;
+    AcquireTexturePrepSlot();
+    pendingMipmap = std::async(std::launch::async, [=]() {
+        MIPMap<Tmemory> *m = GetTexture(filename, doTrilinear, maxAniso,
+                                        wrapMode, scale, gamma, storage);
+        ReleaseTexturePrepSlot();
+        return m;
+    });
+}
+
+template <typename Tmemory, typename Treturn>
+MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::GetFaceTile(int face) const {
+    {
+        std::lock_guard<std::mutex> lock(udimMutex);
+        auto iter = faceTiles.find(face);
+        if (iter != faceTiles.end()) return iter->second;
+    }
+
+    // Substitute the face number for the <FACE> token and load the map
+    char faceNumber[16];
+    sprintf(faceNumber, "%d", face);
+    std::string faceFilename = udimFilename;
+    faceFilename.replace(faceFilename.find("<FACE>"), 6, faceNumber);
+    MIPMap<Tmemory> *m =
+        GetTexture(faceFilename, udimTrilinear, udimMaxAniso, udimWrap,
+                   udimScale, udimGamma, udimStorage);
+    std::lock_guard<std::mutex> lock(udimMutex);
+    faceTiles[face] = m;
+    return m;
+}
+
+template <typename Tmemory, typename Treturn>
+MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::WaitForMipmap() const {
+    std::lock_guard<std::mutex> lock(mipmapWaitMutex);
+    MIPMap<Tmemory> *m = mipmap.load(std::memory_order_relaxed);
+    if (!m) {
+        m = pendingMipmap.get();
+        mipmap.store(m, std::memory_order_release);
+    }
+    return m;
+}
+
+template <typename Tmemory, typename Treturn>
+MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::GetUDIMTile(int tu,
+                                                             int tv) const {
+    int tileIndex = tv * 10 + tu;
+    MIPMap<Tmemory> *m = udimTiles[tileIndex].load(std::memory_order_acquire);
+    if (m) return m;
+    std::lock_guard<std::mutex> lock(udimMutex);
+    m = udimTiles[tileIndex].load(std::memory_order_relaxed);
+    if (m) return m;
+
+    // Substitute the tile number for the <UDIM> token and load the tile
+    char tileNumber[8];
+    sprintf(tileNumber, "%d", 1001 + tileIndex);
+    std::string tileFilename = udimFilename;
+    tileFilename.replace(tileFilename.find("<UDIM>"), 6, tileNumber);
+    m = GetTexture(tileFilename, udimTrilinear, udimMaxAniso, udimWrap,
+                   udimScale, udimGamma, udimStorage);
+    udimTiles[tileIndex].store(m, std::memory_order_release);
+    return m;
 }
 
 template <typename Tmemory, typename Treturn>
 MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::GetTexture(
     const std::string &filename, bool doTrilinear, Float maxAniso,
-    ImageWrap wrap, Float scale, bool gamma) {
-    // Return _MIPMap_ from texture cache if present
-    TexInfo texInfo(filename, doTrilinear, maxAniso, wrap, scale, gamma);
-    if (textures.find(texInfo) != textures.end())
-        return textures[texInfo].get();
+    ImageWrap wrap, Float scale, bool gamma, MIPMapStorage storage) {
+    // The shared texture map is accessed from background build tasks
+    // and lazy UDIM tile loads, so guard it -- but only the map, not
+    // the build itself, or concurrent texture preparation would
+    // serialize behind one decode at a time.
+    static std::mutex textureMutex;
+    TexInfo texInfo(filename, doTrilinear, maxAniso, wrap, scale, gamma,
+                    storage);
+    {
+        std::lock_guard<std::mutex> lock(textureMutex);
+        auto iter = textures.find(texInfo);
+        if (iter != textures.end()) return iter->second.get();
+    }
+
+    // Stream the texture through the tiled texture cache if a budget
+    // was set and a converted cache file is available
+    TiledTextureCache *tileCache = TiledTextureCache::GetInstance();
+    std::string cacheFilename;
+    if (tileCache) {
+        // The cache file bakes in the conversion parameters, so its
+        // name must distinguish them
+        int nChannels = sizeof(Tmemory) / sizeof(Float);
+        char suffix[64];
+        sprintf(suffix, "_%dc_%g_%d.txc", nChannels, scale, (int)gamma);
+        cacheFilename = filename + suffix;
+        Point2i cachedRes;
+        std::vector<Point2i> levelRes;
+        int texId = tileCache->OpenTexture(cacheFilename, nChannels,
+                                           &cachedRes, &levelRes);
+        if (texId >= 0) {
+            MIPMap<Tmemory> *cached = new MIPMap<Tmemory>(
+                tileCache, texId, cachedRes, std::move(levelRes), doTrilinear,
+                maxAniso, wrap);
+            std::lock_guard<std::mutex> lock(textureMutex);
+            std::unique_ptr<MIPMap<Tmemory>> &entry = textures[texInfo];
+            if (!entry)
+                entry.reset(cached);
+            else
+                delete cached;
+            return entry.get();
+        }
+    }
 
     // Create _MIPMap_ for _filename_
     Point2i resolution;
@@ -65,15 +217,46 @@ MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::GetTexture(
             new Tmemory[resolution.x * resolution.y]);
         for (int i = 0; i < resolution.x * resolution.y; ++i)
             convertIn(texels[i], &convertedTexels[i], scale, gamma);
+        // Key the shared pyramid segment (--sharedmem) on everything
+        // that shapes the decoded texels
+        uint64_t shareKey = 0;
+        if (SharedSceneEnabled()) {
+            shareKey = 14695981039346656037ull;
+            auto mix = [&shareKey](const void *data, size_t size) {
+                const unsigned char *bytes = (const unsigned char *)data;
+                for (size_t i = 0; i < size; ++i) {
+                    shareKey ^= bytes[i];
+                    shareKey *= 1099511628211ull;
+                }
+            };
+            mix(filename.data(), filename.size());
+            mix(&scale, sizeof(scale));
+            mix(&gamma, sizeof(gamma));
+            mix(&wrap, sizeof(wrap));
+            size_t texelSize = sizeof(Tmemory);
+            mix(&texelSize, sizeof(texelSize));
+        }
         mipmap = new MIPMap<Tmemory>(resolution, convertedTexels.get(),
-                                     doTrilinear, maxAniso, wrap);
+                                     doTrilinear, maxAniso, wrap, storage,
+                                     shareKey);
+
+        // One-time conversion: write the tiled cache file so that
+        // subsequent renders stream this texture on demand
+        if (tileCache) mipmap->WriteCacheFile(cacheFilename);
     } else {
         // Create one-valued _MIPMap_
         Tmemory oneVal = scale;
         mipmap = new MIPMap<Tmemory>(Point2i(1, 1), &oneVal);
     }
-    textures[texInfo].reset(mipmap);
-    return mipmap;
+    std::lock_guard<std::mutex> lock(textureMutex);
+    std::unique_ptr<MIPMap<Tmemory>> &entry = textures[texInfo];
+    if (!entry)
+        entry.reset(mipmap);
+    else
+        // Another task built the same texture concurrently; keep the
+        // first one
+        delete mipmap;
+    return entry.get();
 }
 
 template <typename Tmemory, typename Treturn>
@@ -117,11 +300,19 @@ ImageTexture<Float, Float> *CreateImageFloatTexture(const Transform &tex2world,
     std::string filename = tp.FindFilename("filename");
     bool gamma = tp.FindBool("gamma", HasExtension(filename, ".tga") ||
                                           HasExtension(filename, ".png"));
+    std::string storage = tp.FindString("storage", "float");
+    MIPMapStorage storageMode = MIPMapStorage::Full;
+    if (storage == "half")
+        storageMode = MIPMapStorage::Half;
+    else if (storage != "float")
+        Warning("Texture storage \"%s\" unknown; using \"float\".",
+                storage.c_str());
     return new ImageTexture<Float, Float>(std::move(map), filename, trilerp,
-                                          maxAniso, wrapMode, scale, gamma);
+                                          maxAniso, wrapMode, scale, gamma,
+                                          storageMode);
 }
 
-ImageTexture<RGBSpectrum, Spectrum> *CreateImageSpectrumTexture(
+Texture<Spectrum> *CreateImageSpectrumTexture(
     const Transform &tex2world, const TextureParams &tp) {
     // Initialize 2D texture mapping _map_ from _tp_
     std::unique_ptr<TextureMapping2D> map;
@@ -159,6 +350,28 @@ ImageTexture<RGBSpectrum, Spectrum> *CreateImageSpectrumTexture(
     std::string filename = tp.FindFilename("filename");
     bool gamma = tp.FindBool("gamma", HasExtension(filename, ".tga") ||
                                           HasExtension(filename, ".png"));
-    return new ImageTexture<RGBSpectrum, Spectrum>(
-        std::move(map), filename, trilerp, maxAniso, wrapMode, scale, gamma);
+    std::string storage = tp.FindString("storage", "float");
+    MIPMapStorage storageMode = MIPMapStorage::Full;
+    if (storage == "half")
+        storageMode = MIPMapStorage::Half;
+    else if (storage != "float")
+        Warning("Texture storage \"%s\" unknown; using \"float\".",
+                storage.c_str());
+#ifdef PBRT_SAMPLED_SPECTRUM
+    // Spectral-native storage: store SampledSpectrum texels so the
+    // per-lookup RGB uplift disappears; costs nSpectralSamples/3x the
+    // pyramid memory, so it can be disabled per texture, and the
+    // half-precision mode stays with the RGB representation
+    if (tp.FindBool("spectralstorage", true)) {
+        if (storageMode == MIPMapStorage::Half)
+            Warning("\"storage\" \"half\" is not supported with spectral "
+                    "texture storage; using full precision.");
+        return new ImageTexture<SampledSpectrum, Spectrum>(
+            std::move(map), filename, trilerp, maxAniso, wrapMode, scale,
+            gamma, MIPMapStorage::Full);
+    }
+#endif  // PBRT_SAMPLED_SPECTRUM
+    return new ImageTexture<RGBSpectrum, Spectrum>(std::move(map), filename,
+                                                   trilerp, maxAniso, wrapMode,
+                                                   scale, gamma, storageMode);
 }
@@ -41,32 +41,39 @@
 // textures/imagemap.h*
 #include "pbrt.h"
 #include "texture.h"
+#include "interaction.h"
 #include "mipmap.h"
 #include "paramset.h"
 #include <map>
+#include <atomic>
+#include <mutex>
+#include <future>
 
 // TexInfo Declarations
 struct TexInfo {
     TexInfo(const std::string &f, bool dt, Float ma, ImageWrap wm, Float sc,
-            bool gamma)
+            bool gamma, MIPMapStorage storage)
         : filename(f),
           doTrilinear(dt),
           maxAniso(ma),
           wrapMode(wm),
           scale(sc),
-          gamma(gamma) {}
+          gamma(gamma),
+          storage(storage) {}
     std::string filename;
     bool doTrilinear;
     Float maxAniso;
     ImageWrap wrapMode;
     Float scale;
     bool gamma;
+    MIPMapStorage storage;
     bool operator<(const TexInfo &t2) const {
         if (filename != t2.filename) return filename < t2.filename;
         if (doTrilinear != t2.doTrilinear) return doTrilinear < t2.doTrilinear;
         if (maxAniso != t2.maxAniso) return maxAniso < t2.maxAniso;
         if (scale != t2.scale) return scale < t2.scale;
         if (gamma != t2.gamma) return !gamma;
+        if (storage != t2.storage) return storage < t2.storage;
         return wrapMode < t2.wrapMode;
     }
 };
@@ -78,24 +85,93 @@ class ImageTexture : public Texture<Treturn> {
     // ImageTexture Public Methods
     ImageTexture(std::unique_ptr<TextureMapping2D> m,
                  const std::string &filename, bool doTri, Float maxAniso,
-                 ImageWrap wm, Float scale, bool gamma);
+                 ImageWrap wm, Float scale, bool gamma,
+                 MIPMapStorage storage = MIPMapStorage::Full);
     static void ClearCache() {
         textures.erase(textures.begin(), textures.end());
     }
     Treturn Evaluate(const SurfaceInteraction &si) const {
         Vector2f dstdx, dstdy;
         Point2f st = mapping->Map(si, &dstdx, &dstdy);
-        Tmemory mem = mipmap->Lookup(st, dstdx, dstdy);
+        const MIPMap<Tmemory> *m = mipmap.load(std::memory_order_acquire);
+        if (!m && !udimTiles && !perFace) m = WaitForMipmap();
+        if (perFace)
+            // Per-face texturing: resolve the face's own map and look
+            // it up with the face-local uv parameterization
+            m = GetFaceTile(si.faceIndex);
+        if (udimTiles) {
+            // Resolve the UDIM tile from the integer parts of (u, v)
+            // and look up with tile-local coordinates; each tile spans
+            // one uv unit, so the differentials carry over unchanged
+            int tu = Clamp((int)std::floor(st.x), 0, 9);
+            int tv = Clamp((int)std::floor(st.y), 0, udimRows - 1);
+            m = GetUDIMTile(tu, tv);
+            st.x -= tu;
+            st.y -= tv;
+        }
+        Tmemory mem = m->Lookup(st, dstdx, dstdy);
         Treturn ret;
         convertOut(mem, &ret);
         return ret;
     }
+    void EvaluateBatch(const SurfaceInteraction *const *si, int n,
+                       Treturn *out) const {
+        // Map every interaction first, then perform the lookups ordered
+        // by UDIM tile, approximate MIP level, and scanline position,
+        // so texel fetches stream through one region of the pyramid at
+        // a time instead of making isolated cache-cold excursions.
+        struct BatchEntry {
+            uint64_t key;
+            int index;
+            const MIPMap<Tmemory> *m;
+            Point2f st;
+            Vector2f dstdx, dstdy;
+        };
+        std::vector<BatchEntry> entries(n);
+        const MIPMap<Tmemory> *base = mipmap.load(std::memory_order_acquire);
+        if (!base && !udimTiles) base = WaitForMipmap();
+        for (int i = 0; i < n; ++i) {
+            BatchEntry &e = entries[i];
+            e.index = i;
+            e.st = mapping->Map(*si[i], &e.dstdx, &e.dstdy);
+            uint64_t tile = 0;
+            if (perFace) {
+                e.m = GetFaceTile(si[i]->faceIndex);
+                tile = si[i]->faceIndex + 1;
+            } else if (udimTiles) {
+                int tu = Clamp((int)std::floor(e.st.x), 0, 9);
+                int tv = Clamp((int)std::floor(e.st.y), 0, udimRows - 1);
+                e.m = GetUDIMTile(tu, tv);
+                e.st.x -= tu;
+                e.st.y -= tv;
+                tile = tv * 10 + tu + 1;
+            } else
+                e.m = base;
+            Float width = std::max(
+                std::max(std::abs(e.dstdx[0]), std::abs(e.dstdx[1])),
+                std::max(std::abs(e.dstdy[0]), std::abs(e.dstdy[1])));
+            uint64_t lodKey = (uint64_t)Clamp(
+                (int)(32 + 4 * Log2(std::max(width, (Float)1e-8))), 0, 255);
+            uint64_t qv = (uint64_t)Clamp((int)(e.st.y * 1024), 0, 1023);
+            uint64_t qu = (uint64_t)Clamp((int)(e.st.x * 1024), 0, 1023);
+            e.key = (tile << 48) | (lodKey << 40) | (qv << 20) | qu;
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const BatchEntry &a, const BatchEntry &b) {
+                      return a.key < b.key;
+                  });
+        for (const BatchEntry &e : entries) {
+            Tmemory mem = e.m->Lookup(e.st, e.dstdx, e.dstdy);
+            convertOut(mem, &out[e.index]);
+        }
+    }
 
   private:
     // ImageTexture Private Methods
     static MIPMap<Tmemory> *GetTexture(const std::string &filename,
                                        bool doTrilinear, Float maxAniso,
-                                       ImageWrap wm, Float scale, bool gamma);
+                                       ImageWrap wm, Float scale, bool gamma,
+                                       MIPMapStorage storage);
     static void convertIn(const RGBSpectrum &from, RGBSpectrum *to, Float scale,
                           bool gamma) {
         for (int i = 0; i < RGBSpectrum::nSamples; ++i)
@@ -111,16 +187,56 @@ class ImageTexture : public Texture<Treturn> {
         *to = Spectrum::FromRGB(rgb);
     }
     static void convertOut(Float from, Float *to) { *to = from; }
+    // Spectral-native storage (spectral builds, "spectralstorage"):
+    // the uplift from RGB runs once per texel here at load, and
+    // lookups below filter and return the coefficients directly
+    static void convertIn(const RGBSpectrum &from, SampledSpectrum *to,
+                          Float scale, bool gamma) {
+        Float rgb[3];
+        for (int i = 0; i < 3; ++i)
+            rgb[i] =
+                scale * (gamma ? InverseGammaCorrect(from[i]) : from[i]);
+        *to = SampledSpectrum::FromRGB(rgb);
+    }
+    static void convertOut(const SampledSpectrum &from, SampledSpectrum *to) {
+        *to = from;
+    }
+
+    MIPMap<Tmemory> *GetUDIMTile(int tu, int tv) const;
+    MIPMap<Tmemory> *GetFaceTile(int face) const;
+    MIPMap<Tmemory> *WaitForMipmap() const;
 
     // ImageTexture Private Data
     std::unique_ptr<TextureMapping2D> mapping;
-    MIPMap<Tmemory> *mipmap;
+    // The MIP pyramid is decoded and built by a background task
+    // launched from the constructor so preparation of many textures
+    // overlaps during scene parsing; _mipmap_ holds null until the
+    // first lookup waits on _pendingMipmap_
+    mutable std::atomic<MIPMap<Tmemory> *> mipmap;
+    mutable std::future<MIPMap<Tmemory> *> pendingMipmap;
+    mutable std::mutex mipmapWaitMutex;
+    // UDIM state: when the filename carries a <UDIM> token, per-tile
+    // MIPMaps are instantiated on first access instead of eagerly
+    static PBRT_CONSTEXPR int udimRows = 10;
+    std::string udimFilename;
+    bool udimTrilinear;
+    Float udimMaxAniso;
+    ImageWrap udimWrap;
+    Float udimScale;
+    bool udimGamma;
+    MIPMapStorage udimStorage;
+    mutable std::unique_ptr<std::atomic<MIPMap<Tmemory> *>[]> udimTiles;
+    // Per-face state: when the filename carries a <FACE> token, each
+    // base face's map is loaded lazily on first shading access
+    bool perFace = false;
+    mutable std::map<int, MIPMap<Tmemory> *> faceTiles;
+    mutable std::mutex udimMutex;
     static std::map<TexInfo, std::unique_ptr<MIPMap<Tmemory>>> textures;
 };
 
 ImageTexture<Float, Float> *CreateImageFloatTexture(const Transform &tex2world,
                                                     const TextureParams &tp);
-ImageTexture<RGBSpectrum, Spectrum> *CreateImageSpectrumTexture(
+Texture<Spectrum> *CreateImageSpectrumTexture(
     const Transform &tex2world, const TextureParams &tp);
 
 #endif  // PBRT_TEXTURES_IMAGEMAP_H
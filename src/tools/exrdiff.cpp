@@ -2,43 +2,42 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 #include "pbrt.h"
+#include "parallel.h"
 #include "spectrum.h"
 #include "imageio.h"
+#ifndef PBRT_IS_WINDOWS
+#include <dirent.h>
+#endif
 
 static bool ReadEXR(const char *name, Float **rgba, int *xRes, int *yRes);
 static void WriteEXR(const char *name, Float *pixels, int xRes, int yRes);
 
 static void usage() {
     fprintf(stderr,
-            "usage: exrdiff [-o difffile.exr] [-d diff tolerance %%] <foo.exr> "
-            "<bar.exr>\n");
+            "usage: exrdiff [-o difffile.exr] [-d diff tolerance %%] [-p] "
+            "<foo.exr> <bar.exr>\n"
+            "       exrdiff [-d diff tolerance %%] [-p] -batch <dir1> <dir2>\n"
+            "Supported options:\n"
+            "\t-p\tperceptual mode: flag per-tile mean differences only when\n"
+            "\t\tthey exceed the tile's sampler-noise estimate\n"
+            "\t-batch\tcompare every .exr present in both directories\n");
     exit(1);
 }
 
-int main(int argc, char *argv[]) {
-    const char *outfile = NULL;
-    const char *imageFile1 = NULL, *imageFile2 = NULL;
-    float tol = 0.f;
-
-    if (argc == 1) usage();
-    for (int i = 1; i < argc; ++i) {
-        if (!strcmp(argv[i], "-o")) {
-            if (!argv[i + 1]) usage();
-            outfile = argv[i + 1];
-            ++i;
-        } else if (!strcmp(argv[i], "-d")) {
-            if (!argv[i + 1]) usage();
-            tol = atof(argv[i + 1]);
-            ++i;
-        } else if (!imageFile1)
-            imageFile1 = argv[i];
-        else if (!imageFile2)
-            imageFile2 = argv[i];
-        else
-            usage();
-    }
+// Per-scanline partial sums, reduced after the parallel loop so the
+// workers never contend on shared accumulators
+struct RowStats {
+    double sum1 = 0, sum2 = 0, mse = 0;
+    int smallDiff = 0, bigDiff = 0;
+};
 
+static int CompareImages(const char *imageFile1, const char *imageFile2,
+                         const char *outfile, float tol, bool perceptual) {
     Float *im1, *im2;
     int r1[2], r2[2];
     if (!ReadEXR(imageFile1, &im1, &r1[0], &r1[1])) {
@@ -47,52 +46,197 @@ int main(int argc, char *argv[]) {
     }
     if (!ReadEXR(imageFile2, &im2, &r2[0], &r2[1])) {
         printf("couldn't read image %s\n", imageFile2);
+        delete[] im1;
         return 1;
     }
     if (r1[0] != r2[0] || r1[1] != r2[1]) {
         printf("%s/%s:\n\tresolutions don't match! (%d,%d) vs (%d,%d)\n",
                imageFile1, imageFile2, r1[0], r1[1], r2[0], r2[1]);
+        delete[] im1;
+        delete[] im2;
         return 1;
     }
+    int xRes = r1[0], yRes = r1[1];
 
     Float *diffRGB = NULL;
-    if (outfile != NULL) diffRGB = new Float[3 * r1[0] * r1[1]];
+    if (outfile != NULL) diffRGB = new Float[3 * xRes * yRes];
 
-    double sum1 = 0.f, sum2 = 0.f;
+    std::vector<RowStats> rowStats(yRes);
+    ParallelFor([&](int64_t y) {
+        RowStats &stats = rowStats[y];
+        for (int i = 3 * y * xRes; i < 3 * (y + 1) * xRes; ++i) {
+            if (diffRGB) diffRGB[i] = std::abs(im1[i] - im2[i]);
+            if (im1[i] == 0 && im2[i] == 0) continue;
+
+            stats.sum1 += im1[i];
+            stats.sum2 += im2[i];
+            float d = std::abs(im1[i] - im2[i]) / im1[i];
+            stats.mse += (im1[i] - im2[i]) * (im1[i] - im2[i]);
+            if (d > .005) ++stats.smallDiff;
+            if (d > .05) ++stats.bigDiff;
+        }
+    }, yRes, 16);
+    double sum1 = 0, sum2 = 0, mse = 0;
     int smallDiff = 0, bigDiff = 0;
-    double mse = 0.f;
-    for (int i = 0; i < 3 * r1[0] * r1[1]; ++i) {
-        if (diffRGB) diffRGB[i] = std::abs(im1[i] - im2[i]);
-        if (im1[i] == 0 && im2[i] == 0) continue;
-
-        sum1 += im1[i];
-        sum2 += im2[i];
-        float d = std::abs(im1[i] - im2[i]) / im1[i];
-        mse += (im1[i] - im2[i]) * (im1[i] - im2[i]);
-        if (d > .005) ++smallDiff;
-        if (d > .05) ++bigDiff;
+    for (const RowStats &stats : rowStats) {
+        sum1 += stats.sum1;
+        sum2 += stats.sum2;
+        mse += stats.mse;
+        smallDiff += stats.smallDiff;
+        bigDiff += stats.bigDiff;
+    }
+
+    // Perceptual mode: compare per-tile means against the standard
+    // error implied by the per-pixel difference variance inside the
+    // tile, so uncorrelated sampler noise (which cancels in the mean)
+    // passes while a systematic shift (which doesn't) is flagged
+    int badTiles = 0, nTiles = 0;
+    if (perceptual) {
+        const int tileSize = 16;
+        int nxTiles = (xRes + tileSize - 1) / tileSize;
+        int nyTiles = (yRes + tileSize - 1) / tileSize;
+        nTiles = nxTiles * nyTiles;
+        std::vector<int> tileBad(nTiles, 0);
+        ParallelFor([&](int64_t tile) {
+            int tx = tile % nxTiles, ty = tile / nxTiles;
+            int x0 = tx * tileSize, x1 = std::min(x0 + tileSize, xRes);
+            int y0 = ty * tileSize, y1 = std::min(y0 + tileSize, yRes);
+            double diffSum = 0, diffSumSq = 0, valueSum = 0;
+            int n = 0;
+            for (int y = y0; y < y1; ++y)
+                for (int x = x0; x < x1; ++x)
+                    for (int c = 0; c < 3; ++c) {
+                        int i = 3 * (y * xRes + x) + c;
+                        double d = im1[i] - im2[i];
+                        diffSum += d;
+                        diffSumSq += d * d;
+                        valueSum += im1[i] + im2[i];
+                        ++n;
+                    }
+            if (n < 2) return;
+            double meanDiff = diffSum / n;
+            double variance =
+                std::max(0., (diffSumSq - diffSum * diffSum / n) / (n - 1));
+            double standardError = std::sqrt(variance / n);
+            double meanValue = valueSum / (2 * n);
+            // Systematic if the tile's mean shift exceeds three
+            // standard errors of the noise and 0.1% of its radiance
+            if (std::abs(meanDiff) > 3 * standardError &&
+                std::abs(meanDiff) > 1e-3 * std::max(meanValue, 1e-6))
+                tileBad[tile] = 1;
+        }, nTiles, 16);
+        for (int bad : tileBad) badTiles += bad;
     }
-    double avg1 = sum1 / (3. * r1[0] * r1[1]);
-    double avg2 = sum2 / (3. * r1[0] * r1[1]);
+
+    double avg1 = sum1 / (3. * xRes * yRes);
+    double avg2 = sum2 / (3. * xRes * yRes);
     double avgDelta = (avg1 - avg2) / std::min(avg1, avg2);
-    if ((tol == 0. && (bigDiff > 0 || smallDiff > 0)) ||
-        (tol > 0. && 100.f * std::abs(avgDelta) > tol)) {
+    bool failed;
+    if (perceptual)
+        failed = badTiles > 0 &&
+                 (tol == 0. || 100. * badTiles / nTiles > tol);
+    else
+        failed = (tol == 0. && (bigDiff > 0 || smallDiff > 0)) ||
+                 (tol > 0. && 100.f * std::abs(avgDelta) > tol);
+    if (failed) {
         printf(
             "%s %s\n\tImages differ: %d big (%.2f%%), %d small (%.2f%%)\n"
             "\tavg 1 = %g, avg2 = %g (%f%% delta)\n"
             "\tMSE = %g, RMS = %.3f%%\n",
             imageFile1, imageFile2, bigDiff,
-            100.f * float(bigDiff) / (3 * r1[0] * r1[1]), smallDiff,
-            100.f * float(smallDiff) / (3 * r1[0] * r1[1]), avg1, avg2,
-            100. * avgDelta, mse / (3. * r1[0] * r1[1]),
-            100. * sqrt(mse / (3. * r1[0] * r1[1])));
-        if (outfile) WriteEXR(outfile, diffRGB, r1[0], r1[1]);
+            100.f * float(bigDiff) / (3 * xRes * yRes), smallDiff,
+            100.f * float(smallDiff) / (3 * xRes * yRes), avg1, avg2,
+            100. * avgDelta, mse / (3. * xRes * yRes),
+            100. * sqrt(mse / (3. * xRes * yRes)));
+        if (perceptual)
+            printf("\t%d / %d tiles differ beyond their noise estimate\n",
+                   badTiles, nTiles);
+        if (outfile) WriteEXR(outfile, diffRGB, xRes, yRes);
+        delete[] im1;
+        delete[] im2;
+        delete[] diffRGB;
         return 1;
     }
 
+    delete[] im1;
+    delete[] im2;
+    delete[] diffRGB;
     return 0;
 }
 
+static int CompareDirectories(const char *dir1, const char *dir2, float tol,
+                              bool perceptual) {
+#ifdef PBRT_IS_WINDOWS
+    fprintf(stderr, "exrdiff: -batch is not supported on Windows\n");
+    return 1;
+#else
+    DIR *dir = opendir(dir1);
+    if (!dir) {
+        fprintf(stderr, "exrdiff: couldn't open directory %s\n", dir1);
+        return 1;
+    }
+    std::vector<std::string> names;
+    while (struct dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".exr") == 0)
+            names.push_back(name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    int nFailed = 0;
+    for (const std::string &name : names) {
+        std::string f1 = std::string(dir1) + "/" + name;
+        std::string f2 = std::string(dir2) + "/" + name;
+        FILE *f = fopen(f2.c_str(), "rb");
+        if (!f) {
+            printf("%s: missing from %s\n", name.c_str(), dir2);
+            ++nFailed;
+            continue;
+        }
+        fclose(f);
+        if (CompareImages(f1.c_str(), f2.c_str(), NULL, tol, perceptual))
+            ++nFailed;
+    }
+    printf("%d / %d image pairs differ\n", nFailed, (int)names.size());
+    return nFailed > 0 ? 1 : 0;
+#endif  // PBRT_IS_WINDOWS
+}
+
+int main(int argc, char *argv[]) {
+    const char *outfile = NULL;
+    const char *imageFile1 = NULL, *imageFile2 = NULL;
+    float tol = 0.f;
+    bool perceptual = false, batch = false;
+
+    if (argc == 1) usage();
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-o")) {
+            if (!argv[i + 1]) usage();
+            outfile = argv[i + 1];
+            ++i;
+        } else if (!strcmp(argv[i], "-d")) {
+            if (!argv[i + 1]) usage();
+            tol = atof(argv[i + 1]);
+            ++i;
+        } else if (!strcmp(argv[i], "-p"))
+            perceptual = true;
+        else if (!strcmp(argv[i], "-batch"))
+            batch = true;
+        else if (!imageFile1)
+            imageFile1 = argv[i];
+        else if (!imageFile2)
+            imageFile2 = argv[i];
+        else
+            usage();
+    }
+    if (!imageFile1 || !imageFile2) usage();
+
+    if (batch)
+        return CompareDirectories(imageFile1, imageFile2, tol, perceptual);
+    return CompareImages(imageFile1, imageFile2, outfile, tol, perceptual);
+}
+
 static bool ReadEXR(const char *name, Float **rgb, int *width, int *height) {
     Point2i res;
     std::unique_ptr<RGBSpectrum[]> image = ReadImage(name, &res);
@@ -16,6 +16,7 @@ static void usage() {
     fprintf(stderr, "Supported options:\n");
     fprintf(stderr, "\t-scale scale\n");
     fprintf(stderr, "\t-repeatpix [count]\n");
+    fprintf(stderr, "\t-dither\n");
     exit(1);
 }
 
@@ -34,6 +35,9 @@ int main(int argc, char *argv[]) {
     }
         if (false) {
         }
+        else if (!strcmp(argv[argNum], "-dither")) {
+            PbrtOptions.ditherOutput = true;
+        }
         ARG("repeatpix", rp)
         ARG("scale", scale)
         else usage();
@@ -0,0 +1,102 @@
+//
+// maketiledtex.cpp
+//
+// Convert an image to pbrt's tiled, mip-complete .txc texture cache
+// format offline, so that renders started with --texcachemb stream
+// (or memory-map) the texture directly instead of re-decoding the
+// source image and rebuilding its MIP pyramid at startup.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pbrt.h"
+#include "spectrum.h"
+#include "imageio.h"
+#include "mipmap.h"
+#include "texcache.h"
+#include "parallel.h"
+
+static void usage() {
+    fprintf(stderr, "usage: maketiledtex [options] <input image>\n");
+    fprintf(stderr, "Supported options:\n");
+    fprintf(stderr, "\t-scale scale    scale texel values (default 1)\n");
+    fprintf(stderr,
+            "\t-gamma 0|1      apply inverse sRGB gamma (default: 1 for "
+            "png/tga inputs)\n");
+    fprintf(stderr,
+            "\t-float          write a single-channel (Float) texture\n");
+    fprintf(stderr,
+            "The output file is named so that pbrt's ImageTexture finds it "
+            "for the same scale and gamma parameters.\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    float scale = 1.f;
+    int gamma = -1;
+    bool asFloat = false;
+
+    int argNum = 1;
+    while (argNum < argc && argv[argNum][0] == '-') {
+        if (!strcmp(argv[argNum], "-scale")) {
+            if (argNum + 1 == argc) usage();
+            scale = atof(argv[++argNum]);
+        } else if (!strcmp(argv[argNum], "-gamma")) {
+            if (argNum + 1 == argc) usage();
+            gamma = atoi(argv[++argNum]);
+        } else if (!strcmp(argv[argNum], "-float"))
+            asFloat = true;
+        else
+            usage();
+        ++argNum;
+    }
+    if (argNum + 1 > argc) usage();
+    std::string inFile = argv[argNum];
+    if (gamma < 0)
+        gamma = HasExtension(inFile, "png") || HasExtension(inFile, "tga");
+
+    Point2i res;
+    std::unique_ptr<RGBSpectrum[]> image = ReadImage(inFile, &res);
+    if (!image) {
+        fprintf(stderr, "maketiledtex: unable to read \"%s\"\n",
+                inFile.c_str());
+        return 1;
+    }
+
+    // Bake the same scale/gamma conversion ImageTexture applies and
+    // name the output the way its cache-file lookup expects
+    int nChannels = asFloat ? 1 : 3;
+    char suffix[64];
+    sprintf(suffix, "_%dc_%g_%d.txc", nChannels, scale, gamma);
+    std::string outFile = inFile + suffix;
+    bool ok;
+    if (asFloat) {
+        std::unique_ptr<Float[]> texels(new Float[res.x * res.y]);
+        for (int i = 0; i < res.x * res.y; ++i)
+            texels[i] =
+                scale * (gamma ? InverseGammaCorrect(image[i].y())
+                               : image[i].y());
+        MIPMap<Float> mipmap(res, texels.get());
+        ok = mipmap.WriteCacheFile(outFile);
+    } else {
+        for (int i = 0; i < res.x * res.y; ++i) {
+            Float rgb[3];
+            image[i].ToRGB(rgb);
+            for (int c = 0; c < 3; ++c)
+                rgb[c] = scale *
+                         (gamma ? InverseGammaCorrect(rgb[c]) : rgb[c]);
+            image[i] = RGBSpectrum::FromRGB(rgb);
+        }
+        MIPMap<RGBSpectrum> mipmap(res, image.get());
+        ok = mipmap.WriteCacheFile(outFile);
+    }
+    TerminateWorkerThreads();
+    if (!ok) {
+        fprintf(stderr, "maketiledtex: failed to write \"%s\"\n",
+                outFile.c_str());
+        return 1;
+    }
+    printf("maketiledtex: wrote %s\n", outFile.c_str());
+    return 0;
+}
@@ -24,6 +24,10 @@
 #include <vector>
 #include <map>
 
+#include "shapes/plymesh.h"
+#include "imageio.h"
+#include "spectrum.h"
+
 namespace tinyobj {
 
 typedef struct
@@ -902,10 +906,355 @@ LoadObj(
 
 using namespace tinyobj;
 
+
+
+// ---- Texture atlas baking (--atlas) ----
+//
+// Scanned-asset conversions reference thousands of small MTL maps; one
+// ImageTexture per map means one file open and decode each at load
+// time.  With --atlas, small maps whose meshes keep their UVs inside
+// [0,1] are shelf-packed into a few shared atlas images at conversion
+// time, and the emitted imagemap textures address their sub-rectangle
+// with uscale/vscale/udelta/vdelta, so the renderer opens a handful of
+// files instead of thousands.  Maps that tile (UVs outside [0,1]), are
+// large, or fail to load are emitted as before.
+
+struct AtlasPlacement {
+  std::string atlasFile;
+  float uscale, vscale, udelta, vdelta;
+};
+
+struct PendingMap {
+  std::string file;
+  int width, height;
+  std::vector<RGBSpectrum> texels;
+};
+
+static bool BakeTextureAtlases(
+    std::vector<shape_t> &shapes, const char *outName,
+    std::map<std::string, AtlasPlacement> *placements) {
+  const int atlasSize = 4096, maxMapSize = 1024, gutter = 4;
+
+  // Find the maps referenced by materials whose meshes keep their UVs
+  // inside [0,1] (tiling lookups can't come from an atlas)
+  std::map<std::string, bool> packable;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    const material_t &mtl = shapes[i].material;
+    const mesh_t &mesh = shapes[i].mesh;
+    bool uvsInUnit = true;
+    for (size_t t = 0; t < mesh.texcoords.size(); ++t)
+      if (mesh.texcoords[t] < -1e-4f || mesh.texcoords[t] > 1 + 1e-4f) {
+        uvsInUnit = false;
+        break;
+      }
+    const std::string *names[3] = {&mtl.diffuse_texname,
+                                   &mtl.specular_texname,
+                                   &mtl.normal_texname};
+    for (int k = 0; k < 3; ++k) {
+      if (names[k]->empty()) continue;
+      std::map<std::string, bool>::iterator iter = packable.find(*names[k]);
+      if (iter == packable.end())
+        packable[*names[k]] = uvsInUnit;
+      else
+        iter->second = iter->second && uvsInUnit;
+    }
+  }
+
+  // Load the packable maps, skipping large or unreadable ones
+  std::vector<PendingMap> maps;
+  for (std::map<std::string, bool>::iterator iter = packable.begin();
+       iter != packable.end(); ++iter) {
+    if (!iter->second) continue;
+    Point2i res;
+    std::unique_ptr<RGBSpectrum[]> texels = ReadImage(iter->first, &res);
+    if (!texels || res.x > maxMapSize || res.y > maxMapSize) continue;
+    PendingMap map;
+    map.file = iter->first;
+    map.width = res.x;
+    map.height = res.y;
+    map.texels.assign(texels.get(), texels.get() + res.x * res.y);
+    maps.push_back(map);
+  }
+  if (maps.size() < 2) return false;
+
+  // Shelf-pack, tallest first, with a duplicated-edge gutter so MIP
+  // filtering doesn't bleed between neighbors
+  std::sort(maps.begin(), maps.end(),
+            [](const PendingMap &a, const PendingMap &b) {
+              return a.height > b.height;
+            });
+  std::vector<std::vector<RGBSpectrum>> atlases;
+  int shelfX = 0, shelfY = 0, shelfHeight = 0, atlasIndex = -1;
+  for (size_t m = 0; m < maps.size(); ++m) {
+    const PendingMap &map = maps[m];
+    int paddedW = map.width + 2 * gutter, paddedH = map.height + 2 * gutter;
+    if (atlasIndex < 0 || shelfX + paddedW > atlasSize) {
+      shelfX = 0;
+      shelfY += shelfHeight;
+      shelfHeight = 0;
+    }
+    if (atlasIndex < 0 || shelfY + paddedH > atlasSize) {
+      atlases.push_back(std::vector<RGBSpectrum>(atlasSize * atlasSize));
+      ++atlasIndex;
+      shelfX = shelfY = shelfHeight = 0;
+    }
+    // Copy the texels, replicating edges into the gutter
+    std::vector<RGBSpectrum> &atlas = atlases[atlasIndex];
+    for (int y = -gutter; y < map.height + gutter; ++y) {
+      int srcY = std::min(std::max(y, 0), map.height - 1);
+      for (int x = -gutter; x < map.width + gutter; ++x) {
+        int srcX = std::min(std::max(x, 0), map.width - 1);
+        atlas[(shelfY + gutter + y) * atlasSize + shelfX + gutter + x] =
+            map.texels[srcY * map.width + srcX];
+      }
+    }
+    char atlasFile[1024];
+    snprintf(atlasFile, sizeof(atlasFile), "%s_atlas_%d.exr", outName,
+             atlasIndex);
+    AtlasPlacement placement;
+    placement.atlasFile = atlasFile;
+    placement.uscale = (float)map.width / atlasSize;
+    placement.vscale = (float)map.height / atlasSize;
+    placement.udelta = (float)(shelfX + gutter) / atlasSize;
+    placement.vdelta = (float)(shelfY + gutter) / atlasSize;
+    (*placements)[map.file] = placement;
+    shelfX += paddedW;
+    shelfHeight = std::max(shelfHeight, paddedH);
+  }
+
+  for (size_t i = 0; i < atlases.size(); ++i) {
+    char atlasFile[1024];
+    snprintf(atlasFile, sizeof(atlasFile), "%s_atlas_%d.exr", outName,
+             (int)i);
+    WriteImage(atlasFile, (Float *)&atlases[i][0],
+               Bounds2i(Point2i(0, 0), Point2i(atlasSize, atlasSize)),
+               Point2i(atlasSize, atlasSize));
+  }
+  fprintf(stderr, "Packed %d maps into %d atlases.\n", (int)maps.size(),
+          (int)atlases.size());
+  return true;
+}
+
+// Print the imagemap parameters for _file_, addressing its atlas
+// sub-rectangle when it was packed
+static void EmitImageMapParams(
+    FILE *f, const std::string &file,
+    const std::map<std::string, AtlasPlacement> &placements) {
+  std::map<std::string, AtlasPlacement>::const_iterator iter =
+      placements.find(file);
+  if (iter == placements.end()) {
+    fprintf(f, "\"string filename\" [\"%s\"]", file.c_str());
+    return;
+  }
+  const AtlasPlacement &p = iter->second;
+  fprintf(f,
+          "\"string filename\" [\"%s\"] \"float uscale\" [%.9g] "
+          "\"float vscale\" [%.9g] \"float udelta\" [%.9g] "
+          "\"float vdelta\" [%.9g]",
+          p.atlasFile.c_str(), p.uscale, p.vscale, p.udelta, p.vdelta);
+}
+
+// ---- Mesh optimization (--optimize) ----
+//
+// Two passes over each mesh before emission: weld duplicate vertices
+// (bit-exact, or within a --weld epsilon), then reorder triangles with
+// Forsyth's linear-time vertex-cache optimization ("Linear-Speed
+// Vertex Cache Optimisation", 2006) so consecutive triangles reuse
+// recently fetched vertices in the renderer's BVH leaf loops.
+
+static void WeldVertices(mesh_t *mesh, float eps) {
+  size_t nVerts = mesh->positions.size() / 3;
+  bool hasNormals = mesh->normals.size() == 3 * nVerts;
+  bool hasTexcoords = mesh->texcoords.size() == 2 * nVerts;
+
+  std::map<std::string, unsigned int> vertexIndex;
+  std::vector<unsigned int> remap(nVerts);
+  std::vector<float> positions, normals, texcoords;
+  for (size_t i = 0; i < nVerts; ++i) {
+    // Key on the (possibly epsilon-quantized) full attribute tuple
+    float key[8];
+    int nKey = 0;
+    for (int c = 0; c < 3; ++c) key[nKey++] = mesh->positions[3 * i + c];
+    if (hasNormals)
+      for (int c = 0; c < 3; ++c) key[nKey++] = mesh->normals[3 * i + c];
+    if (hasTexcoords)
+      for (int c = 0; c < 2; ++c) key[nKey++] = mesh->texcoords[2 * i + c];
+    if (eps > 0)
+      for (int k = 0; k < nKey; ++k)
+        key[k] = (float)floor(key[k] / eps + 0.5f);
+    std::string keyBytes((const char *)key, nKey * sizeof(float));
+
+    std::map<std::string, unsigned int>::iterator iter =
+        vertexIndex.find(keyBytes);
+    if (iter != vertexIndex.end()) {
+      remap[i] = iter->second;
+      continue;
+    }
+    unsigned int newIndex = positions.size() / 3;
+    vertexIndex[keyBytes] = remap[i] = newIndex;
+    for (int c = 0; c < 3; ++c)
+      positions.push_back(mesh->positions[3 * i + c]);
+    if (hasNormals)
+      for (int c = 0; c < 3; ++c)
+        normals.push_back(mesh->normals[3 * i + c]);
+    if (hasTexcoords)
+      for (int c = 0; c < 2; ++c)
+        texcoords.push_back(mesh->texcoords[2 * i + c]);
+  }
+  for (size_t i = 0; i < mesh->indices.size(); ++i)
+    mesh->indices[i] = remap[mesh->indices[i]];
+  mesh->positions.swap(positions);
+  mesh->normals.swap(normals);
+  mesh->texcoords.swap(texcoords);
+}
+
+// Forsyth scoring constants
+static const int kCacheSize = 32;
+static const float kLastTriScore = 0.75f;
+static const float kCacheDecayPower = 1.5f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+
+static float VertexScore(int cachePosition, int activeTriangles) {
+  if (activeTriangles == 0) return -1;
+  float score = 0;
+  if (cachePosition >= 0) {
+    if (cachePosition < 3)
+      score = kLastTriScore;
+    else
+      score = powf(1.0f - (cachePosition - 3) / (float)(kCacheSize - 3),
+                   kCacheDecayPower);
+  }
+  return score + kValenceBoostScale *
+                     powf((float)activeTriangles, -kValenceBoostPower);
+}
+
+static void ForsythReorder(std::vector<unsigned int> &indices,
+                           size_t nVerts) {
+  size_t nTris = indices.size() / 3;
+  if (nTris < 2) return;
+
+  // Per-vertex valence and triangle adjacency
+  std::vector<int> valence(nVerts, 0);
+  for (unsigned int index : indices) ++valence[index];
+  std::vector<int> adjacencyStart(nVerts + 1, 0);
+  for (size_t v = 0; v < nVerts; ++v)
+    adjacencyStart[v + 1] = adjacencyStart[v] + valence[v];
+  std::vector<int> adjacency(indices.size());
+  std::vector<int> adjacencyPos(adjacencyStart.begin(),
+                                adjacencyStart.end() - 1);
+  for (size_t t = 0; t < nTris; ++t)
+    for (int c = 0; c < 3; ++c)
+      adjacency[adjacencyPos[indices[3 * t + c]]++] = t;
+
+  std::vector<int> cachePosition(nVerts, -1);
+  std::vector<float> vertexScore(nVerts);
+  for (size_t v = 0; v < nVerts; ++v)
+    vertexScore[v] = VertexScore(-1, valence[v]);
+  std::vector<float> triangleScore(nTris, 0);
+  std::vector<char> emitted(nTris, 0);
+  for (size_t t = 0; t < nTris; ++t)
+    for (int c = 0; c < 3; ++c)
+      triangleScore[t] += vertexScore[indices[3 * t + c]];
+
+  std::vector<unsigned int> output;
+  output.reserve(indices.size());
+  std::vector<int> cache;  // most recently used first
+  int bestTriangle = 0;
+  for (size_t emittedCount = 0; emittedCount < nTris; ++emittedCount) {
+    if (bestTriangle < 0) {
+      // Fall back to a scan when no candidate touches the cache
+      float bestScore = -1e30f;
+      for (size_t t = 0; t < nTris; ++t)
+        if (!emitted[t] && triangleScore[t] > bestScore) {
+          bestScore = triangleScore[t];
+          bestTriangle = t;
+        }
+    }
+
+    // Emit _bestTriangle_ and update its vertices
+    emitted[bestTriangle] = 1;
+    for (int c = 0; c < 3; ++c) {
+      unsigned int v = indices[3 * bestTriangle + c];
+      output.push_back(v);
+      --valence[v];
+      // Move _v_ to the front of the cache
+      std::vector<int>::iterator where =
+          std::find(cache.begin(), cache.end(), (int)v);
+      if (where != cache.end()) cache.erase(where);
+      cache.insert(cache.begin(), v);
+    }
+    if ((int)cache.size() > kCacheSize) {
+      for (size_t i = kCacheSize; i < cache.size(); ++i)
+        cachePosition[cache[i]] = -1;
+      cache.resize(kCacheSize);
+    }
+
+    // Rescore the cached vertices and their unemitted triangles, and
+    // pick the next triangle among them
+    for (size_t i = 0; i < cache.size(); ++i)
+      cachePosition[cache[i]] = i;
+    bestTriangle = -1;
+    float bestScore = -1e30f;
+    for (size_t i = 0; i < cache.size(); ++i) {
+      int v = cache[i];
+      float oldScore = vertexScore[v];
+      vertexScore[v] = VertexScore(cachePosition[v], valence[v]);
+      float delta = vertexScore[v] - oldScore;
+      for (int a = adjacencyStart[v]; a < adjacencyStart[v + 1]; ++a) {
+        int t = adjacency[a];
+        if (emitted[t]) continue;
+        triangleScore[t] += delta;
+        if (triangleScore[t] > bestScore) {
+          bestScore = triangleScore[t];
+          bestTriangle = t;
+        }
+      }
+    }
+  }
+  indices.swap(output);
+}
+
+static void OptimizeMesh(mesh_t *mesh, float weldEps) {
+  size_t vertsBefore = mesh->positions.size() / 3;
+  WeldVertices(mesh, weldEps);
+  ForsythReorder(mesh->indices, mesh->positions.size() / 3);
+  fprintf(stderr, "Optimized mesh: %d -> %d vertices\n", (int)vertsBefore,
+          (int)(mesh->positions.size() / 3));
+}
+
 int main(int argc, char *argv[]) {
+  // With --bmesh, geometry is written to binary mesh sidecar files
+  // referenced from the emitted scene rather than inlined as text
+  bool bmesh = false, optimize = false, atlas = false;
+  float weldEps = 0;
+  while (argc > 3) {
+    if (strcmp(argv[1], "--bmesh") == 0)
+      bmesh = true;
+    else if (strcmp(argv[1], "--atlas") == 0)
+      atlas = true;
+    else if (strcmp(argv[1], "--optimize") == 0)
+      optimize = true;
+    else if (strcmp(argv[1], "--weld") == 0 && argc > 4) {
+      optimize = true;
+      weldEps = atof(argv[2]);
+      ++argv;
+      --argc;
+    } else
+      break;
+    ++argv;
+    --argc;
+  }
   if (argc != 3 || strcmp(argv[1], "--help") == 0 ||
       strcmp(argv[1], "-h") == 0) {
-    fprintf(stderr, "usage: obj2pbrt [OBJ filename] [pbrt output filename]\n");
+    fprintf(stderr,
+            "usage: obj2pbrt [--bmesh] [--optimize] [--weld epsilon] "
+            "[--atlas] [OBJ filename] [pbrt output filename]\n");
+    return 1;
+  }
+  if ((bmesh || atlas) && strcmp(argv[2], "-") == 0) {
+    fprintf(stderr,
+            "obj2pbrt: --bmesh and --atlas require an output filename\n");
     return 1;
   }
 
@@ -918,6 +1267,17 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
+  // Weld duplicate vertices and reorder triangles for vertex-cache
+  // locality; the emitted index buffers then reference the smaller,
+  // coherently ordered vertex arrays
+  if (optimize)
+    for (size_t i = 0; i < shapes.size(); ++i)
+      OptimizeMesh(&shapes[i].mesh, weldEps);
+
+  // Pack small, non-tiling material maps into shared atlas images
+  std::map<std::string, AtlasPlacement> atlasPlacements;
+  if (atlas) BakeTextureAtlases(shapes, argv[2], &atlasPlacements);
+
   FILE *f = (strcmp(argv[2], "-") == 0) ? stdout : fopen(argv[2], "w");
   if (!f) {
     perror(argv[2]);
@@ -965,43 +1325,48 @@ int main(int argc, char *argv[]) {
     bool hasDiffuseTex = (mtl.diffuse_texname != "");
     if (mtl.diffuse_texname != "") {
       if (mtl.diffuse[0] != 0 || mtl.diffuse[1] != 0 || mtl.diffuse[2] != 0) {
-          fprintf(f, "Texture \"%s-kd-img\" \"color\" \"imagemap\" "
-                  "\"string filename\" [\"%s\"]\n",
-                  mtl.name.c_str(), mtl.diffuse_texname.c_str());
+          fprintf(f, "Texture \"%s-kd-img\" \"color\" \"imagemap\" ",
+                  mtl.name.c_str());
+          EmitImageMapParams(f, mtl.diffuse_texname, atlasPlacements);
+          fprintf(f, "\n");
           fprintf(f, "Texture \"%s-kd\" \"color\" \"scale\" \"texture tex1\" "
                   "\"%s-kd-img\" \"color tex2\" [%f %f %f]\n",
                   mtl.name.c_str(), mtl.name.c_str(),
                   mtl.diffuse[0], mtl.diffuse[1], mtl.diffuse[2]);
       }
       else {
-          fprintf(f, "Texture \"%s-kd\" \"color\" \"imagemap\" "
-                  "\"string filename\" [\"%s\"]\n",
-                  mtl.name.c_str(), mtl.diffuse_texname.c_str());
+          fprintf(f, "Texture \"%s-kd\" \"color\" \"imagemap\" ",
+                  mtl.name.c_str());
+          EmitImageMapParams(f, mtl.diffuse_texname, atlasPlacements);
+          fprintf(f, "\n");
       }
     }
 
     bool hasSpecularTex = (mtl.specular_texname != "");
     if (mtl.specular_texname != "") {
       if (mtl.specular[0] != 0 || mtl.specular[1] != 0 || mtl.specular[2] != 0) {
-        fprintf(f, "Texture \"%s-ks-img\" \"color\" \"imagemap\" "
-                "\"string filename\" [\"%s\"]\n",
-                mtl.name.c_str(), mtl.specular_texname.c_str());
+        fprintf(f, "Texture \"%s-ks-img\" \"color\" \"imagemap\" ",
+                mtl.name.c_str());
+        EmitImageMapParams(f, mtl.specular_texname, atlasPlacements);
+        fprintf(f, "\n");
         fprintf(f, "Texture \"%s-ks\" \"color\" \"scale\" \"texture tex1\" "
                 "\"%s-ks-img\" \"color tex2\" [%f %f %f]\n",
                 mtl.name.c_str(), mtl.name.c_str(),
                 mtl.specular[0], mtl.specular[1], mtl.specular[2]);
       }
       else {
-        fprintf(f, "Texture \"%s-ks\" \"color\" \"imagemap\" "
-                "\"string filename\" [\"%s\"]\n",
-                mtl.name.c_str(), mtl.specular_texname.c_str());
+        fprintf(f, "Texture \"%s-ks\" \"color\" \"imagemap\" ",
+                mtl.name.c_str());
+        EmitImageMapParams(f, mtl.specular_texname, atlasPlacements);
+        fprintf(f, "\n");
       }
     }
 
     if (mtl.normal_texname != "") {
-      fprintf(f, "Texture \"%s-bump-map\" \"float\" \"imagemap\" "
-              "\"string filename\" [\"%s\"]\n",
-              mtl.name.c_str(), mtl.normal_texname.c_str());
+      fprintf(f, "Texture \"%s-bump-map\" \"float\" \"imagemap\" ",
+              mtl.name.c_str());
+      EmitImageMapParams(f, mtl.normal_texname, atlasPlacements);
+      fprintf(f, "\n");
       fprintf(f, "Texture \"%s-bump\" \"float\" \"scale\" \"float tex1\" [%f] "
               "\"texture tex2\" \"%s-bump-map\"\n",
               mtl.name.c_str(), mtl.bump_scale, mtl.name.c_str());
@@ -1030,6 +1395,37 @@ int main(int argc, char *argv[]) {
     fprintf(f, "\n\n");
 
     const mesh_t &mesh = shape.mesh;
+    if (bmesh) {
+      // Write the geometry to a binary mesh file and reference it
+      char suffix[32];
+      sprintf(suffix, "_%d.bmesh", (int)i);
+      std::string bmeshName = std::string(argv[2]) + suffix;
+      size_t nVerts = mesh.positions.size() / 3;
+      std::vector<Point3f> P(nVerts);
+      for (size_t i = 0; i < nVerts; ++i)
+        P[i] = Point3f(mesh.positions[3 * i], mesh.positions[3 * i + 1],
+                       mesh.positions[3 * i + 2]);
+      std::vector<Normal3f> N(mesh.normals.size() / 3);
+      for (size_t i = 0; i < N.size(); ++i)
+        N[i] = Normal3f(mesh.normals[3 * i], mesh.normals[3 * i + 1],
+                        mesh.normals[3 * i + 2]);
+      std::vector<Point2f> UV(mesh.texcoords.size() / 2);
+      for (size_t i = 0; i < UV.size(); ++i)
+        UV[i] = Point2f(mesh.texcoords[2 * i], mesh.texcoords[2 * i + 1]);
+      if (!WriteBinaryMesh(bmeshName, mesh.indices.size() / 3,
+                           (const int *)&mesh.indices[0], nVerts, &P[0],
+                           N.empty() ? nullptr : &N[0],
+                           UV.empty() ? nullptr : &UV[0])) {
+        fprintf(stderr, "obj2pbrt: unable to write \"%s\"\n",
+                bmeshName.c_str());
+        return 1;
+      }
+      numTriangles += mesh.indices.size() / 3;
+      fprintf(f, "Shape \"plymesh\" \"string filename\" \"%s\"\n",
+              bmeshName.c_str());
+      fprintf(f, "AttributeEnd\n\n\n");
+      continue;
+    }
     fprintf(f, "Shape \"trianglemesh\"\n");
     fprintf(f, "  \"point P\" [\n    ");
     for (size_t i = 0; i < mesh.positions.size(); ++i) {